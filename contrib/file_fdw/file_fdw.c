@@ -32,9 +32,17 @@
 #include "optimizer/planmain.h"
 #include "optimizer/restrictinfo.h"
 #include "optimizer/var.h"
+#ifdef XCP
+#include "pgxc/locator.h"
+#include "pgxc/nodemgr.h"
+#include "pgxc/pgxc.h"
+#include "pgxc/pgxcnode.h"
+#endif
+#include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/rel.h"
 #include "utils/sampling.h"
+#include "utils/varlena.h"
 
 PG_MODULE_MAGIC;
 
@@ -60,6 +68,7 @@ static const struct FileFdwOption valid_options[] = {
     /* Data source options */
     {"filename", ForeignTableRelationId},
     {"program", ForeignTableRelationId},
+    {"distributed", ForeignTableRelationId},
 
     /* Format options */
     /* oids option is not supported */
@@ -88,6 +97,7 @@ typedef struct FileFdwPlanState
 {
     char       *filename;        /* file or program to read from */
     bool        is_program;        /* true if filename represents an OS command */
+    bool        distributed;    /* true if every datanode reads its share */
     List       *options;        /* merged COPY options, excluding filename and
                                  * is_program */
     BlockNumber pages;            /* estimate of file's physical size */
@@ -104,6 +114,8 @@ typedef struct FileFdwExecutionState
     List       *options;        /* merged COPY options, excluding filename and
                                  * is_program */
     CopyState    cstate;            /* COPY execution state */
+    List       *files;            /* files or program this scan reads */
+    ListCell   *cur_file;        /* the one cstate is reading */
 } FileFdwExecutionState;
 
 /*
@@ -146,7 +158,12 @@ static bool is_valid_option(const char *option, Oid context);
 static void fileGetOptions(Oid foreigntableid,
                char **filename,
                bool *is_program,
+               bool *distributed,
                List **other_options);
+static List *get_file_list(char *filename, bool is_program, bool distributed,
+              int node_index, int node_count);
+static CopyState file_begin_copy(ForeignScanState *node,
+                FileFdwExecutionState *festate);
 static List *get_file_fdw_attribute_options(Oid relid);
 static bool check_selective_binary_conversion(RelOptInfo *baserel,
                                   Oid foreigntableid,
@@ -196,6 +213,8 @@ file_fdw_validator(PG_FUNCTION_ARGS)
     List       *options_list = untransformRelOptions(PG_GETARG_DATUM(0));
     Oid            catalog = PG_GETARG_OID(1);
     char       *filename = NULL;
+    bool        is_program = false;
+    DefElem    *distributed = NULL;
     DefElem    *force_not_null = NULL;
     DefElem    *force_null = NULL;
     List       *other_options = NIL;
@@ -265,6 +284,21 @@ file_fdw_validator(PG_FUNCTION_ARGS)
                         (errcode(ERRCODE_SYNTAX_ERROR),
                          errmsg("conflicting or redundant options")));
             filename = defGetString(def);
+            is_program = (strcmp(def->defname, "program") == 0);
+        }
+
+        /*
+         * distributed only changes how the table is scanned; it is not a
+         * COPY option.
+         */
+        else if (strcmp(def->defname, "distributed") == 0)
+        {
+            if (distributed)
+                ereport(ERROR,
+                        (errcode(ERRCODE_SYNTAX_ERROR),
+                         errmsg("conflicting or redundant options")));
+            distributed = def;
+            (void) defGetBoolean(def);
         }
 
         /*
@@ -311,6 +345,19 @@ file_fdw_validator(PG_FUNCTION_ARGS)
                 (errcode(ERRCODE_FDW_DYNAMIC_PARAMETER_VALUE_NEEDED),
                  errmsg("either filename or program is required for file_fdw foreign tables")));
 
+    /* The filename of a distributed table is a list; check its syntax */
+    if (filename && !is_program && distributed && defGetBoolean(distributed))
+    {
+        List       *files;
+
+        if (!SplitDirectoriesString(pstrdup(filename), ',', &files) ||
+            files == NIL)
+            ereport(ERROR,
+                    (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                     errmsg("invalid list syntax in parameter \"%s\"",
+                            "filename")));
+    }
+
     PG_RETURN_VOID();
 }
 
@@ -334,12 +381,14 @@ is_valid_option(const char *option, Oid context)
 /*
  * Fetch the options for a file_fdw foreign table.
  *
- * We have to separate out filename/program from the other options because
- * those must not appear in the options list passed to the core COPY code.
+ * We have to separate out filename/program and distributed from the other
+ * options because those must not appear in the options list passed to the
+ * core COPY code.
  */
 static void
 fileGetOptions(Oid foreigntableid,
-               char **filename, bool *is_program, List **other_options)
+               char **filename, bool *is_program, bool *distributed,
+               List **other_options)
 {
     ForeignTable *table;
     ForeignServer *server;
@@ -368,29 +417,37 @@ fileGetOptions(Oid foreigntableid,
 
     /*
      * Separate out the filename or program option (we assume there is only
-     * one).
+     * one), and the distributed option.
      */
     *filename = NULL;
     *is_program = false;
+    *distributed = false;
     prev = NULL;
-    foreach(lc, options)
+    lc = list_head(options);
+    while (lc != NULL)
     {
         DefElem    *def = (DefElem *) lfirst(lc);
+        ListCell   *next = lnext(lc);
 
         if (strcmp(def->defname, "filename") == 0)
         {
             *filename = defGetString(def);
             options = list_delete_cell(options, lc, prev);
-            break;
         }
         else if (strcmp(def->defname, "program") == 0)
         {
             *filename = defGetString(def);
             *is_program = true;
             options = list_delete_cell(options, lc, prev);
-            break;
         }
-        prev = lc;
+        else if (strcmp(def->defname, "distributed") == 0)
+        {
+            *distributed = defGetBoolean(def);
+            options = list_delete_cell(options, lc, prev);
+        }
+        else
+            prev = lc;
+        lc = next;
     }
 
     /*
@@ -403,6 +460,43 @@ fileGetOptions(Oid foreigntableid,
     *other_options = options;
 }
 
+/*
+ * Build the list of sources a scan of the foreign table reads.
+ *
+ * A plain table reads its one file or program.  The filename of a
+ * distributed table is a comma-separated list of paths, and the datanode at
+ * node_index out of node_count takes every node_count'th of them, so that
+ * the nodes share the files between them.  A node_count of zero means read
+ * all of them.  A program is run as it is on every node.
+ */
+static List *
+get_file_list(char *filename, bool is_program, bool distributed,
+              int node_index, int node_count)
+{
+    List       *files;
+    List       *result = NIL;
+    ListCell   *lc;
+    int            i = 0;
+
+    if (is_program || !distributed)
+        return list_make1(filename);
+
+    if (!SplitDirectoriesString(pstrdup(filename), ',', &files))
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("invalid list syntax in parameter \"%s\"",
+                        "filename")));
+
+    foreach(lc, files)
+    {
+        if (node_count <= 0 || i % node_count == node_index)
+            result = lappend(result, lfirst(lc));
+        i++;
+    }
+
+    return result;
+}
+
 /*
  * Retrieve per-column generic options from pg_attribute and construct a list
  * of DefElems representing them.
@@ -500,6 +594,7 @@ fileGetForeignRelSize(PlannerInfo *root,
     fileGetOptions(foreigntableid,
                    &fdw_private->filename,
                    &fdw_private->is_program,
+                   &fdw_private->distributed,
                    &fdw_private->options);
     baserel->fdw_private = (void *) fdw_private;
 
@@ -525,6 +620,10 @@ fileGetForeignPaths(PlannerInfo *root,
     Cost        total_cost;
     List       *columns;
     List       *coptions = NIL;
+    ForeignPath *path;
+#ifdef XCP
+    Distribution *distribution = NULL;
+#endif
 
     /* Decide whether to selectively perform binary conversion */
     if (check_selective_binary_conversion(baserel,
@@ -537,21 +636,55 @@ fileGetForeignPaths(PlannerInfo *root,
     estimate_costs(root, baserel, fdw_private,
                    &startup_cost, &total_cost);
 
+#ifdef XCP
+    /*
+     * A distributed table is read on all the datanodes at once, each taking
+     * its share of the files, so its rows come out spread over the nodes the
+     * same way as those of a round-robin table.  The planner redistributes
+     * them from there if the rest of the query needs it.  The names of the
+     * nodes sharing the files travel in the path's fdw_private list, so that
+     * each of them can find its share by its position in the list.
+     */
+    if (fdw_private->distributed && IS_PGXC_COORDINATOR && NumDataNodes > 0)
+    {
+        List       *nodes = NIL;
+        int            i;
+
+        distribution = makeNode(Distribution);
+        distribution->distributionType = LOCATOR_TYPE_RROBIN;
+        for (i = 0; i < NumDataNodes; i++)
+        {
+            distribution->nodes = bms_add_member(distribution->nodes, i);
+            nodes = lappend(nodes,
+                            makeString(get_pgxc_nodename(PGXCNodeGetNodeOid(i,
+                                                                            PGXC_NODE_DATANODE))));
+        }
+
+        coptions = lappend(coptions,
+                           makeDefElem("nodes", (Node *) nodes, -1));
+
+        total_cost = startup_cost + (total_cost - startup_cost) / NumDataNodes;
+    }
+#endif
+
     /*
      * Create a ForeignPath node and add it as only possible path.  We use the
      * fdw_private list of the path to carry the convert_selectively option;
      * it will be propagated into the fdw_private list of the Plan node.
      */
-    add_path(baserel, (Path *)
-             create_foreignscan_path(root, baserel,
-                                     NULL,    /* default pathtarget */
-                                     baserel->rows,
-                                     startup_cost,
-                                     total_cost,
-                                     NIL,    /* no pathkeys */
-                                     NULL,    /* no outer rel either */
-                                     NULL,    /* no extra plan */
-                                     coptions));
+    path = create_foreignscan_path(root, baserel,
+                                   NULL,    /* default pathtarget */
+                                   baserel->rows,
+                                   startup_cost,
+                                   total_cost,
+                                   NIL,    /* no pathkeys */
+                                   NULL,    /* no outer rel either */
+                                   NULL,    /* no extra plan */
+                                   coptions);
+#ifdef XCP
+    path->path.distribution = distribution;
+#endif
+    add_path(baserel, (Path *) path);
 
     /*
      * If data file was sorted, and we knew it somehow, we could insert
@@ -604,19 +737,22 @@ fileExplainForeignScan(ForeignScanState *node, ExplainState *es)
 {
     char       *filename;
     bool        is_program;
+    bool        distributed;
     List       *options;
 
     /* Fetch options --- we only need filename and is_program at this point */
     fileGetOptions(RelationGetRelid(node->ss.ss_currentRelation),
-                   &filename, &is_program, &options);
+                   &filename, &is_program, &distributed, &options);
 
     if (is_program)
         ExplainPropertyText("Foreign Program", filename, es);
+    else if (distributed)
+        ExplainPropertyText("Foreign Files", filename, es);
     else
         ExplainPropertyText("Foreign File", filename, es);
 
     /* Suppress file size if we're not showing cost details */
-    if (es->costs)
+    if (es->costs && !distributed)
     {
         struct stat stat_buf;
 
@@ -637,9 +773,13 @@ fileBeginForeignScan(ForeignScanState *node, int eflags)
     ForeignScan *plan = (ForeignScan *) node->ss.ps.plan;
     char       *filename;
     bool        is_program;
+    bool        distributed;
     List       *options;
-    CopyState    cstate;
     FileFdwExecutionState *festate;
+    List       *nodes = NIL;
+    int            node_index = 0;
+    int            node_count = 0;
+    ListCell   *lc;
 
     /*
      * Do nothing in EXPLAIN (no ANALYZE) case.  node->fdw_state stays NULL.
@@ -649,22 +789,56 @@ fileBeginForeignScan(ForeignScanState *node, int eflags)
 
     /* Fetch options of foreign table */
     fileGetOptions(RelationGetRelid(node->ss.ss_currentRelation),
-                   &filename, &is_program, &options);
+                   &filename, &is_program, &distributed, &options);
 
-    /* Add any options from the plan (currently only convert_selectively) */
-    options = list_concat(options, plan->fdw_private);
+    /*
+     * Add any options from the plan (currently only convert_selectively),
+     * except nodes, which lists the datanodes sharing the files.
+     */
+    foreach(lc, plan->fdw_private)
+    {
+        DefElem    *def = (DefElem *) lfirst(lc);
+
+        if (strcmp(def->defname, "nodes") == 0)
+            nodes = (List *) def->arg;
+        else
+            options = lappend(options, def);
+    }
+
+#ifdef XCP
+    /* Our share of the files is determined by our place in the node list */
+    if (nodes != NIL && IS_PGXC_DATANODE)
+    {
+        foreach(lc, nodes)
+        {
+            if (strcmp(strVal(lfirst(lc)), PGXCNodeName) == 0)
+            {
+                node_count = list_length(nodes);
+                break;
+            }
+            node_index++;
+        }
+        if (node_count == 0)
+            ereport(ERROR,
+                    (errcode(ERRCODE_FDW_ERROR),
+                     errmsg("datanode \"%s\" is not among the nodes planned to scan the files",
+                            PGXCNodeName)));
+    }
+#endif
 
     /*
-     * Create CopyState from FDW options.  We always acquire all columns, so
-     * as to match the expected ScanTupleSlot signature.
+     * A program is run on every datanode; let it know which part of the
+     * input it is expected to produce.
      */
-    cstate = BeginCopyFrom(NULL,
-                           node->ss.ss_currentRelation,
-                           filename,
-                           is_program,
-                           NULL,
-                           NIL,
-                           options);
+    if (is_program && distributed && node_count > 0)
+    {
+        char        buf[32];
+
+        snprintf(buf, sizeof(buf), "%d", node_index);
+        setenv("FILE_FDW_NODE_INDEX", buf, 1);
+        snprintf(buf, sizeof(buf), "%d", node_count);
+        setenv("FILE_FDW_NODE_COUNT", buf, 1);
+    }
 
     /*
      * Save state in node->fdw_state.  We must save enough information to call
@@ -674,11 +848,39 @@ fileBeginForeignScan(ForeignScanState *node, int eflags)
     festate->filename = filename;
     festate->is_program = is_program;
     festate->options = options;
-    festate->cstate = cstate;
+    festate->files = get_file_list(filename, is_program, distributed,
+                                   node_index, node_count);
+    festate->cur_file = list_head(festate->files);
+
+    /*
+     * Create CopyState for the first source.  We always acquire all columns,
+     * so as to match the expected ScanTupleSlot signature.
+     */
+    festate->cstate = file_begin_copy(node, festate);
 
     node->fdw_state = (void *) festate;
 }
 
+/*
+ * file_begin_copy
+ *        Create CopyState for the source the scan is at, or return NULL if
+ *        the scan has read all its sources
+ */
+static CopyState
+file_begin_copy(ForeignScanState *node, FileFdwExecutionState *festate)
+{
+    if (festate->cur_file == NULL)
+        return NULL;
+
+    return BeginCopyFrom(NULL,
+                         node->ss.ss_currentRelation,
+                         (char *) lfirst(festate->cur_file),
+                         festate->is_program,
+                         NULL,
+                         NIL,
+                         festate->options);
+}
+
 /*
  * fileIterateForeignScan
  *        Read next record from the data file and store it into the
@@ -692,17 +894,11 @@ fileIterateForeignScan(ForeignScanState *node)
     bool        found;
     ErrorContextCallback errcallback;
 
-    /* Set up callback to identify error line number. */
-    errcallback.callback = CopyFromErrorCallback;
-    errcallback.arg = (void *) festate->cstate;
-    errcallback.previous = error_context_stack;
-    error_context_stack = &errcallback;
-
     /*
      * The protocol for loading a virtual tuple into a slot is first
      * ExecClearTuple, then fill the values/isnull arrays, then
-     * ExecStoreVirtualTuple.  If we don't find another row in the file, we
-     * just skip the last step, leaving the slot empty as required.
+     * ExecStoreVirtualTuple.  If we don't find another row in any of the
+     * files, we just skip the last step, leaving the slot empty as required.
      *
      * We can pass ExprContext = NULL because we read all columns from the
      * file, so no need to evaluate default expressions.
@@ -711,14 +907,32 @@ fileIterateForeignScan(ForeignScanState *node)
      * foreign tables.
      */
     ExecClearTuple(slot);
-    found = NextCopyFrom(festate->cstate, NULL,
-                         slot->tts_values, slot->tts_isnull,
-                         NULL);
-    if (found)
-        ExecStoreVirtualTuple(slot);
+    while (festate->cstate != NULL)
+    {
+        /* Set up callback to identify error line number. */
+        errcallback.callback = CopyFromErrorCallback;
+        errcallback.arg = (void *) festate->cstate;
+        errcallback.previous = error_context_stack;
+        error_context_stack = &errcallback;
+
+        found = NextCopyFrom(festate->cstate, NULL,
+                             slot->tts_values, slot->tts_isnull,
+                             NULL);
+
+        /* Remove error callback. */
+        error_context_stack = errcallback.previous;
+
+        if (found)
+        {
+            ExecStoreVirtualTuple(slot);
+            break;
+        }
 
-    /* Remove error callback. */
-    error_context_stack = errcallback.previous;
+        /* This file is done; go on to the next one, if any */
+        EndCopyFrom(festate->cstate);
+        festate->cur_file = lnext(festate->cur_file);
+        festate->cstate = file_begin_copy(node, festate);
+    }
 
     return slot;
 }
@@ -732,15 +946,11 @@ fileReScanForeignScan(ForeignScanState *node)
 {
     FileFdwExecutionState *festate = (FileFdwExecutionState *) node->fdw_state;
 
-    EndCopyFrom(festate->cstate);
+    if (festate->cstate)
+        EndCopyFrom(festate->cstate);
 
-    festate->cstate = BeginCopyFrom(NULL,
-                                    node->ss.ss_currentRelation,
-                                    festate->filename,
-                                    festate->is_program,
-                                    NULL,
-                                    NIL,
-                                    festate->options);
+    festate->cur_file = list_head(festate->files);
+    festate->cstate = file_begin_copy(node, festate);
 }
 
 /*
@@ -753,7 +963,7 @@ fileEndForeignScan(ForeignScanState *node)
     FileFdwExecutionState *festate = (FileFdwExecutionState *) node->fdw_state;
 
     /* if festate is NULL, we are in EXPLAIN; nothing to do */
-    if (festate)
+    if (festate && festate->cstate)
         EndCopyFrom(festate->cstate);
 }
 
@@ -768,11 +978,15 @@ fileAnalyzeForeignTable(Relation relation,
 {
     char       *filename;
     bool        is_program;
+    bool        distributed;
     List       *options;
     struct stat stat_buf;
+    off_t        total_size = 0;
+    ListCell   *lc;
 
     /* Fetch options of foreign table */
-    fileGetOptions(RelationGetRelid(relation), &filename, &is_program, &options);
+    fileGetOptions(RelationGetRelid(relation), &filename, &is_program,
+                   &distributed, &options);
 
     /*
      * If this is a program instead of a file, just return false to skip
@@ -785,20 +999,26 @@ fileAnalyzeForeignTable(Relation relation,
         return false;
 
     /*
-     * Get size of the file.  (XXX if we fail here, would it be better to just
-     * return false to skip analyzing the table?)
+     * Get size of the files.  (XXX if we fail here, would it be better to
+     * just return false to skip analyzing the table?)
      */
-    if (stat(filename, &stat_buf) < 0)
-        ereport(ERROR,
-                (errcode_for_file_access(),
-                 errmsg("could not stat file \"%s\": %m",
-                        filename)));
+    foreach(lc, get_file_list(filename, is_program, distributed, 0, 0))
+    {
+        char       *file = (char *) lfirst(lc);
+
+        if (stat(file, &stat_buf) < 0)
+            ereport(ERROR,
+                    (errcode_for_file_access(),
+                     errmsg("could not stat file \"%s\": %m",
+                            file)));
+        total_size += stat_buf.st_size;
+    }
 
     /*
      * Convert size to pages.  Must return at least 1 so that we can tell
      * later on that pg_class.relpages is not default.
      */
-    *totalpages = (stat_buf.st_size + (BLCKSZ - 1)) / BLCKSZ;
+    *totalpages = (total_size + (BLCKSZ - 1)) / BLCKSZ;
     if (*totalpages < 1)
         *totalpages = 1;
 
@@ -950,22 +1170,38 @@ estimate_size(PlannerInfo *root, RelOptInfo *baserel,
               FileFdwPlanState *fdw_private)
 {
     struct stat stat_buf;
+    off_t        total_size = 0;
     BlockNumber pages;
     double        ntuples;
     double        nrows;
 
     /*
-     * Get size of the file.  It might not be there at plan time, though, in
-     * which case we have to use a default estimate.  We also have to fall
+     * Get size of the files.  They might not be there at plan time, though,
+     * in which case we have to use a default estimate.  We also have to fall
      * back to the default if using a program as the input.
      */
-    if (fdw_private->is_program || stat(fdw_private->filename, &stat_buf) < 0)
-        stat_buf.st_size = 10 * BLCKSZ;
+    if (fdw_private->is_program)
+        total_size = 10 * BLCKSZ;
+    else
+    {
+        ListCell   *lc;
+
+        foreach(lc, get_file_list(fdw_private->filename, false,
+                                  fdw_private->distributed, 0, 0))
+        {
+            if (stat((char *) lfirst(lc), &stat_buf) < 0)
+            {
+                total_size = 10 * BLCKSZ;
+                break;
+            }
+            total_size += stat_buf.st_size;
+        }
+    }
 
     /*
      * Convert size to pages for use in I/O cost estimate later.
      */
-    pages = (stat_buf.st_size + (BLCKSZ - 1)) / BLCKSZ;
+    pages = (total_size + (BLCKSZ - 1)) / BLCKSZ;
     if (pages < 1)
         pages = 1;
     fdw_private->pages = pages;
@@ -999,7 +1235,7 @@ estimate_size(PlannerInfo *root, RelOptInfo *baserel,
 
         tuple_width = MAXALIGN(baserel->reltarget->width) +
             MAXALIGN(SizeofHeapTupleHeader);
-        ntuples = clamp_row_est((double) stat_buf.st_size /
+        ntuples = clamp_row_est((double) total_size /
                                 (double) tuple_width);
     }
     fdw_private->ntuples = ntuples;
@@ -1083,7 +1319,9 @@ file_acquire_sample_rows(Relation onerel, int elevel,
     bool        found;
     char       *filename;
     bool        is_program;
+    bool        distributed;
     List       *options;
+    ListCell   *lc;
     CopyState    cstate;
     ErrorContextCallback errcallback;
     MemoryContext oldcontext = CurrentMemoryContext;
@@ -1097,13 +1335,8 @@ file_acquire_sample_rows(Relation onerel, int elevel,
     nulls = (bool *) palloc(tupDesc->natts * sizeof(bool));
 
     /* Fetch options of foreign table */
-    fileGetOptions(RelationGetRelid(onerel), &filename, &is_program, &options);
-
-    /*
-     * Create CopyState from FDW options.
-     */
-    cstate = BeginCopyFrom(NULL, onerel, filename, is_program, NULL, NIL,
-                           options);
+    fileGetOptions(RelationGetRelid(onerel), &filename, &is_program,
+                   &distributed, &options);
 
     /*
      * Use per-tuple memory context to prevent leak of memory used to read
@@ -1116,77 +1349,90 @@ file_acquire_sample_rows(Relation onerel, int elevel,
     /* Prepare for sampling rows */
     reservoir_init_selection_state(&rstate, targrows);
 
-    /* Set up callback to identify error line number. */
-    errcallback.callback = CopyFromErrorCallback;
-    errcallback.arg = (void *) cstate;
-    errcallback.previous = error_context_stack;
-    error_context_stack = &errcallback;
-
     *totalrows = 0;
     *totaldeadrows = 0;
-    for (;;)
+
+    /* Read all the files, sampling rows from them as one stream */
+    foreach(lc, get_file_list(filename, is_program, distributed, 0, 0))
     {
-        /* Check for user-requested abort or sleep */
-        vacuum_delay_point();
+        /*
+         * Create CopyState from FDW options.
+         */
+        cstate = BeginCopyFrom(NULL, onerel, (char *) lfirst(lc), is_program,
+                               NULL, NIL, options);
 
-        /* Fetch next row */
-        MemoryContextReset(tupcontext);
-        MemoryContextSwitchTo(tupcontext);
+        /* Set up callback to identify error line number. */
+        errcallback.callback = CopyFromErrorCallback;
+        errcallback.arg = (void *) cstate;
+        errcallback.previous = error_context_stack;
+        error_context_stack = &errcallback;
 
-        found = NextCopyFrom(cstate, NULL, values, nulls, NULL);
+        for (;;)
+        {
+            /* Check for user-requested abort or sleep */
+            vacuum_delay_point();
 
-        MemoryContextSwitchTo(oldcontext);
+            /* Fetch next row */
+            MemoryContextReset(tupcontext);
+            MemoryContextSwitchTo(tupcontext);
 
-        if (!found)
-            break;
+            found = NextCopyFrom(cstate, NULL, values, nulls, NULL);
+
+            MemoryContextSwitchTo(oldcontext);
+
+            if (!found)
+                break;
 
-        /*
-         * The first targrows sample rows are simply copied into the
-         * reservoir.  Then we start replacing tuples in the sample until we
-         * reach the end of the relation. This algorithm is from Jeff Vitter's
-         * paper (see more info in commands/analyze.c).
-         */
-        if (numrows < targrows)
-        {
-            rows[numrows++] = heap_form_tuple(tupDesc, values, nulls);
-        }
-        else
-        {
             /*
-             * t in Vitter's paper is the number of records already processed.
-             * If we need to compute a new S value, we must use the
-             * not-yet-incremented value of totalrows as t.
+             * The first targrows sample rows are simply copied into the
+             * reservoir.  Then we start replacing tuples in the sample until
+             * we reach the end of the relation. This algorithm is from Jeff
+             * Vitter's paper (see more info in commands/analyze.c).
              */
-            if (rowstoskip < 0)
-                rowstoskip = reservoir_get_next_S(&rstate, *totalrows, targrows);
-
-            if (rowstoskip <= 0)
+            if (numrows < targrows)
+            {
+                rows[numrows++] = heap_form_tuple(tupDesc, values, nulls);
+            }
+            else
             {
                 /*
-                 * Found a suitable tuple, so save it, replacing one old tuple
-                 * at random
+                 * t in Vitter's paper is the number of records already
+                 * processed.  If we need to compute a new S value, we must
+                 * use the not-yet-incremented value of totalrows as t.
                  */
-                int            k = (int) (targrows * sampler_random_fract(rstate.randstate));
+                if (rowstoskip < 0)
+                    rowstoskip = reservoir_get_next_S(&rstate, *totalrows,
+                                                      targrows);
+
+                if (rowstoskip <= 0)
+                {
+                    /*
+                     * Found a suitable tuple, so save it, replacing one old
+                     * tuple at random
+                     */
+                    int            k = (int) (targrows *
+                                           sampler_random_fract(rstate.randstate));
+
+                    Assert(k >= 0 && k < targrows);
+                    heap_freetuple(rows[k]);
+                    rows[k] = heap_form_tuple(tupDesc, values, nulls);
+                }
 
-                Assert(k >= 0 && k < targrows);
-                heap_freetuple(rows[k]);
-                rows[k] = heap_form_tuple(tupDesc, values, nulls);
+                rowstoskip -= 1;
             }
 
-            rowstoskip -= 1;
+            *totalrows += 1;
         }
 
-        *totalrows += 1;
-    }
+        /* Remove error callback. */
+        error_context_stack = errcallback.previous;
 
-    /* Remove error callback. */
-    error_context_stack = errcallback.previous;
+        EndCopyFrom(cstate);
+    }
 
     /* Clean up. */
     MemoryContextDelete(tupcontext);
 
-    EndCopyFrom(cstate);
-
     pfree(values);
     pfree(nulls);
 
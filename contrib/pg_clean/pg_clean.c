@@ -35,6 +35,7 @@
 
 #include "utils/memutils.h"
 #include "nodes/memnodes.h"
+#include "nodes/bitmapset.h"
 
 #ifdef XCP
 #include "catalog/pg_type.h"
@@ -247,6 +248,8 @@ static Oid	        *cn_node_list = NULL;
 static Oid	        *dn_node_list = NULL;
 static bool         *cn_health_map = NULL;
 static bool         *dn_health_map = NULL;
+/* node indexes whose health has been checked in this run */
+static Bitmapset    *health_checked_nodes = NULL;
 static int	        cn_nodes_num = 0;
 static int	        dn_nodes_num = 0;
 static int	        pgxc_clean_node_count = 0;
@@ -745,6 +748,7 @@ static void ResetGlobalVariables(void)
 	dn_node_list = NULL;
 	cn_health_map = NULL;
 	dn_health_map = NULL;
+	health_checked_nodes = NULL;
 	cn_nodes_num = 0;
 	dn_nodes_num = 0;
 	pgxc_clean_node_count = 0;
@@ -873,12 +877,24 @@ execute_query_on_single_node(Oid node, const char *query, int attnum, TupleTable
 static bool check_node_health(Oid node_oid)
 {
 	int i;
+	int node_idx;
 	bool ishealthy = false;
-	
-	PoolPingNodeRecheck(node_oid);
-	PgxcNodeGetHealthMap(cn_node_list, dn_node_list, 
-						&cn_nodes_num, &dn_nodes_num, 
-						cn_health_map, dn_health_map);
+
+	/*
+	 * Pinging the node costs a round trip, and a run may send tens of
+	 * thousands of queries to the same node, so check each node only once
+	 * per run.
+	 */
+	node_idx = find_node_index(node_oid);
+	if (node_idx < 0 || !bms_is_member(node_idx, health_checked_nodes))
+	{
+		PoolPingNodeRecheck(node_oid);
+		PgxcNodeGetHealthMap(cn_node_list, dn_node_list, 
+							&cn_nodes_num, &dn_nodes_num, 
+							cn_health_map, dn_health_map);
+		if (node_idx >= 0)
+			health_checked_nodes = bms_add_member(health_checked_nodes, node_idx);
+	}
 	if (get_pgxc_nodetype(node_oid) == 'C')
 	{
 		for (i = 0; i < cn_nodes_num; i++)
@@ -0,0 +1,17 @@
+/* contrib/pg_prewarm/pg_prewarm--1.1--1.2.sql */
+
+-- complain if script is sourced in psql, rather than via ALTER EXTENSION
+\echo Use "ALTER EXTENSION pg_prewarm UPDATE TO '1.2'" to load this file. \quit
+
+CREATE FUNCTION autoprewarm_dump_now()
+RETURNS pg_catalog.int8
+AS 'MODULE_PATHNAME', 'autoprewarm_dump_now'
+LANGUAGE C STRICT;
+
+CREATE FUNCTION autoprewarm_load_now()
+RETURNS pg_catalog.int8
+AS 'MODULE_PATHNAME', 'autoprewarm_load_now'
+LANGUAGE C STRICT;
+
+REVOKE EXECUTE ON FUNCTION autoprewarm_dump_now() FROM PUBLIC;
+REVOKE EXECUTE ON FUNCTION autoprewarm_load_now() FROM PUBLIC;
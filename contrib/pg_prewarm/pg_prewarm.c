@@ -16,19 +16,68 @@
 #include <unistd.h>
 
 #include "access/heapam.h"
+#include "access/xact.h"
 #include "catalog/catalog.h"
 #include "fmgr.h"
 #include "miscadmin.h"
+#include "pgstat.h"
+#include "postmaster/bgworker.h"
+#include "storage/buf_internals.h"
 #include "storage/bufmgr.h"
+#include "storage/fd.h"
+#include "storage/ipc.h"
+#include "storage/latch.h"
 #include "storage/smgr.h"
 #include "utils/acl.h"
 #include "utils/builtins.h"
+#include "utils/guc.h"
 #include "utils/lsyscache.h"
 #include "utils/rel.h"
+#include "utils/relfilenodemap.h"
 
 PG_MODULE_MAGIC;
 
 PG_FUNCTION_INFO_V1(pg_prewarm);
+PG_FUNCTION_INFO_V1(autoprewarm_dump_now);
+PG_FUNCTION_INFO_V1(autoprewarm_load_now);
+
+void        _PG_init(void);
+void        autoprewarm_main(Datum main_arg) pg_attribute_noreturn();
+void        autoprewarm_database_main(Datum main_arg) pg_attribute_noreturn();
+
+#define AUTOPREWARM_FILE "autoprewarm.blocks"
+
+/* Metadata for each block we dump. */
+typedef struct BlockInfoRecord
+{
+    Oid            database;
+    Oid            tablespace;
+    Oid            filenode;
+    ForkNumber    forknum;
+    BlockNumber blocknum;
+    uint32        usagecount;
+} BlockInfoRecord;
+
+/* GUC variables */
+static bool autoprewarm = true;
+static int    autoprewarm_interval = 300;    /* seconds, 0 dumps at shutdown only */
+
+/* AUTOPREWARM_FILE as last written or loaded by the autoprewarm worker */
+static time_t apw_file_mtime = 0;
+static off_t apw_file_size = -1;
+
+/* flags set by signal handlers */
+static volatile sig_atomic_t got_sighup = false;
+static volatile sig_atomic_t got_sigterm = false;
+
+static int64 apw_dump_now(void);
+static void apw_remember_file(void);
+static bool apw_file_replaced(void);
+static BlockInfoRecord *apw_read_file(int64 *num_elements, bool missing_ok);
+static int64 apw_load_database(BlockInfoRecord *block_info,
+                  int64 num_elements);
+static bool apw_load_all(void);
+static int    apw_compare_blockinfo(const void *p, const void *q);
 
 typedef enum
 {
@@ -204,3 +253,571 @@ pg_prewarm(PG_FUNCTION_ARGS)
 
     PG_RETURN_INT64(blocks_done);
 }
+
+/*
+ * Module load callback: define the GUCs, and start the autoprewarm worker
+ * when loaded through shared_preload_libraries.
+ */
+void
+_PG_init(void)
+{
+    BackgroundWorker worker;
+
+    DefineCustomBoolVariable("pg_prewarm.autoprewarm",
+                             "Starts the autoprewarm worker.",
+                             NULL,
+                             &autoprewarm,
+                             true,
+                             PGC_POSTMASTER,
+                             0,
+                             NULL,
+                             NULL,
+                             NULL);
+
+    DefineCustomIntVariable("pg_prewarm.autoprewarm_interval",
+                            "Sets the interval between dumps of shared buffers.",
+                            "If set to zero, the buffers are only dumped at shutdown.",
+                            &autoprewarm_interval,
+                            300,
+                            0, INT_MAX / 1000,
+                            PGC_SIGHUP,
+                            GUC_UNIT_S,
+                            NULL,
+                            NULL,
+                            NULL);
+
+    EmitWarningsOnPlaceholders("pg_prewarm");
+
+    if (!process_shared_preload_libraries_in_progress || !autoprewarm)
+        return;
+
+    memset(&worker, 0, sizeof(worker));
+    worker.bgw_flags = BGWORKER_SHMEM_ACCESS;
+    worker.bgw_start_time = BgWorkerStart_ConsistentState;
+    worker.bgw_restart_time = BGW_NEVER_RESTART;
+    sprintf(worker.bgw_library_name, "pg_prewarm");
+    sprintf(worker.bgw_function_name, "autoprewarm_main");
+    snprintf(worker.bgw_name, BGW_MAXLEN, "autoprewarm master");
+    worker.bgw_main_arg = (Datum) 0;
+    worker.bgw_notify_pid = 0;
+
+    RegisterBackgroundWorker(&worker);
+}
+
+static void
+apw_sigterm_handler(SIGNAL_ARGS)
+{
+    int            save_errno = errno;
+
+    got_sigterm = true;
+    SetLatch(MyLatch);
+
+    errno = save_errno;
+}
+
+static void
+apw_sighup_handler(SIGNAL_ARGS)
+{
+    int            save_errno = errno;
+
+    got_sighup = true;
+    SetLatch(MyLatch);
+
+    errno = save_errno;
+}
+
+/*
+ * Main entry point of the autoprewarm master worker.
+ *
+ * The blocks listed in AUTOPREWARM_FILE are loaded once the server reaches
+ * a consistent state, in the background while connections are accepted.
+ * Then the list is dumped every autoprewarm_interval seconds, and when the
+ * server shuts down, so that the next start finds the cache as it was.
+ *
+ * A file put in place by someone else, such as the list of a primary copied
+ * to its standby, is not overwritten before it has been loaded: the dump
+ * that finds it loads it instead.
+ */
+void
+autoprewarm_main(Datum main_arg)
+{
+    bool        loaded;
+
+    pqsignal(SIGTERM, apw_sigterm_handler);
+    pqsignal(SIGHUP, apw_sighup_handler);
+    BackgroundWorkerUnblockSignals();
+
+    apw_remember_file();
+    loaded = apw_load_all();
+
+    while (!got_sigterm)
+    {
+        int            rc;
+
+        if (got_sighup)
+        {
+            got_sighup = false;
+            ProcessConfigFile(PGC_SIGHUP);
+        }
+
+        if (autoprewarm_interval > 0)
+            rc = WaitLatch(MyLatch,
+                           WL_LATCH_SET | WL_TIMEOUT | WL_POSTMASTER_DEATH,
+                           autoprewarm_interval * 1000L,
+                           PG_WAIT_EXTENSION);
+        else
+            rc = WaitLatch(MyLatch,
+                           WL_LATCH_SET | WL_POSTMASTER_DEATH,
+                           -1L,
+                           PG_WAIT_EXTENSION);
+        ResetLatch(MyLatch);
+
+        /* emergency bailout if postmaster has died */
+        if (rc & WL_POSTMASTER_DEATH)
+            proc_exit(1);
+
+        if (!(rc & WL_TIMEOUT))
+            continue;
+
+        if (apw_file_replaced())
+        {
+            apw_remember_file();
+            loaded = apw_load_all();
+        }
+        else if (loaded)
+        {
+            apw_dump_now();
+            apw_remember_file();
+        }
+    }
+
+    /*
+     * A load cut short would leave only part of the list behind, and a file
+     * not loaded yet is left for the next start.
+     */
+    if (loaded && !apw_file_replaced())
+        apw_dump_now();
+
+    proc_exit(0);
+}
+
+/*
+ * Remember which AUTOPREWARM_FILE the worker has dealt with.
+ */
+static void
+apw_remember_file(void)
+{
+    struct stat st;
+
+    if (stat(AUTOPREWARM_FILE, &st) == 0)
+    {
+        apw_file_mtime = st.st_mtime;
+        apw_file_size = st.st_size;
+    }
+    else
+    {
+        apw_file_mtime = 0;
+        apw_file_size = -1;
+    }
+}
+
+/*
+ * Has AUTOPREWARM_FILE been replaced since apw_remember_file()?
+ */
+static bool
+apw_file_replaced(void)
+{
+    struct stat st;
+
+    if (stat(AUTOPREWARM_FILE, &st) != 0)
+        return false;
+
+    return st.st_mtime != apw_file_mtime || st.st_size != apw_file_size;
+}
+
+/*
+ * Load AUTOPREWARM_FILE, with one worker per database, one database after
+ * the other, the database of the hottest block first. Returns false if
+ * interrupted.
+ */
+static bool
+apw_load_all(void)
+{
+    BlockInfoRecord *block_info;
+    int64        num_elements;
+    Oid           *databases;
+    int            num_databases = 0;
+    int64        i;
+    int            j;
+
+    block_info = apw_read_file(&num_elements, true);
+    if (block_info == NULL)
+        return true;
+
+    /* hottest first, see apw_compare_blockinfo() */
+    pg_qsort(block_info, num_elements, sizeof(BlockInfoRecord),
+             apw_compare_blockinfo);
+
+    /* shared relations are loaded along with each database */
+    databases = (Oid *) palloc(Max(num_elements, 1) * sizeof(Oid));
+    for (i = 0; i < num_elements; i++)
+    {
+        if (!OidIsValid(block_info[i].database))
+            continue;
+        for (j = 0; j < num_databases; j++)
+        {
+            if (databases[j] == block_info[i].database)
+                break;
+        }
+        if (j == num_databases)
+            databases[num_databases++] = block_info[i].database;
+    }
+    pfree(block_info);
+
+    for (j = 0; j < num_databases && !got_sigterm; j++)
+    {
+        BackgroundWorker worker;
+        BackgroundWorkerHandle *handle;
+
+        memset(&worker, 0, sizeof(worker));
+        worker.bgw_flags = BGWORKER_SHMEM_ACCESS |
+            BGWORKER_BACKEND_DATABASE_CONNECTION;
+        worker.bgw_start_time = BgWorkerStart_ConsistentState;
+        worker.bgw_restart_time = BGW_NEVER_RESTART;
+        sprintf(worker.bgw_library_name, "pg_prewarm");
+        sprintf(worker.bgw_function_name, "autoprewarm_database_main");
+        snprintf(worker.bgw_name, BGW_MAXLEN,
+                 "autoprewarm worker for database %u", databases[j]);
+        worker.bgw_main_arg = ObjectIdGetDatum(databases[j]);
+        worker.bgw_notify_pid = MyProcPid;
+
+        if (!RegisterDynamicBackgroundWorker(&worker, &handle))
+        {
+            ereport(LOG,
+                    (errcode(ERRCODE_INSUFFICIENT_RESOURCES),
+                     errmsg("could not register background worker to prewarm database %u",
+                            databases[j]),
+                     errhint("Consider increasing configuration parameter \"max_worker_processes\".")));
+            continue;
+        }
+
+        if (WaitForBackgroundWorkerShutdown(handle) == BGWH_POSTMASTER_DIED)
+            proc_exit(1);
+    }
+    pfree(databases);
+
+    return !got_sigterm;
+}
+
+/*
+ * Main entry point of the worker loading the blocks of one database.
+ */
+void
+autoprewarm_database_main(Datum main_arg)
+{
+    BlockInfoRecord *block_info;
+    int64        num_elements;
+    int64        blocks_done = 0;
+
+    BackgroundWorkerUnblockSignals();
+    BackgroundWorkerInitializeConnectionByOid(DatumGetObjectId(main_arg),
+                                              InvalidOid);
+
+    StartTransactionCommand();
+    block_info = apw_read_file(&num_elements, true);
+    if (block_info != NULL)
+    {
+        blocks_done = apw_load_database(block_info, num_elements);
+        pfree(block_info);
+    }
+    CommitTransactionCommand();
+
+    ereport(LOG,
+            (errmsg("autoprewarm loaded " INT64_FORMAT " blocks of database %u",
+                    blocks_done, MyDatabaseId)));
+
+    proc_exit(0);
+}
+
+/*
+ * autoprewarm_dump_now()
+ *
+ * Write the list of the blocks of permanent relations currently in shared
+ * buffers to AUTOPREWARM_FILE in the data directory, and return the number
+ * of blocks written.  The file is reloaded by the autoprewarm worker at the
+ * next start, or can be copied to a standby of this server and loaded there
+ * with autoprewarm_load_now(), so that the standby has a warm buffer cache
+ * if it gets promoted.
+ */
+Datum
+autoprewarm_dump_now(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_INT64(apw_dump_now());
+}
+
+static int64
+apw_dump_now(void)
+{
+    BlockInfoRecord *block_info;
+    int64        num_blocks = 0;
+    char        transient_dump_file_path[MAXPGPATH];
+    FILE       *file;
+    int            i;
+
+    block_info = (BlockInfoRecord *)
+        palloc_extended((Size) NBuffers * sizeof(BlockInfoRecord),
+                        MCXT_ALLOC_HUGE);
+
+    for (i = 0; i < NBuffers; i++)
+    {
+        BufferDesc *bufHdr = GetBufferDescriptor(i);
+        uint32        buf_state;
+
+        CHECK_FOR_INTERRUPTS();
+
+        buf_state = LockBufHdr(bufHdr);
+
+        /* Blocks of unlogged relations do not exist on a standby. */
+        if ((buf_state & BM_TAG_VALID) && (buf_state & BM_PERMANENT))
+        {
+            block_info[num_blocks].database = bufHdr->tag.rnode.dbNode;
+            block_info[num_blocks].tablespace = bufHdr->tag.rnode.spcNode;
+            block_info[num_blocks].filenode = bufHdr->tag.rnode.relNode;
+            block_info[num_blocks].forknum = bufHdr->tag.forkNum;
+            block_info[num_blocks].blocknum = bufHdr->tag.blockNum;
+            block_info[num_blocks].usagecount = BUF_STATE_GET_USAGECOUNT(buf_state);
+            ++num_blocks;
+        }
+
+        UnlockBufHdr(bufHdr, buf_state);
+    }
+
+    snprintf(transient_dump_file_path, MAXPGPATH, "%s.tmp", AUTOPREWARM_FILE);
+    file = AllocateFile(transient_dump_file_path, "w");
+    if (!file)
+        ereport(ERROR,
+                (errcode_for_file_access(),
+                 errmsg("could not open file \"%s\": %m",
+                        transient_dump_file_path)));
+
+    fprintf(file, "<<" INT64_FORMAT ">>\n", num_blocks);
+    for (i = 0; i < num_blocks; i++)
+    {
+        CHECK_FOR_INTERRUPTS();
+
+        fprintf(file, "%u,%u,%u,%u,%u,%u\n",
+                block_info[i].database,
+                block_info[i].tablespace,
+                block_info[i].filenode,
+                (uint32) block_info[i].forknum,
+                block_info[i].blocknum,
+                block_info[i].usagecount);
+    }
+    pfree(block_info);
+
+    if (ferror(file) || FreeFile(file))
+    {
+        unlink(transient_dump_file_path);
+        ereport(ERROR,
+                (errcode_for_file_access(),
+                 errmsg("could not write file \"%s\": %m",
+                        transient_dump_file_path)));
+    }
+
+    (void) durable_rename(transient_dump_file_path, AUTOPREWARM_FILE, ERROR);
+
+    return num_blocks;
+}
+
+/*
+ * autoprewarm_load_now()
+ *
+ * Read the blocks listed in AUTOPREWARM_FILE into shared buffers, and return
+ * the number of blocks read.  Only the blocks of the relations of the
+ * current database and of shared relations are loaded, so this has to be
+ * run in every database to be prewarmed.  It works on a hot standby.
+ * Relations and blocks which no longer exist are skipped.
+ */
+Datum
+autoprewarm_load_now(PG_FUNCTION_ARGS)
+{
+    BlockInfoRecord *block_info;
+    int64        num_elements;
+    int64        blocks_done;
+
+    block_info = apw_read_file(&num_elements, false);
+    blocks_done = apw_load_database(block_info, num_elements);
+    pfree(block_info);
+
+    PG_RETURN_INT64(blocks_done);
+}
+
+/*
+ * Read the records of AUTOPREWARM_FILE. Returns NULL if the file does not
+ * exist and missing_ok is set.
+ */
+static BlockInfoRecord *
+apw_read_file(int64 *num_elements, bool missing_ok)
+{
+    FILE       *file;
+    BlockInfoRecord *block_info;
+    int64        i;
+
+    file = AllocateFile(AUTOPREWARM_FILE, "r");
+    if (!file)
+    {
+        if (missing_ok && errno == ENOENT)
+            return NULL;
+        ereport(ERROR,
+                (errcode_for_file_access(),
+                 errmsg("could not open file \"%s\": %m",
+                        AUTOPREWARM_FILE)));
+    }
+
+    if (fscanf(file, "<<" INT64_FORMAT ">>\n", num_elements) != 1 ||
+        *num_elements < 0 || *num_elements > NBuffers * (int64) 16)
+        ereport(ERROR,
+                (errcode(ERRCODE_DATA_CORRUPTED),
+                 errmsg("invalid header in file \"%s\"", AUTOPREWARM_FILE)));
+
+    block_info = (BlockInfoRecord *)
+        palloc_extended(Max(*num_elements, 1) * sizeof(BlockInfoRecord),
+                        MCXT_ALLOC_HUGE);
+
+    for (i = 0; i < *num_elements; i++)
+    {
+        uint32        forknum;
+
+        if (fscanf(file, "%u,%u,%u,%u,%u,%u\n", &block_info[i].database,
+                   &block_info[i].tablespace, &block_info[i].filenode,
+                   &forknum, &block_info[i].blocknum,
+                   &block_info[i].usagecount) != 6 ||
+            forknum > MAX_FORKNUM)
+            ereport(ERROR,
+                    (errcode(ERRCODE_DATA_CORRUPTED),
+                     errmsg("invalid block record " INT64_FORMAT " in file \"%s\"",
+                            i + 1, AUTOPREWARM_FILE)));
+        block_info[i].forknum = (ForkNumber) forknum;
+    }
+    FreeFile(file);
+
+    return block_info;
+}
+
+/*
+ * Read the listed blocks of the current database and of shared relations
+ * into shared buffers, the most used ones first, and each relation fork in
+ * block order.  Up to target_prefetch_pages reads are kept in flight ahead
+ * of the one waited for.
+ */
+static int64
+apw_load_database(BlockInfoRecord *block_info, int64 num_elements)
+{
+    int64        blocks_done = 0;
+    int64        i;
+    int64        j;
+
+    pg_qsort(block_info, num_elements, sizeof(BlockInfoRecord),
+             apw_compare_blockinfo);
+
+    for (i = 0; i < num_elements; i = j)
+    {
+        BlockInfoRecord *blk = &block_info[i];
+        Relation    rel;
+        Oid            reloid;
+
+        /* the run of records of the same relation */
+        for (j = i + 1; j < num_elements; j++)
+        {
+            if (block_info[j].usagecount != blk->usagecount ||
+                block_info[j].database != blk->database ||
+                block_info[j].tablespace != blk->tablespace ||
+                block_info[j].filenode != blk->filenode)
+                break;
+        }
+
+        if (blk->database != MyDatabaseId && blk->database != InvalidOid)
+            continue;
+
+        CHECK_FOR_INTERRUPTS();
+
+        reloid = RelidByRelfilenode(blk->tablespace, blk->filenode);
+        if (!OidIsValid(reloid))
+            continue;
+        rel = try_relation_open(reloid, AccessShareLock);
+        if (!rel)
+            continue;
+        RelationOpenSmgr(rel);
+
+        while (i < j)
+        {
+            ForkNumber    forknum = block_info[i].forknum;
+            BlockNumber nblocks = 0;
+            int64        end;
+            int64        prefetched;
+
+            if (smgrexists(rel->rd_smgr, forknum))
+                nblocks = RelationGetNumberOfBlocksInFork(rel, forknum);
+
+            for (end = i; end < j && block_info[end].forknum == forknum; end++)
+                ;
+
+            for (prefetched = i + 1; i < end; i++)
+            {
+                Buffer        buf;
+
+                CHECK_FOR_INTERRUPTS();
+
+                if (block_info[i].blocknum >= nblocks)
+                    continue;
+
+                while (prefetched < end &&
+                       prefetched <= i + target_prefetch_pages)
+                {
+                    if (block_info[prefetched].blocknum < nblocks)
+                        PrefetchBuffer(rel, forknum,
+                                       block_info[prefetched].blocknum);
+                    prefetched++;
+                }
+
+                buf = ReadBufferExtended(rel, forknum, block_info[i].blocknum,
+                                         RBM_NORMAL, NULL);
+                ReleaseBuffer(buf);
+                ++blocks_done;
+            }
+        }
+
+        relation_close(rel, AccessShareLock);
+    }
+
+    return blocks_done;
+}
+
+/*
+ * Comparator for sorting BlockInfoRecord objects, by decreasing usage count
+ * and then in physical order.
+ */
+static int
+apw_compare_blockinfo(const void *p, const void *q)
+{
+    const BlockInfoRecord *a = (const BlockInfoRecord *) p;
+    const BlockInfoRecord *b = (const BlockInfoRecord *) q;
+
+#define cmp_member_elem(fld)    \
+do { \
+    if (a->fld < b->fld)        \
+        return -1;                \
+    else if (a->fld > b->fld)    \
+        return 1;                \
+} while(0)
+
+    if (a->usagecount != b->usagecount)
+        return (a->usagecount > b->usagecount) ? -1 : 1;
+    cmp_member_elem(database);
+    cmp_member_elem(tablespace);
+    cmp_member_elem(filenode);
+    cmp_member_elem(forknum);
+    cmp_member_elem(blocknum);
+
+    return 0;
+}
@@ -0,0 +1,39 @@
+/* contrib/pg_stat_cluster_activity/pg_stat_cluster_activity--1.0--1.1.sql */
+
+-- complain if script is sourced in psql, rather than via ALTER EXTENSION
+\echo Use "ALTER EXTENSION pg_stat_cluster_activity UPDATE TO '1.1'" to load this file. \quit
+
+CREATE OR REPLACE FUNCTION pg_stat_get_cluster_samples(
+    sessionid text,
+    coordonly bool,
+    localonly bool,
+    OUT sessionid text,
+    OUT pid integer,
+    OUT nodename text,
+    OUT role text,
+    OUT wait_event_type text,
+    OUT wait_event text,
+    OUT state text,
+    OUT portal text,
+    OUT sample_time timestamptz
+)
+RETURNS SETOF record
+AS 'MODULE_PATHNAME'
+LANGUAGE C;
+
+CREATE OR REPLACE VIEW pg_stat_cluster_samples AS
+  SELECT * FROM pg_stat_get_cluster_samples(NULL, false, false);
+
+-- where each distributed session spent its sampled time, across all nodes
+CREATE OR REPLACE VIEW pg_stat_cluster_session_waits AS
+  SELECT sessionid, nodename, role,
+         coalesce(wait_event_type, 'CPU') AS wait_event_type,
+         coalesce(wait_event, 'CPU') AS wait_event,
+         count(*) AS samples,
+         min(sample_time) AS first_sample,
+         max(sample_time) AS last_sample
+    FROM pg_stat_get_cluster_samples(NULL, false, false)
+   GROUP BY 1, 2, 3, 4, 5;
+
+GRANT SELECT ON pg_stat_cluster_samples TO PUBLIC;
+GRANT SELECT ON pg_stat_cluster_session_waits TO PUBLIC;
@@ -14,10 +14,14 @@
 #include "pgxc/pgxc.h"
 #include "pgxc/squeue.h"
 #include "port/atomics.h"
+#include "postmaster/bgworker.h"
 #include "storage/ipc.h"
+#include "storage/latch.h"
 #include "storage/procarray.h"
 #include "storage/shmem.h"
 #include "utils/builtins.h"
+#include "utils/guc.h"
+#include "utils/memutils.h"
 #include "utils/portal.h"
 #include "utils/snapmgr.h"
 #include "utils/timestamp.h"
@@ -25,6 +29,7 @@
 PG_MODULE_MAGIC;
 
 #define PG_STAT_GET_ClUSTER_ACTIVITY_COLS 22
+#define PG_STAT_GET_ClUSTER_SAMPLES_COLS 9
 
 /* ----------
  * Total number of backends including auxiliary
@@ -94,6 +99,41 @@ typedef struct PgClusterStatus
 static PgClusterStatus *ClusterStatusArray = NULL;
 static PgClusterStatus *MyCSEntry = NULL;
 
+/*
+ * PgClusterSample is one observation of an active backend taken by the
+ * sampler worker, kept in a shared ring buffer and shown in view
+ * pg_stat_cluster_samples. Only the sampler writes the ring, readers use
+ * the same changecount protocol as PgClusterStatus on each slot.
+ */
+typedef struct PgClusterSample
+{
+	int changecount;
+	
+	TimestampTz sample_time;        /* 0 if the slot was never written */
+	int pid;
+	uint32 wait_event_info;
+	BackendState state;
+	char sessionid[NAMEDATALEN];
+	char role[NAMEDATALEN];
+	char portal[NAMEDATALEN];       /* identifies the plan fragment */
+} PgClusterSample;
+
+typedef struct PgClusterSampleRing
+{
+	uint64 next;                    /* total number of samples taken */
+	PgClusterSample samples[FLEXIBLE_ARRAY_MEMBER];
+} PgClusterSampleRing;
+
+static PgClusterSampleRing *ClusterSampleRing = NULL;
+
+/* GUC variables */
+static int pgcs_sample_interval = 0;        /* ms, 0 disables sampling */
+static int pgcs_sample_buffer_size = 16384; /* slots in the ring */
+
+/* flags set by signal handlers */
+static volatile sig_atomic_t got_sighup = false;
+static volatile sig_atomic_t got_sigterm = false;
+
 static shmem_startup_hook_type prev_shmem_startup_hook = NULL;
 static PortalStart_hook_type prev_PortalStart = NULL;
 static PortalDrop_hook_type prev_PortalDrop = NULL;
@@ -137,14 +177,17 @@ static ExecutorStart_hook_type prev_ExecutorStart = NULL;
 	} while (0)
 
 Datum pg_stat_get_cluster_activity(PG_FUNCTION_ARGS);
+Datum pg_stat_get_cluster_samples(PG_FUNCTION_ARGS);
 Datum pg_signal_session(PG_FUNCTION_ARGS);
 Datum pg_terminate_session(PG_FUNCTION_ARGS);
 Datum pg_cancel_session(PG_FUNCTION_ARGS);
 
 void _PG_init(void);
 void _PG_fini(void);
+void pgcs_sampler_main(Datum main_arg) pg_attribute_noreturn();
 
 PG_FUNCTION_INFO_V1(pg_stat_get_cluster_activity);
+PG_FUNCTION_INFO_V1(pg_stat_get_cluster_samples);
 PG_FUNCTION_INFO_V1(pg_signal_session);
 PG_FUNCTION_INFO_V1(pg_terminate_session);
 PG_FUNCTION_INFO_V1(pg_cancel_session);
@@ -195,6 +238,14 @@ CreateSharedClusterStatus(void)
 		 */
 		MemSet(ClusterStatusArray, 0, size);
 	}
+	
+	size = add_size(offsetof(PgClusterSampleRing, samples),
+	                mul_size(sizeof(PgClusterSample), pgcs_sample_buffer_size));
+	ClusterSampleRing = (PgClusterSampleRing *)
+		ShmemInitStruct("Cluster Sample Ring", size, &found);
+	
+	if (!found)
+		MemSet(ClusterSampleRing, 0, size);
 }
 
 /*
@@ -487,6 +538,143 @@ pgstat_fetch_stat_local_csentry(int beid)
 	return local;
 }
 
+/* ----------
+ * pgcs_take_samples
+ * 
+ *  Record one sample for every active backend into the ring buffer.
+ *  Idle sessions are skipped, so the ring only holds time spent working
+ *  or waiting on behalf of a query.
+ * ----------
+ */
+static void
+pgcs_take_samples(void)
+{
+	int              num_backends = pgstat_fetch_stat_numbackends();
+	int              curr_backend;
+	TimestampTz      now = GetCurrentTimestamp();
+	
+	for (curr_backend = 1; curr_backend <= num_backends; curr_backend++)
+	{
+		LocalPgBackendStatus *local_beentry;
+		PgBackendStatus *beentry;
+		PgClusterStatus *local_csentry;
+		volatile PgClusterSample *sample;
+		PGPROC	   *proc;
+		
+		local_beentry = pgstat_fetch_stat_local_beentry(curr_backend);
+		if (!local_beentry)
+			continue;
+		
+		beentry = &local_beentry->backendStatus;
+		if (beentry->st_procpid == MyProcPid ||
+		    (beentry->st_state != STATE_RUNNING &&
+		     beentry->st_state != STATE_FASTPATH))
+			continue;
+		
+		local_csentry = pgstat_fetch_stat_local_csentry(local_beentry->backend_id);
+		if (!local_csentry || !local_csentry->valid)
+			continue;
+		
+		proc = BackendPidGetProc(beentry->st_procpid);
+		
+		sample = &ClusterSampleRing->samples[ClusterSampleRing->next % pgcs_sample_buffer_size];
+		
+		increment_changecount_before(sample);
+		
+		sample->sample_time = now;
+		sample->pid = beentry->st_procpid;
+		sample->wait_event_info = proc ? UINT32_ACCESS_ONCE(proc->wait_event_info) : 0;
+		sample->state = beentry->st_state;
+		memcpy((char *) sample->sessionid, local_csentry->sessionid, NAMEDATALEN);
+		memcpy((char *) sample->role, local_csentry->role, NAMEDATALEN);
+		memcpy((char *) sample->portal, local_csentry->portal, NAMEDATALEN);
+		
+		increment_changecount_after(sample);
+		
+		ClusterSampleRing->next++;
+	}
+}
+
+static void
+pgcs_sampler_sigterm(SIGNAL_ARGS)
+{
+	int			save_errno = errno;
+	
+	got_sigterm = true;
+	SetLatch(MyLatch);
+	
+	errno = save_errno;
+}
+
+static void
+pgcs_sampler_sighup(SIGNAL_ARGS)
+{
+	int			save_errno = errno;
+	
+	got_sighup = true;
+	SetLatch(MyLatch);
+	
+	errno = save_errno;
+}
+
+/* ----------
+ * pgcs_sampler_main
+ * 
+ *  Entry point of the sampler background worker. Wakes up every
+ *  pg_stat_cluster_activity.sample_interval milliseconds and samples all
+ *  active backends of this node, sleeps while sampling is disabled.
+ * ----------
+ */
+void
+pgcs_sampler_main(Datum main_arg)
+{
+	MemoryContext sample_context;
+	
+	pqsignal(SIGHUP, pgcs_sampler_sighup);
+	pqsignal(SIGTERM, pgcs_sampler_sigterm);
+	BackgroundWorkerUnblockSignals();
+	
+	sample_context = AllocSetContextCreate(TopMemoryContext,
+	                                       "cluster sampler",
+	                                       ALLOCSET_DEFAULT_SIZES);
+	
+	while (!got_sigterm)
+	{
+		int			rc;
+		long        timeout = pgcs_sample_interval > 0 ? pgcs_sample_interval : 10000L;
+		
+		rc = WaitLatch(MyLatch,
+		               WL_LATCH_SET | WL_TIMEOUT | WL_POSTMASTER_DEATH,
+		               timeout,
+		               PG_WAIT_EXTENSION);
+		ResetLatch(MyLatch);
+		
+		/* emergency bailout if postmaster has died */
+		if (rc & WL_POSTMASTER_DEATH)
+			proc_exit(1);
+		
+		CHECK_FOR_INTERRUPTS();
+		
+		if (got_sighup)
+		{
+			got_sighup = false;
+			ProcessConfigFile(PGC_SIGHUP);
+		}
+		
+		if (pgcs_sample_interval <= 0)
+			continue;
+		
+		MemoryContextSwitchTo(sample_context);
+		pgcs_take_samples();
+		/* drop the backend status snapshot so the next pass sees fresh data */
+		pgstat_clear_snapshot();
+		MemoryContextSwitchTo(TopMemoryContext);
+		MemoryContextReset(sample_context);
+	}
+	
+	proc_exit(0);
+}
+
 /* ----------
  * pg_stat_get_remote_activity
  * 
@@ -495,7 +683,8 @@ pgstat_fetch_stat_local_csentry(int beid)
  * ----------
  */
 static void
-pg_stat_get_remote_activity(const char *sessionid, bool coordonly, Tuplestorestate *tupstore)
+pg_stat_get_remote_activity(const char *funcname, int ncols,
+                            const char *sessionid, bool coordonly, Tuplestorestate *tupstore)
 {
 #define QUERY_LEN 1024
 	char    query[QUERY_LEN];
@@ -508,13 +697,13 @@ pg_stat_get_remote_activity(const char *sessionid, bool coordonly, Tuplestoresta
 	TupleTableSlot		*result = NULL;
 	
 	/*
-	 * Here we call pg_stat_get_cluster_activity in remote with args:
+	 * Here we call funcname in remote with args:
 	 * coordonly = false, localonly = true, to prevent recursive calls in remote nodes.
 	 */
 	if (sessionid == NULL)
-		snprintf(query, QUERY_LEN, "select * from pg_stat_get_cluster_activity(NULL, false, true)");
+		snprintf(query, QUERY_LEN, "select * from %s(NULL, false, true)", funcname);
 	else
-		snprintf(query, QUERY_LEN, "select * from pg_stat_get_cluster_activity('%s', false, true)", sessionid);
+		snprintf(query, QUERY_LEN, "select * from %s('%s', false, true)", funcname, sessionid);
 	
 	plan = makeNode(RemoteQuery);
 	plan->combine_type = COMBINE_TYPE_NONE;
@@ -539,7 +728,7 @@ pg_stat_get_remote_activity(const char *sessionid, bool coordonly, Tuplestoresta
 	 * We only need the target entry to determine result data type.
 	 * So create dummy even if real expression is a function.
 	 */
-	for (i = 1; i <= PG_STAT_GET_ClUSTER_ACTIVITY_COLS; i++)
+	for (i = 1; i <= ncols; i++)
 	{
 		dummy = makeVar(1, i, TEXTOID, 0, InvalidOid, 0);
 		plan->scan.plan.targetlist = lappend(plan->scan.plan.targetlist,
@@ -626,7 +815,9 @@ pg_stat_get_cluster_activity(PG_FUNCTION_ARGS)
 	
 	/* dispatch query to remote if needed */
 	if (!localonly && IS_PGXC_COORDINATOR)
-		pg_stat_get_remote_activity(sessionid, coordonly, tupstore);
+		pg_stat_get_remote_activity("pg_stat_get_cluster_activity",
+		                            PG_STAT_GET_ClUSTER_ACTIVITY_COLS,
+		                            sessionid, coordonly, tupstore);
 	
 	/* 1-based index */
 	for (curr_backend = 1; curr_backend <= num_backends; curr_backend++)
@@ -890,6 +1081,131 @@ pg_stat_get_cluster_activity(PG_FUNCTION_ARGS)
 	return (Datum) 0;
 }
 
+/* ----------
+ * pg_stat_get_cluster_samples
+ * 
+ *  SRF showing the samples kept in the ring buffer of this node, and of
+ *  every other node unless localonly. Arguments are the same as for
+ *  pg_stat_get_cluster_activity.
+ * ----------
+ */
+Datum
+pg_stat_get_cluster_samples(PG_FUNCTION_ARGS)
+{
+	bool             with_sessionid = !PG_ARGISNULL(0);
+	bool             coordonly = PG_ARGISNULL(1) ? false : PG_GETARG_BOOL(1);
+	bool             localonly = PG_ARGISNULL(2) ? false : PG_GETARG_BOOL(2);
+	const char      *sessionid = with_sessionid ? text_to_cstring(PG_GETARG_TEXT_P(0)) : NULL;
+	ReturnSetInfo   *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	TupleDesc	     tupdesc;
+	Tuplestorestate *tupstore;
+	MemoryContext    per_query_ctx;
+	MemoryContext    oldcontext;
+	PgClusterSample  local;
+	int              i;
+	
+	if (ClusterSampleRing == NULL)
+		ereport(ERROR,
+		        (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			        errmsg("shared memory for pg_stat_cluster_activity is not prepared"),
+			        errhint("maybe you need to set shared_preload_libraries in postgresql.conf")));
+	
+	/* check to see if caller supports us returning a tuplestore */
+	if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo))
+		ereport(ERROR,
+		        (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			        errmsg("set-valued function called in context that cannot accept a set")));
+	if (!(rsinfo->allowedModes & SFRM_Materialize))
+		ereport(ERROR,
+		        (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			        errmsg("materialize mode required, but it is not " \
+						"allowed in this context")));
+	
+	/* Build a tuple descriptor for our result type */
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+	
+	/* switch to query's memory context to save results during execution */
+	per_query_ctx = rsinfo->econtext->ecxt_per_query_memory;
+	oldcontext = MemoryContextSwitchTo(per_query_ctx);
+	
+	tupstore = tuplestore_begin_heap(true, false, work_mem);
+	rsinfo->returnMode = SFRM_Materialize;
+	rsinfo->setResult = tupstore;
+	rsinfo->setDesc = tupdesc;
+	
+	MemoryContextSwitchTo(oldcontext);
+	
+	/* dispatch query to remote if needed */
+	if (!localonly && IS_PGXC_COORDINATOR)
+		pg_stat_get_remote_activity("pg_stat_get_cluster_samples",
+		                            PG_STAT_GET_ClUSTER_SAMPLES_COLS,
+		                            sessionid, coordonly, tupstore);
+	
+	for (i = 0; i < pgcs_sample_buffer_size; i++)
+	{
+		Datum		values[PG_STAT_GET_ClUSTER_SAMPLES_COLS];
+		bool		nulls[PG_STAT_GET_ClUSTER_SAMPLES_COLS];
+		PgClusterSample *sample = &ClusterSampleRing->samples[i];
+		const char *wait_event_type;
+		const char *wait_event;
+		
+		for (;;)
+		{
+			int			before_changecount;
+			int			after_changecount;
+			
+			save_changecount_before(sample, before_changecount);
+			memcpy(&local, sample, sizeof(PgClusterSample));
+			save_changecount_after(sample, after_changecount);
+			if (before_changecount == after_changecount &&
+			    (before_changecount & 1) == 0)
+				break;
+			
+			/* Make sure we can break out of loop if stuck... */
+			CHECK_FOR_INTERRUPTS();
+		}
+		
+		if (local.sample_time == 0)
+			continue;
+		
+		/* If looking for specific sessionid, ignore all the others */
+		if (with_sessionid && strcmp(sessionid, local.sessionid) != 0)
+			continue;
+		
+		MemSet(values, 0, sizeof(values));
+		MemSet(nulls, 0, sizeof(nulls));
+		
+		values[0] = CStringGetTextDatum(local.sessionid);
+		values[1] = Int32GetDatum(local.pid);
+		values[2] = CStringGetTextDatum(PGXCNodeName);
+		values[3] = CStringGetTextDatum(local.role);
+		
+		wait_event_type = pgstat_get_wait_event_type(local.wait_event_info);
+		wait_event = pgstat_get_wait_event(local.wait_event_info);
+		if (wait_event_type)
+			values[4] = CStringGetTextDatum(wait_event_type);
+		else
+			nulls[4] = true;
+		if (wait_event)
+			values[5] = CStringGetTextDatum(wait_event);
+		else
+			nulls[5] = true;
+		
+		values[6] = CStringGetTextDatum(local.state == STATE_FASTPATH ?
+		                                "fastpath function call" : "active");
+		values[7] = CStringGetTextDatum(local.portal);
+		values[8] = TimestampTzGetDatum(local.sample_time);
+		
+		tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+	}
+	
+	/* clean up and return the tuplestore */
+	tuplestore_donestoring(tupstore);
+	
+	return (Datum) 0;
+}
+
 static bool
 pgcs_signal_session_remote(const char *sessionid, int signal)
 {
@@ -1027,7 +1343,13 @@ pgcs_shmem_startup(void)
 static Size
 pgcs_memsize(void)
 {
-	return mul_size(sizeof(PgClusterStatus), NumBackendStatSlots);
+	Size size;
+	
+	size = mul_size(sizeof(PgClusterStatus), NumBackendStatSlots);
+	size = add_size(size, offsetof(PgClusterSampleRing, samples));
+	size = add_size(size, mul_size(sizeof(PgClusterSample), pgcs_sample_buffer_size));
+	
+	return size;
 }
 
 /*
@@ -1036,9 +1358,39 @@ pgcs_memsize(void)
 void
 _PG_init(void)
 {
+	BackgroundWorker worker;
+	
 	if (!process_shared_preload_libraries_in_progress)
 		return;
 	
+	DefineCustomIntVariable("pg_stat_cluster_activity.sample_interval",
+	                        "Sets the interval between two samples of active backends.",
+	                        "Zero disables sampling.",
+	                        &pgcs_sample_interval,
+	                        0,
+	                        0,
+	                        60000,
+	                        PGC_SIGHUP,
+	                        GUC_UNIT_MS,
+	                        NULL,
+	                        NULL,
+	                        NULL);
+	
+	DefineCustomIntVariable("pg_stat_cluster_activity.sample_buffer_size",
+	                        "Sets the number of samples kept on each node.",
+	                        NULL,
+	                        &pgcs_sample_buffer_size,
+	                        16384,
+	                        1024,
+	                        INT_MAX / 1024,
+	                        PGC_POSTMASTER,
+	                        0,
+	                        NULL,
+	                        NULL,
+	                        NULL);
+	
+	EmitWarningsOnPlaceholders("pg_stat_cluster_activity");
+	
 	/*
 	 * Request additional shared resources.  (These are no-ops if we're not in
 	 * the postmaster process.)  We'll allocate or attach to the shared
@@ -1057,6 +1409,21 @@ _PG_init(void)
 	PortalDrop_hook = pgcs_report_activity;
 	prev_ExecutorStart = ExecutorStart_hook;
 	ExecutorStart_hook = pgcs_report_query_activity;
+	
+	/*
+	 * Register the sampler, it sleeps while sample_interval is zero so that
+	 * sampling can be switched on with a reload.
+	 */
+	memset(&worker, 0, sizeof(worker));
+	worker.bgw_flags = BGWORKER_SHMEM_ACCESS;
+	worker.bgw_start_time = BgWorkerStart_ConsistentState;
+	worker.bgw_restart_time = 10;
+	sprintf(worker.bgw_library_name, "pg_stat_cluster_activity");
+	sprintf(worker.bgw_function_name, "pgcs_sampler_main");
+	snprintf(worker.bgw_name, BGW_MAXLEN, "pg_stat_cluster_activity sampler");
+	worker.bgw_main_arg = (Datum) 0;
+	worker.bgw_notify_pid = 0;
+	RegisterBackgroundWorker(&worker);
 }
 
 /*
@@ -559,6 +559,100 @@ cmd_t *prepare_startDatanodeSlave(char *nodeName)
     return(cmd);
 }
 
+/*
+ * Prewarm datanode slaves ------------------------------------------------
+ *
+ * Copies the list of the blocks in the buffer cache of the master to the
+ * slave and loads them there in every database, with the functions of
+ * pg_prewarm, so that the slave does not start cold after a failover.  Meant
+ * to be run periodically; pg_prewarm must be installed in the databases.
+ */
+int prewarm_datanode_slave_all(void)
+{
+    elog(INFO, "Prewarming all the datanode slaves.\n");
+    return(prewarm_datanode_slave(aval(VAR_datanodeNames)));
+}
+
+cmd_t *prepare_prewarmDatanodeSlave(char *nodeName)
+{
+    cmd_t *cmd, *cmdDump, *cmdCopy, *cmdLoad;
+    int idx;
+
+    if ((idx = datanodeIdx(nodeName)) < 0)
+    {
+        elog(WARNING, "WARNING: node %s is not a datanode. Skipping\n", nodeName);
+        return(NULL);
+    }
+    if (!doesExist(VAR_datanodeSlaveServers, idx) || is_none(aval(VAR_datanodeSlaveServers)[idx]))
+    {
+        elog(WARNING, "WARNING: slave not configured for datanode %s\n", nodeName);
+        return(NULL);
+    }
+    if (pingNode(aval(VAR_datanodeMasterServers)[idx], aval(VAR_datanodePorts)[idx]) != 0 ||
+        pingNode(aval(VAR_datanodeSlaveServers)[idx], aval(VAR_datanodeSlavePorts)[idx]) != 0)
+    {
+        elog(WARNING, "WARNING: master or slave of the datanode %s is not running. Skipping\n", nodeName);
+        return(NULL);
+    }
+
+    /* Dump the block list at the master */
+    cmd = cmdDump = initCmd(aval(VAR_datanodeMasterServers)[idx]);
+    snprintf(newCommand(cmdDump), MAXLINE,
+             "psql -p %s -d %s -c 'SELECT autoprewarm_dump_now()'",
+             aval(VAR_datanodePorts)[idx], sval(VAR_defaultDatabase));
+
+    /*
+     * Copy it to the slave through this host, under another name so that the
+     * autoprewarm worker of the slave never reads a partial file
+     */
+    appendCmdEl(cmdDump, (cmdCopy = initCmd(NULL)));
+    snprintf(newCommand(cmdCopy), MAXLINE,
+             "scp -3 %s@%s:%s/autoprewarm.blocks %s@%s:%s/autoprewarm.blocks.copy",
+             sval(VAR_pgxcUser), aval(VAR_datanodeMasterServers)[idx],
+             aval(VAR_datanodeMasterDirs)[idx],
+             sval(VAR_pgxcUser), aval(VAR_datanodeSlaveServers)[idx],
+             aval(VAR_datanodeSlaveDirs)[idx]);
+
+    /* Load it at the slave, in every database */
+    appendCmdEl(cmdDump, (cmdLoad = initCmd(aval(VAR_datanodeSlaveServers)[idx])));
+    snprintf(newCommand(cmdLoad), MAXLINE,
+             "mv %s/autoprewarm.blocks.copy %s/autoprewarm.blocks && "
+             "psql -p %s -d %s -Atc 'SELECT datname FROM pg_database WHERE datallowconn' | "
+             "xargs -I{} psql -p %s -d {} -c 'SELECT autoprewarm_load_now()'",
+             aval(VAR_datanodeSlaveDirs)[idx], aval(VAR_datanodeSlaveDirs)[idx],
+             aval(VAR_datanodeSlavePorts)[idx], sval(VAR_defaultDatabase),
+             aval(VAR_datanodeSlavePorts)[idx]);
+    return(cmd);
+}
+
+int prewarm_datanode_slave(char **nodeList)
+{
+    int ii;
+    int rc;
+    cmdList_t *cmdList;
+    cmd_t *cmd;
+    char **actualNodeList;
+
+    if (!isVarYes(VAR_datanodeSlave))
+    {
+        elog(ERROR, "ERROR: datanode slave is not configured.\n");
+        return 1;
+    }
+    actualNodeList = makeActualNodeList(nodeList);
+    cmdList = initCmdList();
+    for (ii = 0; actualNodeList[ii]; ii++)
+    {
+        elog(INFO, "Prewarming datanode slave %s.\n", actualNodeList[ii]);
+        if ((cmd = prepare_prewarmDatanodeSlave(actualNodeList[ii])))
+            addCmd(cmdList, cmd);
+    }
+    rc = doCmdList(cmdList);
+    cleanCmdList(cmdList);
+    CleanArray(actualNodeList);
+    elog(INFO, "Done.\n");
+    return(rc);
+}
+
 int start_datanode_slave(char **nodeList)
 {
     int ii;
@@ -916,7 +1010,7 @@ static int failover_oneDatanode(int datanodeIdx)
         }
         
         len = snprintf(cmd + cmdlen, MAXLINE - cmdlen, "EXECUTE DIRECT ON (%s) 'ALTER NODE %s WITH (HOST=''%s'', PORT=%s)';\n"
-                "EXECUTE DIRECT ON (%s) 'select pgxc_pool_reload()';\n",
+                "EXECUTE DIRECT ON (%s) 'select case when pgxc_pool_refresh() then true else pgxc_pool_reload() end';\n",
                                  aval(VAR_datanodeNames)[jj],
                                  aval(VAR_datanodeNames)[datanodeIdx],
                                  aval(VAR_datanodeMasterServers)[datanodeIdx],
@@ -954,9 +1048,13 @@ static int failover_oneDatanode(int datanodeIdx)
             elog(ERROR, "ERROR: failed to start psql for coordinator %s, %s\n", aval(VAR_coordNames)[jj], strerror(errno));
             continue;
         }
+        /*
+         * Only the connections to the failed node are redirected, the pools
+         * of the others are kept.
+         */
         fprintf(f,
                 "ALTER NODE %s WITH (HOST='%s', PORT=%s);\n"
-                "select pgxc_pool_reload();\n"
+                "select case when pgxc_pool_refresh() then true else pgxc_pool_reload() end;\n"
                 "%s"
                 "\\q\n",
                 aval(VAR_datanodeNames)[datanodeIdx],
@@ -37,6 +37,10 @@ extern cmd_t *prepare_stopDatanodeMaster(char *nodeName, char *immediate);
 
 extern int failover_datanode(char **nodeList);
 
+extern int prewarm_datanode_slave(char **nodeList);
+extern int prewarm_datanode_slave_all(void);
+extern cmd_t *prepare_prewarmDatanodeSlave(char *nodeName);
+
 extern int kill_datanode_master(char **nodeList);
 extern int kill_datanode_master_all(void);
 extern int kill_datanode_slave(char **nodeList);
@@ -65,6 +65,17 @@ static void do_stop_command(char *line);
 static void stop_all(char *immediate);
 static int show_Resource(char *datanodeName, char *databasename, char *username);
 static void do_show_help(char *line);
+static void do_backup_command(char *line);
+static void do_prewarm_command(char *line);
+static void do_upgrade_command(char *line);
+static int selectCoordinator(void);
+static cmd_t *prepare_backupNode(char *name, char *host, char *port,
+                                 char *backupDir, char *maxRate);
+static cmd_t *prepare_upgradeNode(char *name, char *nodeType, char *host,
+                                  char *port, char *dir, char *walDir,
+                                  char *oldBinDir, char *jobs);
+static cmd_t *prepare_swapUpgradedNode(char *host, char *dir, char *walDir);
+static char *datanodeMasterWALDir(int idx);
 
 typedef enum ConfigType
 {
@@ -310,6 +321,34 @@ static void do_failover_command(char *line)
         elog(ERROR, "ERROR: invalid failover command option %s.\n", token);
 }
 
+/*
+ * Prewarm command ... prewarm datanode [all | nodename ... ]
+ */
+static void do_prewarm_command(char *line)
+{
+    char *token;
+
+    if (GetToken() == NULL || !TestToken("datanode"))
+    {
+        elog(ERROR, "ERROR: Please specify prewarm datanode command option.\n");
+        return;
+    }
+    if (!isVarYes(VAR_datanodeSlave))
+        elog(ERROR, "ERROR: datanode slave is not configured.\n");
+    else if (!GetToken() || TestToken("all"))
+        prewarm_datanode_slave_all();
+    else
+    {
+        char **nodeList = NULL;
+
+        do
+            AddMember(nodeList, token);
+        while (GetToken());
+        prewarm_datanode_slave(nodeList);
+        CleanArray(nodeList);
+    }
+}
+
 /*
  * Reconnect command ... reconnect gtm_proxy [all | nodename ... ]
  */
@@ -700,15 +739,59 @@ static void do_init_command(char *line)
  */
 static void start_all(void)
 {
+    cmdList_t *cmdList;
+    cmd_t *cmd;
+    int ii;
+
     start_gtm_master();
-    if (isVarYes(VAR_gtmSlave))
-        start_gtm_slave();
+
+    /* GTM slave and proxies depend only on the GTM master */
+    cmdList = initCmdList();
+    if (isVarYes(VAR_gtmSlave) && (cmd = prepare_startGtmSlave()))
+        addCmd(cmdList, cmd);
     if (isVarYes(VAR_gtmProxy))
-        start_gtm_proxy_all();
+    {
+        for (ii = 0; aval(VAR_gtmProxyNames)[ii]; ii++)
+        {
+            if (is_none(aval(VAR_gtmProxyNames)[ii]))
+                continue;
+            elog(NOTICE, "Starting gtm proxy %s.\n", aval(VAR_gtmProxyNames)[ii]);
+            if ((cmd = prepare_startGtmProxy(aval(VAR_gtmProxyNames)[ii])))
+                addCmd(cmdList, cmd);
+        }
+    }
+    doCmdList(cmdList);
+    cleanCmdList(cmdList);
+
     start_coordinator_master_all();
+
+    /*
+     * Coordinator slaves need only their masters, and datanode masters need
+     * only the GTM, so they can be started together.
+     */
+    cmdList = initCmdList();
     if (isVarYes(VAR_coordSlave))
-        start_coordinator_slave_all();
-    start_datanode_master_all();
+    {
+        for (ii = 0; aval(VAR_coordNames)[ii]; ii++)
+        {
+            if (is_none(aval(VAR_coordNames)[ii]) || is_none(aval(VAR_coordSlaveServers)[ii]))
+                continue;
+            elog(INFO, "Starting coordinator slave %s.\n", aval(VAR_coordNames)[ii]);
+            if ((cmd = prepare_startCoordinatorSlave(aval(VAR_coordNames)[ii])))
+                addCmd(cmdList, cmd);
+        }
+    }
+    for (ii = 0; aval(VAR_datanodeNames)[ii]; ii++)
+    {
+        if (is_none(aval(VAR_datanodeNames)[ii]))
+            continue;
+        elog(INFO, "Starting datanode master %s.\n", aval(VAR_datanodeNames)[ii]);
+        if ((cmd = prepare_startDatanodeMaster(aval(VAR_datanodeNames)[ii])))
+            addCmd(cmdList, cmd);
+    }
+    doCmdList(cmdList);
+    cleanCmdList(cmdList);
+
     if (isVarYes(VAR_datanodeSlave))
         start_datanode_slave_all();
 }
@@ -1303,6 +1386,421 @@ static void do_stop_command(char *line)
     return;
 }
 
+/*
+ * Backup command
+ *
+ * backup [ -r max_rate ] directory
+ *
+ * Takes base backups of all the coordinator and datanode masters in
+ * parallel, each with pg_basebackup run on the host of the node and written
+ * to directory/nodename there, compressed and throttled to max_rate.  When
+ * all of them are done, a barrier is created and its id is recorded next to
+ * every backup: recovering each node to this barrier from its backup and
+ * archived WAL brings the cluster back to one consistent point.  The GTM
+ * directory is copied last, so its global timestamp is ahead of the barrier.
+ */
+static cmd_t *prepare_backupNode(char *name, char *host, char *port,
+                                 char *backupDir, char *maxRate)
+{
+    cmd_t *cmd;
+    char rateOpt[MAXTOKEN+1];
+
+    rateOpt[0] = 0;
+    if (maxRate)
+        snprintf(rateOpt, MAXTOKEN, "--max-rate=%s", maxRate);
+
+    cmd = initCmd(host);
+    snprintf(newCommand(cmd), MAXLINE,
+             "rm -rf %s/%s;"
+             "mkdir -p %s/%s;"
+             "pg_basebackup -U %s -p %s -h %s -D %s/%s -Ft -z --wal-method=stream %s",
+             backupDir, name,
+             backupDir, name,
+             sval(VAR_pgxcOwner), port, host, backupDir, name, rateOpt);
+    return(cmd);
+}
+
+static void do_backup_command(char *line)
+{
+    char *token;
+    char *maxRate = NULL;
+    char *backupDir;
+    char barrierId[MAXTOKEN+1];
+    char date[MAXTOKEN+1];
+    cmdList_t *cmdList;
+    cmd_t *cmd;
+    FILE *f;
+    int ii;
+    int rc;
+
+    if (GetToken() && TestToken("-r"))
+    {
+        if (!GetToken())
+        {
+            elog(ERROR, "ERROR: please specify the maximum transfer rate after -r.\n");
+            return;
+        }
+        maxRate = Strdup(token);
+        GetToken();
+    }
+    if (token == NULL)
+    {
+        elog(ERROR, "ERROR: please specify the backup directory.\n");
+        Free(maxRate);
+        return;
+    }
+    backupDir = Strdup(token);
+
+    /* Every master must be running to be backed up */
+    for (ii = 0; aval(VAR_coordNames)[ii]; ii++)
+    {
+        if (is_none(aval(VAR_coordNames)[ii]))
+            continue;
+        if (pingNode(aval(VAR_coordMasterServers)[ii], aval(VAR_coordPorts)[ii]) != 0)
+        {
+            elog(ERROR, "ERROR: coordinator master %s is not running, cannot take the backup.\n",
+                 aval(VAR_coordNames)[ii]);
+            goto done;
+        }
+    }
+    for (ii = 0; aval(VAR_datanodeNames)[ii]; ii++)
+    {
+        if (is_none(aval(VAR_datanodeNames)[ii]))
+            continue;
+        if (pingNode(aval(VAR_datanodeMasterServers)[ii], aval(VAR_datanodePorts)[ii]) != 0)
+        {
+            elog(ERROR, "ERROR: datanode master %s is not running, cannot take the backup.\n",
+                 aval(VAR_datanodeNames)[ii]);
+            goto done;
+        }
+    }
+
+    elog(INFO, "Taking base backups of all the nodes to %s\n", backupDir);
+    cmdList = initCmdList();
+    for (ii = 0; aval(VAR_coordNames)[ii]; ii++)
+    {
+        if (is_none(aval(VAR_coordNames)[ii]))
+            continue;
+        if ((cmd = prepare_backupNode(aval(VAR_coordNames)[ii],
+                                      aval(VAR_coordMasterServers)[ii],
+                                      aval(VAR_coordPorts)[ii],
+                                      backupDir, maxRate)))
+            addCmd(cmdList, cmd);
+    }
+    for (ii = 0; aval(VAR_datanodeNames)[ii]; ii++)
+    {
+        if (is_none(aval(VAR_datanodeNames)[ii]))
+            continue;
+        if ((cmd = prepare_backupNode(aval(VAR_datanodeNames)[ii],
+                                      aval(VAR_datanodeMasterServers)[ii],
+                                      aval(VAR_datanodePorts)[ii],
+                                      backupDir, maxRate)))
+            addCmd(cmdList, cmd);
+    }
+    rc = doCmdList(cmdList);
+    cleanCmdList(cmdList);
+    if (rc != 0)
+    {
+        elog(ERROR, "ERROR: base backup failed on some of the nodes.\n");
+        goto done;
+    }
+
+    /*
+     * The barrier must follow the end of every backup, so that recovery of
+     * each node can reach it.
+     */
+    ii = selectCoordinator();
+    snprintf(barrierId, MAXTOKEN, "backup_%s", timeStampString(date, MAXTOKEN));
+    if ((f = pgxc_popen_wRaw("psql -h %s -p %d %s",
+                             aval(VAR_coordMasterServers)[ii],
+                             atoi(aval(VAR_coordPorts)[ii]),
+                             sval(VAR_defaultDatabase))) == NULL)
+    {
+        elog(ERROR, "ERROR: cannot connect to the coordinator master %s.\n", aval(VAR_coordNames)[ii]);
+        goto done;
+    }
+    fprintf(f, "CREATE BARRIER '%s';\n", barrierId);
+    fprintf(f, "\\q\n");
+    if (pclose(f) != 0)
+    {
+        elog(ERROR, "ERROR: failed to create barrier %s.\n", barrierId);
+        goto done;
+    }
+    elog(NOTICE, "Created barrier %s\n", barrierId);
+
+    cmdList = initCmdList();
+    for (ii = 0; aval(VAR_coordNames)[ii]; ii++)
+    {
+        if (is_none(aval(VAR_coordNames)[ii]))
+            continue;
+        cmd = initCmd(aval(VAR_coordMasterServers)[ii]);
+        snprintf(newCommand(cmd), MAXLINE,
+                 "echo \"recovery_target_barrier = '%s'\" > %s/%s/barrier_id",
+                 barrierId, backupDir, aval(VAR_coordNames)[ii]);
+        addCmd(cmdList, cmd);
+    }
+    for (ii = 0; aval(VAR_datanodeNames)[ii]; ii++)
+    {
+        if (is_none(aval(VAR_datanodeNames)[ii]))
+            continue;
+        cmd = initCmd(aval(VAR_datanodeMasterServers)[ii]);
+        snprintf(newCommand(cmd), MAXLINE,
+                 "echo \"recovery_target_barrier = '%s'\" > %s/%s/barrier_id",
+                 barrierId, backupDir, aval(VAR_datanodeNames)[ii]);
+        addCmd(cmdList, cmd);
+    }
+    if (!is_none(sval(VAR_gtmMasterServer)))
+    {
+        cmd = initCmd(sval(VAR_gtmMasterServer));
+        snprintf(newCommand(cmd), MAXLINE,
+                 "rm -rf %s/%s;"
+                 "mkdir -p %s/%s;"
+                 "tar czf %s/%s/gtm.tar.gz --exclude=gtm.pid -C %s .;"
+                 "echo \"recovery_target_barrier = '%s'\" > %s/%s/barrier_id",
+                 backupDir, sval(VAR_gtmName),
+                 backupDir, sval(VAR_gtmName),
+                 backupDir, sval(VAR_gtmName), sval(VAR_gtmMasterDir),
+                 barrierId, backupDir, sval(VAR_gtmName));
+        addCmd(cmdList, cmd);
+    }
+    rc = doCmdList(cmdList);
+    cleanCmdList(cmdList);
+    if (rc != 0)
+        elog(ERROR, "ERROR: failed to record barrier %s with some of the backups.\n", barrierId);
+    else
+        elog(INFO, "Done, backup is consistent at barrier %s.\n", barrierId);
+
+done:
+    Free(backupDir);
+    Free(maxRate);
+}
+
+/*
+ * Upgrade command
+ *
+ * upgrade [ -j jobs ] old_bindir
+ *
+ * Upgrades the coordinator and datanode masters, stopped beforehand, to the
+ * binaries deployed in pgxcInstallDir, with old_bindir holding the previous
+ * ones on every host.  pg_upgrade runs on all the nodes at once, each in
+ * link mode against a fresh cluster initialized next to its directory, with
+ * jobs databases in parallel.  Only when every node succeeded are the new
+ * directories swapped in, the old ones being kept as dir.old.  The GTM
+ * store has no on-disk version and is carried over as it is: it is archived
+ * and the GTM restarted on the new binaries first, as the nodes need it.
+ */
+static cmd_t *prepare_upgradeNode(char *name, char *nodeType, char *host,
+                                  char *port, char *dir, char *walDir,
+                                  char *oldBinDir, char *jobs)
+{
+    cmd_t *cmd, *cmdConf, *cmdUpgrade;
+    char walOpt[MAXPATH+16];
+
+    walOpt[0] = 0;
+    if (walDir)
+        snprintf(walOpt, sizeof(walOpt), "-X %s.new", walDir);
+
+    cmd = initCmd(host);
+    snprintf(newCommand(cmd), MAXLINE,
+             "rm -rf %s.new %s.upgrade %s%s;"
+             "mkdir -p %s.upgrade;"
+             "PGXC_CTL_SILENT=1 initdb --nodename %s --nodetype %s %s -D %s.new "
+             "--master_gtm_nodename %s --master_gtm_ip %s --master_gtm_port %s",
+             dir, dir, walDir ? walDir : "", walDir ? ".new" : "",
+             dir,
+             name, nodeType, walOpt, dir,
+             sval(VAR_gtmName),
+             sval(VAR_gtmMasterServer),
+             sval(VAR_gtmMasterPort));
+
+    appendCmdEl(cmd, (cmdConf = initCmd(host)));
+    snprintf(newCommand(cmdConf), MAXLINE,
+             "cp %s/postgresql.conf %s/pg_hba.conf %s.new/",
+             dir, dir, dir);
+
+    /*
+     * Nodes sharing a host use their own port and working directory, which
+     * pg_upgrade fills with its logs and dumps.
+     */
+    appendCmdEl(cmd, (cmdUpgrade = initCmd(host)));
+    snprintf(newCommand(cmdUpgrade), MAXLINE,
+             "cd %s.upgrade && "
+             "pg_upgrade --link -j %s -U %s -p %s -P %s "
+             "-b %s -B %s/bin -d %s -D %s.new",
+             dir,
+             jobs, sval(VAR_pgxcOwner), port, port,
+             oldBinDir, sval(VAR_pgxcInstallDir), dir, dir);
+    return(cmd);
+}
+
+/*
+ * Put the upgraded directories in place of the old ones, pointing pg_wal of
+ * the new cluster to the final location of its WAL directory.
+ */
+static cmd_t *prepare_swapUpgradedNode(char *host, char *dir, char *walDir)
+{
+    cmd_t *cmd, *cmdWal;
+
+    cmd = initCmd(host);
+    snprintf(newCommand(cmd), MAXLINE,
+             "rm -rf %s.old; mv %s %s.old && mv %s.new %s",
+             dir, dir, dir, dir, dir);
+    if (walDir)
+    {
+        appendCmdEl(cmd, (cmdWal = initCmd(host)));
+        snprintf(newCommand(cmdWal), MAXLINE,
+                 "rm -rf %s.old; mv %s %s.old && mv %s.new %s && ln -sfn %s %s/pg_wal",
+                 walDir, walDir, walDir, walDir, walDir, walDir, dir);
+    }
+    return(cmd);
+}
+
+static char *datanodeMasterWALDir(int idx)
+{
+    if (doesExist(VAR_datanodeMasterWALDirs, idx) &&
+        aval(VAR_datanodeMasterWALDirs)[idx] &&
+        !is_none(aval(VAR_datanodeMasterWALDirs)[idx]))
+        return(aval(VAR_datanodeMasterWALDirs)[idx]);
+    return(NULL);
+}
+
+static void do_upgrade_command(char *line)
+{
+    char *token;
+    char *jobs = NULL;
+    char *oldBinDir;
+    cmdList_t *cmdList;
+    cmd_t *cmd;
+    int ii;
+    int rc;
+
+    if (GetToken() && TestToken("-j"))
+    {
+        if (!GetToken())
+        {
+            elog(ERROR, "ERROR: please specify the number of jobs after -j.\n");
+            return;
+        }
+        jobs = Strdup(token);
+        GetToken();
+    }
+    if (token == NULL)
+    {
+        elog(ERROR, "ERROR: please specify the directory of the old binaries.\n");
+        Free(jobs);
+        return;
+    }
+    oldBinDir = Strdup(token);
+    if (jobs == NULL)
+        jobs = Strdup("1");
+
+    /* pg_upgrade needs the old clusters down */
+    for (ii = 0; aval(VAR_coordNames)[ii]; ii++)
+    {
+        if (is_none(aval(VAR_coordNames)[ii]))
+            continue;
+        if (pingNode(aval(VAR_coordMasterServers)[ii], aval(VAR_coordPorts)[ii]) == 0)
+        {
+            elog(ERROR, "ERROR: coordinator master %s is running, stop it before the upgrade.\n",
+                 aval(VAR_coordNames)[ii]);
+            goto done;
+        }
+    }
+    for (ii = 0; aval(VAR_datanodeNames)[ii]; ii++)
+    {
+        if (is_none(aval(VAR_datanodeNames)[ii]))
+            continue;
+        if (pingNode(aval(VAR_datanodeMasterServers)[ii], aval(VAR_datanodePorts)[ii]) == 0)
+        {
+            elog(ERROR, "ERROR: datanode master %s is running, stop it before the upgrade.\n",
+                 aval(VAR_datanodeNames)[ii]);
+            goto done;
+        }
+    }
+
+    elog(INFO, "Archiving the GTM store and restarting the GTM master.\n");
+    if (isVarYes(VAR_gtmProxy))
+        stop_gtm_proxy_all();
+    cmdList = initCmdList();
+    cmd = initCmd(sval(VAR_gtmMasterServer));
+    snprintf(newCommand(cmd), MAXLINE,
+             "[ -f %s/gtm.pid ] && gtm_ctl stop -Z gtm -D %s;"
+             "tar czf %s.pre_upgrade.tar.gz --exclude=gtm.pid -C %s .",
+             sval(VAR_gtmMasterDir), sval(VAR_gtmMasterDir),
+             sval(VAR_gtmMasterDir), sval(VAR_gtmMasterDir));
+    appendCmdEl(cmd, prepare_startGtmMaster());
+    addCmd(cmdList, cmd);
+    rc = doCmdList(cmdList);
+    cleanCmdList(cmdList);
+    if (rc != 0)
+    {
+        elog(ERROR, "ERROR: failed to restart the GTM master.\n");
+        goto done;
+    }
+    if (isVarYes(VAR_gtmProxy))
+        start_gtm_proxy_all();
+
+    elog(INFO, "Upgrading all the coordinator and datanode masters.\n");
+    cmdList = initCmdList();
+    for (ii = 0; aval(VAR_coordNames)[ii]; ii++)
+    {
+        if (is_none(aval(VAR_coordNames)[ii]))
+            continue;
+        addCmd(cmdList, prepare_upgradeNode(aval(VAR_coordNames)[ii], "coordinator",
+                                            aval(VAR_coordMasterServers)[ii],
+                                            aval(VAR_coordPorts)[ii],
+                                            aval(VAR_coordMasterDirs)[ii],
+                                            NULL, oldBinDir, jobs));
+    }
+    for (ii = 0; aval(VAR_datanodeNames)[ii]; ii++)
+    {
+        if (is_none(aval(VAR_datanodeNames)[ii]))
+            continue;
+        addCmd(cmdList, prepare_upgradeNode(aval(VAR_datanodeNames)[ii], "datanode",
+                                            aval(VAR_datanodeMasterServers)[ii],
+                                            aval(VAR_datanodePorts)[ii],
+                                            aval(VAR_datanodeMasterDirs)[ii],
+                                            datanodeMasterWALDir(ii),
+                                            oldBinDir, jobs));
+    }
+    rc = doCmdList(cmdList);
+    cleanCmdList(cmdList);
+    if (rc != 0)
+    {
+        elog(ERROR, "ERROR: pg_upgrade failed on some of the nodes, see dir.upgrade of each node. "
+             "The old directories are still in place.\n");
+        goto done;
+    }
+
+    cmdList = initCmdList();
+    for (ii = 0; aval(VAR_coordNames)[ii]; ii++)
+    {
+        if (is_none(aval(VAR_coordNames)[ii]))
+            continue;
+        addCmd(cmdList, prepare_swapUpgradedNode(aval(VAR_coordMasterServers)[ii],
+                                                 aval(VAR_coordMasterDirs)[ii],
+                                                 NULL));
+    }
+    for (ii = 0; aval(VAR_datanodeNames)[ii]; ii++)
+    {
+        if (is_none(aval(VAR_datanodeNames)[ii]))
+            continue;
+        addCmd(cmdList, prepare_swapUpgradedNode(aval(VAR_datanodeMasterServers)[ii],
+                                                 aval(VAR_datanodeMasterDirs)[ii],
+                                                 datanodeMasterWALDir(ii)));
+    }
+    rc = doCmdList(cmdList);
+    cleanCmdList(cmdList);
+    if (rc != 0)
+        elog(ERROR, "ERROR: failed to move the upgraded directories in place on some of the nodes.\n");
+    else
+        elog(INFO, "Done. Start the cluster, then rebuild the slaves and remove the dir.old directories.\n");
+
+done:
+    Free(oldBinDir);
+    Free(jobs);
+}
+
 /*
  * Test staff
  */
@@ -2405,6 +2903,11 @@ int do_singleLine(char *buf, char *wkline)
         do_failover_command(line);
         return 0;
     }
+    else if (TestToken("prewarm"))
+    {
+        do_prewarm_command(line);
+        return 0;
+    }
     else if (TestToken("reconnect"))
     {
         do_reconnect_command(line);
@@ -2615,6 +3118,16 @@ int do_singleLine(char *buf, char *wkline)
         do_test(line);
         return 0;
     }
+    else if (TestToken("backup"))
+    {
+        do_backup_command(line);
+        return 0;
+    }
+    else if (TestToken("upgrade"))
+    {
+        do_upgrade_command(line);
+        return 0;
+    }
     else if (TestToken("set"))
     {
         do_set(line);
@@ -2666,10 +3179,10 @@ show_all_help()
     printf("You are using pgxc_ctl, the configuration utility for PGXL\n"
            "Type:\n"
            "    help <command>\n"
-           "    where <command> is either add, Createdb, Createuser, clean,\n"
+           "    where <command> is either add, backup, Createdb, Createuser, clean,\n"
            "        configure, deploy, failover, init, kill, log, monitor,\n"
-           "        prepare, q, reconnect, remove, set, show, start, \n"
-           "        stop or unregister\n");
+           "        prepare, prewarm, q, reconnect, remove, set, show, start, \n"
+           "        stop, unregister or upgrade\n");
 }
 
 static void
@@ -2700,6 +3213,17 @@ do_show_help(char *line)
                 "\n"
               );
     }
+    else if (TestToken("backup"))
+    {
+        printf(
+                "\n"
+                "backup [ -r max_rate ] directory\n"
+                "\n"
+                "Takes base backups of all the nodes in parallel and a barrier they can all be recovered to\n"
+                "For more details, please see the pgxc_ctl documentation\n"
+                "\n"
+              );
+    }
     else if (TestToken("Createdb"))
     {
         printf(
@@ -2760,6 +3284,17 @@ do_show_help(char *line)
                 "\n"
               );
     }
+    else if (TestToken("prewarm"))
+    {
+        printf(
+                "\n"
+                "prewarm datanode [ all | nodename ... ]\n"
+                "\n"
+                "Loads the blocks in the buffer cache of the datanode masters into their slaves\n"
+                "For more details, please see the pgxc_ctl documentation\n"
+                "\n"
+              );
+    }
     else if (TestToken("failover"))
     {
         printf(
@@ -2977,6 +3512,17 @@ do_show_help(char *line)
                 "\n"
                 );
     }
+    else if (TestToken("upgrade"))
+    {
+        printf(
+                "\n"
+                "upgrade [ -j jobs ] old_bindir\n"
+                "\n"
+                "Runs pg_upgrade on all the coordinator and datanode masters in parallel\n"
+                "For more details, please see the pgxc_ctl documentation\n"
+                "\n"
+              );
+    }
     else
     {
         printf(
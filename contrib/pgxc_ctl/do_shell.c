@@ -54,6 +54,8 @@ static void echoPid(pid_t pid);
 #endif
 static char *allocActualCmd(cmd_t *cmd);
 static void prepareStdout(cmdList_t *cmdList);
+static void runCmdList(cmdList_t *cmds);
+static int runningOnHost(cmdList_t *cmds, char *state, int idx);
 
 /*
  * SIGINT handler
@@ -367,6 +369,105 @@ int doCmdEl(cmd_t *cmd)
     }
 }
 
+/*
+ * States of the commands of a list run in parallel
+ */
+#define CMD_WAITING    0
+#define CMD_RUNNING    1
+#define CMD_DONE    2
+
+/*
+ * Number of commands of the list running on the host of the idx-th one.
+ * The first element of a command decides where it runs.
+ */
+static int runningOnHost(cmdList_t *cmds, char *state, int idx)
+{
+    char *host = cmds->cmds[idx]->host;
+    int ii;
+    int n = 0;
+
+    for (ii = 0; cmds->cmds[ii]; ii++)
+    {
+        if (state[ii] != CMD_RUNNING)
+            continue;
+        if ((host == NULL && cmds->cmds[ii]->host == NULL) ||
+            (host && cmds->cmds[ii]->host && strcmp(host, cmds->cmds[ii]->host) == 0))
+            n++;
+    }
+    return n;
+}
+
+/*
+ * Run each command of the list in a child process.
+ *
+ * A command is started as soon as its host has a free slot: at most
+ * maxParallelPerHost commands run on the same host at a time, or any number
+ * if it is zero.  Exit status of each command is kept in its excode and
+ * progress is reported as they finish.
+ */
+static void runCmdList(cmdList_t *cmds)
+{
+    int limit = atoi(sval(VAR_maxParallelPerHost));
+    int total;
+    int finished = 0;
+    char *state;
+    pid_t pid;
+    int status;
+    int ii;
+
+    for (total = 0; cmds->cmds[total]; total++);
+    state = Malloc0(total);
+
+    while (finished < total)
+    {
+        for (ii = 0; ii < total; ii++)
+        {
+            if (state[ii] != CMD_WAITING)
+                continue;
+            if (limit > 0 && runningOnHost(cmds, state, ii) >= limit)
+                continue;
+            if ((pid = fork()) == 0)
+                exit(doCmd(cmds->cmds[ii]));
+            if (pid == -1)
+            {
+                elog(ERROR, "Process for \"%s\" failed to start. %s\n",
+                            cmds->cmds[ii]->command,
+                            strerror(errno));
+                state[ii] = CMD_DONE;
+                finished++;
+                continue;
+            }
+            cmds->cmds[ii]->pid = pid;
+            state[ii] = CMD_RUNNING;
+        }
+        if (finished >= total)
+            break;
+
+        if ((pid = wait(&status)) == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        for (ii = 0; ii < total; ii++)
+        {
+            if (state[ii] == CMD_RUNNING && cmds->cmds[ii]->pid == pid)
+            {
+                cmds->cmds[ii]->excode = status;
+                cmds->cmds[ii]->pid = 0;
+                state[ii] = CMD_DONE;
+                finished++;
+                if (total > 1)
+                    elog(INFO, "[%d/%d] %s on %s\n", finished, total,
+                         WEXITSTATUS(status) == 0 ? "done" : "FAILED",
+                         cmds->cmds[ii]->host ? cmds->cmds[ii]->host : "localhost");
+                break;
+            }
+        }
+    }
+    Free(state);
+}
+
 /*
  * Here, we should handle exit code.
  *
@@ -393,25 +494,11 @@ int doCmdList(cmdList_t *cmds)
     prepareStdout(cmds);
     if (setjmp(dcJmpBufDoShell) == 0)
     {
-        for (ii = 0; cmds->cmds[ii]; ii++)
+        if (!isVarYes(VAR_debug))
+            runCmdList(cmds);
+        else
         {
-            if (!isVarYes(VAR_debug))
-            {
-                if ((cmds->cmds[ii]->pid = fork()) != 0)
-                {
-                    if (cmds->cmds[ii]->pid == -1)
-                    {
-                        elog(ERROR, "Process for \"%s\" failed to start. %s\n",
-                                    cmds->cmds[ii]->actualCmd,
-                                    strerror(errno));
-                        cmds->cmds[ii]->pid = 0;
-                    }
-                    continue;
-                }
-                else
-                    exit(doCmd(cmds->cmds[ii]));
-            }
-            else
+            for (ii = 0; cmds->cmds[ii]; ii++)
             {
                 cmds->cmds[ii]->excode = doCmd(cmds->cmds[ii]);
                 rc = WEXITSTATUS(cmds->cmds[ii]->excode);
@@ -460,17 +547,10 @@ int doCmdList(cmdList_t *cmds)
     {
         for (ii = 0; cmds->cmds[ii]; ii++)
         {
-            int status;
             cmd_t *cur;
 
             if (!isVarYes(VAR_debug))
-            {
-                if (cmds->cmds[ii]->pid)
-                {
-                    waitpid(cmds->cmds[ii]->pid, &status, 0);
-                    rc = WEXITSTATUS(status);
-                }
-            }
+                rc = WEXITSTATUS(cmds->cmds[ii]->excode);
             cmds->cmds[ii]->pid = 0;
             for (cur = cmds->cmds[ii]; cur; cur = cur->next)
             {
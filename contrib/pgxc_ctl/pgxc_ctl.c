@@ -379,6 +379,7 @@ static void setup_my_env(void)
         VAR_pgxcCtlName,
         VAR_printLocation,
         VAR_logLocation,
+        VAR_maxParallelPerHost,
         NULL
     };
 
@@ -419,6 +420,7 @@ static void setup_my_env(void)
     defaultDatabase = Strdup(sval(VAR_defaultDatabase));
     setDefaultIfNeeded(VAR_printLocation, "n");
     setDefaultIfNeeded(VAR_logLocation, "n");
+    setDefaultIfNeeded(VAR_maxParallelPerHost, "0");
 }
 
 int main(int argc, char *argv[])
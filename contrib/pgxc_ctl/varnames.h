@@ -218,5 +218,6 @@
 #define VAR_printMessage    "printMessage"    
 #define VAR_logLocation        "logLocation"
 #define VAR_printLocation    "printLocation"
+#define VAR_maxParallelPerHost    "maxParallelPerHost"
 
 #endif /* VARNAMES_H */
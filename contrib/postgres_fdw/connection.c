@@ -58,6 +58,7 @@ typedef struct ConnCacheEntry
     bool        invalidated;    /* true if reconnect is pending */
     uint32        server_hashvalue;    /* hash value of foreign server OID */
     uint32        mapping_hashvalue;    /* hash value of user mapping OID */
+    PgFdwConnState state;        /* extra per-connection state */
 } ConnCacheEntry;
 
 /*
@@ -102,9 +103,12 @@ static bool pgfdw_get_cleanup_result(PGconn *conn, TimestampTz endtime,
  * will_prep_stmt must be true if caller intends to create any prepared
  * statements.  Since those don't go away automatically at transaction end
  * (not even on error), we need this flag to cue manual cleanup.
+ *
+ * If state is not NULL, *state receives the per-connection state, which
+ * callers issuing asynchronous queries use to coordinate with each other.
  */
 PGconn *
-GetConnection(UserMapping *user, bool will_prep_stmt)
+GetConnection(UserMapping *user, bool will_prep_stmt, PgFdwConnState **state)
 {
     bool        found;
     ConnCacheEntry *entry;
@@ -190,6 +194,7 @@ GetConnection(UserMapping *user, bool will_prep_stmt)
         entry->have_error = false;
         entry->changing_xact_state = false;
         entry->invalidated = false;
+        entry->state.pending_scan = NULL;
         entry->server_hashvalue =
             GetSysCacheHashValue1(FOREIGNSERVEROID,
                                   ObjectIdGetDatum(server->serverid));
@@ -212,6 +217,9 @@ GetConnection(UserMapping *user, bool will_prep_stmt)
     /* Remember if caller will prepare statements */
     entry->have_prep_stmt |= will_prep_stmt;
 
+    if (state)
+        *state = &entry->state;
+
     return entry->conn;
 }
 
@@ -669,6 +677,20 @@ pgfdw_xact_callback(XactEvent event, void *arg)
         if (entry->conn == NULL)
             continue;
 
+        /*
+         * A scan that prefetched a batch but never came back for it leaves
+         * the FETCH result unread.  Swallow it before committing; on abort,
+         * the cancel below takes care of it.
+         */
+        if (entry->state.pending_scan != NULL)
+        {
+            entry->state.pending_scan = NULL;
+            if (event == XACT_EVENT_PARALLEL_PRE_COMMIT ||
+                event == XACT_EVENT_PRE_COMMIT ||
+                event == XACT_EVENT_PRE_PREPARE)
+                PQclear(pgfdw_get_result(entry->conn, "FETCH"));
+        }
+
         /* If it has an open remote transaction, try to close it */
         if (entry->xact_depth > 0)
         {
@@ -903,6 +925,9 @@ pgfdw_subxact_callback(SubXactEvent event, SubTransactionId mySubid,
             /* Assume we might have lost track of prepared statements */
             entry->have_error = true;
 
+            /* A FETCH in flight gets cancelled below */
+            entry->state.pending_scan = NULL;
+
             /*
              * If a command has been submitted to the remote server by using
              * an asynchronous execution function, the command might not have
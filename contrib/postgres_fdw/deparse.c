@@ -1542,13 +1542,15 @@ deparseRangeTblRef(StringInfo buf, PlannerInfo *root, RelOptInfo *foreignrel,
  *
  * The statement text is appended to buf, and we also create an integer List
  * of the columns being retrieved by RETURNING (if any), which is returned
- * to *retrieved_attrs.
+ * to *retrieved_attrs.  *values_end_len receives the length of the text up
+ * to the end of the VALUES list, for use by rebuildInsertSql.
  */
 void
 deparseInsertSql(StringInfo buf, PlannerInfo *root,
                  Index rtindex, Relation rel,
                  List *targetAttrs, bool doNothing,
-                 List *returningList, List **retrieved_attrs)
+                 List *returningList, List **retrieved_attrs,
+                 int *values_end_len)
 {
     AttrNumber    pindex;
     bool        first;
@@ -1591,6 +1593,7 @@ deparseInsertSql(StringInfo buf, PlannerInfo *root,
     }
     else
         appendStringInfoString(buf, " DEFAULT VALUES");
+    *values_end_len = buf->len;
 
     if (doNothing)
         appendStringInfoString(buf, " ON CONFLICT DO NOTHING");
@@ -1600,6 +1603,44 @@ deparseInsertSql(StringInfo buf, PlannerInfo *root,
                          returningList, retrieved_attrs);
 }
 
+/*
+ * rebuild remote INSERT statement for a batch of rows
+ *
+ * Given the single-row statement made by deparseInsertSql and the offset of
+ * the end of its VALUES list, append to buf the same statement inserting
+ * num_rows rows, numbering the parameters of row i from i * num_params + 1.
+ */
+void
+rebuildInsertSql(StringInfo buf, const char *orig_query,
+                 int values_end_len, int num_params, int num_rows)
+{
+    int            pindex;
+    int            i;
+    int            j;
+
+    /* Copy up to the end of the first row from the original query */
+    appendBinaryStringInfo(buf, orig_query, values_end_len);
+
+    pindex = num_params + 1;
+    for (i = 1; i < num_rows; i++)
+    {
+        appendStringInfoString(buf, ", (");
+
+        for (j = 0; j < num_params; j++)
+        {
+            if (j > 0)
+                appendStringInfoString(buf, ", ");
+            appendStringInfo(buf, "$%d", pindex);
+            pindex++;
+        }
+
+        appendStringInfoChar(buf, ')');
+    }
+
+    /* Copy whatever follows the VALUES list */
+    appendStringInfoString(buf, orig_query + values_end_len);
+}
+
 /*
  * deparse remote UPDATE statement
  *
@@ -108,7 +108,8 @@ postgres_fdw_validator(PG_FUNCTION_ARGS)
          * Validate option value, when we can do so without any context.
          */
         if (strcmp(def->defname, "use_remote_estimate") == 0 ||
-            strcmp(def->defname, "updatable") == 0)
+            strcmp(def->defname, "updatable") == 0 ||
+            strcmp(def->defname, "async_capable") == 0)
         {
             /* these accept only boolean values */
             (void) defGetBoolean(def);
@@ -132,12 +133,13 @@ postgres_fdw_validator(PG_FUNCTION_ARGS)
             /* check list syntax, warn about uninstalled extensions */
             (void) ExtractExtensionList(defGetString(def), true);
         }
-        else if (strcmp(def->defname, "fetch_size") == 0)
+        else if (strcmp(def->defname, "fetch_size") == 0 ||
+                 strcmp(def->defname, "batch_size") == 0)
         {
-            int            fetch_size;
+            int            size;
 
-            fetch_size = strtol(defGetString(def), NULL, 10);
-            if (fetch_size <= 0)
+            size = strtol(defGetString(def), NULL, 10);
+            if (size <= 0)
                 ereport(ERROR,
                         (errcode(ERRCODE_SYNTAX_ERROR),
                          errmsg("%s requires a non-negative integer value",
@@ -177,6 +179,12 @@ InitPgFdwOptions(void)
         /* fetch_size is available on both server and table */
         {"fetch_size", ForeignServerRelationId, false},
         {"fetch_size", ForeignTableRelationId, false},
+        /* batch_size is available on both server and table */
+        {"batch_size", ForeignServerRelationId, false},
+        {"batch_size", ForeignTableRelationId, false},
+        /* async_capable is available on both server and table */
+        {"async_capable", ForeignServerRelationId, false},
+        {"async_capable", ForeignTableRelationId, false},
         {NULL, InvalidOid, false}
     };
 
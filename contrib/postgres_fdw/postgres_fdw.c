@@ -53,6 +53,9 @@ PG_MODULE_MAGIC;
 /* If no remote estimates, assume a sort costs 20% extra */
 #define DEFAULT_FDW_SORT_MULTIPLIER 1.2
 
+/* Upper bound on the number of parameters in one remote statement */
+#define PQ_QUERY_PARAM_MAX_LIMIT    65535
+
 /*
  * Indexes of FDW-private information stored in fdw_private lists.
  *
@@ -68,6 +71,8 @@ enum FdwScanPrivateIndex
     FdwScanPrivateRetrievedAttrs,
     /* Integer representing the desired fetch_size */
     FdwScanPrivateFetchSize,
+    /* Boolean flag showing if batches may be prefetched asynchronously */
+    FdwScanPrivateAsyncCapable,
 
     /*
      * String describing join i.e. names of relations being joined and types
@@ -85,6 +90,8 @@ enum FdwScanPrivateIndex
  *      (NIL for a DELETE)
  * 3) Boolean flag showing if the remote query has a RETURNING clause
  * 4) Integer list of attribute numbers retrieved by RETURNING, if any
+ * 5) Length of the INSERT text up to the end of its VALUES list, or -1 if
+ *      the INSERT can't be sent in batches (as an integer Value node)
  */
 enum FdwModifyPrivateIndex
 {
@@ -95,7 +102,9 @@ enum FdwModifyPrivateIndex
     /* has-returning flag (as an integer Value node) */
     FdwModifyPrivateHasReturning,
     /* Integer list of attribute numbers retrieved by RETURNING */
-    FdwModifyPrivateRetrievedAttrs
+    FdwModifyPrivateRetrievedAttrs,
+    /* Length of the INSERT text up to the end of the VALUES list */
+    FdwModifyPrivateLen
 };
 
 /*
@@ -135,6 +144,7 @@ typedef struct PgFdwScanState
 
     /* for remote query execution */
     PGconn       *conn;            /* connection for the scan */
+    PgFdwConnState *conn_state; /* extra per-connection state */
     unsigned int cursor_number; /* quasi-unique ID for my cursor */
     bool        cursor_exists;    /* have we created the cursor? */
     int            numParams;        /* number of parameters passed to query */
@@ -156,6 +166,16 @@ typedef struct PgFdwScanState
     MemoryContext temp_cxt;        /* context for per-tuple temporary data */
 
     int            fetch_size;        /* number of tuples per fetch */
+
+    /*
+     * With async_capable, the FETCH for the next batch is sent as soon as the
+     * current one arrives, and its result lands in the spare batch.
+     */
+    bool        async_capable;    /* prefetch batches without waiting? */
+    MemoryContext spare_cxt;    /* context holding the prefetched batch */
+    HeapTuple  *spare_tuples;    /* prefetched tuples */
+    int            spare_num_tuples;    /* # of prefetched tuples */
+    bool        spare_ready;    /* does the spare batch hold a result? */
 } PgFdwScanState;
 
 /*
@@ -168,6 +188,7 @@ typedef struct PgFdwModifyState
 
     /* for remote query execution */
     PGconn       *conn;            /* connection for the scan */
+    PgFdwConnState *conn_state; /* extra per-connection state */
     char       *p_name;            /* name of prepared statement, if created */
 
     /* extracted fdw_private data */
@@ -181,6 +202,14 @@ typedef struct PgFdwModifyState
     int            p_nums;            /* number of parameters to transmit */
     FmgrInfo   *p_flinfo;        /* output conversion functions for them */
 
+    /* for batched INSERTs; batch_size is 1 when rows are sent one by one */
+    char       *orig_query;        /* single-row INSERT text */
+    int            values_end;        /* length of orig_query up to end of VALUES */
+    int            batch_size;        /* max # of rows sent in one INSERT */
+    int            num_slots;        /* # of rows currently buffered */
+    const char **batch_values;    /* parameter values of the buffered rows */
+    MemoryContext batch_cxt;    /* context holding buffered values */
+
     /* working memory context */
     MemoryContext temp_cxt;        /* context for per-tuple temporary data */
 } PgFdwModifyState;
@@ -201,6 +230,7 @@ typedef struct PgFdwDirectModifyState
 
     /* for remote query execution */
     PGconn       *conn;            /* connection for the update */
+    PgFdwConnState *conn_state; /* extra per-connection state */
     int            numParams;        /* number of parameters passed to query */
     FmgrInfo   *param_flinfo;    /* output conversion functions for them */
     List       *param_exprs;    /* executable expressions for param values */
@@ -369,8 +399,13 @@ static bool ec_member_matches_foreign(PlannerInfo *root, RelOptInfo *rel,
                           void *arg);
 static void create_cursor(ForeignScanState *node);
 static void fetch_more_data(ForeignScanState *node);
+static void fetch_more_data_begin(ForeignScanState *node);
+static void fetch_more_data_end(ForeignScanState *node);
+static void process_pending_request(PgFdwConnState *conn_state);
 static void close_cursor(PGconn *conn, unsigned int cursor_number);
 static void prepare_foreign_modify(PgFdwModifyState *fmstate);
+static int    get_batch_size_option(Relation rel);
+static void execute_foreign_insert_batch(PgFdwModifyState *fmstate);
 static const char **convert_prep_stmt_params(PgFdwModifyState *fmstate,
                          ItemPointer tupleid,
                          TupleTableSlot *slot);
@@ -517,6 +552,7 @@ postgresGetForeignRelSize(PlannerInfo *root,
     fpinfo->fdw_tuple_cost = DEFAULT_FDW_TUPLE_COST;
     fpinfo->shippable_extensions = NIL;
     fpinfo->fetch_size = 100;
+    fpinfo->async_capable = false;
 
     apply_server_options(fpinfo);
     apply_table_options(fpinfo);
@@ -1248,9 +1284,10 @@ postgresGetForeignPlan(PlannerInfo *root,
      * Build the fdw_private list that will be available to the executor.
      * Items in the list must match order in enum FdwScanPrivateIndex.
      */
-    fdw_private = list_make3(makeString(sql.data),
+    fdw_private = list_make4(makeString(sql.data),
                              retrieved_attrs,
-                             makeInteger(fpinfo->fetch_size));
+                             makeInteger(fpinfo->fetch_size),
+                             makeInteger(fpinfo->async_capable));
     if (IS_JOIN_REL(foreignrel) || IS_UPPER_REL(foreignrel))
         fdw_private = lappend(fdw_private,
                               makeString(fpinfo->relation_name->data));
@@ -1322,7 +1359,7 @@ postgresBeginForeignScan(ForeignScanState *node, int eflags)
      * Get connection to the foreign server.  Connection manager will
      * establish new connection if necessary.
      */
-    fsstate->conn = GetConnection(user, false);
+    fsstate->conn = GetConnection(user, false, &fsstate->conn_state);
 
     /* Assign a unique ID for my cursor */
     fsstate->cursor_number = GetCursorNumber(fsstate->conn);
@@ -1335,11 +1372,16 @@ postgresBeginForeignScan(ForeignScanState *node, int eflags)
                                                  FdwScanPrivateRetrievedAttrs);
     fsstate->fetch_size = intVal(list_nth(fsplan->fdw_private,
                                           FdwScanPrivateFetchSize));
+    fsstate->async_capable = intVal(list_nth(fsplan->fdw_private,
+                                             FdwScanPrivateAsyncCapable));
 
     /* Create contexts for batches of tuples and per-tuple temp workspace. */
     fsstate->batch_cxt = AllocSetContextCreate(estate->es_query_cxt,
                                                "postgres_fdw tuple data",
                                                ALLOCSET_DEFAULT_SIZES);
+    fsstate->spare_cxt = AllocSetContextCreate(estate->es_query_cxt,
+                                               "postgres_fdw prefetched tuple data",
+                                               ALLOCSET_DEFAULT_SIZES);
     fsstate->temp_cxt = AllocSetContextCreate(estate->es_query_cxt,
                                               "postgres_fdw temporary data",
                                               ALLOCSET_SMALL_SIZES);
@@ -1373,6 +1415,18 @@ postgresBeginForeignScan(ForeignScanState *node, int eflags)
                              &fsstate->param_flinfo,
                              &fsstate->param_exprs,
                              &fsstate->param_values);
+
+    /*
+     * An async-capable scan without parameters opens its cursor and asks for
+     * the first batch right away.  When several such scans sit under an
+     * Append, their remote servers all work on the query at the same time.
+     */
+    if (fsstate->async_capable && numParams == 0 &&
+        fsstate->conn_state->pending_scan == NULL)
+    {
+        create_cursor(node);
+        fetch_more_data_begin(node);
+    }
 }
 
 /*
@@ -1456,6 +1510,13 @@ postgresReScanForeignScan(ForeignScanState *node)
         return;
     }
 
+    /* A batch prefetched from the old cursor position is of no use now */
+    process_pending_request(fsstate->conn_state);
+    MemoryContextReset(fsstate->spare_cxt);
+    fsstate->spare_tuples = NULL;
+    fsstate->spare_num_tuples = 0;
+    fsstate->spare_ready = false;
+
     /*
      * We don't use a PG_TRY block here, so be careful not to throw error
      * without releasing the PGresult.
@@ -1488,7 +1549,10 @@ postgresEndForeignScan(ForeignScanState *node)
 
     /* Close the cursor if open, to prevent accumulation of cursors */
     if (fsstate->cursor_exists)
+    {
+        process_pending_request(fsstate->conn_state);
         close_cursor(fsstate->conn, fsstate->cursor_number);
+    }
 
     /* Release remote connection */
     ReleaseConnection(fsstate->conn);
@@ -1552,6 +1616,7 @@ postgresPlanForeignModify(PlannerInfo *root,
     List       *returningList = NIL;
     List       *retrieved_attrs = NIL;
     bool        doNothing = false;
+    int            values_end_len = -1;
 
     initStringInfo(&sql);
 
@@ -1623,7 +1688,15 @@ postgresPlanForeignModify(PlannerInfo *root,
         case CMD_INSERT:
             deparseInsertSql(&sql, root, resultRelation, rel,
                              targetAttrs, doNothing, returningList,
-                             &retrieved_attrs);
+                             &retrieved_attrs, &values_end_len);
+
+            /*
+             * Rows buffered for a batch are reported as inserted before they
+             * reach the remote side, so we can only batch an INSERT whose
+             * every row is known to go in and which returns nothing.
+             */
+            if (doNothing || targetAttrs == NIL || retrieved_attrs != NIL)
+                values_end_len = -1;
             break;
         case CMD_UPDATE:
             deparseUpdateSql(&sql, root, resultRelation, rel,
@@ -1646,10 +1719,11 @@ postgresPlanForeignModify(PlannerInfo *root,
      * Build the fdw_private list that will be available to the executor.
      * Items in the list must match enum FdwModifyPrivateIndex, above.
      */
-    return list_make4(makeString(sql.data),
+    return list_make5(makeString(sql.data),
                       targetAttrs,
                       makeInteger((retrieved_attrs != NIL)),
-                      retrieved_attrs);
+                      retrieved_attrs,
+                      makeInteger(values_end_len));
 }
 
 /*
@@ -1699,7 +1773,7 @@ postgresBeginForeignModify(ModifyTableState *mtstate,
     user = GetUserMapping(userid, table->serverid);
 
     /* Open connection; report that we'll create a prepared statement. */
-    fmstate->conn = GetConnection(user, true);
+    fmstate->conn = GetConnection(user, true, &fmstate->conn_state);
     fmstate->p_name = NULL;        /* prepared statement not made yet */
 
     /* Deconstruct fdw_private data. */
@@ -1711,6 +1785,8 @@ postgresBeginForeignModify(ModifyTableState *mtstate,
                                              FdwModifyPrivateHasReturning));
     fmstate->retrieved_attrs = (List *) list_nth(fdw_private,
                                                  FdwModifyPrivateRetrievedAttrs);
+    fmstate->values_end = intVal(list_nth(fdw_private,
+                                          FdwModifyPrivateLen));
 
     /* Create context for per-tuple temp workspace. */
     fmstate->temp_cxt = AllocSetContextCreate(estate->es_query_cxt,
@@ -1760,6 +1836,36 @@ postgresBeginForeignModify(ModifyTableState *mtstate,
 
     Assert(fmstate->p_nums <= n_params);
 
+    /*
+     * Set up to send INSERTed rows in batches, if the table asks for that.
+     * Statement-level AFTER triggers would fire before the last batch goes
+     * out, so don't batch when there are any.  A batch must also stay within
+     * the protocol's limit on the number of parameters.
+     */
+    fmstate->batch_size = 1;
+    if (operation == CMD_INSERT && fmstate->values_end >= 0 &&
+        !(resultRelInfo->ri_TrigDesc &&
+          resultRelInfo->ri_TrigDesc->trig_insert_after_statement))
+        fmstate->batch_size = Min(get_batch_size_option(rel),
+                                  PQ_QUERY_PARAM_MAX_LIMIT / fmstate->p_nums);
+
+    if (fmstate->batch_size > 1)
+    {
+        StringInfoData sql;
+
+        initStringInfo(&sql);
+        rebuildInsertSql(&sql, fmstate->query, fmstate->values_end,
+                         fmstate->p_nums, fmstate->batch_size);
+        fmstate->orig_query = fmstate->query;
+        fmstate->query = sql.data;
+        fmstate->num_slots = 0;
+        fmstate->batch_values = (const char **)
+            palloc(sizeof(char *) * fmstate->p_nums * fmstate->batch_size);
+        fmstate->batch_cxt = AllocSetContextCreate(estate->es_query_cxt,
+                                                   "postgres_fdw batch data",
+                                                   ALLOCSET_DEFAULT_SIZES);
+    }
+
     resultRelInfo->ri_FdwState = fmstate;
 }
 
@@ -1778,6 +1884,34 @@ postgresExecForeignInsert(EState *estate,
     PGresult   *res;
     int            n_rows;
 
+    if (fmstate->batch_size > 1)
+    {
+        const char **dest;
+        MemoryContext oldcontext;
+        int            i;
+
+        /* Convert the row's parameters and keep them for the batch */
+        p_values = convert_prep_stmt_params(fmstate, NULL, slot);
+        dest = fmstate->batch_values + fmstate->num_slots * fmstate->p_nums;
+
+        oldcontext = MemoryContextSwitchTo(fmstate->batch_cxt);
+        for (i = 0; i < fmstate->p_nums; i++)
+            dest[i] = p_values[i] ? pstrdup(p_values[i]) : NULL;
+        MemoryContextSwitchTo(oldcontext);
+
+        fmstate->num_slots++;
+        MemoryContextReset(fmstate->temp_cxt);
+
+        if (fmstate->num_slots >= fmstate->batch_size)
+            execute_foreign_insert_batch(fmstate);
+
+        /* The row is reported as inserted; failures raise an error later */
+        return slot;
+    }
+
+    /* The connection may be busy with the prefetch of a scan feeding us */
+    process_pending_request(fmstate->conn_state);
+
     /* Set up the prepared statement on the remote server, if we didn't yet */
     if (!fmstate->p_name)
         prepare_foreign_modify(fmstate);
@@ -1844,6 +1978,9 @@ postgresExecForeignUpdate(EState *estate,
     PGresult   *res;
     int            n_rows;
 
+    /* The connection may be busy with the prefetch of a scan feeding us */
+    process_pending_request(fmstate->conn_state);
+
     /* Set up the prepared statement on the remote server, if we didn't yet */
     if (!fmstate->p_name)
         prepare_foreign_modify(fmstate);
@@ -1920,6 +2057,9 @@ postgresExecForeignDelete(EState *estate,
     PGresult   *res;
     int            n_rows;
 
+    /* The connection may be busy with the prefetch of a scan feeding us */
+    process_pending_request(fmstate->conn_state);
+
     /* Set up the prepared statement on the remote server, if we didn't yet */
     if (!fmstate->p_name)
         prepare_foreign_modify(fmstate);
@@ -1993,12 +2133,18 @@ postgresEndForeignModify(EState *estate,
     if (fmstate == NULL)
         return;
 
+    /* Send the rows of a partly filled batch */
+    if (fmstate->batch_size > 1)
+        execute_foreign_insert_batch(fmstate);
+
     /* If we created a prepared statement, destroy it */
     if (fmstate->p_name)
     {
         char        sql[64];
         PGresult   *res;
 
+        process_pending_request(fmstate->conn_state);
+
         snprintf(sql, sizeof(sql), "DEALLOCATE %s", fmstate->p_name);
 
         /*
@@ -2017,6 +2163,46 @@ postgresEndForeignModify(EState *estate,
     fmstate->conn = NULL;
 }
 
+/*
+ * get_batch_size_option
+ *        Determine how many rows postgres_fdw sends in one remote INSERT
+ */
+static int
+get_batch_size_option(Relation rel)
+{
+    int            batch_size;
+    ForeignTable *table;
+    ForeignServer *server;
+    ListCell   *lc;
+
+    /*
+     * By default rows are sent one at a time.  This can be overridden by a
+     * per-server setting, which in turn can be overridden by a per-table
+     * setting.
+     */
+    batch_size = 1;
+
+    table = GetForeignTable(RelationGetRelid(rel));
+    server = GetForeignServer(table->serverid);
+
+    foreach(lc, server->options)
+    {
+        DefElem    *def = (DefElem *) lfirst(lc);
+
+        if (strcmp(def->defname, "batch_size") == 0)
+            batch_size = strtol(defGetString(def), NULL, 10);
+    }
+    foreach(lc, table->options)
+    {
+        DefElem    *def = (DefElem *) lfirst(lc);
+
+        if (strcmp(def->defname, "batch_size") == 0)
+            batch_size = strtol(defGetString(def), NULL, 10);
+    }
+
+    return batch_size;
+}
+
 /*
  * postgresIsForeignRelUpdatable
  *        Determine whether a foreign table supports INSERT, UPDATE and/or
@@ -2302,7 +2488,7 @@ postgresBeginDirectModify(ForeignScanState *node, int eflags)
      * Get connection to the foreign server.  Connection manager will
      * establish new connection if necessary.
      */
-    dmstate->conn = GetConnection(user, false);
+    dmstate->conn = GetConnection(user, false, &dmstate->conn_state);
 
     /* Initialize state variable */
     dmstate->num_tuples = -1;    /* -1 means not set yet */
@@ -2563,7 +2749,7 @@ estimate_path_cost_size(PlannerInfo *root,
                                 &retrieved_attrs, NULL);
 
         /* Get the remote estimate */
-        conn = GetConnection(fpinfo->user, false);
+        conn = GetConnection(fpinfo->user, false, NULL);
         get_remote_estimate(sql.data, conn, &rows, &width,
                             &startup_cost, &total_cost);
         ReleaseConnection(conn);
@@ -2926,6 +3112,9 @@ create_cursor(ForeignScanState *node)
     StringInfoData buf;
     PGresult   *res;
 
+    /* The connection may be busy with another scan's prefetch */
+    process_pending_request(fsstate->conn_state);
+
     /*
      * Construct array of query parameter values in text format.  We do the
      * conversions in the short-lived per-tuple context, so as not to cause a
@@ -2986,49 +3175,117 @@ create_cursor(ForeignScanState *node)
 
 /*
  * Fetch some more rows from the node's cursor.
+ *
+ * If the batch was prefetched, this only collects it.  For an async-capable
+ * scan, the FETCH for the following batch is sent before returning, so that
+ * the remote server produces it while we are busy with this one.
  */
 static void
 fetch_more_data(ForeignScanState *node)
 {
     PgFdwScanState *fsstate = (PgFdwScanState *) node->fdw_state;
-    PGresult   *volatile res = NULL;
-    MemoryContext oldcontext;
+    MemoryContext tmpcxt;
+
+    if (!fsstate->spare_ready)
+    {
+        if (fsstate->conn_state->pending_scan != node)
+        {
+            /* Only one query at a time; let any other prefetch finish */
+            process_pending_request(fsstate->conn_state);
+            fetch_more_data_begin(node);
+        }
+        fetch_more_data_end(node);
+    }
 
     /*
-     * We'll store the tuples in the batch_cxt.  First, flush the previous
-     * batch.
+     * Make the fetched batch current.  That frees the previous batch, whose
+     * context becomes the spare for the next one.
      */
-    fsstate->tuples = NULL;
-    MemoryContextReset(fsstate->batch_cxt);
-    oldcontext = MemoryContextSwitchTo(fsstate->batch_cxt);
+    tmpcxt = fsstate->batch_cxt;
+    fsstate->batch_cxt = fsstate->spare_cxt;
+    fsstate->spare_cxt = tmpcxt;
+    MemoryContextReset(fsstate->spare_cxt);
+
+    fsstate->tuples = fsstate->spare_tuples;
+    fsstate->num_tuples = fsstate->spare_num_tuples;
+    fsstate->next_tuple = 0;
+    fsstate->spare_tuples = NULL;
+    fsstate->spare_num_tuples = 0;
+    fsstate->spare_ready = false;
+
+    /* Update fetch_ct_2 */
+    if (fsstate->fetch_ct_2 < 2)
+        fsstate->fetch_ct_2++;
+
+    /* Must be EOF if we didn't get as many tuples as we asked for. */
+    fsstate->eof_reached = (fsstate->num_tuples < fsstate->fetch_size);
+
+    if (fsstate->async_capable && !fsstate->eof_reached &&
+        fsstate->conn_state->pending_scan == NULL)
+        fetch_more_data_begin(node);
+}
+
+/*
+ * Send the FETCH for the node's next batch without waiting for its result.
+ */
+static void
+fetch_more_data_begin(ForeignScanState *node)
+{
+    PgFdwScanState *fsstate = (PgFdwScanState *) node->fdw_state;
+    char        sql[64];
+
+    Assert(fsstate->conn_state->pending_scan == NULL);
+    Assert(!fsstate->spare_ready);
+
+    snprintf(sql, sizeof(sql), "FETCH %d FROM c%u",
+             fsstate->fetch_size, fsstate->cursor_number);
+
+    if (!PQsendQuery(fsstate->conn, sql))
+        pgfdw_report_error(ERROR, NULL, fsstate->conn, false, fsstate->query);
+
+    fsstate->conn_state->pending_scan = node;
+}
+
+/*
+ * Wait for the FETCH sent for the node, and store the rows it returned in
+ * the node's spare batch.
+ */
+static void
+fetch_more_data_end(ForeignScanState *node)
+{
+    PgFdwScanState *fsstate = (PgFdwScanState *) node->fdw_state;
+    PGresult   *volatile res = NULL;
+    MemoryContext oldcontext;
+
+    Assert(fsstate->conn_state->pending_scan == node);
+
+    /* Whatever happens below, the connection is no longer ours */
+    fsstate->conn_state->pending_scan = NULL;
+
+    oldcontext = MemoryContextSwitchTo(fsstate->spare_cxt);
 
     /* PGresult must be released before leaving this function. */
     PG_TRY();
     {
         PGconn       *conn = fsstate->conn;
-        char        sql[64];
         int            numrows;
         int            i;
 
-        snprintf(sql, sizeof(sql), "FETCH %d FROM c%u",
-                 fsstate->fetch_size, fsstate->cursor_number);
-
-        res = pgfdw_exec_query(conn, sql);
+        res = pgfdw_get_result(conn, fsstate->query);
         /* On error, report the original query, not the FETCH. */
         if (PQresultStatus(res) != PGRES_TUPLES_OK)
             pgfdw_report_error(ERROR, res, conn, false, fsstate->query);
 
         /* Convert the data into HeapTuples */
         numrows = PQntuples(res);
-        fsstate->tuples = (HeapTuple *) palloc0(numrows * sizeof(HeapTuple));
-        fsstate->num_tuples = numrows;
-        fsstate->next_tuple = 0;
+        fsstate->spare_tuples = (HeapTuple *) palloc0(numrows * sizeof(HeapTuple));
+        fsstate->spare_num_tuples = numrows;
 
         for (i = 0; i < numrows; i++)
         {
             Assert(IsA(node->ss.ps.plan, ForeignScan));
 
-            fsstate->tuples[i] =
+            fsstate->spare_tuples[i] =
                 make_tuple_from_result_row(res, i,
                                            fsstate->rel,
                                            fsstate->attinmeta,
@@ -3037,13 +3294,6 @@ fetch_more_data(ForeignScanState *node)
                                            fsstate->temp_cxt);
         }
 
-        /* Update fetch_ct_2 */
-        if (fsstate->fetch_ct_2 < 2)
-            fsstate->fetch_ct_2++;
-
-        /* Must be EOF if we didn't get as many tuples as we asked for. */
-        fsstate->eof_reached = (numrows < fsstate->fetch_size);
-
         PQclear(res);
         res = NULL;
     }
@@ -3056,6 +3306,20 @@ fetch_more_data(ForeignScanState *node)
     PG_END_TRY();
 
     MemoryContextSwitchTo(oldcontext);
+
+    fsstate->spare_ready = true;
+}
+
+/*
+ * Finish the prefetch in flight on a connection, if any, so that the
+ * connection can be used for something else.  The rows wait in the spare
+ * batch of the scan that asked for them.
+ */
+static void
+process_pending_request(PgFdwConnState *conn_state)
+{
+    if (conn_state->pending_scan != NULL)
+        fetch_more_data_end(conn_state->pending_scan);
 }
 
 /*
@@ -3174,6 +3438,73 @@ prepare_foreign_modify(PgFdwModifyState *fmstate)
     fmstate->p_name = p_name;
 }
 
+/*
+ * execute_foreign_insert_batch
+ *        Send the rows buffered by postgresExecForeignInsert in one INSERT
+ */
+static void
+execute_foreign_insert_batch(PgFdwModifyState *fmstate)
+{
+    int            n_params = fmstate->num_slots * fmstate->p_nums;
+    char       *sql;
+    PGresult   *res;
+
+    if (fmstate->num_slots == 0)
+        return;
+
+    /* The connection may be busy with the prefetch of a scan feeding us */
+    process_pending_request(fmstate->conn_state);
+
+    if (fmstate->num_slots == fmstate->batch_size)
+    {
+        /* Full batches reuse one prepared statement */
+        if (!fmstate->p_name)
+            prepare_foreign_modify(fmstate);
+
+        sql = fmstate->query;
+        if (!PQsendQueryPrepared(fmstate->conn,
+                                 fmstate->p_name,
+                                 n_params,
+                                 fmstate->batch_values,
+                                 NULL,
+                                 NULL,
+                                 0))
+            pgfdw_report_error(ERROR, NULL, fmstate->conn, false, sql);
+    }
+    else
+    {
+        StringInfoData buf;
+        MemoryContext oldcontext;
+
+        /* The last, partly filled batch is sent as a one-off statement */
+        oldcontext = MemoryContextSwitchTo(fmstate->temp_cxt);
+        initStringInfo(&buf);
+        rebuildInsertSql(&buf, fmstate->orig_query, fmstate->values_end,
+                         fmstate->p_nums, fmstate->num_slots);
+        MemoryContextSwitchTo(oldcontext);
+
+        sql = buf.data;
+        if (!PQsendQueryParams(fmstate->conn, sql, n_params,
+                               NULL, fmstate->batch_values, NULL, NULL, 0))
+            pgfdw_report_error(ERROR, NULL, fmstate->conn, false, sql);
+    }
+
+    /*
+     * Get the result, and check for success.
+     *
+     * We don't use a PG_TRY block here, so be careful not to throw error
+     * without releasing the PGresult.
+     */
+    res = pgfdw_get_result(fmstate->conn, sql);
+    if (PQresultStatus(res) != PGRES_COMMAND_OK)
+        pgfdw_report_error(ERROR, res, fmstate->conn, true, sql);
+    PQclear(res);
+
+    fmstate->num_slots = 0;
+    MemoryContextReset(fmstate->batch_cxt);
+    MemoryContextReset(fmstate->temp_cxt);
+}
+
 /*
  * convert_prep_stmt_params
  *        Create array of text strings representing parameter values
@@ -3282,6 +3613,9 @@ execute_dml_stmt(ForeignScanState *node)
     int            numParams = dmstate->numParams;
     const char **values = dmstate->param_values;
 
+    /* The connection may be busy with another scan's prefetch */
+    process_pending_request(dmstate->conn_state);
+
     /*
      * Construct array of query parameter values in text format.
      */
@@ -3500,7 +3834,7 @@ postgresAnalyzeForeignTable(Relation relation,
      */
     table = GetForeignTable(RelationGetRelid(relation));
     user = GetUserMapping(relation->rd_rel->relowner, table->serverid);
-    conn = GetConnection(user, false);
+    conn = GetConnection(user, false, NULL);
 
     /*
      * Construct command to get page count for relation.
@@ -3590,7 +3924,7 @@ postgresAcquireSampleRowsFunc(Relation relation, int elevel,
     table = GetForeignTable(RelationGetRelid(relation));
     server = GetForeignServer(table->serverid);
     user = GetUserMapping(relation->rd_rel->relowner, table->serverid);
-    conn = GetConnection(user, false);
+    conn = GetConnection(user, false, NULL);
 
     /*
      * Construct cursor that retrieves whole rows from remote.
@@ -3813,7 +4147,7 @@ postgresImportForeignSchema(ImportForeignSchemaStmt *stmt, Oid serverOid)
      */
     server = GetForeignServer(serverOid);
     mapping = GetUserMapping(GetUserId(), server->serverid);
-    conn = GetConnection(mapping, false);
+    conn = GetConnection(mapping, false, NULL);
 
     /* Don't attempt to import collation if remote server hasn't got it */
     if (PQserverVersion(conn) < 90100)
@@ -4371,6 +4705,8 @@ apply_server_options(PgFdwRelationInfo *fpinfo)
                 ExtractExtensionList(defGetString(def), false);
         else if (strcmp(def->defname, "fetch_size") == 0)
             fpinfo->fetch_size = strtol(defGetString(def), NULL, 10);
+        else if (strcmp(def->defname, "async_capable") == 0)
+            fpinfo->async_capable = defGetBoolean(def);
     }
 }
 
@@ -4392,6 +4728,8 @@ apply_table_options(PgFdwRelationInfo *fpinfo)
             fpinfo->use_remote_estimate = defGetBoolean(def);
         else if (strcmp(def->defname, "fetch_size") == 0)
             fpinfo->fetch_size = strtol(defGetString(def), NULL, 10);
+        else if (strcmp(def->defname, "async_capable") == 0)
+            fpinfo->async_capable = defGetBoolean(def);
     }
 }
 
@@ -4426,6 +4764,7 @@ merge_fdw_options(PgFdwRelationInfo *fpinfo,
     fpinfo->shippable_extensions = fpinfo_o->shippable_extensions;
     fpinfo->use_remote_estimate = fpinfo_o->use_remote_estimate;
     fpinfo->fetch_size = fpinfo_o->fetch_size;
+    fpinfo->async_capable = fpinfo_o->async_capable;
 
     /* Merge the table level options from either side of the join. */
     if (fpinfo_i)
@@ -4447,6 +4786,10 @@ merge_fdw_options(PgFdwRelationInfo *fpinfo,
          * relation sizes.
          */
         fpinfo->fetch_size = Max(fpinfo_o->fetch_size, fpinfo_i->fetch_size);
+
+        /* Prefetch only if both sides allow it */
+        fpinfo->async_capable = fpinfo_o->async_capable &&
+            fpinfo_i->async_capable;
     }
 }
 
@@ -15,6 +15,7 @@
 
 #include "foreign/foreign.h"
 #include "lib/stringinfo.h"
+#include "nodes/execnodes.h"
 #include "nodes/relation.h"
 #include "utils/relcache.h"
 
@@ -77,6 +78,7 @@ typedef struct PgFdwRelationInfo
     UserMapping *user;            /* only set in use_remote_estimate mode */
 
     int            fetch_size;        /* fetch size for this remote table */
+    bool        async_capable;    /* prefetch batches without waiting? */
 
     /*
      * Name of the relation while EXPLAINing ForeignScan. It is used for join
@@ -110,12 +112,23 @@ typedef struct PgFdwRelationInfo
     int            relation_index;
 } PgFdwRelationInfo;
 
+/*
+ * Per-connection state shared by all the scans and modifies that use one
+ * connection.  Only one query can be in flight on a connection, so an
+ * asynchronous FETCH must be completed before anyone else uses it.
+ */
+typedef struct PgFdwConnState
+{
+    ForeignScanState *pending_scan; /* scan with a FETCH in flight, or NULL */
+} PgFdwConnState;
+
 /* in postgres_fdw.c */
 extern int    set_transmission_modes(void);
 extern void reset_transmission_modes(int nestlevel);
 
 /* in connection.c */
-extern PGconn *GetConnection(UserMapping *user, bool will_prep_stmt);
+extern PGconn *GetConnection(UserMapping *user, bool will_prep_stmt,
+              PgFdwConnState **state);
 extern void ReleaseConnection(PGconn *conn);
 extern unsigned int GetCursorNumber(PGconn *conn);
 extern unsigned int GetPrepStmtNumber(PGconn *conn);
@@ -143,7 +156,9 @@ extern bool is_foreign_expr(PlannerInfo *root,
 extern void deparseInsertSql(StringInfo buf, PlannerInfo *root,
                  Index rtindex, Relation rel,
                  List *targetAttrs, bool doNothing, List *returningList,
-                 List **retrieved_attrs);
+                 List **retrieved_attrs, int *values_end_len);
+extern void rebuildInsertSql(StringInfo buf, const char *orig_query,
+                 int values_end_len, int num_params, int num_rows);
 extern void deparseUpdateSql(StringInfo buf, PlannerInfo *root,
                  Index rtindex, Relation rel,
                  List *targetAttrs, List *returningList,
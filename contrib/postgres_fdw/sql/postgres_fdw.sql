@@ -1764,3 +1764,70 @@ WHERE ftrelid = 'table30000'::regclass
 AND ftoptions @> array['fetch_size=60000'];
 
 ROLLBACK;
+
+-- ===================================================================
+-- test batch insert
+-- ===================================================================
+CREATE TABLE batch_table ( x int );
+CREATE FOREIGN TABLE ftable ( x int ) SERVER loopback
+	OPTIONS ( table_name 'batch_table', batch_size '10' );
+-- one full batch
+INSERT INTO ftable SELECT * FROM generate_series(1, 10) i;
+-- two full batches and a partly filled one
+INSERT INTO ftable SELECT * FROM generate_series(11, 31) i;
+INSERT INTO ftable VALUES (32);
+INSERT INTO ftable VALUES (33), (34);
+SELECT COUNT(*), SUM(x) FROM ftable;
+-- RETURNING sends the rows one by one
+INSERT INTO ftable VALUES (35), (36) RETURNING *;
+-- batched rows are rolled back with the transaction
+BEGIN;
+INSERT INTO ftable SELECT * FROM generate_series(37, 50) i;
+SELECT COUNT(*) FROM ftable;
+ROLLBACK;
+SELECT COUNT(*), SUM(x) FROM ftable;
+-- the server's batch_size applies when the table has none
+ALTER FOREIGN TABLE ftable OPTIONS ( DROP batch_size );
+ALTER SERVER loopback OPTIONS ( ADD batch_size '3' );
+INSERT INTO ftable SELECT * FROM generate_series(37, 43) i;
+SELECT COUNT(*), SUM(x) FROM ftable;
+ALTER SERVER loopback OPTIONS ( DROP batch_size );
+-- batch_size must be positive
+ALTER FOREIGN TABLE ftable OPTIONS ( ADD batch_size '0' );
+DROP FOREIGN TABLE ftable;
+DROP TABLE batch_table;
+
+-- ===================================================================
+-- test asynchronous scans
+-- ===================================================================
+CREATE TABLE async_pt ( a int, b int );
+CREATE TABLE base_tbl1 ( a int, b int );
+CREATE TABLE base_tbl2 ( a int, b int );
+INSERT INTO base_tbl1 SELECT i, i % 10 FROM generate_series(1, 100) i;
+INSERT INTO base_tbl2 SELECT i, i % 10 FROM generate_series(101, 200) i;
+-- a small fetch_size makes every scan prefetch several batches
+CREATE FOREIGN TABLE async_p1 () INHERITS (async_pt) SERVER loopback
+	OPTIONS ( table_name 'base_tbl1', async_capable 'true', fetch_size '7' );
+CREATE FOREIGN TABLE async_p2 () INHERITS (async_pt) SERVER loopback2
+	OPTIONS ( table_name 'base_tbl2', async_capable 'true', fetch_size '7' );
+-- both servers are scanned under one Append
+SELECT COUNT(*), SUM(a) FROM async_pt;
+SELECT * FROM async_pt WHERE b = 0 ORDER BY a;
+-- two async scans sharing one connection
+SELECT COUNT(*), SUM(a) FROM (SELECT a FROM async_p1 UNION ALL SELECT a FROM async_p1) s;
+-- a scan ended early leaves a pending FETCH for the next command to collect
+SELECT a FROM async_p1 ORDER BY a LIMIT 3;
+SELECT COUNT(*) FROM async_p1;
+-- scans with parameters fetch synchronously
+SELECT t.a, (SELECT COUNT(*) FROM async_p1 WHERE a < t.a) FROM (VALUES (5), (50)) t(a);
+-- switch it off again
+ALTER FOREIGN TABLE async_p1 OPTIONS ( SET async_capable 'false' );
+ALTER FOREIGN TABLE async_p2 OPTIONS ( SET async_capable 'false' );
+SELECT COUNT(*), SUM(a) FROM async_pt;
+-- async_capable must be a Boolean
+ALTER FOREIGN TABLE async_p1 OPTIONS ( SET async_capable 'maybe' );
+DROP FOREIGN TABLE async_p1;
+DROP FOREIGN TABLE async_p2;
+DROP TABLE async_pt;
+DROP TABLE base_tbl1;
+DROP TABLE base_tbl2;
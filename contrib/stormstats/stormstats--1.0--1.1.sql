@@ -0,0 +1,47 @@
+/* contrib/stormstats/stormstats--1.0--1.1.sql */
+
+-- complain if script is sourced in psql, rather than via ALTER EXTENSION
+\echo Use "ALTER EXTENSION stormstats UPDATE TO '1.1'" to load this file. \quit
+
+CREATE FUNCTION storm_statement_stats(
+    OUT nodename text,
+    OUT nodetype text,
+    OUT dbname text,
+    OUT queryid int8,
+    OUT query text,
+    OUT calls int8,
+    OUT plans int8,
+    OUT plan_time float8,
+    OUT exec_time float8,
+    OUT rows int8,
+    OUT commits int8,
+    OUT commit_time float8
+)
+RETURNS SETOF record
+AS 'MODULE_PATHNAME'
+LANGUAGE C;
+
+CREATE FUNCTION storm_statement_stats_reset()
+RETURNS void
+AS 'MODULE_PATHNAME'
+LANGUAGE C;
+
+-- one row per statement and node
+CREATE VIEW storm_statement_stats AS
+  SELECT * FROM storm_statement_stats();
+
+-- one row per distributed statement, summed up over all nodes
+CREATE VIEW storm_statements AS
+  SELECT dbname, queryid,
+         max(query) FILTER (WHERE nodetype = 'coordinator') AS query,
+         sum(calls) FILTER (WHERE nodetype = 'coordinator') AS calls,
+         sum(plan_time) AS plan_time,
+         sum(exec_time) FILTER (WHERE nodetype = 'coordinator') AS exec_time,
+         sum(exec_time) FILTER (WHERE nodetype = 'datanode') AS remote_exec_time,
+         max(exec_time) FILTER (WHERE nodetype = 'datanode') AS max_node_exec_time,
+         sum(rows) FILTER (WHERE nodetype = 'datanode') AS rows_shipped,
+         sum(commit_time) AS commit_time
+    FROM storm_statement_stats()
+   GROUP BY dbname, queryid;
+
+REVOKE ALL ON FUNCTION storm_statement_stats_reset() FROM PUBLIC;
@@ -1,8 +1,16 @@
 #include "postgres.h"
 
+#include <ctype.h>
 #include <unistd.h>
 
+#include "access/parallel.h"
+#include "access/xact.h"
 #include "catalog/pg_type.h"
+#include "executor/executor.h"
+#include "executor/instrument.h"
+#include "mb/pg_wchar.h"
+#include "parser/analyze.h"
+#include "tcop/tcopprot.h"
 #include "executor/spi.h"
 #include "miscadmin.h"
 #include "storage/ipc.h"
@@ -39,6 +47,10 @@ PG_MODULE_MAGIC;
 static const uint32 STORM_FILE_HEADER = 0x20120229;
 
 #define STORM_STATS_COLS 7
+#define STORM_STMT_COLS 12
+
+/* Longest statement text kept per entry */
+#define STORM_QUERY_LEN 1024
 
 typedef struct ssHashKey
 {
@@ -73,9 +85,48 @@ typedef struct LocalStatsEntry
     char            dbname[NAMEDATALEN];
 } LocalStatsEntry;
 
+/*
+ * Statement statistics are kept per node, keyed by the global query id the
+ * coordinator computed for the statement (PGXCQueryId), which datanodes get
+ * along with the session id. Summing up the entries of all nodes with the
+ * same id gives the cost of one distributed statement.
+ */
+typedef struct StmtHashKey
+{
+    Oid         dbid;
+    uint32      queryid;
+} StmtHashKey;
+
+typedef struct StmtCounters
+{
+    int64       calls;          /* executions on this node */
+    int64       plans;          /* plannings on this node */
+    double      plan_time;      /* total planning time, in msec */
+    double      exec_time;      /* total execution time, in msec */
+    int64       rows;           /* rows returned, shipped up on datanodes */
+    int64       commits;        /* commits which ran on remote nodes */
+    double      commit_time;    /* total time of remote prepare/commit, in msec */
+} StmtCounters;
+
+typedef struct StormStmtEntry
+{
+    StmtHashKey     key;         /* hash key of entry - MUST BE FIRST */
+    StmtCounters    counters;
+    slock_t         mutex;
+    char            query[STORM_QUERY_LEN];   /* set when entry is created */
+} StormStmtEntry;
+
+typedef enum StmtEvent
+{
+    STMT_EVENT_PLAN,
+    STMT_EVENT_EXEC,
+    STMT_EVENT_COMMIT
+} StmtEvent;
+
 typedef struct StormSharedState
 {
     LWLock *lock;
+    LWLock *stmt_lock;          /* protects StmtEntryHash */
 } StormSharedState;
 
 static bool sp_save;            /* whether to save stats across shutdown */
@@ -92,14 +143,30 @@ static int ss_match_fn(const void *key1, const void *key2, Size keysize);
 static void stats_store(const char *dbname, CmdType c, bool isConnEvent, bool isUtilEvent);
 
 static StormStatsEntry *alloc_event_entry(ssHashKey *key);
+static const char *stmt_text(const char *source, int location, int len, int *query_len);
+static void stmt_store(uint32 queryid, StmtEvent event, const char *query,
+                       int query_len, double time, uint64 rows);
+
+static void storm_post_parse_analyze(ParseState *pstate, Query *query);
+static void storm_ExecutorStart(QueryDesc *queryDesc, int eflags);
+static void storm_ExecutorRun(QueryDesc *queryDesc, ScanDirection direction,
+                              uint64 count, bool execute_once);
+static void storm_ExecutorFinish(QueryDesc *queryDesc);
+static void storm_ExecutorEnd(QueryDesc *queryDesc);
+static void storm_xact_callback(XactEvent event, void *arg);
 
 /* Functions */
 Datum storm_database_stats(PG_FUNCTION_ARGS);
+Datum storm_statement_stats(PG_FUNCTION_ARGS);
+Datum storm_statement_stats_reset(PG_FUNCTION_ARGS);
 
 PG_FUNCTION_INFO_V1(storm_database_stats);
+PG_FUNCTION_INFO_V1(storm_statement_stats);
+PG_FUNCTION_INFO_V1(storm_statement_stats_reset);
 
 /* Shared Memory Objects */
 static HTAB *StatsEntryHash = NULL;
+static HTAB *StmtEntryHash = NULL;
 static StormSharedState *shared_state = NULL;
 
 /* Session level objects */
@@ -109,7 +176,25 @@ static ClientAuthentication_hook_type original_client_auth_hook = NULL;
 
 static ProcessUtility_hook_type prev_ProcessUtility = NULL;
 
+static post_parse_analyze_hook_type prev_post_parse_analyze_hook = NULL;
+static ExecutorStart_hook_type prev_ExecutorStart = NULL;
+static ExecutorRun_hook_type prev_ExecutorRun = NULL;
+static ExecutorFinish_hook_type prev_ExecutorFinish = NULL;
+static ExecutorEnd_hook_type prev_ExecutorEnd = NULL;
+
 static int max_tracked_dbs;
+static int max_tracked_stmts;
+static bool track_stmts;
+
+/* Current nesting depth of ExecutorRun+ExecutorFinish calls */
+static int nested_level = 0;
+
+/* Statement last run by the current transaction, gets its commit time */
+static uint32 last_queryid = 0;
+
+/* Only top level statements are tracked, parallel workers add to the leader */
+#define stmt_tracking() \
+    (track_stmts && StmtEntryHash != NULL && nested_level == 0 && !IsParallelWorker())
 
 static void
 ProcessUtility_callback(PlannedStmt *pstmt,
@@ -124,6 +209,10 @@ ProcessUtility_callback(PlannedStmt *pstmt,
 
     elog( DEBUG1, "STORMSTATS: using plugin." );
 
+    /* utility statements do not carry a query id to the remote nodes */
+    if (nested_level == 0 && IS_PGXC_LOCAL_COORDINATOR)
+        PGXCQueryId = 0;
+
     standard_ProcessUtility(pstmt, queryString, context, params, queryEnv,
                             dest, sentToRemote, completionTag);
 
@@ -215,6 +304,30 @@ _PG_init(void)
                             NULL,
                             NULL);
 
+    DefineCustomIntVariable("storm_stats.max_tracked_statements",
+                            "Sets the maximum number of statements tracked per node.",
+                            NULL,
+                            &max_tracked_stmts,
+                            5000,
+                            100,
+                            INT_MAX,
+                            PGC_POSTMASTER,
+                            0,
+                            NULL,
+                            NULL,
+                            NULL);
+
+    DefineCustomBoolVariable("storm_stats.track_statements",
+                             "Collects statistics of statements by global query id.",
+                             NULL,
+                             &track_stmts,
+                             true,
+                             PGC_SUSET,
+                             0,
+                             NULL,
+                             NULL,
+                             NULL);
+
     DefineCustomBoolVariable("storm_stats.save",
                              "Save statistics across server shutdowns.",
                              NULL,
@@ -229,7 +342,7 @@ _PG_init(void)
     EmitWarningsOnPlaceholders("storm_stats");
 
     RequestAddinShmemSpace(hash_memsize());
-    RequestNamedLWLockTranche("storm_stats", 1);
+    RequestNamedLWLockTranche("storm_stats", 2);
 
     prev_shmem_startup_hook = shmem_startup_hook;
     shmem_startup_hook = sp_shmem_startup;
@@ -241,6 +354,19 @@ _PG_init(void)
     prev_ProcessUtility = ProcessUtility_hook;
     ProcessUtility_hook = ProcessUtility_callback;
 
+    prev_post_parse_analyze_hook = post_parse_analyze_hook;
+    post_parse_analyze_hook = storm_post_parse_analyze;
+    prev_ExecutorStart = ExecutorStart_hook;
+    ExecutorStart_hook = storm_ExecutorStart;
+    prev_ExecutorRun = ExecutorRun_hook;
+    ExecutorRun_hook = storm_ExecutorRun;
+    prev_ExecutorFinish = ExecutorFinish_hook;
+    ExecutorFinish_hook = storm_ExecutorFinish;
+    prev_ExecutorEnd = ExecutorEnd_hook;
+    ExecutorEnd_hook = storm_ExecutorEnd;
+
+    RegisterXactCallback(storm_xact_callback, NULL);
+
     elog( DEBUG1, "STORMSTATS: plugin loaded" );
 }
 
@@ -250,6 +376,12 @@ _PG_fini(void)
     shmem_startup_hook = prev_shmem_startup_hook;
     planner_hook = NULL;
     ProcessUtility_hook = prev_ProcessUtility;
+    post_parse_analyze_hook = prev_post_parse_analyze_hook;
+    ExecutorStart_hook = prev_ExecutorStart;
+    ExecutorRun_hook = prev_ExecutorRun;
+    ExecutorFinish_hook = prev_ExecutorFinish;
+    ExecutorEnd_hook = prev_ExecutorEnd;
+    UnregisterXactCallback(storm_xact_callback, NULL);
 
     elog( DEBUG1, "STORMSTATS: plugin unloaded." );
 }
@@ -257,6 +389,7 @@ _PG_fini(void)
 static void sp_shmem_startup(void)
 {
     HASHCTL        event_ctl;
+    HASHCTL        stmt_ctl;
     bool        found;
     FILE           *file;
     uint32        header;
@@ -278,7 +411,10 @@ static void sp_shmem_startup(void)
         elog(ERROR, "out of shared memory");
 
     if (!found)
-        shared_state->lock = &(GetNamedLWLockTranche("storm_stats"))->lock;
+    {
+        shared_state->lock = &(GetNamedLWLockTranche("storm_stats"))[0].lock;
+        shared_state->stmt_lock = &(GetNamedLWLockTranche("storm_stats"))[1].lock;
+    }
 
     memset(&event_ctl, 0, sizeof(event_ctl));
 
@@ -293,6 +429,18 @@ static void sp_shmem_startup(void)
     if (!StatsEntryHash)
         elog(ERROR, "out of shared memory");
 
+    /* statement statistics are not saved across shutdowns */
+    memset(&stmt_ctl, 0, sizeof(stmt_ctl));
+
+    stmt_ctl.keysize = sizeof(StmtHashKey);
+    stmt_ctl.entrysize = sizeof(StormStmtEntry);
+
+    StmtEntryHash = ShmemInitHash("storm_stats statement hash", max_tracked_stmts,
+                                  max_tracked_stmts, &stmt_ctl,
+                                  HASH_ELEM | HASH_BLOBS);
+    if (!StmtEntryHash)
+        elog(ERROR, "out of shared memory");
+
     LWLockRelease(AddinShmemInitLock);
 
     /*
@@ -441,12 +589,34 @@ error:
 PlannedStmt *planner_callback(Query *parse, int cursorOptions, ParamListInfo boundParams)
 {
     PlannedStmt  *plan;
+    bool          track;
+    instr_time    start;
+    instr_time    duration;
 
     elog( DEBUG1, "STORMSTATS: using plugin." );
 
+    /* Only the coordinator receiving the statement plans it as a whole */
+    track = stmt_tracking() && IS_PGXC_LOCAL_COORDINATOR && parse->queryId != 0;
+    if (track)
+        INSTR_TIME_SET_CURRENT(start);
+
     /* Generate a plan */
     plan = standard_planner(parse, cursorOptions, boundParams);
 
+    if (track)
+    {
+        const char *query = debug_query_string;
+        int         query_len = 0;
+
+        INSTR_TIME_SET_CURRENT(duration);
+        INSTR_TIME_SUBTRACT(duration, start);
+
+        if (query != NULL)
+            query = stmt_text(query, parse->stmt_location, parse->stmt_len, &query_len);
+        stmt_store(parse->queryId, STMT_EVENT_PLAN, query, query_len,
+                   INSTR_TIME_GET_MILLISEC(duration), 0);
+    }
+
     stats_store(get_database_name(MyDatabaseId), parse->commandType, false, false);
 
     return plan;
@@ -478,6 +648,7 @@ static Size hash_memsize(void)
     state_size = MAXALIGN(sizeof(StormSharedState));
 
     size = add_size(events_size, state_size);
+    size = add_size(size, hash_estimate_size(max_tracked_stmts, sizeof(StormStmtEntry)));
 
     return size;
 }
@@ -600,6 +771,360 @@ stats_store(const char *dbname, CmdType c, bool isConnEvent, bool isUtilEvent)
     LWLockRelease(shared_state->lock);
 }
 
+/*
+ * Find the text of one statement within a possibly multi-statement source
+ * string, as given by stmt_location and stmt_len.
+ */
+static const char *
+stmt_text(const char *source, int location, int len, int *query_len)
+{
+    if (location >= 0)
+    {
+        Assert(location <= strlen(source));
+        source += location;
+    }
+
+    if (len <= 0)
+        len = strlen(source);
+
+    /* skip leading whitespace, we don't want it in the stored text */
+    while (len > 0 && isspace((unsigned char) *source))
+    {
+        source++;
+        len--;
+    }
+
+    *query_len = len;
+    return source;
+}
+
+/*
+ * Compute the global query id of a statement on the coordinator that
+ * received it. Literals are hashed as placeholders and whitespace and case
+ * are folded, so statements that only differ in constants share an id, and
+ * the same statement gets the same id on every coordinator.
+ */
+static uint32
+storm_query_hash(const char *query, int len)
+{
+    StringInfoData  buf;
+    uint32          queryid;
+    bool            space = false;
+    int             i = 0;
+
+    initStringInfo(&buf);
+
+    while (i < len)
+    {
+        unsigned char c = (unsigned char) query[i];
+
+        if (isspace(c))
+        {
+            space = buf.len > 0;
+            i++;
+            continue;
+        }
+
+        if (space)
+        {
+            appendStringInfoChar(&buf, ' ');
+            space = false;
+        }
+
+        if (c == '\'')
+        {
+            /* string literal, '' is a quote inside of it */
+            for (i++; i < len; i++)
+            {
+                if (query[i] != '\'')
+                    continue;
+                if (i + 1 < len && query[i + 1] == '\'')
+                    i++;
+                else
+                    break;
+            }
+            i++;
+            appendStringInfoChar(&buf, '?');
+        }
+        else if (isdigit(c) &&
+                 (i == 0 || !(isalnum((unsigned char) query[i - 1]) ||
+                              query[i - 1] == '_' || query[i - 1] == '$')))
+        {
+            /* numeric literal, but neither a part of a name nor a $n param */
+            while (i < len && (isalnum((unsigned char) query[i]) || query[i] == '.'))
+                i++;
+            appendStringInfoChar(&buf, '?');
+        }
+        else
+        {
+            appendStringInfoChar(&buf, pg_tolower(c));
+            i++;
+        }
+    }
+
+    queryid = DatumGetUInt32(hash_any((const unsigned char *) buf.data, buf.len));
+    pfree(buf.data);
+
+    /* zero means no query id */
+    return queryid != 0 ? queryid : 1;
+}
+
+/*
+ * Assign the global query id to statements received from the client.
+ */
+static void
+storm_post_parse_analyze(ParseState *pstate, Query *query)
+{
+    const char *text;
+    int         len;
+
+    if (prev_post_parse_analyze_hook)
+        prev_post_parse_analyze_hook(pstate, query);
+
+    if (!StmtEntryHash || !IS_PGXC_LOCAL_COORDINATOR)
+        return;
+
+    /* utility statements are not tracked, leave ids set by others alone */
+    if (query->utilityStmt != NULL || query->queryId != 0 ||
+        pstate->p_sourcetext == NULL)
+        return;
+
+    text = stmt_text(pstate->p_sourcetext, query->stmt_location,
+                     query->stmt_len, &len);
+    query->queryId = storm_query_hash(text, len);
+}
+
+static void
+storm_ExecutorStart(QueryDesc *queryDesc, int eflags)
+{
+    if (nested_level == 0)
+    {
+        /*
+         * The coordinator sends the id of its statement to the remote nodes
+         * along with the session id, they track their part under it.
+         */
+        if (IS_PGXC_LOCAL_COORDINATOR)
+            PGXCQueryId = track_stmts ? queryDesc->plannedstmt->queryId : 0;
+        else if (!IsConnFromApp())
+            queryDesc->plannedstmt->queryId = PGXCQueryId;
+    }
+
+    if (prev_ExecutorStart)
+        prev_ExecutorStart(queryDesc, eflags);
+    else
+        standard_ExecutorStart(queryDesc, eflags);
+
+    if (stmt_tracking() && queryDesc->plannedstmt->queryId != 0 &&
+        queryDesc->totaltime == NULL)
+    {
+        MemoryContext oldcxt;
+
+        oldcxt = MemoryContextSwitchTo(queryDesc->estate->es_query_cxt);
+        queryDesc->totaltime = InstrAlloc(1, INSTRUMENT_TIMER);
+        MemoryContextSwitchTo(oldcxt);
+    }
+}
+
+static void
+storm_ExecutorRun(QueryDesc *queryDesc, ScanDirection direction,
+                  uint64 count, bool execute_once)
+{
+    nested_level++;
+    PG_TRY();
+    {
+        if (prev_ExecutorRun)
+            prev_ExecutorRun(queryDesc, direction, count, execute_once);
+        else
+            standard_ExecutorRun(queryDesc, direction, count, execute_once);
+        nested_level--;
+    }
+    PG_CATCH();
+    {
+        nested_level--;
+        PG_RE_THROW();
+    }
+    PG_END_TRY();
+}
+
+static void
+storm_ExecutorFinish(QueryDesc *queryDesc)
+{
+    nested_level++;
+    PG_TRY();
+    {
+        if (prev_ExecutorFinish)
+            prev_ExecutorFinish(queryDesc);
+        else
+            standard_ExecutorFinish(queryDesc);
+        nested_level--;
+    }
+    PG_CATCH();
+    {
+        nested_level--;
+        PG_RE_THROW();
+    }
+    PG_END_TRY();
+}
+
+static void
+storm_ExecutorEnd(QueryDesc *queryDesc)
+{
+    uint32      queryid = queryDesc->plannedstmt->queryId;
+
+    if (queryid != 0 && queryDesc->totaltime && stmt_tracking())
+    {
+        const char *query = queryDesc->sourceText;
+        int         query_len = 0;
+
+        /* make sure stats accumulation is done */
+        InstrEndLoop(queryDesc->totaltime);
+
+        if (query != NULL)
+            query = stmt_text(query,
+                              queryDesc->plannedstmt->stmt_location,
+                              queryDesc->plannedstmt->stmt_len,
+                              &query_len);
+        stmt_store(queryid, STMT_EVENT_EXEC, query, query_len,
+                   queryDesc->totaltime->total * 1000.0,
+                   queryDesc->estate->es_processed);
+
+        if (IS_PGXC_LOCAL_COORDINATOR)
+            last_queryid = queryid;
+    }
+
+    if (prev_ExecutorEnd)
+        prev_ExecutorEnd(queryDesc);
+    else
+        standard_ExecutorEnd(queryDesc);
+
+    if (nested_level == 0 && IS_PGXC_LOCAL_COORDINATOR)
+        PGXCQueryId = 0;
+}
+
+/*
+ * Charge the time the coordinator spent preparing and committing on the
+ * remote nodes to the last statement of the transaction.
+ */
+static void
+storm_xact_callback(XactEvent event, void *arg)
+{
+    switch (event)
+    {
+        case XACT_EVENT_COMMIT:
+            if (last_queryid != 0 && XactRemoteCommitTime > 0 &&
+                IS_PGXC_LOCAL_COORDINATOR && StmtEntryHash != NULL)
+                stmt_store(last_queryid, STMT_EVENT_COMMIT, NULL, 0,
+                           XactRemoteCommitTime / 1000.0, 0);
+            last_queryid = 0;
+            break;
+        case XACT_EVENT_ABORT:
+            last_queryid = 0;
+            break;
+        default:
+            break;
+    }
+}
+
+/*
+ * Create an entry for a statement, NULL if there is no room left for it.
+ * Caller must hold stmt_lock exclusively.
+ */
+static StormStmtEntry *
+alloc_stmt_entry(StmtHashKey *key, const char *query, int query_len)
+{
+    StormStmtEntry *entry;
+    bool            found;
+
+    if (hash_get_num_entries(StmtEntryHash) >= max_tracked_stmts)
+        return NULL;
+
+    entry = (StormStmtEntry *) hash_search(StmtEntryHash, key, HASH_ENTER, &found);
+
+    if (!found)
+    {
+        memset(&entry->counters, 0, sizeof(StmtCounters));
+        SpinLockInit(&entry->mutex);
+
+        if (query != NULL)
+        {
+            query_len = pg_mbcliplen(query, query_len, STORM_QUERY_LEN - 1);
+            memcpy(entry->query, query, query_len);
+        }
+        else
+            query_len = 0;
+        entry->query[query_len] = '\0';
+    }
+
+    return entry;
+}
+
+static void
+stmt_store(uint32 queryid, StmtEvent event, const char *query,
+           int query_len, double time, uint64 rows)
+{
+    StmtHashKey     key;
+    StormStmtEntry *entry;
+
+    if (!shared_state || !StmtEntryHash)
+        return;
+
+    key.dbid = MyDatabaseId;
+    key.queryid = queryid;
+
+    /* Lookup the hash table entry with shared lock. */
+    LWLockAcquire(shared_state->stmt_lock, LW_SHARED);
+
+    entry = (StormStmtEntry *) hash_search(StmtEntryHash, &key, HASH_FIND, NULL);
+    if (!entry)
+    {
+        /* called after commit, where we must not fail */
+        if (event == STMT_EVENT_COMMIT)
+        {
+            LWLockRelease(shared_state->stmt_lock);
+            return;
+        }
+
+        /* Must acquire exclusive lock to add a new entry. */
+        LWLockRelease(shared_state->stmt_lock);
+        LWLockAcquire(shared_state->stmt_lock, LW_EXCLUSIVE);
+        entry = alloc_stmt_entry(&key, query, query_len);
+
+        /* table is full, statements not seen before are not tracked */
+        if (!entry)
+        {
+            LWLockRelease(shared_state->stmt_lock);
+            return;
+        }
+    }
+
+    /* Grab the spinlock while updating the counters. */
+    {
+        volatile StormStmtEntry *e = (volatile StormStmtEntry *) entry;
+
+        SpinLockAcquire(&e->mutex);
+
+        switch (event)
+        {
+            case STMT_EVENT_PLAN:
+                e->counters.plans += 1;
+                e->counters.plan_time += time;
+                break;
+            case STMT_EVENT_EXEC:
+                e->counters.calls += 1;
+                e->counters.exec_time += time;
+                e->counters.rows += rows;
+                break;
+            case STMT_EVENT_COMMIT:
+                e->counters.commits += 1;
+                e->counters.commit_time += time;
+                break;
+        }
+        SpinLockRelease(&e->mutex);
+    }
+
+    LWLockRelease(shared_state->stmt_lock);
+}
+
 /*
  * Gather statistics from remote coordinators
  */
@@ -897,3 +1422,211 @@ Datum storm_database_stats(PG_FUNCTION_ARGS)
 
     return (Datum) 0;
 }
+
+/*
+ * Run a query on all other nodes of the cluster, and add the rows it
+ * returns to tupstore unless that is NULL.
+ */
+static void
+storm_exec_on_nodes(char *query, TupleDesc tupdesc, Tuplestorestate *tupstore)
+{
+    EState        *estate;
+    TupleTableSlot *result;
+    RemoteQuery *step;
+    RemoteQueryState *node;
+    MemoryContext oldcontext;
+    int            i;
+
+    step = makeNode(RemoteQuery);
+
+    step->combine_type = COMBINE_TYPE_NONE;
+    step->exec_nodes = NULL;
+    step->sql_statement = query;
+    step->force_autocommit = false;
+    step->read_only = true;
+    step->exec_type = EXEC_ON_ALL_NODES;
+
+    for (i = 0; i < tupdesc->natts; ++i)
+    {
+        Var           *var;
+        TargetEntry *tle;
+
+        var = makeVar(1,
+                      tupdesc->attrs[i]->attnum,
+                      tupdesc->attrs[i]->atttypid,
+                      tupdesc->attrs[i]->atttypmod,
+                      InvalidOid,
+                      0);
+
+        tle = makeTargetEntry((Expr *) var, tupdesc->attrs[i]->attnum, NULL, false);
+        step->scan.plan.targetlist = lappend(step->scan.plan.targetlist, tle);
+    }
+
+    estate = CreateExecutorState();
+
+    oldcontext = MemoryContextSwitchTo(estate->es_query_cxt);
+
+    estate->es_snapshot = GetActiveSnapshot();
+
+    node = ExecInitRemoteQuery(step, estate, 0);
+    MemoryContextSwitchTo(oldcontext);
+
+    result = ExecRemoteQuery((PlanState *) node);
+    while (result != NULL && !TupIsNull(result))
+    {
+        if (tupstore)
+        {
+            slot_getallattrs(result);
+            tuplestore_puttupleslot(tupstore, result);
+        }
+        result = ExecRemoteQuery((PlanState *) node);
+    }
+    ExecEndRemoteQuery(node);
+}
+
+/*
+ * Statement statistics of this node, and of all the other nodes when called
+ * by a client. One row per statement and node.
+ */
+Datum storm_statement_stats(PG_FUNCTION_ARGS)
+{
+    ReturnSetInfo       *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+    TupleDesc           tupdesc;
+    Tuplestorestate     *tupstore;
+    MemoryContext       per_query_ctx;
+    MemoryContext       oldcontext;
+    HASH_SEQ_STATUS     hash_seq;
+    StormStmtEntry      *entry;
+    StormStmtEntry      *entries;
+    int                 num_entries = 0;
+    int                 n;
+
+    if (!shared_state || !StmtEntryHash)
+        ereport(ERROR,
+                (errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+                 errmsg("storm_stats must be loaded via shared_preload_libraries")));
+
+    /* check to see if caller supports us returning a tuplestore */
+    if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo))
+        ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                 errmsg("set-valued function called in context that cannot accept a set")));
+    if (!(rsinfo->allowedModes & SFRM_Materialize))
+        ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                 errmsg("materialize mode required, but it is not " \
+                        "allowed in this context")));
+
+    per_query_ctx = rsinfo->econtext->ecxt_per_query_memory;
+    oldcontext = MemoryContextSwitchTo(per_query_ctx);
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+        elog(ERROR, "return type must be a row type");
+    Assert(tupdesc->natts == STORM_STMT_COLS);
+
+    tupstore = tuplestore_begin_heap(true, false, work_mem);
+    rsinfo->returnMode = SFRM_Materialize;
+    rsinfo->setResult = tupstore;
+    rsinfo->setDesc = tupdesc;
+
+    MemoryContextSwitchTo(oldcontext);
+
+    /* copy the entries out, looking up database names under the lock won't do */
+    LWLockAcquire(shared_state->stmt_lock, LW_SHARED);
+
+    entries = (StormStmtEntry *) palloc(sizeof(StormStmtEntry) *
+                                        Max(hash_get_num_entries(StmtEntryHash), 1));
+
+    hash_seq_init(&hash_seq, StmtEntryHash);
+    while ((entry = hash_seq_search(&hash_seq)) != NULL)
+    {
+        volatile StormStmtEntry *e = (volatile StormStmtEntry *) entry;
+        StormStmtEntry *copy = &entries[num_entries++];
+
+        copy->key = entry->key;
+        strlcpy(copy->query, entry->query, STORM_QUERY_LEN);
+
+        SpinLockAcquire(&e->mutex);
+        copy->counters = e->counters;
+        SpinLockRelease(&e->mutex);
+    }
+
+    LWLockRelease(shared_state->stmt_lock);
+
+    for (n = 0; n < num_entries; n++)
+    {
+        Datum           values[STORM_STMT_COLS];
+        bool            nulls[STORM_STMT_COLS];
+        int             i = 0;
+        char           *dbname;
+
+        entry = &entries[n];
+
+        memset(values, 0, sizeof(values));
+        memset(nulls, 0, sizeof(nulls));
+
+        values[i++] = CStringGetTextDatum(PGXCNodeName);
+        values[i++] = CStringGetTextDatum(IS_PGXC_COORDINATOR ? "coordinator" : "datanode");
+        dbname = get_database_name(entry->key.dbid);
+        if (dbname)
+            values[i++] = CStringGetTextDatum(dbname);
+        else
+            nulls[i++] = true;
+        values[i++] = Int64GetDatumFast((int64) entry->key.queryid);
+        values[i++] = CStringGetTextDatum(entry->query);
+        values[i++] = Int64GetDatumFast(entry->counters.calls);
+        values[i++] = Int64GetDatumFast(entry->counters.plans);
+        values[i++] = Float8GetDatumFast(entry->counters.plan_time);
+        values[i++] = Float8GetDatumFast(entry->counters.exec_time);
+        values[i++] = Int64GetDatumFast(entry->counters.rows);
+        values[i++] = Int64GetDatumFast(entry->counters.commits);
+        values[i++] = Float8GetDatumFast(entry->counters.commit_time);
+
+        Assert(i == STORM_STMT_COLS);
+
+        tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+    }
+
+    pfree(entries);
+
+    /* The other nodes report their own part of the statements */
+    if (IsConnFromApp())
+        storm_exec_on_nodes("SELECT * FROM storm_statement_stats()", tupdesc, tupstore);
+
+    /* clean up and return the tuplestore */
+    tuplestore_donestoring(tupstore);
+
+    return (Datum) 0;
+}
+
+/*
+ * Drop all statement statistics, on all nodes when called by a client.
+ */
+Datum storm_statement_stats_reset(PG_FUNCTION_ARGS)
+{
+    HASH_SEQ_STATUS     hash_seq;
+    StormStmtEntry      *entry;
+
+    if (!shared_state || !StmtEntryHash)
+        ereport(ERROR,
+                (errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+                 errmsg("storm_stats must be loaded via shared_preload_libraries")));
+
+    LWLockAcquire(shared_state->stmt_lock, LW_EXCLUSIVE);
+
+    hash_seq_init(&hash_seq, StmtEntryHash);
+    while ((entry = hash_seq_search(&hash_seq)) != NULL)
+        hash_search(StmtEntryHash, &entry->key, HASH_REMOVE, NULL);
+
+    LWLockRelease(shared_state->stmt_lock);
+
+    if (IsConnFromApp())
+    {
+        TupleDesc   tupdesc = CreateTemplateTupleDesc(1, false);
+
+        TupleDescInitEntry(tupdesc, (AttrNumber) 1, "reset", VOIDOID, -1, 0);
+        storm_exec_on_nodes("SELECT storm_statement_stats_reset()", tupdesc, NULL);
+    }
+
+    PG_RETURN_VOID();
+}
@@ -0,0 +1,34 @@
+/* contrib/tbase_pooler_stat/tbase_pooler_stat--1.0--1.1.sql */
+
+-- complain if script is sourced in psql, rather than via ALTER EXTENSION
+\echo Use "ALTER EXTENSION tbase_pooler_stat UPDATE TO '1.1'" to load this file. \quit
+
+CREATE FUNCTION tbase_get_pooler_latency_statistics(
+	OUT database name,
+	OUT user_name name,
+	OUT node_name name,
+	OUT is_coord bool,
+	OUT metric text,
+	OUT latency_below_us int8,
+	OUT count int8
+)
+RETURNS SETOF record
+AS 'MODULE_PATHNAME'
+LANGUAGE C;
+
+-- Approximate percentiles per node pool, from the upper bound of the buckets.
+-- NULL means the value is beyond the last bounded bucket.
+CREATE VIEW tbase_pooler_latency AS
+	SELECT database, user_name, node_name, is_coord, metric,
+		   sum(count) AS count,
+		   min(latency_below_us) FILTER (WHERE running >= total * 0.5) AS p50_us,
+		   min(latency_below_us) FILTER (WHERE running >= total * 0.9) AS p90_us,
+		   min(latency_below_us) FILTER (WHERE running >= total * 0.99) AS p99_us,
+		   CASE WHEN bool_or(latency_below_us IS NULL) THEN NULL
+				ELSE max(latency_below_us) END AS max_us
+	FROM (SELECT h.*,
+				 sum(count) OVER (PARTITION BY database, user_name, node_name, metric
+								  ORDER BY latency_below_us NULLS LAST) AS running,
+				 sum(count) OVER (PARTITION BY database, user_name, node_name, metric) AS total
+		  FROM tbase_get_pooler_latency_statistics() h) s
+	GROUP BY database, user_name, node_name, is_coord, metric;
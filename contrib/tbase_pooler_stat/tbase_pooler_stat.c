@@ -38,6 +38,7 @@ PG_MODULE_MAGIC;
 PG_FUNCTION_INFO_V1(tbase_get_pooler_cmd_statistics);
 PG_FUNCTION_INFO_V1(tbase_reset_pooler_cmd_statistics);
 PG_FUNCTION_INFO_V1(tbase_get_pooler_conn_statistics);
+PG_FUNCTION_INFO_V1(tbase_get_pooler_latency_statistics);
 
 typedef struct
 {
@@ -54,6 +55,18 @@ typedef struct
     StringInfo   buf;                  /* a stringInfo buf store the result */
 } Pooler_ConnState;
 
+typedef struct
+{
+    uint32       total_node_cursor;    /* node pools not yet returned */
+    const char   *database;            /* current node pool's database */
+    const char   *username;            /* current node pool's username */
+    const char   *nodename;            /* current node pool's node name */
+    bool         is_coord;             /* current node pool is a coordinator */
+    uint32       bucket_cursor;        /* next bucket of the current node pool */
+    uint32       hist[POOL_LATENCY_COUNT * POOL_LATENCY_BUCKETS];
+    StringInfo   buf;                  /* a stringInfo buf store the result */
+} Pooler_LatencyState;
+
 
 /* the g_pooler_cmd_name_tab and g_pooler_cmd must be in the same order */
 static char *g_pooler_cmd_name_tab[POOLER_CMD_COUNT] =
@@ -75,7 +88,17 @@ static char *g_pooler_cmd_name_tab[POOLER_CMD_COUNT] =
     "CLOSE_POOLER_CONN",      /* Close pooler connections*/
     "GET_CMD_STATSTICS",      /* Get command statistics */
     "RESET_CMD_STATISTICS",   /* Reset command statistics */
-    "GET_CONN_STATISTICS"     /* Get connection statistics */
+    "GET_CONN_STATISTICS",    /* Get connection statistics */
+    "GET_LATENCY_STATISTICS"  /* Get latency statistics */
+};
+
+/* the g_pooler_latency_name_tab and PoolLatencyType must be in the same order */
+static char *g_pooler_latency_name_tab[POOL_LATENCY_COUNT] =
+{
+    "acquire",                /* session waiting for a connection */
+    "set",                    /* replaying session params */
+    "build",                  /* async connection build */
+    "lifetime"                /* connection lifetime */
 };
 
 /*
@@ -307,4 +330,129 @@ tbase_get_pooler_conn_statistics(PG_FUNCTION_ARGS)
     }
 
     SRF_RETURN_DONE(funcctx);
-}
\ No newline at end of file
+}
+
+/*
+ * get pooler latency histograms, one row for each non empty bucket
+ */
+Datum
+tbase_get_pooler_latency_statistics(PG_FUNCTION_ARGS)
+{
+#define  LIST_POOLER_LATENCY_STATISTICS_COLUMNS 7
+    FuncCallContext 	 *funcctx = NULL;
+    int32                ret = 0;
+    Pooler_LatencyState  *status = NULL;
+    Datum		         values[LIST_POOLER_LATENCY_STATISTICS_COLUMNS];
+    bool		         nulls[LIST_POOLER_LATENCY_STATISTICS_COLUMNS];
+    HeapTuple	         tuple;
+    Datum		         result;
+
+    if (SRF_IS_FIRSTCALL())
+    {
+        MemoryContext oldcontext;
+        TupleDesc	  tupdesc;
+
+        funcctx = SRF_FIRSTCALL_INIT();
+
+        oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+        tupdesc = CreateTemplateTupleDesc(LIST_POOLER_LATENCY_STATISTICS_COLUMNS, false);
+        TupleDescInitEntry(tupdesc, (AttrNumber) 1, "database",
+                           NAMEOID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber) 2, "user_name",
+                           NAMEOID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber) 3, "node_name",
+                           NAMEOID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber) 4, "is_coord",
+                           BOOLOID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber) 5, "metric",
+                           TEXTOID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber) 6, "latency_below_us",
+                           INT8OID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber) 7, "count",
+                           INT8OID, -1, 0);
+
+        funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+        status = (Pooler_LatencyState*) palloc0(sizeof(Pooler_LatencyState));
+        status->bucket_cursor = POOL_LATENCY_COUNT * POOL_LATENCY_BUCKETS;
+        status->buf = makeStringInfo();
+
+        funcctx->user_fctx = (void*) status;
+
+        ret = PoolManagerGetLatencyStatistics(status->buf);
+        if (ret)
+        {
+            elog(ERROR, "get pooler latency statictics info from pooler failed");
+        }
+        else
+        {
+            status->total_node_cursor = pq_getmsgint(status->buf, sizeof(uint32));
+        }
+
+        MemoryContextSwitchTo(oldcontext);
+    }
+
+    funcctx = SRF_PERCALL_SETUP();
+    status  = (Pooler_LatencyState *) funcctx->user_fctx;
+
+    for (;;)
+    {
+        uint32 idx;
+        uint32 bucket;
+
+        if (status->bucket_cursor >= POOL_LATENCY_COUNT * POOL_LATENCY_BUCKETS)
+        {
+            int i;
+
+            if (status->total_node_cursor == 0)
+            {
+                break;
+            }
+
+            /* get next node pool */
+            status->database = pq_getmsgstring(status->buf);
+            status->username = pq_getmsgstring(status->buf);
+            status->nodename = pq_getmsgstring(status->buf);
+            status->is_coord = pq_getmsgint(status->buf, sizeof(bool));
+            for (i = 0; i < POOL_LATENCY_COUNT * POOL_LATENCY_BUCKETS; i++)
+            {
+                status->hist[i] = pq_getmsgint(status->buf, sizeof(uint32));
+            }
+            status->bucket_cursor = 0;
+            status->total_node_cursor--;
+        }
+
+        idx = status->bucket_cursor++;
+        if (status->hist[idx] == 0)
+        {
+            continue;
+        }
+
+        MemSet(values, 0, sizeof(values));
+        MemSet(nulls,  0, sizeof(nulls));
+
+        bucket = idx % POOL_LATENCY_BUCKETS;
+        values[0] = CStringGetDatum(status->database);
+        values[1] = CStringGetDatum(status->username);
+        values[2] = CStringGetDatum(status->nodename);
+        values[3] = BoolGetDatum(status->is_coord);
+        values[4] = CStringGetTextDatum(g_pooler_latency_name_tab[idx / POOL_LATENCY_BUCKETS]);
+        /* the last bucket is open ended */
+        if (bucket == POOL_LATENCY_BUCKETS - 1)
+        {
+            nulls[5] = true;
+        }
+        else
+        {
+            values[5] = Int64GetDatum(INT64CONST(1) << bucket);
+        }
+        values[6] = Int64GetDatum(status->hist[idx]);
+
+        tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+        result = HeapTupleGetDatum(tuple);
+        SRF_RETURN_NEXT(funcctx, result);
+    }
+
+    SRF_RETURN_DONE(funcctx);
+}
@@ -28,10 +28,13 @@
 
 #include "postgres.h"
 
+#include <math.h>
+
 #include "access/relscan.h"
 #include "access/tsmapi.h"
 #include "catalog/pg_type.h"
 #include "miscadmin.h"
+#include "nodes/plannodes.h"
 #include "optimizer/clauses.h"
 #include "optimizer/cost.h"
 #include "utils/sampling.h"
@@ -185,6 +188,22 @@ system_rows_beginsamplescan(SampleScanState *node,
                 (errcode(ERRCODE_INVALID_TABLESAMPLE_ARGUMENT),
                  errmsg("sample size must not be negative")));
 
+#ifdef __TBASE__
+    /*
+     * When the table is spread over several datanodes, take a share of the
+     * sample proportional to the rows stored here. Round up, so that the
+     * whole cluster returns at least the requested number of rows.
+     */
+    {
+        SampleScan *plan = (SampleScan *) node->ss.ps.plan;
+        double        local_tuples = node->ss.ss_currentRelation->rd_rel->reltuples;
+
+        if (plan->cluster_tuples > 0 &&
+            local_tuples > 0 && local_tuples < plan->cluster_tuples)
+            ntuples = (int64) ceil(ntuples * local_tuples / plan->cluster_tuples);
+    }
+#endif
+
     sampler->seed = seed;
     sampler->ntuples = ntuples;
     sampler->donetuples = 0;
@@ -29,10 +29,16 @@
 #include "postmaster/autovacuum.h"
 #include "storage/bufmgr.h"
 #include "storage/freespace.h"
+#ifdef _SHARDING_
+#include "storage/extentmapping.h"
+#endif
 #include "utils/builtins.h"
 #include "utils/index_selfuncs.h"
 #include "utils/memutils.h"
 #include "utils/rel.h"
+#ifdef _SHARDING_
+#include "utils/syscache.h"
+#endif
 
 
 /*
@@ -183,15 +189,38 @@ brininsert(Relation idxRel, Datum *values, bool *nulls,
             BlockNumber lastPageRange = heapBlk - 1;
             BrinTuple  *lastPageTuple;
 
-            lastPageTuple =
-                brinGetTupleForHeapBlock(revmap, lastPageRange, &buf, &off,
-                                         NULL, BUFFER_LOCK_SHARE, NULL);
-            if (!lastPageTuple)
-                AutoVacuumRequestWork(AVW_BRINSummarizeRange,
-                                      RelationGetRelid(idxRel),
-                                      lastPageRange);
-            else
-                LockBuffer(buf, BUFFER_LOCK_UNLOCK);
+#ifdef _SHARDING_
+            /*
+             * In a table stored in extents, the block before a new extent
+             * belongs to some other shard. The range this shard just filled
+             * up is the last one of its previous extent.
+             */
+            if (RelationHasExtent(heapRel) && heapBlk % PAGES_PER_EXTENTS == 0)
+            {
+                ExtentID    prev;
+
+                prev = ema_prev_scan(heapRel, BLOCKNUMBER_TO_EXTENTID(heapBlk),
+                                     NULL, NULL);
+                if (ExtentIdIsValid(prev))
+                    lastPageRange = EXTENT_FIRST_BLOCKNUMBER(prev) +
+                        PAGES_PER_EXTENTS - 1;
+                else
+                    lastPageRange = InvalidBlockNumber;
+            }
+
+            if (BlockNumberIsValid(lastPageRange))
+#endif
+            {
+                lastPageTuple =
+                    brinGetTupleForHeapBlock(revmap, lastPageRange, &buf, &off,
+                                             NULL, BUFFER_LOCK_SHARE, NULL);
+                if (!lastPageTuple)
+                    AutoVacuumRequestWork(AVW_BRINSummarizeRange,
+                                          RelationGetRelid(idxRel),
+                                          lastPageRange);
+                else
+                    LockBuffer(buf, BUFFER_LOCK_UNLOCK);
+            }
         }
 
         brtup = brinGetTupleForHeapBlock(revmap, heapBlk, &buf, &off,
@@ -638,6 +667,66 @@ brinbuildCallback(Relation index,
     }
 }
 
+#ifdef _SHARDING_
+/*
+ * Range size to build a BRIN index with.
+ *
+ * An extent of a table stored in extents holds the tuples of a single shard,
+ * but neighbouring extents belong to unrelated shards, so a range spanning
+ * several extents gets a summary too wide to exclude anything. On such
+ * tables ranges are aligned with extents: one range per extent unless
+ * pages_per_range is given, and a given size is rounded down to a divisor
+ * of the extent size.
+ */
+static BlockNumber
+brin_build_pages_per_range(Relation heap, Relation index)
+{
+    BlockNumber pagesPerRange = BrinGetPagesPerRange(index);
+    BlockNumber aligned;
+    HeapTuple    tuple;
+    Datum        reloptions;
+    bool        isnull;
+    bool        explicit = false;
+    ListCell   *lc;
+
+    if (!RelationHasExtent(heap))
+        return pagesPerRange;
+
+    tuple = SearchSysCache1(RELOID, ObjectIdGetDatum(RelationGetRelid(index)));
+    if (!HeapTupleIsValid(tuple))
+        elog(ERROR, "cache lookup failed for relation %u",
+             RelationGetRelid(index));
+    reloptions = SysCacheGetAttr(RELOID, tuple, Anum_pg_class_reloptions,
+                                 &isnull);
+    if (!isnull)
+    {
+        foreach(lc, untransformRelOptions(reloptions))
+        {
+            DefElem    *def = (DefElem *) lfirst(lc);
+
+            if (strcmp(def->defname, "pages_per_range") == 0)
+                explicit = true;
+        }
+    }
+    ReleaseSysCache(tuple);
+
+    if (!explicit)
+        return PAGES_PER_EXTENTS;
+
+    /* PAGES_PER_EXTENTS is a power of two */
+    aligned = PAGES_PER_EXTENTS;
+    while (aligned > pagesPerRange)
+        aligned >>= 1;
+
+    if (aligned != pagesPerRange)
+        ereport(NOTICE,
+                (errmsg("pages_per_range of index \"%s\" rounded down to %u to align ranges with extents",
+                        RelationGetRelationName(index), aligned)));
+
+    return aligned;
+}
+#endif
+
 /*
  * brinbuild() -- build a new BRIN index.
  */
@@ -668,7 +757,12 @@ brinbuild(Relation heap, Relation index, IndexInfo *indexInfo)
     Assert(BufferGetBlockNumber(meta) == BRIN_METAPAGE_BLKNO);
     LockBuffer(meta, BUFFER_LOCK_EXCLUSIVE);
 
-    brin_metapage_init(BufferGetPage(meta), BrinGetPagesPerRange(index),
+#ifdef _SHARDING_
+    pagesPerRange = brin_build_pages_per_range(heap, index);
+#else
+    pagesPerRange = BrinGetPagesPerRange(index);
+#endif
+    brin_metapage_init(BufferGetPage(meta), pagesPerRange,
                        BRIN_CURRENT_VERSION);
     MarkBufferDirty(meta);
 
@@ -679,7 +773,7 @@ brinbuild(Relation heap, Relation index, IndexInfo *indexInfo)
         Page        page;
 
         xlrec.version = BRIN_CURRENT_VERSION;
-        xlrec.pagesPerRange = BrinGetPagesPerRange(index);
+        xlrec.pagesPerRange = pagesPerRange;
 
         XLogBeginInsert();
         XLogRegisterData((char *) &xlrec, SizeOfBrinCreateIdx);
@@ -1271,6 +1271,30 @@ slot_deform_tuple(TupleTableSlot *slot, int natts)
 
     tp = (char *) tup + tup->t_hoff;
 
+#ifdef __TBASE__
+    /*
+     * Fast path for the leading fixed-width columns of a tuple without
+     * nulls: once their offsets are cached by the first tuple, each value
+     * can be fetched straight from its cached offset without any alignment
+     * or null bitmap work.  Scans over wide tables mostly go through here.
+     */
+    if (attnum == 0 && !hasnulls)
+    {
+        for (; attnum < natts; attnum++)
+        {
+            Form_pg_attribute thisatt = att[attnum];
+
+            if (thisatt->attlen <= 0 || thisatt->attcacheoff < 0)
+                break;
+
+            off = thisatt->attcacheoff;
+            values[attnum] = fetchatt(thisatt, tp + off);
+            isnull[attnum] = false;
+            off += thisatt->attlen;
+        }
+    }
+#endif
+
     for (; attnum < natts; attnum++)
     {
         Form_pg_attribute thisatt = att[attnum];
@@ -83,6 +83,7 @@
 #include "access/nbtree.h"
 #include "access/reloptions.h"
 #include "access/spgist.h"
+#include "access/tuptoaster.h"
 #include "catalog/pg_type.h"
 #include "commands/defrem.h"
 #include "commands/tablespace.h"
@@ -489,6 +490,18 @@ static relopt_string stringRelOpts[] =
         validateWithCheckOption,
         NULL
     },
+    {
+        {
+            "compression",
+            "Compression method of toasted values of the column",
+            RELOPT_KIND_ATTRIBUTE,
+            ShareUpdateExclusiveLock
+        },
+        0,
+        true,
+        validate_toast_compression,
+        NULL
+    },
     /* list terminator */
     {{NULL}}
 };
@@ -1540,7 +1553,8 @@ attribute_reloptions(Datum reloptions, bool validate)
     int            numoptions;
     static const relopt_parse_elt tab[] = {
         {"n_distinct", RELOPT_TYPE_REAL, offsetof(AttributeOpts, n_distinct)},
-        {"n_distinct_inherited", RELOPT_TYPE_REAL, offsetof(AttributeOpts, n_distinct_inherited)}
+        {"n_distinct_inherited", RELOPT_TYPE_REAL, offsetof(AttributeOpts, n_distinct_inherited)},
+        {"compression", RELOPT_TYPE_STRING, offsetof(AttributeOpts, compression)}
     };
 
     options = parseRelOptions(reloptions, validate, RELOPT_KIND_ATTRIBUTE,
@@ -32,9 +32,21 @@
 #include "storage/indexfsm.h"
 #include "storage/lmgr.h"
 #include "utils/builtins.h"
+#include "utils/timestamp.h"
 
-/* GUC parameter */
+/* GUC parameters */
 int            gin_pending_list_limit = 0;
+bool        gin_pending_list_background_cleanup = false;
+
+/*
+ * Index whose pending list cleanup we last handed to autovacuum, and when.
+ * Inserters keep finding the list too long until a worker gets to it, this
+ * keeps them from queueing the request on every insert.
+ */
+static Oid    lastCleanupRequestIndex = InvalidOid;
+static TimestampTz lastCleanupRequestTime = 0;
+
+#define GIN_CLEANUP_REQUEST_INTERVAL_MS    1000
 
 #define GIN_PAGE_FREESIZE \
     ( BLCKSZ - MAXALIGN(SizeOfPageHeaderData) - MAXALIGN(sizeof(GinPageOpaqueData)) )
@@ -47,6 +59,7 @@ typedef struct KeyArray
     int32        maxvalues;        /* allocated size of arrays */
 } KeyArray;
 
+static bool ginRequestBackgroundCleanup(Relation index);
 
 /*
  * Build a pending-list page from the given array of tuples, and write it out.
@@ -440,10 +453,44 @@ ginHeapTupleFastInsert(GinState *ginstate, GinTupleCollector *collector)
 
     END_CRIT_SECTION();
 
-    if (needCleanup)
+    if (needCleanup && !ginRequestBackgroundCleanup(index))
         ginInsertCleanup(ginstate, false, true, NULL);
 }
 
+/*
+ * Leave the cleanup of a too long pending list to autovacuum, if
+ * gin_pending_list_background_cleanup is set, so that the inserter doesn't
+ * have to merge the list itself. The worker merges it in one pass with
+ * autovacuum_work_mem rather than work_mem, so in larger batches too.
+ *
+ * Returns false if the request could not be made, in which case the caller
+ * must clean up the list itself, or the list would grow without bound.
+ */
+static bool
+ginRequestBackgroundCleanup(Relation index)
+{
+    Oid            indexOid = RelationGetRelid(index);
+    TimestampTz now;
+
+    if (!gin_pending_list_background_cleanup || !AutoVacuumingActive() ||
+        RelationUsesLocalBuffers(index))
+        return false;
+
+    now = GetCurrentTimestamp();
+    if (indexOid == lastCleanupRequestIndex &&
+        !TimestampDifferenceExceeds(lastCleanupRequestTime, now,
+                                    GIN_CLEANUP_REQUEST_INTERVAL_MS))
+        return true;
+
+    if (!AutoVacuumRequestWork(AVW_GINCleanPendingList, indexOid,
+                               InvalidBlockNumber))
+        return false;
+
+    lastCleanupRequestIndex = indexOid;
+    lastCleanupRequestTime = now;
+    return true;
+}
+
 /*
  * Create temporary index tuples for a single indexable item (one index column
  * for the heap tuple specified by ht_ctid), and append them to the array
@@ -681,6 +681,138 @@ compute_hash(Oid type, Datum value, char locator)
     return (Datum)0;
 }
 
+#ifdef __TBASE__
+/*
+ * hash_uint32_batch
+ *        hash_uint32() of an array of keys.
+ *
+ * A plain loop without calls, which the compiler can keep in registers and
+ * turn into vector instructions.
+ */
+static void
+hash_uint32_batch(uint32 *keys, int nkeys)
+{
+    int     i;
+
+    for (i = 0; i < nkeys; i++)
+    {
+        uint32  a,
+                b,
+                c;
+
+        a = b = c = 0x9e3779b9 + (uint32) sizeof(uint32) + 3923095;
+        a += keys[i];
+
+        final(a, b, c);
+
+        keys[i] = c;
+    }
+}
+
+/*
+ * compute_hash_batch()
+ *        compute_hash() of an array of values of the same type.
+ *
+ * Used to route many rows in one go.  The common integer types and text are
+ * hashed in place without going through fmgr for every value; other types
+ * fall back to compute_hash().  A NULL value gets the hash value 0, which
+ * is where the shard locator puts NULLs.
+ */
+void
+compute_hash_batch(Oid type, Datum *values, bool *nulls, int nvalues,
+                   char locator, long *hashes)
+{
+    uint32 *keys;
+    int     i;
+
+#ifdef _MIGRATE_
+    if (locator != LOCATOR_TYPE_HASH && locator != LOCATOR_TYPE_SHARD)
+#else
+    if (locator != LOCATOR_TYPE_HASH)
+#endif
+        goto generic;
+
+    switch (type)
+    {
+        case INT2OID:
+        case INT4OID:
+        case INT8OID:
+        case OIDOID:
+            break;
+        case VARCHAROID:
+        case TEXTOID:
+#ifdef _PG_ORCL_
+        case VARCHAR2OID:
+        case NVARCHAR2OID:
+#endif
+            for (i = 0; i < nvalues; i++)
+            {
+                text   *key;
+
+                if (nulls && nulls[i])
+                {
+                    hashes[i] = 0;
+                    continue;
+                }
+
+                key = DatumGetTextPP(values[i]);
+                hashes[i] = (long) DatumGetUInt32(hash_any((unsigned char *) VARDATA_ANY(key),
+                                                           VARSIZE_ANY_EXHDR(key)));
+                if ((Pointer) key != DatumGetPointer(values[i]))
+                    pfree(key);
+            }
+            return;
+        default:
+            goto generic;
+    }
+
+    /* integer types: fold the values into 32 bits keys first, then hash */
+    keys = (uint32 *) palloc(sizeof(uint32) * nvalues);
+    for (i = 0; i < nvalues; i++)
+    {
+        switch (type)
+        {
+            case INT2OID:
+                keys[i] = (uint32) (int32) DatumGetInt16(values[i]);
+                break;
+            case INT4OID:
+                keys[i] = (uint32) DatumGetInt32(values[i]);
+                break;
+            case INT8OID:
+                {
+                    /* same folding as hashint8 */
+                    int64   val = DatumGetInt64(values[i]);
+                    uint32  lohalf = (uint32) val;
+                    uint32  hihalf = (uint32) (val >> 32);
+
+                    keys[i] = lohalf ^ ((val >= 0) ? hihalf : ~hihalf);
+                }
+                break;
+            case OIDOID:
+                keys[i] = (uint32) DatumGetObjectId(values[i]);
+                break;
+        }
+    }
+
+    hash_uint32_batch(keys, nvalues);
+
+    for (i = 0; i < nvalues; i++)
+        hashes[i] = (nulls && nulls[i]) ? 0 : (long) keys[i];
+
+    pfree(keys);
+    return;
+
+generic:
+    for (i = 0; i < nvalues; i++)
+    {
+        if (nulls && nulls[i])
+            hashes[i] = 0;
+        else
+            hashes[i] = (long) compute_hash(type, values[i], locator);
+    }
+}
+#endif
+
 
 /*
  * get_compute_hash_function
@@ -79,6 +79,8 @@
 #include "pgxc/pgxc.h"
 #endif
 #ifdef _SHARDING_
+#include "storage/extent_zonemap.h"
+#include "storage/extentmapping.h"
 #include "utils/guc.h"
 #endif
 #ifdef __TBASE__
@@ -95,6 +97,9 @@
 
 /* GUC variable */
 bool        synchronize_seqscans = true;
+#ifdef __TBASE__
+int         seqscan_prefetch_pages = 0;
+#endif
 
 
 static HeapScanDesc heap_beginscan_internal(Relation relation,
@@ -108,9 +113,21 @@ static HeapScanDesc heap_beginscan_internal(Relation relation,
                         bool is_samplescan,
                         bool temp_snap);
 static void heap_parallelscan_startblock_init(HeapScanDesc scan);
+#ifdef __TBASE__
+static void heapprefetch(HeapScanDesc scan, BlockNumber page);
+#endif
 static BlockNumber heap_parallelscan_nextpage(HeapScanDesc scan);
+#ifdef _SHARDING_
+static bool heap_scan_filters_shards(HeapScanDesc scan);
+static bool heap_shard_is_skipped(Snapshot snapshot, ShardID sid);
+static bool heap_extent_skip(HeapScanDesc scan, ScanDirection dir,
+                  BlockNumber *page, bool *finished);
+#endif
 static HeapTuple heap_prepare_insert(Relation relation, HeapTuple tup,
                     TransactionId xid, CommandId cid, int options);
+#ifdef _SHARDING_
+static HeapTuple *heap_multi_insert_group_shards(HeapTuple *tuples, int ntuples);
+#endif
 static XLogRecPtr log_heap_update(Relation reln, Buffer oldbuf,
                 Buffer newbuf, HeapTuple oldtup,
                 HeapTuple newtup, HeapTuple old_key_tup,
@@ -316,11 +333,20 @@ initscan(HeapScanDesc scan, ScanKey key, bool keep_startblock)
 
     scan->rs_numblocks = InvalidBlockNumber;
     scan->rs_inited = false;
+#ifdef _SHARDING_
+    scan->rs_extent_next = scan->rs_extent_end = InvalidBlockNumber;
+    scan->rs_zone_eid = InvalidExtentID;
+    scan->rs_zone_skip = false;
+#endif
 
     scan->rs_ctup.t_data = NULL;
     ItemPointerSetInvalid(&scan->rs_ctup.t_self);
     scan->rs_cbuf = InvalidBuffer;
     scan->rs_cblock = InvalidBlockNumber;
+#ifdef __TBASE__
+    scan->rs_prefetch_next = InvalidBlockNumber;
+    scan->rs_vmbuffer = InvalidBuffer;
+#endif
 
     /* page-at-a-time fields are always invalid when not rs_inited */
 
@@ -358,6 +384,45 @@ heap_setscanlimits(HeapScanDesc scan, BlockNumber startBlk, BlockNumber numBlks)
     scan->rs_numblocks = numBlks;
 }
 
+#ifdef __TBASE__
+/*
+ * heapprefetch - read ahead for a sequential scan
+ *
+ * Keep up to seqscan_prefetch_pages blocks after the one being read
+ * requested from the kernel, so that a scan has a queue of reads in flight
+ * instead of depending on the OS noticing the sequential pattern.  The
+ * window is only advanced while the scan moves forward one block at a time;
+ * backward, parallel and bitmap scans are left alone (the latter prefetch
+ * by themselves, see effective_io_concurrency).
+ */
+static void
+heapprefetch(HeapScanDesc scan, BlockNumber page)
+{
+#ifdef USE_PREFETCH
+    BlockNumber last;
+
+    if (scan->rs_bitmapscan || scan->rs_samplescan || scan->rs_parallel != NULL)
+        return;
+
+    if (scan->rs_cblock != InvalidBlockNumber && page != scan->rs_cblock + 1)
+    {
+        /* not moving forward, forget the window */
+        scan->rs_prefetch_next = InvalidBlockNumber;
+        return;
+    }
+
+    last = (BlockNumber) Min((uint64) page + seqscan_prefetch_pages,
+                             (uint64) scan->rs_nblocks - 1);
+    if (scan->rs_prefetch_next == InvalidBlockNumber ||
+        scan->rs_prefetch_next <= page)
+        scan->rs_prefetch_next = page + 1;
+
+    while (scan->rs_prefetch_next <= last)
+        PrefetchBuffer(scan->rs_rd, MAIN_FORKNUM, scan->rs_prefetch_next++);
+#endif
+}
+#endif
+
 /*
  * heapgetpage - subroutine for heapgettup()
  *
@@ -376,9 +441,17 @@ heapgetpage(HeapScanDesc scan, BlockNumber page)
     OffsetNumber lineoff;
     ItemId        lpp;
     bool        all_visible;
+#ifdef __TBASE__
+    bool        all_frozen = false;
+#endif
 
     Assert(page < scan->rs_nblocks);
 
+#ifdef __TBASE__
+    if (seqscan_prefetch_pages > 0)
+        heapprefetch(scan, page);
+#endif
+
     /* release previous scan buffer, if any */
     if (BufferIsValid(scan->rs_cbuf))
     {
@@ -409,6 +482,21 @@ heapgetpage(HeapScanDesc scan, BlockNumber page)
      */
     heap_page_prune_opt(scan->rs_rd, buffer);
 
+#ifdef __TBASE__
+    /*
+     * Tuples on an all-frozen page have a frozen xmin and no xmax, so every
+     * snapshot sees them, including one taken during recovery; the all-frozen
+     * bit is WAL-logged with the visibility map, unlike the page-level flag
+     * discussed below. Look it up before locking the heap page, it may have
+     * to read and pin a visibility map page. The pin is kept in the scan for
+     * the following pages.
+     */
+    if (!NeedMvcc() && snapshot->takenDuringRecovery)
+        all_frozen = (visibilitymap_get_status(scan->rs_rd, page,
+                                               &scan->rs_vmbuffer) &
+                      VISIBILITYMAP_ALL_FROZEN) != 0;
+#endif
+
     /*
      * We must hold share lock on the buffer content while examining tuple
      * visibility.  Afterwards, however, the tuples we have found to be
@@ -442,7 +530,8 @@ heapgetpage(HeapScanDesc scan, BlockNumber page)
      * tuple for visibility the hard way.
      */
 #ifdef __TBASE__
-    all_visible = !NeedMvcc() && PageIsAllVisible(dp) && !snapshot->takenDuringRecovery;
+    all_visible = !NeedMvcc() && PageIsAllVisible(dp) &&
+        (!snapshot->takenDuringRecovery || all_frozen);
 #else
     all_visible = PageIsAllVisible(dp) && !snapshot->takenDuringRecovery;
 #endif
@@ -493,6 +582,172 @@ heapgetpage(HeapScanDesc scan, BlockNumber page)
     scan->rs_ntuples = ntup;
 }
 
+#ifdef _SHARDING_
+/*
+ * heap_scan_filters_shards - does the scan only see part of the shards
+ *
+ * Connections from applications honour shard visibility on datanodes; the
+ * shards they may not see are left out extent by extent.
+ */
+static bool
+heap_scan_filters_shards(HeapScanDesc scan)
+{
+    return IS_PGXC_DATANODE
+        && IsConnFromApp()
+        && g_ShardVisibleMode != SHARD_VISIBLE_MODE_ALL
+        && RelationHasExtent(scan->rs_rd)
+        && IsMVCCSnapshot(scan->rs_snapshot);
+}
+
+static bool
+heap_shard_is_skipped(Snapshot snapshot, ShardID sid)
+{
+    bool shard_is_visible = bms_is_member(sid/snapshot->groupsize,
+                                          SnapshotGetShardTable(snapshot));
+
+    return (!shard_is_visible && g_ShardVisibleMode == SHARD_VISIBLE_MODE_VISIBLE)
+        || (shard_is_visible && g_ShardVisibleMode == SHARD_VISIBLE_MODE_HIDDEN);
+}
+
+/*
+ * heap_extent_skip - step over the extent of *page if none of its tuples
+ * can be returned
+ *
+ * That is the case if its zone map shows no tuple in it can pass the scan's
+ * zone filter, or if the EMA says it belongs to a shard the scan must not
+ * see; either is decided without reading the extent's pages. When the scan
+ * enters an extent it will read, the rest of the extent is prefetched.
+ *
+ * Returns true after moving *page to the next block to look at and setting
+ * *finished, false if the block has to be read. Only forward scans over the
+ * whole relation skip; the others still check the shard page by page.
+ */
+static bool
+heap_extent_skip(HeapScanDesc scan, ScanDirection dir,
+                 BlockNumber *page, bool *finished)
+{
+    ExtentID    eid;
+    BlockNumber next;
+    bool        filter_shards;
+
+    if (ScanDirectionIsBackward(dir) ||
+        scan->rs_numblocks != InvalidBlockNumber)
+        return false;
+
+    filter_shards = heap_scan_filters_shards(scan);
+    if (scan->rs_zonefilter == NULL && !filter_shards)
+        return false;
+
+    eid = (ExtentID) (*page / PAGES_PER_EXTENTS);
+    if (eid != scan->rs_zone_eid)
+    {
+        ShardID        sid;
+
+        scan->rs_zone_eid = eid;
+        if (scan->rs_zonefilter != NULL &&
+            !ZoneMapExtentMayMatch(scan->rs_rd, eid, scan->rs_zonefilter))
+            scan->rs_zone_skip = true;
+        else if (filter_shards &&
+                 ema_get_extent_shard(scan->rs_rd, eid, &sid) &&
+                 heap_shard_is_skipped(scan->rs_snapshot, sid))
+            scan->rs_zone_skip = true;
+        else
+            scan->rs_zone_skip = false;
+
+#ifdef USE_PREFETCH
+        if (!scan->rs_zone_skip && scan->rs_parallel == NULL &&
+            target_prefetch_pages > 0)
+        {
+            BlockNumber blk;
+            BlockNumber end = Min((eid + 1) * PAGES_PER_EXTENTS,
+                                  scan->rs_nblocks);
+
+            for (blk = *page + 1; blk < end; blk++)
+                PrefetchBuffer(scan->rs_rd, MAIN_FORKNUM, blk);
+        }
+#endif
+    }
+    if (!scan->rs_zone_skip)
+        return false;
+
+    if (scan->rs_parallel != NULL)
+    {
+        /* give back the rest of the extent we are on, if handed out whole */
+        scan->rs_extent_next = scan->rs_extent_end;
+        *page = heap_parallelscan_nextpage(scan);
+        *finished = (*page == InvalidBlockNumber);
+        return true;
+    }
+
+    next = (eid + 1) * PAGES_PER_EXTENTS;
+    if (*page < scan->rs_startblock && next > scan->rs_startblock)
+    {
+        /* wrapped around to the extent a synchronized scan started in */
+        *finished = true;
+    }
+    else
+    {
+        if (next >= scan->rs_nblocks)
+            next = 0;
+        *finished = (next == scan->rs_startblock);
+    }
+    *page = next;
+
+    if (scan->rs_syncscan)
+        ss_report_location(scan->rs_rd, next);
+
+    return true;
+}
+
+/*
+ * heap_snapshot_filters_shards - may the snapshot hide tuples of relation
+ * for belonging to shards it must not see?
+ *
+ * Mirrors the shard check of the HeapTupleSatisfies routines, for callers
+ * like index-only scans which decide visibility without the tuple.
+ */
+bool
+heap_snapshot_filters_shards(Relation relation, Snapshot snapshot)
+{
+    return IS_PGXC_DATANODE
+        && RelationIsSharded(relation)
+        && IsMVCCSnapshot(snapshot)
+        && SnapshotGetShardTable(snapshot) != NULL
+        && (!IsConnFromApp() || g_ShardVisibleMode != SHARD_VISIBLE_MODE_ALL);
+}
+
+/*
+ * heap_extent_shard_hidden - does the snapshot hide all tuples of an extent?
+ *
+ * An extent only ever holds tuples of one shard, and it is not handed to
+ * another shard before all of them are gone, so the shard recorded in the
+ * EMA decides for every tuple in it.  *known is set false if the EMA can't
+ * tell, in which case the tuples have to be checked one by one.  Only for
+ * relations with extents, and when heap_snapshot_filters_shards() is true.
+ */
+bool
+heap_extent_shard_hidden(Relation relation, Snapshot snapshot, ExtentID eid,
+                         bool *known)
+{
+    ShardID        sid;
+    bool        shard_is_visible;
+
+    Assert(RelationHasExtent(relation));
+
+    *known = ema_get_extent_shard(relation, eid, &sid) && ShardIDIsValid(sid);
+    if (!*known)
+        return false;
+
+    if (IsConnFromApp())
+        return heap_shard_is_skipped(snapshot, sid);
+
+    /* other nodes and internal connections only see the visible shards */
+    shard_is_visible = bms_is_member(sid/snapshot->groupsize,
+                                     SnapshotGetShardTable(snapshot));
+    return !shard_is_visible;
+}
+#endif
+
 /* ----------------
  *        heapgettup - fetch next heap tuple
  *
@@ -787,6 +1042,11 @@ get_next_page:
             return;
         }
 
+#ifdef _SHARDING_
+        if (heap_extent_skip(scan, dir, &page, &finished))
+            goto get_next_page;
+#endif
+
         heapgetpage(scan, page);
 
         LockBuffer(scan->rs_cbuf, BUFFER_LOCK_SHARE);
@@ -800,22 +1060,10 @@ get_next_page:
             {
                 to_skip = true;
             }
-            else if(IS_PGXC_DATANODE
-                && IsConnFromApp()
-                && g_ShardVisibleMode != SHARD_VISIBLE_MODE_ALL
-                && RelationHasExtent(scan->rs_rd)
-                && IsMVCCSnapshot(scan->rs_snapshot))
+            else if(heap_scan_filters_shards(scan) &&
+                    heap_shard_is_skipped(scan->rs_snapshot, PageGetShardId(dp)))
             {
-                Snapshot snapshot = scan->rs_snapshot;
-                ShardID pg_sid = PageGetShardId(dp);
-                bool shard_is_visible = bms_is_member(pg_sid/snapshot->groupsize,
-                                                SnapshotGetShardTable(snapshot));
-
-                if((!shard_is_visible && g_ShardVisibleMode == SHARD_VISIBLE_MODE_VISIBLE)
-                    || (shard_is_visible && g_ShardVisibleMode == SHARD_VISIBLE_MODE_HIDDEN))
-                {
-                    to_skip = true;
-                }
+                to_skip = true;
             }
 
             if(to_skip)
@@ -1155,6 +1403,11 @@ get_next_page:
             return;
         }
 
+#ifdef _SHARDING_
+        if (heap_extent_skip(scan, dir, &page, &finished))
+            goto get_next_page;
+#endif
+
         heapgetpage(scan, page);
 
         dp = BufferGetPage(scan->rs_cbuf);
@@ -1166,22 +1419,10 @@ get_next_page:
             {
                 to_skip = true;
             }
-            else if(IS_PGXC_DATANODE
-                && IsConnFromApp()
-                && g_ShardVisibleMode != SHARD_VISIBLE_MODE_ALL
-                && RelationHasExtent(scan->rs_rd)
-                && IsMVCCSnapshot(scan->rs_snapshot))
+            else if(heap_scan_filters_shards(scan) &&
+                    heap_shard_is_skipped(scan->rs_snapshot, PageGetShardId(dp)))
             {
-                Snapshot snapshot = scan->rs_snapshot;
-                ShardID pg_sid = PageGetShardId(dp);
-                bool shard_is_visible = bms_is_member(pg_sid/snapshot->groupsize,
-                                                SnapshotGetShardTable(snapshot));
-
-                if((!shard_is_visible && g_ShardVisibleMode == SHARD_VISIBLE_MODE_VISIBLE)
-                    || (shard_is_visible && g_ShardVisibleMode == SHARD_VISIBLE_MODE_HIDDEN))
-                {
-                    to_skip = true;
-                }
+                to_skip = true;
             }
 
             if(to_skip)
@@ -1667,6 +1908,9 @@ heap_beginscan_internal(Relation relation, Snapshot snapshot,
     scan->rs_allow_sync = allow_sync;
     scan->rs_temp_snap = temp_snap;
     scan->rs_parallel = parallel_scan;
+#ifdef _SHARDING_
+    scan->rs_zonefilter = NULL;
+#endif
 
     /*
      * we can use page-at-a-time mode if it's an MVCC-safe snapshot
@@ -1735,6 +1979,10 @@ heap_rescan(HeapScanDesc scan,
      */
     if (BufferIsValid(scan->rs_cbuf))
         ReleaseBuffer(scan->rs_cbuf);
+#ifdef __TBASE__
+    if (BufferIsValid(scan->rs_vmbuffer))
+        ReleaseBuffer(scan->rs_vmbuffer);
+#endif
 
     /*
      * reinitialize scan descriptor
@@ -1845,6 +2093,10 @@ heap_endscan(HeapScanDesc scan)
      */
     if (BufferIsValid(scan->rs_cbuf))
         ReleaseBuffer(scan->rs_cbuf);
+#ifdef __TBASE__
+    if (BufferIsValid(scan->rs_vmbuffer))
+        ReleaseBuffer(scan->rs_vmbuffer);
+#endif
 
     /*
      * decrement relation reference count and free scan descriptor storage
@@ -1898,9 +2150,53 @@ heap_parallelscan_initialize(ParallelHeapScanDesc target, Relation relation,
     SpinLockInit(&target->phs_mutex);
     target->phs_startblock = InvalidBlockNumber;
 	pg_atomic_write_u64(&target->phs_nallocated, 0);
+#ifdef _SHARDING_
+    target->phs_extentscan = false;
+    target->phs_nextents = 0;
+    target->phs_extents_off = 0;
+#endif
     SerializeSnapshot(snapshot, target->phs_snapshot_data);
 }
 
+#ifdef _SHARDING_
+/* ----------------
+ *        heap_parallelscan_estimate_extents - estimate storage for
+ *        ParallelHeapScanDesc which hands out the given number of extents
+ * ----------------
+ */
+Size
+heap_parallelscan_estimate_extents(Snapshot snapshot, int nextents)
+{
+    return add_size(MAXALIGN(heap_parallelscan_estimate(snapshot)),
+                    mul_size(nextents, sizeof(ExtentID)));
+}
+
+/* ----------------
+ *        heap_parallelscan_initialize_extents - initialize ParallelHeapScanDesc
+ *        to scan only the given extents
+ *
+ *        Workers get whole extents rather than blocks, so a scan restricted
+ *        to a few shards reads only the extents of those shards.  Must allow
+ *        as many bytes as returned by heap_parallelscan_estimate_extents.
+ * ----------------
+ */
+void
+heap_parallelscan_initialize_extents(ParallelHeapScanDesc target,
+                                     Relation relation, Snapshot snapshot,
+                                     ExtentID *extents, int nextents)
+{
+    heap_parallelscan_initialize(target, relation, snapshot);
+
+    /* extents are not in block order, syncscan makes no sense */
+    target->phs_syncscan = false;
+    target->phs_extentscan = true;
+    target->phs_nextents = nextents;
+    target->phs_extents_off = MAXALIGN(heap_parallelscan_estimate(snapshot));
+    memcpy((char *) target + target->phs_extents_off, extents,
+           nextents * sizeof(ExtentID));
+}
+#endif
+
 /* ----------------
  *		heap_parallelscan_reinitialize - reset a parallel scan
  *
@@ -1933,6 +2229,56 @@ heap_beginscan_parallel(Relation relation, ParallelHeapScanDesc parallel_scan)
                                    true, true, true, false, false, true);
 }
 
+#ifdef _SHARDING_
+/* ----------------
+ *        heap_setscanextent - restart a scan on the blocks of one extent
+ *
+ *        For scans reading a list of extents, such as the ones of a few
+ *        shards.  Returns false, leaving the scan empty, if the extent lies
+ *        past the end of the relation.
+ * ----------------
+ */
+bool
+heap_setscanextent(HeapScanDesc scan, ExtentID eid)
+{
+    BlockNumber start = eid * PAGES_PER_EXTENTS;
+
+    /* the scan is restarted for every extent, keep syncscan out of it */
+    scan->rs_allow_sync = false;
+    heap_rescan(scan, NULL);
+
+    if (start >= scan->rs_nblocks)
+    {
+        heap_setscanlimits(scan, 0, 0);
+        return false;
+    }
+
+    /* the scan must end with the relation, it would wrap around otherwise */
+    heap_setscanlimits(scan, start,
+                       Min(PAGES_PER_EXTENTS, scan->rs_nblocks - start));
+    return true;
+}
+
+/* ----------------
+ *        heap_setzonefilter - let a scan skip extents by their zone maps
+ *
+ *        The filter must stay valid until the scan ends.  Only MVCC scans
+ *        may skip: a summary covers every tuple an MVCC snapshot can see,
+ *        but not necessarily those of a still running inserter.
+ * ----------------
+ */
+void
+heap_setzonefilter(HeapScanDesc scan, struct ExtentZoneFilter *filter)
+{
+    if (!RelationHasExtent(scan->rs_rd) || !IsMVCCSnapshot(scan->rs_snapshot))
+        return;
+
+    scan->rs_zonefilter = filter;
+    scan->rs_zone_eid = InvalidExtentID;
+    scan->rs_zone_skip = false;
+}
+#endif
+
 /* ----------------
  *		heap_parallelscan_startblock_init - find and set the scan's startblock
  *
@@ -1999,6 +2345,36 @@ heap_parallelscan_nextpage(HeapScanDesc scan)
 	Assert(scan->rs_parallel);
 	parallel_scan = scan->rs_parallel;
 
+#ifdef _SHARDING_
+	if (parallel_scan->phs_extentscan)
+	{
+		ExtentID   *extents = (ExtentID *)
+			((char *) parallel_scan + parallel_scan->phs_extents_off);
+
+		for (;;)
+		{
+			/* continue with the extent at hand */
+			if (scan->rs_extent_next < scan->rs_extent_end)
+			{
+				page = scan->rs_extent_next++;
+				if (page < scan->rs_nblocks)
+					return page;
+
+				/* rest of the extent is past the end of the scan */
+				scan->rs_extent_next = scan->rs_extent_end;
+				continue;
+			}
+
+			nallocated = pg_atomic_fetch_add_u64(&parallel_scan->phs_nallocated, 1);
+			if (nallocated >= parallel_scan->phs_nextents)
+				return InvalidBlockNumber;
+
+			scan->rs_extent_next = extents[nallocated] * PAGES_PER_EXTENTS;
+			scan->rs_extent_end = scan->rs_extent_next + PAGES_PER_EXTENTS;
+		}
+	}
+#endif
+
 	/*
 	 * phs_nallocated tracks how many pages have been allocated to workers
 	 * already.  When phs_nallocated >= rs_nblocks, all blocks have been
@@ -3025,6 +3401,68 @@ heap_prepare_insert(Relation relation, HeapTuple tup, TransactionId xid,
  * Note: this leaks memory into the current memory context. You can create a
  * temporary context before calling this, if that's a problem.
  */
+#ifdef _SHARDING_
+typedef struct ShardSortTuple
+{
+    ShardID     sid;
+    int         idx;            /* position in the caller's array */
+    HeapTuple   tuple;
+} ShardSortTuple;
+
+static int
+shard_sort_tuple_cmp(const void *a, const void *b)
+{
+    const ShardSortTuple *ta = (const ShardSortTuple *) a;
+    const ShardSortTuple *tb = (const ShardSortTuple *) b;
+
+    if (ta->sid != tb->sid)
+        return (ta->sid < tb->sid) ? -1 : 1;
+    return (ta->idx < tb->idx) ? -1 : (ta->idx > tb->idx);
+}
+
+/*
+ * Tuples of different shards never share a page, so a batch coming in mixed
+ * shard order would take one page, and one WAL record, per tuple. Return the
+ * tuples grouped by shard, keeping the order within a shard. The caller's
+ * array is left alone; the returned one points to the same tuples, so their
+ * t_self is still set for the caller.
+ */
+static HeapTuple *
+heap_multi_insert_group_shards(HeapTuple *tuples, int ntuples)
+{
+    ShardSortTuple *sorted;
+    HeapTuple  *result;
+    int         i;
+
+    for (i = 1; i < ntuples; i++)
+    {
+        if (HeapTupleGetShardId(tuples[i]) < HeapTupleGetShardId(tuples[i - 1]))
+            break;
+    }
+
+    /* already grouped */
+    if (i >= ntuples)
+        return tuples;
+
+    sorted = (ShardSortTuple *) palloc(ntuples * sizeof(ShardSortTuple));
+    for (i = 0; i < ntuples; i++)
+    {
+        sorted[i].sid = HeapTupleGetShardId(tuples[i]);
+        sorted[i].idx = i;
+        sorted[i].tuple = tuples[i];
+    }
+
+    qsort(sorted, ntuples, sizeof(ShardSortTuple), shard_sort_tuple_cmp);
+
+    result = (HeapTuple *) palloc(ntuples * sizeof(HeapTuple));
+    for (i = 0; i < ntuples; i++)
+        result[i] = sorted[i].tuple;
+
+    pfree(sorted);
+    return result;
+}
+#endif
+
 void
 heap_multi_insert(Relation relation, HeapTuple *tuples, int ntuples,
                   CommandId cid, int options, BulkInsertState bistate)
@@ -3039,6 +3477,10 @@ heap_multi_insert(Relation relation, HeapTuple *tuples, int ntuples,
     Size        saveFreeSpace;
 #ifdef _SHARDING_
     ShardID        tuple_sid = InvalidShardID;
+#endif
+#ifdef __TBASE__
+    bool        lock_checked = false;
+    ShardID        checked_sid = InvalidShardID;
 #endif
     bool        need_tuple_data = RelationIsLogicallyLogged(relation);
     bool        need_cids = RelationIsAccessibleInLogicalDecoding(relation);
@@ -3051,6 +3493,11 @@ heap_multi_insert(Relation relation, HeapTuple *tuples, int ntuples,
     saveFreeSpace = RelationGetTargetPageFreeSpace(relation,
                                                    HEAP_DEFAULT_FILLFACTOR);
 
+#ifdef _SHARDING_
+    if (RelationHasExtent(relation) && ntuples > 1)
+        tuples = heap_multi_insert_group_shards(tuples, ntuples);
+#endif
+
     /* Toast and set header data in all the tuples */
     heaptuples = palloc(ntuples * sizeof(HeapTuple));
     for (i = 0; i < ntuples; i++)
@@ -3125,7 +3572,13 @@ heap_multi_insert(Relation relation, HeapTuple *tuples, int ntuples,
 #endif
 
 #ifdef __TBASE__
-        LightLockCheck(CMD_INSERT, RelationGetRelid(relation), tuple_sid);
+        /* tuples come grouped by shard, check once per shard */
+        if (!lock_checked || tuple_sid != checked_sid)
+        {
+            LightLockCheck(CMD_INSERT, RelationGetRelid(relation), tuple_sid);
+            lock_checked = true;
+            checked_sid = tuple_sid;
+        }
 #endif
 
         /*
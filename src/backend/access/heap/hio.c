@@ -22,11 +22,14 @@
 #include "access/xlogutils.h"
 #include "storage/bufmgr.h"
 #include "storage/extentmapping.h"
+#include "storage/extent_zonemap.h"
 #include "storage/freespace.h"
 #include "storage/lmgr.h"
 #include "storage/smgr.h"
 
 static void RelationAddExtraBlocks_repair(Relation relation, ShardID *shardid);
+static Buffer RelationAddExtent(Relation relation, BulkInsertState bistate,
+                  ShardID sid, ExtentID eid);
 
 /*
  * RelationPutHeapTuple - place tuple at specified page
@@ -62,6 +65,12 @@ RelationPutHeapTuple(Relation relation,
     /* Update tuple->t_self to the actual position where it was stored */
     ItemPointerSet(&(tuple->t_self), BufferGetBlockNumber(buffer), offnum);
 
+#ifdef _SHARDING_
+    /* every tuple put on a page of a shard table passes here */
+    if (extent_zonemap_entries > 0 && RelationHasExtent(relation))
+        ZoneMapAddTuple(relation, BufferGetBlockNumber(buffer), tuple);
+#endif
+
     /*
      * Insert the correct position into CTID of the stored tuple, too (unless
      * this is a speculative insertion, in which case the token is held in
@@ -253,7 +262,7 @@ RelationAddExtraBlocks(Relation relation, BulkInsertState bistate, ShardID sid)
         /* init extent info */
         ExtendExtentForShard(relation, sid, next_extent, MAX_FREESPACE, false);
         
-        extraBlocks = PAGES_PER_EXTENTS;
+        return RelationAddExtent(relation, bistate, sid, next_extent);
     }
     if(extraBlocks <= 0)
         elog(PANIC, "extraBlocks cannot be zero");
@@ -312,6 +321,51 @@ RelationAddExtraBlocks(Relation relation, BulkInsertState bistate, ShardID sid)
 }
 
 #ifdef _SHARDING_
+/*
+ * Add the storage of a whole extent to a shard table in one step.
+ *
+ * Only the first page of the extent is initialized here and returned pinned
+ * and exclusive-locked.  The rest stay all-zero on disk and are initialized
+ * with the shard id by RelationGetBufferForTuple when first used, so the
+ * relation extension lock is held for one fallocate() instead of a write
+ * per page.  The extent itself has been logged by ExtendExtentForShard, and
+ * heap pages are logged by their first insert as usual.
+ */
+static Buffer
+RelationAddExtent(Relation relation, BulkInsertState bistate,
+                  ShardID sid, ExtentID eid)
+{
+    BlockNumber firstBlock = eid * PAGES_PER_EXTENTS;
+    BlockNumber lastBlock = firstBlock + PAGES_PER_EXTENTS - 1;
+    BlockNumber blockNum;
+    Buffer        buffer;
+    Page        page;
+    Size        freespace;
+
+    RelationOpenSmgr(relation);
+    smgrrealloc(relation->rd_smgr, MAIN_FORKNUM, firstBlock);
+
+    buffer = ReadBufferBI(relation, firstBlock, bistate);
+    LockBuffer(buffer, BUFFER_LOCK_EXCLUSIVE);
+    page = BufferGetPage(buffer);
+    if (!PageIsNew(page))
+        elog(ERROR, "page %u of relation \"%s\" should be empty but is not",
+             firstBlock, RelationGetRelationName(relation));
+    PageInit_shard(page, BufferGetPageSize(buffer), 0, sid, false);
+    MarkBufferDirty(buffer);
+    freespace = PageGetHeapFreeSpace(page);
+
+    if(bistate)
+        bistate->sid = sid;
+
+    /* all pages of the extent are equally empty, see RelationAddExtraBlocks */
+    for (blockNum = firstBlock; blockNum <= lastBlock; blockNum++)
+        RecordPageWithFreeSpace(relation, blockNum, freespace);
+    UpdateFreeSpaceMap(relation, firstBlock, lastBlock, freespace);
+
+    return buffer;
+}
+
 static void
 RelationAddExtraBlocks_repair(Relation relation, ShardID *shardid)
 {
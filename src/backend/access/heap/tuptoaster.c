@@ -29,6 +29,12 @@
 
 #include <unistd.h>
 #include <fcntl.h>
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
 
 #include "access/genam.h"
 #include "access/heapam.h"
@@ -37,8 +43,10 @@
 #include "catalog/catalog.h"
 #include "common/pg_lzcompress.h"
 #include "miscadmin.h"
+#include "utils/attoptcache.h"
 #include "utils/expandeddatum.h"
 #include "utils/fmgroids.h"
+#include "utils/guc.h"
 #include "utils/rel.h"
 #include "utils/snapmgr.h"
 #include "utils/typcache.h"
@@ -53,7 +61,7 @@
 typedef struct toast_compress_header
 {
     int32        vl_len_;        /* varlena header (do not touch directly!) */
-    int32        rawsize;
+    uint32        rawsize;        /* raw size and compression method */
 } toast_compress_header;
 
 /*
@@ -61,11 +69,29 @@ typedef struct toast_compress_header
  * toast entries.
  */
 #define TOAST_COMPRESS_HDRSZ        ((int32) sizeof(toast_compress_header))
-#define TOAST_COMPRESS_RAWSIZE(ptr) (((toast_compress_header *) (ptr))->rawsize)
+#define TOAST_COMPRESS_RAWSIZE(ptr) \
+    ((int32) (((toast_compress_header *) (ptr))->rawsize & VARLENA_RAWSIZE_MASK))
+#define TOAST_COMPRESS_METHOD(ptr) \
+    ((int) (((toast_compress_header *) (ptr))->rawsize >> VARLENA_RAWSIZE_BITS))
 #define TOAST_COMPRESS_RAWDATA(ptr) \
     (((char *) (ptr)) + TOAST_COMPRESS_HDRSZ)
-#define TOAST_COMPRESS_SET_RAWSIZE(ptr, len) \
-    (((toast_compress_header *) (ptr))->rawsize = (len))
+#define TOAST_COMPRESS_SET_RAWSIZE(ptr, len, cmethod) \
+    (((toast_compress_header *) (ptr))->rawsize = \
+     ((uint32) (len) | ((uint32) (cmethod) << VARLENA_RAWSIZE_BITS)))
+
+/* GUC variable */
+int            default_toast_compression = TOAST_PGLZ_COMPRESSION_ID;
+
+const struct config_enum_entry default_toast_compression_options[] = {
+    {"pglz", TOAST_PGLZ_COMPRESSION_ID, false},
+#ifdef USE_LZ4
+    {"lz4", TOAST_LZ4_COMPRESSION_ID, false},
+#endif
+#ifdef USE_ZSTD
+    {"zstd", TOAST_ZSTD_COMPRESSION_ID, false},
+#endif
+    {NULL, 0, false}
+};
 
 static void toast_delete_datum(Relation rel, Datum value, bool is_speculative);
 static Datum toast_save_datum(Relation rel, Datum value,
@@ -80,6 +106,7 @@ static struct varlena *toast_fetch_datum(struct varlena *attr);
 static struct varlena *toast_fetch_datum_slice(struct varlena *attr,
                         int32 sliceoffset, int32 length);
 static struct varlena *toast_decompress_datum(struct varlena *attr);
+static int    toast_attribute_compression(Relation rel, int attnum);
 static int toast_open_indexes(Relation toastrel,
                    LOCKMODE lock,
                    Relation **toastidxs,
@@ -778,7 +805,8 @@ toast_insert_or_update(Relation rel, HeapTuple newtup, HeapTuple oldtup,
         if (att[i]->attstorage == 'x')
         {
             old_value = toast_values[i];
-            new_value = toast_compress_datum(old_value);
+            new_value = toast_compress_datum_method(old_value,
+                                                    toast_attribute_compression(rel, i + 1));
 
             if (DatumGetPointer(new_value) != NULL)
             {
@@ -925,7 +953,8 @@ toast_insert_or_update(Relation rel, HeapTuple newtup, HeapTuple oldtup,
          */
         i = biggest_attno;
         old_value = toast_values[i];
-        new_value = toast_compress_datum(old_value);
+        new_value = toast_compress_datum_method(old_value,
+                                                toast_attribute_compression(rel, i + 1));
 
         if (DatumGetPointer(new_value) != NULL)
         {
@@ -1382,7 +1411,20 @@ toast_build_flattened_tuple(TupleDesc tupleDesc,
 /* ----------
  * toast_compress_datum -
  *
- *    Create a compressed version of a varlena datum
+ *    Create a compressed version of a varlena datum, with the default
+ *    compression method
+ * ----------
+ */
+Datum
+toast_compress_datum(Datum value)
+{
+    return toast_compress_datum_method(value, default_toast_compression);
+}
+
+/* ----------
+ * toast_compress_datum_method -
+ *
+ *    Create a compressed version of a varlena datum with the given method
  *
  *    If we fail (ie, compressed result is actually bigger than original)
  *    then return NULL.  We must not use compressed data if it'd expand
@@ -1393,28 +1435,75 @@ toast_build_flattened_tuple(TupleDesc tupleDesc,
  * ----------
  */
 Datum
-toast_compress_datum(Datum value)
+toast_compress_datum_method(Datum value, int cmethod)
 {
     struct varlena *tmp;
+    char       *src = VARDATA_ANY(DatumGetPointer(value));
     int32        valsize = VARSIZE_ANY_EXHDR(DatumGetPointer(value));
-    int32        len;
+    int32        maxlen;
+    int32        len = -1;
 
     Assert(!VARATT_IS_EXTERNAL(DatumGetPointer(value)));
     Assert(!VARATT_IS_COMPRESSED(DatumGetPointer(value)));
 
     /*
      * No point in wasting a palloc cycle if value size is out of the allowed
-     * range for compression
+     * range for compression. The pglz limits apply to the other methods as
+     * well, tiny values do not compress with any of them.
      */
     if (valsize < PGLZ_strategy_default->min_input_size ||
         valsize > PGLZ_strategy_default->max_input_size)
         return PointerGetDatum(NULL);
 
-    tmp = (struct varlena *) palloc(PGLZ_MAX_OUTPUT(valsize) +
-                                    TOAST_COMPRESS_HDRSZ);
+    switch (cmethod)
+    {
+#ifdef USE_LZ4
+        case TOAST_LZ4_COMPRESSION_ID:
+            maxlen = LZ4_compressBound(valsize);
+            break;
+#endif
+#ifdef USE_ZSTD
+        case TOAST_ZSTD_COMPRESSION_ID:
+            maxlen = ZSTD_compressBound(valsize);
+            break;
+#endif
+        default:
+            cmethod = TOAST_PGLZ_COMPRESSION_ID;
+            maxlen = PGLZ_MAX_OUTPUT(valsize);
+            break;
+    }
+
+    tmp = (struct varlena *) palloc(maxlen + TOAST_COMPRESS_HDRSZ);
+
+    switch (cmethod)
+    {
+#ifdef USE_LZ4
+        case TOAST_LZ4_COMPRESSION_ID:
+            len = LZ4_compress_default(src, TOAST_COMPRESS_RAWDATA(tmp),
+                                       valsize, maxlen);
+            if (len <= 0)
+                len = -1;
+            break;
+#endif
+#ifdef USE_ZSTD
+        case TOAST_ZSTD_COMPRESSION_ID:
+            {
+                size_t        zlen;
+
+                zlen = ZSTD_compress(TOAST_COMPRESS_RAWDATA(tmp), maxlen,
+                                     src, valsize, ZSTD_CLEVEL_DEFAULT);
+                len = ZSTD_isError(zlen) ? -1 : (int32) zlen;
+            }
+            break;
+#endif
+        default:
+            len = pglz_compress(src, valsize, TOAST_COMPRESS_RAWDATA(tmp),
+                                PGLZ_strategy_default);
+            break;
+    }
 
     /*
-     * We recheck the actual size even if pglz_compress() reports success,
+     * We recheck the actual size even if the compressor reports success,
      * because it might be satisfied with having saved as little as one byte
      * in the compressed data --- which could turn into a net loss once you
      * consider header and alignment padding.  Worst case, the compressed
@@ -1423,14 +1512,10 @@ toast_compress_datum(Datum value)
      * only one header byte and no padding if the value is short enough.  So
      * we insist on a savings of more than 2 bytes to ensure we have a gain.
      */
-    len = pglz_compress(VARDATA_ANY(DatumGetPointer(value)),
-                        valsize,
-                        TOAST_COMPRESS_RAWDATA(tmp),
-                        PGLZ_strategy_default);
     if (len >= 0 &&
         len + TOAST_COMPRESS_HDRSZ < valsize - 2)
     {
-        TOAST_COMPRESS_SET_RAWSIZE(tmp, valsize);
+        TOAST_COMPRESS_SET_RAWSIZE(tmp, valsize, cmethod);
         SET_VARSIZE_COMPRESSED(tmp, len + TOAST_COMPRESS_HDRSZ);
         /* successful compression */
         return PointerGetDatum(tmp);
@@ -1443,6 +1528,92 @@ toast_compress_datum(Datum value)
     }
 }
 
+/* ----------
+ * toast_compression_method -
+ *
+ *    Look up a compression method by name, -1 if this build lacks it
+ * ----------
+ */
+int
+toast_compression_method(const char *name)
+{
+    int            i;
+
+    for (i = 0; default_toast_compression_options[i].name != NULL; i++)
+    {
+        if (pg_strcasecmp(name, default_toast_compression_options[i].name) == 0)
+            return default_toast_compression_options[i].val;
+    }
+
+    return -1;
+}
+
+/*
+ * Validator of the "compression" attribute option
+ */
+void
+validate_toast_compression(char *value)
+{
+    if (value != NULL && toast_compression_method(value) < 0)
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("compression method \"%s\" is not supported", value),
+                 errhint("Valid methods are pglz and, if enabled at build time, lz4 and zstd.")));
+}
+
+/* ----------
+ * toast_get_compression_method -
+ *
+ *    Method a datum is compressed with, -1 if it is not compressed
+ * ----------
+ */
+int
+toast_get_compression_method(struct varlena *attr)
+{
+    if (VARATT_IS_EXTERNAL_ONDISK(attr))
+    {
+        struct varatt_external toast_pointer;
+        struct varlena *tmp;
+        int            cmethod;
+
+        VARATT_EXTERNAL_GET_POINTER(toast_pointer, attr);
+        if (!VARATT_EXTERNAL_IS_COMPRESSED(toast_pointer))
+            return -1;
+
+        /* the method is in the header of the compressed data */
+        tmp = toast_fetch_datum(attr);
+        cmethod = TOAST_COMPRESS_METHOD(tmp);
+        pfree(tmp);
+
+        return cmethod;
+    }
+
+    if (VARATT_IS_COMPRESSED(attr))
+        return TOAST_COMPRESS_METHOD(attr);
+
+    return -1;
+}
+
+/*
+ * The compression method to use for an attribute of rel
+ */
+static int
+toast_attribute_compression(Relation rel, int attnum)
+{
+    AttributeOpts *aopts;
+    int            cmethod = -1;
+
+    aopts = get_attribute_options(RelationGetRelid(rel), attnum);
+    if (aopts != NULL)
+    {
+        if (aopts->compression > 0)
+            cmethod = toast_compression_method((char *) aopts + aopts->compression);
+        pfree(aopts);
+    }
+
+    return cmethod >= 0 ? cmethod : default_toast_compression;
+}
+
 
 /* ----------
  * toast_get_valid_index
@@ -2306,18 +2477,46 @@ static struct varlena *
 toast_decompress_datum(struct varlena *attr)
 {
     struct varlena *result;
+    int32        rawsize = TOAST_COMPRESS_RAWSIZE(attr);
+    int32        complen = VARSIZE(attr) - TOAST_COMPRESS_HDRSZ;
 
     Assert(VARATT_IS_COMPRESSED(attr));
 
-    result = (struct varlena *)
-        palloc(TOAST_COMPRESS_RAWSIZE(attr) + VARHDRSZ);
-    SET_VARSIZE(result, TOAST_COMPRESS_RAWSIZE(attr) + VARHDRSZ);
+    result = (struct varlena *) palloc(rawsize + VARHDRSZ);
+    SET_VARSIZE(result, rawsize + VARHDRSZ);
 
-    if (pglz_decompress(TOAST_COMPRESS_RAWDATA(attr),
-                        VARSIZE(attr) - TOAST_COMPRESS_HDRSZ,
-                        VARDATA(result),
-                        TOAST_COMPRESS_RAWSIZE(attr)) < 0)
-        elog(ERROR, "compressed data is corrupted");
+    switch (TOAST_COMPRESS_METHOD(attr))
+    {
+        case TOAST_PGLZ_COMPRESSION_ID:
+            if (pglz_decompress(TOAST_COMPRESS_RAWDATA(attr), complen,
+                                VARDATA(result), rawsize) < 0)
+                elog(ERROR, "compressed data is corrupted");
+            break;
+        case TOAST_LZ4_COMPRESSION_ID:
+#ifdef USE_LZ4
+            if (LZ4_decompress_safe(TOAST_COMPRESS_RAWDATA(attr), VARDATA(result),
+                                    complen, rawsize) != rawsize)
+                elog(ERROR, "compressed lz4 data is corrupted");
+#else
+            ereport(ERROR,
+                    (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                     errmsg("value is compressed with lz4, which is not supported by this build")));
+#endif
+            break;
+        case TOAST_ZSTD_COMPRESSION_ID:
+#ifdef USE_ZSTD
+            if (ZSTD_decompress(VARDATA(result), rawsize,
+                                TOAST_COMPRESS_RAWDATA(attr), complen) != (size_t) rawsize)
+                elog(ERROR, "compressed zstd data is corrupted");
+#else
+            ereport(ERROR,
+                    (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                     errmsg("value is compressed with zstd, which is not supported by this build")));
+#endif
+            break;
+        default:
+            elog(ERROR, "invalid compression method %d", TOAST_COMPRESS_METHOD(attr));
+    }
 
     return result;
 }
@@ -102,26 +102,12 @@ btint4cmp(PG_FUNCTION_ARGS)
         PG_RETURN_INT32(-1);
 }
 
-static int
-btint4fastcmp(Datum x, Datum y, SortSupport ssup)
-{
-    int32        a = DatumGetInt32(x);
-    int32        b = DatumGetInt32(y);
-
-    if (a > b)
-        return 1;
-    else if (a == b)
-        return 0;
-    else
-        return -1;
-}
-
 Datum
 btint4sortsupport(PG_FUNCTION_ARGS)
 {
     SortSupport ssup = (SortSupport) PG_GETARG_POINTER(0);
 
-    ssup->comparator = btint4fastcmp;
+    ssup->comparator = ssup_datum_int32_cmp;
     PG_RETURN_VOID();
 }
 
@@ -139,6 +125,7 @@ btint8cmp(PG_FUNCTION_ARGS)
         PG_RETURN_INT32(-1);
 }
 
+#ifndef USE_FLOAT8_BYVAL
 static int
 btint8fastcmp(Datum x, Datum y, SortSupport ssup)
 {
@@ -152,13 +139,18 @@ btint8fastcmp(Datum x, Datum y, SortSupport ssup)
     else
         return -1;
 }
+#endif
 
 Datum
 btint8sortsupport(PG_FUNCTION_ARGS)
 {
     SortSupport ssup = (SortSupport) PG_GETARG_POINTER(0);
 
+#ifdef USE_FLOAT8_BYVAL
+    ssup->comparator = ssup_datum_signed_cmp;
+#else
     ssup->comparator = btint8fastcmp;
+#endif
     PG_RETURN_VOID();
 }
 
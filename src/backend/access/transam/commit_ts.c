@@ -114,10 +114,34 @@ typedef struct CommitTimestampShared
 
 CommitTimestampShared *commitTsShared;
 
+#ifdef __TBASE__
+/*
+ * Backend-local cache of commit timestamps that were found, so that scans
+ * over tuples not yet stamped with their commit timestamp do not take the
+ * partition lock again and again for the same few transactions.  A commit
+ * timestamp never changes once it is set; the cache is only dropped when
+ * oldestXid moves, as xids older than that may be handed out again.
+ */
+#define COMMIT_TS_CACHE_SIZE    1024    /* keep this a power of 2 */
+
+typedef struct CommitTsCacheEntry
+{
+    TransactionId xid;
+    RepOriginId nodeid;
+    TimestampTz global_timestamp;
+} CommitTsCacheEntry;
+
+static CommitTsCacheEntry CommitTsCache[COMMIT_TS_CACHE_SIZE];
+static TransactionId CommitTsCacheOldestXid = InvalidTransactionId;
+
+#define CommitTsCacheSlot(xid) (&CommitTsCache[(xid) & (COMMIT_TS_CACHE_SIZE - 1)])
+#endif
+
 
 /* GUC variable */
 bool        track_commit_timestamp = true;
 bool        track_commit_timestamp_guc;
+int         commit_ts_buffers = 0;
 
 
 static void
@@ -296,18 +320,30 @@ SetXidCommitTsInPage(TransactionId xid, int nsubxids,
     int            i;
     int         partitionno;
     LWLock         *partitionlock;
+    LruShared    shared;
     
     partitionno = PagenoMappingPartitionno(CommitTsCtl, pageno);
     partitionlock = GetPartitionLock(CommitTsCtl, partitionno);
+    shared = CommitTsCtl->shared[partitionno];
     LWLockAcquire(partitionlock, LW_EXCLUSIVE);
 
     slotno = LruReadPage(CommitTsCtl, partitionno, pageno, XLogRecPtrIsInvalid(lsn), xid);
 
+    /*
+     * Write the whole group of entries in one go: the page is unprotected
+     * and its change counter bumped once per page rather than once per xid.
+     */
+    LruTlogDisableMemoryProtection(shared->page_buffer[slotno]);
+    LruBeginSlotChange(shared, slotno);
+
     TransactionIdSetCommitTs(xid, gts, ts, nodeid, partitionno, slotno, lsn);
     for (i = 0; i < nsubxids; i++)
         TransactionIdSetCommitTs(subxids[i], gts, ts, nodeid, partitionno, slotno, lsn);
 
-    CommitTsCtl->shared[partitionno]->page_dirty[slotno] = true;
+    LruEndSlotChange(shared, slotno);
+    LruTlogEnableMemoryProtection(shared->page_buffer[slotno]);
+
+    shared->page_dirty[slotno] = true;
 
     LWLockRelease(partitionlock);
 }
@@ -315,7 +351,8 @@ SetXidCommitTsInPage(TransactionId xid, int nsubxids,
 /*
  * Sets the commit timestamp of a single transaction.
  *
- * Must be called with CommitTsControlLock held
+ * Must be called with the partition lock held, the page unprotected and
+ * inside LruBeginSlotChange/LruEndSlotChange; see SetXidCommitTsInPage.
  */
 static void
 TransactionIdSetCommitTs(TransactionId xid, TimestampTz gts, TimestampTz ts,
@@ -333,11 +370,9 @@ TransactionIdSetCommitTs(TransactionId xid, TimestampTz gts, TimestampTz ts,
 	entry.time = ts;
 	entry.nodeid = nodeid;
 
-	LruTlogDisableMemoryProtection(CommitTsCtl->shared[partitionno]->page_buffer[slotno]);
 	memcpy(CommitTsCtl->shared[partitionno]->page_buffer[slotno] +
 		   SizeOfCommitTimestampEntry * entryno,
 		   &entry, SizeOfCommitTimestampEntry);
-	LruTlogEnableMemoryProtection(CommitTsCtl->shared[partitionno]->page_buffer[slotno]);
 
 #ifdef __TBASE__
     /*
@@ -395,19 +430,45 @@ TransactionIdGetCommitTsData(TransactionId xid, TimestampTz *gts,
         return true;
     }
 
+#ifdef __TBASE__
+    if (CommitTsCacheOldestXid != ShmemVariableCache->oldestXid)
+    {
+        MemSet(CommitTsCache, 0, sizeof(CommitTsCache));
+        CommitTsCacheOldestXid = ShmemVariableCache->oldestXid;
+    }
+    else
+    {
+        CommitTsCacheEntry *cached = CommitTsCacheSlot(xid);
+
+        if (cached->xid == xid)
+        {
+            *gts = cached->global_timestamp;
+            if (nodeid)
+                *nodeid = cached->nodeid;
+            return true;
+        }
+    }
+#endif
+
     //elog(DEBUG8, "Get committs xid %d.", xid);
     partitionno = PagenoMappingPartitionno(CommitTsCtl, pageno);
 
-    partitionLock = GetPartitionLock(CommitTsCtl, partitionno);
-    
-    /* lock is acquired by SimpleLruReadPage_ReadOnly */
-    slotno = LruReadPage_ReadOnly(CommitTsCtl, partitionno, pageno, xid);
-    memcpy(&entry,
-           CommitTsCtl->shared[partitionno]->page_buffer[slotno] +
-           SizeOfCommitTimestampEntry * entryno,
-           SizeOfCommitTimestampEntry);
+    /* resident pages can be read without the partition lock */
+    if (!LruReadPageOptimistic(CommitTsCtl, partitionno, pageno,
+                               SizeOfCommitTimestampEntry * entryno,
+                               SizeOfCommitTimestampEntry, (char *) &entry))
+    {
+        partitionLock = GetPartitionLock(CommitTsCtl, partitionno);
+
+        /* lock is acquired by SimpleLruReadPage_ReadOnly */
+        slotno = LruReadPage_ReadOnly(CommitTsCtl, partitionno, pageno, xid);
+        memcpy(&entry,
+               CommitTsCtl->shared[partitionno]->page_buffer[slotno] +
+               SizeOfCommitTimestampEntry * entryno,
+               SizeOfCommitTimestampEntry);
+        LWLockRelease(partitionLock);
+    }
 
-    
     *gts = entry.global_timestamp;
     
     if (nodeid)
@@ -416,7 +477,17 @@ TransactionIdGetCommitTsData(TransactionId xid, TimestampTz *gts,
     }
     
     //elog(DEBUG8, "Get committs xid %d time " INT64_FORMAT, xid, *ts);
-    LWLockRelease(partitionLock);
+
+#ifdef __TBASE__
+    if (*gts != 0)
+    {
+        CommitTsCacheEntry *cached = CommitTsCacheSlot(xid);
+
+        cached->xid = xid;
+        cached->nodeid = entry.nodeid;
+        cached->global_timestamp = entry.global_timestamp;
+    }
+#endif
     return *gts != 0;
 }
 
@@ -450,16 +521,22 @@ TransactionIdGetLocalCommitTsData(TransactionId xid, TimestampTz *ts,
     //elog(DEBUG8, "Get committs xid %d.", xid);
     partitionno = PagenoMappingPartitionno(CommitTsCtl, pageno);
 
-    partitionLock = GetPartitionLock(CommitTsCtl, partitionno);
-    
-    /* lock is acquired by SimpleLruReadPage_ReadOnly */
-    slotno = LruReadPage_ReadOnly(CommitTsCtl, partitionno, pageno, xid);
-    memcpy(&entry,
-           CommitTsCtl->shared[partitionno]->page_buffer[slotno] +
-           SizeOfCommitTimestampEntry * entryno,
-           SizeOfCommitTimestampEntry);
+    /* resident pages can be read without the partition lock */
+    if (!LruReadPageOptimistic(CommitTsCtl, partitionno, pageno,
+                               SizeOfCommitTimestampEntry * entryno,
+                               SizeOfCommitTimestampEntry, (char *) &entry))
+    {
+        partitionLock = GetPartitionLock(CommitTsCtl, partitionno);
+
+        /* lock is acquired by SimpleLruReadPage_ReadOnly */
+        slotno = LruReadPage_ReadOnly(CommitTsCtl, partitionno, pageno, xid);
+        memcpy(&entry,
+               CommitTsCtl->shared[partitionno]->page_buffer[slotno] +
+               SizeOfCommitTimestampEntry * entryno,
+               SizeOfCommitTimestampEntry);
+        LWLockRelease(partitionLock);
+    }
 
-    
     *ts = entry.time;
     
     if (nodeid)
@@ -468,7 +545,6 @@ TransactionIdGetLocalCommitTsData(TransactionId xid, TimestampTz *ts,
     }
     
     //elog(DEBUG8, "Get committs xid %d time " INT64_FORMAT, xid, *ts);
-    LWLockRelease(partitionLock);
     return *ts != 0;
 }
 
@@ -597,11 +673,17 @@ pg_last_committed_xact(PG_FUNCTION_ARGS)
  * Number of shared CommitTS buffers.
  *
  * We use a very similar logic as for the number of CLOG buffers; see comments
- * in CLOGShmemBuffers.
+ * in CLOGShmemBuffers.  This is the number of slots of each of the
+ * NUM_PARTITIONS partitions; commit_ts_buffers overrides it for workloads
+ * that keep many old pages busy in one partition, e.g. long running
+ * snapshots checking visibility of old transactions.
  */
 Size
 CommitTsShmemBuffers(void)
 {
+    if (commit_ts_buffers > 0)
+        return commit_ts_buffers;
+
     return Min(32, Max(4, NBuffers / 32));
 }
 
@@ -908,8 +990,10 @@ TrimCommitTs(void)
         byteptr = CommitTsCtl->shared[partitionno]->page_buffer[slotno] + byteno;
         
 		LruTlogDisableMemoryProtection(CommitTsCtl->shared[partitionno]->page_buffer[slotno]);
+        LruBeginSlotChange(CommitTsCtl->shared[partitionno], slotno);
         /* Zero the rest of the page */
         MemSet(byteptr, 0, BLCKSZ - byteno);
+        LruEndSlotChange(CommitTsCtl->shared[partitionno], slotno);
 		LruTlogEnableMemoryProtection(CommitTsCtl->shared[partitionno]->page_buffer[slotno]);
 
         elog(DEBUG10, "zero out the remaining page starting from byteno %d len BLCKSZ -byteno %d entryno %d sizeofentry %lu",
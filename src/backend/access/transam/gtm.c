@@ -41,6 +41,10 @@
 #include "pgxc/nodemgr.h"
 #include "access/xlog.h"
 #include "storage/lmgr.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "storage/spin.h"
+#include "storage/proc.h"
 #endif
 
 /* To access sequences */
@@ -54,6 +58,20 @@
 char *NewGtmHost = NULL;
 int      NewGtmPort = -1;
 bool  g_GTM_skip_catalog = false;
+bool  enable_gts_broker = false;
+bool  enable_gts_prefetch = false;
+
+/* Shared state of the GTS broker, see GetGlobalTimestampBrokered */
+typedef struct GTSBrokerData
+{
+    slock_t         mutex;          /* protects the fields below */
+    uint64          start_gen;      /* number of fetches started */
+    uint64          done_gen;       /* generation of the published gts */
+    GlobalTimestamp gts;            /* last timestamp fetched from GTM */
+    bool            gtm_readonly;   /* GTM read only flag of that fetch */
+} GTSBrokerData;
+
+static GTSBrokerData *GTSBroker = NULL;
 #endif
 char *GtmHost = NULL;
 int GtmPort = 0;
@@ -64,6 +82,16 @@ extern bool FirstSnapshotSet;
 bool GTMDebugPrint = false;
 static GTM_Conn *conn;
 
+#ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+/*
+ * A global timestamp request sent ahead by PrefetchGlobalTimestampGTM whose
+ * reply has not been read yet, and the local transaction it was sent in.
+ */
+static bool gts_prefetch_pending = false;
+static LocalTransactionId gts_prefetch_lxid = InvalidLocalTransactionId;
+static void DiscardPrefetchedGlobalTimestamp(void);
+#endif
+
 /* Used to check if needed to commit/abort at datanodes */
 GlobalTransactionId currentGxid = InvalidGlobalTransactionId;
 
@@ -443,6 +471,31 @@ int GetGTMStoreStatus(GTMStorageStatus *header)
 }
 
 
+static int GetGTMLatencyStatistics(bool clear, GTM_ThreadLatencyItem **threads)
+{
+    int ret = 0;
+
+    CheckConnection();
+    ret = -1;
+    if (conn)
+    {
+        ret = get_gtm_latency_statistics(conn, clear ? 1 : 0, 20, threads);
+    }
+
+    /* If something went wrong (timeout), try and reset GTM connection. */
+    if (ret < 0)
+    {
+        CloseGTM();
+        InitGTM();
+        if (conn)
+        {
+            ret = get_gtm_latency_statistics(conn, clear ? 1 : 0, 20, threads);
+        }
+    }
+
+    return ret;
+}
+
 int GetGTMStoreSequence(GTM_StoredSeqInfo **store_seq)
 {
     int ret = 0;
@@ -1073,6 +1126,106 @@ pg_check_storage_transaction(PG_FUNCTION_ARGS)
     SRF_RETURN_DONE(funcctx);
 }
 
+/*
+ * pg_gtm_latency_statistics - list the latency histograms of the GTM worker
+ * threads, one row per non-empty bucket, together with how many connections
+ * the thread found ready at its last and its busiest epoll wakeup.
+ */
+Datum
+pg_gtm_latency_statistics(PG_FUNCTION_ARGS)
+{
+#define NUM_GTM_LATENCY_COLUMNS    6
+    static const char *latency_names[LATENCY_CMD_COUNT] = {
+        "txn_begin",
+        "get_gts",
+        "snapshot",
+        "txn_commit",
+        "sequence",
+        "other"
+    };
+    FuncCallContext   *funcctx;
+    PG_Storage_status *mystatus;
+    GTM_ThreadLatencyItem *threads;
+
+    if (SRF_IS_FIRSTCALL())
+    {
+        TupleDesc    tupdesc;
+        MemoryContext oldcontext;
+        GTM_ThreadLatencyItem *remote = NULL;
+        int          nthreads;
+
+        funcctx = SRF_FIRSTCALL_INIT();
+        oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+        /* this had better match function's declaration in pg_proc.h */
+        tupdesc = CreateTemplateTupleDesc(NUM_GTM_LATENCY_COLUMNS, false);
+        TupleDescInitEntry(tupdesc, (AttrNumber) 1, "thread_id",
+                           INT4OID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber) 2, "last_ready",
+                           INT4OID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber) 3, "max_ready",
+                           INT4OID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber) 4, "command",
+                           TEXTOID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber) 5, "latency_below_us",
+                           INT8OID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber) 6, "requests",
+                           INT8OID, -1, 0);
+        funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+        mystatus = (PG_Storage_status *) palloc0(sizeof(PG_Storage_status));
+        funcctx->user_fctx = (void *) mystatus;
+
+        nthreads = GetGTMLatencyStatistics(PG_GETARG_BOOL(0), &remote);
+        if (nthreads < 0)
+        {
+            elog(ERROR, "get latency statistics from gtm failed");
+        }
+
+        /* the result buffer belongs to the GTM connection, keep a copy */
+        mystatus->totalIdx = nthreads * LATENCY_CMD_COUNT * GTM_LATENCY_BUCKETS;
+        mystatus->data = palloc(Max(nthreads, 1) * sizeof(GTM_ThreadLatencyItem));
+        if (nthreads > 0)
+            memcpy(mystatus->data, remote, nthreads * sizeof(GTM_ThreadLatencyItem));
+
+        MemoryContextSwitchTo(oldcontext);
+    }
+
+    funcctx  = SRF_PERCALL_SETUP();
+    mystatus = (PG_Storage_status *) funcctx->user_fctx;
+    threads  = (GTM_ThreadLatencyItem *) mystatus->data;
+    while (mystatus->currIdx < mystatus->totalIdx)
+    {
+        Datum        values[NUM_GTM_LATENCY_COLUMNS];
+        bool        nulls[NUM_GTM_LATENCY_COLUMNS];
+        int         idx = mystatus->currIdx++;
+        int         bucket = idx % GTM_LATENCY_BUCKETS;
+        int         cmd = (idx / GTM_LATENCY_BUCKETS) % LATENCY_CMD_COUNT;
+        GTM_ThreadLatencyItem *thread = &threads[idx / (GTM_LATENCY_BUCKETS * LATENCY_CMD_COUNT)];
+        HeapTuple    tuple;
+
+        if (thread->latency[cmd][bucket] == 0)
+            continue;
+
+        MemSet(nulls, false, sizeof(nulls));
+        values[0] = Int32GetDatum(thread->thread_id);
+        values[1] = Int32GetDatum(thread->last_ready);
+        values[2] = Int32GetDatum(thread->max_ready);
+        values[3] = CStringGetTextDatum(latency_names[cmd]);
+        /* the last bucket is open ended */
+        if (bucket == GTM_LATENCY_BUCKETS - 1)
+            nulls[4] = true;
+        else
+            values[4] = Int64GetDatum(INT64CONST(1) << bucket);
+        values[5] = Int64GetDatum(thread->latency[cmd][bucket]);
+
+        tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+        SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+    }
+
+    SRF_RETURN_DONE(funcctx);
+}
+
 #endif
 
 bool
@@ -1168,6 +1321,12 @@ GetMasterGtmInfo(void)
 static void
 CheckConnection(void)
 {
+#ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+	/* The pending reply has to be read before anything else goes out */
+	if (gts_prefetch_pending)
+		DiscardPrefetchedGlobalTimestamp();
+#endif
+
 	/* Be sure that a backend does not use a postmaster connection */
 	if (IsUnderPostmaster && GTMPQispostmaster(conn) == 1)
 	{
@@ -1314,6 +1473,9 @@ try_connect_gtm:
 void
 CloseGTM(void)
 {
+#ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+    gts_prefetch_pending = false;
+#endif
     if (conn)
     {
         GTMPQfinish(conn);
@@ -1334,26 +1496,38 @@ CloseGTM(void)
 }
 
 #ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
-GTM_Timestamp 
-GetGlobalTimestampGTM(void)
-{// #lizard forgives
+/*
+ * Fetch a global timestamp from GTM over our own connection, reconnecting
+ * once on failure.
+ */
+static Get_GTS_Result
+GetGlobalTimestampDirect(bool use_prefetched)
+{
     Get_GTS_Result gts_result = {InvalidGlobalTimestamp,false};
-    GTM_Timestamp  latest_gts = InvalidGlobalTimestamp;
-    struct rusage start_r;
-    struct timeval start_t;
-
-    if (log_gtm_stats)
-        ResetUsageCommon(&start_r, &start_t);
 
-    CheckConnection();
-    // TODO Isolation level
-    if (conn)
+    /*
+     * A timestamp requested earlier in this transaction is still newer than
+     * anything this session has committed, so a snapshot may use it. Commit
+     * and prepare timestamps must be taken after the fact and never do.
+     */
+    if (use_prefetched && gts_prefetch_pending && conn &&
+        gts_prefetch_lxid == MyProc->lxid)
     {
-        gts_result =  get_global_timestamp(conn);
+        gts_prefetch_pending = false;
+        gts_result = get_global_timestamp_receive(conn);
     }
-    else if(GTMDebugPrint)
+    else
     {
-        elog(LOG, "get global timestamp conn is null");
+        CheckConnection();
+        // TODO Isolation level
+        if (conn)
+        {
+            gts_result =  get_global_timestamp(conn);
+        }
+        else if(GTMDebugPrint)
+        {
+            elog(LOG, "get global timestamp conn is null");
+        }
     }
 
     /* If something went wrong (timeout), try and reset GTM connection
@@ -1378,6 +1552,171 @@ GetGlobalTimestampGTM(void)
     }
     elog(DEBUG7, "get global timestamp gts " INT64_FORMAT, gts_result.gts);
 
+    return gts_result;
+}
+
+/*
+ * Read and drop the reply of a prefetched global timestamp request, it has
+ * become useless once the connection is needed for something else or the
+ * transaction that asked for it is over.
+ */
+static void
+DiscardPrefetchedGlobalTimestamp(void)
+{
+    Get_GTS_Result gts_result;
+
+    gts_prefetch_pending = false;
+    if (conn == NULL)
+        return;
+
+    gts_result = get_global_timestamp_receive(conn);
+    if (!GlobalTimestampIsValid(gts_result.gts))
+    {
+        /* the stream may be out of step now, start over */
+        CloseGTM();
+        InitGTM();
+    }
+}
+
+/*
+ * Send a global timestamp request to GTM without waiting for the reply, so
+ * that the round trip overlaps with parsing and planning the statement. The
+ * next snapshot of the same transaction picks the reply up; any other use of
+ * the connection throws it away first.
+ */
+void
+PrefetchGlobalTimestampGTM(void)
+{
+    if (!enable_gts_prefetch || gts_prefetch_pending || MyProc == NULL)
+        return;
+
+#ifdef __TBASE__
+    /* brokered requests do not go over our own connection */
+    if (enable_gts_broker && IsUnderPostmaster && GTSBroker != NULL)
+        return;
+#endif
+
+    CheckConnection();
+    if (conn && get_global_timestamp_send(conn) == 0)
+    {
+        gts_prefetch_pending = true;
+        gts_prefetch_lxid = MyProc->lxid;
+    }
+}
+
+#ifdef __TBASE__
+Size
+GTSBrokerShmemSize(void)
+{
+    return MAXALIGN(sizeof(GTSBrokerData));
+}
+
+void
+GTSBrokerShmemInit(void)
+{
+    bool found;
+
+    GTSBroker = (GTSBrokerData *)
+        ShmemInitStruct("GTS broker", GTSBrokerShmemSize(), &found);
+
+    if (!found)
+    {
+        SpinLockInit(&GTSBroker->mutex);
+        GTSBroker->start_gen = 0;
+        GTSBroker->done_gen = 0;
+        GTSBroker->gts = InvalidGlobalTimestamp;
+        GTSBroker->gtm_readonly = false;
+    }
+}
+
+/*
+ * Get a global timestamp through the shared GTS broker.
+ *
+ * Any timestamp GTM hands out after our request began is as good as one
+ * fetched over our own connection, so concurrent callers elect a single
+ * leader to do the round trip and the rest reuse its result. start_gen
+ * counts fetches that have been started and done_gen is the generation of
+ * the last one published; once done_gen passes the start_gen we saw on
+ * entry, the published timestamp is fresh enough for us.
+ */
+static Get_GTS_Result
+GetGlobalTimestampBrokered(void)
+{
+    Get_GTS_Result gts_result = {InvalidGlobalTimestamp,false};
+    uint64         my_gen;
+
+    SpinLockAcquire(&GTSBroker->mutex);
+    my_gen = GTSBroker->start_gen;
+    SpinLockRelease(&GTSBroker->mutex);
+
+    for (;;)
+    {
+        SpinLockAcquire(&GTSBroker->mutex);
+        if (GTSBroker->done_gen > my_gen)
+        {
+            gts_result.gts = GTSBroker->gts;
+            gts_result.gtm_readonly = GTSBroker->gtm_readonly;
+            SpinLockRelease(&GTSBroker->mutex);
+            return gts_result;
+        }
+        SpinLockRelease(&GTSBroker->mutex);
+
+        /*
+         * Nobody has published a usable timestamp yet. Try to become the
+         * leader; if somebody else holds the lock, wait for it to go away
+         * and look again, since the holder's fetch may already cover us.
+         */
+        if (LWLockAcquireOrWait(GTSBrokerLock, LW_EXCLUSIVE))
+            break;
+    }
+
+    SpinLockAcquire(&GTSBroker->mutex);
+    if (GTSBroker->done_gen > my_gen)
+    {
+        gts_result.gts = GTSBroker->gts;
+        gts_result.gtm_readonly = GTSBroker->gtm_readonly;
+        SpinLockRelease(&GTSBroker->mutex);
+        LWLockRelease(GTSBrokerLock);
+        return gts_result;
+    }
+    my_gen = ++GTSBroker->start_gen;
+    SpinLockRelease(&GTSBroker->mutex);
+
+    gts_result = GetGlobalTimestampDirect(false);
+
+    /* Only publish good timestamps, followers will retry on their own. */
+    if (GlobalTimestampIsValid(gts_result.gts))
+    {
+        SpinLockAcquire(&GTSBroker->mutex);
+        GTSBroker->gts = gts_result.gts;
+        GTSBroker->gtm_readonly = gts_result.gtm_readonly;
+        GTSBroker->done_gen = my_gen;
+        SpinLockRelease(&GTSBroker->mutex);
+    }
+    LWLockRelease(GTSBrokerLock);
+
+    return gts_result;
+}
+#endif
+
+static GTM_Timestamp
+GetGlobalTimestampInternal(bool for_snapshot)
+{// #lizard forgives
+    Get_GTS_Result gts_result = {InvalidGlobalTimestamp,false};
+    GTM_Timestamp  latest_gts = InvalidGlobalTimestamp;
+    struct rusage start_r;
+    struct timeval start_t;
+
+    if (log_gtm_stats)
+        ResetUsageCommon(&start_r, &start_t);
+
+#ifdef __TBASE__
+    if (enable_gts_broker && IsUnderPostmaster && GTSBroker != NULL)
+        gts_result = GetGlobalTimestampBrokered();
+    else
+#endif
+        gts_result = GetGlobalTimestampDirect(for_snapshot);
+
     if (log_gtm_stats)
         ShowUsageCommon("BeginTranGTM", &start_r, &start_t);
 
@@ -1404,6 +1743,22 @@ GetGlobalTimestampGTM(void)
 	
 	return gts_result.gts;
 }
+
+GTM_Timestamp
+GetGlobalTimestampGTM(void)
+{
+    return GetGlobalTimestampInternal(false);
+}
+
+/*
+ * Like GetGlobalTimestampGTM, but may use the reply of a request prefetched
+ * earlier in the current transaction. Only for snapshots.
+ */
+GTM_Timestamp
+GetSnapshotTimestampGTM(void)
+{
+    return GetGlobalTimestampInternal(true);
+}
 #endif
 
 GlobalTransactionId
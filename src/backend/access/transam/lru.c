@@ -283,6 +283,7 @@ LruShmemSize(int nslots, int nlsns)
     sz += MAXALIGN(nslots * sizeof(bool));    /* page_dirty[] */
     sz += MAXALIGN(nslots * sizeof(int));    /* page_number[] */
     sz += MAXALIGN(nslots * sizeof(int));    /* page_lru_count[] */
+    sz += MAXALIGN(nslots * sizeof(pg_atomic_uint32));    /* page_seq[] */
     sz += MAXALIGN((nslots + 1) * sizeof(LWLockPadded));    /* buffer_locks[] */
 
     if (nlsns > 0)
@@ -518,6 +519,8 @@ LruInit(LruCtl ctl, const char *name, int nslots, int nlsns, int nbufs,
             offset += MAXALIGN(nslots * sizeof(int));
             shared->page_lru_count = (int *) (ptr + offset);
             offset += MAXALIGN(nslots * sizeof(int));
+            shared->page_seq = (pg_atomic_uint32 *) (ptr + offset);
+            offset += MAXALIGN(nslots * sizeof(pg_atomic_uint32));
 
             if (nlsns > 0)
             {
@@ -550,6 +553,7 @@ LruInit(LruCtl ctl, const char *name, int nslots, int nlsns, int nbufs,
                 shared->page_status[slotno] = LRU_PAGE_EMPTY;
                 shared->page_dirty[slotno] = false;
                 shared->page_lru_count[slotno] = 0;
+                pg_atomic_init_u32(&shared->page_seq[slotno], 0);
                 ptr += BLCKSZ;
             }
             LWLockInitialize(&shared->buffer_locks[slotno].lock,
@@ -604,6 +608,8 @@ LruZeroPage(LruCtl ctl, int partitionno, int pageno)
             !shared->page_dirty[slotno]) ||
            shared->page_number[slotno] == pageno);
 
+    LruBeginSlotChange(shared, slotno);
+
     if(shared->page_number[slotno] != pageno || 
         shared->page_status[slotno] == LRU_PAGE_EMPTY){
         
@@ -624,6 +630,8 @@ LruZeroPage(LruCtl ctl, int partitionno, int pageno)
     MemSet(shared->page_buffer[slotno], 0, BLCKSZ);
 	LruTlogEnableMemoryProtection(shared->page_buffer[slotno]);
 
+    LruEndSlotChange(shared, slotno);
+
     /* Set the LSNs for this new page to zero */
     LruZeroLSNs(ctl, partitionno, slotno);
 
@@ -708,7 +716,9 @@ LruWaitIO(LruCtl ctl, int partitionno, int slotno)
                 INIT_LRUBUFTAG(tag, pageno);
                 hash = LruBufTableHashCode(&tag);
                 LruBufTableDelete(&tag, hash);        
+                LruBeginSlotChange(shared, slotno);
                 shared->page_status[slotno] = LRU_PAGE_EMPTY;
+                LruEndSlotChange(shared, slotno);
             }
             else                /* write_in_progress */
             {
@@ -814,9 +824,11 @@ LruReadPage(LruCtl ctl, int partitionno, int pageno, bool write_ok,
             Assert(lookupno == slotno);
         }
 #endif
+        LruBeginSlotChange(shared, slotno);
         shared->page_number[slotno] = pageno;
         shared->page_status[slotno] = LRU_PAGE_READ_IN_PROGRESS;
         shared->page_dirty[slotno] = false;
+        LruEndSlotChange(shared, slotno);
 
 
         /* Acquire per-buffer lock (cannot deadlock, see notes at top) */
@@ -840,7 +852,9 @@ LruReadPage(LruCtl ctl, int partitionno, int pageno, bool write_ok,
                !shared->page_dirty[slotno]);
 
         
+        LruBeginSlotChange(shared, slotno);
         shared->page_status[slotno] = ok ? LRU_PAGE_VALID : LRU_PAGE_EMPTY;
+        LruEndSlotChange(shared, slotno);
         
         
         LWLockRelease(&shared->buffer_locks[slotno].lock);
@@ -884,6 +898,58 @@ LWLock * GetPartitionLock(LruCtl ctl, int partitionno)
 }
 
 
+/*
+ * Copy len bytes at offset of a resident page into dest without taking the
+ * partition lock.
+ *
+ * The slots of the partition are scanned for the page, and the copy is
+ * validated against the slot's change counter: it is only accepted if the
+ * counter was even before the copy and unchanged after it, i.e. nobody
+ * replaced, zeroed or wrote into the slot meanwhile.  Returns false if the
+ * page is not resident in a readable state or the copy raced with a writer;
+ * the caller then falls back to LruReadPage_ReadOnly.
+ */
+bool
+LruReadPageOptimistic(LruCtl ctl, int partitionno, int pageno,
+                      int offset, int len, char *dest)
+{
+    LruShared    shared = ctl->shared[partitionno];
+    int            slotno;
+
+    Assert(offset >= 0 && len >= 0 && offset + len <= BLCKSZ);
+
+    for (slotno = 0; slotno < shared->num_slots; slotno++)
+    {
+        uint32        seq;
+        LruPageStatus status;
+
+        if (shared->page_number[slotno] != pageno)
+            continue;
+
+        seq = pg_atomic_read_u32(&shared->page_seq[slotno]);
+        if (seq & 1)
+            return false;
+        pg_read_barrier();
+
+        status = shared->page_status[slotno];
+        if (shared->page_number[slotno] != pageno ||
+            (status != LRU_PAGE_VALID && status != LRU_PAGE_WRITE_IN_PROGRESS))
+            return false;
+
+        memcpy(dest, shared->page_buffer[slotno] + offset, len);
+
+        pg_read_barrier();
+        if (pg_atomic_read_u32(&shared->page_seq[slotno]) != seq)
+            return false;
+
+        /* See comments for LruRecentlyUsed macro */
+        LruRecentlyUsed(shared, slotno);
+        return true;
+    }
+
+    return false;
+}
+
 /*
  * Find a page in a shared buffer, reading it in if necessary.
  * The page number must correspond to an already-initialized page.
@@ -1764,7 +1830,9 @@ restart:;
             oldPartitionno = BufHashPartition(oldHash);
             Assert(oldPartitionno == partitionno);
             LruBufTableDelete(&oldTag, oldHash);
+            LruBeginSlotChange(shared, slotno);
             shared->page_status[slotno] = LRU_PAGE_EMPTY;
+            LruEndSlotChange(shared, slotno);
             elog(DEBUG10, "truncate pageno %d partition %d slotno %d cutoffpage %d.", oldPageno, partitionno, slotno, cutoffPage);
             continue;
         }
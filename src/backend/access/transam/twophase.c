@@ -137,6 +137,29 @@ int  transaction_threshold = 200000;
 #define GET_NODE "nodes:"
 #define GET_XID "xid:"
 
+/*
+ * Participants may commit prepared transactions asynchronously, see
+ * RecordTransactionCommitPrepared. The 2pc record files of such transactions
+ * are kept until their commit record is flushed, so that a crash in between
+ * still leaves pg_clean enough to finish them.
+ */
+bool        enable_async_commit_prepared = false;
+
+#ifdef __TWO_PHASE_TRANS__
+typedef struct AsyncCommitRecord
+{
+    char        gid[GIDSIZE];
+    XLogRecPtr  lsn;
+} AsyncCommitRecord;
+
+static List *asyncCommitRecords = NIL;
+static bool asyncCommitExitRegistered = false;
+
+static void RememberAsyncCommitRecord(const char *gid, XLogRecPtr lsn);
+static void RemoveFlushedAsyncCommitRecords(bool flush);
+static void AtProcExit_AsyncCommitRecords(int code, Datum arg);
+#endif
+
 /* GUC variable, can't be changed after startup */
 #ifdef PGXC
 int            max_prepared_xacts = 10000;  /* We require 2PC */
@@ -243,14 +266,15 @@ static GlobalTransaction MyLockedGxact = NULL;
 
 static bool twophaseExitRegistered = false;
 
-static void RecordTransactionCommitPrepared(TransactionId xid,
+static XLogRecPtr RecordTransactionCommitPrepared(TransactionId xid,
                                 int nchildren,
                                 TransactionId *children,
                                 int nrels,
                                 RelFileNode *rels,
                                 int ninvalmsgs,
                                 SharedInvalidationMessage *invalmsgs,
-                                bool initfileinval);
+                                bool initfileinval,
+                                bool async);
 static void RecordTransactionAbortPrepared(TransactionId xid,
                                int nchildren,
                                TransactionId *children,
@@ -412,6 +436,7 @@ RecoverEndGlobalPrepare(GlobalTransaction gxact)
     volatile PGXACT    *pgxact = &ProcGlobal->allPgXact[gxact->pgprocno];
     
     pg_atomic_write_u64(&pgxact->prepare_timestamp, gxact->prepared_timestamp);
+    ProcArrayAdvanceGeneration();
     elog(LOG, "recover proc no %d prepare timestamp " INT64_FORMAT " xid %d.", gxact->pgprocno, 
                             gxact->prepared_timestamp, pgxact->xid);
 
@@ -423,6 +448,7 @@ EndGlobalPrepare(GlobalTransaction gxact, bool isImplicit)
 	volatile PGXACT	*pgxact = &ProcGlobal->allPgXact[gxact->pgprocno];
 	
 	pg_atomic_write_u64(&pgxact->prepare_timestamp, GetGlobalPrepareTimestamp());
+	ProcArrayAdvanceGeneration();
 	if(enable_distri_print)
 	{
 		elog(LOG, "proc no %d prepare timestamp " INT64_FORMAT " xid %d.", gxact->pgprocno, 
@@ -477,6 +503,7 @@ void EndExplicitGlobalPrepare(char *gid)
     
     pgxact =  &ProcGlobal->allPgXact[gxact->pgprocno];
     pg_atomic_write_u64(&pgxact->prepare_timestamp, GetGlobalPrepareTimestamp());
+    ProcArrayAdvanceGeneration();
     if(enable_distri_print)
     {
         elog(LOG, "proc no %d explicit prepare timestamp " INT64_FORMAT " xid %d gid %s.", 
@@ -1736,6 +1763,8 @@ FinishPreparedTransaction(const char *gid, bool isCommit)
     DropInfo    *drop_info   = NULL;
 #endif
     int            i;
+    bool        async_commit = false;
+    XLogRecPtr    commit_lsn = InvalidXLogRecPtr;
 
 
 #ifdef __TWO_PHASE_TRANS__
@@ -1936,11 +1965,30 @@ FinishPreparedTransaction(const char *gid, bool isCommit)
      * callbacks will release the locks the transaction held.
      */
     if (isCommit)
-        RecordTransactionCommitPrepared(xid,
+    {
+        /*
+         * Only implicit transactions of a remote start node, which has made
+         * the commit decision durable already, may commit asynchronously.
+         * Relation files and state files are removed right afterwards, so
+         * transactions that own any keep the synchronous path.
+         */
+        async_commit = enable_async_commit_prepared &&
+                    IsConnFromCoord() &&
+                    !g_twophase_state.is_start_node &&
+                    IsXidImplicit(gid) &&
+                    !gxact->ondisk &&
+                    hdr->ncommitrels == 0 &&
+                    hdr->ncreatesegs == 0 &&
+                    hdr->ndropsegs == 0 &&
+                    hdr->nrenamesegs == 0;
+
+        commit_lsn = RecordTransactionCommitPrepared(xid,
                                         hdr->nsubxacts, children,
                                         hdr->ncommitrels, commitrels,
                                         hdr->ninvalmsgs, invalmsgs,
-                                        hdr->initfileinval);
+                                        hdr->initfileinval,
+                                        async_commit);
+    }
     else
         RecordTransactionAbortPrepared(xid,
                                        hdr->nsubxacts, children,
@@ -2062,7 +2110,10 @@ FinishPreparedTransaction(const char *gid, bool isCommit)
     /* delete the 2pc file while twophase transaction is committed on the current node */
     if(isCommit)
     {
-        remove_2pc_records(gid, false);
+        if (async_commit)
+            RememberAsyncCommitRecord(gid, commit_lsn);
+        else
+            remove_2pc_records(gid, false);
     }
     ClearLocalTwoPhaseState();
     
@@ -2740,7 +2791,7 @@ ProcessTwoPhaseBuffer(TransactionId xid,
  * We know the transaction made at least one XLOG entry (its PREPARE),
  * so it is never possible to optimize out the commit record.
  */
-static void
+static XLogRecPtr
 RecordTransactionCommitPrepared(TransactionId xid,
                                 int nchildren,
                                 TransactionId *children,
@@ -2748,7 +2799,8 @@ RecordTransactionCommitPrepared(TransactionId xid,
                                 RelFileNode *rels,
                                 int ninvalmsgs,
                                 SharedInvalidationMessage *invalmsgs,
-                                bool initfileinval)
+                                bool initfileinval,
+                                bool async)
 {// #lizard forgives
     XLogRecPtr    recptr;
     TimestampTz committs = GetCurrentTimestamp();
@@ -2835,17 +2887,28 @@ RecordTransactionCommitPrepared(TransactionId xid,
                                    replorigin_session_origin, false, InvalidXLogRecPtr);
 #endif
     /*
-     * We don't currently try to sleep before flush here ... nor is there any
-     * support for async commit of a prepared xact (the very idea is probably
-     * a contradiction)
+     * We don't currently try to sleep before flush here.
+     *
+     * A participant may commit asynchronously: the start node has flushed
+     * the commit decision before sending COMMIT PREPARED, so if we crash
+     * before our commit record reaches disk the transaction comes back as
+     * prepared and pg_clean commits it again with the same timestamp. As with
+     * asynchronous commit, pg_xact pages are kept from reaching disk ahead
+     * of the record.
      */
+    if (async)
+    {
+        XLogSetAsyncXactLSN(recptr);
+        TransactionIdAsyncCommitTree(xid, nchildren, children, recptr);
+    }
+    else
+    {
+        /* Flush XLOG to disk */
+        XLogFlush(recptr);
 
-    /* Flush XLOG to disk */
-    XLogFlush(recptr);
-
-
-    /* Mark the transaction committed in pg_xact */
-    TransactionIdCommitTree(xid, nchildren, children);
+        /* Mark the transaction committed in pg_xact */
+        TransactionIdCommitTree(xid, nchildren, children);
+    }
 
 
     /* Checkpoint can proceed now */
@@ -2897,7 +2960,10 @@ RecordTransactionCommitPrepared(TransactionId xid,
      * Note that at this stage we have marked clog, but still show as running
      * in the procarray and continue to hold locks.
      */
-    SyncRepWaitForLSN(recptr, true);
+    if (!async)
+        SyncRepWaitForLSN(recptr, true);
+
+    return recptr;
 }
 
 /*
@@ -3408,6 +3474,84 @@ void remove_2pc_records(const char * tid, bool record_in_xlog)
     }
 }
 
+/*
+ * Keep the 2pc record file of an asynchronously committed transaction until
+ * its commit record has been flushed.
+ */
+static void
+RememberAsyncCommitRecord(const char *gid, XLogRecPtr lsn)
+{
+    MemoryContext       oldcontext;
+    AsyncCommitRecord  *record;
+
+    if (!asyncCommitExitRegistered)
+    {
+        before_shmem_exit(AtProcExit_AsyncCommitRecords, 0);
+        asyncCommitExitRegistered = true;
+    }
+
+    oldcontext = MemoryContextSwitchTo(TopMemoryContext);
+    record = (AsyncCommitRecord *) palloc(sizeof(AsyncCommitRecord));
+    strncpy(record->gid, gid, GIDSIZE);
+    record->gid[GIDSIZE - 1] = '\0';
+    record->lsn = lsn;
+    asyncCommitRecords = lappend(asyncCommitRecords, record);
+    MemoryContextSwitchTo(oldcontext);
+}
+
+/*
+ * Remove the 2pc record files whose commit record is on disk by now, or all
+ * of them after flushing XLOG if 'flush' is set.
+ */
+static void
+RemoveFlushedAsyncCommitRecords(bool flush)
+{
+    XLogRecPtr  flushed;
+    ListCell   *cell;
+    ListCell   *prev = NULL;
+    ListCell   *next;
+
+    if (asyncCommitRecords == NIL)
+        return;
+
+    if (flush)
+        XLogFlush(((AsyncCommitRecord *) llast(asyncCommitRecords))->lsn);
+    flushed = GetFlushRecPtr();
+
+    for (cell = list_head(asyncCommitRecords); cell != NULL; cell = next)
+    {
+        AsyncCommitRecord *record = (AsyncCommitRecord *) lfirst(cell);
+
+        next = lnext(cell);
+        if (record->lsn <= flushed)
+        {
+            remove_2pc_records(record->gid, false);
+            asyncCommitRecords = list_delete_cell(asyncCommitRecords, cell, prev);
+            pfree(record);
+        }
+        else
+            prev = cell;
+    }
+}
+
+static void
+AtProcExit_AsyncCommitRecords(int code, Datum arg)
+{
+    RemoveFlushedAsyncCommitRecords(true);
+}
+
+/*
+ * Called once the answer to a command has been sent: make the commit records
+ * of the prepared transactions committed asynchronously since durable and
+ * remove their 2pc record files, so that none is left behind while the
+ * backend waits for its next command.
+ */
+void
+AtIdle_AsyncCommitRecords(void)
+{
+    RemoveFlushedAsyncCommitRecords(true);
+}
+
 void record_2pc_readonly(const char *gid)
 {
     File fd = 0;
@@ -390,6 +390,9 @@ static uint64 globalXidVersion = 0;
 static char *saveNodeString = NULL;
 #endif
 static bool XactLocalNodePrepared;
+#ifdef __TBASE__
+int64 XactRemoteCommitTime = 0;
+#endif
 static bool  XactReadLocalNode;
 static bool  XactWriteLocalNode;
 
@@ -1813,6 +1816,7 @@ RecordTransactionCommit(void)
             volatile PGXACT *pgxact = MyPgXact;
             
             pg_atomic_write_u64(&pgxact->prepare_timestamp, FrozenGlobalTimestamp);
+            ProcArrayAdvanceGeneration();
             if(delay_before_acquire_committs)
             {
                 pg_usleep(delay_before_acquire_committs);
@@ -2697,6 +2701,9 @@ CommitTransaction(void)
     TransactionState s = CurrentTransactionState;
     TransactionId latestXid;
     bool        is_parallel_worker;
+#ifdef __TBASE__
+    TimestampTz remote_commit_start = 0;
+#endif
 
     if(enable_distri_print)
     {
@@ -2778,6 +2785,11 @@ CommitTransaction(void)
     s->topGlobalTransansactionId = s->transactionId;
     if (IS_PGXC_LOCAL_COORDINATOR)
     {
+#ifdef __TBASE__
+        /* prepare and commit on the remote nodes are timed together */
+        remote_commit_start = GetCurrentTimestamp();
+        XactRemoteCommitTime = 0;
+#endif
         XactLocalNodePrepared = false;
         if (savePrepareGID)
         {
@@ -2897,6 +2909,10 @@ CommitTransaction(void)
             PreventTransactionChain(true, "COMMIT IMPLICIT PREPARED");
             FinishPreparedTransaction(savePrepareGID, true);
         }
+#ifdef __TBASE__
+        if (remote_commit_start != 0)
+            XactRemoteCommitTime = GetCurrentTimestamp() - remote_commit_start;
+#endif
 
         /*
          * The current transaction may have been ended and we might have
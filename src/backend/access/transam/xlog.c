@@ -37,6 +37,9 @@
 #include "access/xloginsert.h"
 #include "access/xlogreader.h"
 #include "access/xlogutils.h"
+#ifdef __TBASE__
+#include "access/xlogprefetch.h"
+#endif
 #include "catalog/catversion.h"
 #include "catalog/pg_control.h"
 #include "catalog/pg_database.h"
@@ -115,7 +118,7 @@ char       *XLogArchiveCommand = NULL;
 bool        EnableHotStandby = false;
 bool        fullPageWrites = true;
 bool        wal_log_hints = false;
-bool        wal_compression = false;
+int            wal_compression = WAL_COMPRESSION_NONE;
 char       *wal_consistency_checking_string = NULL;
 bool       *wal_consistency_checking = NULL;
 bool        log_checkpoints = false;
@@ -167,7 +170,12 @@ bool g_wal_check;
  * to happen concurrently, but adds some CPU overhead to flushing the WAL,
  * which needs to iterate all the locks.
  */
+#ifdef __TBASE__
+int            wal_insert_locks = 8;
+#define NUM_XLOGINSERT_LOCKS  wal_insert_locks
+#else
 #define NUM_XLOGINSERT_LOCKS  8
+#endif
 
 /*
  * Max distance from last checkpoint, before triggering a new xlog-based
@@ -217,6 +225,29 @@ const struct config_enum_entry archive_mode_options[] = {
     {NULL, 0, false}
 };
 
+/*
+ * "on" keeps meaning pglz, the only method before lz4 and zstd were added.
+ * The methods a build lacks support for are not accepted.
+ */
+const struct config_enum_entry wal_compression_options[] = {
+    {"pglz", WAL_COMPRESSION_PGLZ, false},
+#ifdef USE_LZ4
+    {"lz4", WAL_COMPRESSION_LZ4, false},
+#endif
+#ifdef USE_ZSTD
+    {"zstd", WAL_COMPRESSION_ZSTD, false},
+#endif
+    {"on", WAL_COMPRESSION_PGLZ, false},
+    {"off", WAL_COMPRESSION_NONE, false},
+    {"true", WAL_COMPRESSION_PGLZ, true},
+    {"false", WAL_COMPRESSION_NONE, true},
+    {"yes", WAL_COMPRESSION_PGLZ, true},
+    {"no", WAL_COMPRESSION_NONE, true},
+    {"1", WAL_COMPRESSION_PGLZ, true},
+    {"0", WAL_COMPRESSION_NONE, true},
+    {NULL, 0, false}
+};
+
 /*
  * Statistics for current checkpoint are collected in this global struct.
  * Because only the checkpointer or a stand-alone backend can perform
@@ -525,6 +556,10 @@ typedef struct
     LWLock        lock;
     XLogRecPtr    insertingAt;
     XLogRecPtr    lastImportantAt;
+#ifdef __TBASE__
+    /* times an inserter had to sleep on this lock, bumped by its holder */
+    pg_atomic_uint64 waits;
+#endif
 } WALInsertLock;
 
 /*
@@ -760,6 +795,21 @@ typedef struct XLogCtlData
     XLogRecPtr    lastFpwDisableRecPtr;
 
     slock_t        info_lck;        /* locks shared variables shown above */
+
+#ifdef __TBASE__
+    /*
+     * Group flush statistics, see pg_stat_get_wal_flush().  flushRequests
+     * counts XLogFlush() calls that could not be satisfied from the local
+     * LogwrtResult, flushGrouped those of them that another backend's flush
+     * covered while we waited, flushWaitTime the microseconds spent waiting
+     * for the flush to finish.  syncs and syncTime count issue_xlog_fsync().
+     */
+    pg_atomic_uint64 flushRequests;
+    pg_atomic_uint64 flushGrouped;
+    pg_atomic_uint64 flushWaitTime;
+    pg_atomic_uint64 syncs;
+    pg_atomic_uint64 syncTime;
+#endif
 } XLogCtlData;
 
 static XLogCtlData *XLogCtl = NULL;
@@ -1725,6 +1775,9 @@ WALInsertLockAcquire(void)
          * across the locks.
          */
         lockToTry = (lockToTry + 1) % NUM_XLOGINSERT_LOCKS;
+#ifdef __TBASE__
+        pg_atomic_fetch_add_u64(&WALInsertLocks[MyLockNo].l.waits, 1);
+#endif
     }
 }
 
@@ -2889,6 +2942,11 @@ XLogFlush(XLogRecPtr record)
 {// #lizard forgives
     XLogRecPtr    WriteRqstPtr;
     XLogwrtRqst WriteRqst;
+#ifdef __TBASE__
+    bool        flushed_by_us = false;
+    instr_time    flush_start;
+    instr_time    flush_time;
+#endif
 
     /*
      * During REDO, we are reading not writing WAL.  Therefore, instead of
@@ -2934,6 +2992,10 @@ XLogFlush(XLogRecPtr record)
 
     START_CRIT_SECTION();
 
+#ifdef __TBASE__
+    INSTR_TIME_SET_CURRENT(flush_start);
+#endif
+
     /*
      * Since fsync is usually a horribly expensive operation, we try to
      * piggyback as much data as we can on each fsync: if we see any more data
@@ -3027,12 +3089,25 @@ XLogFlush(XLogRecPtr record)
         WriteRqst.Flush = insertpos;
 
         XLogWrite(WriteRqst, false);
+#ifdef __TBASE__
+        flushed_by_us = true;
+#endif
 
         LWLockRelease(WALWriteLock);
         /* done */
         break;
     }
 
+#ifdef __TBASE__
+    INSTR_TIME_SET_CURRENT(flush_time);
+    INSTR_TIME_SUBTRACT(flush_time, flush_start);
+    pg_atomic_fetch_add_u64(&XLogCtl->flushRequests, 1);
+    if (!flushed_by_us)
+        pg_atomic_fetch_add_u64(&XLogCtl->flushGrouped, 1);
+    pg_atomic_fetch_add_u64(&XLogCtl->flushWaitTime,
+                            INSTR_TIME_GET_MICROSEC(flush_time));
+#endif
+
     END_CRIT_SECTION();
 
     /* wake up walsenders now that we've released heavily contended locks */
@@ -5069,6 +5144,9 @@ XLOGShmemInit(void)
         LWLockInitialize(&WALInsertLocks[i].l.lock, LWTRANCHE_WAL_INSERT);
         WALInsertLocks[i].l.insertingAt = InvalidXLogRecPtr;
         WALInsertLocks[i].l.lastImportantAt = InvalidXLogRecPtr;
+#ifdef __TBASE__
+        pg_atomic_init_u64(&WALInsertLocks[i].l.waits, 0);
+#endif
     }
 
     /*
@@ -5100,6 +5178,13 @@ XLOGShmemInit(void)
     SpinLockInit(&XLogCtl->info_lck);
     SpinLockInit(&XLogCtl->ulsn_lck);
     InitSharedLatch(&XLogCtl->recoveryWakeupLatch);
+#ifdef __TBASE__
+    pg_atomic_init_u64(&XLogCtl->flushRequests, 0);
+    pg_atomic_init_u64(&XLogCtl->flushGrouped, 0);
+    pg_atomic_init_u64(&XLogCtl->flushWaitTime, 0);
+    pg_atomic_init_u64(&XLogCtl->syncs, 0);
+    pg_atomic_init_u64(&XLogCtl->syncTime, 0);
+#endif
 
     /*
      * If we are not in bootstrap mode, pg_control should already exist. Read
@@ -6648,6 +6733,7 @@ StartupXLOG(void)
 #ifdef __TBASE__
     nodeLockRecovery();
     RecoverShardStatistic();
+    pgstat_restore_shared_tabstats();
 #endif
 
     if (ControlFile->state < DB_SHUTDOWNED ||
@@ -7503,6 +7589,9 @@ StartupXLOG(void)
         {
             ErrorContextCallback errcallback;
             TimestampTz xtime;
+#ifdef __TBASE__
+            XLogPrefetcher *prefetcher = XLogPrefetcherAllocate();
+#endif
 
             InRedo = true;
 
@@ -7539,6 +7628,12 @@ StartupXLOG(void)
                 /* Handle interrupt signals of startup process */
                 HandleStartupProcInterrupts();
 
+#ifdef __TBASE__
+                /* start reading the blocks of the next records */
+                if (prefetcher)
+                    XLogPrefetcherReadAhead(prefetcher, ReadRecPtr, curFileTLI);
+#endif
+
                 /*
                  * Pause WAL replay, if requested by a hot-standby session via
                  * SetRecoveryPause().
@@ -7737,6 +7832,11 @@ StartupXLOG(void)
              * end of main redo apply loop
              */
 
+#ifdef __TBASE__
+            if (prefetcher)
+                XLogPrefetcherFree(prefetcher);
+#endif
+
             if (reachedStopPoint)
             {
                 if (!reachedConsistency)
@@ -8772,6 +8872,32 @@ GetLastImportantRecPtr(void)
     return res;
 }
 
+#ifdef __TBASE__
+/*
+ * Get the WAL insertion lock and group flush counters, for
+ * pg_stat_get_wal_flush().  The counters are read without locking, so
+ * they need not be mutually consistent.
+ */
+void
+GetXLogFlushStats(uint64 *insert_lock_waits, uint64 *flush_requests,
+                  uint64 *flush_grouped, uint64 *flush_wait_time,
+                  uint64 *syncs, uint64 *sync_time)
+{
+    uint64        waits = 0;
+    int            i;
+
+    for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+        waits += pg_atomic_read_u64(&WALInsertLocks[i].l.waits);
+
+    *insert_lock_waits = waits;
+    *flush_requests = pg_atomic_read_u64(&XLogCtl->flushRequests);
+    *flush_grouped = pg_atomic_read_u64(&XLogCtl->flushGrouped);
+    *flush_wait_time = pg_atomic_read_u64(&XLogCtl->flushWaitTime);
+    *syncs = pg_atomic_read_u64(&XLogCtl->syncs);
+    *sync_time = pg_atomic_read_u64(&XLogCtl->syncTime);
+}
+#endif
+
 /*
  * Get the time and LSN of the last xlog segment switch
  */
@@ -9553,6 +9679,9 @@ CheckPointGuts(XLogRecPtr checkPointRedo, int flags)
 #ifdef _MLS_
     CheckPointRelCrypt();
 #endif
+#ifdef __TBASE__
+    pgstat_save_shared_tabstats();
+#endif
 }
 
 /*
@@ -10763,6 +10892,13 @@ assign_xlog_sync_method(int new_sync_method, void *extra)
 void
 issue_xlog_fsync(int fd, XLogSegNo segno)
 {// #lizard forgives
+#ifdef __TBASE__
+    instr_time    sync_start;
+    instr_time    sync_time;
+
+    INSTR_TIME_SET_CURRENT(sync_start);
+#endif
+
     switch (sync_method)
     {
         case SYNC_METHOD_FSYNC:
@@ -10798,6 +10934,18 @@ issue_xlog_fsync(int fd, XLogSegNo segno)
             elog(PANIC, "unrecognized wal_sync_method: %d", sync_method);
             break;
     }
+
+#ifdef __TBASE__
+    /* open_sync methods have synced in XLogWrite, nothing to count here */
+    if (sync_method != SYNC_METHOD_OPEN && sync_method != SYNC_METHOD_OPEN_DSYNC)
+    {
+        INSTR_TIME_SET_CURRENT(sync_time);
+        INSTR_TIME_SUBTRACT(sync_time, sync_start);
+        pg_atomic_fetch_add_u64(&XLogCtl->syncs, 1);
+        pg_atomic_fetch_add_u64(&XLogCtl->syncTime,
+                                INSTR_TIME_GET_MICROSEC(sync_time));
+    }
+#endif
 }
 
 /*
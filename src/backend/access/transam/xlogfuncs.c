@@ -35,6 +35,7 @@
 #include "utils/tuplestore.h"
 #include "storage/fd.h"
 #include "storage/ipc.h"
+#include "storage/procarray.h"
 
 
 /*
@@ -513,6 +514,59 @@ pg_walfile_name_offset(PG_FUNCTION_ARGS)
     PG_RETURN_DATUM(result);
 }
 
+#ifdef __TBASE__
+/*
+ * Report WAL insertion lock waits and group flush statistics.  Times are
+ * returned in milliseconds.
+ */
+Datum
+pg_stat_get_wal_flush(PG_FUNCTION_ARGS)
+{
+    uint64        insert_lock_waits;
+    uint64        flush_requests;
+    uint64        flush_grouped;
+    uint64        flush_wait_time;
+    uint64        syncs;
+    uint64        sync_time;
+    Datum        values[6];
+    bool        isnull[6];
+    TupleDesc    resultTupleDesc;
+
+    /*
+     * Construct a tuple descriptor for the result row.  This must match this
+     * function's pg_proc entry!
+     */
+    resultTupleDesc = CreateTemplateTupleDesc(6, false);
+    TupleDescInitEntry(resultTupleDesc, (AttrNumber) 1, "insert_lock_waits",
+                       INT8OID, -1, 0);
+    TupleDescInitEntry(resultTupleDesc, (AttrNumber) 2, "flush_requests",
+                       INT8OID, -1, 0);
+    TupleDescInitEntry(resultTupleDesc, (AttrNumber) 3, "flush_grouped",
+                       INT8OID, -1, 0);
+    TupleDescInitEntry(resultTupleDesc, (AttrNumber) 4, "flush_wait_time",
+                       FLOAT8OID, -1, 0);
+    TupleDescInitEntry(resultTupleDesc, (AttrNumber) 5, "syncs",
+                       INT8OID, -1, 0);
+    TupleDescInitEntry(resultTupleDesc, (AttrNumber) 6, "sync_time",
+                       FLOAT8OID, -1, 0);
+    resultTupleDesc = BlessTupleDesc(resultTupleDesc);
+
+    GetXLogFlushStats(&insert_lock_waits, &flush_requests, &flush_grouped,
+                      &flush_wait_time, &syncs, &sync_time);
+
+    MemSet(isnull, 0, sizeof(isnull));
+    values[0] = Int64GetDatum((int64) insert_lock_waits);
+    values[1] = Int64GetDatum((int64) flush_requests);
+    values[2] = Int64GetDatum((int64) flush_grouped);
+    values[3] = Float8GetDatum((double) flush_wait_time / 1000.0);
+    values[4] = Int64GetDatum((int64) syncs);
+    values[5] = Float8GetDatum((double) sync_time / 1000.0);
+
+    PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(resultTupleDesc,
+                                                      values, isnull)));
+}
+#endif
+
 /*
  * Compute an xlog file name given a WAL location,
  * such as is returned by pg_stop_backup() or pg_switch_wal().
@@ -609,6 +663,29 @@ pg_last_xact_replay_timestamp(PG_FUNCTION_ARGS)
     PG_RETURN_TIMESTAMPTZ(xtime);
 }
 
+#ifdef __TBASE__
+/*
+ * Returns the global timestamp of the latest replayed commit record.
+ *
+ * Snapshots taken at or before it see on this standby what they would see
+ * on the master.  Returns NULL when the server is not in recovery.
+ */
+Datum
+pg_last_replay_global_timestamp(PG_FUNCTION_ARGS)
+{
+    GlobalTimestamp gts;
+
+    if (!RecoveryInProgress())
+        PG_RETURN_NULL();
+
+    gts = GetLatestCommitTS();
+    if (!GlobalTimestampIsValid(gts))
+        PG_RETURN_NULL();
+
+    PG_RETURN_INT64(gts);
+}
+#endif
+
 /*
  * Returns bool with current recovery mode, a global state.
  */
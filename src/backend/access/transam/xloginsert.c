@@ -25,6 +25,12 @@
 #include "access/xloginsert.h"
 #include "catalog/pg_control.h"
 #include "common/pg_lzcompress.h"
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
 #include "miscadmin.h"
 #include "replication/origin.h"
 #include "storage/bufmgr.h"
@@ -34,6 +40,17 @@
 
 /* Buffer size required to store a compressed version of backup block image */
 #define PGLZ_MAX_BLCKSZ PGLZ_MAX_OUTPUT(BLCKSZ)
+#ifdef USE_LZ4
+#define LZ4_MAX_BLCKSZ LZ4_COMPRESSBOUND(BLCKSZ)
+#else
+#define LZ4_MAX_BLCKSZ 0
+#endif
+#ifdef USE_ZSTD
+#define ZSTD_MAX_BLCKSZ ZSTD_COMPRESSBOUND(BLCKSZ)
+#else
+#define ZSTD_MAX_BLCKSZ 0
+#endif
+#define COMPRESS_BUFSIZE Max(Max(PGLZ_MAX_BLCKSZ, LZ4_MAX_BLCKSZ), ZSTD_MAX_BLCKSZ)
 
 /*
  * For each block reference registered with XLogRegisterBuffer, we fill in
@@ -60,7 +77,7 @@ typedef struct
                                  * backup block data in XLogRecordAssemble() */
 
     /* buffer to store a compressed version of backup block image */
-    char        compressed_page[PGLZ_MAX_BLCKSZ];
+    char        compressed_page[COMPRESS_BUFSIZE];
 } registered_buffer;
 
 static registered_buffer *registered_buffers;
@@ -643,7 +660,7 @@ XLogRecordAssemble(RmgrId rmid, uint8 info,
             /*
              * Try to compress a block image if wal_compression is enabled
              */
-            if (wal_compression)
+            if (wal_compression != WAL_COMPRESSION_NONE)
             {
                 is_compressed =
                     XLogCompressBackupBlock(page, bimg.hole_offset,
@@ -678,7 +695,21 @@ XLogRecordAssemble(RmgrId rmid, uint8 info,
             if (is_compressed)
             {
                 bimg.length = compressed_len;
-                bimg.bimg_info |= BKPIMAGE_IS_COMPRESSED;
+                switch ((WalCompression) wal_compression)
+                {
+                    case WAL_COMPRESSION_PGLZ:
+                        bimg.bimg_info |= BKPIMAGE_IS_COMPRESSED;
+                        break;
+                    case WAL_COMPRESSION_LZ4:
+                        bimg.bimg_info |= BKPIMAGE_COMPRESS_LZ4;
+                        break;
+                    case WAL_COMPRESSION_ZSTD:
+                        bimg.bimg_info |= BKPIMAGE_COMPRESS_ZSTD;
+                        break;
+                    case WAL_COMPRESSION_NONE:
+                        Assert(false);    /* cannot happen */
+                        break;
+                }
 
                 rdt_datas_last->data = regbuf->compressed_page;
                 rdt_datas_last->len = compressed_len;
@@ -818,7 +849,8 @@ XLogRecordAssemble(RmgrId rmid, uint8 info,
 }
 
 /*
- * Create a compressed version of a backup block image.
+ * Create a compressed version of a backup block image, using the method
+ * selected by wal_compression.
  *
  * Returns FALSE if compression fails (i.e., compressed result is actually
  * bigger than original). Otherwise, returns TRUE and sets 'dlen' to
@@ -829,7 +861,7 @@ XLogCompressBackupBlock(char *page, uint16 hole_offset, uint16 hole_length,
                         char *dest, uint16 *dlen)
 {
     int32        orig_len = BLCKSZ - hole_length;
-    int32        len;
+    int32        len = -1;
     int32        extra_bytes = 0;
     char       *source;
     char        tmp[BLCKSZ];
@@ -852,12 +884,48 @@ XLogCompressBackupBlock(char *page, uint16 hole_offset, uint16 hole_length,
     else
         source = page;
 
+    switch ((WalCompression) wal_compression)
+    {
+        case WAL_COMPRESSION_PGLZ:
+            len = pglz_compress(source, orig_len, dest, PGLZ_strategy_default);
+            break;
+
+        case WAL_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+            len = LZ4_compress_default(source, dest, orig_len,
+                                       COMPRESS_BUFSIZE);
+            if (len <= 0)
+                len = -1;        /* failure */
+#else
+            elog(ERROR, "LZ4 is not supported by this build");
+#endif
+            break;
+
+        case WAL_COMPRESSION_ZSTD:
+#ifdef USE_ZSTD
+            {
+                size_t        zlen;
+
+                zlen = ZSTD_compress(dest, COMPRESS_BUFSIZE, source, orig_len,
+                                     ZSTD_CLEVEL_DEFAULT);
+                if (!ZSTD_isError(zlen))
+                    len = (int32) zlen;
+            }
+#else
+            elog(ERROR, "zstd is not supported by this build");
+#endif
+            break;
+
+        case WAL_COMPRESSION_NONE:
+            Assert(false);        /* cannot happen */
+            break;
+    }
+
     /*
-     * We recheck the actual size even if pglz_compress() reports success and
-     * see if the number of bytes saved by compression is larger than the
-     * length of extra data needed for the compressed version of block image.
+     * We recheck the actual size even if compression reports success and see
+     * if the number of bytes saved by compression is larger than the length
+     * of extra data needed for the compressed version of block image.
      */
-    len = pglz_compress(source, orig_len, dest, PGLZ_strategy_default);
     if (len >= 0 &&
         len + extra_bytes < orig_len)
     {
@@ -0,0 +1,253 @@
+/*-------------------------------------------------------------------------
+ *
+ * xlogprefetch.c
+ *        Prefetching of data blocks referenced by WAL ahead of redo.
+ *
+ * Redo is applied by the startup process alone, and spends most of its time
+ * waiting for synchronous reads of the data blocks the records modify. To
+ * keep several reads in flight, a second WAL reader decodes the records up to
+ * recovery_prefetch_distance past the record being replayed, and issues
+ * asynchronous reads for the blocks they reference, so that the blocks are
+ * usually in the kernel cache by the time redo reads them. Records are still
+ * applied one by one in WAL order.
+ *
+ * The read-ahead reader reads the segments in pg_wal directly. It is only a
+ * hint: whenever it can not read or decode a record, because the WAL is not
+ * there yet or comes from the archive, it stops and starts over from the
+ * replay position once replay has passed that point.
+ *
+ * Blocks with a full-page image, or that redo initializes, are not read by
+ * redo and are skipped, as are blocks already in shared buffers.
+ *
+ * Portions Copyright (c) 2020-Present, TBase Development Team, Tencent
+ *
+ * IDENTIFICATION
+ *      src/backend/access/transam/xlogprefetch.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "access/xlog_internal.h"
+#include "access/xlogprefetch.h"
+#include "access/xlogreader.h"
+#include "access/xlogrecord.h"
+#include "storage/bufmgr.h"
+#include "storage/fd.h"
+
+/* GUC, in kilobytes of WAL ahead of replay, 0 disables prefetching */
+int            recovery_prefetch_distance = 256;
+
+/* number of recently prefetched blocks remembered to skip duplicates */
+#define XLOG_PREFETCH_RECENT    64
+
+typedef struct XLogPrefetchBlock
+{
+    RelFileNode rnode;
+    ForkNumber    forknum;
+    BlockNumber blkno;
+} XLogPrefetchBlock;
+
+struct XLogPrefetcher
+{
+    XLogReaderState *reader;
+    TimeLineID    tli;            /* timeline of the segments read */
+    int            readFile;        /* open segment, or -1 */
+    XLogSegNo    readSegNo;        /* segment number of readFile */
+
+    bool        started;        /* reader positioned on a record? */
+    XLogRecPtr    stalledAt;        /* reading stopped before this point */
+
+    XLogPrefetchBlock recent[XLOG_PREFETCH_RECENT];
+    int            nextRecent;
+};
+
+static int XLogPrefetcherReadPage(XLogReaderState *state,
+                       XLogRecPtr targetPagePtr, int reqLen,
+                       XLogRecPtr targetRecPtr, char *readBuf,
+                       TimeLineID *pageTLI);
+static void XLogPrefetcherCloseFile(XLogPrefetcher *prefetcher);
+static void XLogPrefetcherPrefetchBlocks(XLogPrefetcher *prefetcher,
+                             XLogReaderState *record);
+
+XLogPrefetcher *
+XLogPrefetcherAllocate(void)
+{
+    XLogPrefetcher *prefetcher;
+
+    prefetcher = (XLogPrefetcher *) palloc0(sizeof(XLogPrefetcher));
+    prefetcher->reader = XLogReaderAllocate(XLogPrefetcherReadPage, prefetcher);
+    if (prefetcher->reader == NULL)
+    {
+        pfree(prefetcher);
+        return NULL;
+    }
+    prefetcher->readFile = -1;
+    prefetcher->stalledAt = InvalidXLogRecPtr;
+
+    return prefetcher;
+}
+
+void
+XLogPrefetcherFree(XLogPrefetcher *prefetcher)
+{
+    XLogPrefetcherCloseFile(prefetcher);
+    XLogReaderFree(prefetcher->reader);
+    pfree(prefetcher);
+}
+
+/*
+ * Decode records up to recovery_prefetch_distance past replayPtr, the start
+ * of the record about to be replayed, and prefetch the blocks they need.
+ */
+void
+XLogPrefetcherReadAhead(XLogPrefetcher *prefetcher, XLogRecPtr replayPtr,
+                        TimeLineID tli)
+{
+    XLogReaderState *reader = prefetcher->reader;
+    XLogRecPtr    horizon;
+    XLogRecord *record;
+    char       *errormsg;
+
+    if (recovery_prefetch_distance <= 0)
+        return;
+
+    /* after a failure, wait until replay got past the failing point */
+    if (!XLogRecPtrIsInvalid(prefetcher->stalledAt))
+    {
+        if (replayPtr <= prefetcher->stalledAt)
+            return;
+        prefetcher->stalledAt = InvalidXLogRecPtr;
+        prefetcher->started = false;
+    }
+
+    /* follow timeline switches of replay */
+    if (tli != prefetcher->tli)
+    {
+        XLogPrefetcherCloseFile(prefetcher);
+        prefetcher->tli = tli;
+        prefetcher->started = false;
+    }
+
+    /* replay overtook us, no point in prefetching what's done already */
+    if (prefetcher->started && reader->EndRecPtr <= replayPtr)
+        prefetcher->started = false;
+
+    horizon = replayPtr + (XLogRecPtr) recovery_prefetch_distance * 1024;
+
+    while (!prefetcher->started || reader->EndRecPtr < horizon)
+    {
+        XLogRecPtr    readPtr = prefetcher->started ? reader->EndRecPtr : replayPtr;
+
+        record = XLogReadRecord(reader,
+                                prefetcher->started ? InvalidXLogRecPtr : replayPtr,
+                                &errormsg);
+        if (record == NULL)
+        {
+            prefetcher->stalledAt = readPtr;
+            XLogPrefetcherCloseFile(prefetcher);
+            return;
+        }
+
+        /* the record being replayed was prefetched before, if at all */
+        if (prefetcher->started)
+            XLogPrefetcherPrefetchBlocks(prefetcher, reader);
+        prefetcher->started = true;
+    }
+}
+
+static void
+XLogPrefetcherPrefetchBlocks(XLogPrefetcher *prefetcher,
+                             XLogReaderState *record)
+{
+    int            block_id;
+    int            i;
+
+    for (block_id = 0; block_id <= record->max_block_id; block_id++)
+    {
+        DecodedBkpBlock *blk = &record->blocks[block_id];
+        XLogPrefetchBlock *recent;
+
+        if (!blk->in_use)
+            continue;
+
+        /* redo won't read these */
+        if (blk->apply_image || (blk->flags & BKPBLOCK_WILL_INIT))
+            continue;
+
+        for (i = 0; i < XLOG_PREFETCH_RECENT; i++)
+        {
+            recent = &prefetcher->recent[i];
+            if (recent->blkno == blk->blkno &&
+                recent->forknum == blk->forknum &&
+                RelFileNodeEquals(recent->rnode, blk->rnode))
+                break;
+        }
+        if (i < XLOG_PREFETCH_RECENT)
+            continue;
+
+        if (PrefetchRedoBuffer(blk->rnode, blk->forknum, blk->blkno))
+        {
+            recent = &prefetcher->recent[prefetcher->nextRecent];
+            recent->rnode = blk->rnode;
+            recent->forknum = blk->forknum;
+            recent->blkno = blk->blkno;
+            prefetcher->nextRecent = (prefetcher->nextRecent + 1) %
+                XLOG_PREFETCH_RECENT;
+        }
+    }
+}
+
+static void
+XLogPrefetcherCloseFile(XLogPrefetcher *prefetcher)
+{
+    if (prefetcher->readFile >= 0)
+    {
+        close(prefetcher->readFile);
+        prefetcher->readFile = -1;
+    }
+}
+
+/*
+ * Read a WAL page from pg_wal, for the read-ahead reader. Any failure just
+ * ends the read-ahead.
+ */
+static int
+XLogPrefetcherReadPage(XLogReaderState *state, XLogRecPtr targetPagePtr,
+                       int reqLen, XLogRecPtr targetRecPtr, char *readBuf,
+                       TimeLineID *pageTLI)
+{
+    XLogPrefetcher *prefetcher = (XLogPrefetcher *) state->private_data;
+    XLogSegNo    segno;
+    uint32        offset;
+
+    XLByteToSeg(targetPagePtr, segno);
+    offset = targetPagePtr % XLogSegSize;
+
+    if (prefetcher->readFile >= 0 && prefetcher->readSegNo != segno)
+        XLogPrefetcherCloseFile(prefetcher);
+
+    if (prefetcher->readFile < 0)
+    {
+        char        path[MAXPGPATH];
+
+        XLogFilePath(path, prefetcher->tli, segno);
+        prefetcher->readFile = BasicOpenFile(path, O_RDONLY | PG_BINARY, 0);
+        if (prefetcher->readFile < 0)
+            return -1;
+        prefetcher->readSegNo = segno;
+    }
+
+    if (lseek(prefetcher->readFile, (off_t) offset, SEEK_SET) < 0 ||
+        read(prefetcher->readFile, readBuf, XLOG_BLCKSZ) != XLOG_BLCKSZ)
+    {
+        XLogPrefetcherCloseFile(prefetcher);
+        return -1;
+    }
+
+    *pageTLI = prefetcher->tli;
+    return XLOG_BLCKSZ;
+}
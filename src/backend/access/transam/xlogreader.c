@@ -23,6 +23,12 @@
 #include "access/xlogreader.h"
 #include "catalog/pg_control.h"
 #include "common/pg_lzcompress.h"
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
 #include "replication/origin.h"
 #ifndef FRONTEND
 #include "utils/memutils.h"
@@ -1147,7 +1153,7 @@ DecodeXLogRecord(XLogReaderState *state, XLogRecord *record, char **errormsg)
 
                 blk->apply_image = ((blk->bimg_info & BKPIMAGE_APPLY) != 0);
 
-                if (blk->bimg_info & BKPIMAGE_IS_COMPRESSED)
+                if (BKPIMAGE_COMPRESSED(blk->bimg_info))
                 {
                     if (blk->bimg_info & BKPIMAGE_HAS_HOLE)
                         COPY_HEADER_FIELD(&blk->hole_length, sizeof(uint16));
@@ -1192,29 +1198,29 @@ DecodeXLogRecord(XLogReaderState *state, XLogRecord *record, char **errormsg)
                 }
 
                 /*
-                 * cross-check that bimg_len < BLCKSZ if the IS_COMPRESSED
-                 * flag is set.
+                 * cross-check that bimg_len < BLCKSZ if the page image is
+                 * compressed.
                  */
-                if ((blk->bimg_info & BKPIMAGE_IS_COMPRESSED) &&
+                if (BKPIMAGE_COMPRESSED(blk->bimg_info) &&
                     blk->bimg_len == BLCKSZ)
                 {
                     report_invalid_record(state,
-                                          "BKPIMAGE_IS_COMPRESSED set, but block image length %u at %X/%X",
+                                          "BKPIMAGE_COMPRESSED set, but block image length %u at %X/%X",
                                           (unsigned int) blk->bimg_len,
                                           (uint32) (state->ReadRecPtr >> 32), (uint32) state->ReadRecPtr);
                     goto err;
                 }
 
                 /*
-                 * cross-check that bimg_len = BLCKSZ if neither HAS_HOLE nor
-                 * IS_COMPRESSED flag is set.
+                 * cross-check that bimg_len = BLCKSZ if the page image has
+                 * neither a hole nor compression.
                  */
                 if (!(blk->bimg_info & BKPIMAGE_HAS_HOLE) &&
-                    !(blk->bimg_info & BKPIMAGE_IS_COMPRESSED) &&
+                    !BKPIMAGE_COMPRESSED(blk->bimg_info) &&
                     blk->bimg_len != BLCKSZ)
                 {
                     report_invalid_record(state,
-                                          "neither BKPIMAGE_HAS_HOLE nor BKPIMAGE_IS_COMPRESSED set, but block image length is %u at %X/%X",
+                                          "neither BKPIMAGE_HAS_HOLE nor BKPIMAGE_COMPRESSED set, but block image length is %u at %X/%X",
                                           (unsigned int) blk->data_len,
                                           (uint32) (state->ReadRecPtr >> 32), (uint32) state->ReadRecPtr);
                     goto err;
@@ -1407,11 +1413,52 @@ RestoreBlockImage(XLogReaderState *record, uint8 block_id, char *page)
     bkpb = &record->blocks[block_id];
     ptr = bkpb->bkp_image;
 
-    if (bkpb->bimg_info & BKPIMAGE_IS_COMPRESSED)
+    if (BKPIMAGE_COMPRESSED(bkpb->bimg_info))
     {
         /* If a backup block image is compressed, decompress it */
-        if (pglz_decompress(ptr, bkpb->bimg_len, tmp,
-                            BLCKSZ - bkpb->hole_length) < 0)
+        bool        decomp_success = true;
+
+        if (bkpb->bimg_info & BKPIMAGE_IS_COMPRESSED)
+        {
+            if (pglz_decompress(ptr, bkpb->bimg_len, tmp,
+                                BLCKSZ - bkpb->hole_length) < 0)
+                decomp_success = false;
+        }
+        else if (bkpb->bimg_info & BKPIMAGE_COMPRESS_LZ4)
+        {
+#ifdef USE_LZ4
+            if (LZ4_decompress_safe(ptr, tmp, bkpb->bimg_len,
+                                    BLCKSZ - bkpb->hole_length) <= 0)
+                decomp_success = false;
+#else
+            report_invalid_record(record, "image at %X/%X compressed with %s not supported by build, block %d",
+                                  (uint32) (record->ReadRecPtr >> 32),
+                                  (uint32) record->ReadRecPtr,
+                                  "LZ4",
+                                  block_id);
+            return false;
+#endif
+        }
+        else if (bkpb->bimg_info & BKPIMAGE_COMPRESS_ZSTD)
+        {
+#ifdef USE_ZSTD
+            size_t        decomp_result;
+
+            decomp_result = ZSTD_decompress(tmp, BLCKSZ - bkpb->hole_length,
+                                            ptr, bkpb->bimg_len);
+            if (ZSTD_isError(decomp_result))
+                decomp_success = false;
+#else
+            report_invalid_record(record, "image at %X/%X compressed with %s not supported by build, block %d",
+                                  (uint32) (record->ReadRecPtr >> 32),
+                                  (uint32) record->ReadRecPtr,
+                                  "zstd",
+                                  block_id);
+            return false;
+#endif
+        }
+
+        if (!decomp_success)
         {
             report_invalid_record(record, "invalid compressed image at %X/%X, block %d",
                                   (uint32) (record->ReadRecPtr >> 32),
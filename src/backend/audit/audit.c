@@ -8408,260 +8408,302 @@ static AuditMode audit_hit_get_reverse_mode(bool is_success)
     return AuditMode_Success;
 }
 
-static bool audit_hit_match_in_pg_audit_o(AuditHitInfo * audit_hit,
-                                             AuditSQL action_id,
-                                             AuditMode reverse_mode)
+/*
+ * Compiled audit rules.
+ *
+ * The rows of pg_audit_o, pg_audit_d, pg_audit_u and pg_audit_s are read
+ * once per backend into one hash table, so that deciding whether a statement
+ * hits an audit rule costs hash probes instead of catalog scans. Any change
+ * of those catalogs shows up as a syscache invalidation, which throws the
+ * table away; it is rebuilt on the next use.
+ */
+typedef enum AuditRuleKind
 {
-    int32 sys_cacheid = InvalidSysCacheID;
-    Oid sys_reloid = InvalidOid;
-    Oid sys_indoid = InvalidOid;
-
-    int sys_nkeys = 0;
-    ScanKeyData skey[Audit_nSysScanKeys];
+    AuditRuleKind_Object = 1,
+    AuditRuleKind_ObjectDefault,
+    AuditRuleKind_User,
+    AuditRuleKind_Statement
+} AuditRuleKind;
 
-    Relation sys_rel = NULL;
-    LOCKMODE lockmode = AccessShareLock;
-    
-    SysScanDesc sd = NULL;
-    HeapTuple    tup = NULL;
+typedef struct AuditRuleKey
+{
+    int32       kind;                               /* AuditRuleKind */
+    int32       action_id;                          /* AuditSQL */
+    Oid         id1;                                /* class_id or user_id */
+    Oid         id2;                                /* object_id */
+    int32       id3;                                /* object_sub_id */
+} AuditRuleKey;
+
+typedef struct AuditRuleEntry
+{
+    AuditRuleKey key;
+    uint8       modes;                              /* AuditRuleModeBit of turned on rows */
+} AuditRuleEntry;
 
-    bool is_match = false;
+#define AuditRuleModeBit(mode) \
+    ((mode) == AuditMode_All ? 0x01 : \
+     (mode) == AuditMode_Success ? 0x02 : \
+     (mode) == AuditMode_Fail ? 0x04 : 0x08)
 
-    audit_get_cacheid_pg_audit_o(&(sys_cacheid), NULL);
-    GetSysCacheInfo(sys_cacheid, 
-                    &sys_reloid,
-                    &sys_indoid,
-                    NULL);
+static HTAB * gAuditRuleHash = NULL;
+static MemoryContext gAuditRuleContext = NULL;
+static bool gAuditRuleValid = false;
+static int32 gAuditRuleCount[AuditRuleKind_Statement + 1];
 
-    MemSet(skey, 0, sizeof(skey));
-
-    ScanKeyInit(&(skey[sys_nkeys]),
-                Anum_audit_obj_conf_class_id,
-                BTEqualStrategyNumber, F_OIDEQ,
-                ObjectIdGetDatum(audit_hit->obj_addr.classId)); sys_nkeys++;
-    ScanKeyInit(&(skey[sys_nkeys]),
-                Anum_audit_obj_conf_object_id,
-                BTEqualStrategyNumber, F_OIDEQ,
-                ObjectIdGetDatum(audit_hit->obj_addr.objectId)); sys_nkeys++;
-    ScanKeyInit(&(skey[sys_nkeys]),
-                Anum_audit_obj_conf_object_sub_id,
-                BTEqualStrategyNumber, F_INT4EQ,
-                Int32GetDatum(audit_hit->obj_addr.objectSubId)); sys_nkeys++;
-    ScanKeyInit(&(skey[sys_nkeys]),
-                Anum_audit_obj_conf_action_id,
-                BTEqualStrategyNumber, F_INT4EQ,
-                Int32GetDatum(action_id)); sys_nkeys++;
+static void audit_rule_invalidate_callback(Datum arg, int cacheid, uint32 hashvalue)
+{
+    gAuditRuleValid = false;
+}
 
-    sys_rel = heap_open(sys_reloid, lockmode);
-    sd = systable_beginscan(sys_rel, 
-                            sys_indoid,
-                            true,
-                            NULL, 
-                            sys_nkeys,
-                            skey);
+static void audit_rule_add(AuditRuleKind kind,
+                           AuditSQL action_id,
+                           Oid id1,
+                           Oid id2,
+                           int32 id3,
+                           AuditMode mode,
+                           bool ison)
+{
+    AuditRuleKey key;
+    AuditRuleEntry * entry = NULL;
+    bool found = false;
 
-    while ((tup = systable_getnext(sd)) != NULL)
+    if (ison == false)
     {
-        Form_audit_obj_conf pg_struct = (Form_audit_obj_conf)(GETSTRUCT(tup));
-        AuditMode audit_mode = (AuditMode)pg_struct->action_mode;
-        bool action_ison = pg_struct->action_ison;
-        
-        if (action_ison == true && 
-            audit_mode != reverse_mode)
-        {
-            is_match = true;
-            break;
-        }
+        return;
     }
 
-    systable_endscan(sd);
-    heap_close(sys_rel, lockmode);
+    MemSet(&key, 0, sizeof(key));
+    key.kind = kind;
+    key.action_id = action_id;
+    key.id1 = id1;
+    key.id2 = id2;
+    key.id3 = id3;
 
-    return is_match;
+    entry = (AuditRuleEntry *) hash_search(gAuditRuleHash, &key, HASH_ENTER, &found);
+    if (found == false)
+    {
+        entry->modes = 0;
+        gAuditRuleCount[kind]++;
+    }
+    entry->modes |= AuditRuleModeBit(mode);
 }
 
-static bool audit_hit_match_in_pg_audit_d(AuditHitInfo * audit_hit,
-                                             AuditSQL action_id,
-                                             AuditMode reverse_mode)
+static void audit_rule_load_catalog(int32 sys_cacheid, AuditRuleKind kind)
 {
-    int32 sys_cacheid = InvalidSysCacheID;
     Oid sys_reloid = InvalidOid;
     Oid sys_indoid = InvalidOid;
-
-    int sys_nkeys = 0;
-    ScanKeyData skey[Audit_nSysScanKeys];
-
     Relation sys_rel = NULL;
     LOCKMODE lockmode = AccessShareLock;
-    
     SysScanDesc sd = NULL;
-    HeapTuple    tup = NULL;
-
-    bool is_match = false;
+    HeapTuple tup = NULL;
 
-    audit_get_cacheid_pg_audit_d((int32 *)&(sys_cacheid), NULL);
     GetSysCacheInfo(sys_cacheid, 
                     &sys_reloid,
                     &sys_indoid,
                     NULL);
 
-    MemSet(skey, 0, sizeof(skey));
-
-    ScanKeyInit(&(skey[sys_nkeys]),
-                Anum_audit_obj_def_opts_action_id,
-                BTEqualStrategyNumber, F_INT4EQ,
-                Int32GetDatum(action_id)); sys_nkeys++;
-
     sys_rel = heap_open(sys_reloid, lockmode);
-    sd = systable_beginscan(sys_rel, 
-                            sys_indoid,
-                            true,
-                            NULL, 
-                            sys_nkeys,
-                            skey);
+    sd = systable_beginscan(sys_rel, InvalidOid, false, NULL, 0, NULL);
 
     while ((tup = systable_getnext(sd)) != NULL)
     {
-        Form_audit_obj_def_opts pg_struct = (Form_audit_obj_def_opts)(GETSTRUCT(tup));
-        AuditMode audit_mode = (AuditMode)pg_struct->action_mode;
-        bool action_ison = pg_struct->action_ison;
-        
-        if (action_ison == true && 
-            audit_mode != reverse_mode)
+        switch (kind)
         {
-            is_match = true;
-            break;
+            case AuditRuleKind_Object:
+            {
+                Form_audit_obj_conf pg_struct = (Form_audit_obj_conf)(GETSTRUCT(tup));
+                audit_rule_add(kind, pg_struct->action_id,
+                               pg_struct->class_id, pg_struct->object_id,
+                               pg_struct->object_sub_id,
+                               (AuditMode) pg_struct->action_mode,
+                               pg_struct->action_ison);
+                break;
+            }
+            case AuditRuleKind_ObjectDefault:
+            {
+                Form_audit_obj_def_opts pg_struct = (Form_audit_obj_def_opts)(GETSTRUCT(tup));
+                audit_rule_add(kind, pg_struct->action_id,
+                               InvalidOid, InvalidOid, 0,
+                               (AuditMode) pg_struct->action_mode,
+                               pg_struct->action_ison);
+                break;
+            }
+            case AuditRuleKind_User:
+            {
+                Form_audit_user_conf pg_struct = (Form_audit_user_conf)(GETSTRUCT(tup));
+                audit_rule_add(kind, pg_struct->action_id,
+                               pg_struct->user_id, InvalidOid, 0,
+                               (AuditMode) pg_struct->action_mode,
+                               pg_struct->action_ison);
+                break;
+            }
+            case AuditRuleKind_Statement:
+            {
+                Form_audit_stmt_conf pg_struct = (Form_audit_stmt_conf)(GETSTRUCT(tup));
+                audit_rule_add(kind, pg_struct->action_id,
+                               InvalidOid, InvalidOid, 0,
+                               (AuditMode) pg_struct->action_mode,
+                               pg_struct->action_ison);
+                break;
+            }
+            default:
+                Assert(0);
+                break;
         }
     }
 
     systable_endscan(sd);
     heap_close(sys_rel, lockmode);
-
-    return is_match;
 }
 
-static bool audit_hit_match_in_pg_audit_u(AuditHitInfo * audit_hit,
-                                             AuditSQL action_id,
-                                             AuditMode reverse_mode)
+static void audit_rule_build(void)
 {
+    static bool callback_registered = false;
     int32 sys_cacheid = InvalidSysCacheID;
-    Oid sys_reloid = InvalidOid;
-    Oid sys_indoid = InvalidOid;
-
-    int sys_nkeys = 0;
-    ScanKeyData skey[Audit_nSysScanKeys];
+    HASHCTL hash_ctl;
 
-    Relation sys_rel = NULL;
-    LOCKMODE lockmode = AccessShareLock;
-    
-    SysScanDesc sd = NULL;
-    HeapTuple    tup = NULL;
+    if (gAuditRuleValid)
+    {
+        return;
+    }
 
-    bool is_match = false;
+    if (gAuditRuleContext == NULL)
+    {
+        gAuditRuleContext = AllocSetContextCreate(CacheMemoryContext,
+                                                  "Audit rules",
+                                                  ALLOCSET_DEFAULT_SIZES);
+    }
 
-    audit_get_cacheid_pg_audit_u((int32 *)&(sys_cacheid), NULL);
-    GetSysCacheInfo(sys_cacheid, 
-                    &sys_reloid,
-                    &sys_indoid,
-                    NULL);
+    if (callback_registered == false)
+    {
+        audit_get_cacheid_pg_audit_o(&(sys_cacheid), NULL);
+        CacheRegisterSyscacheCallback(sys_cacheid, audit_rule_invalidate_callback, (Datum) 0);
+        audit_get_cacheid_pg_audit_d(&(sys_cacheid), NULL);
+        CacheRegisterSyscacheCallback(sys_cacheid, audit_rule_invalidate_callback, (Datum) 0);
+        audit_get_cacheid_pg_audit_u(&(sys_cacheid), NULL);
+        CacheRegisterSyscacheCallback(sys_cacheid, audit_rule_invalidate_callback, (Datum) 0);
+        audit_get_cacheid_pg_audit_s(&(sys_cacheid), NULL);
+        CacheRegisterSyscacheCallback(sys_cacheid, audit_rule_invalidate_callback, (Datum) 0);
+        callback_registered = true;
+    }
 
-    MemSet(skey, 0, sizeof(skey));
+    /* 
+     * an invalidation arriving while we read the catalogs clears
+     * gAuditRuleValid again, so set it before reading
+     */
+    gAuditRuleValid = true;
 
-    ScanKeyInit(&(skey[sys_nkeys]),
-                Anum_audit_user_conf_user_id,
-                BTEqualStrategyNumber, F_OIDEQ,
-                ObjectIdGetDatum(GetUserId())); sys_nkeys++;
-    ScanKeyInit(&(skey[sys_nkeys]),
-                Anum_audit_user_conf_action_id,
-                BTEqualStrategyNumber, F_INT4EQ,
-                Int32GetDatum(action_id)); sys_nkeys++;
+    MemoryContextReset(gAuditRuleContext);
+    MemSet(gAuditRuleCount, 0, sizeof(gAuditRuleCount));
 
-    sys_rel = heap_open(sys_reloid, lockmode);
-    sd = systable_beginscan(sys_rel, 
-                            sys_indoid,
-                            true,
-                            NULL, 
-                            sys_nkeys,
-                            skey);
+    MemSet(&hash_ctl, 0, sizeof(hash_ctl));
+    hash_ctl.keysize = sizeof(AuditRuleKey);
+    hash_ctl.entrysize = sizeof(AuditRuleEntry);
+    hash_ctl.hcxt = gAuditRuleContext;
+    gAuditRuleHash = hash_create("Audit rules", 256, &hash_ctl,
+                                 HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
 
-    while ((tup = systable_getnext(sd)) != NULL)
+    PG_TRY();
     {
-        Form_audit_user_conf pg_struct = (Form_audit_user_conf)(GETSTRUCT(tup));
-        AuditMode audit_mode = (AuditMode)pg_struct->action_mode;
-        bool action_ison = pg_struct->action_ison;
-        
-        if (action_ison == true && 
-            audit_mode != reverse_mode)
-        {
-            is_match = true;
-            break;
-        }
+        audit_get_cacheid_pg_audit_o(&(sys_cacheid), NULL);
+        audit_rule_load_catalog(sys_cacheid, AuditRuleKind_Object);
+        audit_get_cacheid_pg_audit_d(&(sys_cacheid), NULL);
+        audit_rule_load_catalog(sys_cacheid, AuditRuleKind_ObjectDefault);
+        audit_get_cacheid_pg_audit_u(&(sys_cacheid), NULL);
+        audit_rule_load_catalog(sys_cacheid, AuditRuleKind_User);
+        audit_get_cacheid_pg_audit_s(&(sys_cacheid), NULL);
+        audit_rule_load_catalog(sys_cacheid, AuditRuleKind_Statement);
     }
-
-    systable_endscan(sd);
-    heap_close(sys_rel, lockmode);
-
-    return is_match;
+    PG_CATCH();
+    {
+        gAuditRuleValid = false;
+        PG_RE_THROW();
+    }
+    PG_END_TRY();
 }
 
-static bool audit_hit_match_in_pg_audit_s(AuditHitInfo * audit_hit,
-                                             AuditSQL action_id,
-                                             AuditMode reverse_mode)
+/*
+ * Is there a turned on rule for the key whose mode is not reverse_mode
+ */
+static bool audit_rule_match(AuditRuleKind kind,
+                             AuditSQL action_id,
+                             Oid id1,
+                             Oid id2,
+                             int32 id3,
+                             AuditMode reverse_mode)
 {
-    int32 sys_cacheid = InvalidSysCacheID;
-    Oid sys_reloid = InvalidOid;
-    Oid sys_indoid = InvalidOid;
-
-    int sys_nkeys = 0;
-    ScanKeyData skey[Audit_nSysScanKeys];
+    AuditRuleKey key;
+    AuditRuleEntry * entry = NULL;
 
-    Relation sys_rel = NULL;
-    LOCKMODE lockmode = AccessShareLock;
-    
-    SysScanDesc sd = NULL;
-    HeapTuple    tup = NULL;
+    audit_rule_build();
 
-    bool is_match = false;
+    if (gAuditRuleCount[kind] == 0)
+    {
+        return false;
+    }
 
-    audit_get_cacheid_pg_audit_s((int32 *)&(sys_cacheid), NULL);
-    GetSysCacheInfo(sys_cacheid, 
-                    &sys_reloid,
-                    &sys_indoid,
-                    NULL);
+    MemSet(&key, 0, sizeof(key));
+    key.kind = kind;
+    key.action_id = action_id;
+    key.id1 = id1;
+    key.id2 = id2;
+    key.id3 = id3;
 
-    MemSet(skey, 0, sizeof(skey));
+    entry = (AuditRuleEntry *) hash_search(gAuditRuleHash, &key, HASH_FIND, NULL);
+    if (entry == NULL)
+    {
+        return false;
+    }
 
-    ScanKeyInit(&(skey[sys_nkeys]),
-                Anum_audit_stmt_conf_action_id,
-                BTEqualStrategyNumber, F_INT4EQ,
-                Int32GetDatum(action_id)); sys_nkeys++;
+    return (entry->modes & ~AuditRuleModeBit(reverse_mode)) != 0;
+}
 
-    sys_rel = heap_open(sys_reloid, lockmode);
-    sd = systable_beginscan(sys_rel, 
-                            sys_indoid,
-                            true,
-                            NULL, 
-                            sys_nkeys,
-                            skey);
+static bool audit_hit_match_in_pg_audit_o(AuditHitInfo * audit_hit,
+                                             AuditSQL action_id,
+                                             AuditMode reverse_mode)
+{
+    return audit_rule_match(AuditRuleKind_Object,
+                            action_id,
+                            audit_hit->obj_addr.classId,
+                            audit_hit->obj_addr.objectId,
+                            audit_hit->obj_addr.objectSubId,
+                            reverse_mode);
+}
 
-    while ((tup = systable_getnext(sd)) != NULL)
-    {
-        Form_audit_stmt_conf pg_struct = (Form_audit_stmt_conf)(GETSTRUCT(tup));
-        AuditMode audit_mode = (AuditMode)pg_struct->action_mode;
-        bool action_ison = pg_struct->action_ison;
-        
-        if (action_ison == true && 
-            audit_mode != reverse_mode)
-        {
-            is_match = true;
-            break;
-        }
-    }
+static bool audit_hit_match_in_pg_audit_d(AuditHitInfo * audit_hit,
+                                             AuditSQL action_id,
+                                             AuditMode reverse_mode)
+{
+    return audit_rule_match(AuditRuleKind_ObjectDefault,
+                            action_id,
+                            InvalidOid,
+                            InvalidOid,
+                            0,
+                            reverse_mode);
+}
 
-    systable_endscan(sd);
-    heap_close(sys_rel, lockmode);
+static bool audit_hit_match_in_pg_audit_u(AuditHitInfo * audit_hit,
+                                             AuditSQL action_id,
+                                             AuditMode reverse_mode)
+{
+    return audit_rule_match(AuditRuleKind_User,
+                            action_id,
+                            GetUserId(),
+                            InvalidOid,
+                            0,
+                            reverse_mode);
+}
 
-    return is_match;
+static bool audit_hit_match_in_pg_audit_s(AuditHitInfo * audit_hit,
+                                             AuditSQL action_id,
+                                             AuditMode reverse_mode)
+{
+    return audit_rule_match(AuditRuleKind_Statement,
+                            action_id,
+                            InvalidOid,
+                            InvalidOid,
+                            0,
+                            reverse_mode);
 }
 
 static void audit_hit_rebuild_hit_info(AuditHitInfo * hit_info,
@@ -47,6 +47,7 @@
 #include "catalog/pg_trigger.h"
 #include "catalog/pg_type.h"
 #include "catalog/storage.h"
+#include "commands/progress.h"
 #include "commands/tablecmds.h"
 #include "commands/trigger.h"
 #include "executor/executor.h"
@@ -55,6 +56,7 @@
 #include "nodes/nodeFuncs.h"
 #include "optimizer/clauses.h"
 #include "parser/parser.h"
+#include "pgstat.h"
 #include "pgxc/pgxc.h"
 #include "storage/bufmgr.h"
 #include "storage/lmgr.h"
@@ -2097,6 +2099,10 @@ index_build(Relation heapRelation,
                            save_sec_context | SECURITY_RESTRICTED_OPERATION);
     save_nestlevel = NewGUCNestLevel();
 
+    if (pgstat_progress_command() == PROGRESS_COMMAND_CREATE_INDEX)
+        pgstat_progress_update_param(PROGRESS_CREATEIDX_INDEX_OID,
+                                     RelationGetRelid(indexRelation));
+
     /*
      * Call the access method's build procedure
      */
@@ -2283,6 +2289,8 @@ IndexBuildHeapRangeScan(Relation heapRelation,
     BlockNumber root_blkno = InvalidBlockNumber;
     OffsetNumber root_offsets[MaxHeapTuplesPerPage];
     ScanState * node = NULL;
+    bool        report_progress;
+    BlockNumber blks_scanned = 0;
     /*
      * sanity checks
      */
@@ -2356,6 +2364,25 @@ IndexBuildHeapRangeScan(Relation heapRelation,
 
     reltuples = 0;
 
+    /* Brin summarization gets here from VACUUM too, which reports its own */
+    report_progress = (pgstat_progress_command() == PROGRESS_COMMAND_CREATE_INDEX);
+    if (report_progress)
+    {
+        const int    index[] = {
+            PROGRESS_CREATEIDX_PHASE,
+            PROGRESS_CREATEIDX_HEAP_BLKS_TOTAL,
+            PROGRESS_CREATEIDX_HEAP_BLKS_SCANNED,
+            PROGRESS_CREATEIDX_TUPLES_DONE
+        };
+        int64        val[4];
+
+        val[0] = PROGRESS_CREATEIDX_PHASE_SCAN_HEAP;
+        val[1] = (numblocks != InvalidBlockNumber) ? numblocks : scan->rs_nblocks;
+        val[2] = 0;
+        val[3] = 0;
+        pgstat_progress_update_multi_param(4, index, val);
+    }
+
 #ifdef _MLS_
     if (heapRelation->rd_att->transp_crypt)
     {
@@ -2408,6 +2435,19 @@ IndexBuildHeapRangeScan(Relation heapRelation,
             LockBuffer(scan->rs_cbuf, BUFFER_LOCK_UNLOCK);
 
             root_blkno = scan->rs_cblock;
+
+            if (report_progress)
+            {
+                const int    index[] = {
+                    PROGRESS_CREATEIDX_HEAP_BLKS_SCANNED,
+                    PROGRESS_CREATEIDX_TUPLES_DONE
+                };
+                int64        val[2];
+
+                val[0] = ++blks_scanned;
+                val[1] = (int64) reltuples;
+                pgstat_progress_update_multi_param(2, index, val);
+            }
         }
 
         if (snapshot == SnapshotAny)
@@ -2685,6 +2725,20 @@ IndexBuildHeapRangeScan(Relation heapRelation,
 
     heap_endscan(scan);
 
+    /* the AM sorts and loads what the scan produced from here on */
+    if (report_progress)
+    {
+        const int    index[] = {
+            PROGRESS_CREATEIDX_PHASE,
+            PROGRESS_CREATEIDX_TUPLES_DONE
+        };
+        int64        val[2];
+
+        val[0] = PROGRESS_CREATEIDX_PHASE_BUILD;
+        val[1] = (int64) reltuples;
+        pgstat_progress_update_multi_param(2, index, val);
+    }
+
     /* we can now forget our snapshot, if set */
     if (IsBootstrapProcessingMode() || indexInfo->ii_Concurrent)
         UnregisterSnapshot(snapshot);
@@ -3048,6 +3102,8 @@ validate_index_heapscan(Relation heapRelation,
     BlockNumber root_blkno = InvalidBlockNumber;
     OffsetNumber root_offsets[MaxHeapTuplesPerPage];
     bool        in_index[MaxHeapTuplesPerPage];
+    bool        report_progress;
+    BlockNumber blks_scanned = 0;
 
     /* state variables for the merge */
     ItemPointer indexcursor = NULL;
@@ -3086,6 +3142,22 @@ validate_index_heapscan(Relation heapRelation,
                                 true,    /* buffer access strategy OK */
                                 false); /* syncscan not OK */
 
+    report_progress = (pgstat_progress_command() == PROGRESS_COMMAND_CREATE_INDEX);
+    if (report_progress)
+    {
+        const int    index[] = {
+            PROGRESS_CREATEIDX_PHASE,
+            PROGRESS_CREATEIDX_HEAP_BLKS_TOTAL,
+            PROGRESS_CREATEIDX_HEAP_BLKS_SCANNED
+        };
+        int64        val[3];
+
+        val[0] = PROGRESS_CREATEIDX_PHASE_VALIDATE;
+        val[1] = scan->rs_nblocks;
+        val[2] = 0;
+        pgstat_progress_update_multi_param(3, index, val);
+    }
+
     /*
      * Scan all tuples matching the snapshot.
      */
@@ -3124,6 +3196,10 @@ validate_index_heapscan(Relation heapRelation,
             memset(in_index, 0, sizeof(in_index));
 
             root_blkno = scan->rs_cblock;
+
+            if (report_progress)
+                pgstat_progress_update_param(PROGRESS_CREATEIDX_HEAP_BLKS_SCANNED,
+                                             ++blks_scanned);
         }
 
         /* Convert actual tuple TID to root TID */
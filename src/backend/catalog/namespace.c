@@ -70,6 +70,13 @@
 #ifdef _PG_ORCL_
 #include "catalog/catalog.h"
 #endif
+#ifdef __TBASE__
+#include "access/genam.h"
+#include "access/heapam.h"
+#include "catalog/indexing.h"
+#include "catalog/pg_depend.h"
+#include "utils/fmgroids.h"
+#endif
 
 /*
  * The namespace search path is a possibly-empty list of namespace OIDs.
@@ -3586,6 +3593,48 @@ GetTempNamespaceState(Oid *tempNamespaceId, Oid *tempToastNamespaceId)
     *tempToastNamespaceId = myTempToastNamespace;
 }
 
+#ifdef __TBASE__
+/*
+ * TempNamespaceHasObjects - does the session's temporary namespace hold
+ * anything at the moment?
+ *
+ * Every object created in a namespace records a dependency on it, so this is
+ * a single index probe on pg_depend. Objects dropped earlier in the current
+ * transaction are not counted.
+ */
+bool
+TempNamespaceHasObjects(void)
+{
+    Relation    depRel;
+    ScanKeyData key[2];
+    SysScanDesc scan;
+    bool        found;
+
+    if (!OidIsValid(myTempNamespace))
+        return false;
+
+    depRel = heap_open(DependRelationId, AccessShareLock);
+
+    ScanKeyInit(&key[0],
+                Anum_pg_depend_refclassid,
+                BTEqualStrategyNumber, F_OIDEQ,
+                ObjectIdGetDatum(NamespaceRelationId));
+    ScanKeyInit(&key[1],
+                Anum_pg_depend_refobjid,
+                BTEqualStrategyNumber, F_OIDEQ,
+                ObjectIdGetDatum(myTempNamespace));
+
+    scan = systable_beginscan(depRel, DependReferenceIndexId, true,
+                              NULL, 2, key);
+    found = HeapTupleIsValid(systable_getnext(scan));
+    systable_endscan(scan);
+
+    heap_close(depRel, AccessShareLock);
+
+    return found;
+}
+#endif
+
 /*
  * SetTempNamespaceState - set status of session's temporary namespace
  *
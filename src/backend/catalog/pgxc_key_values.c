@@ -83,6 +83,52 @@
 #include "catalog/pgxc_shard_map.h"
 #include "utils/lsyscache.h"
 #include "catalog/heap.h"
+#include "access/hash.h"
+#include "access/tuptoaster.h"
+#include "pgxc/locator.h"
+#include "utils/datum.h"
+#include "utils/hsearch.h"
+#include "utils/memutils.h"
+
+/*
+ * Backend cache of the key values of the relations, so routing a row probes
+ * a hash table with the binary value of the distribution column instead of
+ * printing it and looking the text up in the syscache.
+ *
+ * The values of a relation are loaded on first use, converted with the input
+ * function of the column type.  Adding key values invalidates the relcache
+ * entry of the relation, which drops its cached values; any change of
+ * pgxc_key_value drops them all.
+ */
+typedef struct KeyValueEntry
+{
+    Datum       value;
+    uint32      hash;
+    Oid         group;
+    Oid         coldgroup;
+    int         next;               /* next entry in the bucket, or -1 */
+} KeyValueEntry;
+
+typedef struct KeyValueRelCache
+{
+    Oid         relid;              /* hash key */
+    bool        valid;
+    Oid         type;
+    int16       typlen;
+    bool        typbyval;
+    int         nentries;
+    int         nbuckets;           /* a power of 2 */
+    int        *buckets;
+    KeyValueEntry *entries;
+} KeyValueRelCache;
+
+static HTAB          *KeyValueCacheHash = NULL;
+static MemoryContext  KeyValueCacheContext = NULL;
+
+static void InvalidateKeyValueCacheRel(Datum arg, Oid relid);
+static void InvalidateKeyValueCacheAll(Datum arg, int cacheid, uint32 hashvalue);
+static void LoadKeyValueRelCache(KeyValueRelCache *cache);
+static bool KeyValueEqual(KeyValueRelCache *cache, Datum a, Datum b);
 
 
 
@@ -614,3 +660,209 @@ bool IsKeyValues(Oid db, Oid rel, char *value)
                                   0);    
 }
 
+static void
+InvalidateKeyValueCacheRel(Datum arg, Oid relid)
+{
+    KeyValueRelCache *cache;
+
+    if (KeyValueCacheHash == NULL)
+        return;
+
+    if (!OidIsValid(relid))
+    {
+        InvalidateKeyValueCacheAll(arg, SHARDKEYVALUE, 0);
+        return;
+    }
+
+    cache = (KeyValueRelCache *) hash_search(KeyValueCacheHash, &relid, HASH_FIND, NULL);
+    if (cache != NULL)
+        cache->valid = false;
+}
+
+static void
+InvalidateKeyValueCacheAll(Datum arg, int cacheid, uint32 hashvalue)
+{
+    HASH_SEQ_STATUS status;
+    KeyValueRelCache *cache;
+
+    if (KeyValueCacheHash == NULL)
+        return;
+
+    hash_seq_init(&status, KeyValueCacheHash);
+    while ((cache = (KeyValueRelCache *) hash_seq_search(&status)) != NULL)
+        cache->valid = false;
+}
+
+static bool
+KeyValueEqual(KeyValueRelCache *cache, Datum a, Datum b)
+{
+    if (cache->typlen == -1)
+    {
+        struct varlena *va = (struct varlena *) DatumGetPointer(a);
+        struct varlena *vb = (struct varlena *) DatumGetPointer(b);
+        bool            result;
+
+        /* the probed value may be toasted or have a short header */
+        if (VARATT_IS_EXTENDED(vb))
+            vb = heap_tuple_untoast_attr(vb);
+
+        result = (VARSIZE_ANY_EXHDR(va) == VARSIZE_ANY_EXHDR(vb) &&
+                  memcmp(VARDATA_ANY(va), VARDATA_ANY(vb), VARSIZE_ANY_EXHDR(va)) == 0);
+
+        if ((Pointer) vb != DatumGetPointer(b))
+            pfree(vb);
+        return result;
+    }
+
+    return datumIsEqual(a, b, cache->typbyval, cache->typlen);
+}
+
+/*
+ * Read the key values of a relation from pgxc_key_value into its cache
+ * entry.  The entry must have its type set.
+ */
+static void
+LoadKeyValueRelCache(KeyValueRelCache *cache)
+{
+    Relation        kvrel;
+    SysScanDesc     scan;
+    ScanKeyData     skey[2];
+    HeapTuple       tup;
+    MemoryContext   oldcontext;
+    List           *tuples = NIL;
+    ListCell       *lc;
+    Oid             typinput;
+    Oid             typioparam;
+    int             i;
+
+    if (!cache->typbyval)
+    {
+        for (i = 0; i < cache->nentries; i++)
+            pfree(DatumGetPointer(cache->entries[i].value));
+    }
+    if (cache->entries)
+        pfree(cache->entries);
+    if (cache->buckets)
+        pfree(cache->buckets);
+    cache->entries = NULL;
+    cache->buckets = NULL;
+    cache->nentries = 0;
+
+    get_type_io_data(cache->type, IOFunc_input, &cache->typlen, &cache->typbyval,
+                     NULL, NULL, &typioparam, &typinput);
+
+    ScanKeyInit(&skey[0],
+                Anum_pgxc_key_valuew_db,
+                BTEqualStrategyNumber, F_OIDEQ,
+                ObjectIdGetDatum(MyDatabaseId));
+    ScanKeyInit(&skey[1],
+                Anum_pgxc_key_values_rel,
+                BTEqualStrategyNumber, F_OIDEQ,
+                ObjectIdGetDatum(cache->relid));
+
+    kvrel = heap_open(PgxcKeyValueRelationId, AccessShareLock);
+    scan = systable_beginscan(kvrel, PgxcShardKeyValuesIndexID, true,
+                              NULL, 2, skey);
+    while ((tup = systable_getnext(scan)) != NULL)
+        tuples = lappend(tuples, heap_copytuple(tup));
+    systable_endscan(scan);
+    heap_close(kvrel, AccessShareLock);
+
+    oldcontext = MemoryContextSwitchTo(KeyValueCacheContext);
+
+    for (cache->nbuckets = 16; cache->nbuckets < list_length(tuples) * 2; cache->nbuckets <<= 1)
+        ;
+    cache->buckets = (int *) palloc(sizeof(int) * cache->nbuckets);
+    for (i = 0; i < cache->nbuckets; i++)
+        cache->buckets[i] = -1;
+    cache->entries = (KeyValueEntry *) palloc(sizeof(KeyValueEntry) * Max(list_length(tuples), 1));
+
+    foreach(lc, tuples)
+    {
+        Form_pgxc_key_value keyvalue = (Form_pgxc_key_value) GETSTRUCT((HeapTuple) lfirst(lc));
+        KeyValueEntry      *entry = &cache->entries[cache->nentries];
+        int                 bucket;
+
+        entry->value = OidInputFunctionCall(typinput, NameStr(keyvalue->keyvalue),
+                                            typioparam, -1);
+        entry->hash = (uint32) compute_hash(cache->type, entry->value, LOCATOR_TYPE_SHARD);
+        entry->group = keyvalue->nodegroup;
+        entry->coldgroup = keyvalue->coldnodegroup;
+
+        bucket = entry->hash & (cache->nbuckets - 1);
+        entry->next = cache->buckets[bucket];
+        cache->buckets[bucket] = cache->nentries++;
+    }
+
+    MemoryContextSwitchTo(oldcontext);
+
+    list_free_deep(tuples);
+    cache->valid = true;
+}
+
+/*
+ * GetKeyValuesGroupByDatum
+ *
+ * Same as GetKeyValuesGroup, but takes the binary value of the distribution
+ * column of the given type.
+ */
+Oid GetKeyValuesGroupByDatum(Oid rel, Oid type, Datum value, Oid *coldgroup)
+{
+    KeyValueRelCache *cache;
+    bool              found;
+    uint32            hash;
+    int               i;
+
+    if (KeyValueCacheHash == NULL)
+    {
+        HASHCTL     ctl;
+
+        KeyValueCacheContext = AllocSetContextCreate(CacheMemoryContext,
+                                                     "key value routing cache",
+                                                     ALLOCSET_SMALL_SIZES);
+        MemSet(&ctl, 0, sizeof(ctl));
+        ctl.keysize = sizeof(Oid);
+        ctl.entrysize = sizeof(KeyValueRelCache);
+        ctl.hcxt = KeyValueCacheContext;
+        KeyValueCacheHash = hash_create("key value routing cache", 64, &ctl,
+                                        HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
+        CacheRegisterRelcacheCallback(InvalidateKeyValueCacheRel, (Datum) 0);
+        CacheRegisterSyscacheCallback(SHARDKEYVALUE, InvalidateKeyValueCacheAll, (Datum) 0);
+    }
+
+    cache = (KeyValueRelCache *) hash_search(KeyValueCacheHash, &rel, HASH_ENTER, &found);
+    if (!found)
+    {
+        cache->valid = false;
+        cache->entries = NULL;
+        cache->buckets = NULL;
+        cache->nentries = 0;
+        cache->type = InvalidOid;
+        cache->typbyval = true;
+    }
+
+    if (!cache->valid || cache->type != type)
+    {
+        cache->type = type;
+        LoadKeyValueRelCache(cache);
+    }
+
+    if (cache->nentries == 0)
+        return InvalidOid;
+
+    hash = (uint32) compute_hash(type, value, LOCATOR_TYPE_SHARD);
+    for (i = cache->buckets[hash & (cache->nbuckets - 1)]; i >= 0; i = cache->entries[i].next)
+    {
+        KeyValueEntry *entry = &cache->entries[i];
+
+        if (entry->hash == hash && KeyValueEqual(cache, entry->value, value))
+        {
+            if (coldgroup)
+                *coldgroup = entry->coldgroup;
+            return entry->group;
+        }
+    }
+
+    return InvalidOid;
+}
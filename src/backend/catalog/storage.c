@@ -91,6 +91,7 @@
 #ifdef _SHARDING_
 #include "commands/vacuum.h"
 #include "storage/extentmapping.h"
+#include "storage/extent_zonemap.h"
 #include "postmaster/bgwriter.h"
 #endif
 #include "storage/freespace.h"
@@ -335,6 +336,7 @@ RelationTruncate(Relation rel, BlockNumber nblocks)
         rel->rd_smgr->smgr_shard_targblocks[i] = InvalidBlockNumber;
     }
     //MemSet(rel->rd_smgr->smgr_shard_targblocks, 0, sizeof(rel->rd_smgr->smgr_shard_targblocks));
+    smgr_reset_freeext_hints(rel->rd_smgr);
 
     if(RelationHasExtent(rel))
         TruncateExtentMap(rel, nblocks);
@@ -466,7 +468,12 @@ smgrDoPendingDeletes(bool isCommit)
         smgrdounlinkall(srels, nrels, false);
 
         for (i = 0; i < nrels; i++)
+        {
+#ifdef _SHARDING_
+            ZoneMapForgetRelFileNode(srels[i]->smgr_rnode.node);
+#endif
             smgrclose(srels[i]);
+        }
 
         pfree(srels);
     }
@@ -793,7 +793,8 @@ CREATE VIEW pg_replication_slots AS
             L.xmin,
             L.catalog_xmin,
             L.restart_lsn,
-            L.confirmed_flush_lsn
+            L.confirmed_flush_lsn,
+            L.shard_skipped
     FROM pg_get_replication_slots() AS L
             LEFT JOIN pg_database D ON (L.datoid = D.oid);
 
@@ -867,6 +868,19 @@ CREATE VIEW pg_stat_archiver AS
         s.stats_reset
     FROM pg_stat_get_archiver() s;
 
+CREATE VIEW pg_stat_wal_flush AS
+    SELECT
+        s.insert_lock_waits,
+        s.flush_requests,
+        s.flush_grouped,
+        s.flush_wait_time,
+        s.syncs,
+        s.sync_time,
+        CASE WHEN s.syncs > 0
+             THEN s.flush_requests::float8 / s.syncs
+        END AS requests_per_sync
+    FROM pg_stat_get_wal_flush() s;
+
 CREATE VIEW pg_stat_bgwriter AS
     SELECT
         pg_stat_get_bgwriter_timed_checkpoints() AS checkpoints_timed,
@@ -899,6 +913,42 @@ CREATE VIEW pg_stat_progress_vacuum AS
     FROM pg_stat_get_progress_info('VACUUM') AS S
 		LEFT JOIN pg_database D ON S.datid = D.oid;
 
+CREATE VIEW pg_stat_progress_create_index AS
+	SELECT
+		S.pid AS pid, S.datid AS datid, D.datname AS datname,
+		S.relid AS relid,
+		S.param2 AS index_relid,
+		CASE S.param1 WHEN 0 THEN 'initializing'
+					  WHEN 1 THEN 'scanning heap'
+					  WHEN 2 THEN 'building index'
+					  WHEN 3 THEN 'validating index'
+					  END AS phase,
+		S.param3 AS heap_blks_total, S.param4 AS heap_blks_scanned,
+		S.param5 AS tuples_done
+    FROM pg_stat_get_progress_info('CREATE INDEX') AS S
+		LEFT JOIN pg_database D ON S.datid = D.oid;
+
+CREATE VIEW pg_stat_squeues AS
+    SELECT
+        S.squeue, S.producer_pid, S.producer_node, S.consumer_index,
+        S.consumer_node, S.consumer_pid, S.status, S.queued_rows,
+        S.rows, S.bytes, S.full_count, S.full_wait_us,
+        S.read_wait_us, S.spill_rows, S.spill_bytes, S.send_bytes,
+        S.send_blocked, S.send_errors
+    FROM pg_stat_get_squeues() AS S;
+
+CREATE VIEW pg_stat_squeue_nodes AS
+    SELECT
+        S.consumer_node, S.rows, S.bytes, S.full_count,
+        S.full_wait_us, S.read_wait_us, S.spill_rows, S.spill_bytes,
+        S.send_bytes, S.send_blocked, S.send_errors
+    FROM pg_stat_get_squeue_nodes() AS S;
+
+CREATE VIEW pg_stat_shard_io AS
+    SELECT
+        S.node_name, S.shard_id, S.blks_read, S.blks_hit, S.blks_written
+    FROM tbase_shard_io_statistic() AS S;
+
 CREATE VIEW pg_user_mappings AS
     SELECT
         U.oid       AS umid,
@@ -1084,6 +1134,36 @@ LANGUAGE SQL STRICT STABLE PARALLEL SAFE;
 COMMENT ON FUNCTION ts_debug(text) IS
     'debug function for current text search configuration';
 
+--
+-- Shard move advisor. Ranks the shards of this datanode by buffer accesses
+-- and returns the hottest ones until they make up the requested share of
+-- all accesses, which is the set worth moving to offload the node.
+--
+
+CREATE FUNCTION tbase_shard_move_advice(IN load_share float8 DEFAULT 0.5,
+    OUT shard_id int4,
+    OUT accesses int8,
+    OUT blks_read int8,
+    OUT cumulative_share float8)
+RETURNS SETOF record AS
+$$
+SELECT s.shard_id, s.accesses, s.blks_read, s.running / s.total
+FROM (SELECT io.shard_id,
+             io.blks_read + io.blks_hit + io.blks_written AS accesses,
+             io.blks_read,
+             (sum(io.blks_read + io.blks_hit + io.blks_written)
+                 OVER (ORDER BY io.blks_read + io.blks_hit + io.blks_written DESC,
+                       io.shard_id))::float8 AS running,
+             (sum(io.blks_read + io.blks_hit + io.blks_written) OVER ())::float8 AS total
+      FROM pg_catalog.pg_stat_shard_io AS io) AS s
+WHERE s.total > 0 AND s.running - s.accesses < $1 * s.total
+ORDER BY s.accesses DESC, s.shard_id
+$$
+LANGUAGE SQL STRICT VOLATILE;
+
+COMMENT ON FUNCTION tbase_shard_move_advice(float8) IS
+    'shards of this datanode to move to offload the given share of buffer accesses';
+
 --
 -- Redeclare built-in functions that need default values attached to their
 -- arguments.  It's impractical to set those up directly in pg_proc.h because
@@ -37,6 +37,7 @@
 #include "commands/vacuum.h"
 #include "executor/executor.h"
 #include "foreign/fdwapi.h"
+#include "lib/binaryheap.h"
 #include "miscadmin.h"
 #include "nodes/nodeFuncs.h"
 #include "parser/parse_oper.h"
@@ -101,6 +102,9 @@ int            default_statistics_target = 100;
 /* enable calculate coordinator statistics by sampling rows from data node */
 bool		enable_sampling_analyze = true;
 
+/* skip interval partitions not modified since their last analyze */
+bool		interval_incremental_analyze = true;
+
 /* enable collecting distributed query info */
 bool        distributed_query_analyze = false;
 
@@ -148,6 +152,7 @@ extern bool random_collect_stats;
 #endif
 
 #ifdef __TBASE__
+static bool interval_partition_is_analyzed(Oid relid);
 static void get_rel_pages_visiblepages(Relation onerel, 
 						   BlockNumber *pages, 
 						   BlockNumber *visiblepages);
@@ -185,6 +190,21 @@ analyze_rel(Oid relid, RangeVar *relation, int options,
             foreach(lc, childs)
             {
                 child = lfirst_oid(lc);
+
+                /*
+                 * Old interval partitions rarely change.  Their statistics
+                 * are still good, and the parent samples them directly, so
+                 * only analyze the ones written since.
+                 */
+                if (interval_incremental_analyze && va_cols == NIL &&
+                    interval_partition_is_analyzed(child))
+                {
+                    ereport((options & VACOPT_VERBOSE) ? INFO : DEBUG2,
+                            (errmsg("skipping analyze of \"%s\" --- not modified since last analyze",
+                                    get_rel_name(child))));
+                    continue;
+                }
+
                 analyze_rel(child, relation, options, params, va_cols, in_outer_xact,
                             bstrategy);
             }
@@ -399,6 +419,33 @@ analyze_rel(Oid relid, RangeVar *relation, int options,
     LWLockRelease(ProcArrayLock);
 }
 
+#ifdef __TBASE__
+/*
+ * interval_partition_is_analyzed
+ *        Has the partition been analyzed, with no rows changed since?
+ *
+ * Only datanodes know; the modifications are counted where the rows are.
+ * Coordinators always analyze, which costs them just fetching the stats.
+ * The counters are lost in a crash, so we err on the side of analyzing.
+ */
+static bool
+interval_partition_is_analyzed(Oid relid)
+{
+    PgStat_StatTabEntry *tabentry;
+
+    if (!IS_PGXC_DATANODE)
+        return false;
+
+    tabentry = pgstat_fetch_stat_tabentry(relid);
+    if (tabentry == NULL)
+        return false;
+
+    return tabentry->changes_since_analyze == 0 &&
+        (tabentry->analyze_timestamp != 0 ||
+         tabentry->autovac_analyze_timestamp != 0);
+}
+#endif
+
 /*
  *    do_analyze_rel() -- analyze one relation, recursively or not
  *
@@ -5027,10 +5074,15 @@ void ExecSample(SampleStmt *stmt, DestReceiver *dest)
 	
 	if (context->samplenum > 0)
 	{
+		/*
+		 * Every row carries the sample and relation size of this node, so
+		 * that the coordinator can weight it while merging the samples of
+		 * all nodes.
+		 */
 		for (index = 0; index < context->samplenum; index++)
 		{
-			nulls[0] = true;
-			nulls[1] = true;
+			nulls[0] = false;
+			nulls[1] = false;
 			nulls[2] = true;
 			nulls[3] = true;
 			nulls[4] = true;
@@ -5051,6 +5103,25 @@ void ExecSample(SampleStmt *stmt, DestReceiver *dest)
 
 }
 
+/*
+ * Orders sample row indexes by their key, smallest first; arg is the array
+ * of keys.
+ */
+static int
+sample_key_comparator(Datum a, Datum b, void *arg)
+{
+	double	   *keys = (double *) arg;
+	double		ka = keys[DatumGetInt32(a)];
+	double		kb = keys[DatumGetInt32(b)];
+
+	/* binaryheap keeps the largest element on top, so invert */
+	if (ka < kb)
+		return 1;
+	if (ka > kb)
+		return -1;
+	return 0;
+}
+
 static int 
 acquire_coordinator_sample_rows(Relation onerel, int elevel,
 												HeapTuple *rows, int targrows,
@@ -5073,11 +5144,11 @@ acquire_coordinator_sample_rows(Relation onerel, int elevel,
 	double			totalnum = 0;
 	double			deadnum = 0;
 	int				numrows = 0;
-	double			samplerows = 0;
-	double			rowstoskip = -1;	/* -1 means not set yet */
 	ReservoirStateData rstate;
 	int64			totalpagesnum = 0;
 	int64			visiblepagesnum = 0;
+	double		   *keys;
+	binaryheap	   *heap;
 
 	/* Get the relation identifier */
 	relname = RelationGetRelationName(onerel);
@@ -5146,15 +5217,77 @@ acquire_coordinator_sample_rows(Relation onerel, int elevel,
 	node = ExecInitRemoteQuery(step, estate, 0);
 	MemoryContextSwitchTo(oldcontext);
 
-	/* Prepare for sampling rows */
+	/*
+	 * Prepare for sampling rows.  Every node sends a uniform sample of its
+	 * own rows, but the nodes hold different numbers of rows, so simply
+	 * pooling the samples would over-represent the small nodes.  Instead we
+	 * run a weighted reservoir (Efraimidis and Spirakis' A-Res) over the
+	 * arriving rows, a row standing for totalnum / samplenum rows of its
+	 * node: each gets the key u^(1/weight) for a random u, and we keep the
+	 * targrows rows with the largest keys, in a heap with the smallest key
+	 * on top.  The samples of all nodes are taken concurrently, and rows are
+	 * merged as they come in, whichever node they are from.
+	 */
 	reservoir_init_selection_state(&rstate, targrows);
+	keys = (double *) palloc(targrows * sizeof(double));
+	heap = binaryheap_allocate(targrows, sample_key_comparator, keys);
 
 	result = ExecRemoteQuery((PlanState *) node);
 	
 	while (result != NULL && !TupIsNull(result))
 	{
 		slot_getallattrs(result);
-		
+
+		if (result->tts_isnull[5] == false)
+		{
+			HeapTupleHeader td = DatumGetHeapTupleHeader(result->tts_values[5]);
+			HeapTupleData tmptup;
+			double		weight = 1.0;
+			double		key;
+
+			/* older datanodes don't send the size of their sample along */
+			if (result->tts_isnull[0] == false &&
+				result->tts_isnull[1] == false &&
+				DatumGetFloat8(result->tts_values[0]) > 0 &&
+				DatumGetFloat8(result->tts_values[1]) > 0)
+				weight = DatumGetFloat8(result->tts_values[1]) /
+					DatumGetFloat8(result->tts_values[0]);
+
+			/* compare the keys by their logarithm, log(u) / weight */
+			key = log(sampler_random_fract(rstate.randstate)) / weight;
+
+			/* Build a temporary HeapTuple control structure */
+			tmptup.t_len = HeapTupleHeaderGetDatumLength(td);
+			ItemPointerSetInvalid(&(tmptup.t_self));
+			tmptup.t_tableOid = InvalidOid;
+			tmptup.t_data = td;
+
+			if (numrows < targrows)
+			{
+				rows[numrows] = heap_copytuple(&tmptup);
+				keys[numrows] = key;
+				binaryheap_add(heap, Int32GetDatum(numrows));
+				numrows++;
+			}
+			else
+			{
+				int			k = DatumGetInt32(binaryheap_first(heap));
+
+				if (key > keys[k])
+				{
+					/* replace the row with the smallest key */
+					heap_freetuple(rows[k]);
+					rows[k] = heap_copytuple(&tmptup);
+					keys[k] = key;
+					binaryheap_replace_first(heap, Int32GetDatum(k));
+				}
+			}
+
+			result = ExecRemoteQuery((PlanState *) node);
+			continue;
+		}
+
+		/* the first row of each node reports the node's totals */
 		if (result->tts_isnull[0] == false)
 		{
 			samplenum += DatumGetFloat8(result->tts_values[0]);
@@ -5180,62 +5313,13 @@ acquire_coordinator_sample_rows(Relation onerel, int elevel,
 			visiblepagesnum += DatumGetInt64(result->tts_values[4]);
 		}
 
-		if (result->tts_isnull[5] == false)
-		{
-			if (numrows < targrows)
-			{
-				HeapTupleHeader td = DatumGetHeapTupleHeader(result->tts_values[5]);
-				HeapTupleData tmptup;
-
-				/* Build a temporary HeapTuple control structure */
-				tmptup.t_len = HeapTupleHeaderGetDatumLength(td);
-				ItemPointerSetInvalid(&(tmptup.t_self));
-				tmptup.t_tableOid = InvalidOid;
-				tmptup.t_data = td;
-
-				/* Build a copy and return it */
-				rows[numrows++] = heap_copytuple(&tmptup);
-			}
-			else
-			{
-				/*
-					* t in Vitter's paper is the number of records already
-					* processed.  If we need to compute a new S value, we
-					* must use the not-yet-incremented value of samplerows as
-					* t.
-					*/
-				if (rowstoskip < 0)
-					rowstoskip = reservoir_get_next_S(&rstate, samplerows, targrows);
-
-				if (rowstoskip <= 0)
-				{
-					/*
-						* Found a suitable tuple, so save it, replacing one
-						* old tuple at random
-						*/
-					int			k = (int) (targrows * sampler_random_fract(rstate.randstate));
-					HeapTupleHeader td = DatumGetHeapTupleHeader(result->tts_values[5]);
-					HeapTupleData tmptup;
-
-					/* Build a temporary HeapTuple control structure */
-					tmptup.t_len = HeapTupleHeaderGetDatumLength(td);
-					ItemPointerSetInvalid(&(tmptup.t_self));
-					tmptup.t_tableOid = InvalidOid;
-					tmptup.t_data = td;
-					Assert(k >= 0 && k < targrows);
-					heap_freetuple(rows[k]);
-					rows[k] = heap_copytuple(&tmptup);
-				}
-
-				rowstoskip -= 1;
-			}
-			samplerows += 1;
-		}
-		
 		result = ExecRemoteQuery((PlanState *) node);
 	}
 
 	ExecEndRemoteQuery(node);
+
+	binaryheap_free(heap);
+	pfree(keys);
 	
 	*totalrows = totalnum;
 	*totaldeadrows = deadnum;
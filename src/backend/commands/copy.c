@@ -85,6 +85,11 @@
 #ifdef __COLD_HOT__
 #include "pgxc/shardmap.h"
 #endif
+#ifdef _SHARDING_
+#include "access/relscan.h"
+#include "storage/extentmapping.h"
+#include "utils/timestamp.h"
+#endif
 
 #define ISOCTAL(c) (((c) >= '0') && ((c) <= '7'))
 #define OCTVALUE(c) ((c) - '0')
@@ -260,6 +265,12 @@ typedef struct CopyStateData
 
 #ifdef _SHARDING_
     Bitmapset * shard_array;
+    ExtentID   *shard_extents;        /* extents of shard_array in the relation
+                                     * being scanned, NULL to scan it all */
+    int            shard_nextents;
+    int            shard_nextextent;    /* next shard_extents entry to read */
+    uint64        shard_copy_bytes;    /* sent since shard_copy_start */
+    TimestampTz shard_copy_start;
 #endif
 #ifdef __TBASE__
     Relation    *partrels;
@@ -416,6 +427,17 @@ static bool CopyGetInt16(CopyState cstate, int16 *val);
 static RemoteCopyOptions *GetRemoteCopyOptions(CopyState cstate);
 static void append_defvals(Datum *values, CopyState cstate);
 #endif
+#ifdef _SHARDING_
+/* COPY ... SHARDING TO throughput limit in kB per second, 0 for none */
+int            shard_copy_rate_limit = 0;
+
+/* bytes copied between two checks of the rate */
+#define SHARD_COPY_THROTTLE_BYTES    (64 * 1024)
+
+static void CopyShardScanBegin(CopyState cstate, HeapScanDesc scan);
+static HeapTuple CopyShardGetNext(CopyState cstate, HeapScanDesc scan);
+static void CopyShardThrottle(CopyState cstate, Size len);
+#endif
 
 /*
  * Send copy start/stop messages for frontend copies.  These have changed
@@ -1981,6 +2003,29 @@ BeginCopy(ParseState *pstate,
             cstate->convert_select_flags[attnum - 1] = true;
         }
     }
+#ifdef __TBASE__
+    /*
+     * A coordinator only needs the distribution columns to route a line to
+     * its datanode, which converts the whole line again anyway. So convert
+     * just those and ship the raw line. Bad values in other columns are then
+     * reported by the datanode, which is why silent mode keeps the full
+     * conversion.
+     */
+    else if (is_from && g_enable_copy_fast_route && IS_PGXC_COORDINATOR &&
+             !cstate->binary && !cstate->insert_into && !g_enable_copy_silence &&
+             cstate->remoteCopyState && cstate->remoteCopyState->rel_loc)
+    {
+        RelationLocInfo *rel_loc = cstate->remoteCopyState->rel_loc;
+
+        cstate->convert_select_flags = (bool *) palloc0(num_phys_attrs * sizeof(bool));
+        if (AttributeNumberIsValid(rel_loc->partAttrNum))
+            cstate->convert_select_flags[rel_loc->partAttrNum - 1] = true;
+#ifdef __COLD_HOT__
+        if (AttributeNumberIsValid(rel_loc->secAttrNum))
+            cstate->convert_select_flags[rel_loc->secAttrNum - 1] = true;
+#endif
+    }
+#endif
 
     /* Use client encoding when ENCODING option is not specified. */
     if (cstate->file_encoding < 0)
@@ -2497,7 +2542,12 @@ CopyTo(CopyState cstate)
             for(i = 0; i < cstate->nparts; i++)
             {
                 scandesc = heap_beginscan(cstate->partrels[i], GetActiveSnapshot(), 0, NULL);
+#ifdef _SHARDING_
+                CopyShardScanBegin(cstate, scandesc);
+                while ((tuple = CopyShardGetNext(cstate, scandesc)) != NULL)
+#else
                 while ((tuple = heap_getnext(scandesc, ForwardScanDirection)) != NULL)
+#endif
                 {
                     bool isdeformed = false;
                     CHECK_FOR_INTERRUPTS();
@@ -2611,6 +2661,9 @@ CopyTo(CopyState cstate)
                     /* Format and send the data */
                     CopyOneRowTo(cstate, HeapTupleGetOid(tuple), values, nulls);
                     processed++;
+#ifdef _SHARDING_
+                    CopyShardThrottle(cstate, tuple->t_len);
+#endif
                 }
                 heap_endscan(scandesc);
                 scandesc = NULL;
@@ -2631,7 +2684,12 @@ CopyTo(CopyState cstate)
         scandesc = heap_beginscan(cstate->rel, GetActiveSnapshot(), 0, NULL);
 
         processed = 0;
+#ifdef _SHARDING_
+        CopyShardScanBegin(cstate, scandesc);
+        while ((tuple = CopyShardGetNext(cstate, scandesc)) != NULL)
+#else
         while ((tuple = heap_getnext(scandesc, ForwardScanDirection)) != NULL)
+#endif
         {
             CHECK_FOR_INTERRUPTS();
 #ifdef _MLS_
@@ -2714,6 +2772,9 @@ CopyTo(CopyState cstate)
             /* Format and send the data */
             CopyOneRowTo(cstate, HeapTupleGetOid(tuple), values, nulls);
             processed++;
+#ifdef _SHARDING_
+            CopyShardThrottle(cstate, tuple->t_len);
+#endif
         }
 
         heap_endscan(scandesc);
@@ -2762,6 +2823,94 @@ CopyTo(CopyState cstate)
     return processed;
 }
 
+#ifdef _SHARDING_
+/*
+ * CopyShardScanBegin
+ *
+ * For COPY ... SHARDING TO of a table organized in extents, read just the
+ * extents on the scan lists of the requested shards rather than the whole
+ * relation. Extents added to the lists after the snapshot only carry tuples
+ * the snapshot can not see, so missing them is fine.
+ */
+static void
+CopyShardScanBegin(CopyState cstate, HeapScanDesc scan)
+{
+    if (cstate->shard_extents)
+        pfree(cstate->shard_extents);
+    cstate->shard_extents = NULL;
+    cstate->shard_nextents = 0;
+    cstate->shard_nextextent = 0;
+    cstate->shard_copy_bytes = 0;
+    cstate->shard_copy_start = GetCurrentTimestamp();
+
+    if (cstate->shard_array == NULL || !RelationHasExtent(scan->rs_rd))
+        return;
+
+    cstate->shard_extents = GetShardsScanExtents(scan->rs_rd, cstate->shard_array,
+                                                 &cstate->shard_nextents);
+
+    /* start out empty, CopyShardGetNext moves on to the first extent */
+    if (cstate->shard_extents)
+        heap_setscanlimits(scan, 0, 0);
+}
+
+static HeapTuple
+CopyShardGetNext(CopyState cstate, HeapScanDesc scan)
+{
+    HeapTuple    tuple;
+
+    for (;;)
+    {
+        tuple = heap_getnext(scan, ForwardScanDirection);
+        if (tuple != NULL || cstate->shard_extents == NULL)
+            return tuple;
+        if (cstate->shard_nextextent >= cstate->shard_nextents)
+            return NULL;
+        (void) heap_setscanextent(scan,
+                                  cstate->shard_extents[cstate->shard_nextextent++]);
+    }
+}
+
+/*
+ * Hold COPY ... SHARDING TO to shard_copy_rate_limit, so that moving shards
+ * away does not starve the foreground work of the node of I/O and network.
+ */
+static void
+CopyShardThrottle(CopyState cstate, Size len)
+{
+    long        secs;
+    int            usecs;
+    int64        elapsed;
+    int64        expected;
+
+    if (shard_copy_rate_limit <= 0 || cstate->shard_array == NULL)
+        return;
+
+    cstate->shard_copy_bytes += len;
+    if (cstate->shard_copy_bytes < SHARD_COPY_THROTTLE_BYTES)
+        return;
+
+    TimestampDifference(cstate->shard_copy_start, GetCurrentTimestamp(),
+                        &secs, &usecs);
+    elapsed = (int64) secs * USECS_PER_SEC + usecs;
+    expected = (int64) (cstate->shard_copy_bytes * USECS_PER_SEC /
+                        ((uint64) shard_copy_rate_limit * 1024));
+
+    /* sleep in slices, so a cancel does not wait for the whole of it */
+    while (expected > elapsed)
+    {
+        int64        naptime = Min(expected - elapsed, USECS_PER_SEC);
+
+        pg_usleep(naptime);
+        elapsed += naptime;
+        CHECK_FOR_INTERRUPTS();
+    }
+
+    cstate->shard_copy_bytes = 0;
+    cstate->shard_copy_start = GetCurrentTimestamp();
+}
+#endif
+
 /*
  * Emit one row during CopyTo().
  */
@@ -71,6 +71,9 @@
 #ifdef __TBASE__
 #include "commands/sequence.h"
 #endif
+#ifdef _SHARDING_
+#include "storage/extent_zonemap.h"
+#endif
 
 typedef struct
 {
@@ -977,6 +980,9 @@ dropdb(const char *dbname, bool missing_ok)
      * dirty buffer to the dead database later...
      */
     DropDatabaseBuffers(db_id);
+#ifdef _SHARDING_
+    ZoneMapForgetDatabase(db_id);
+#endif
 
     /*
      * Tell the stats collector to forget it immediately, too.
@@ -1031,6 +1037,9 @@ dropdb(const char *dbname, bool missing_ok)
 #endif
     }
 #endif
+#ifdef __TBASE__
+    SharedSeqCacheInvalidate(db_id, InvalidOid);
+#endif
 }
 
 
@@ -3982,6 +3982,10 @@ ExplainRemoteQuery(RemoteQuery *plan, PlanState *planstate, List *ancestors, Exp
             }
             ExplainPropertyText("Node/s", node_names->data, es);
         }
+#ifdef __COLD_HOT__
+        if (en->cold_pruned > 0)
+            ExplainPropertyInteger("Cold nodes pruned", en->cold_pruned, es);
+#endif
     }
 
 	/*
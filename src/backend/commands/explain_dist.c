@@ -21,7 +21,9 @@
 #include "libpq/pqformat.h"
 #include "nodes/nodeFuncs.h"
 #include "utils/lsyscache.h"
+#include "utils/memutils.h"
 #include "utils/tuplesort.h"
+#include "utils/tuplestore.h"
 
 /* Read instrument field */
 #define INSTR_READ_FIELD(fldname)                \
@@ -58,13 +60,15 @@ typedef struct
  * InstrOut
  *
  * Serialize Instrumentation structure with the format
- * "nodetype-plan_node_id-node_oid{val,val,...,val}".
+ * "nodetype-plan_node_id-node_oid{val,val,...,val}". The last value is the
+ * workspace memory of the node.
  *
  * NOTE: The function should be modified if the structure of Instrumentation
  * or its relevant members has been changed.
  */
 static void
-InstrOut(StringInfo buf, Plan *plan, Instrumentation *instr, int current_node_id)
+InstrOut(StringInfo buf, Plan *plan, Instrumentation *instr, int current_node_id,
+         Size memory)
 {
 	/* nodeTag for varify */
 	appendStringInfo(buf, "%hd-%d-%d{", nodeTag(plan), plan->plan_node_id, current_node_id);
@@ -120,7 +124,9 @@ InstrOut(StringInfo buf, Plan *plan, Instrumentation *instr, int current_node_id
 	appendStringInfo(buf, "%ld,", instr->bufusage.blk_read_time.tv_sec);
 	appendStringInfo(buf, "%ld,", instr->bufusage.blk_read_time.tv_nsec);
 	appendStringInfo(buf, "%ld,", instr->bufusage.blk_write_time.tv_sec);
-	appendStringInfo(buf, "%ld}", instr->bufusage.blk_write_time.tv_nsec);
+	appendStringInfo(buf, "%ld,", instr->bufusage.blk_write_time.tv_nsec);
+	/* Size */
+	appendStringInfo(buf, "%zu}", memory);
 	
 	elog(DEBUG1, "InstrOut: plan_node_id %d, node %d, nloops %.0f", plan->plan_node_id, current_node_id, instr->nloops);
 }
@@ -379,6 +385,9 @@ InstrIn(StringInfo str, RemoteInstr *rinstr)
 	INSTR_READ_FIELD(bufusage.blk_write_time.tv_sec);
 	INSTR_READ_FIELD(bufusage.blk_write_time.tv_nsec);
 	
+	rinstr->memory = (Size) strtoul(tmp_head, &tmp_pos, 10);
+	tmp_head = tmp_pos + 1;
+	
 	elog(DEBUG1, "InstrIn: plan_node_id %d, node %d, nloops %.0f", rinstr->key.plan_node_id, rinstr->key.node_id, instr->nloops);
 	
 	/* tmp_head points to next instrument's nodetype or '\0' already */
@@ -459,6 +468,71 @@ SpecInstrIn(StringInfo str, RemoteInstr *instr)
 	str->cursor = tmp_head - &str->data[0];
 }
 
+/*
+ * PlanStateMemory
+ *
+ * Workspace memory in bytes held by the sorts, hash tables and tuplestores
+ * of a plan node. Sorts which went to disk used all the memory they were
+ * allowed before spilling.
+ */
+static Size
+PlanStateMemory(PlanState *planstate)
+{
+	switch (nodeTag(planstate))
+	{
+		case T_SortState:
+		{
+			SortState *sortstate = (SortState *) planstate;
+			TuplesortInstrumentation stats;
+			
+			if (sortstate->sort_Done && sortstate->tuplesortstate)
+				tuplesort_get_stats((Tuplesortstate *) sortstate->tuplesortstate, &stats);
+			else if (sortstate->instrument.sortMethod != -1)
+				stats = sortstate->instrument;
+			else
+				return 0;
+			
+			if (stats.spaceType == SORT_SPACE_TYPE_MEMORY)
+				return (Size) stats.spaceUsed * 1024;
+			return (Size) ExecWorkMem(planstate->state) * 1024;
+		}
+		case T_HashState:
+		{
+			HashState *hashstate = (HashState *) planstate;
+			
+			if (hashstate->hashtable)
+				return hashstate->hashtable->spacePeak;
+			return 0;
+		}
+		case T_MaterialState:
+		{
+			MaterialState *matstate = (MaterialState *) planstate;
+			
+			if (matstate->tuplestorestate)
+				return (Size) tuplestore_space_peak(matstate->tuplestorestate);
+			return 0;
+		}
+		case T_WindowAggState:
+		{
+			WindowAggState *winstate = (WindowAggState *) planstate;
+			
+			if (winstate->buffer)
+				return (Size) tuplestore_space_peak(winstate->buffer);
+			return 0;
+		}
+		case T_AggState:
+		{
+			AggState *aggstate = (AggState *) planstate;
+			
+			if (aggstate->hashcontext)
+				return MemoryContextTotalSpace(aggstate->hashcontext->ecxt_per_tuple_memory);
+			return 0;
+		}
+		default:
+			return 0;
+	}
+}
+
 /*
  * SerializeLocalInstr
  *
@@ -498,7 +572,8 @@ SerializeLocalInstr(PlanState *planstate, SerializeState *ss)
 				/* instrument valid only if node_oid set */
 				if (node_id != 0)
 				{
-					InstrOut(&ss->buf, planstate->plan, instrument, node_id);
+					InstrOut(&ss->buf, planstate->plan, instrument, node_id,
+					         planstate->dn_instrument->instrument[n].memory);
 					SpecInstrOut(&ss->buf, nodeTag(planstate->plan), planstate);
 				}
 				else
@@ -510,7 +585,8 @@ SerializeLocalInstr(PlanState *planstate, SerializeState *ss)
 		else
 		{
 			/* send our own instr */
-			InstrOut(&ss->buf, planstate->plan, planstate->instrument, 0);
+			InstrOut(&ss->buf, planstate->plan, planstate->instrument, 0,
+			         PlanStateMemory(planstate));
 			SpecInstrOut(&ss->buf, nodeTag(planstate->plan), planstate);
 		}
 	}
@@ -692,6 +768,8 @@ combineRemoteInstr(RemoteInstr *rtarget, RemoteInstr *rsrc)
 	INSTR_MAX_FIELD(bufusage.blk_write_time.tv_sec);
 	INSTR_MAX_FIELD(bufusage.blk_write_time.tv_nsec);
 	
+	rtarget->memory = Max(rtarget->memory, rsrc->memory);
+	
 	combineSpecRemoteInstr(rtarget, rsrc);
 }
 
@@ -913,6 +991,7 @@ AttachRemoteInstr(PlanState *planstate, AttachRemoteInstrContext *ctx)
 				elog(DEBUG1, "instr attach plan_node_id %d node %d index %d", plan_node_id, key.node_id, n);
 				planstate->dn_instrument->instrument[n].nodeid = key.node_id;
 				memcpy(&planstate->dn_instrument->instrument[n].instr, &rinstr->instr, sizeof(Instrumentation));
+				planstate->dn_instrument->instrument[n].memory = rinstr->memory;
 				/* TODO attach all nodes' remote specific instr */
 				rinstr_final.nodeTag = rinstr->nodeTag;
 				rinstr_final.key = rinstr->key;
@@ -956,6 +1035,11 @@ ExplainCommonRemoteInstr(PlanState *planstate, ExplainState *es)
 	double startup_sec_min, startup_sec_max, startup_sec;
 	double total_sec_min, total_sec_max, total_sec;
 	double rows_min, rows_max, rows;
+	/* for avg display, over the nodes that executed */
+	double total_sec_sum = 0, rows_sum = 0;
+	int    nexecuted = 0;
+	/* workspace memory in kB, summed up over the nodes that executed */
+	long   mem_min = 0, mem_max = 0, mem_sum = 0;
 	/* for verbose */
 	StringInfoData buf;
 	
@@ -1007,6 +1091,20 @@ ExplainCommonRemoteInstr(PlanState *planstate, ExplainState *es)
 		SET_MIN_MAX(total_sec_min, total_sec_max, total_sec);
 		SET_MIN_MAX(rows_min, rows_max, rows);
 		
+		if (nloops > 0)
+		{
+			long mem = (long) ((rinstr[i].memory + 1023) / 1024);
+			
+			if (nexecuted == 0 || mem < mem_min)
+				mem_min = mem;
+			mem_max = Max(mem_max, mem);
+			mem_sum += mem;
+			
+			total_sec_sum += total_sec;
+			rows_sum += rows;
+			nexecuted++;
+		}
+		
 		/* one line for each dn if verbose */
 		if (es->verbose)
 		{
@@ -1065,6 +1163,11 @@ ExplainCommonRemoteInstr(PlanState *planstate, ExplainState *es)
 				appendStringInfo(es->str,
 				                 "DN (actual rows=%.0f..%.0f loops=%.0f..%.0f)",
 				                 rows_min, rows_max, nloops_min, nloops_max);
+			
+			/* memory varies between runs like the timings, show them together */
+			if (es->timing && mem_max > 0)
+				appendStringInfo(es->str, "  Memory: %ldkB..%ldkB  Total Memory: %ldkB",
+				                 mem_min, mem_max, mem_sum);
 		}
 		
 		if (es->verbose)
@@ -1083,10 +1186,28 @@ ExplainCommonRemoteInstr(PlanState *planstate, ExplainState *es)
 			ExplainPropertyFloat("Actual Max Startup Time", startup_sec_max, 3, es);
 			ExplainPropertyFloat("Actual Min Total Time", total_sec_min, 3, es);
 			ExplainPropertyFloat("Actual Max Total Time", total_sec_max, 3, es);
+			if (nexecuted > 0)
+				ExplainPropertyFloat("Actual Avg Total Time",
+				                     total_sec_sum / nexecuted, 3, es);
 		}
 		ExplainPropertyFloat("Actual Min Rows", rows_min, 0, es);
 		ExplainPropertyFloat("Actual Max Rows", rows_max, 0, es);
+		if (nexecuted > 0)
+		{
+			double rows_avg = rows_sum / nexecuted;
+
+			ExplainPropertyFloat("Actual Avg Rows", rows_avg, 0, es);
+			/* max over avg, 1.0 means evenly spread across datanodes */
+			ExplainPropertyFloat("Rows Skew",
+			                     rows_avg > 0 ? rows_max / rows_avg : 1.0, 2, es);
+		}
 		ExplainPropertyFloat("Actual Min Loops", nloops_min, 0, es);
 		ExplainPropertyFloat("Actual Max Loops", nloops_max, 0, es);
+		if (mem_max > 0)
+		{
+			ExplainPropertyLong("Min Memory", mem_min, es);
+			ExplainPropertyLong("Max Memory", mem_max, es);
+			ExplainPropertyLong("Total Memory", mem_sum, es);
+		}
 	}
 }
@@ -33,6 +33,7 @@
 #include "commands/comment.h"
 #include "commands/dbcommands.h"
 #include "commands/defrem.h"
+#include "commands/progress.h"
 #include "commands/tablecmds.h"
 #include "commands/tablespace.h"
 #include "mb/pg_wchar.h"
@@ -46,6 +47,7 @@
 #include "parser/parse_oper.h"
 #ifdef PGXC
 #include "parser/parse_utilcmd.h"
+#include "pgstat.h"
 #include "pgxc/pgxc.h"
 #endif
 #include "storage/lmgr.h"
@@ -381,6 +383,8 @@ DefineIndex(Oid relationId,
     relationId = RelationGetRelid(rel);
     namespaceId = RelationGetNamespace(rel);
 
+    pgstat_progress_start_command(PROGRESS_COMMAND_CREATE_INDEX, relationId);
+
     if (rel->rd_rel->relkind != RELKIND_RELATION &&
         rel->rd_rel->relkind != RELKIND_MATVIEW)
     {
@@ -755,6 +759,7 @@ DefineIndex(Oid relationId,
     if (!OidIsValid(indexRelationId))
     {
         heap_close(rel, NoLock);
+        pgstat_progress_end_command();
         return address;
     }
 
@@ -767,6 +772,7 @@ DefineIndex(Oid relationId,
     {
         /* Close the heap and we're done, in the non-concurrent case */
         heap_close(rel, NoLock);
+        pgstat_progress_end_command();
         return address;
     }
 
@@ -1022,6 +1028,8 @@ DefineIndex(Oid relationId,
      */
     UnlockRelationIdForSession(&heaprelid, ShareUpdateExclusiveLock);
 
+    pgstat_progress_end_command();
+
     return address;
 }
 
@@ -76,6 +76,9 @@
 
 int            SequenceRangeVal = 1;
 #endif
+#ifdef __TBASE__
+int            shared_sequence_cache_size = 0;
+#endif
 
 typedef struct sequence_magic
 {
@@ -138,6 +141,11 @@ static SeqTableData *last_used_seq = NULL;
 
 static void fill_seq_with_data(Relation rel, HeapTuple tuple);
 static Relation lock_and_open_sequence(SeqTable seq);
+#ifdef __TBASE__
+static bool SharedSeqCacheUsable(Relation seqrel);
+static bool SharedSeqCacheNext(Oid relid, int64 incby, int64 *result);
+static bool SharedSeqCacheStore(Oid relid, int64 incby, int64 last, int64 cached);
+#endif
 static void create_seq_hashtable(void);
 static void init_sequence(Oid relid, SeqTable *p_elm, Relation *p_rel);
 static Form_pg_sequence_data read_seq_tuple(Relation rel,
@@ -470,6 +478,9 @@ ResetSequence(Oid seq_relid)
     /* Clear local cache so that we don't think we have cached numbers */
     /* Note that we do not change the currval() state */
     elm->cached = elm->last;
+#ifdef __TBASE__
+    SharedSeqCacheInvalidate(MyDatabaseId, seq_relid);
+#endif
 
     relation_close(seq_rel, NoLock);
 }
@@ -635,6 +646,9 @@ AlterSequence(ParseState *pstate, AlterSeqStmt *stmt)
         /* Clear local cache so that we don't think we have cached numbers */
         /* Note that we do not change the currval() state */
         elm->cached = elm->last;
+#ifdef __TBASE__
+        SharedSeqCacheInvalidate(MyDatabaseId, relid);
+#endif
 
         /* Now okay to update the on-disk tuple */
 #ifdef PGXC
@@ -716,6 +730,9 @@ AlterSequence(ParseState *pstate, AlterSeqStmt *stmt)
         /* Clear local cache so that we don't think we have cached numbers */
         /* Note that we do not change the currval() state */
         elm->cached = elm->last;
+#ifdef __TBASE__
+        SharedSeqCacheInvalidate(MyDatabaseId, relid);
+#endif
 
         /* Now okay to update the on-disk tuple */
 
@@ -779,6 +796,9 @@ DeleteSequenceTuple(Oid relid)
         elog(ERROR, "cache lookup failed for sequence %u", relid);
 
     CatalogTupleDelete(rel, &tuple->t_self);
+#ifdef __TBASE__
+    SharedSeqCacheInvalidate(MyDatabaseId, relid);
+#endif
 
     ReleaseSysCache(tuple);
     heap_close(rel, RowExclusiveLock);
@@ -832,6 +852,9 @@ nextval_internal(Oid relid, bool check_permissions)
     int64        incby;
     int64        cache;
     int64        result = 0;
+#ifdef __TBASE__
+    bool        use_shared_cache;
+#endif
 
     /* open and lock sequence */
     init_sequence(relid, &elm, &seqrel);
@@ -875,9 +898,24 @@ nextval_internal(Oid relid, bool check_permissions)
     cache = pgsform->seqcache;
     ReleaseSysCache(pgstuple);
 
+#ifdef __TBASE__
+    use_shared_cache = SharedSeqCacheUsable(seqrel);
+    if (use_shared_cache && SharedSeqCacheNext(relid, incby, &result))
+        goto shared_cache_hit;
+#endif
+
     /* lock page' buffer and read tuple */
     seq = read_seq_tuple(seqrel, &buf, &seqdatatuple);
 
+#ifdef __TBASE__
+    /* Another backend may have refilled the range while we waited */
+    if (use_shared_cache && SharedSeqCacheNext(relid, incby, &result))
+    {
+        UnlockReleaseBuffer(buf);
+        goto shared_cache_hit;
+    }
+#endif
+
     {
         int64 range = cache; /* how many values to ask from GTM? */
         int64 rangemax; /* the max value returned from the GTM for our request */
@@ -960,6 +998,13 @@ nextval_internal(Oid relid, bool check_permissions)
         elm->cached = rangemax;        /* last fetched range max limit */
         elm->last_valid = true;
 
+#ifdef __TBASE__
+        /* Hand the rest of the range to the other backends */
+        if (use_shared_cache && rangemax != result &&
+            SharedSeqCacheStore(relid, incby, result, rangemax))
+            elm->cached = result;
+#endif
+
         last_used_seq = elm;
     }
 
@@ -989,6 +1034,18 @@ nextval_internal(Oid relid, bool check_permissions)
     relation_close(seqrel, NoLock);
 
     return result;
+
+#ifdef __TBASE__
+shared_cache_hit:
+    /* Nothing is left cached in this backend, only currval() state */
+    elm->last = result;
+    elm->cached = result;
+    elm->last_valid = true;
+    elm->increment = incby;
+    relation_close(seqrel, NoLock);
+    last_used_seq = elm;
+    return result;
+#endif
 }
 
 Datum
@@ -1165,6 +1222,9 @@ do_setval(Oid relid, int64 next, bool iscalled)
     }
     /* In any case, forget any future cached numbers */
     elm->cached = elm->last;
+#ifdef __TBASE__
+    SharedSeqCacheInvalidate(MyDatabaseId, relid);
+#endif
 
     /* check the comment above nextval_internal()'s equivalent call. */
     if (RelationNeedsWAL(seqrel))
@@ -2264,3 +2324,239 @@ void RenameDatabaseSequence(const char* oldname, const char* newname)
     }
 }
 #endif
+
+#ifdef __TBASE__
+/*
+ * Coordinator-wide sequence cache.
+ *
+ * A range fetched from GTM by one backend is published here so that every
+ * backend of the coordinator draws from it, and only the refill costs a GTM
+ * round trip. Refills are serialized by the sequence page lock taken in
+ * nextval_internal. Entries are dropped whenever the sequence is altered,
+ * reset or dropped; like the per-backend cache, unused values are simply
+ * skipped in that case.
+ */
+typedef struct SharedSeqCacheKey
+{
+    Oid            dbid;            /* database of the sequence */
+    Oid            relid;            /* pg_class OID of the sequence */
+} SharedSeqCacheKey;
+
+typedef struct SharedSeqCacheEntry
+{
+    SharedSeqCacheKey key;        /* hash key, must be first */
+    int64        last;            /* value last handed out */
+    int64        cached;            /* last value of the range fetched */
+    int64        increment;        /* increment the range was fetched with */
+} SharedSeqCacheEntry;
+
+static HTAB *SharedSeqCache = NULL;
+
+Size
+SharedSeqCacheShmemSize(void)
+{
+    if (shared_sequence_cache_size <= 0)
+        return 0;
+
+    return hash_estimate_size(shared_sequence_cache_size,
+                              sizeof(SharedSeqCacheEntry));
+}
+
+void
+SharedSeqCacheShmemInit(void)
+{
+    HASHCTL        info;
+
+    if (shared_sequence_cache_size <= 0)
+        return;
+
+    MemSet(&info, 0, sizeof(info));
+    info.keysize = sizeof(SharedSeqCacheKey);
+    info.entrysize = sizeof(SharedSeqCacheEntry);
+
+    SharedSeqCache = ShmemInitHash("Shared sequence cache",
+                                   shared_sequence_cache_size,
+                                   shared_sequence_cache_size,
+                                   &info,
+                                   HASH_ELEM | HASH_BLOBS);
+}
+
+/*
+ * Can this sequence use the coordinator-wide cache?
+ */
+static bool
+SharedSeqCacheUsable(Relation seqrel)
+{
+    return SharedSeqCache != NULL && IS_PGXC_COORDINATOR &&
+           !RelationUsesLocalBuffers(seqrel);
+}
+
+/*
+ * Take the next value from the cached range of the sequence, if any.
+ */
+static bool
+SharedSeqCacheNext(Oid relid, int64 incby, int64 *result)
+{
+    SharedSeqCacheKey     key;
+    SharedSeqCacheEntry *entry;
+    bool                 found = false;
+
+    key.dbid = MyDatabaseId;
+    key.relid = relid;
+
+    LWLockAcquire(SharedSeqCacheLock, LW_EXCLUSIVE);
+    entry = (SharedSeqCacheEntry *) hash_search(SharedSeqCache, &key,
+                                                HASH_FIND, NULL);
+    if (entry != NULL && entry->increment == incby &&
+        entry->last != entry->cached)
+    {
+        entry->last += incby;
+        *result = entry->last;
+        found = true;
+    }
+    LWLockRelease(SharedSeqCacheLock);
+
+    return found;
+}
+
+/*
+ * Publish a range fetched from GTM, whose first value has already been
+ * consumed by the caller. Returns false if the cache is full.
+ */
+static bool
+SharedSeqCacheStore(Oid relid, int64 incby, int64 last, int64 cached)
+{
+    SharedSeqCacheKey     key;
+    SharedSeqCacheEntry *entry;
+
+    key.dbid = MyDatabaseId;
+    key.relid = relid;
+
+    LWLockAcquire(SharedSeqCacheLock, LW_EXCLUSIVE);
+    entry = (SharedSeqCacheEntry *) hash_search(SharedSeqCache, &key,
+                                                HASH_ENTER_NULL, NULL);
+    if (entry != NULL)
+    {
+        entry->last = last;
+        entry->cached = cached;
+        entry->increment = incby;
+    }
+    LWLockRelease(SharedSeqCacheLock);
+
+    return entry != NULL;
+}
+
+/*
+ * Forget the cached range of a sequence, or of every sequence of the
+ * database if relid is InvalidOid.
+ */
+void
+SharedSeqCacheInvalidate(Oid dbid, Oid relid)
+{
+    SharedSeqCacheEntry *entry;
+
+    if (SharedSeqCache == NULL)
+        return;
+
+    LWLockAcquire(SharedSeqCacheLock, LW_EXCLUSIVE);
+    if (OidIsValid(relid))
+    {
+        SharedSeqCacheKey key;
+
+        key.dbid = dbid;
+        key.relid = relid;
+        hash_search(SharedSeqCache, &key, HASH_REMOVE, NULL);
+    }
+    else
+    {
+        HASH_SEQ_STATUS status;
+
+        hash_seq_init(&status, SharedSeqCache);
+        while ((entry = (SharedSeqCacheEntry *) hash_seq_search(&status)) != NULL)
+        {
+            if (entry->key.dbid == dbid)
+                hash_search(SharedSeqCache, &entry->key, HASH_REMOVE, NULL);
+        }
+    }
+    LWLockRelease(SharedSeqCacheLock);
+}
+
+/*
+ * Cluster-unique ids, generated without GTM.
+ *
+ * An id is made of the milliseconds since UNIQUE_ID_EPOCH, the node and a
+ * per-node counter:
+ *
+ *    | 0 | 41 bits milliseconds | 1 bit node type | 9 bits node | 12 bits |
+ *
+ * Backends of a node draw from the same shared 64-bit state holding the last
+ * (milliseconds, counter) pair handed out, so ids of a node only grow. When
+ * the counter of a millisecond is exhausted, or the clock goes backwards, the
+ * state simply moves on past the current time instead of waiting for it.
+ * Ids are roughly ordered by time, but not across nodes.
+ */
+#define UNIQUE_ID_EPOCH            INT64CONST(1577836800000)    /* 2020-01-01 */
+#define UNIQUE_ID_COUNTER_BITS    12
+#define UNIQUE_ID_NODE_BITS        9
+#define UNIQUE_ID_NODE_SHIFT    UNIQUE_ID_COUNTER_BITS
+#define UNIQUE_ID_TYPE_SHIFT    (UNIQUE_ID_NODE_SHIFT + UNIQUE_ID_NODE_BITS)
+#define UNIQUE_ID_TIME_SHIFT    (UNIQUE_ID_TYPE_SHIFT + 1)
+#define UNIQUE_ID_MAX_NODE        ((1 << UNIQUE_ID_NODE_BITS) - 1)
+
+static pg_atomic_uint64 *UniqueIdState = NULL;
+
+Size
+UniqueIdShmemSize(void)
+{
+    return sizeof(pg_atomic_uint64);
+}
+
+void
+UniqueIdShmemInit(void)
+{
+    bool        found;
+
+    UniqueIdState = (pg_atomic_uint64 *)
+        ShmemInitStruct("Cluster unique id", UniqueIdShmemSize(), &found);
+    if (!found)
+        pg_atomic_init_u64(UniqueIdState, 0);
+}
+
+Datum
+cluster_unique_id(PG_FUNCTION_ARGS)
+{
+    uint64        now;
+    uint64        last;
+    uint64        next;
+    uint64        node;
+
+    if (PGXCNodeId <= 0 || PGXCNodeId > UNIQUE_ID_MAX_NODE)
+        ereport(ERROR,
+                (errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+                 errmsg("node id %d of \"%s\" can not be used for a cluster unique id",
+                        PGXCNodeId, PGXCNodeName ? PGXCNodeName : "")));
+
+    /* (milliseconds, counter) state for the current time */
+    now = (uint64) (GetCurrentTimestamp() / 1000 +
+                    (int64) (POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE) *
+                    SECS_PER_DAY * 1000 - UNIQUE_ID_EPOCH);
+    now <<= UNIQUE_ID_COUNTER_BITS;
+
+    last = pg_atomic_read_u64(UniqueIdState);
+    do
+    {
+        next = Max(now, last + 1);
+    } while (!pg_atomic_compare_exchange_u64(UniqueIdState, &last, next));
+
+    node = (uint64) PGXCNodeId << UNIQUE_ID_NODE_SHIFT;
+    if (IS_PGXC_DATANODE)
+        node |= (uint64) 1 << UNIQUE_ID_TYPE_SHIFT;
+
+    /* splice the node between the milliseconds and the counter */
+    PG_RETURN_INT64((int64)
+                    ((((next >> UNIQUE_ID_COUNTER_BITS) << UNIQUE_ID_TIME_SHIFT) |
+                      node |
+                      (next & ((1 << UNIQUE_ID_COUNTER_BITS) - 1))) &
+                     (uint64) PG_INT64_MAX));
+}
+#endif
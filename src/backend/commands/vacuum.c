@@ -2049,43 +2049,47 @@ ExecVacuumShard(VacuumShardStmt *stmt)
 {
     List *relations = NULL;
     ListCell *cur = NULL;
-    int tuples = 0;
+    ListCell *lc_shard = NULL;
+    List     *relnames = NIL;
+    ListCell *lc_name = NULL;
+    MemoryContext oldcontext;
+    ShardID  *sids = NULL;
+    int nsids = 0;
     
     vac_context = AllocSetContextCreate(PortalContext,
                                         "Vacuum",
                                         ALLOCSET_DEFAULT_SIZES);
     relations = get_rel_oids(InvalidOid, stmt->relation);
 
+    sids = (ShardID *) MemoryContextAlloc(vac_context,
+                                          sizeof(ShardID) * Max(list_length(stmt->shards), 1));
+    foreach(lc_shard, stmt->shards)
+    {
+        A_Const * con = ((A_Const *)lfirst(lc_shard));
+
+        sids[nsids++] = intVal(&(con->val));
+    }
+
+    /* the names are reported once the catalogs can no longer be read */
+    oldcontext = MemoryContextSwitchTo(vac_context);
+    foreach(cur, relations)
+        relnames = lappend(relnames, get_rel_name(lfirst_oid(cur)));
+    MemoryContextSwitchTo(oldcontext);
+
     if(ActiveSnapshotSet())
         PopActiveSnapshot();
     CommitTransactionCommand();
 
-    foreach(cur, relations)
+    forboth(cur, relations, lc_name, relnames)
     {        
         Oid         relid = lfirst_oid(cur);
-        //Relation    rel = heap_open(relid, ShareLock);
-        ListCell     *lc_shard;
-
-        /* for every shard */
-        foreach(lc_shard, stmt->shards)
-        {
-            int s_tuples = 0;
-
-            A_Const * con = ((A_Const *)lfirst(lc_shard));
-            
-            ShardID sid = intVal(&(con->val));
-            
-            s_tuples = TruncateShard(relid, sid, stmt->pause);
-
-            elog(INFO, "Vacuum One Shard Success. rel=%d, sid=%d, tuples=%d",
-                        relid, sid, s_tuples);
-            tuples += s_tuples;
-        }
+        int         tuples;
 
-        //heap_close(rel, ShareLock);
+        /* all requested shards of the relation at once */
+        tuples = TruncateShards(relid, sids, nsids, stmt->pause);
 
-        elog(INFO, "Vacuum Shard Success. rel=%d, tuples=%d",
-                        relid, tuples);
+        elog(INFO, "Vacuum Shard Success. rel=%s, shards=%d, tuples=%d",
+                        (char *) lfirst(lc_name), nsids, tuples);
     }
 
     StartTransactionCommand();
@@ -175,6 +175,79 @@ static const unsigned char SboxTable[16][16] =
 {0x18,0xf0,0x7d,0xec,0x3a,0xdc,0x4d,0x20,0x79,0xee,0x5f,0x3e,0xd7,0xcb,0x39,0x48}
 };
 
+/*
+ * Sbox followed by the linear transform L for the most significant byte of
+ * the round input, L(Sbox(a) << 24).  The lower bytes use the same table
+ * rotated right by 8, 16 and 24 bits, as L commutes with rotation.
+ */
+static const uint32 SboxLTable[256] =
+{
+0x8ed55b5b,0xd0924242,0x4deaa7a7,0x06fdfbfb,
+0xfccf3333,0x65e28787,0xc93df4f4,0x6bb5dede,
+0x4e165858,0x6eb4dada,0x44145050,0xcac10b0b,
+0x8828a0a0,0x17f8efef,0x9c2cb0b0,0x11051414,
+0x872bacac,0xfb669d9d,0xf2986a6a,0xae77d9d9,
+0x822aa8a8,0x46bcfafa,0x14041010,0xcfc00f0f,
+0x02a8aaaa,0x54451111,0x5f134c4c,0xbe269898,
+0x6d482525,0x9e841a1a,0x1e061818,0xfd9b6666,
+0xec9e7272,0x4a430909,0x10514141,0x24f7d3d3,
+0xd5934646,0x53ecbfbf,0xf89a6262,0x927be9e9,
+0xff33cccc,0x04555151,0x270b2c2c,0x4f420d0d,
+0x59eeb7b7,0xf3cc3f3f,0x1caeb2b2,0xea638989,
+0x74e79393,0x7fb1cece,0x6c1c7070,0x0daba6a6,
+0xedca2727,0x28082020,0x48eba3a3,0xc1975656,
+0x80820202,0xa3dc7f7f,0xc4965252,0x12f9ebeb,
+0xa174d5d5,0xb38d3e3e,0xc33ffcfc,0x3ea49a9a,
+0x5b461d1d,0x1b071c1c,0x3ba59e9e,0x0cfff3f3,
+0x3ff0cfcf,0xbf72cdcd,0x4b175c5c,0x52b8eaea,
+0x8f810e0e,0x3d586565,0xcc3cf0f0,0x7d196464,
+0x7ee59b9b,0x91871616,0x734e3d3d,0x08aaa2a2,
+0xc869a1a1,0xc76aadad,0x85830606,0x7ab0caca,
+0xb570c5c5,0xf4659191,0xb2d96b6b,0xa7892e2e,
+0x18fbe3e3,0x47e8afaf,0x330f3c3c,0x674a2d2d,
+0xb071c1c1,0x0e575959,0xe99f7676,0xe135d4d4,
+0x661e7878,0xb4249090,0x360e3838,0x265f7979,
+0xef628d8d,0x38596161,0x95d24747,0x2aa08a8a,
+0xb1259494,0xaa228888,0x8c7df1f1,0xd73becec,
+0x05010404,0xa5218484,0x9879e1e1,0x9b851e1e,
+0x84d75353,0x00000000,0x5e471919,0x0b565d5d,
+0xe39d7e7e,0x9fd04f4f,0xbb279c9c,0x1a534949,
+0x7c4d3131,0xee36d8d8,0x0a020808,0x7be49f9f,
+0x20a28282,0xd4c71313,0xe8cb2323,0xe69c7a7a,
+0x42e9abab,0x43bdfefe,0xa2882a2a,0x9ad14b4b,
+0x40410101,0xdbc41f1f,0xd838e0e0,0x61b7d6d6,
+0x2fa18e8e,0x2bf4dfdf,0x3af1cbcb,0xf6cd3b3b,
+0x1dfae7e7,0xe5608585,0x41155454,0x25a38686,
+0x60e38383,0x16acbaba,0x295c7575,0x34a69292,
+0xf7996e6e,0xe434d0d0,0x721a6868,0x01545555,
+0x19afb6b6,0xdf914e4e,0xfa32c8c8,0xf030c0c0,
+0x21f6d7d7,0xbc8e3232,0x75b3c6c6,0x6fe08f8f,
+0x691d7474,0x2ef5dbdb,0x6ae18b8b,0x962eb8b8,
+0x8a800a0a,0xfe679999,0xe2c92b2b,0xe0618181,
+0xc0c30303,0x8d29a4a4,0xaf238c8c,0x07a9aeae,
+0x390d3434,0x1f524d4d,0x764f3939,0xd36ebdbd,
+0x81d65757,0xb7d86f6f,0xeb37dcdc,0x51441515,
+0xa6dd7b7b,0x09fef7f7,0xb68c3a3a,0x932fbcbc,
+0x0f030c0c,0x03fcffff,0xc26ba9a9,0xba73c9c9,
+0xd96cb5b5,0xdc6db1b1,0x375a6d6d,0x15504545,
+0xb98f3636,0x771b6c6c,0x13adbebe,0xda904a4a,
+0x57b9eeee,0xa9de7777,0x4cbef2f2,0x837efdfd,
+0x55114444,0xbdda6767,0x2c5d7171,0x45400505,
+0x631f7c7c,0x50104040,0x325b6969,0xb8db6363,
+0x220a2828,0xc5c20707,0xf531c4c4,0xa88a2222,
+0x31a79696,0xf9ce3737,0x977aeded,0x49bff6f6,
+0x992db4b4,0xa475d1d1,0x90d34343,0x5a124848,
+0x58bae2e2,0x71e69797,0x64b6d2d2,0x70b2c2c2,
+0xad8b2626,0xcd68a5a5,0xcb955e5e,0x624b2929,
+0x3c0c3030,0xce945a5a,0xab76dddd,0x867ff9f9,
+0xf1649595,0x5dbbe6e6,0x35f2c7c7,0x2d092424,
+0xd1c61717,0xd66fb9b9,0xdec51b1b,0x94861212,
+0x78186060,0x30f3c3c3,0x897cf5f5,0x5cefb3b3,
+0xd23ae8e8,0xacdf7373,0x794c3535,0xa0208080,
+0x9d78e5e5,0x56edbbbb,0x235e7d7d,0xc63ef8f8,
+0x8bd45f5f,0xe7c82f2f,0xdd39e4e4,0x68492121
+};
+
 /* System parameter */
 static const unsigned long FK[4] = {0xa3b1bac6,0x56aa3350,0x677d9197,0xb27022dc};
 
@@ -204,44 +277,6 @@ static unsigned char sm4Sbox(unsigned char inch)
     return retVal;
 }
 
-/*
- * private F(Lt) function:
- * "T algorithm" == "L algorithm" + "t algorithm".
- * args:    [in] a: a is a 32 bits unsigned value;
- * return: c: c is calculated with line algorithm "L" and nonline algorithm "t"
- */
-static unsigned long sm4Lt(unsigned long ka)
-{
-    unsigned long bb = 0;
-    unsigned long c = 0;
-    unsigned char a[4];
-    unsigned char b[4];
-    PUT_ULONG_BE(ka,a,0)
-    b[0] = sm4Sbox(a[0]);
-    b[1] = sm4Sbox(a[1]);
-    b[2] = sm4Sbox(a[2]);
-    b[3] = sm4Sbox(a[3]);
-    GET_ULONG_BE(bb,b,0)
-    c =bb^(ROTL(bb, 2))^(ROTL(bb, 10))^(ROTL(bb, 18))^(ROTL(bb, 24));
-    return c;
-}
-
-/*
- * private F function:
- * Calculating and getting encryption/decryption contents.
- * args:    [in] x0: original contents;
- * args:    [in] x1: original contents;
- * args:    [in] x2: original contents;
- * args:    [in] x3: original contents;
- * args:    [in] rk: encryption/decryption key;
- * return the contents of encryption/decryption contents.
- */
-static unsigned long sm4F(unsigned long x0, unsigned long x1, unsigned long x2, unsigned long x3, unsigned long rk)
-{
-    return (x0^sm4Lt(x1^x2^x3^rk));
-}
-
-
 /* private function:
  * Calculating round encryption key.
  * args:    [in] a: a is a 32 bits unsigned value;
@@ -285,6 +320,17 @@ static void sm4_setkey( unsigned long SK[32], unsigned char key[16] )
 
 }
 
+/*
+ * The "T algorithm" of a round, L(t(x)), by table lookup.
+ */
+#define SM4_T(x) \
+    (SboxLTable[((x) >> 24) & 0xFF] ^ \
+     ROTL32(SboxLTable[((x) >> 16) & 0xFF], 24) ^ \
+     ROTL32(SboxLTable[((x) >> 8) & 0xFF], 16) ^ \
+     ROTL32(SboxLTable[(x) & 0xFF], 8))
+
+#define ROTL32(x,n) ((uint32) (((x) << (n)) | ((x) >> (32 - (n)))))
+
 /*
  * SM4 standard one round processing
  *
@@ -293,26 +339,32 @@ static void sm4_one_round( unsigned long sk[32],
                     unsigned char input[16],
                     unsigned char output[16] )
 {
-    unsigned long i = 0;
-    unsigned long ulbuf[36];
-
-    memset(ulbuf, 0, sizeof(ulbuf));
-    GET_ULONG_BE( ulbuf[0], input, 0 )
-    GET_ULONG_BE( ulbuf[1], input, 4 )
-    GET_ULONG_BE( ulbuf[2], input, 8 )
-    GET_ULONG_BE( ulbuf[3], input, 12 )
-    while(i<32)
+    int    i;
+    uint32 x0, x1, x2, x3;
+
+    x0 = ((uint32) input[0] << 24) | ((uint32) input[1] << 16) | ((uint32) input[2] << 8) | input[3];
+    x1 = ((uint32) input[4] << 24) | ((uint32) input[5] << 16) | ((uint32) input[6] << 8) | input[7];
+    x2 = ((uint32) input[8] << 24) | ((uint32) input[9] << 16) | ((uint32) input[10] << 8) | input[11];
+    x3 = ((uint32) input[12] << 24) | ((uint32) input[13] << 16) | ((uint32) input[14] << 8) | input[15];
+
+    for (i = 0; i < 32; i += 4)
     {
-        ulbuf[i+4] = sm4F(ulbuf[i], ulbuf[i+1], ulbuf[i+2], ulbuf[i+3], sk[i]);
-// #ifdef _DEBUG
-//            printf("rk(%02d) = 0x%08x,  X(%02d) = 0x%08x \n",i,sk[i], i, ulbuf[i+4] );
-// #endif
-        i++;
+        uint32 t;
+
+        t = x1 ^ x2 ^ x3 ^ (uint32) sk[i];
+        x0 ^= SM4_T(t);
+        t = x2 ^ x3 ^ x0 ^ (uint32) sk[i + 1];
+        x1 ^= SM4_T(t);
+        t = x3 ^ x0 ^ x1 ^ (uint32) sk[i + 2];
+        x2 ^= SM4_T(t);
+        t = x0 ^ x1 ^ x2 ^ (uint32) sk[i + 3];
+        x3 ^= SM4_T(t);
     }
-    PUT_ULONG_BE(ulbuf[35],output,0);
-    PUT_ULONG_BE(ulbuf[34],output,4);
-    PUT_ULONG_BE(ulbuf[33],output,8);
-    PUT_ULONG_BE(ulbuf[32],output,12);
+
+    PUT_ULONG_BE(x3,output,0);
+    PUT_ULONG_BE(x2,output,4);
+    PUT_ULONG_BE(x1,output,8);
+    PUT_ULONG_BE(x0,output,12);
 }
 
 /*
@@ -1170,6 +1170,11 @@ InitPlan(QueryDesc *queryDesc, int eflags)
 	if (queryDesc->epqContext != NULL)
 		AttachRemoteEPQContext(estate, queryDesc->epqContext);
 
+#ifdef __TBASE__
+    /* share query_work_mem among the workspaces before nodes size them */
+    ExecAssignWorkMem(estate, plannedstmt);
+#endif
+
     /*
      * Initialize private state information for each SubPlan.  We must do this
      * before running ExecInitNode on the main query tree, since
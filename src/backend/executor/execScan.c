@@ -146,11 +146,16 @@ ExecScan(ScanState *node,
 
     char *cmd_type = "SELECT";
     CmdType    commandType = CMD_SELECT;
+    bool    check_fga;
 
     if (node->ps.state && node->ps.state->es_plannedstmt)
     {
         commandType = node->ps.state->es_plannedstmt->commandType;
     }
+
+    /* fga policies are only checked for SELECT here */
+    check_fga = (enable_fga && node->ps.audit_fga_qual != NIL &&
+                 g_commandTag && strcmp(g_commandTag, "SELECT") == 0);
 #endif
 
     /*
@@ -178,7 +183,7 @@ ExecScan(ScanState *node,
      * all the overhead and return the raw scan tuple.
      */
 #ifdef __AUDIT_FGA__
-    if (!qual && !projInfo && !node->ps.audit_fga_qual && enable_fga)
+    if (!qual && !projInfo && !check_fga)
 #else
     if (!qual && !projInfo)
 #endif
@@ -316,20 +321,27 @@ next_record:
         if (qual == NULL || ExecQual(qual, econtext))
         {
 #ifdef __AUDIT_FGA__
-            if (enable_fga && g_commandTag && (strcmp(g_commandTag, "SELECT") == 0))
+            if (check_fga && node->ps.audit_fga_qual != NIL)
             {
-                foreach (item, node->ps.audit_fga_qual)
+                ListCell   *prev = NULL;
+                ListCell   *next;
+
+                for (item = list_head(node->ps.audit_fga_qual); item != NULL; item = next)
                 {
                     audit_fga_policy_state *audit_fga_qual = (audit_fga_policy_state *) lfirst(item);
-                    if (audit_fga_qual != NULL)
+
+                    next = lnext(item);
+                    if (audit_fga_qual != NULL && ExecQual(audit_fga_qual->qual, econtext))
                     {
-                        if(ExecQual(audit_fga_qual->qual, econtext))
-                        {
-                            audit_fga_log_policy_info_2(audit_fga_qual, cmd_type);
+                        audit_fga_log_policy_info_2(audit_fga_qual, cmd_type);
 
-                            node->ps.audit_fga_qual = list_delete(node->ps.audit_fga_qual, audit_fga_qual);
-                        }
-                    }   
+                        /* a policy is reported once per scan, stop checking it */
+                        node->ps.audit_fga_qual = list_delete_cell(node->ps.audit_fga_qual, item, prev);
+                    }
+                    else
+                    {
+                        prev = item;
+                    }
                 }
             }
 #endif
@@ -116,6 +116,9 @@
 #include "utils/rel.h"
 #include "utils/typcache.h"
 #ifdef __TBASE__
+#include "miscadmin.h"
+#include "pgxc/pgxc.h"
+#include "pgxc/planner.h"
 #include "utils/ruleutils.h"
 #endif
 
@@ -219,6 +222,9 @@ CreateExecutorState(void)
 #ifdef __AUDIT__
     estate->es_remote_subplan_num = 0;
 #endif
+#ifdef __TBASE__
+    estate->es_work_mem = 0;
+#endif
 
     /*
      * Return the executor state structure
@@ -270,6 +276,108 @@ FreeExecutorState(EState *estate)
     MemoryContextDelete(estate->es_query_cxt);
 }
 
+#ifdef __TBASE__
+/*
+ * Count the plan nodes which keep a workspace bounded by work_mem. Nodes
+ * below a RemoteSubplan run in another fragment and are not counted, except
+ * for the producer at the top of a datanode fragment.
+ */
+static int
+ExecCountWorkspaces(Plan *plan, bool top)
+{
+    int         count = 0;
+    ListCell   *lc;
+
+    if (plan == NULL)
+        return 0;
+
+    switch (nodeTag(plan))
+    {
+        case T_Sort:
+        case T_Hash:
+        case T_Material:
+        case T_WindowAgg:
+        case T_RecursiveUnion:
+            count++;
+            break;
+        case T_Agg:
+            if (((Agg *) plan)->aggstrategy != AGG_PLAIN)
+                count++;
+            break;
+        case T_SetOp:
+            if (((SetOp *) plan)->strategy == SETOP_HASHED)
+                count++;
+            break;
+        case T_RemoteSubplan:
+            if (!top || !IS_PGXC_DATANODE)
+                return 0;
+            break;
+        case T_Append:
+            foreach(lc, ((Append *) plan)->appendplans)
+                count += ExecCountWorkspaces((Plan *) lfirst(lc), false);
+            break;
+        case T_MergeAppend:
+            foreach(lc, ((MergeAppend *) plan)->mergeplans)
+                count += ExecCountWorkspaces((Plan *) lfirst(lc), false);
+            break;
+        case T_ModifyTable:
+            foreach(lc, ((ModifyTable *) plan)->plans)
+                count += ExecCountWorkspaces((Plan *) lfirst(lc), false);
+            break;
+        case T_SubqueryScan:
+            count += ExecCountWorkspaces(((SubqueryScan *) plan)->subplan, false);
+            break;
+        default:
+            break;
+    }
+
+    count += ExecCountWorkspaces(plan->lefttree, false);
+    count += ExecCountWorkspaces(plan->righttree, false);
+
+    return count;
+}
+
+/* ----------------
+ *        ExecAssignWorkMem
+ *
+ *        Split query_work_mem evenly over the workspaces of the plan, so a
+ *        fragment with many sorts and hash tables spills to disk instead of
+ *        using work_mem for each of them.
+ * ----------------
+ */
+void
+ExecAssignWorkMem(EState *estate, PlannedStmt *plannedstmt)
+{
+    int         count;
+    ListCell   *lc;
+
+    estate->es_work_mem = 0;
+    if (query_work_mem <= 0)
+        return;
+
+    count = ExecCountWorkspaces(plannedstmt->planTree, true);
+    foreach(lc, plannedstmt->subplans)
+        count += ExecCountWorkspaces((Plan *) lfirst(lc), false);
+
+    if (count > 0)
+        estate->es_work_mem = Max(query_work_mem / count, 64);
+}
+
+/* ----------------
+ *        ExecWorkMem
+ *
+ *        Memory in KB a workspace of the query may use before spilling.
+ * ----------------
+ */
+int
+ExecWorkMem(EState *estate)
+{
+    if (estate != NULL && estate->es_work_mem > 0)
+        return Min(work_mem, estate->es_work_mem);
+    return work_mem;
+}
+#endif
+
 /* ----------------
  *        CreateExprContext
  *
@@ -705,7 +705,11 @@ initialize_phase(AggState *aggstate, int newphase)
                                                   sortnode->sortOperators,
                                                   sortnode->collations,
                                                   sortnode->nullsFirst,
+#ifdef __TBASE__
+                                                  ExecWorkMem(aggstate->ss.ps.state),
+#else
                                                   work_mem,
+#endif
                                                   false);
     }
 
@@ -2268,9 +2272,37 @@ HybridHashtableLoadDone(TupleHashTable hashtable)
 	return result;
 }
 
+/* upper bound of batch files a single spill set may open */
+#define HYBRID_HASHAGG_MAX_NBATCHES 256
+
+/*
+ * Choose the batch file of a spilled entry.
+ *
+ * The hash value is remixed with the spill level, so entries that landed in
+ * the same file at one level are spread over the files of the next level
+ * instead of being partitioned by the same low-order bits again.
+ */
+static inline int
+hybrid_spill_file_index(uint32 hash, int level, int nfiles)
+{
+	uint32 h = hash ^ ((uint32) level * 0x9e3779b9U);
+
+	h ^= h >> 16;
+	h *= 0x85ebca6b;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35;
+	h ^= h >> 16;
+
+	return (int) (h % (uint32) nfiles);
+}
+
 /* 
  * get max number of buckets of hashtable in memory.
  * If not all fit in memory, get the batch file's number.
+ *
+ * The number of batch files follows the estimated groups so that every
+ * batch is expected to fit in work_mem when it is loaded back, but is never
+ * below g_default_hashagg_nbatches.
  */
 void
 OptimizeHybridHashtableSize(TupleHashTable hashtable, uint32 entrySize, double numGroups)
@@ -2290,7 +2322,9 @@ OptimizeHybridHashtableSize(TupleHashTable hashtable, uint32 entrySize, double n
 		nentries = ceil(max_mem/entrySize);
 	}
 
-	nbatches = g_default_hashagg_nbatches;
+	nbatches = Max(nbatches, g_default_hashagg_nbatches);
+	nbatches = Min(nbatches, Max(g_default_hashagg_nbatches,
+								 HYBRID_HASHAGG_MAX_NBATCHES));
 
 	hashtable->nbatches = (int)nbatches;
 	hashtable->spilled = false;
@@ -2366,11 +2400,8 @@ DumpHybridHashtable(AggState *aggstate, TupleHashTable hashtable)
 		SpillFile *spill_file = NULL;
 		uint32 hash = entry->hash;
 		Datum *trans_values = NULL;
-		/* 
-		 * FIXME: we use mod to get the batch index, any other ways to 
-		 * make tuples balance in batch files
-		 */
-		spill_file_index = hash % hashtable->nbatches;
+		spill_file_index = hybrid_spill_file_index(hash, spill_set->level,
+												   spill_set->num_files);
 
 		if (!spill_set->spill_file[spill_file_index])
 		{
@@ -2861,7 +2892,8 @@ RETRY:
 
 							spillset = (SpillSet *)spill_file->child_spill_set;
 
-							file_index = hashkey % spillset->num_files;
+							file_index = hybrid_spill_file_index(hashkey, spillset->level,
+																 spillset->num_files);
 
 							if (!spillset->spill_file[file_index])
 							{
@@ -60,9 +60,22 @@
 #include "executor/execdebug.h"
 #include "executor/nodeAppend.h"
 #include "miscadmin.h"
+#ifdef __TBASE__
+#include "access/heapam.h"
+#include "catalog/pg_type.h"
+#include "nodes/makefuncs.h"
+#include "nodes/nodeFuncs.h"
+#include "utils/lsyscache.h"
+#include "utils/ruleutils.h"
+#endif
 
 static TupleTableSlot *ExecAppend(PlanState *pstate);
 static bool exec_append_initialize_next(AppendState *appendstate);
+#ifdef __TBASE__
+static Node *interval_prune_param_mutator(Node *node, ParamListInfo params);
+static bool exec_append_interval_prune(Append *node, EState *estate, Bitmapset **parts);
+static bool exec_append_child_pruned(Plan *plan, Bitmapset *parts);
+#endif
 
 
 /* ----------------------------------------------------------------
@@ -107,6 +120,102 @@ exec_append_initialize_next(AppendState *appendstate)
     }
 }
 
+#ifdef __TBASE__
+/*
+ * replace external params by their values, so that the quals can be handled
+ * by the plan time pruning code.
+ */
+static Node *
+interval_prune_param_mutator(Node *node, ParamListInfo params)
+{
+    if (node == NULL)
+        return NULL;
+
+    if (IsA(node, Param))
+    {
+        Param *param = (Param *) node;
+
+        if (param->paramkind == PARAM_EXTERN &&
+            param->paramid > 0 && param->paramid <= params->numParams)
+        {
+            ParamExternData *prm = &params->params[param->paramid - 1];
+
+            if (!OidIsValid(prm->ptype) && params->paramFetch != NULL)
+                (*params->paramFetch) (params, param->paramid);
+
+            /*
+             * only types the partition router knows, null never matches and
+             * is left to the scan
+             */
+            if (OidIsValid(prm->ptype) && prm->ptype == param->paramtype && !prm->isnull &&
+                (param->paramtype == INT2OID || param->paramtype == INT4OID ||
+                 param->paramtype == INT8OID || param->paramtype == TIMESTAMPOID))
+            {
+                int16   typlen;
+                bool    typbyval;
+
+                get_typlenbyval(param->paramtype, &typlen, &typbyval);
+                return (Node *) makeConst(param->paramtype,
+                                          param->paramtypmod,
+                                          param->paramcollid,
+                                          (int) typlen,
+                                          prm->value,
+                                          false,
+                                          typbyval);
+            }
+        }
+        return node;
+    }
+
+    return expression_tree_mutator(node, interval_prune_param_mutator, (void *) params);
+}
+
+/*
+ * compute the children of an interval partitioned table still needed once
+ * external params are known. Returns false if nothing could be pruned at
+ * runtime.
+ */
+static bool
+exec_append_interval_prune(Append *node, EState *estate, Bitmapset **parts)
+{
+    ParamListInfo params = estate->es_param_list_info;
+    List       *quals;
+    Relation    rel;
+
+    if (!node->interval || !OidIsValid(node->interval_parent) ||
+        node->interval_prune_quals == NIL || params == NULL)
+        return false;
+
+    quals = (List *) interval_prune_param_mutator((Node *) node->interval_prune_quals, params);
+
+    rel = heap_open(node->interval_parent, AccessShareLock);
+    *parts = RelationGetPartitionsByQuals(rel, quals);
+    heap_close(rel, NoLock);
+
+    return true;
+}
+
+static bool
+exec_append_child_pruned(Plan *plan, Bitmapset *parts)
+{
+    switch (nodeTag(plan))
+    {
+        case T_SeqScan:
+        case T_SampleScan:
+        case T_IndexScan:
+        case T_IndexOnlyScan:
+        case T_BitmapHeapScan:
+            {
+                Scan *scan = (Scan *) plan;
+
+                return scan->ispartchild && !bms_is_member(scan->childidx, parts);
+            }
+        default:
+            return false;
+    }
+}
+#endif
+
 /* ----------------------------------------------------------------
  *        ExecInitAppend
  *
@@ -126,6 +235,10 @@ ExecInitAppend(Append *node, EState *estate, int eflags)
     int            nplans;
     int            i;
     ListCell   *lc;
+#ifdef __TBASE__
+    Bitmapset  *parts = NULL;
+    bool        pruning;
+#endif
 
     /* check for unsupported flags */
     Assert(!(eflags & EXEC_FLAG_MARK));
@@ -165,6 +278,11 @@ ExecInitAppend(Append *node, EState *estate, int eflags)
      */
     ExecInitResultTupleSlot(estate, &appendstate->ps);
 
+#ifdef __TBASE__
+    /* generic plans over interval partitions, prune children by param values */
+    pruning = exec_append_interval_prune(node, estate, &parts);
+#endif
+
     /*
      * call ExecInitNode on each of the plans to be executed and save the
      * results into the array "appendplans".
@@ -173,8 +291,14 @@ ExecInitAppend(Append *node, EState *estate, int eflags)
     foreach(lc, node->appendplans)
     {
         Plan       *initNode = (Plan *) lfirst(lc);
+		PlanState  *ret;
 
-		PlanState *ret = ExecInitNode(initNode, estate, eflags);
+#ifdef __TBASE__
+        if (pruning && exec_append_child_pruned(initNode, parts))
+            continue;
+#endif
+
+		ret = ExecInitNode(initNode, estate, eflags);
 		if (ret)
 		{
 			appendplanstates[i] = ret;
@@ -209,6 +333,12 @@ ExecAppend(PlanState *pstate)
 {
     AppendState *node = castNode(AppendState, pstate);
 
+#ifdef __TBASE__
+    /* every child has been pruned */
+    if (node->as_nplans == 0)
+        return ExecClearTuple(node->ps.ps_ResultTupleSlot);
+#endif
+
     for (;;)
     {
         PlanState  *subnode;
@@ -219,7 +219,11 @@ ExecInitCteScan(CteScan *node, EState *estate, int eflags)
         /* I am the leader */
         prmdata->value = PointerGetDatum(scanstate);
         scanstate->leader = scanstate;
+#ifdef __TBASE__
+        scanstate->cte_table = tuplestore_begin_heap(true, false, ExecWorkMem(estate));
+#else
         scanstate->cte_table = tuplestore_begin_heap(true, false, work_mem);
+#endif
         tuplestore_set_eflags(scanstate->cte_table, scanstate->eflags);
         scanstate->readptr = 0;
     }
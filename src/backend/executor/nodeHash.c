@@ -99,6 +99,16 @@ MultiExecHash(HashState *node)
     outerNode = outerPlanState(node);
     hashtable = node->hashtable;
 
+#ifdef __TBASE__
+    /* add batches once the share of query_work_mem is used up */
+    if (ExecWorkMem(node->ps.state) < work_mem)
+    {
+        hashtable->spaceAllowed = ExecWorkMem(node->ps.state) * 1024L;
+        hashtable->spaceAllowedSkew =
+            hashtable->spaceAllowed * SKEW_WORK_MEM_PERCENT / 100;
+    }
+#endif
+
     /*
      * set expression context
      */
@@ -135,6 +145,10 @@ MultiExecHash(HashState *node)
                 ExecHashTableInsert(hashtable, slot, hashvalue);
             }
             hashtable->totalTuples += 1;
+#ifdef __TBASE__
+            if (node->filter)
+                SQueueFilterAdd(node->filter, hashvalue);
+#endif
         }
     }
 
@@ -25,6 +25,8 @@
 #ifdef __TBASE__
 #include "access/xact.h"
 #include "executor/execParallel.h"
+#include "pgxc/execRemote.h"
+#include "pgxc/pgxc.h"
 #endif
 
 /*
@@ -58,6 +60,8 @@ static bool ExecHashJoinNewBatch(HashJoinState *hjstate);
 static void ExecShareBufFileName(volatile ParallelHashJoinState *parallelState, HashJoinTable hashtable, bool inner);
 static HashJoinTable ExecMergeShmHashTable(HashJoinState * hjstate, volatile ParallelHashJoinState *parallelState, 
                                 Hash *node, List *hashOperators, bool keepNulls);
+static void ExecHashJoinFilterKeys(HashJoin *node, HashJoinState *hjstate);
+static void ExecHashJoinPushFilter(HashJoinState *hjstate, SQueueFilter *filter);
 static void ExecFormNewOuterBufFile(HashJoinState * hjstate, volatile ParallelHashJoinState *parallelState, 
                                  Hash *node);
 
@@ -320,6 +324,16 @@ ExecHashJoin(PlanState *pstate)
                                                 node->hj_HashOperators,
                                                 HJ_FILL_INNER(node));
                 node->hj_HashTable = hashtable;
+#ifdef __TBASE__
+                /* collect runtime join filter while building */
+                if (node->hj_FilterNKeys > 0)
+                {
+                    MemoryContext oldcontext = MemoryContextSwitchTo(hashtable->hashCxt);
+
+                    hashNode->filter = SQueueFilterCreate(hashNode->ps.plan->plan_rows);
+                    MemoryContextSwitchTo(oldcontext);
+                }
+#endif
 
                 /*
                  * execute the Hash node, to build the hash table
@@ -328,6 +342,13 @@ ExecHashJoin(PlanState *pstate)
                 (void) MultiExecProcNode((PlanState *) hashNode);
 #ifdef __TBASE__
                 }
+
+                /* the filter lives in the hash table context, hand it off */
+                if (hashNode->filter)
+                {
+                    ExecHashJoinPushFilter(node, hashNode->filter);
+                    hashNode->filter = NULL;
+                }
 #endif
                 /*
                  * If the inner relation is completely empty, and we're not
@@ -764,6 +785,7 @@ ExecInitHashJoin(HashJoin *node, EState *estate, int eflags)
 #ifdef __TBASE__
     hjstate->hj_OuterInited = false;
     hjstate->hj_InnerInited = false;
+    ExecHashJoinFilterKeys(node, hjstate);
 #endif
 
     return hjstate;
@@ -1295,6 +1317,14 @@ RETRY:
 void
 ExecReScanHashJoin(HashJoinState *node)
 {
+#ifdef __TBASE__
+    /*
+     * Producers may keep a filter sent for the previous scan, do not ship
+     * filters which could be mixed up.
+     */
+    node->hj_FilterNKeys = 0;
+#endif
+
     /*
      * In a multi-batch join, we currently have to do rescans the hard way,
      * primarily because batch temp files may have already been released. But
@@ -1952,3 +1982,85 @@ ParallelHashJoinEreport(void)
     }
 }
 #endif
+
+#ifdef __TBASE__
+/*
+ * ExecHashJoinFilterKeys
+ *
+ * Check if a runtime join filter could be shipped to the producers of the
+ * outer RemoteSubplan, and remember the outer key columns if so. Only joins
+ * where an outer tuple without a partner is not returned qualify.
+ */
+static void
+ExecHashJoinFilterKeys(HashJoin *node, HashJoinState *hjstate)
+{
+    PlanState  *outerNode = outerPlanState(hjstate);
+    ListCell   *l;
+    int         nkeys = 0;
+
+    hjstate->hj_FilterNKeys = 0;
+
+    if (!enable_runtime_join_filter || !IS_PGXC_DATANODE ||
+        IsParallelWorker() ||
+        hjstate->js.ps.state->es_plannedstmt->parallelModeNeeded)
+        return;
+
+    if (node->join.jointype != JOIN_INNER &&
+        node->join.jointype != JOIN_SEMI &&
+        node->join.jointype != JOIN_RIGHT)
+        return;
+
+    if (!IsA(outerNode, RemoteSubplanState) ||
+        ((RemoteSubplanState *) outerNode)->local_exec ||
+        ((RemoteSubplan *) outerNode->plan)->cursor == NULL)
+        return;
+
+    if (list_length(node->hashclauses) > SQUEUE_FILTER_MAX_KEYS)
+        return;
+
+    foreach(l, node->hashclauses)
+    {
+        OpExpr     *hclause = lfirst_node(OpExpr, l);
+        Var        *var = (Var *) linitial(hclause->args);
+
+        if (!IsA(var, Var) || var->varno != OUTER_VAR || var->varattno <= 0)
+            return;
+        hjstate->hj_FilterKeys[nkeys++] = var->varattno;
+    }
+
+    hjstate->hj_FilterNKeys = nkeys;
+}
+
+/*
+ * ExecHashJoinPushFilter
+ *
+ * Ship the filter built along with the hash table to the outer producers.
+ * Filter is not worth it if most of the bits are set.
+ */
+static void
+ExecHashJoinPushFilter(HashJoinState *hjstate, SQueueFilter *filter)
+{
+    HashJoinTable hashtable = hjstate->hj_HashTable;
+    int           i;
+
+    if (hashtable->totalTuples == 0 && !HJ_FILL_OUTER(hjstate))
+        return;
+
+    if (hashtable->totalTuples * 8 > filter->nbits)
+    {
+        elog(DEBUG1, "runtime join filter skipped, %.0f inner tuples for %d bits",
+             hashtable->totalTuples, filter->nbits);
+        return;
+    }
+
+    filter->nkeys = hjstate->hj_FilterNKeys;
+    for (i = 0; i < filter->nkeys; i++)
+    {
+        filter->keys[i] = hjstate->hj_FilterKeys[i];
+        filter->hashfuncs[i] = hashtable->outer_hashfunctions[i].fn_oid;
+    }
+
+    ExecRemoteSubplanSetFilter((RemoteSubplanState *) outerPlanState(hjstate),
+                               filter);
+}
+#endif
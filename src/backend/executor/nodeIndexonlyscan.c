@@ -30,6 +30,7 @@
  */
 #include "postgres.h"
 
+#include "access/heapam.h"
 #include "access/relscan.h"
 #include "access/visibilitymap.h"
 #include "executor/execdebug.h"
@@ -123,9 +124,44 @@ IndexOnlyNext(IndexOnlyScanState *node)
     while ((tid = index_getnext_tid(scandesc, direction)) != NULL)
     {
         HeapTuple    tuple = NULL;
+#ifdef _SHARDING_
+        bool        shard_unknown = false;
+#endif
 
         CHECK_FOR_INTERRUPTS();
 
+#ifdef _SHARDING_
+        /*
+         * If the snapshot may hide shards, the shard of the tuple is needed
+         * as well.  With extents it follows from the TID: all tuples of an
+         * extent belong to the extent's shard.  Hidden tuples are dropped
+         * here without touching the heap; if the shard can't be told this
+         * way, the heap visit below checks it.
+         */
+        if (node->ioss_FilterShards)
+        {
+            if (RelationHasExtent(scandesc->heapRelation))
+            {
+                ExtentID    eid;
+
+                eid = (ExtentID) (ItemPointerGetBlockNumber(tid) / PAGES_PER_EXTENTS);
+                if (eid != node->ioss_ShardEid)
+                {
+                    node->ioss_ShardEid = eid;
+                    node->ioss_ShardHidden =
+                        heap_extent_shard_hidden(scandesc->heapRelation,
+                                                 scandesc->xs_snapshot, eid,
+                                                 &node->ioss_ShardKnown);
+                }
+                if (node->ioss_ShardHidden)
+                    continue;
+                shard_unknown = !node->ioss_ShardKnown;
+            }
+            else
+                shard_unknown = true;
+        }
+#endif
+
         /*
          * We can skip the heap fetch if the TID references a heap page on
          * which all tuples are known visible to everybody.  In any case,
@@ -161,7 +197,8 @@ IndexOnlyNext(IndexOnlyScanState *node)
          * the VM buffer, which could cause significant contention.
          */
 #ifdef __TBASE__
-        if (!VM_ALL_VISIBLE(scandesc->heapRelation,
+        if (shard_unknown ||
+            !VM_ALL_VISIBLE(scandesc->heapRelation,
                             ItemPointerGetBlockNumber(tid),
                             &node->ioss_VMBuffer) || NeedMvcc())
 #else
@@ -552,6 +589,14 @@ ExecInitIndexOnlyScan(IndexOnlyScan *node, EState *estate, int eflags)
     indexstate->ss.ss_currentRelation = currentRelation;
     indexstate->ss.ss_currentScanDesc = NULL;    /* no heap scan here */
 
+#ifdef _SHARDING_
+    indexstate->ioss_FilterShards =
+        heap_snapshot_filters_shards(currentRelation, estate->es_snapshot);
+    indexstate->ioss_ShardEid = InvalidExtentID;
+    indexstate->ioss_ShardHidden = false;
+    indexstate->ioss_ShardKnown = false;
+#endif
+
     /*
      * Build the scan tuple type using the indextlist generated by the
      * planner.  We use this, rather than the index's physical tuple
@@ -61,7 +61,11 @@ ExecMaterial(PlanState *pstate)
      */
     if (tuplestorestate == NULL && node->eflags != 0)
     {
+#ifdef __TBASE__
+        tuplestorestate = tuplestore_begin_heap(true, false, ExecWorkMem(estate));
+#else
         tuplestorestate = tuplestore_begin_heap(true, false, work_mem);
+#endif
         tuplestore_set_eflags(tuplestorestate, node->eflags);
         if (node->eflags & EXEC_FLAG_MARK)
         {
@@ -432,14 +432,6 @@ ExecInsert(ModifyTableState *mtstate,
         {
             elog(ERROR, "inserted value is not in range of partitioned table, please check the value of paritition key");
         }
-        
-		partname = GetPartitionName(RelationGetRelid(resultRelInfo->ri_RelationDesc), partidx, false);
-		partoid = get_relname_relid(partname, RelationGetNamespace(resultRelInfo->ri_RelationDesc));
-		if(InvalidOid == partoid)
-		{
-			/* the partition have dropped */
-			elog(ERROR, "inserted value is not in range of partitioned table, please check the value of paritition key");
-		}
 
         switch(resultRelInfo->arraymode)
         { 
@@ -460,6 +452,27 @@ ExecInsert(ModifyTableState *mtstate,
                 break;
         }
 
+        /*
+         * children opened by InitResultRelInfo are locked and can not be
+         * dropped under us, only check the catalog for the other ones.
+         */
+        if (partRel == NULL || partRel->part_index != partidx)
+        {
+            partname = GetPartitionName(RelationGetRelid(resultRelInfo->ri_RelationDesc), partidx, false);
+            partoid = get_relname_relid(partname, RelationGetNamespace(resultRelInfo->ri_RelationDesc));
+            if(InvalidOid == partoid)
+            {
+                /* the partition have dropped */
+                elog(ERROR, "inserted value is not in range of partitioned table, please check the value of paritition key");
+            }
+
+            if (partRel == NULL)
+            {
+                elog(ERROR, "internal error: partition %d of \"%s\" is not opened for insert",
+                     partidx, RelationGetRelationName(resultRelationDesc));
+            }
+        }
+
         if (arbiterIndexes)
         {
             int partidx = partRel->part_index;
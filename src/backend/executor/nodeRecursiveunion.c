@@ -122,7 +122,11 @@ ExecRecursiveUnion(PlanState *pstate)
 
             /* create new empty intermediate table */
             node->intermediate_table = tuplestore_begin_heap(false, false,
+#ifdef __TBASE__
+                                                             ExecWorkMem(node->ps.state));
+#else
                                                              work_mem);
+#endif
             node->intermediate_empty = true;
 
             /* reset the recursive term */
@@ -184,8 +188,13 @@ ExecInitRecursiveUnion(RecursiveUnion *node, EState *estate, int eflags)
     /* initialize processing state */
     rustate->recursing = false;
     rustate->intermediate_empty = true;
+#ifdef __TBASE__
+    rustate->working_table = tuplestore_begin_heap(false, false, ExecWorkMem(estate));
+    rustate->intermediate_table = tuplestore_begin_heap(false, false, ExecWorkMem(estate));
+#else
     rustate->working_table = tuplestore_begin_heap(false, false, work_mem);
     rustate->intermediate_table = tuplestore_begin_heap(false, false, work_mem);
+#endif
 
     /*
      * If hashing, we need a per-tuple memory context for comparisons, and a
@@ -38,7 +38,25 @@
 #ifdef __AUDIT_FGA__
 #include "audit/audit_fga.h"
 #endif
+#ifdef _SHARDING_
+#include "pgxc/locator.h"
+#include "pgxc/pgxc.h"
+#include "pgxc/shardmap.h"
+#include "access/stratnum.h"
+#include "storage/bufmgr.h"
+#include "storage/extent_zonemap.h"
+#include "storage/extentmapping.h"
+#include "utils/array.h"
+#include "utils/lsyscache.h"
+#include "utils/typcache.h"
+#endif
+
+#ifdef _SHARDING_
+bool		enable_parallel_shard_scan = true;
 
+static ExtentID *SeqScanShardExtents(SeqScanState *node, int *nextents);
+static ExtentZoneFilter *SeqScanZoneFilter(SeqScanState *node);
+#endif
 
 static bool InitScanRelation(SeqScanState *node, EState *estate, int eflags);
 static TupleTableSlot *SeqNext(SeqScanState *node);
@@ -80,6 +98,10 @@ SeqNext(SeqScanState *node)
 		scandesc = heap_beginscan(node->ss.ss_currentRelation,
 								  estate->es_snapshot,
 								  0, NULL);
+#ifdef _SHARDING_
+		if (node->zonefilter)
+			heap_setzonefilter(scandesc, node->zonefilter);
+#endif
 		if(enable_distri_print)
 		{
 			elog(LOG, "seq scan snapshot local %d start ts "INT64_FORMAT " rel %s", estate->es_snapshot->local,
@@ -285,6 +307,10 @@ ExecInitSeqScan(SeqScan *node, EState *estate, int eflags)
 		return NULL;
 	}
 
+#ifdef _SHARDING_
+	scanstate->zonefilter = SeqScanZoneFilter(scanstate);
+#endif
+
 	/*
 	 * Initialize result tuple type and projection info.
 	 */
@@ -377,6 +403,13 @@ ExecSeqScanEstimate(SeqScanState *node,
 {
 	EState	   *estate = node->ss.ps.state;
 
+#ifdef _SHARDING_
+	node->pscan_extents = SeqScanShardExtents(node, &node->pscan_nextents);
+	if (node->pscan_extents)
+		node->pscan_len = heap_parallelscan_estimate_extents(estate->es_snapshot,
+															  node->pscan_nextents);
+	else
+#endif
 	node->pscan_len = heap_parallelscan_estimate(estate->es_snapshot);
 	shm_toc_estimate_chunk(&pcxt->estimator, node->pscan_len);
 	shm_toc_estimate_keys(&pcxt->estimator, 1);
@@ -396,12 +429,25 @@ ExecSeqScanInitializeDSM(SeqScanState *node,
 	ParallelHeapScanDesc pscan;
 
 	pscan = shm_toc_allocate(pcxt->toc, node->pscan_len);
+#ifdef _SHARDING_
+	if (node->pscan_extents)
+		heap_parallelscan_initialize_extents(pscan,
+											 node->ss.ss_currentRelation,
+											 estate->es_snapshot,
+											 node->pscan_extents,
+											 node->pscan_nextents);
+	else
+#endif
 	heap_parallelscan_initialize(pscan,
 								 node->ss.ss_currentRelation,
 								 estate->es_snapshot);
 	shm_toc_insert(pcxt->toc, node->ss.ps.plan->plan_node_id, pscan);
 	node->ss.ss_currentScanDesc =
 		heap_beginscan_parallel(node->ss.ss_currentRelation, pscan);
+#ifdef _SHARDING_
+	if (node->zonefilter)
+		heap_setzonefilter(node->ss.ss_currentScanDesc, node->zonefilter);
+#endif
 }
 
 /* ----------------------------------------------------------------
@@ -434,4 +480,371 @@ ExecSeqScanInitializeWorker(SeqScanState *node,
 	pscan = shm_toc_lookup(pwcxt->toc, node->ss.ps.plan->plan_node_id, false);
 	node->ss.ss_currentScanDesc =
 		heap_beginscan_parallel(node->ss.ss_currentRelation, pscan);
+#ifdef _SHARDING_
+	if (node->zonefilter)
+		heap_setzonefilter(node->ss.ss_currentScanDesc, node->zonefilter);
+#endif
+}
+
+#ifdef _SHARDING_
+/*
+ * Shards the qual restricts the distribution key to, or NULL if it does not.
+ * Handles "diskey = const" and "diskey = ANY (const array)".
+ */
+static Bitmapset *
+SeqScanQualShards(Relation rel, Index scanrelid, AttrNumber diskey, Expr *qual)
+{
+	Oid			distype = RelationGetDescr(rel)->attrs[diskey - 1]->atttypid;
+	Oid			opno;
+	Node	   *lexpr;
+	Node	   *rexpr;
+	Var		   *var;
+	Const	   *con;
+	Bitmapset  *shards = NULL;
+
+	if (IsA(qual, OpExpr) && list_length(((OpExpr *) qual)->args) == 2)
+	{
+		opno = ((OpExpr *) qual)->opno;
+		lexpr = linitial(((OpExpr *) qual)->args);
+		rexpr = lsecond(((OpExpr *) qual)->args);
+
+		/* the Var may be on either side */
+		if (IsA(rexpr, Var))
+		{
+			Node	   *tmp = lexpr;
+
+			lexpr = rexpr;
+			rexpr = tmp;
+		}
+	}
+	else if (IsA(qual, ScalarArrayOpExpr) && ((ScalarArrayOpExpr *) qual)->useOr)
+	{
+		opno = ((ScalarArrayOpExpr *) qual)->opno;
+		lexpr = linitial(((ScalarArrayOpExpr *) qual)->args);
+		rexpr = lsecond(((ScalarArrayOpExpr *) qual)->args);
+	}
+	else
+		return NULL;
+
+	if (!IsA(lexpr, Var) || !IsA(rexpr, Const))
+		return NULL;
+	var = (Var *) lexpr;
+	con = (Const *) rexpr;
+	if (var->varno != scanrelid || var->varattno != diskey ||
+		var->varlevelsup != 0 || con->constisnull)
+		return NULL;
+
+	if (!op_mergejoinable(opno, distype) && !op_hashjoinable(opno, distype))
+		return NULL;
+
+	if (IsA(qual, OpExpr))
+	{
+		/* the value must be hashed the same way it was on insert */
+		if (con->consttype != distype)
+			return NULL;
+		shards = bms_add_member(shards,
+								EvaluateShardId(distype, false, con->constvalue,
+												InvalidOid, true, (Datum) 0,
+												RelationGetRelid(rel)));
+	}
+	else
+	{
+		ArrayType  *arr = DatumGetArrayTypeP(con->constvalue);
+		int16		typlen;
+		bool		typbyval;
+		char		typalign;
+		Datum	   *values;
+		bool	   *nulls;
+		int			nvalues;
+		int			i;
+
+		if (ARR_ELEMTYPE(arr) != distype)
+			return NULL;
+
+		get_typlenbyvalalign(distype, &typlen, &typbyval, &typalign);
+		deconstruct_array(arr, distype, typlen, typbyval, typalign,
+						  &values, &nulls, &nvalues);
+		for (i = 0; i < nvalues; i++)
+		{
+			/* NULL never matches, no shard to scan for it */
+			if (nulls[i])
+				continue;
+			shards = bms_add_member(shards,
+									EvaluateShardId(distype, false, values[i],
+													InvalidOid, true, (Datum) 0,
+													RelationGetRelid(rel)));
+		}
+
+		/* all NULLs, nothing matches; one shard is as good as none */
+		if (shards == NULL)
+			shards = bms_make_singleton(NullShardId);
+	}
+
+	return shards;
 }
+
+/*
+ * SeqScanShardExtents
+ *
+ * If the scan quals pin the distribution key of a shard table, collect the
+ * extents of the selected shards so a parallel scan reads only those instead
+ * of the whole relation. Returns NULL if the whole relation has to be read.
+ */
+static ExtentID *
+SeqScanShardExtents(SeqScanState *node, int *nextents)
+{
+	Relation	rel = node->ss.ss_currentRelation;
+	Index		scanrelid = ((Scan *) node->ss.ps.plan)->scanrelid;
+	AttrNumber	diskey;
+	Bitmapset  *shards = NULL;
+	ExtentID   *extents;
+	BlockNumber nblocks;
+	int			n = 0;
+	ListCell   *lc;
+
+	*nextents = 0;
+
+	if (!enable_parallel_shard_scan || !IS_PGXC_DATANODE ||
+		!RelationHasExtent(rel) || rel->rd_locator_info == NULL ||
+		rel->rd_locator_info->locatorType != LOCATOR_TYPE_SHARD)
+		return NULL;
+
+	/* the shard of a two-key table depends on both keys */
+	diskey = RelationGetDisKey(rel);
+	if (diskey <= 0 || diskey > RelationGetDescr(rel)->natts ||
+		RelationGetSecDisKey(rel) != InvalidAttrNumber)
+		return NULL;
+
+	foreach(lc, node->ss.ps.plan->qual)
+	{
+		shards = SeqScanQualShards(rel, scanrelid, diskey, (Expr *) lfirst(lc));
+		if (shards)
+			break;
+	}
+	if (shards == NULL)
+		return NULL;
+
+	extents = GetShardsScanExtents(rel, shards, &n);
+	bms_free(shards);
+	if (extents == NULL)
+		return NULL;
+
+	nblocks = RelationGetNumberOfBlocks(rel);
+
+	/* the shards cover the relation, a plain parallel scan does as well */
+	if ((uint64) n * PAGES_PER_EXTENTS >= nblocks && n > 0)
+	{
+		pfree(extents);
+		return NULL;
+	}
+
+	elog(DEBUG1, "parallel scan of relation %s limited to %d extents",
+		 RelationGetRelationName(rel), n);
+
+	*nextents = n;
+	return extents;
+}
+
+/* narrow the range of a zone filter key to values below or above v */
+static void
+SeqScanZoneKeyHi(ExtentZoneKey *key, int64 v, bool incl)
+{
+	if (!key->has_hi || v < key->hi || (v == key->hi && !incl))
+	{
+		key->has_hi = true;
+		key->hi = v;
+		key->hi_incl = incl;
+	}
+}
+
+static void
+SeqScanZoneKeyLo(ExtentZoneKey *key, int64 v, bool incl)
+{
+	if (!key->has_lo || v > key->lo || (v == key->lo && !incl))
+	{
+		key->has_lo = true;
+		key->lo = v;
+		key->lo_incl = incl;
+	}
+}
+
+/*
+ * Add the range a qual restricts a column to to the zone filter. Handles
+ * "col op const" with a btree comparison operator of the column type and
+ * "col = ANY (const array)".
+ */
+static void
+SeqScanZoneQual(Index scanrelid, Expr *qual, ExtentZoneFilter *filter)
+{
+	Oid			opno;
+	Node	   *lexpr;
+	Node	   *rexpr;
+	Var		   *var;
+	Const	   *con;
+	Oid			valtype;
+	int			strategy;
+	ExtentZoneKey *key = NULL;
+	int			i;
+
+	if (IsA(qual, OpExpr) && list_length(((OpExpr *) qual)->args) == 2)
+	{
+		opno = ((OpExpr *) qual)->opno;
+		lexpr = linitial(((OpExpr *) qual)->args);
+		rexpr = lsecond(((OpExpr *) qual)->args);
+
+		/* "const op col" is "col commutator const" */
+		if (IsA(rexpr, Var))
+		{
+			Node	   *tmp = lexpr;
+
+			lexpr = rexpr;
+			rexpr = tmp;
+			opno = get_commutator(opno);
+			if (!OidIsValid(opno))
+				return;
+		}
+	}
+	else if (IsA(qual, ScalarArrayOpExpr) && ((ScalarArrayOpExpr *) qual)->useOr)
+	{
+		opno = ((ScalarArrayOpExpr *) qual)->opno;
+		lexpr = linitial(((ScalarArrayOpExpr *) qual)->args);
+		rexpr = lsecond(((ScalarArrayOpExpr *) qual)->args);
+	}
+	else
+		return;
+
+	if (!IsA(lexpr, Var) || !IsA(rexpr, Const))
+		return;
+	var = (Var *) lexpr;
+	con = (Const *) rexpr;
+	if (var->varno != scanrelid || var->varattno <= 0 ||
+		var->varlevelsup != 0 || con->constisnull ||
+		!ZoneMapTypeSupported(var->vartype))
+		return;
+
+	valtype = IsA(qual, OpExpr) ? con->consttype :
+		ARR_ELEMTYPE(DatumGetArrayTypeP(con->constvalue));
+	if (!ZoneMapTypesComparable(var->vartype, valtype))
+		return;
+
+	/* the ordering of the summaries is the one of the default btree opclass */
+	strategy = get_op_opfamily_strategy(opno,
+					lookup_type_cache(var->vartype,
+									  TYPECACHE_BTREE_OPFAMILY)->btree_opf);
+	if (strategy == 0 ||
+		(IsA(qual, ScalarArrayOpExpr) && strategy != BTEqualStrategyNumber))
+		return;
+
+	for (i = 0; i < filter->nkeys; i++)
+	{
+		if (filter->keys[i].attnum == var->varattno)
+		{
+			key = &filter->keys[i];
+			break;
+		}
+	}
+	if (key == NULL)
+	{
+		if (filter->nkeys >= ZONEMAP_MAX_COLUMNS)
+			return;
+		key = &filter->keys[filter->nkeys++];
+		memset(key, 0, sizeof(ExtentZoneKey));
+		key->attnum = var->varattno;
+		key->typid = var->vartype;
+	}
+
+	if (IsA(qual, OpExpr))
+	{
+		int64		v = ZoneMapDatumGetInt64(valtype, con->constvalue);
+
+		switch (strategy)
+		{
+			case BTLessStrategyNumber:
+				SeqScanZoneKeyHi(key, v, false);
+				break;
+			case BTLessEqualStrategyNumber:
+				SeqScanZoneKeyHi(key, v, true);
+				break;
+			case BTEqualStrategyNumber:
+				SeqScanZoneKeyLo(key, v, true);
+				SeqScanZoneKeyHi(key, v, true);
+				break;
+			case BTGreaterEqualStrategyNumber:
+				SeqScanZoneKeyLo(key, v, true);
+				break;
+			case BTGreaterStrategyNumber:
+				SeqScanZoneKeyLo(key, v, false);
+				break;
+		}
+	}
+	else
+	{
+		ArrayType  *arr = DatumGetArrayTypeP(con->constvalue);
+		int16		typlen;
+		bool		typbyval;
+		char		typalign;
+		Datum	   *values;
+		bool	   *nulls;
+		int			nvalues;
+		bool		any = false;
+		int64		minv = 0;
+		int64		maxv = 0;
+
+		get_typlenbyvalalign(valtype, &typlen, &typbyval, &typalign);
+		deconstruct_array(arr, valtype, typlen, typbyval, typalign,
+						  &values, &nulls, &nvalues);
+		for (i = 0; i < nvalues; i++)
+		{
+			int64		v;
+
+			if (nulls[i])
+				continue;
+			v = ZoneMapDatumGetInt64(valtype, values[i]);
+			if (!any || v < minv)
+				minv = v;
+			if (!any || v > maxv)
+				maxv = v;
+			any = true;
+		}
+
+		/* nothing but NULLs is left to the quals themselves */
+		if (any)
+		{
+			SeqScanZoneKeyLo(key, minv, true);
+			SeqScanZoneKeyHi(key, maxv, true);
+		}
+	}
+}
+
+/*
+ * SeqScanZoneFilter
+ *
+ * Collect the ranges the scan quals restrict integer and datetime columns
+ * of a shard table to, so the scan can step over extents whose zone maps
+ * lie outside of them. Returns NULL if the quals give no such range.
+ */
+static ExtentZoneFilter *
+SeqScanZoneFilter(SeqScanState *node)
+{
+	Relation	rel = node->ss.ss_currentRelation;
+	Index		scanrelid = ((Scan *) node->ss.ps.plan)->scanrelid;
+	ExtentZoneFilter *filter;
+	ListCell   *lc;
+
+	if (extent_zonemap_entries <= 0 || !IS_PGXC_DATANODE ||
+		!RelationHasExtent(rel) || node->ss.ps.plan->qual == NIL)
+		return NULL;
+
+	filter = (ExtentZoneFilter *) palloc0(sizeof(ExtentZoneFilter));
+	foreach(lc, node->ss.ps.plan->qual)
+		SeqScanZoneQual(scanrelid, (Expr *) lfirst(lc), filter);
+
+	if (filter->nkeys == 0)
+	{
+		pfree(filter);
+		return NULL;
+	}
+
+	return filter;
+}
+#endif
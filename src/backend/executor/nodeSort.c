@@ -139,7 +139,11 @@ ExecSort(PlanState *pstate)
                                               plannode->sortOperators,
                                               plannode->collations,
                                               plannode->nullsFirst,
+#ifdef __TBASE__
+                                              ExecWorkMem(estate),
+#else
                                               work_mem,
+#endif
                                               node->randomAccess);
         if (node->bounded)
             tuplesort_set_bound(tuplesortstate, node->bound);
@@ -1094,7 +1094,12 @@ begin_partition(WindowAggState *winstate)
     }
 
     /* Create new tuplestore for this partition */
+#ifdef __TBASE__
+    winstate->buffer = tuplestore_begin_heap(false, false,
+                                             ExecWorkMem(winstate->ss.ps.state));
+#else
     winstate->buffer = tuplestore_begin_heap(false, false, work_mem);
+#endif
 
     /*
      * Set up read pointers for the tuplestore.  The current pointer doesn't
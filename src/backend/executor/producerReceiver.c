@@ -48,6 +48,11 @@ typedef struct
 #ifdef __TBASE__
     uint64      send_tuples;        /* number of tuples sent to remote */
     TimestampTz send_total_time;    /* total time to send tuples */
+    SQueueFilterCache *filters;     /* runtime join filters of consumers */
+    SQueueFilterCache *selffilter;  /* runtime join filter of self consumer */
+    long        filtered;           /* tuples dropped by the filters */
+    long       *conscount;          /* tuples sent to each consumer */
+    int         nconscount;         /* length of conscount */
 #endif
 } ProducerState;
 
@@ -144,6 +149,14 @@ producerReceiveSlot(TupleTableSlot *slot, DestReceiver *self)
         else if (consumerIdx == SQ_CONS_SELF)
         {
             Assert(myState->consumer);
+#ifdef __TBASE__
+            if (myState->selffilter &&
+                !SQueueFilterMatch(myState->selffilter, slot))
+            {
+                myState->filtered++;
+                continue;
+            }
+#endif
             (*myState->consumer->receiveSlot) (slot, myState->consumer);
             myState->selfcount++;
         }
@@ -158,6 +171,15 @@ producerReceiveSlot(TupleTableSlot *slot, DestReceiver *self)
             MemoryContext savecontext;
             Assert(ActivePortal);
             savecontext = MemoryContextSwitchTo(PortalGetHeapMemory(ActivePortal));
+#ifdef __TBASE__
+            if (!SharedQueueFilterTuple(myState->squeue, consumerIdx, slot,
+                                        &myState->filters))
+            {
+                MemoryContextSwitchTo(savecontext);
+                myState->filtered++;
+                continue;
+            }
+#endif
             if (g_UseDataPump)
             {
                 TimestampTz begin = 0;
@@ -187,6 +209,10 @@ producerReceiveSlot(TupleTableSlot *slot, DestReceiver *self)
             }
             MemoryContextSwitchTo(savecontext);
             myState->othercount++;
+#ifdef __TBASE__
+            if (consumerIdx < myState->nconscount)
+                myState->conscount[consumerIdx]++;
+#endif
         }
     }
 
@@ -226,6 +252,45 @@ producerDestroyReceiver(DestReceiver *self)
 
     elog(DEBUG2, "Producer stats: total %ld tuples, %ld tuples to self, %ld to other nodes",
          myState->tcount, myState->selfcount, myState->othercount);
+#ifdef __TBASE__
+    if (myState->filtered)
+        elog(DEBUG2, "Producer stats: %ld tuples dropped by runtime join filters",
+             myState->filtered);
+    if (myState->conscount)
+    {
+        int        hot = -1;
+        long    hotcount;
+        int        i;
+
+        /* Self consumer counts as one more target of the redistribution */
+        hotcount = myState->selfcount;
+        for (i = 0; i < myState->nconscount; i++)
+        {
+            if (myState->conscount[i] > hotcount)
+            {
+                hot = i;
+                hotcount = myState->conscount[i];
+            }
+        }
+
+        /*
+         * Flag a redistribution where one target got more than twice its
+         * fair share of rows, it is likely hashing a hot key.
+         */
+        if (hotcount > 2 * (myState->selfcount + myState->othercount) /
+                       (myState->nconscount + 1) && hotcount > 1000)
+        {
+            if (hot < 0)
+                elog(DEBUG1, "Producer stats: skewed redistribution, %ld of %ld tuples to self",
+                     hotcount, myState->selfcount + myState->othercount);
+            else
+                elog(DEBUG1, "Producer stats: skewed redistribution, %ld of %ld tuples to consumer %d",
+                     hotcount, myState->selfcount + myState->othercount, hot);
+        }
+        pfree(myState->conscount);
+        myState->conscount = NULL;
+    }
+#endif
 
     if (myState->consumer)
     {
@@ -301,6 +366,11 @@ CreateProducerDestReceiver(void)
     self->send_tuples     = 0;
     self->send_total_time = 0;
     self->nodeMap = NULL;
+    self->filters = NULL;
+    self->selffilter = NULL;
+    self->filtered = 0;
+    self->conscount = NULL;
+    self->nconscount = 0;
 #endif
 
     return (DestReceiver *) self;
@@ -336,8 +406,13 @@ SetProducerDestReceiverParams(DestReceiver *self,
     myState->distNodes = (int *) getLocatorResults(locator);
     if (squeue)
 #ifdef __TBASE__
+    {
         myState->tstores = (Tuplestorestate **)
             palloc0(getLocatorNodeCount(locator) * sizeof(Tuplestorestate *));
+        myState->nconscount = getLocatorNodeCount(locator);
+        myState->conscount = (long *)
+            palloc0(myState->nconscount * sizeof(long));
+    }
 #else
         myState->tstores = (Tuplestorestate **)
             palloc0(NumDataNodes * sizeof(Tuplestorestate *));
@@ -414,4 +489,17 @@ SetProducerNodeMap(DestReceiver *self, int16 *nodemap)
 
     memcpy(myState->nodeMap, nodemap, sizeof(int16) * MAX_NODES_NUMBER);
 }
+
+/*
+ * Set runtime join filter for tuples kept for self consumer
+ */
+void
+SetProducerSelfFilter(DestReceiver *self, SQueueFilterCache *filter)
+{
+    ProducerState *myState = (ProducerState *) self;
+
+    Assert(myState->pub.mydest == DestProducer);
+    if (myState->selffilter == NULL)
+        myState->selffilter = filter;
+}
 #endif
@@ -1167,6 +1167,64 @@ pq_getbyte_if_available(unsigned char *c)
     return r;
 }
 
+#ifdef __TBASE__
+/* --------------------------------
+ *        pq_peekbyte_if_available - peek at the next byte from connection,
+ *            if available, without consuming it
+ *
+ * Same return convention as pq_getbyte_if_available.
+ * --------------------------------
+ */
+int
+pq_peekbyte_if_available(unsigned char *c)
+{
+    int            r;
+
+    Assert(PqCommReadingMsg);
+
+    if (PqRecvPointer < PqRecvLength)
+    {
+        *c = PqRecvBuffer[PqRecvPointer];
+        return 1;
+    }
+
+    /* buffer is empty, read what is there into it */
+    PqRecvPointer = 0;
+    PqRecvLength = 0;
+
+    /* Put the socket into non-blocking mode */
+    socket_set_nonblocking(true);
+
+    r = secure_read(MyProcPort, PqRecvBuffer, PQ_RECV_BUFFER_SIZE);
+    if (r < 0)
+    {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            r = 0;
+        else
+        {
+            /* must go *only* to the postmaster log, see above */
+            ereport(COMMERROR,
+                    (errcode_for_socket_access(),
+                     errmsg("could not receive data from client: %m")));
+            r = EOF;
+        }
+    }
+    else if (r == 0)
+    {
+        /* EOF detected */
+        r = EOF;
+    }
+    else
+    {
+        PqRecvLength = r;
+        *c = PqRecvBuffer[0];
+        r = 1;
+    }
+
+    return r;
+}
+#endif
+
 /* --------------------------------
  *        pq_getbytes        - get a known number of bytes from connection
  *
@@ -294,6 +294,8 @@ _copyAppend(const Append *from)
     COPY_NODE_FIELD(appendplans);
 #ifdef __TBASE__
     COPY_SCALAR_FIELD(interval);
+    COPY_SCALAR_FIELD(interval_parent);
+    COPY_NODE_FIELD(interval_prune_quals);
 #endif
 
     return newnode;
@@ -520,6 +522,9 @@ _copySampleScan(const SampleScan *from)
      * copy remainder of node
      */
     COPY_NODE_FIELD(tablesample);
+#ifdef __TBASE__
+    COPY_SCALAR_FIELD(cluster_tuples);
+#endif
 
     return newnode;
 }
@@ -1360,6 +1365,7 @@ _copyExecNodes(const ExecNodes *from)
     COPY_NODE_FIELD(en_expr);
 #ifdef __COLD_HOT__
     COPY_NODE_FIELD(sec_en_expr);
+    COPY_SCALAR_FIELD(cold_pruned);
 #endif
     COPY_SCALAR_FIELD(en_relid);
     COPY_SCALAR_FIELD(accesstype);
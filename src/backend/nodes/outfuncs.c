@@ -706,6 +706,15 @@ _outAppend(StringInfo str, const Append *node)
     WRITE_NODE_FIELD(appendplans);
 #ifdef __TBASE__
     WRITE_BOOL_FIELD(interval);
+    if (portable_output)
+    {
+        WRITE_RELID_FIELD(interval_parent);
+    }
+    else
+    {
+        WRITE_OID_FIELD(interval_parent);
+    }
+    WRITE_NODE_FIELD(interval_prune_quals);
 #endif
 }
 
@@ -923,6 +932,9 @@ _outSampleScan(StringInfo str, const SampleScan *node)
     _outScanInfo(str, (const Scan *) node);
 
     WRITE_NODE_FIELD(tablesample);
+#ifdef __TBASE__
+    WRITE_FLOAT_FIELD(cluster_tuples, "%.0f");
+#endif
 }
 
 static void
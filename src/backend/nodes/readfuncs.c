@@ -2424,6 +2424,15 @@ _readAppend(void)
     READ_NODE_FIELD(appendplans);
 #ifdef __TBASE__
     READ_BOOL_FIELD(interval);
+    if (portable_input)
+    {
+        READ_RELID_FIELD(interval_parent);
+    }
+    else
+    {
+        READ_OID_FIELD(interval_parent);
+    }
+    READ_NODE_FIELD(interval_prune_quals);
 #endif
 
     READ_DONE();
@@ -2631,6 +2640,9 @@ _readSampleScan(void)
     ReadCommonScan(&local_node->scan);
 
     READ_NODE_FIELD(tablesample);
+#ifdef __TBASE__
+    READ_FLOAT_FIELD(cluster_tuples);
+#endif
 
     READ_DONE();
 }
@@ -2316,6 +2316,20 @@ set_worktable_pathlist(PlannerInfo *root, RelOptInfo *rel, RangeTblEntry *rte)
     required_outer = rel->lateral_relids;
 
     /* Generate appropriate path */
+#ifdef __TBASE__
+    if (cteroot->wt_distribution)
+    {
+        Path         *path = create_worktablescan_path(root, rel, required_outer);
+        Distribution *distribution = copyObject(cteroot->wt_distribution);
+        Var          *var = (Var *) distribution->distributionExpr;
+
+        /* work table rows stay on the datanode of their key */
+        var->varno = var->varnoold = rel->relid;
+        path->distribution = distribution;
+        add_path(rel, path);
+        return;
+    }
+#endif
     add_path(rel, create_worktablescan_path(root, rel, required_outer));
 }
 
@@ -4204,6 +4204,112 @@ approx_tuple_count(PlannerInfo *root, JoinPath *path, List *quals)
 }
 
 
+#ifdef __TBASE__
+/*
+ * Interval partition pruning only looks at the restrictions of the table
+ * itself. When its partition key is equated with a column of another base
+ * relation, the range restrictions on that column bound the key as well,
+ * e.g. "f.ts = d.ts AND d.ts >= c" means only children of f with ts >= c can
+ * join. Build such restrictions on the partition key, for pruning purpose
+ * only, the same way equivalence classes propagate constants.
+ */
+static List *
+get_interval_derived_prune_quals(PlannerInfo *root, RelOptInfo *rel, Relation relation)
+{// #lizard forgives
+    List       *result = NIL;
+    AttrNumber  partkey;
+    Oid         parttype;
+    ListCell   *lc_ec;
+
+    partkey  = RelationGetPartitionColumnIndex(relation);
+    parttype = relation->rd_att->attrs[partkey - 1]->atttypid;
+
+    foreach(lc_ec, root->eq_classes)
+    {
+        EquivalenceClass *ec = (EquivalenceClass *) lfirst(lc_ec);
+        Var        *partvar = NULL;
+        ListCell   *lc_em;
+
+        if (ec->ec_has_volatile || ec->ec_below_outer_join ||
+            list_length(ec->ec_members) < 2)
+            continue;
+
+        /* is the partition key of this relation in the class */
+        foreach(lc_em, ec->ec_members)
+        {
+            EquivalenceMember *em = (EquivalenceMember *) lfirst(lc_em);
+            Var        *var = (Var *) em->em_expr;
+
+            if (em->em_is_child || !bms_is_empty(em->em_nullable_relids) ||
+                !IsA(var, Var))
+                continue;
+
+            if (var->varno == rel->relid && var->varattno == partkey &&
+                var->varlevelsup == 0)
+            {
+                partvar = var;
+                break;
+            }
+        }
+
+        if (partvar == NULL)
+            continue;
+
+        /* take the restrictions of the other members with the same type */
+        foreach(lc_em, ec->ec_members)
+        {
+            EquivalenceMember *em = (EquivalenceMember *) lfirst(lc_em);
+            Var        *var = (Var *) em->em_expr;
+            RelOptInfo *other;
+            ListCell   *lc_ri;
+
+            if (em->em_is_child || !bms_is_empty(em->em_nullable_relids) ||
+                !IsA(var, Var))
+                continue;
+
+            if (var->varno == rel->relid || var->varlevelsup != 0 ||
+                var->vartype != parttype ||
+                var->varno >= root->simple_rel_array_size)
+                continue;
+
+            other = root->simple_rel_array[var->varno];
+            if (other == NULL || other->reloptkind != RELOPT_BASEREL)
+                continue;
+
+            foreach(lc_ri, other->baserestrictinfo)
+            {
+                RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc_ri);
+                OpExpr     *op = (OpExpr *) rinfo->clause;
+                Node       *larg;
+                Node       *rarg;
+                OpExpr     *newop;
+
+                if (!IsA(op, OpExpr) || list_length(op->args) != 2)
+                    continue;
+
+                larg = (Node *) linitial(op->args);
+                rarg = (Node *) lsecond(op->args);
+
+                newop = (OpExpr *) copyObject(op);
+                if (IsA(larg, Var) && equal(larg, var) && IsA(rarg, Const))
+                    linitial(newop->args) = copyObject(partvar);
+                else if (IsA(rarg, Var) && equal(rarg, var) && IsA(larg, Const))
+                    lsecond(newop->args) = copyObject(partvar);
+                else
+                {
+                    pfree(newop);
+                    continue;
+                }
+
+                result = lappend(result, newop);
+            }
+        }
+    }
+
+    return result;
+}
+#endif
+
 /*
  * set_baserel_size_estimates
  *        Set the size estimates for the given base relation.
@@ -4235,7 +4341,15 @@ set_baserel_size_estimates(PlannerInfo *root, RelOptInfo *rel)
         relation = heap_open(rte->relid, AccessShareLock);
 
         //pruning
-        rel->childs = RelationGetPartitionsByQuals(relation, rel->baserestrictinfo);
+        {
+            List *derived = get_interval_derived_prune_quals(root, rel, relation);
+
+            if (derived)
+                rel->childs = RelationGetPartitionsByQuals(relation,
+                                        list_concat(list_copy(rel->baserestrictinfo), derived));
+            else
+                rel->childs = RelationGetPartitionsByQuals(relation, rel->baserestrictinfo);
+        }
 
 #ifdef __COLD_HOT__
         /* only datanode and SELECT command need to prune hot data */
@@ -4275,6 +4389,19 @@ set_baserel_size_estimates(PlannerInfo *root, RelOptInfo *rel)
 
             bms_free(bmscopy);
         }
+        else
+        {
+            int     nparts = RelationGetNParts(relation);
+            int     nchilds = bms_num_members(rel->childs);
+
+            /*
+             * Pages of the parent are summed over all the partitions, while
+             * only the remaining ones are to be scanned.
+             */
+            if (nparts > 0 && nchilds < nparts)
+                rel->pages = (BlockNumber)
+                    ceil((double) rel->pages * nchilds / nparts);
+        }
 
         heap_close(relation, AccessShareLock);
     }
@@ -5349,15 +5476,51 @@ page_size(double tuples, int width)
 }
 
 #ifdef XCP
+/*
+ * Bytes sent per tuple besides its data: the DataRow message header and
+ * the length words of a few columns.
+ */
+#define REMOTE_TUPLE_OVERHEAD    24
+
+/*
+ * remote_subplan_fanout
+ *    How many times the average tuple crosses the network when it is
+ *    shipped to "nodes" with the given distribution type.
+ *
+ * Gathering to a single consumer sends every tuple once. Broadcasting sends
+ * every tuple to each of the target nodes. Redistributing by value sends a
+ * tuple to one node, and with N target nodes about 1/N of the tuples are
+ * already where they belong.
+ */
+static double
+remote_subplan_fanout(char distributionType, Bitmapset *nodes)
+{
+    int            nnodes;
+
+    if (nodes == NULL)
+        return 1.0;
+
+    nnodes = bms_num_members(nodes);
+    if (IsLocatorReplicated(distributionType) ||
+        IsLocatorNone(distributionType))
+        return (double) nnodes;
+
+    if (nnodes > 1)
+        return (double) (nnodes - 1) / nnodes;
+    return 1.0;
+}
+
 void
 cost_remote_subplan(Path *path,
               Cost input_startup_cost, Cost input_total_cost,
-			  double tuples, int width, int replication)
+			  double tuples, int width,
+			  char distributionType, Bitmapset *nodes)
 {
     Cost        startup_cost = input_startup_cost + remote_query_cost;
     Cost        run_cost = input_total_cost - input_startup_cost;
+    double        nbytes;
 
-	path->rows = tuples * replication;
+	path->rows = tuples * calcDistReplications(distributionType, nodes);
 
     /*
      * Charge 2x cpu_operator_cost per tuple to reflect bookkeeping overhead.
@@ -5365,9 +5528,12 @@ cost_remote_subplan(Path *path,
 	run_cost += 2 * cpu_operator_cost * tuples;
 
     /*
-     * Estimate cost of sending data over network
+     * Estimate cost of sending data over network, by the bytes the chosen
+     * strategy puts on the wire.
      */
-	run_cost += network_byte_cost * tuples * width * replication;
+	nbytes = tuples * (width + REMOTE_TUPLE_OVERHEAD) *
+		remote_subplan_fanout(distributionType, nodes);
+	run_cost += network_byte_cost * nbytes;
 
     path->startup_cost = startup_cost;
     path->total_cost = startup_cost + run_cost;
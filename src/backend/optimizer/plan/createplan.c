@@ -343,6 +343,8 @@ static int add_sort_column(AttrNumber colIdx, Oid sortOp, Oid coll,
 static double GetPlanRows(Plan *plan);
 static bool set_plan_parallel(Plan *plan);
 static void set_plan_nonparallel(Plan *plan);
+static bool contain_extern_param_walker(Node *node, void *context);
+static List *get_interval_runtime_prune_quals(RelOptInfo *rel);
 
 #endif
 static RemoteSubplan *find_push_down_plan(Plan *plan, bool force);
@@ -1028,6 +1030,8 @@ create_scan_plan(PlannerInfo *root, Path *best_path, int flags)
                     Append *append = NULL;
                     append = make_append(scanlist, tlist, NULL);
                     append->interval = true;
+                    append->interval_parent = RelationGetRelid(relation);
+                    append->interval_prune_quals = get_interval_runtime_prune_quals(rel);
                     append->plan.parallel_aware = best_path->parallel_aware;
                     plan = (Plan *)append;
                 }
@@ -2876,6 +2880,19 @@ create_recursiveunion_plan(PlannerInfo *root, RecursiveUnionPath *best_path)
     leftplan = create_plan_recurse(root, best_path->leftpath, CP_EXACT_TLIST);
     rightplan = create_plan_recurse(root, best_path->rightpath, CP_EXACT_TLIST);
 
+#ifdef __TBASE__
+    /*
+     * Each datanode runs the recursion on its own work table, so rows of the
+     * recursive term must never be sent to another node.
+     */
+    if (best_path->path.distribution &&
+        IsLocatorDistributedByValue(best_path->path.distribution->distributionType) &&
+        contain_remote_subplan_walker((Node *) rightplan, NULL, false))
+        ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                 errmsg("WITH RECURSIVE on distributed tables requires the recursive term to stay on the datanode of its key")));
+#endif
+
     tlist = build_path_tlist(root, &best_path->path);
 
     /* Convert numGroups to long int --- but 'ware overflow! */
@@ -3394,6 +3411,19 @@ create_samplescan_plan(PlannerInfo *root, Path *best_path,
                                 scan_relid,
                                 tsc);
 
+#ifdef __TBASE__
+    /*
+     * Each datanode samples its own part of a distributed table. Tell them
+     * how big the whole table is, so that methods asking for a number of
+     * rows rather than a percentage can return their share only.
+     */
+    if (best_path->distribution &&
+        !IsLocatorReplicated(best_path->distribution->distributionType) &&
+        bms_is_empty(best_path->distribution->restrictNodes) &&
+        bms_num_members(best_path->distribution->nodes) > 1)
+        scan_plan->cluster_tuples = best_path->parent->tuples;
+#endif
+
 #ifdef __AUDIT_FGA__
     if (enable_fga && g_commandTag && (strcmp(g_commandTag, "SELECT") == 0))
     {
@@ -9572,11 +9602,41 @@ set_plan_parallel(Plan *plan)
         case T_SeqScan:
         case T_IndexScan:
         case T_IndexOnlyScan:
-        case T_RemoteSubplan:
             {
                 plan->parallel_aware = true;
                 result = true;
             }
+            break;
+        case T_RemoteSubplan:
+            {
+                /*
+                 * Workers split the producing nodes among themselves, which
+                 * needs a redistribution from all of them; reading from a
+                 * single replica can not be divided.
+                 */
+                if (((RemoteSubplan *) plan)->execOnAll)
+                {
+                    plan->parallel_aware = true;
+                    result = true;
+                }
+            }
+            break;
+        case T_Result:
+            {
+                /*
+                 * A projection on top of a parallel input stays parallel.
+                 * Without an input every worker would emit the row, and a
+                 * volatile gating qual could pass in some workers only.
+                 */
+                Result *resplan = (Result *) plan;
+
+                if (plan->lefttree && resplan->resconstantqual == NULL &&
+                    set_plan_parallel(plan->lefttree))
+                {
+                    plan->parallel_aware = true;
+                    result = true;
+                }
+            }
             break;
 		case T_BitmapHeapScan:
 			{
@@ -9762,3 +9822,38 @@ set_plan_nonparallel(Plan *plan)
 }
 #endif
 
+#ifdef __TBASE__
+static bool
+contain_extern_param_walker(Node *node, void *context)
+{
+    if (node == NULL)
+        return false;
+
+    if (IsA(node, Param))
+        return ((Param *) node)->paramkind == PARAM_EXTERN;
+
+    return expression_tree_walker(node, contain_extern_param_walker, context);
+}
+
+/*
+ * Restrictions of an interval partitioned table comparing with external
+ * params can not prune children at plan time in a generic plan. Keep them
+ * so that the executor can prune once the param values are known.
+ */
+static List *
+get_interval_runtime_prune_quals(RelOptInfo *rel)
+{
+    List       *result = NIL;
+    ListCell   *lc;
+
+    foreach(lc, rel->baserestrictinfo)
+    {
+        RestrictInfo *rinfo = lfirst_node(RestrictInfo, lc);
+
+        if (contain_extern_param_walker((Node *) rinfo->clause, NULL))
+            result = lappend(result, copyObject(rinfo->clause));
+    }
+
+    return result;
+}
+#endif
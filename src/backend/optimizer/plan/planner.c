@@ -52,6 +52,7 @@
 #include "parser/analyze.h"
 #include "parser/parsetree.h"
 #include "parser/parse_agg.h"
+#include "parser/parse_oper.h"
 #include "rewrite/rewriteManip.h"
 #include "storage/dsm_impl.h"
 #include "utils/rel.h"
@@ -79,6 +80,7 @@ create_upper_paths_hook_type create_upper_paths_hook = NULL;
 
 #ifdef __TBASE__
 bool olap_optimizer = false;
+bool enable_distinct_agg_dedup = true;
 #endif
 
 /* Expression kind codes for preprocess_expression */
@@ -200,11 +202,14 @@ static bool groupingsets_distribution_match(PlannerInfo *root, Query *parse,
 static Path *adjust_path_distribution(PlannerInfo *root, Query *parse,
                       Path *path);
 static bool can_push_down_grouping(PlannerInfo *root, Query *parse, Path *path);
-static bool can_push_down_window(PlannerInfo *root, Path *path);
+static bool can_push_down_window(PlannerInfo *root, Path *path,
+                                 WindowClause *wc);
 static void adjust_paths_for_srfs(PlannerInfo *root, RelOptInfo *rel,
                       List *targets, List *targets_contain_srfs);
 #ifdef __TBASE__
 static Path *adjust_modifytable_subpath(PlannerInfo *root, Query *parse, Path *path);
+static Path *create_distinct_agg_dedup_path(PlannerInfo *root, Path *path,
+                               const AggClauseCosts *agg_costs);
 #endif
 
 /*****************************************************************************
@@ -1044,7 +1049,12 @@ subquery_planner(PlannerGlobal *glob, Query *parse,
         root->recursiveOk = recursiveOk;
 
     if (root->hasRecursion && !root->recursiveOk)
+    {
+#ifdef __TBASE__
+        if (!root->recursiveDistributed)
+#endif
             elog(ERROR, "WITH RECURSIVE currently not supported on distributed tables.");
+    }
 
     return root;
 }
@@ -4330,7 +4340,10 @@ create_grouping_paths(PlannerInfo *root,
                     {
                         if (agg_costs->hasOnlyDistinct && olap_optimizer && !parse->groupingSets
                             && !has_cold_hot_table)
+                        {
+                            path = create_distinct_agg_dedup_path(root, path, agg_costs);
                             path = create_redistribute_grouping_path(root, parse, path);
+                        }
                         else
                             path = create_remotesubplan_path(root, path, NULL);
 
@@ -5020,7 +5033,10 @@ create_grouping_paths(PlannerInfo *root,
                         !olap_optimizer || has_cold_hot_table)
                     {
                         if (agg_costs->hasOnlyDistinct && olap_optimizer && !has_cold_hot_table)
+                        {
+                            path = create_distinct_agg_dedup_path(root, path, agg_costs);
                             path = create_redistribute_grouping_path(root, parse, path);
+                        }
                         else
                             path = create_remotesubplan_path(root, path, NULL);
                     }
@@ -6246,6 +6262,24 @@ create_one_window_path(PlannerInfo *root,
                                                    wc,
                                                    tlist);
 
+#ifdef __TBASE__
+        /*
+         * Window partitions spread across datanodes could be brought together
+         * by redistributing the input by a partition key, instead of
+         * computing the whole window on the coordinator.
+         */
+        if (olap_optimizer && !has_cold_hot_table && path->distribution &&
+            wc->partitionClause && !can_push_down_window(root, path, wc))
+        {
+            Path *redistribute = create_redistribute_window_path(root,
+                                                                 root->parse,
+                                                                 path, wc);
+
+            if (redistribute)
+                path = redistribute;
+        }
+#endif
+
         /* Sort if necessary */
         if (!pathkeys_contained_in(window_pathkeys, path->pathkeys))
         {
@@ -6282,8 +6316,11 @@ create_one_window_path(PlannerInfo *root,
             window_target = output_target;
         }
 
-        /* We can't really push down window functions for now. */
-        if (!can_push_down_window(root, path))
+        /*
+         * Window functions are pushed down only if every partition lives on
+         * a single datanode.
+         */
+        if (!can_push_down_window(root, path, wc))
             path = create_remotesubplan_path(root, path, NULL);
 
         path = (Path *)
@@ -8024,7 +8061,7 @@ can_push_down_grouping(PlannerInfo *root, Query *parse, Path *path)
 }
 
 static bool
-can_push_down_window(PlannerInfo *root, Path *path)
+can_push_down_window(PlannerInfo *root, Path *path, WindowClause *wc)
 {
 #ifdef __COLD_HOT__
     if (has_cold_hot_table)
@@ -8042,9 +8079,114 @@ can_push_down_window(PlannerInfo *root, Path *path)
     if (! path->distribution)
         return true;
 
-    return false;
+    /* partitions never span datanodes if partitioned by distribution key */
+    return grouping_distribution_match(root, root->parse, path,
+                                       wc->partitionClause);
 }
 #ifdef __TBASE__
+/*
+ * create_distinct_agg_dedup_path
+ *      Drop duplicate input rows on the datanodes when all aggregates of the
+ *      query are DISTINCT aggregates.
+ *
+ * Such aggregates only depend on the set of distinct input rows per group, so
+ * duplicates of a whole input row can be removed with a hashed Agg before the
+ * rows are redistributed or shipped to the coordinator for the final
+ * aggregation. For count(DISTINCT x) over a large fact table this ships the
+ * distinct values per datanode instead of every row.
+ */
+static Path *
+create_distinct_agg_dedup_path(PlannerInfo *root, Path *path,
+                               const AggClauseCosts *agg_costs)
+{// #lizard forgives
+    Query          *parse = root->parse;
+    PathTarget     *target;
+    List           *groupClause = NIL;
+    List           *groupExprs = NIL;
+    Index           maxref = 0;
+    ListCell       *lc;
+    int             i;
+    double          dNumGroups;
+    AggClauseCosts  dedup_costs;
+    Size            hashsize;
+
+    if (!enable_distinct_agg_dedup || !path->distribution ||
+        agg_costs->numAggs == 0 ||
+        agg_costs->numOrderedAggs != agg_costs->numAggs ||
+        parse->groupingSets)
+        return path;
+
+    target = copy_pathtarget(path->pathtarget);
+    if (target->sortgrouprefs == NULL)
+        target->sortgrouprefs = (Index *)
+            palloc0(list_length(target->exprs) * sizeof(Index));
+
+    /* the refs we add must not clash with the ones of the query */
+    foreach(lc, parse->targetList)
+        maxref = Max(maxref, ((TargetEntry *) lfirst(lc))->ressortgroupref);
+    for (i = 0; i < list_length(target->exprs); i++)
+        maxref = Max(maxref, target->sortgrouprefs[i]);
+
+    /* group by every input column */
+    i = 0;
+    foreach(lc, target->exprs)
+    {
+        Node            *expr = (Node *) lfirst(lc);
+        SortGroupClause *sgc;
+        Oid              sortop;
+        Oid              eqop;
+        bool             hashable;
+
+        get_sort_group_operators(exprType(expr), false, false, false,
+                                 &sortop, &eqop, NULL, &hashable);
+        if (!OidIsValid(eqop) || !hashable)
+            return path;
+
+        if (target->sortgrouprefs[i] == 0)
+            target->sortgrouprefs[i] = ++maxref;
+
+        sgc = makeNode(SortGroupClause);
+        sgc->tleSortGroupRef = target->sortgrouprefs[i];
+        sgc->eqop = eqop;
+        sgc->sortop = sortop;
+        sgc->nulls_first = false;
+        sgc->hashable = true;
+
+        groupClause = lappend(groupClause, sgc);
+        groupExprs = lappend(groupExprs, expr);
+        i++;
+    }
+
+    if (groupClause == NIL)
+        return path;
+
+    /* only worth it if it removes at least half of the rows */
+    dNumGroups = estimate_num_groups(root, groupExprs, path->rows, NULL);
+    if (dNumGroups * 2 > path->rows)
+        return path;
+
+    MemSet(&dedup_costs, 0, sizeof(AggClauseCosts));
+    hashsize = estimate_hashagg_tablesize(path, &dedup_costs, dNumGroups);
+    if (hashsize >= work_mem * 1024L && !g_hybrid_hash_agg)
+        return path;
+
+    path = (Path *) create_projection_path(root, path->parent, path, target);
+    path = (Path *) create_agg_path(root,
+                                    path->parent,
+                                    path,
+                                    target,
+                                    AGG_HASHED,
+                                    AGGSPLIT_SIMPLE,
+                                    groupClause,
+                                    NIL,
+                                    NULL,
+                                    dNumGroups);
+    if (hashsize >= work_mem * 1024L)
+        ((AggPath *) path)->hybrid = true;
+
+    return path;
+}
+
 static Path *
 adjust_modifytable_subpath(PlannerInfo *root, Query *parse, Path *path)
 {
@@ -100,6 +100,7 @@
 #ifdef __TBASE__
 #include <math.h>
 #include "nodes/pg_list.h"
+#include "optimizer/tlist.h"
 #include "parser/parse_oper.h"
 #include "parser/parse_func.h"
 #include "catalog/pg_aggregate.h"
@@ -184,6 +185,8 @@ static Node * get_or_exist_subquery_targetlist(PlannerInfo *root, Node *node,
 			  List **targetList, List **joinClause, int *next_attno);
 static bool is_simple_subquery(Query *subquery, JoinExpr *lowest_outer_join,
 			  bool deletion_ok);
+static JoinExpr *convert_EXISTS_agg_sublink_to_join(PlannerInfo *root,
+			  Query *subselect, bool under_not, Relids available_rels);
 #endif
 /*
  * Select a PARAM_EXEC number to identify the given Var as a parameter for
@@ -2552,7 +2555,16 @@ convert_EXISTS_sublink_to_join(PlannerInfo *root, SubLink *sublink,
      * with noplace to evaluate the targetlist.
      */
     if (!simplify_EXISTS_query(root, subselect))
+    {
+#ifdef __TBASE__
+        /* grouped sub-select with HAVING may still become a join */
+        if (enable_pullup_subquery)
+            return convert_EXISTS_agg_sublink_to_join(root, subselect,
+                                                      under_not,
+                                                      available_rels);
+#endif
         return NULL;
+    }
 
     /*
      * The subquery must have a nonempty jointree, else we won't have a join.
@@ -2662,6 +2674,247 @@ convert_EXISTS_sublink_to_join(PlannerInfo *root, SubLink *sublink,
 }
 
 #ifdef __TBASE__
+/*
+ * convert_EXISTS_agg_sublink_to_join: try to convert an EXISTS SubLink whose
+ * sub-select has GROUP BY and HAVING into a join, e.g.
+ *
+ *    EXISTS (SELECT 1 FROM t WHERE t.a = o.a GROUP BY t.b HAVING count(*) > 1)
+ *
+ * becomes a semi join (anti join for NOT EXISTS) on o.a = "EXISTS_subquery".a
+ * against
+ *
+ *    SELECT t.a FROM t GROUP BY t.b, t.a HAVING count(*) > 1
+ *
+ * Each correlation clause must be an equality between an outer expression and
+ * an inner one, using the equality operator the inner expression is grouped
+ * by. Then the groups of the sub-select for a given outer row are exactly the
+ * groups of the new sub-select with that key, so it is evaluated once instead
+ * of once per outer row, and only its keys are joined.
+ *
+ * The subselect is expected to be a fresh copy that we can munge up.
+ */
+static JoinExpr *
+convert_EXISTS_agg_sublink_to_join(PlannerInfo *root, Query *subselect,
+                                   bool under_not, Relids available_rels)
+{// #lizard forgives
+    Query       *parse = root->parse;
+    Node        *whereClause;
+    List        *newWhere = NIL;
+    List        *joinops = NIL;
+    List        *outerargs = NIL;
+    List        *outerleft = NIL;
+    List        *tlist = NIL;
+    List        *subquery_vars;
+    List        *quals = NIL;
+    ListCell    *lc;
+    ListCell    *jc;
+    ListCell    *oc;
+    List        *groupClause;
+    Index        maxref = 0;
+    AttrNumber   resno = 1;
+    Relids       upper_varnos;
+    ParseState  *pstate;
+    RangeTblEntry *rte;
+    RangeTblRef *rtr;
+    JoinExpr    *result;
+
+    /*
+     * Without GROUP BY an aggregate over no rows still returns one row, so
+     * the correlation can not be turned into grouping keys.
+     */
+    if (subselect->commandType != CMD_SELECT ||
+        subselect->groupClause == NIL ||
+        subselect->havingQual == NULL ||
+        subselect->setOperations ||
+        subselect->groupingSets ||
+        subselect->hasWindowFuncs ||
+        subselect->hasTargetSRFs ||
+        subselect->hasModifyingCTE ||
+        subselect->hasSubLinks ||
+        subselect->limitOffset ||
+        subselect->limitCount ||
+        subselect->rowMarks ||
+        subselect->cteList ||
+        subselect->jointree->fromlist == NIL)
+        return NULL;
+
+    /*
+     * Separate out the WHERE clause, the rest of the sub-select must not
+     * refer to the parent query.
+     */
+    whereClause = subselect->jointree->quals;
+    subselect->jointree->quals = NULL;
+
+    if (contain_vars_of_level((Node *) subselect, 1) ||
+        contain_vars_upper_level(whereClause, 1) ||
+        contain_volatile_functions(whereClause))
+        return NULL;
+
+    whereClause = eval_const_expressions(root, whereClause);
+    whereClause = (Node *) canonicalize_qual((Expr *) whereClause);
+    whereClause = (Node *) make_ands_implicit((Expr *) whereClause);
+
+    groupClause = subselect->groupClause;
+    foreach(lc, subselect->targetList)
+    {
+        TargetEntry *tle = (TargetEntry *) lfirst(lc);
+
+        maxref = Max(maxref, tle->ressortgroupref);
+    }
+
+    foreach(lc, (List *) whereClause)
+    {
+        Node       *clause = (Node *) lfirst(lc);
+        OpExpr     *expr = (OpExpr *) clause;
+        Node       *leftarg;
+        Node       *rightarg;
+        Node       *inner;
+        Node       *outer;
+        Oid         sortop;
+        Oid         eqop;
+        bool        hashable;
+        SortGroupClause *sgc;
+        TargetEntry *tle;
+
+        if (!contain_vars_of_level(clause, 1))
+        {
+            newWhere = lappend(newWhere, clause);
+            continue;
+        }
+
+        if (!IsA(clause, OpExpr) || list_length(expr->args) != 2)
+            return NULL;
+
+        leftarg = (Node *) linitial(expr->args);
+        rightarg = (Node *) lsecond(expr->args);
+
+        if (!contain_vars_of_level(leftarg, 0) &&
+            !contain_vars_of_level(rightarg, 1))
+        {
+            outer = leftarg;
+            inner = rightarg;
+        }
+        else if (!contain_vars_of_level(rightarg, 0) &&
+                 !contain_vars_of_level(leftarg, 1))
+        {
+            outer = rightarg;
+            inner = leftarg;
+        }
+        else
+            return NULL;
+
+        if (exprType(outer) != exprType(inner))
+            return NULL;
+
+        if (parse->hasAggs && contain_aggs_of_level(outer, 1))
+            return NULL;
+
+        get_sort_group_operators(exprType(inner),
+                                 false, false, false,
+                                 &sortop, &eqop, NULL,
+                                 &hashable);
+        if (!OidIsValid(eqop) || eqop != expr->opno)
+            return NULL;
+
+        /* group by the inner expression as well, and return it */
+        tle = makeTargetEntry((Expr *) inner, resno++, NULL, false);
+        tle->ressortgroupref = ++maxref;
+        tlist = lappend(tlist, tle);
+
+        sgc = makeNode(SortGroupClause);
+        sgc->tleSortGroupRef = tle->ressortgroupref;
+        sgc->eqop = eqop;
+        sgc->sortop = sortop;
+        sgc->nulls_first = false;
+        sgc->hashable = hashable;
+        subselect->groupClause = lappend(subselect->groupClause, sgc);
+
+        joinops = lappend(joinops, expr);
+        outerargs = lappend(outerargs, outer);
+        outerleft = lappend_int(outerleft, outer == leftarg);
+    }
+
+    if (joinops == NIL)
+        return NULL;
+
+    /*
+     * The old target list is only needed for the GROUP BY keys it holds,
+     * which stay as resjunk columns behind the new keys.
+     */
+    foreach(lc, subselect->targetList)
+    {
+        TargetEntry *tle = (TargetEntry *) lfirst(lc);
+
+        if (tle->ressortgroupref == 0 ||
+            get_sortgroupref_clause_noerr(tle->ressortgroupref,
+                                          groupClause) == NULL)
+            continue;
+
+        tle = flatCopyTargetEntry(tle);
+        tle->resno = resno++;
+        tle->resjunk = true;
+        tlist = lappend(tlist, tle);
+    }
+
+    subselect->targetList = tlist;
+    subselect->jointree->quals = newWhere ?
+        (Node *) make_ands_explicit(newWhere) : NULL;
+    subselect->sortClause = NIL;
+    subselect->distinctClause = NIL;
+    subselect->windowClause = NIL;
+    subselect->hasDistinctOn = false;
+
+    /*
+     * Only the outer sides of the join clauses remain in the parent query,
+     * and they can only refer to available_rels.
+     */
+    IncrementVarSublevelsUp((Node *) outerargs, -1, 1);
+    upper_varnos = pull_varnos((Node *) outerargs);
+    if (bms_is_empty(upper_varnos) ||
+        !bms_is_subset(upper_varnos, available_rels))
+        return NULL;
+
+    /* Create a dummy ParseState for addRangeTableEntryForSubquery */
+    pstate = make_parsestate(NULL);
+
+    rte = addRangeTableEntryForSubquery(pstate,
+                                        subselect,
+                                        makeAlias("EXISTS_subquery", NIL),
+                                        false,
+                                        false);
+    parse->rtable = lappend(parse->rtable, rte);
+
+    rtr = makeNode(RangeTblRef);
+    rtr->rtindex = list_length(parse->rtable);
+
+    subquery_vars = generate_subquery_vars(root, subselect->targetList,
+                                           rtr->rtindex);
+
+    /* compare the outer expressions with the returned keys */
+    forthree(jc, joinops, lc, subquery_vars, oc, outerleft)
+    {
+        OpExpr *expr = (OpExpr *) lfirst(jc);
+
+        if (lfirst_int(oc))
+            lsecond(expr->args) = lfirst(lc);
+        else
+            linitial(expr->args) = lfirst(lc);
+        quals = lappend(quals, expr);
+    }
+
+    result = makeNode(JoinExpr);
+    result->jointype = under_not ? JOIN_ANTI : JOIN_SEMI;
+    result->isNatural = false;
+    result->larg = NULL;        /* caller must fill this in */
+    result->rarg = (Node *) rtr;
+    result->usingClause = NIL;
+    result->quals = (Node *) make_ands_explicit(quals);
+    result->alias = NULL;
+    result->rtindex = 0;        /* we don't need an RTE for it */
+
+    return result;
+}
+
 /*
   * try to convert an expr SubLink to a join
   */
@@ -4327,7 +4580,15 @@ simplify_EXISTS_query(PlannerInfo *root, Query *query)
      */
     if (query->commandType != CMD_SELECT ||
         query->setOperations ||
+#ifdef __TBASE__
+        /*
+         * Aggregates under GROUP BY without HAVING don't change the number of
+         * groups, so they are dropped along with the targetlist below.
+         */
+        (query->hasAggs && query->groupClause == NIL) ||
+#else
         query->hasAggs ||
+#endif
         query->groupingSets ||
         query->hasWindowFuncs ||
         query->hasTargetSRFs ||
@@ -4384,6 +4645,9 @@ simplify_EXISTS_query(PlannerInfo *root, Query *query)
     query->distinctClause = NIL;
     query->sortClause = NIL;
     query->hasDistinctOn = false;
+#ifdef __TBASE__
+    query->hasAggs = false;
+#endif
 
     return true;
 }
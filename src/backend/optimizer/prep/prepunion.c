@@ -51,6 +51,9 @@
 #include "utils/lsyscache.h"
 #include "utils/rel.h"
 #include "utils/selfuncs.h"
+#ifdef __TBASE__
+#include "pgxc/locator.h"
+#endif
 
 
 typedef struct
@@ -475,6 +478,106 @@ strip_remote_subquery(PlannerInfo *root, Path *path)
     return path;
 }
 
+#ifdef __TBASE__
+/*
+ * Is the set operation arm distributed by its output column attno?
+ */
+static bool
+setop_column_is_distkey(Path *path, List *colTypes, AttrNumber attno)
+{
+    Distribution *distribution = path->distribution;
+    PlannerInfo  *subroot;
+    ListCell     *lc;
+
+    if (!IsA(path, SubqueryScanPath) || distribution == NULL ||
+        !IsLocatorDistributedByValue(distribution->distributionType) ||
+        distribution->distributionExpr == NULL)
+        return false;
+
+    subroot = path->parent->subroot;
+    foreach(lc, subroot->processed_tlist)
+    {
+        TargetEntry *tle = (TargetEntry *) lfirst(lc);
+
+        if (tle->resjunk || tle->resno != attno)
+            continue;
+
+        /* a coerced column is hashed differently */
+        if (exprType((Node *) tle->expr) != list_nth_oid(colTypes, attno - 1))
+            return false;
+
+        return equal(tle->expr, distribution->distributionExpr) ||
+               exprs_known_equal(subroot, (Node *) tle->expr,
+                                 distribution->distributionExpr);
+    }
+
+    return false;
+}
+
+/*
+ * If the non-recursive term is distributed by one of its output columns,
+ * the work table can be distributed the same way: every datanode keeps the
+ * rows of its own keys in a local work table. Returns the distribution of the
+ * work table, with a Var of varno 0 for the key column, or NULL.
+ */
+static Distribution *
+recursion_worktable_distribution(SetOperationStmt *setOp, Path *lpath)
+{
+    Distribution *distribution;
+    AttrNumber    attno;
+    int           numCols = list_length(setOp->colTypes);
+
+    for (attno = 1; attno <= numCols; attno++)
+    {
+        if (setop_column_is_distkey(lpath, setOp->colTypes, attno))
+            break;
+    }
+
+    if (attno > numCols)
+        return NULL;
+
+    distribution = makeNode(Distribution);
+    distribution->distributionType = lpath->distribution->distributionType;
+    distribution->nodes = bms_copy(lpath->distribution->nodes);
+    distribution->restrictNodes = NULL;
+    distribution->distributionExpr = (Node *)
+        makeVar(0, attno,
+                list_nth_oid(setOp->colTypes, attno - 1),
+                list_nth_int(setOp->colTypmods, attno - 1),
+                list_nth_oid(setOp->colCollations, attno - 1),
+                0);
+
+    return distribution;
+}
+
+/*
+ * The recursion may run on the datanodes if the recursive term keeps its rows
+ * on the datanode of their key: it is distributed like the work table by the
+ * same output column, and does not move any rows between nodes.
+ */
+static bool
+recursion_is_colocated(SetOperationStmt *setOp, Path *rpath,
+                       Distribution *wt_distribution)
+{
+    Distribution *distribution = rpath->distribution;
+    Var          *var = (Var *) wt_distribution->distributionExpr;
+    int           nRemotePlans = 0;
+    bool          redistribute = false;
+
+    if (distribution == NULL ||
+        distribution->distributionType != wt_distribution->distributionType ||
+        !bms_equal(distribution->nodes, wt_distribution->nodes))
+        return false;
+
+    if (!setop_column_is_distkey(rpath, setOp->colTypes, var->varattno))
+        return false;
+
+    contains_remotesubplan(rpath, &nRemotePlans, &redistribute);
+
+    return nRemotePlans == 0 && !redistribute;
+}
+#endif
+
 /*
  * Generate path for a recursive UNION node
  */
@@ -509,6 +612,15 @@ generate_recursion_path(SetOperationStmt *setOp, PlannerInfo *root,
                                    refnames_tlist,
                                    &lpath_tlist,
                                    NULL);
+#ifdef __TBASE__
+    /*
+     * If the non-recursive term is distributed by one of its columns, plan the
+     * recursive term against a work table distributed the same way, so that
+     * the recursion may run on the datanodes.
+     */
+    lpath = strip_remote_subquery(root, lpath);
+    root->wt_distribution = recursion_worktable_distribution(setOp, lpath);
+#endif
     /* The right path will want to look at the left one ... */
     root->non_recursive_path = lpath;
     rpath = recurse_set_operations(setOp->rarg, root,
@@ -581,6 +693,18 @@ generate_recursion_path(SetOperationStmt *setOp, PlannerInfo *root,
     rpath = strip_remote_subquery(root, rpath);
     lpath = strip_remote_subquery(root, lpath);
 
+#ifdef __TBASE__
+    /*
+     * With distributed tables, each datanode runs the recursion on its own
+     * work table, and the results are gathered on top of the recursive union.
+     * This only works if rows produced by the recursive term never belong to
+     * another datanode, otherwise we refuse the query as before.
+     */
+    if (root->wt_distribution)
+        root->recursiveDistributed = recursion_is_colocated(setOp, rpath,
+                                                            root->wt_distribution);
+#endif
+
     /*
      * And make the path node.
      */
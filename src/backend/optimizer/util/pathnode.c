@@ -1417,7 +1417,6 @@ create_remotesubplan_path(PlannerInfo *root, Path *subpath,
 {
     RelOptInfo       *rel = subpath->parent;
     RemoteSubPath  *pathnode;
-	Distribution   *subDist = subpath->distribution;
 
     pathnode = makeNode(RemoteSubPath);
     pathnode->path.pathtype = T_RemoteSubplan;
@@ -1435,7 +1434,8 @@ create_remotesubplan_path(PlannerInfo *root, Path *subpath,
 
     cost_remote_subplan((Path *) pathnode, subpath->startup_cost,
                         subpath->total_cost, subpath->rows, rel->reltarget->width,
-						subDist ? calcDistReplications(subDist->distributionType, subDist->nodes) : 1);
+                        distribution ? distribution->distributionType : LOCATOR_TYPE_NONE,
+                        distribution ? distribution->nodes : NULL);
 
     return (Path *) pathnode;
 }
@@ -1503,7 +1503,7 @@ redistribute_path(PlannerInfo *root, Path *subpath, List *pathkeys,
 							subpath->total_cost,
 							subpath->rows,
 							rel->reltarget->width,
-							calcDistReplications(distributionType, nodes));
+							distributionType, nodes);
 
 		mpath->path.distribution = (Distribution *) copyObject(distribution);
         mpath->subpath = (Path *) pathnode;
@@ -1570,7 +1570,7 @@ redistribute_path(PlannerInfo *root, Path *subpath, List *pathkeys,
 							input_total_cost,
 							subpath->rows,
 							rel->reltarget->width,
-							calcDistReplications(distributionType, nodes));
+							distributionType, nodes);
         return (Path *) pathnode;
     }
 }
@@ -3198,6 +3198,107 @@ create_redistribute_grouping_path(PlannerInfo *root, Query *parse, Path *path)
     return NULL; /* keep compiler quiet */
 }
 
+/*
+ * create_redistribute_window_path
+ *      Redistribute the input of a window function by one of its PARTITION BY
+ *      keys, so that every window partition is computed on a single datanode.
+ *
+ * The partition key giving the most groups is chosen as distribution key.
+ * Returns NULL if none of the partition keys can be hash distributed.
+ */
+Path *
+create_redistribute_window_path(PlannerInfo *root, Query *parse, Path *path,
+                                WindowClause *wc)
+{
+    int i;
+    Bitmapset *nodes = NULL;
+    TargetEntry *te = NULL;
+    Oid group = InvalidOid;
+    double    num_groups = 0;
+    int       colIdx = -1;
+    AttrNumber *partColIdx;
+    List *partExprs;
+
+    if (wc->partitionClause == NIL)
+        return NULL;
+
+    partColIdx = extract_grouping_cols(wc->partitionClause,
+                                       parse->targetList);
+    partExprs = get_sortgrouplist_exprs(wc->partitionClause,
+                                        parse->targetList);
+
+    /* choose partition key which get max group numbers as distributed key */
+    for (i = 0; i < list_length(wc->partitionClause); i++)
+    {
+        List *expr = NULL;
+        double dNumGroups;
+        Node *partExpr = (Node *) list_nth(partExprs, i);
+
+        if (!IsTypeHashDistributable(exprType(partExpr)))
+            continue;
+
+        expr = lappend(expr, partExpr);
+
+        dNumGroups = estimate_num_groups(root, expr, path->rows, NULL);
+
+        if (dNumGroups > num_groups)
+        {
+            num_groups = dNumGroups;
+            colIdx = i;
+        }
+
+        list_free(expr);
+    }
+
+    list_free(partExprs);
+
+    if (colIdx < 0)
+        return NULL;
+
+    te = (TargetEntry *) list_nth(parse->targetList, partColIdx[colIdx] - 1);
+
+    if (groupOids)
+        group = linitial_oid(groupOids);
+
+    if (group == InvalidOid)
+    {
+        for (i = 0; i < NumDataNodes; i++)
+            nodes = bms_add_member(nodes, i);
+
+        path = redistribute_path(root,
+                                 path,
+                                 NULL,
+                                 LOCATOR_TYPE_HASH,
+                                 (Node *) te->expr,
+                                 nodes,
+                                 NULL);
+    }
+    else
+    {
+        ListCell *cell;
+        List *nodelist = GetGroupNodeList(group);
+
+        foreach(cell, nodelist)
+        {
+            int nodeid = lfirst_int(cell);
+
+            nodes = bms_add_member(nodes, nodeid);
+        }
+
+        path = redistribute_path(root,
+                                 path,
+                                 NULL,
+                                 LOCATOR_TYPE_SHARD,
+                                 (Node *) te->expr,
+                                 nodes,
+                                 NULL);
+    }
+
+    path->pathkeys = NULL;
+
+    return path;
+}
+
 static List *
 add_groups_to_list(bool has_baserestrictinfo, Oid          relid, RelationLocInfo *rel_loc_info, 
                           Node *dis_qual, List    *nodeList, Node *sec_quals)
@@ -3222,27 +3323,14 @@ add_groups_to_list(bool has_baserestrictinfo, Oid          relid, RelationLocInf
         /* meet distributed column quals */
         if (dis_qual)
         {
-            int16         typlen;
-            bool         typbyval;
-            char         typalign;
-            char         typdelim;
-            Oid          typioparam;
-            Oid          typiofunc;
             Oid          keyValueGroup;
             Oid          keyValueColdGroup;
-            char        *value;
             Const *const_expr = (Const *)dis_qual;
             
             /* check whether the value is key value */
-            get_type_io_data(const_expr->consttype, IOFunc_output,
-                             &typlen, &typbyval,
-                             &typalign, &typdelim,
-                             &typioparam, &typiofunc);
-            value = OidOutputFunctionCall(typiofunc, const_expr->constvalue);        
-            
-            keyValueGroup = GetKeyValuesGroup(MyDatabaseId, relid, value, &keyValueColdGroup);
-            pfree(value);
-            value = NULL;
+            keyValueGroup = GetKeyValuesGroupByDatum(relid, const_expr->consttype,
+                                                     const_expr->constvalue,
+                                                     &keyValueColdGroup);
 
             /* relation in key-value */
             if (OidIsValid(keyValueGroup))
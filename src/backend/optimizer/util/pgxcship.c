@@ -43,8 +43,18 @@
 #endif
 #ifdef __TBASE__
 #include "catalog/pg_constraint.h"
+#include "access/hash.h"
 #include "access/htup_details.h"
+#include "funcapi.h"
 #include "optimizer/pathnode.h"
+#include "utils/hsearch.h"
+#include "utils/inval.h"
+#include "utils/memutils.h"
+#include "utils/syscache.h"
+#include "catalog/namespace.h"
+#include "utils/array.h"
+#include "utils/builtins.h"
+#include "utils/regproc.h"
 #endif
 /*
  * Shippability_context
@@ -114,6 +124,9 @@ extern void PoolPingNodes(void);
 
 /* Determine if given function is shippable */
 static bool pgxc_is_func_shippable(Oid funcid);
+#ifdef __TBASE__
+static ExecNodes *pgxc_FQS_shard_local_function(Query *query);
+#endif
 /* Check equijoin conditions on given relations */
 static Expr *pgxc_find_dist_equijoin_qual(Relids varnos_1, Relids varnos_2,
                                 Oid distcol_type, Node *quals, List *rtable);
@@ -147,6 +160,7 @@ static bool pgxc_query_needs_coord(Query *query);
 static bool pgxc_query_contains_only_pg_catalog(List *rtable);
 static bool pgxc_is_var_distrib_column(Var *var, List *rtable);
 static bool pgxc_distinct_has_distcol(Query *query);
+static bool pgxc_window_has_distcol(Query *query);
 static bool pgxc_targetlist_has_distcol(Query *query);
 static ExecNodes *pgxc_FQS_find_datanodes_recurse(Node *node, Query *query,
                                             Bitmapset **relids);
@@ -1000,6 +1014,43 @@ pgxc_distinct_has_distcol(Query *query)
     return false;
 }
 
+/*
+ * pgxc_window_has_distcol
+ * Every window of the query is partitioned by a distribution column, so each
+ * partition lives on a single datanode.
+ */
+static bool
+pgxc_window_has_distcol(Query *query)
+{
+    ListCell    *lc;
+    ListCell    *lcell;
+
+    foreach (lc, query->windowClause)
+    {
+        WindowClause *wc = (WindowClause *) lfirst(lc);
+        bool          found = false;
+
+        foreach (lcell, wc->partitionClause)
+        {
+            SortGroupClause     *sgc = lfirst(lcell);
+            Node                *sgc_expr;
+            if (!IsA(sgc, SortGroupClause))
+                continue;
+            sgc_expr = get_sortgroupclause_expr(sgc, query->targetList);
+            if (IsA(sgc_expr, Var) && (((Var *)sgc_expr)->varlevelsup == 0) &&
+                pgxc_is_var_distrib_column((Var *)sgc_expr, query->rtable))
+            {
+                found = true;
+                break;
+            }
+        }
+
+        if (!found)
+            return false;
+    }
+    return true;
+}
+
 /*
  * pgxc_shippability_walker
  * walks the query/expression tree routed at the node passed in, gathering
@@ -1346,6 +1397,28 @@ pgxc_shippability_walker(Node *node, Shippability_context *sc_context)
             if (query->hasRecursive)
                 pgxc_set_shippability_reason(sc_context, SS_UNSUPPORTED_EXPR);
 
+#ifdef __TBASE__
+            /*
+             * A sample of a given number of rows taken on each datanode would
+             * return that many rows per node, let the planner split it.
+             */
+            {
+                ListCell *lc;
+
+                foreach(lc, query->rtable)
+                {
+                    RangeTblEntry *rte = (RangeTblEntry *) lfirst(lc);
+
+                    if (rte->rtekind == RTE_RELATION && rte->tablesample)
+                    {
+                        pgxc_set_shippability_reason(sc_context,
+                                                     SS_NEED_SINGLENODE);
+                        break;
+                    }
+                }
+            }
+#endif
+
             /* Queries with FOR UPDATE/SHARE can't be shipped */
         //    if (query->hasForUpdate || query->rowMarks)
             //    pgxc_set_shippability_reason(sc_context, SS_UNSUPPORTED_EXPR);
@@ -1402,14 +1475,15 @@ pgxc_shippability_walker(Node *node, Shippability_context *sc_context)
              * Datanode involved
              * 1. the query has aggregagtes without grouping by distribution
              *    column
-             * 2. the query has window functions
+             * 2. the query has window functions not partitioned by
+             *    distribution column
              * 3. the query has ORDER BY clause
              * 4. the query has Distinct clause without distribution column in
              *    distinct clause
              * 5. the query has limit and offset clause
              */
-            if (query->hasWindowFuncs || query->sortClause ||
-                query->limitOffset || query->limitCount)
+            if ((query->hasWindowFuncs && !pgxc_window_has_distcol(query)) ||
+                query->sortClause || query->limitOffset || query->limitCount)
                 pgxc_set_shippability_reason(sc_context, SS_NEED_SINGLENODE);
 
             /*
@@ -1894,6 +1968,710 @@ make_FQS_single_node()
 	return exec_nodes;
 }
 
+#ifdef __TBASE__
+/*
+ * FQS decision cache
+ *
+ * For a simple statement on a single relation the verdict of the
+ * shippability walker only depends on the shape of the query, not on the
+ * values of its constants. We remember it per backend, keyed by a compact
+ * serialization of the query tree that leaves the constant values out. A
+ * later query with the same key only has to find its datanodes again, which
+ * evaluates the distribution column value against the current locator and
+ * shard map, so only catalog changes affecting the verdict need to flush it.
+ *
+ * Each entry remembers the relation it was computed for. A relcache
+ * invalidation (locator, triggers, columns) removes the entries of that
+ * relation only. Function and type shippability are not tracked per entry,
+ * so pg_proc and pg_type invalidations still flush the whole cache.
+ */
+int			fqs_cache_size = 512;
+
+#define FQS_CACHE_MAX_KEYLEN	4096
+
+#define FQS_JUMBLE(buf, item) \
+	appendBinaryStringInfo((buf), (const char *) &(item), sizeof(item))
+
+typedef struct
+{
+	uint32		hash;			/* hash of the key, must be first */
+	int			keylen;
+	char	   *key;			/* serialized query tree */
+	Oid			relid;			/* relation the query is on */
+	uint32		shippability;	/* ShippabilityStat reasons as bitmask */
+} FQSCacheEntry;
+
+typedef struct
+{
+	bool		valid;			/* query can be cached */
+	uint32		hash;
+	StringInfoData data;
+	Oid			relid;
+	uint64		generation;		/* fqs_cache_generation before the walk */
+} FQSCacheKey;
+
+static HTAB *fqs_cache = NULL;
+static MemoryContext fqs_cache_context = NULL;
+static bool fqs_cache_callbacks = false;
+static uint64 fqs_cache_generation = 0;
+static Oid	fqs_cache_walk_relid = InvalidOid;
+static uint64 fqs_cache_hits = 0;
+static uint64 fqs_cache_misses = 0;
+
+static void
+pgxc_FQS_cache_reset(void)
+{
+	fqs_cache_generation++;
+	if (fqs_cache_context)
+		MemoryContextReset(fqs_cache_context);
+	fqs_cache = NULL;
+}
+
+static void
+pgxc_FQS_cache_relcache_callback(Datum arg, Oid relid)
+{
+	HASH_SEQ_STATUS status;
+	FQSCacheEntry *entry;
+
+	if (!OidIsValid(relid))
+	{
+		pgxc_FQS_cache_reset();
+		return;
+	}
+
+	/* a decision being computed for this relation may be stale already */
+	if (relid == fqs_cache_walk_relid)
+		fqs_cache_generation++;
+
+	if (fqs_cache == NULL)
+		return;
+
+	hash_seq_init(&status, fqs_cache);
+	while ((entry = (FQSCacheEntry *) hash_seq_search(&status)) != NULL)
+	{
+		if (entry->relid != relid)
+			continue;
+		pfree(entry->key);
+		hash_search(fqs_cache, &entry->hash, HASH_REMOVE, NULL);
+	}
+}
+
+static void
+pgxc_FQS_cache_syscache_callback(Datum arg, int cacheid, uint32 hashvalue)
+{
+	pgxc_FQS_cache_reset();
+}
+
+/*
+ * Append the parts of an expression tree the shippability walker looks at.
+ * Returns true for anything we don't know about, such queries always go
+ * through the full walker.
+ */
+static bool
+pgxc_FQS_jumble_walker(Node *node, StringInfo buf)
+{// #lizard forgives
+	NodeTag		tag;
+
+	if (buf->len > FQS_CACHE_MAX_KEYLEN)
+		return true;
+
+	if (node == NULL)
+	{
+		tag = T_Invalid;
+		FQS_JUMBLE(buf, tag);
+		return false;
+	}
+
+	tag = nodeTag(node);
+	FQS_JUMBLE(buf, tag);
+
+	switch (tag)
+	{
+		case T_List:
+		{
+			int			len = list_length((List *) node);
+
+			FQS_JUMBLE(buf, len);
+		}
+		break;
+
+		case T_Var:
+		{
+			Var		   *var = (Var *) node;
+
+			FQS_JUMBLE(buf, var->varno);
+			FQS_JUMBLE(buf, var->varattno);
+			FQS_JUMBLE(buf, var->vartype);
+			FQS_JUMBLE(buf, var->varlevelsup);
+		}
+		break;
+
+		case T_Const:
+			/* the value is what we want to leave out */
+			FQS_JUMBLE(buf, ((Const *) node)->consttype);
+			break;
+
+		case T_Param:
+		{
+			Param	   *param = (Param *) node;
+
+			FQS_JUMBLE(buf, param->paramkind);
+			FQS_JUMBLE(buf, param->paramid);
+			FQS_JUMBLE(buf, param->paramtype);
+		}
+		break;
+
+		case T_FuncExpr:
+		{
+			FuncExpr   *funcexpr = (FuncExpr *) node;
+
+			FQS_JUMBLE(buf, funcexpr->funcid);
+			FQS_JUMBLE(buf, funcexpr->funcresulttype);
+			FQS_JUMBLE(buf, funcexpr->funcretset);
+			FQS_JUMBLE(buf, funcexpr->funcformat);
+		}
+		break;
+
+		case T_OpExpr:
+		case T_DistinctExpr:
+		case T_NullIfExpr:
+		{
+			OpExpr	   *op_expr = (OpExpr *) node;
+
+			FQS_JUMBLE(buf, op_expr->opno);
+			FQS_JUMBLE(buf, op_expr->opfuncid);
+			FQS_JUMBLE(buf, op_expr->opresulttype);
+		}
+		break;
+
+		case T_ScalarArrayOpExpr:
+		{
+			ScalarArrayOpExpr *sao_expr = (ScalarArrayOpExpr *) node;
+
+			FQS_JUMBLE(buf, sao_expr->opno);
+			FQS_JUMBLE(buf, sao_expr->opfuncid);
+			FQS_JUMBLE(buf, sao_expr->useOr);
+		}
+		break;
+
+		case T_BoolExpr:
+			FQS_JUMBLE(buf, ((BoolExpr *) node)->boolop);
+			break;
+
+		case T_RelabelType:
+		{
+			RelabelType *relabel = (RelabelType *) node;
+
+			FQS_JUMBLE(buf, relabel->resulttype);
+			FQS_JUMBLE(buf, relabel->relabelformat);
+		}
+		break;
+
+		case T_CoerceViaIO:
+		{
+			CoerceViaIO *cvio = (CoerceViaIO *) node;
+
+			/* the walker checks the coercion in an implicit or explicit context */
+			FQS_JUMBLE(buf, cvio->resulttype);
+			FQS_JUMBLE(buf, cvio->coerceformat);
+		}
+		break;
+
+		case T_ArrayCoerceExpr:
+		{
+			ArrayCoerceExpr *acexpr = (ArrayCoerceExpr *) node;
+
+			FQS_JUMBLE(buf, acexpr->elemfuncid);
+			FQS_JUMBLE(buf, acexpr->resulttype);
+			FQS_JUMBLE(buf, acexpr->isExplicit);
+			FQS_JUMBLE(buf, acexpr->coerceformat);
+		}
+		break;
+
+		case T_ConvertRowtypeExpr:
+		{
+			ConvertRowtypeExpr *cre = (ConvertRowtypeExpr *) node;
+
+			FQS_JUMBLE(buf, cre->resulttype);
+			FQS_JUMBLE(buf, cre->convertformat);
+		}
+		break;
+
+		case T_CollateExpr:
+			FQS_JUMBLE(buf, ((CollateExpr *) node)->collOid);
+			break;
+
+		case T_CaseExpr:
+			FQS_JUMBLE(buf, ((CaseExpr *) node)->casetype);
+			break;
+
+		case T_CaseWhen:
+			break;
+
+		case T_CaseTestExpr:
+			FQS_JUMBLE(buf, ((CaseTestExpr *) node)->typeId);
+			break;
+
+		case T_ArrayExpr:
+			FQS_JUMBLE(buf, ((ArrayExpr *) node)->array_typeid);
+			break;
+
+		case T_RowExpr:
+		{
+			RowExpr    *rowexpr = (RowExpr *) node;
+
+			FQS_JUMBLE(buf, rowexpr->row_typeid);
+			FQS_JUMBLE(buf, rowexpr->row_format);
+		}
+		break;
+
+		case T_CoalesceExpr:
+			FQS_JUMBLE(buf, ((CoalesceExpr *) node)->coalescetype);
+			break;
+
+		case T_MinMaxExpr:
+		{
+			MinMaxExpr *mmexpr = (MinMaxExpr *) node;
+
+			FQS_JUMBLE(buf, mmexpr->minmaxtype);
+			FQS_JUMBLE(buf, mmexpr->op);
+		}
+		break;
+
+		case T_SQLValueFunction:
+		{
+			SQLValueFunction *svf = (SQLValueFunction *) node;
+
+			FQS_JUMBLE(buf, svf->op);
+			FQS_JUMBLE(buf, svf->type);
+		}
+		break;
+
+		case T_NullTest:
+		{
+			NullTest   *nt = (NullTest *) node;
+
+			FQS_JUMBLE(buf, nt->nulltesttype);
+			FQS_JUMBLE(buf, nt->argisrow);
+		}
+		break;
+
+		case T_BooleanTest:
+			FQS_JUMBLE(buf, ((BooleanTest *) node)->booltesttype);
+			break;
+
+		case T_CoerceToDomain:
+		{
+			CoerceToDomain *ctd = (CoerceToDomain *) node;
+
+			FQS_JUMBLE(buf, ctd->resulttype);
+			FQS_JUMBLE(buf, ctd->coercionformat);
+		}
+		break;
+
+		case T_CoerceToDomainValue:
+			FQS_JUMBLE(buf, ((CoerceToDomainValue *) node)->typeId);
+			break;
+
+		case T_FieldSelect:
+		{
+			FieldSelect *fs = (FieldSelect *) node;
+
+			FQS_JUMBLE(buf, fs->fieldnum);
+			FQS_JUMBLE(buf, fs->resulttype);
+		}
+		break;
+
+		case T_NamedArgExpr:
+			FQS_JUMBLE(buf, ((NamedArgExpr *) node)->argnumber);
+			break;
+
+		case T_TargetEntry:
+		{
+			TargetEntry *tle = (TargetEntry *) node;
+
+			FQS_JUMBLE(buf, tle->resno);
+			FQS_JUMBLE(buf, tle->ressortgroupref);
+			FQS_JUMBLE(buf, tle->resjunk);
+		}
+		break;
+
+		case T_RangeTblRef:
+			FQS_JUMBLE(buf, ((RangeTblRef *) node)->rtindex);
+			break;
+
+		case T_FromExpr:
+			break;
+
+		default:
+			return true;
+	}
+
+	return expression_tree_walker(node, pgxc_FQS_jumble_walker, (void *) buf);
+}
+
+/*
+ * Serialize the query into buf. Returns false if the query is not one of the
+ * simple single relation statements we cache decisions for.
+ */
+static bool
+pgxc_FQS_cache_key(Query *query, StringInfo buf)
+{// #lizard forgives
+	RangeTblEntry *rte;
+	ListCell   *lc;
+
+	if (query->commandType != CMD_SELECT &&
+		query->commandType != CMD_INSERT &&
+		query->commandType != CMD_UPDATE &&
+		query->commandType != CMD_DELETE)
+		return false;
+
+	if (query->utilityStmt || list_length(query->rtable) != 1 ||
+		query->hasAggs || query->hasWindowFuncs || query->hasSubLinks ||
+		query->hasRecursive || query->hasModifyingCTE ||
+		query->hasRowSecurity || query->isMultiValues ||
+		query->copy_filename || query->cteList || query->onConflict ||
+		query->groupClause || query->groupingSets || query->havingQual ||
+		query->windowClause || query->distinctClause ||
+		query->setOperations || query->withCheckOptions)
+		return false;
+
+	rte = (RangeTblEntry *) linitial(query->rtable);
+	if (rte->rtekind != RTE_RELATION || rte->tablesample ||
+		rte->securityQuals)
+		return false;
+
+	FQS_JUMBLE(buf, query->commandType);
+	FQS_JUMBLE(buf, query->resultRelation);
+	FQS_JUMBLE(buf, query->hasTargetSRFs);
+	FQS_JUMBLE(buf, query->hasForUpdate);
+	FQS_JUMBLE(buf, query->isSingleValues);
+	FQS_JUMBLE(buf, query->override);
+	FQS_JUMBLE(buf, rte->relid);
+	FQS_JUMBLE(buf, rte->relkind);
+	FQS_JUMBLE(buf, rte->inh);
+
+	foreach(lc, query->sortClause)
+	{
+		SortGroupClause *sgc = (SortGroupClause *) lfirst(lc);
+
+		FQS_JUMBLE(buf, sgc->tleSortGroupRef);
+		FQS_JUMBLE(buf, sgc->sortop);
+	}
+
+	foreach(lc, query->rowMarks)
+	{
+		RowMarkClause *rc = (RowMarkClause *) lfirst(lc);
+
+		FQS_JUMBLE(buf, rc->rti);
+		FQS_JUMBLE(buf, rc->strength);
+		FQS_JUMBLE(buf, rc->waitPolicy);
+	}
+
+	if (pgxc_FQS_jumble_walker((Node *) query->jointree, buf) ||
+		pgxc_FQS_jumble_walker((Node *) query->targetList, buf) ||
+		pgxc_FQS_jumble_walker((Node *) query->returningList, buf) ||
+		pgxc_FQS_jumble_walker(query->limitOffset, buf) ||
+		pgxc_FQS_jumble_walker(query->limitCount, buf))
+		return false;
+
+	return buf->len <= FQS_CACHE_MAX_KEYLEN;
+}
+
+/*
+ * Look the query up in the FQS cache. On a hit the context is filled in as
+ * the shippability walker would have done it and true is returned. On a miss
+ * the key is left in fqs_key for pgxc_FQS_cache_store.
+ */
+static bool
+pgxc_FQS_cache_fetch(Query *query, int query_level,
+					 Shippability_context *sc_context, FQSCacheKey *fqs_key)
+{
+	FQSCacheEntry *entry;
+	int			x;
+
+	fqs_key->valid = false;
+	if (query_level != 0 || fqs_cache_size <= 0)
+		return false;
+
+	initStringInfo(&fqs_key->data);
+	if (!pgxc_FQS_cache_key(query, &fqs_key->data))
+	{
+		pfree(fqs_key->data.data);
+		return false;
+	}
+	fqs_key->valid = true;
+	fqs_key->relid = ((RangeTblEntry *) linitial(query->rtable))->relid;
+	fqs_key->hash = DatumGetUInt32(hash_any((unsigned char *) fqs_key->data.data,
+											fqs_key->data.len));
+	fqs_key->generation = fqs_cache_generation;
+	fqs_cache_walk_relid = fqs_key->relid;
+
+	if (fqs_cache == NULL)
+	{
+		fqs_cache_misses++;
+		return false;
+	}
+
+	entry = (FQSCacheEntry *) hash_search(fqs_cache, &fqs_key->hash,
+										  HASH_FIND, NULL);
+	if (entry == NULL || entry->keylen != fqs_key->data.len ||
+		memcmp(entry->key, fqs_key->data.data, entry->keylen) != 0)
+	{
+		fqs_cache_misses++;
+		return false;
+	}
+	fqs_cache_hits++;
+
+	for (x = 0; x < 32; x++)
+	{
+		if (entry->shippability & ((uint32) 1 << x))
+			sc_context->sc_shippability =
+				bms_add_member(sc_context->sc_shippability, x);
+	}
+
+	if (bms_is_member(SS_UNSHIPPABLE_TRIGGER, sc_context->sc_shippability))
+		query->hasUnshippableTriggers = true;
+
+	sc_context->sc_exec_nodes = pgxc_FQS_find_datanodes(query);
+
+	pfree(fqs_key->data.data);
+	fqs_key->valid = false;
+	return true;
+}
+
+/*
+ * Remember the verdict of the shippability walker for a query that missed
+ * the cache.
+ */
+static void
+pgxc_FQS_cache_store(Shippability_context *sc_context, FQSCacheKey *fqs_key,
+					 bool walk_failed)
+{
+	FQSCacheEntry *entry;
+	bool		found;
+	uint32		shippability = 0;
+	int			x = -1;
+
+	if (!fqs_key->valid)
+		return;
+
+	fqs_cache_walk_relid = InvalidOid;
+
+	/* the walker gave up, or catalogs changed while it was running */
+	if (walk_failed || fqs_key->generation != fqs_cache_generation)
+		goto done;
+
+	if (!fqs_cache_callbacks)
+	{
+		CacheRegisterRelcacheCallback(pgxc_FQS_cache_relcache_callback,
+									  (Datum) 0);
+		CacheRegisterSyscacheCallback(PROCOID,
+									  pgxc_FQS_cache_syscache_callback,
+									  (Datum) 0);
+		CacheRegisterSyscacheCallback(TYPEOID,
+									  pgxc_FQS_cache_syscache_callback,
+									  (Datum) 0);
+		fqs_cache_callbacks = true;
+	}
+
+	if (fqs_cache_context == NULL)
+		fqs_cache_context = AllocSetContextCreate(CacheMemoryContext,
+												  "FQS cache",
+												  ALLOCSET_DEFAULT_SIZES);
+
+	/* simply start over once the cache is full */
+	if (fqs_cache && hash_get_num_entries(fqs_cache) >= fqs_cache_size)
+		pgxc_FQS_cache_reset();
+
+	if (fqs_cache == NULL)
+	{
+		HASHCTL		ctl;
+
+		MemSet(&ctl, 0, sizeof(ctl));
+		ctl.keysize = sizeof(uint32);
+		ctl.entrysize = sizeof(FQSCacheEntry);
+		ctl.hcxt = fqs_cache_context;
+		fqs_cache = hash_create("FQS cache", fqs_cache_size, &ctl,
+								HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+	}
+
+	while ((x = bms_next_member(sc_context->sc_shippability, x)) >= 0)
+		shippability |= (uint32) 1 << x;
+
+	entry = (FQSCacheEntry *) hash_search(fqs_cache, &fqs_key->hash,
+										  HASH_ENTER, &found);
+	if (found)
+		pfree(entry->key);
+	entry->keylen = fqs_key->data.len;
+	entry->key = MemoryContextAlloc(fqs_cache_context, entry->keylen);
+	memcpy(entry->key, fqs_key->data.data, entry->keylen);
+	entry->relid = fqs_key->relid;
+	entry->shippability = shippability;
+
+done:
+	pfree(fqs_key->data.data);
+	fqs_key->valid = false;
+}
+
+/*
+ * Report the FQS cache lookups of this backend and the number of cached
+ * decisions.
+ */
+Datum
+pg_stat_get_fqs_cache(PG_FUNCTION_ARGS)
+{
+	Datum		values[3];
+	bool		isnull[3];
+	TupleDesc	resultTupleDesc;
+
+	/*
+	 * Construct a tuple descriptor for the result row.  This must match this
+	 * function's pg_proc entry!
+	 */
+	resultTupleDesc = CreateTemplateTupleDesc(3, false);
+	TupleDescInitEntry(resultTupleDesc, (AttrNumber) 1, "hits",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(resultTupleDesc, (AttrNumber) 2, "misses",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(resultTupleDesc, (AttrNumber) 3, "entries",
+					   INT8OID, -1, 0);
+	resultTupleDesc = BlessTupleDesc(resultTupleDesc);
+
+	MemSet(isnull, 0, sizeof(isnull));
+	values[0] = Int64GetDatum((int64) fqs_cache_hits);
+	values[1] = Int64GetDatum((int64) fqs_cache_misses);
+	values[2] = Int64GetDatum(fqs_cache ? (int64) hash_get_num_entries(fqs_cache) : 0);
+
+	PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(resultTupleDesc,
+													  values, isnull)));
+}
+#endif
+
+#ifdef __TBASE__
+char *shard_local_relation = NULL;
+
+/*
+ * pgxc_shard_local_function_relid
+ * If the function has shard_local_relation in its SET clause, return the
+ * relation it names, otherwise InvalidOid.
+ */
+static Oid
+pgxc_shard_local_function_relid(Oid funcid)
+{
+	HeapTuple	proctup;
+	Datum		proconfig;
+	bool		isnull;
+	Oid			relid = InvalidOid;
+	const char *prefix = "shard_local_relation=";
+
+	proctup = SearchSysCache1(PROCOID, ObjectIdGetDatum(funcid));
+	if (!HeapTupleIsValid(proctup))
+		return InvalidOid;
+
+	proconfig = SysCacheGetAttr(PROCOID, proctup, Anum_pg_proc_proconfig,
+								&isnull);
+	if (!isnull)
+	{
+		Datum	   *settings;
+		int			nsettings;
+		int			i;
+
+		deconstruct_array(DatumGetArrayTypeP(proconfig), TEXTOID, -1, false,
+						  'i', &settings, NULL, &nsettings);
+		for (i = 0; i < nsettings; i++)
+		{
+			char	   *setting = TextDatumGetCString(settings[i]);
+
+			if (strncmp(setting, prefix, strlen(prefix)) == 0 &&
+				setting[strlen(prefix)] != '\0')
+			{
+				List	   *names = stringToQualifiedNameList(setting + strlen(prefix));
+
+				relid = RangeVarGetRelid(makeRangeVarFromNameList(names),
+										 NoLock, true);
+			}
+			pfree(setting);
+		}
+		pfree(settings);
+	}
+
+	ReleaseSysCache(proctup);
+	return relid;
+}
+
+/*
+ * pgxc_FQS_shard_local_function
+ * A query that only calls a shard-local function, like SELECT f($1, $2),
+ * is shipped as a whole to the datanode owning the function's first
+ * argument as a value of the distribution column of its shard_local_relation.
+ * All statements of the function then run there without further round
+ * trips. The target node is found at execution time from the argument.
+ */
+static ExecNodes *
+pgxc_FQS_shard_local_function(Query *query)
+{
+	TargetEntry *tle;
+	FuncExpr   *funcexpr;
+	Node	   *distarg;
+	Oid			relid;
+	RelationLocInfo *rel_loc_info;
+	ExecNodes  *exec_nodes;
+
+	if (query->commandType != CMD_SELECT || query->rtable != NIL ||
+		query->utilityStmt || query->hasSubLinks || query->hasAggs ||
+		query->hasWindowFuncs || query->cteList || query->setOperations ||
+		query->jointree->quals || query->groupClause || query->havingQual ||
+		query->sortClause || query->distinctClause || query->limitCount ||
+		query->limitOffset || query->rowMarks ||
+		list_length(query->targetList) != 1)
+		return NULL;
+
+	tle = (TargetEntry *) linitial(query->targetList);
+	if (!IsA(tle->expr, FuncExpr))
+		return NULL;
+	funcexpr = (FuncExpr *) tle->expr;
+	if (funcexpr->args == NIL)
+		return NULL;
+
+	relid = pgxc_shard_local_function_relid(funcexpr->funcid);
+	if (!OidIsValid(relid))
+		return NULL;
+
+	/*
+	 * The coordinator evaluates the first argument to route the call, so it
+	 * must give the same value there as on the datanode.
+	 */
+	distarg = (Node *) linitial(funcexpr->args);
+	if (!IsA(distarg, Const) &&
+		!(IsA(distarg, Param) && ((Param *) distarg)->paramkind == PARAM_EXTERN))
+		return NULL;
+	if (expression_returns_set((Node *) funcexpr->args) ||
+		!pgxc_is_expr_shippable((Expr *) funcexpr->args, NULL))
+		return NULL;
+
+	rel_loc_info = GetRelationLocInfo(relid);
+	if (rel_loc_info == NULL)
+		return NULL;
+	if (!IsRelationDistributedByValue(rel_loc_info) ||
+		get_atttype(relid, rel_loc_info->partAttrNum) != exprType(distarg))
+	{
+		FreeRelationLocInfo(rel_loc_info);
+		return NULL;
+	}
+
+	exec_nodes = makeNode(ExecNodes);
+	exec_nodes->baselocatortype = rel_loc_info->locatorType;
+	exec_nodes->en_expr = (Expr *) copyObject(distarg);
+	exec_nodes->en_relid = relid;
+	/* the function may write, route it like a DML on the relation */
+	exec_nodes->accesstype = RELATION_ACCESS_UPDATE;
+
+	FreeRelationLocInfo(rel_loc_info);
+	return exec_nodes;
+}
+#endif
+
 /*
  * pgxc_is_query_shippable
  * This function calls the query walker to analyse the query to gather
@@ -1911,6 +2689,16 @@ pgxc_is_query_shippable(Query *query, int query_level)
 	ExecNodes	*exec_nodes;
 	bool		canShip = true;
 	Bitmapset	*shippability;
+#ifdef __TBASE__
+	FQSCacheKey	fqs_key;
+#endif
+
+#ifdef __TBASE__
+	/* a lone call of a shard-local function goes to one datanode */
+	exec_nodes = pgxc_FQS_shard_local_function(query);
+	if (exec_nodes)
+		return exec_nodes;
+#endif
 
 	memset(&sc_context, 0, sizeof(sc_context));
 	/* let's assume that by default query is shippable */
@@ -1923,7 +2711,17 @@ pgxc_is_query_shippable(Query *query, int query_level)
 	 * still walk it anyway to find out if there are any subqueries which can be
 	 * shipped.
 	 */
+#ifdef __TBASE__
+	if (!pgxc_FQS_cache_fetch(query, query_level, &sc_context, &fqs_key))
+	{
+		bool		walk_failed;
+
+		walk_failed = pgxc_shippability_walker((Node *)query, &sc_context);
+		pgxc_FQS_cache_store(&sc_context, &fqs_key, walk_failed);
+	}
+#else
 	pgxc_shippability_walker((Node *)query, &sc_context);
+#endif
 
 	exec_nodes = sc_context.sc_exec_nodes;
 
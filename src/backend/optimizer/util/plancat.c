@@ -53,6 +53,9 @@
 #include "pgxc/pgxc.h"
 #endif
 #ifdef __TBASE__
+#include "utils/hsearch.h"
+#include "utils/inval.h"
+#include "utils/memutils.h"
 #include "utils/ruleutils.h"
 #endif
 
@@ -81,7 +84,25 @@ static List *build_index_tlist(PlannerInfo *root, IndexOptInfo *index,
 static List *get_relation_statistics(RelOptInfo *rel, Relation relation);
 
 #ifdef __TBASE__
+/*
+ * Statistic page num of interval partition tables and their indexes, summed
+ * over the children. Summing means one catalog lookup per child, which is
+ * too expensive to repeat in every planning for tables with thousands of
+ * partitions, so the result is kept until a relcache invalidation arrives.
+ * VACUUM/ANALYZE of a child updates its pg_class row and hence invalidates.
+ */
+typedef struct IntervalPagesEntry
+{
+    Oid         relid;          /* interval parent or its index, hash key */
+    BlockNumber pages;
+} IntervalPagesEntry;
+
+static HTAB   *interval_pages_cache = NULL;
+static uint32  interval_pages_cache_gen = 0;
+
 static BlockNumber GetIntervalPartitionPages(Relation rel, bool isindex, bool statistic);
+static BlockNumber GetIntervalChildPages(Oid partoid, bool isindex, bool statistic);
+static void IntervalPagesCacheCallback(Datum arg, Oid relid);
 #endif
 /*
  * get_relation_info -
@@ -1957,19 +1978,75 @@ has_row_triggers(PlannerInfo *root, Index rti, CmdType event)
 }
 
 #ifdef __TBASE__
+static void
+IntervalPagesCacheCallback(Datum arg, Oid relid)
+{
+    /* could be a child of any cached parent, so just forget everything */
+    interval_pages_cache_gen++;
+    if (interval_pages_cache != NULL)
+    {
+        hash_destroy(interval_pages_cache);
+        interval_pages_cache = NULL;
+    }
+}
+
+static BlockNumber
+GetIntervalChildPages(Oid partoid, bool isindex, bool statistic)
+{
+    Relation    childrel;
+    BlockNumber pages;
+
+    if (statistic)
+    {
+        HeapTuple   tuple;
+
+        /* no need to open and lock the child only to read pg_class */
+        tuple = SearchSysCache1(RELOID, ObjectIdGetDatum(partoid));
+        if (!HeapTupleIsValid(tuple))
+            return 0;
+        pages = ((Form_pg_class) GETSTRUCT(tuple))->relpages;
+        ReleaseSysCache(tuple);
+        return pages;
+    }
+
+    if (isindex)
+        childrel = index_open(partoid, AccessShareLock);
+    else
+        childrel = heap_open(partoid, AccessShareLock);
+
+    pages = RelationGetNumberOfBlocks(childrel);
+
+    if (isindex)
+        index_close(childrel, AccessShareLock);
+    else
+        heap_close(childrel, AccessShareLock);
+
+    return pages;
+}
+
 /* Get statistic/physical page num of interval partition table or its index */
 static BlockNumber 
 GetIntervalPartitionPages(Relation rel, bool isindex, bool statistic)
 {// #lizard forgives
-    BlockNumber blocknum = 0;
+    double      blocknum = 0;
     int         nparts   = 0;
     int         partidx     = 0;
     Oid         partoid  = InvalidOid;
-    Relation    childrel = NULL;
     int            step     = 0;
     int         scannum     = 0;
     int         i          = 0;
     Relation    indexRel = NULL;
+    uint32      cache_gen = interval_pages_cache_gen;
+    IntervalPagesEntry *entry;
+    Oid         relid = RelationGetRelid(rel);
+
+    if (statistic && interval_pages_cache != NULL)
+    {
+        entry = (IntervalPagesEntry *) hash_search(interval_pages_cache,
+                                                   &relid, HASH_FIND, NULL);
+        if (entry != NULL)
+            return entry->pages;
+    }
 
     if (!isindex)
         nparts = RelationGetNParts(rel);
@@ -1995,20 +2072,7 @@ GetIntervalPartitionPages(Relation rel, bool isindex, bool statistic)
 			    continue;
 			}
 
-            if (isindex)
-                childrel = index_open(partoid, AccessShareLock);
-            else
-                childrel = heap_open(partoid, AccessShareLock);
-
-            if (statistic)
-                blocknum += childrel->rd_rel->relpages;
-            else
-                blocknum += RelationGetNumberOfBlocks(childrel);
-
-            if (isindex)
-                index_close(childrel, AccessShareLock);
-            else
-                heap_close(childrel, AccessShareLock);
+            blocknum += GetIntervalChildPages(partoid, isindex, statistic);
         }
     }
     else
@@ -2026,26 +2090,49 @@ GetIntervalPartitionPages(Relation rel, bool isindex, bool statistic)
 			    continue;
 			}
 
-            if (isindex)
-                childrel = index_open(partoid, AccessShareLock);
-            else
-                childrel = heap_open(partoid, AccessShareLock);
-            
-            if (statistic)
-                blocknum += childrel->rd_rel->relpages;
-            else
-                blocknum += RelationGetNumberOfBlocks(childrel);
-
-            if (isindex)
-                index_close(childrel, AccessShareLock);
-            else
-                heap_close(childrel, AccessShareLock);
+            blocknum += GetIntervalChildPages(partoid, isindex, statistic);
         
             partidx += step;
         }
         Assert(i == scannum);
+
+        /* the samples stand for all the partitions */
+        if (scannum > 0)
+            blocknum = blocknum * nparts / scannum;
+    }
+
+    if (blocknum > (double) MaxBlockNumber)
+        blocknum = (double) MaxBlockNumber;
+
+    /* remember it, unless an invalidation arrived while summing */
+    if (statistic && cache_gen == interval_pages_cache_gen)
+    {
+        if (interval_pages_cache == NULL)
+        {
+            static bool callback_registered = false;
+            HASHCTL     ctl;
+
+            if (!callback_registered)
+            {
+                CacheRegisterRelcacheCallback(IntervalPagesCacheCallback,
+                                              (Datum) 0);
+                callback_registered = true;
+            }
+
+            MemSet(&ctl, 0, sizeof(ctl));
+            ctl.keysize = sizeof(Oid);
+            ctl.entrysize = sizeof(IntervalPagesEntry);
+            ctl.hcxt = CacheMemoryContext;
+            interval_pages_cache = hash_create("interval partition pages", 64,
+                                               &ctl,
+                                               HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+        }
+
+        entry = (IntervalPagesEntry *) hash_search(interval_pages_cache,
+                                                   &relid, HASH_ENTER, NULL);
+        entry->pages = (BlockNumber) blocknum;
     }
     
-    return blocknum;
+    return (BlockNumber) blocknum;
 }
 #endif
@@ -0,0 +1,733 @@
+/*-------------------------------------------------------------------------
+ *
+ * globaldeadlock.c
+ *
+ *     Global deadlock detection
+ *
+ * deadlock.c only sees the wait-for graph of its own node, so a cycle in
+ * which a distributed transaction waits for another one on one datanode and
+ * the other way round on a second datanode is never found; it is resolved
+ * only by lock_timeout.
+ *
+ * The detector is a background worker on each coordinator. Every
+ * global_deadlock_detector_interval it calls pg_detect_global_deadlock()
+ * over a loopback connection. That function collects the wait-for edges of
+ * all datanodes from pg_lock_wait_graph(), keyed by global xid, and keeps
+ * only the edges seen in two consecutive snapshots, as a wait observed on
+ * one node may have ended by the time another node is asked. For each
+ * remaining cycle that spans more than one node, one transaction is
+ * cancelled on all datanodes with pg_cancel_global_xid(). The victim is
+ * chosen deterministically, so the detectors of several coordinators agree
+ * on it. Cycles within a single node are left to deadlock.c.
+ *
+ * IDENTIFICATION
+ *      $$
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include <signal.h>
+
+#include "access/htup_details.h"
+#include "catalog/pg_type.h"
+#include "executor/executor.h"
+#include "funcapi.h"
+#include "libpq-fe.h"
+#include "miscadmin.h"
+#include "nodes/makefuncs.h"
+#include "pgstat.h"
+#include "pgxc/execRemote.h"
+#include "pgxc/globaldeadlock.h"
+#include "pgxc/nodemgr.h"
+#include "pgxc/pgxc.h"
+#include "pgxc/pgxcnode.h"
+#include "postmaster/bgworker.h"
+#include "postmaster/postmaster.h"
+#include "storage/ipc.h"
+#include "storage/latch.h"
+#include "storage/lock.h"
+#include "storage/procarray.h"
+#include "tcop/tcopprot.h"
+#include "utils/array.h"
+#include "utils/builtins.h"
+#include "utils/guc.h"
+#include "utils/hsearch.h"
+#include "utils/snapmgr.h"
+#include "utils/varlena.h"
+
+/* GUC options */
+int global_deadlock_detector_interval = 0;
+
+/* a wait-for edge as reported by one datanode */
+typedef struct GddEdgeKey
+{
+    char    node[NAMEDATALEN];
+    char    waiter[NAMEDATALEN];
+    char    holder[NAMEDATALEN];
+} GddEdgeKey;
+
+/* the wait-for graph, vertices are global xids */
+typedef struct GddGraph
+{
+    int        nvertices;
+    char  **gxids;            /* global xid of each vertex */
+    bool   *removed;        /* vertex left out of the search */
+    List  **out;            /* outgoing edges of each vertex */
+
+    int        nedges;
+    int       *holder;            /* vertex waited for by each edge */
+    char  **node;            /* datanode each edge was seen on */
+} GddGraph;
+
+typedef struct GddVertexEnt
+{
+    char    gxid[NAMEDATALEN];    /* hash key */
+    int        vertex;
+} GddVertexEnt;
+
+static volatile sig_atomic_t got_SIGHUP = false;
+
+static List *gdd_exec_on_datanodes(const char *query, int natts);
+static HTAB *gdd_collect_edges(void);
+static int    gdd_vertex(GddGraph *graph, HTAB *vertices, const char *gxid);
+static GddGraph *gdd_build_graph(HTAB *previous, HTAB *current);
+static int    gdd_find_cycle(GddGraph *graph, int *cycle_edges);
+static bool gdd_search(GddGraph *graph, int v, int *state, int *path_vertices,
+                       int *path_edges, int *depth, int *cycle_edges,
+                       int *ncycle);
+
+/*
+ * Register the detector. Like ApplyLauncherRegister() this has to be
+ * called by the postmaster before InitializeMaxBackends().
+ */
+void
+GlobalDeadlockDetectorRegister(void)
+{
+    BackgroundWorker bgw;
+
+    if (!IS_PGXC_COORDINATOR)
+        return;
+
+    memset(&bgw, 0, sizeof(bgw));
+    bgw.bgw_flags = BGWORKER_SHMEM_ACCESS;
+    bgw.bgw_start_time = BgWorkerStart_RecoveryFinished;
+    snprintf(bgw.bgw_library_name, BGW_MAXLEN, "postgres");
+    snprintf(bgw.bgw_function_name, BGW_MAXLEN, "GlobalDeadlockDetectorMain");
+    snprintf(bgw.bgw_name, BGW_MAXLEN, "global deadlock detector");
+    bgw.bgw_restart_time = 5;
+    bgw.bgw_notify_pid = 0;
+    bgw.bgw_main_arg = (Datum) 0;
+
+    RegisterBackgroundWorker(&bgw);
+}
+
+/* SIGHUP: set flag to reload configuration at next convenient time */
+static void
+gdd_sighup(SIGNAL_ARGS)
+{
+    int            save_errno = errno;
+
+    got_SIGHUP = true;
+
+    /* Waken anything waiting on the process latch */
+    SetLatch(MyLatch);
+
+    errno = save_errno;
+}
+
+/*
+ * Connect to our own coordinator, through the first unix socket directory
+ * if there is one.
+ */
+static PGconn *
+gdd_connect(void)
+{
+    const char *keywords[5];
+    const char *values[5];
+    char        port[16];
+    char       *rawstring;
+    List       *dirs = NIL;
+    PGconn       *conn;
+
+    rawstring = pstrdup(Unix_socket_directories);
+    (void) SplitDirectoriesString(rawstring, ',', &dirs);
+    snprintf(port, sizeof(port), "%d", PostPortNumber);
+
+    keywords[0] = "host";
+    values[0] = dirs != NIL ? (char *) linitial(dirs) : "localhost";
+    keywords[1] = "port";
+    values[1] = port;
+    keywords[2] = "dbname";
+    values[2] = "postgres";
+    keywords[3] = "application_name";
+    values[3] = "global deadlock detector";
+    keywords[4] = NULL;
+    values[4] = NULL;
+
+    conn = PQconnectdbParams(keywords, values, false);
+    list_free_deep(dirs);
+    pfree(rawstring);
+
+    if (PQstatus(conn) != CONNECTION_OK)
+    {
+        ereport(LOG,
+                (errmsg("global deadlock detector could not connect: %s",
+                        PQerrorMessage(conn))));
+        PQfinish(conn);
+        return NULL;
+    }
+
+    return conn;
+}
+
+/*
+ * Main entry point of the global deadlock detector.
+ */
+void
+GlobalDeadlockDetectorMain(Datum main_arg)
+{
+    PGconn       *conn = NULL;
+
+    /* Establish signal handlers. */
+    pqsignal(SIGHUP, gdd_sighup);
+    pqsignal(SIGTERM, die);
+    BackgroundWorkerUnblockSignals();
+
+    for (;;)
+    {
+        int            rc;
+
+        CHECK_FOR_INTERRUPTS();
+
+        ResetLatch(MyLatch);
+
+        if (got_SIGHUP)
+        {
+            got_SIGHUP = false;
+            ProcessConfigFile(PGC_SIGHUP);
+        }
+
+        if (global_deadlock_detector_interval > 0)
+        {
+            if (conn == NULL)
+                conn = gdd_connect();
+
+            if (conn != NULL)
+            {
+                PGresult   *res;
+
+                res = PQexec(conn, "SELECT pg_catalog.pg_detect_global_deadlock()");
+                if (PQresultStatus(res) != PGRES_TUPLES_OK)
+                {
+                    ereport(LOG,
+                            (errmsg("global deadlock detection failed: %s",
+                                    PQerrorMessage(conn))));
+
+                    /* start over with a new connection */
+                    PQfinish(conn);
+                    conn = NULL;
+                }
+                PQclear(res);
+            }
+        }
+        else if (conn != NULL)
+        {
+            PQfinish(conn);
+            conn = NULL;
+        }
+
+        rc = WaitLatch(MyLatch,
+                       WL_LATCH_SET | WL_POSTMASTER_DEATH |
+                       (global_deadlock_detector_interval > 0 ? WL_TIMEOUT : 0),
+                       global_deadlock_detector_interval,
+                       WAIT_EVENT_GLOBAL_DEADLOCK_DETECTOR_MAIN);
+
+        /* emergency bailout if postmaster has died */
+        if (rc & WL_POSTMASTER_DEATH)
+            proc_exit(1);
+    }
+}
+
+/*
+ * pg_lock_wait_graph
+ *
+ * Report the wait-for edges between distributed transactions on this node,
+ * i.e. which global xid waits for a lock held or requested earlier by which
+ * other one. Waits involving local-only transactions are left out.
+ */
+Datum
+pg_lock_wait_graph(PG_FUNCTION_ARGS)
+{
+    ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+    TupleDesc    tupdesc;
+    Tuplestorestate *tupstore;
+    MemoryContext per_query_ctx;
+    MemoryContext oldcontext;
+    LockData   *lockData;
+    int           *waiters;
+    int            nwaiters = 0;
+    int            i;
+    int            j;
+
+    /* check to see if caller supports us returning a tuplestore */
+    if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo))
+        ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                 errmsg("set-valued function called in context that cannot accept a set")));
+    if (!(rsinfo->allowedModes & SFRM_Materialize))
+        ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                 errmsg("materialize mode required, but it is not " \
+                        "allowed in this context")));
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+        elog(ERROR, "return type must be a row type");
+
+    per_query_ctx = rsinfo->econtext->ecxt_per_query_memory;
+    oldcontext = MemoryContextSwitchTo(per_query_ctx);
+
+    tupstore = tuplestore_begin_heap(true, false, work_mem);
+    rsinfo->returnMode = SFRM_Materialize;
+    rsinfo->setResult = tupstore;
+    rsinfo->setDesc = tupdesc;
+
+    MemoryContextSwitchTo(oldcontext);
+
+    /* find the processes waiting for a lock */
+    lockData = GetLockStatusData();
+    waiters = (int *) palloc(Max(lockData->nelements, 1) * sizeof(int));
+    for (i = 0; i < lockData->nelements; i++)
+    {
+        LockInstanceData *instance = &lockData->locks[i];
+
+        if (instance->waitLockMode == NoLock)
+            continue;
+
+        for (j = 0; j < nwaiters; j++)
+        {
+            if (waiters[j] == instance->pid)
+                break;
+        }
+        if (j == nwaiters)
+            waiters[nwaiters++] = instance->pid;
+    }
+
+    for (i = 0; i < nwaiters; i++)
+    {
+        char        waiter_gxid[NAMEDATALEN];
+        ArrayType  *blockers;
+        Datum       *elems;
+        int            nelems;
+
+        if (!GetGlobalXidOfPid(waiters[i], waiter_gxid))
+            continue;
+
+        blockers = DatumGetArrayTypeP(DirectFunctionCall1(pg_blocking_pids,
+                                                          Int32GetDatum(waiters[i])));
+        deconstruct_array(blockers, INT4OID, sizeof(int32), true, 'i',
+                          &elems, NULL, &nelems);
+
+        for (j = 0; j < nelems; j++)
+        {
+            char        holder_gxid[NAMEDATALEN];
+            int            holder_pid = DatumGetInt32(elems[j]);
+            Datum        values[4];
+            bool        nulls[4];
+
+            if (!GetGlobalXidOfPid(holder_pid, holder_gxid) ||
+                strcmp(waiter_gxid, holder_gxid) == 0)
+                continue;
+
+            memset(nulls, 0, sizeof(nulls));
+            values[0] = CStringGetTextDatum(waiter_gxid);
+            values[1] = Int32GetDatum(waiters[i]);
+            values[2] = CStringGetTextDatum(holder_gxid);
+            values[3] = Int32GetDatum(holder_pid);
+
+            tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+        }
+    }
+
+    tuplestore_donestoring(tupstore);
+
+    return (Datum) 0;
+}
+
+/*
+ * pg_cancel_global_xid
+ *
+ * Cancel the lock waits of the backends working for a distributed
+ * transaction on this node, with a deadlock error.
+ */
+Datum
+pg_cancel_global_xid(PG_FUNCTION_ARGS)
+{
+    char       *gxid = text_to_cstring(PG_GETARG_TEXT_PP(0));
+
+    if (!superuser())
+        ereport(ERROR,
+                (errcode(ERRCODE_INSUFFICIENT_PRIVILEGE),
+                 (errmsg("must be superuser to cancel a global transaction"))));
+
+    PG_RETURN_INT32(SignalGlobalXidBackends(gxid, PROCSIG_GLOBAL_DEADLOCK));
+}
+
+/*
+ * Run query on all datanodes, returning its rows as arrays of natts
+ * strings. The query must return natts columns of type text.
+ */
+static List *
+gdd_exec_on_datanodes(const char *query, int natts)
+{
+    List       *rows = NIL;
+    Oid           *dn_node_list;
+    EState       *estate;
+    MemoryContext oldcontext;
+    RemoteQuery *plan;
+    RemoteQueryState *pstate;
+    TupleTableSlot *result;
+    int            i;
+
+    dn_node_list = (Oid *) palloc0(NumDataNodes * sizeof(Oid));
+    PGXCGetAllDnOid(dn_node_list);
+
+    plan = makeNode(RemoteQuery);
+    plan->combine_type = COMBINE_TYPE_NONE;
+    plan->exec_nodes = makeNode(ExecNodes);
+    plan->exec_type = EXEC_ON_DATANODES;
+    for (i = 0; i < NumDataNodes; i++)
+    {
+        char        ntype = PGXC_NODE_NONE;
+
+        plan->exec_nodes->nodeList = lappend_int(plan->exec_nodes->nodeList,
+                                                 PGXCNodeGetNodeId(dn_node_list[i], &ntype));
+    }
+    plan->sql_statement = (char *) query;
+    plan->force_autocommit = false;
+    for (i = 1; i <= natts; i++)
+    {
+        Var           *dummy = makeVar(1, i, TEXTOID, 0, InvalidOid, 0);
+
+        plan->scan.plan.targetlist = lappend(plan->scan.plan.targetlist,
+                                             makeTargetEntry((Expr *) dummy, i, NULL, false));
+    }
+
+    estate = CreateExecutorState();
+    oldcontext = MemoryContextSwitchTo(estate->es_query_cxt);
+    estate->es_snapshot = GetActiveSnapshot();
+    pstate = ExecInitRemoteQuery(plan, estate, 0);
+    MemoryContextSwitchTo(oldcontext);
+
+    result = ExecRemoteQuery((PlanState *) pstate);
+    while (result != NULL && !TupIsNull(result))
+    {
+        char      **row = (char **) palloc0(natts * sizeof(char *));
+
+        slot_getallattrs(result);
+        for (i = 0; i < natts; i++)
+        {
+            if (!result->tts_isnull[i])
+                row[i] = TextDatumGetCString(result->tts_values[i]);
+        }
+        rows = lappend(rows, row);
+
+        result = ExecRemoteQuery((PlanState *) pstate);
+    }
+    ExecEndRemoteQuery(pstate);
+    FreeExecutorState(estate);
+    pfree(dn_node_list);
+
+    return rows;
+}
+
+/*
+ * Take a snapshot of the wait-for edges of all datanodes, as a hash table
+ * of GddEdgeKey. Returns NULL if nobody is waiting.
+ */
+static HTAB *
+gdd_collect_edges(void)
+{
+    HASHCTL        ctl;
+    HTAB       *edges;
+    List       *rows;
+    ListCell   *lc;
+
+    rows = gdd_exec_on_datanodes("SELECT pg_catalog.pgxc_node_str()::text, "
+                                 "waiter_gxid, holder_gxid "
+                                 "FROM pg_catalog.pg_lock_wait_graph()", 3);
+    if (rows == NIL)
+        return NULL;
+
+    memset(&ctl, 0, sizeof(ctl));
+    ctl.keysize = sizeof(GddEdgeKey);
+    ctl.entrysize = sizeof(GddEdgeKey);
+    ctl.hcxt = CurrentMemoryContext;
+    edges = hash_create("global deadlock edges", list_length(rows), &ctl,
+                        HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
+    foreach(lc, rows)
+    {
+        char      **row = (char **) lfirst(lc);
+        GddEdgeKey    key;
+
+        if (row[0] == NULL || row[1] == NULL || row[2] == NULL)
+            continue;
+
+        memset(&key, 0, sizeof(key));
+        strlcpy(key.node, row[0], NAMEDATALEN);
+        strlcpy(key.waiter, row[1], NAMEDATALEN);
+        strlcpy(key.holder, row[2], NAMEDATALEN);
+        (void) hash_search(edges, &key, HASH_ENTER, NULL);
+    }
+
+    return edges;
+}
+
+/* vertex number of gxid, adding it to the graph if it is new */
+static int
+gdd_vertex(GddGraph *graph, HTAB *vertices, const char *gxid)
+{
+    GddVertexEnt *ent;
+    char        key[NAMEDATALEN];
+    bool        found;
+
+    memset(key, 0, sizeof(key));
+    strlcpy(key, gxid, NAMEDATALEN);
+    ent = (GddVertexEnt *) hash_search(vertices, key, HASH_ENTER, &found);
+    if (!found)
+    {
+        ent->vertex = graph->nvertices++;
+        graph->gxids[ent->vertex] = pstrdup(gxid);
+        graph->out[ent->vertex] = NIL;
+    }
+
+    return ent->vertex;
+}
+
+/*
+ * Build the wait-for graph from the edges found in both snapshots.
+ */
+static GddGraph *
+gdd_build_graph(HTAB *previous, HTAB *current)
+{
+    GddGraph   *graph;
+    HASHCTL        ctl;
+    HTAB       *vertices;
+    HASH_SEQ_STATUS status;
+    GddEdgeKey *key;
+    long        nedges = hash_get_num_entries(current);
+
+    graph = (GddGraph *) palloc0(sizeof(GddGraph));
+    graph->gxids = (char **) palloc0(2 * nedges * sizeof(char *));
+    graph->removed = (bool *) palloc0(2 * nedges * sizeof(bool));
+    graph->out = (List **) palloc0(2 * nedges * sizeof(List *));
+    graph->holder = (int *) palloc0(nedges * sizeof(int));
+    graph->node = (char **) palloc0(nedges * sizeof(char *));
+
+    memset(&ctl, 0, sizeof(ctl));
+    ctl.keysize = NAMEDATALEN;
+    ctl.entrysize = sizeof(GddVertexEnt);
+    ctl.hcxt = CurrentMemoryContext;
+    vertices = hash_create("global deadlock vertices", 2 * nedges, &ctl,
+                           HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
+    hash_seq_init(&status, current);
+    while ((key = (GddEdgeKey *) hash_seq_search(&status)) != NULL)
+    {
+        int            waiter;
+        int            holder;
+
+        if (hash_search(previous, key, HASH_FIND, NULL) == NULL)
+            continue;
+
+        waiter = gdd_vertex(graph, vertices, key->waiter);
+        holder = gdd_vertex(graph, vertices, key->holder);
+
+        graph->holder[graph->nedges] = holder;
+        graph->node[graph->nedges] = pstrdup(key->node);
+        graph->out[waiter] = lappend_int(graph->out[waiter], graph->nedges);
+        graph->nedges++;
+    }
+
+    hash_destroy(vertices);
+
+    return graph;
+}
+
+/*
+ * Depth-first search from vertex v for a cycle. The edges of a cycle found
+ * are returned in cycle_edges.
+ */
+static bool
+gdd_search(GddGraph *graph, int v, int *state, int *path_vertices,
+           int *path_edges, int *depth, int *cycle_edges, int *ncycle)
+{
+    ListCell   *lc;
+
+    check_stack_depth();
+
+    state[v] = 1;                /* on the current path */
+    path_vertices[*depth] = v;
+
+    foreach(lc, graph->out[v])
+    {
+        int            e = lfirst_int(lc);
+        int            w = graph->holder[e];
+
+        if (graph->removed[w])
+            continue;
+
+        path_edges[*depth] = e;
+
+        if (state[w] == 1)
+        {
+            int            start;
+            int            i;
+
+            for (start = *depth; path_vertices[start] != w; start--)
+                ;
+            *ncycle = 0;
+            for (i = start; i <= *depth; i++)
+                cycle_edges[(*ncycle)++] = path_edges[i];
+            return true;
+        }
+
+        if (state[w] == 0)
+        {
+            (*depth)++;
+            if (gdd_search(graph, w, state, path_vertices, path_edges, depth,
+                           cycle_edges, ncycle))
+                return true;
+            (*depth)--;
+        }
+    }
+
+    state[v] = 2;                /* done, no cycle through here */
+
+    return false;
+}
+
+/*
+ * Find a cycle among the vertices not removed yet. Returns the number of
+ * its edges, which are stored in cycle_edges, or 0.
+ */
+static int
+gdd_find_cycle(GddGraph *graph, int *cycle_edges)
+{
+    int           *state = (int *) palloc0(graph->nvertices * sizeof(int));
+    int           *path_vertices = (int *) palloc(graph->nvertices * sizeof(int));
+    int           *path_edges = (int *) palloc(graph->nvertices * sizeof(int));
+    int            ncycle = 0;
+    int            v;
+
+    for (v = 0; v < graph->nvertices && ncycle == 0; v++)
+    {
+        int            depth = 0;
+
+        if (graph->removed[v] || state[v] != 0)
+            continue;
+
+        (void) gdd_search(graph, v, state, path_vertices, path_edges, &depth,
+                          cycle_edges, &ncycle);
+    }
+
+    pfree(state);
+    pfree(path_vertices);
+    pfree(path_edges);
+
+    return ncycle;
+}
+
+/*
+ * pg_detect_global_deadlock
+ *
+ * Look for wait-for cycles across datanodes and cancel one transaction of
+ * each. Returns the number of transactions cancelled.
+ */
+Datum
+pg_detect_global_deadlock(PG_FUNCTION_ARGS)
+{
+    HTAB       *previous;
+    HTAB       *current;
+    GddGraph   *graph;
+    int           *cycle_edges;
+    int            ncycle;
+    int            nvictims = 0;
+
+    if (!superuser())
+        ereport(ERROR,
+                (errcode(ERRCODE_INSUFFICIENT_PRIVILEGE),
+                 (errmsg("must be superuser to detect global deadlocks"))));
+
+    if (!IS_PGXC_LOCAL_COORDINATOR)
+        ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                 errmsg("global deadlocks can only be detected on a coordinator")));
+
+    if (NumDataNodes == 0)
+        PG_RETURN_INT32(0);
+
+    previous = gdd_collect_edges();
+    if (previous == NULL)
+        PG_RETURN_INT32(0);
+
+    current = gdd_collect_edges();
+    if (current == NULL)
+        PG_RETURN_INT32(0);
+
+    graph = gdd_build_graph(previous, current);
+    cycle_edges = (int *) palloc(Max(graph->nvertices, 1) * sizeof(int));
+
+    while ((ncycle = gdd_find_cycle(graph, cycle_edges)) > 0)
+    {
+        StringInfoData cycle;
+        bool        local = true;
+        int            victim = -1;
+        int            i;
+
+        initStringInfo(&cycle);
+        for (i = 0; i < ncycle; i++)
+        {
+            int            w = graph->holder[cycle_edges[i]];
+
+            if (strcmp(graph->node[cycle_edges[i]], graph->node[cycle_edges[0]]) != 0)
+                local = false;
+
+            /* the largest global xid is the victim */
+            if (victim < 0 || strcmp(graph->gxids[w], graph->gxids[victim]) > 0)
+                victim = w;
+
+            appendStringInfo(&cycle, "%s%s waits for %s on %s",
+                             i > 0 ? "; " : "",
+                             graph->gxids[graph->holder[cycle_edges[(i + ncycle - 1) % ncycle]]],
+                             graph->gxids[w],
+                             graph->node[cycle_edges[i]]);
+        }
+
+        graph->removed[victim] = true;
+
+        /* deadlock.c breaks cycles within one node by itself */
+        if (!local)
+        {
+            char       *query;
+
+            ereport(LOG,
+                    (errcode(ERRCODE_T_R_DEADLOCK_DETECTED),
+                     errmsg("global deadlock detected, canceling transaction %s",
+                            graph->gxids[victim]),
+                     errdetail_internal("%s.", cycle.data)));
+
+            query = psprintf("SELECT pg_catalog.pg_cancel_global_xid(%s)::text",
+                             quote_literal_cstr(graph->gxids[victim]));
+            (void) gdd_exec_on_datanodes(query, 1);
+            pfree(query);
+            nvictims++;
+        }
+
+        pfree(cycle.data);
+    }
+
+    PG_RETURN_INT32(nvictims);
+}
@@ -18,16 +18,47 @@
 #include "storage/shmem.h"
 #include "storage/spin.h"
 #include "miscadmin.h"
+#include "utils/timestamp.h"
 
 /* globals */
 bool cluster_lock_held;
 bool cluster_ex_lock_held;
+int  cluster_pause_drain_timeout = 0;
 
 static void HandleClusterPause(bool pause, bool initiator);
 static void ProcessClusterPauseRequest(bool pause);
+static void SwitchClusterLock(bool pause);
 
 ClusterLockInfo *ClustLinfo = NULL;
 
+/*
+ * SwitchClusterLock:
+ *
+ * Trade our shared cluster lock for the exclusive one on PAUSE, and back on
+ * UNPAUSE. If the running transactions do not drain in time, or we are
+ * cancelled, get our shared lock back before passing the error on so that
+ * the process count stays right.
+ */
+static void
+SwitchClusterLock(bool pause)
+{
+    ReleaseClusterLock(pause? false:true);
+
+    PG_TRY();
+    {
+        AcquireClusterLock(pause? true:false);
+    }
+    PG_CATCH();
+    {
+        if (pause)
+            AcquireClusterLock(false);
+        PG_RE_THROW();
+    }
+    PG_END_TRY();
+
+    cluster_ex_lock_held = pause;
+}
+
 /*
  * ProcessClusterPauseRequest:
  *
@@ -57,18 +88,10 @@ ProcessClusterPauseRequest(bool pause)
                      errmsg("Received an UNPAUSE request when cluster not PAUSED!")));
 
     /*
-     * Enable/Disable local queries. We need to release the lock first
-     *
-     * TODO: Think of some timeout mechanism here, if the locking takes too
-     * much time...
+     * Enable/Disable local queries. The wait for running transactions is
+     * bounded by cluster_pause_drain_timeout.
      */
-    ReleaseClusterLock(pause? false:true);
-    AcquireClusterLock(pause? true:false);
-
-    if (pause)
-        cluster_ex_lock_held = true;
-    else
-        cluster_ex_lock_held = false;
+    SwitchClusterLock(pause);
 
     elog(DEBUG2, "%s queries at the coordinator", pause? "Paused":"Resumed");
 
@@ -135,26 +158,10 @@ HandleClusterPause(bool pause, bool initiator)
     }
 
     /*
-     * Disable/Enable local queries. We need to release the SHARED mode first
-     *
-     * TODO: Start a timer to cancel the request in case of a timeout
-     */
-    ReleaseClusterLock(pause? false:true);
-    AcquireClusterLock(pause? true:false);
-
-    if (pause)
-        cluster_ex_lock_held = true;
-    else
-        cluster_ex_lock_held = false;
-
-
-    elog(DEBUG2, "%s queries at the driving coordinator", pause? "Paused":"Resumed");
-
-    /*
-     * Local queries are paused/enabled. Check status of the remote coordinators
-     * now. We need a TRY/CATCH block here, so that if one of the coordinator
-     * fails for some reason, we can try best-effort to salvage the situation
-     * at others
+     * Disable/Enable local queries, then check status of the remote
+     * coordinators. We need a TRY/CATCH block here, so that if the local
+     * drain times out or one of the coordinator fails for some reason, we
+     * can try best-effort to salvage the situation at others
      *
      * We hope that errors in the earlier loop generally do not occur (out of
      * memory and improper handles..) or we can have a similar TRY/CATCH block
@@ -166,6 +173,10 @@ HandleClusterPause(bool pause, bool initiator)
     {
         ResponseCombiner combiner;
 
+        SwitchClusterLock(pause);
+
+        elog(DEBUG2, "%s queries at the driving coordinator", pause? "Paused":"Resumed");
+
         InitResponseCombiner(&combiner, coord_handles->co_conn_count, COMBINE_TYPE_NONE);
         for (conn = 0; conn < coord_handles->co_conn_count; conn++)
         {
@@ -237,9 +248,12 @@ HandleClusterPause(bool pause, bool initiator)
              */
         }
 
-        /* cleanup locally.. */
-        ReleaseClusterLock(pause? true:false);
-        AcquireClusterLock(pause? false:true);
+        /* cleanup locally, unless the local PAUSE itself failed.. */
+        if (!pause || cluster_ex_lock_held)
+        {
+            ReleaseClusterLock(pause? true:false);
+            AcquireClusterLock(pause? false:true);
+        }
         cluster_ex_lock_held = false;
         PG_RE_THROW();
     }
@@ -365,11 +379,16 @@ ClusterLockShmemInit(void)
  *  cluster lock is held. But again we are really not worried about performance
  *  and immediate wakeups around PAUSE CLUSTER functionality. Using the sleep
  *  in an infinite loop keeps things simple yet correct
+ *
+ *  While a PAUSE waits for the running transactions to finish, new ones are
+ *  held back, otherwise a busy cluster would never drain. The wait is bounded
+ *  by cluster_pause_drain_timeout.
  */
 void
 AcquireClusterLock(bool exclusive)
 {// #lizard forgives
     volatile ClusterLockInfo *clinfo = ClustLinfo;
+    TimestampTz start = 0;
 
     if (exclusive && cluster_ex_lock_held)
     {
@@ -389,14 +408,15 @@ AcquireClusterLock(bool exclusive)
 
         if (!exclusive)
         {
-            if (clinfo->cl_holder_pid == 0)
+            if (clinfo->cl_holder_pid == 0 && clinfo->cl_waiter_pid == 0)
                 clinfo->cl_process_count++;
             else
                 wait = true;
         }
         else /* PAUSE CLUSTER handling */
         {
-            if (clinfo->cl_holder_pid != 0)
+            if (clinfo->cl_holder_pid != 0 ||
+                (clinfo->cl_waiter_pid != 0 && clinfo->cl_waiter_pid != MyProcPid))
             {
                 SpinLockRelease(&clinfo->cl_mutex);
                 ereport(ERROR,
@@ -409,9 +429,30 @@ AcquireClusterLock(bool exclusive)
              * holding the lock including ourself
              */
             if (clinfo->cl_process_count  > 0)
+            {
+                int running = clinfo->cl_process_count;
+
+                if (start == 0)
+                    start = GetCurrentTimestamp();
+                else if (cluster_pause_drain_timeout > 0 &&
+                         TimestampDifferenceExceeds(start, GetCurrentTimestamp(),
+                                                    cluster_pause_drain_timeout))
+                {
+                    clinfo->cl_waiter_pid = 0;
+                    SpinLockRelease(&clinfo->cl_mutex);
+                    ereport(ERROR,
+                            (errcode(ERRCODE_LOCK_NOT_AVAILABLE),
+                             errmsg("PAUSE CLUSTER timed out, %d transactions still running",
+                                    running)));
+                }
+                clinfo->cl_waiter_pid = MyProcPid;
                 wait = true;
+            }
             else
+            {
+                clinfo->cl_waiter_pid = 0;
                 clinfo->cl_holder_pid = MyProcPid;
+            }
         }
         SpinLockRelease(&clinfo->cl_mutex);
 
@@ -421,6 +462,13 @@ AcquireClusterLock(bool exclusive)
          */
         if (wait)
         {
+            /* don't leave new transactions blocked if we are cancelled */
+            if (exclusive && InterruptPending)
+            {
+                SpinLockAcquire(&clinfo->cl_mutex);
+                clinfo->cl_waiter_pid = 0;
+                SpinLockRelease(&clinfo->cl_mutex);
+            }
             CHECK_FOR_INTERRUPTS();
             pg_usleep(100000L);
         }
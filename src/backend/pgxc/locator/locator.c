@@ -25,6 +25,7 @@
 #include "postgres.h"
 #include "access/skey.h"
 #include "access/gtm.h"
+#include "access/sysattr.h"
 #include "access/relscan.h"
 #include "catalog/indexing.h"
 #include "catalog/pg_type.h"
@@ -193,6 +194,10 @@ static bool TimeStampRange(Oid op);
 #endif
 
 static bool DatanodeInGroup(oidvector* nodeoids, Oid nodeoid);
+#ifdef __TBASE__
+static ExecNodes *GetRelationNodesByShardId(RelationLocInfo *rel_loc_info,
+                            Index varno, Node *quals, RelationAccessType relaccess);
+#endif
 
 
 /*
@@ -2149,6 +2154,54 @@ GET_NODES(Locator *self, Datum value, bool isnull,
 }
 
 #ifdef __TBASE__
+/*
+ * GET_NODES_BATCH
+ *
+ * Route many values of the distribution column at once: the values are
+ * hashed together and the shard map is looked up once.  For each value the
+ * position of its target node in the node map of the locator is written to
+ * nodes.  Only shard locators for INSERT without a secondary distribution
+ * column can route like this; for the others false is returned and the
+ * caller has to use GET_NODES for each value.
+ */
+bool
+GET_NODES_BATCH(Locator *self, Datum *values, bool *nulls, int nvalues, int *nodes)
+{
+    long   *hashvalues;
+    int32  *global_indexes;
+    int     i;
+
+    if (self->locatefunc != locate_shard_insert || self->need_shardmap_router)
+        return false;
+
+    if (nvalues <= 0)
+        return true;
+
+    hashvalues = (long *) palloc(sizeof(long) * nvalues);
+    global_indexes = (int32 *) palloc(sizeof(int32) * nvalues);
+
+    compute_hash_batch(self->dataType, values, nulls, nvalues,
+                       LOCATOR_TYPE_SHARD, hashvalues);
+    GetNodeIndexesByHashValues(self->groupid, hashvalues, nvalues, global_indexes);
+
+    for (i = 0; i < nvalues; i++)
+    {
+        if (self->listType == LOCATOR_LIST_POINTER)
+        {
+            nodes[i] = self->nodeindexMap[global_indexes[i]];
+            if (nodes[i] == -1)
+                elog(ERROR, "could not map global_index %d to local", global_indexes[i]);
+        }
+        else
+            nodes[i] = global_indexes[i];
+    }
+
+    pfree(hashvalues);
+    pfree(global_indexes);
+
+    return true;
+}
+
 char
 getLocatorDisType(Locator *self)
 {
@@ -2727,6 +2780,22 @@ GetRelationNodesByQuals(Oid reloid, RelationLocInfo *rel_loc_info,
                     exec_nodes->baselocatortype = rel_loc_info->locatorType;
                     exec_nodes->accesstype = relaccess;
                     exec_nodes->nodeList = newnodelist;
+
+                    /* remember how many cold nodes the time range saved us from */
+                    if (OidIsValid(rel_loc_info->coldGroupId) &&
+                        !list_member_oid(oids, rel_loc_info->coldGroupId))
+                    {
+                        int32 dn_num;
+                        int32 *datanodes;
+
+                        GetShardNodes(rel_loc_info->coldGroupId, &datanodes, &dn_num, NULL);
+                        for (i = 0; i < dn_num; i++)
+                        {
+                            if (!list_member_int(newnodelist, datanodes[i]))
+                                exec_nodes->cold_pruned++;
+                        }
+                        pfree(datanodes);
+                    }
                     return exec_nodes;
                 }
             }
@@ -2734,6 +2803,16 @@ GetRelationNodesByQuals(Oid reloid, RelationLocInfo *rel_loc_info,
 #endif
     }
 
+#ifdef __TBASE__
+    /* no distribution key qual, but the shard may still be pinned down */
+    if (distcol_expr == NULL)
+    {
+        exec_nodes = GetRelationNodesByShardId(rel_loc_info, varno, quals, relaccess);
+        if (exec_nodes)
+            return exec_nodes;
+    }
+#endif
+
     exec_nodes = GetRelationNodes(rel_loc_info, distcol_value,
                                                 distcol_isnull,
 #ifdef __COLD_HOT__
@@ -2743,6 +2822,74 @@ GetRelationNodesByQuals(Oid reloid, RelationLocInfo *rel_loc_info,
     return exec_nodes;
 }
 
+#ifdef __TBASE__
+/*
+ * GetRelationNodesByShardId
+ * Route a scan of a shard table to a single Datanode when the quals contain
+ * "shardid = <const>". Lookups on a non-distribution column can be served
+ * this way by first reading the row's shardid from a table distributed by
+ * that column, so they no longer have to visit every Datanode.
+ *
+ * Rows of tables routed by a second distribution column or by key values
+ * do not live where their shard id points to, so those are left alone.
+ */
+static ExecNodes *
+GetRelationNodesByShardId(RelationLocInfo *rel_loc_info, Index varno,
+                          Node *quals, RelationAccessType relaccess)
+{
+    Expr       *shard_expr;
+    Const      *shard_const;
+    int32       nodeindex;
+    ExecNodes  *exec_nodes;
+
+    if (rel_loc_info->locatorType != LOCATOR_TYPE_SHARD ||
+        !OidIsValid(rel_loc_info->groupId) ||
+        OidIsValid(rel_loc_info->coldGroupId) ||
+        AttributeNumberIsValid(rel_loc_info->secAttrNum) ||
+        g_EnableKeyValue)
+        return NULL;
+
+    shard_expr = pgxc_find_distcol_expr(varno, ShardIdAttributeNumber, quals);
+    if (shard_expr == NULL)
+        return NULL;
+
+    shard_expr = (Expr *) coerce_to_target_type(NULL,
+                                    (Node *) shard_expr,
+                                    exprType((Node *) shard_expr),
+                                    INT4OID, -1,
+                                    COERCION_ASSIGNMENT,
+                                    COERCE_IMPLICIT_CAST, -1);
+    if (shard_expr == NULL)
+        return NULL;
+    shard_expr = (Expr *) eval_const_expressions(NULL, (Node *) shard_expr);
+    if (!IsA(shard_expr, Const))
+        return NULL;
+
+    shard_const = (Const *) shard_expr;
+    exec_nodes = makeNode(ExecNodes);
+    exec_nodes->baselocatortype = rel_loc_info->locatorType;
+    exec_nodes->accesstype = relaccess;
+
+    /* shardid = NULL matches nothing, any single node gives the empty result */
+    if (shard_const->constisnull)
+    {
+        exec_nodes->nodeList = list_make1_int(linitial_int(rel_loc_info->rl_nodeList));
+        return exec_nodes;
+    }
+
+    nodeindex = GetNodeIndexByShardId(rel_loc_info->groupId,
+                                      DatumGetInt32(shard_const->constvalue));
+    if (nodeindex == PGXC_INVALID_NODE_IDX)
+    {
+        pfree(exec_nodes);
+        return NULL;
+    }
+
+    exec_nodes->nodeList = list_make1_int(nodeindex);
+    return exec_nodes;
+}
+#endif
+
 /*
  * GetRelationDistribColumn
  * Return hash column name for relation or NULL if relation is not distributed.
@@ -3345,17 +3492,21 @@ GetRelationGroupsByQuals(Oid reloid, RelationLocInfo *rel_loc_info, Node *sec_qu
     {
         List *oids = NULL;
         if (minStamp && maxStamp)
-        {            
-            if (IsHotData(minStamp, RELATION_ACCESS_READ, partitionStrategy, interval_step, start_timestamp) && IsHotData(maxStamp, RELATION_ACCESS_READ, partitionStrategy, interval_step, start_timestamp))
+        {
+            /* decide each bound once, IsHotData is not free */
+            bool min_hot = IsHotData(minStamp, RELATION_ACCESS_READ, partitionStrategy, interval_step, start_timestamp);
+            bool max_hot = IsHotData(maxStamp, RELATION_ACCESS_READ, partitionStrategy, interval_step, start_timestamp);
+
+            if (min_hot && max_hot)
             {    /* all hot data */
                 oids = lappend_oid(oids, rel_loc_info->groupId);                                
             }
-            else if (!IsHotData(minStamp, RELATION_ACCESS_READ, partitionStrategy, interval_step, start_timestamp) && !IsHotData(maxStamp, RELATION_ACCESS_READ, partitionStrategy, interval_step, start_timestamp))
+            else if (!min_hot && !max_hot)
             {
                 /* all cold data */
                 oids = lappend_oid(oids, rel_loc_info->coldGroupId);
             }
-            else if(!IsHotData(minStamp, RELATION_ACCESS_READ, partitionStrategy, interval_step, start_timestamp) && IsHotData(maxStamp, RELATION_ACCESS_READ, partitionStrategy, interval_step, start_timestamp))
+            else if(!min_hot && max_hot)
             {
                 /* range across cold and hot group */
                 oids = lappend_oid(oids, rel_loc_info->groupId);
@@ -58,6 +58,7 @@ static void count_coords_datanodes(Relation rel, int *num_coord, int *num_dns);
 static void  PgxcCheckNodeValid(char *name, char *clustername, char type);
 static void  ValidateCreateGtmNode(void);
 static void  ValidateAlterGtmNode(void);
+static bool  PgxcNodeDefinitionsChanged(NodeDefinition *old_nodes, int num_old);
 #endif
 
 /*
@@ -81,6 +82,13 @@ NodeDefinition *sdnDefs;
 #ifdef __TBASE__
 char *PGXCNodeHost;
 static char *g_TbasePlane = NULL;
+
+/*
+ * Bumped under NodeTableLock whenever the node definitions in the shared
+ * tables change.  Sessions compare it with the version their handles were
+ * built from and refresh them lazily, the next time they need a connection.
+ */
+static uint32 *shmemNodeTableVersion = NULL;
 #endif
 
 /* HashTable key: nodeoid  value: position of coDefs/dnDefs */
@@ -187,6 +195,14 @@ NodeTablesShmemInit(void)
 	{
 		g_TbasePlane[0] = '\0';
 	}
+
+    shmemNodeTableVersion = (uint32 *) ShmemInitStruct("Node Table Version",
+                                                       sizeof(uint32),
+                                                       &found);
+    if (!found)
+    {
+        *shmemNodeTableVersion = 0;
+    }
     
     NodeDefHashTabShmemInit();
 #endif
@@ -257,6 +273,9 @@ NodeTablesShmemSize(void)
     total_size = add_size(total_size, dn_slave_size);
     total_size = add_size(total_size, NAMEDATALEN);
 	total_size = add_size(total_size, NAMEDATALEN);
+#ifdef __TBASE__
+    total_size = add_size(total_size, sizeof(uint32));
+#endif
     return total_size;
 }
 
@@ -709,9 +728,6 @@ PgxcNodeListAndCount(void)
     elog(DEBUG1, "Done pgxc_nodes scan: %d coordinators and %d datanodes and %d slavedatanodes",
             *shmemNumCoords, *shmemNumDataNodes, *shmemNumSlaveDataNodes);
 
-    if (numNodes)
-        pfree(nodes);
-
     /* Finally sort the lists */
     if (*shmemNumCoords > 1)
         qsort(coDefs, *shmemNumCoords, sizeof(NodeDefinition), cmp_nodes);
@@ -721,6 +737,21 @@ PgxcNodeListAndCount(void)
     if (*shmemNumSlaveDataNodes > 1)
         qsort(sdnDefs, *shmemNumSlaveDataNodes, sizeof(NodeDefinition), cmp_nodes);
 
+#ifdef __TBASE__
+    /*
+     * Every session reloads the tables when it starts, so only tell the
+     * others about it when a definition really changed.
+     */
+    if (PgxcNodeDefinitionsChanged(nodes, numNodes))
+    {
+        (*shmemNodeTableVersion)++;
+        elog(DEBUG1, "node table version bumped to %u", *shmemNodeTableVersion);
+    }
+#endif
+
+    if (numNodes)
+        pfree(nodes);
+
 #ifdef __TBASE__
 	/* set plane type */
 	if (g_TbasePlane[0] == '\0')
@@ -801,6 +832,65 @@ PgxcNodeListAndCount(void)
     LWLockRelease(NodeTableLock);
 }
 
+#ifdef __TBASE__
+/*
+ * PgxcNodeDefinitionsChanged
+ *
+ * Compare the sorted shared tables with a copy taken before they were
+ * rebuilt.  Health status is not part of the definition.
+ */
+static bool
+PgxcNodeDefinitionsChanged(NodeDefinition *old_nodes, int num_old)
+{
+    NodeDefinition *tables[3];
+    int             counts[3];
+    int             i;
+    int             j;
+    int             k = 0;
+
+    if (num_old != *shmemNumCoords + *shmemNumDataNodes + *shmemNumSlaveDataNodes)
+        return true;
+
+    tables[0] = coDefs;
+    counts[0] = *shmemNumCoords;
+    tables[1] = dnDefs;
+    counts[1] = *shmemNumDataNodes;
+    tables[2] = sdnDefs;
+    counts[2] = *shmemNumSlaveDataNodes;
+
+    for (i = 0; i < 3; i++)
+    {
+        for (j = 0; j < counts[i]; j++, k++)
+        {
+            NodeDefinition *cur = &tables[i][j];
+            NodeDefinition *old = &old_nodes[k];
+
+            if (cur->nodeoid != old->nodeoid ||
+                cur->nodeport != old->nodeport ||
+                cur->nodeisprimary != old->nodeisprimary ||
+                cur->nodeispreferred != old->nodeispreferred ||
+                strncmp(NameStr(cur->nodename), NameStr(old->nodename), NAMEDATALEN) != 0 ||
+                strncmp(NameStr(cur->nodehost), NameStr(old->nodehost), NAMEDATALEN) != 0)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * PgxcNodeTableVersion
+ *
+ * Version of the node definitions in shared memory.  Read without the lock,
+ * a 32 bits load is atomic and callers only look for a change.
+ */
+uint32
+PgxcNodeTableVersion(void)
+{
+    return *shmemNodeTableVersion;
+}
+#endif
+
 /*
  * PgxcNodeListAndCountWrapTransaction
  *
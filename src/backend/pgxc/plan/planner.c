@@ -331,6 +331,12 @@ pgxc_FQS_planner(Query *query, int cursorOptions, ParamListInfo boundParams)
      * through set_plan_references().
      */
     top_plan = set_plan_references(root, top_plan);
+#ifdef __TBASE__
+    /* the relation routing the query may not be in its range table */
+    if (OidIsValid(exec_nodes->en_relid))
+        glob->relationOids = list_append_unique_oid(glob->relationOids,
+                                                    exec_nodes->en_relid);
+#endif
 
     /* build the PlannedStmt result */
     result = makeNode(PlannedStmt);
@@ -400,6 +406,11 @@ pgxc_FQS_create_remote_plan(Query *query, ExecNodes *exec_nodes, bool is_exec_di
 
     /* Optimize multi-node handling */
     query_step->read_only = (query->commandType == CMD_SELECT && !query->hasForUpdate);
+#ifdef __TBASE__
+    /* shipped calls of shard-local functions may write */
+    if (query_step->exec_nodes->accesstype == RELATION_ACCESS_UPDATE)
+        query_step->read_only = false;
+#endif
     query_step->has_row_marks = query->hasForUpdate;
 
     /* Check if temporary tables are in use in query */
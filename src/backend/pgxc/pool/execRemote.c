@@ -19,11 +19,13 @@
 #include <time.h>
 #include "postgres.h"
 #include "access/twophase.h"
+#include "access/hash.h"
 #include "access/gtm.h"
 #include "access/sysattr.h"
 #include "access/transam.h"
 #include "access/xact.h"
 #include "access/relscan.h"
+#include "catalog/namespace.h"
 #include "catalog/pg_type.h"
 #include "catalog/pgxc_node.h"
 #include "commands/prepare.h"
@@ -45,6 +47,7 @@
 #include "storage/ipc.h"
 #include "storage/proc.h"
 #include "utils/datum.h"
+#include "utils/hsearch.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/pg_rusage.h"
@@ -66,6 +69,7 @@
 #include "executor/nodeModifyTable.h"
 #include "utils/syscache.h"
 #include "nodes/print.h"
+#include "optimizer/clauses.h"
 #endif
 /*
  * We do not want it too long, when query is terminating abnormally we just
@@ -92,10 +96,32 @@ List *executed_node_list = NULL;
 #ifdef __TBASE__
 /* GUC parameter */
 int DataRowBufferSize = 0;  /* MBytes */
+int CopySendBufferSize = 64; /* KBytes */
+bool enable_remote_rescan_cache = true;
+int remote_rescan_cache_entries = 64;
+double log_remote_misestimate_ratio = 0;
+bool async_distributed_commit = false;
 
 #define DATA_ROW_BUFFER_SIZE(n) (DataRowBufferSize * 1024 * 1024 * (n))
 #endif
 
+/*
+ * Bump allocator for the DataRows a RemoteSubplan receives. Rows are carved
+ * from one block without per-row palloc overhead and the result slot points
+ * at them directly; the block is rewound once every row handed out has been
+ * released, which happens each time the consumer catches up with the
+ * producers. Rows that do not fit fall back to palloc.
+ */
+#define REMOTE_ROW_ARENA_SIZE (256 * 1024)
+
+typedef struct RemoteRowArena
+{
+    MemoryContext context;      /* where the block is allocated */
+    char         *block;        /* allocated on first use */
+    Size          used;         /* bytes handed out since last rewind */
+    int           nlive;        /* rows handed out and not yet released */
+} RemoteRowArena;
+
 typedef struct
 {
     xact_callback function;
@@ -110,10 +136,25 @@ struct find_params_context
 };
 
 /*
- * Buffer size does not affect performance significantly, just do not allow
- * connection buffer grows infinitely
+ * Do not allow connection buffer grows infinitely. On bulk loads every flush
+ * costs a poll of the connection and a send, so the limit is a GUC.
+ */
+#ifdef __TBASE__
+#define COPY_BUFFER_SIZE ((size_t) CopySendBufferSize * 1024)
+
+/*
+ * Rows may be appended to the CopyData message buffered last, as long as
+ * nothing else was written to the connection after it.
  */
+#define COPY_DATA_CAN_APPEND(handle) \
+    ((handle)->outEnd == (handle)->copy_data_end && \
+     (handle)->copy_data_off + 5 <= (handle)->outEnd && \
+     (handle)->outBuffer[(handle)->copy_data_off] == 'd' && \
+     ntohl(*((uint32_t *) ((handle)->outBuffer + (handle)->copy_data_off + 1))) == \
+        (handle)->outEnd - (handle)->copy_data_off - 1)
+#else
 #define COPY_BUFFER_SIZE 8192
+#endif
 #define PRIMARY_NODE_WRITEAHEAD 1024 * 1024
 
 /*
@@ -122,6 +163,16 @@ struct find_params_context
 static bool temp_object_included = false;
 static abort_callback_type dbcleanup_info = { NULL, NULL };
 
+#ifdef __TBASE__
+/*
+ * Connections still owing the acknowledgement of an asynchronously committed
+ * transaction, see FinishAsyncCommit_Remote()
+ */
+static PGXCNodeHandle **async_commit_conns = NULL;
+static int    async_commit_conn_count = 0;
+static char async_commit_gid[GIDSIZE];
+#endif
+
 static int    pgxc_node_begin(int conn_count, PGXCNodeHandle ** connections,
                 GlobalTransactionId gxid, bool need_tran_block,
                 bool readOnly, char node_type);
@@ -140,7 +191,7 @@ static void pgxc_node_remote_count(int *dnCount, int dnNodeIds[],
 static char *pgxc_node_remote_prepare(char *prepareGID, bool localNode, bool implicit);
 static bool pgxc_node_remote_finish(char *prepareGID, bool commit,
                         char *nodestring, GlobalTransactionId gxid,
-                        GlobalTransactionId prepare_gxid);
+                        GlobalTransactionId prepare_gxid, bool async);
 static bool
 pgxc_node_remote_prefinish(char *prepareGID, char *nodestring);
 
@@ -152,9 +203,13 @@ static void pgxc_node_remote_commit(TranscationType txn_type, bool need_release_
 static void pgxc_node_remote_abort(TranscationType txn_type, bool need_release_handle);
 static bool SetSnapshot(EState *state);
 static int pgxc_node_remote_commit_internal(PGXCNodeAllHandles *handles, TranscationType txn_type);
+static void ExecRemoteSubplanSendFilter(RemoteSubplanState *node, SQueueFilter *filter);
 #endif
 
 static void pgxc_connections_cleanup(ResponseCombiner *combiner);
+static RemoteDataRow AllocDataRow(ResponseCombiner *combiner, size_t len);
+static void ReleaseDataRow(ResponseCombiner *combiner, RemoteDataRow datarow);
+static RemoteDataRow DetachDataRow(ResponseCombiner *combiner, RemoteDataRow datarow);
 
 static bool determine_param_types(Plan *plan,  struct find_params_context *context);
 
@@ -279,6 +334,8 @@ InitResponseCombiner(ResponseCombiner *combiner, int node_count,
     combiner->probing_primary = false;
     combiner->returning_node = InvalidOid;
     combiner->currentRow = NULL;
+    combiner->rowArena = NULL;
+    combiner->slotRow = NULL;
     combiner->rowBuffer = NIL;
     combiner->tapenodes = NULL;
     combiner->merge_sort = false;
@@ -298,6 +355,7 @@ InitResponseCombiner(ResponseCombiner *combiner, int node_count,
     combiner->recv_datarows  = 0;
     combiner->prerowBuffers  = NULL;
     combiner->is_abort = false;
+    combiner->discard_rows = false;
 	combiner->recv_instr_htbl = NULL;
 #endif
 }
@@ -718,6 +776,15 @@ HandleDataRow(ResponseCombiner *combiner, char *msg_body, size_t len, Oid node)
     if (combiner->errorMessage)
         return false;
 
+#ifdef __TBASE__
+    /*
+     * Nobody wants the rows still in flight when connections are drained,
+     * e.g. after a LIMIT was satisfied, so do not copy them out.
+     */
+    if (combiner->discard_rows)
+        return false;
+#endif
+
     /*
      * Replicated INSERT/UPDATE/DELETE with RETURNING: receive only tuples
      * from one node, skip others as duplicates
@@ -743,7 +810,7 @@ HandleDataRow(ResponseCombiner *combiner, char *msg_body, size_t len, Oid node)
      * We are copying message because it points into connection buffer, and
      * will be overwritten on next socket read
      */
-    combiner->currentRow = (RemoteDataRow) palloc(sizeof(RemoteDataRowData) + len);
+    combiner->currentRow = AllocDataRow(combiner, len);
     memcpy(combiner->currentRow->msg, msg_body, len);
     combiner->currentRow->msglen = len;
     combiner->currentRow->msgnode = node;
@@ -1219,7 +1286,7 @@ BufferConnection(PGXCNodeHandle *conn)
                     
                     combiner->nDataRows[node_index]++;
 
-                    pfree(combiner->currentRow);
+                    ReleaseDataRow(combiner, combiner->currentRow);
                 }
                 else
                 {
@@ -1233,6 +1300,7 @@ BufferConnection(PGXCNodeHandle *conn)
                         combiner->dataRowMemSize = (long *)palloc0(sizeof(long) * combiner->conn_count);
                     }
                             
+                    combiner->currentRow = DetachDataRow(combiner, combiner->currentRow);
                     combiner->prerowBuffers[node_index] = lappend(combiner->prerowBuffers[node_index],
                                                                     combiner->currentRow);
 
@@ -1284,7 +1352,7 @@ BufferConnection(PGXCNodeHandle *conn)
                     
                     combiner->nDataRows[0]++;
 
-                    pfree(combiner->currentRow);
+                    ReleaseDataRow(combiner, combiner->currentRow);
                 }
                 else
                 {
@@ -1295,6 +1363,7 @@ BufferConnection(PGXCNodeHandle *conn)
                         combiner->dataRowMemSize[0] = 0;
                     }
                     
+                    combiner->currentRow = DetachDataRow(combiner, combiner->currentRow);
                     combiner->rowBuffer = lappend(combiner->rowBuffer,
                                                   combiner->currentRow);
 
@@ -1575,12 +1644,13 @@ bool PreFetchConnection(PGXCNodeHandle *conn, int32 node_index)
                     
                     combiner->nDataRows[node_index]++;
 
-                    pfree(combiner->currentRow);
+                    ReleaseDataRow(combiner, combiner->currentRow);
 
                     combiner->currentRow = NULL;
                 }
                 else
                 {
+                    combiner->currentRow = DetachDataRow(combiner, combiner->currentRow);
                     combiner->prerowBuffers[node_index] = lappend(combiner->prerowBuffers[node_index],
                                                                     combiner->currentRow);
 
@@ -1639,7 +1709,7 @@ bool PreFetchConnection(PGXCNodeHandle *conn, int32 node_index)
                     
                     combiner->nDataRows[0]++;
 
-                    pfree(combiner->currentRow);
+                    ReleaseDataRow(combiner, combiner->currentRow);
 
                     combiner->currentRow = NULL;
                 }
@@ -1647,6 +1717,7 @@ bool PreFetchConnection(PGXCNodeHandle *conn, int32 node_index)
                 {
                     combiner->dataRowMemSize[0] += msglen;
                     
+                    combiner->currentRow = DetachDataRow(combiner, combiner->currentRow);
                     combiner->rowBuffer = lappend(combiner->rowBuffer,
                                           combiner->currentRow);
                     
@@ -1851,15 +1922,130 @@ bool PreFetchConnection(PGXCNodeHandle *conn, int32 node_index)
     return bComplete;
 }
 
+/*
+ * Allocate room for a data row of len bytes, from the combiner's row arena
+ * if it has one and the row fits.
+ */
+static RemoteDataRow
+AllocDataRow(ResponseCombiner *combiner, size_t len)
+{
+    RemoteRowArena *arena = combiner->rowArena;
+    Size            size = MAXALIGN(sizeof(RemoteDataRowData) + len);
+
+    if (arena)
+    {
+        if (arena->block == NULL)
+            arena->block = MemoryContextAlloc(arena->context,
+                                              REMOTE_ROW_ARENA_SIZE);
+
+        /* everything handed out is back, start over */
+        if (arena->nlive == 0)
+            arena->used = 0;
+
+        if (arena->used + size <= REMOTE_ROW_ARENA_SIZE)
+        {
+            RemoteDataRow datarow = (RemoteDataRow) (arena->block + arena->used);
+
+            arena->used += size;
+            arena->nlive++;
+            return datarow;
+        }
+    }
+
+    return (RemoteDataRow) palloc(sizeof(RemoteDataRowData) + len);
+}
+
+static inline bool
+DataRowInArena(ResponseCombiner *combiner, RemoteDataRow datarow)
+{
+    RemoteRowArena *arena = combiner->rowArena;
+
+    return arena && arena->block &&
+           (char *) datarow >= arena->block &&
+           (char *) datarow < arena->block + REMOTE_ROW_ARENA_SIZE;
+}
+
+/*
+ * Give back a data row obtained from AllocDataRow, or any other palloc'd
+ * data row the combiner owns.
+ */
+static void
+ReleaseDataRow(ResponseCombiner *combiner, RemoteDataRow datarow)
+{
+    if (DataRowInArena(combiner, datarow))
+    {
+        Assert(combiner->rowArena->nlive > 0);
+        combiner->rowArena->nlive--;
+    }
+    else
+        pfree(datarow);
+}
+
+/*
+ * Data rows put aside in the row buffers are freed with pfree and may be
+ * kept for long, so move them out of the arena. The copy is made in the
+ * current memory context.
+ */
+static RemoteDataRow
+DetachDataRow(ResponseCombiner *combiner, RemoteDataRow datarow)
+{
+    RemoteDataRow copy;
+
+    if (!DataRowInArena(combiner, datarow))
+        return datarow;
+
+    copy = (RemoteDataRow) palloc(sizeof(RemoteDataRowData) + datarow->msglen);
+    copy->msgnode = datarow->msgnode;
+    copy->msglen = datarow->msglen;
+    memcpy(copy->msg, datarow->msg, datarow->msglen);
+    ReleaseDataRow(combiner, datarow);
+
+    return copy;
+}
+
+/*
+ * Drop the arena data row the result slot was pointing at. The executor does
+ * not look at a returned tuple once it asks for the next one.
+ */
+static void
+ReleaseSlotDataRow(ResponseCombiner *combiner)
+{
+    TupleTableSlot *slot = combiner->ss.ps.ps_ResultTupleSlot;
+
+    if (combiner->slotRow == NULL)
+        return;
+
+    /* the slot does not own the row, so it leaves its values context alone */
+    if (slot && slot->tts_datarow == combiner->slotRow)
+    {
+        ExecClearTuple(slot);
+        if (slot->tts_drowcxt)
+            MemoryContextReset(slot->tts_drowcxt);
+    }
+    ReleaseDataRow(combiner, combiner->slotRow);
+    combiner->slotRow = NULL;
+}
+
 /*
  * copy the datarow from combiner to the given slot, in the slot's memory
- * context
+ * context. Rows received into the row arena are not copied, the slot points
+ * at them until the next row is fetched.
  */
 static void
 CopyDataRowTupleToSlot(ResponseCombiner *combiner, TupleTableSlot *slot)
 {
     RemoteDataRow     datarow;
     MemoryContext    oldcontext;
+
+    ReleaseSlotDataRow(combiner);
+    if (DataRowInArena(combiner, combiner->currentRow))
+    {
+        ExecStoreDataRowTuple(combiner->currentRow, slot, false);
+        combiner->slotRow = combiner->currentRow;
+        combiner->currentRow = NULL;
+        return;
+    }
+
     oldcontext = MemoryContextSwitchTo(slot->tts_mcxt);
     datarow = (RemoteDataRow) palloc(sizeof(RemoteDataRowData) + combiner->currentRow->msglen);
     datarow->msgnode = combiner->currentRow->msgnode;
@@ -1872,6 +2058,42 @@ CopyDataRowTupleToSlot(ResponseCombiner *combiner, TupleTableSlot *slot)
 }
 
 
+#ifdef __TBASE__
+/*
+ * Number of rows to ask a portal for. The first batch has
+ * pgxl_remote_fetch_size rows, every further batch means the previous one was
+ * consumed in full and gets twice as many, so long scans soon fetch large
+ * batches while a LIMIT satisfied early leaves only a small one outstanding.
+ * Batches are capped to what work_mem holds, judging by the rows seen so far.
+ */
+static int
+pgxc_node_fetch_size(PGXCNodeHandle *conn, bool first)
+{
+    int64 limit;
+
+    if (first || conn->fetch_size <= 0)
+    {
+        conn->fetch_size  = PGXLRemoteFetchSize;
+        conn->fetch_rows  = 0;
+        conn->fetch_bytes = 0;
+        return conn->fetch_size;
+    }
+
+    conn->fetch_size = (conn->fetch_size > INT_MAX / 2) ? INT_MAX : conn->fetch_size * 2;
+    if (conn->fetch_rows > 0 && conn->fetch_bytes > 0)
+    {
+        limit = (int64) work_mem * 1024L * conn->fetch_rows / conn->fetch_bytes;
+        limit = Max(limit, PGXLRemoteFetchSize);
+        if (conn->fetch_size > limit)
+        {
+            conn->fetch_size = (int) limit;
+        }
+    }
+
+    return conn->fetch_size;
+}
+#endif
+
 /*
  * FetchTuple
  *
@@ -1954,6 +2176,9 @@ FetchTuple(ResponseCombiner *combiner)
         }
     }
 
+    /* the row returned last time is not needed anymore */
+    ReleaseSlotDataRow(combiner);
+
 #ifdef __TBASE__
     if (enable_statistic)
     {
@@ -2221,7 +2446,7 @@ READ_ROWBUFFER:
                 return NULL;
             }
 
-            if (pgxc_node_send_execute(conn, combiner->cursor, PGXLRemoteFetchSize) != 0)
+            if (pgxc_node_send_execute(conn, combiner->cursor, pgxc_node_fetch_size(conn, false)) != 0)
             {
                 ereport(ERROR,
                         (errcode(ERRCODE_INTERNAL_ERROR),
@@ -2303,79 +2528,105 @@ READ_ROWBUFFER:
              * consume data from all all connections, we can break the deadlock loop.
              */            
             bool   bComplete          = false;
-            DNConnectionState state   = DN_CONNECTION_STATE_IDLE;
             int    i                  = 0;
+            int    j                  = 0;
+            int    npoll              = 0;
             int    ret                   = 0;
             PGXCNodeHandle *save_conn = NULL;
+            PGXCNodeHandle **poll_conns;
+            DNConnectionState *poll_states;
+            int   *poll_index;
+            int   *poll_pending;
             struct timeval timeout;
             timeout.tv_sec            = 0;
             timeout.tv_usec           = 1000;    
 
+            /*
+             * All connections still producing rows are polled together, so a
+             * wait costs one poll() however many datanodes there are, and
+             * whatever arrived meanwhile on the others is buffered for them.
+             */
+            poll_conns   = (PGXCNodeHandle **) palloc(combiner->conn_count * sizeof(PGXCNodeHandle *));
+            poll_states  = (DNConnectionState *) palloc(combiner->conn_count * sizeof(DNConnectionState));
+            poll_index   = (int *) palloc(combiner->conn_count * sizeof(int));
+            poll_pending = (int *) palloc(combiner->conn_count * sizeof(int));
+
             save_conn = conn;
             while (1)
             {
-                conn  = save_conn;
-                state = conn->state; /* Save the connection state. */
-                ret   = pgxc_node_receive(1, &conn, &timeout);
-                if (DNStatus_OK == ret)
+                /* The current connection goes first. */
+                poll_conns[0]   = save_conn;
+                poll_index[0]   = combiner->current_conn;
+                npoll = 1;
+                for (i = 0; i < combiner->conn_count; i ++)
                 {
-                    /* We got data, handle it. */
-                    break;
+                    conn  = combiner->connections[i];
+                    if (save_conn != conn && conn != NULL &&
+                        conn->state == DN_CONNECTION_STATE_QUERY)
+                    {
+                        poll_conns[npoll] = conn;
+                        poll_index[npoll] = i;
+                        npoll++;
+                    }
+                }
+                for (j = 0; j < npoll; j++)
+                {
+                    /* Save the connection state. */
+                    poll_states[j]  = poll_conns[j]->state;
+                    poll_pending[j] = poll_conns[j]->inEnd - poll_conns[j]->inStart;
                 }
-                else if (DNStatus_ERR == ret)
+
+                ret = pgxc_node_receive(npoll, poll_conns, &timeout);
+                if (DNStatus_ERR == ret)
                 {
+                    conn = save_conn;
+                    for (j = 0; j < npoll; j++)
+                    {
+                        if (poll_conns[j]->state == DN_CONNECTION_STATE_ERROR_FATAL)
+                        {
+                            conn = poll_conns[j];
+                            break;
+                        }
+                    }
                     ereport(ERROR,
                             (errcode(ERRCODE_INTERNAL_ERROR),
                              errmsg("Failed to receive more data from data node %u", conn->nodeoid)));
                 }
-                else
+                else if (DNStatus_EXPIRED == ret)
                 {
-                    /* Restore the saved state of connection. */
-                    conn->state = state;
+                    /* Restore the saved state of connections. */
+                    for (j = 0; j < npoll; j++)
+                        poll_conns[j]->state = poll_states[j];
+                    continue;
                 }
 
-                /* Try to read data from other connections. */
-                for (i = 0; i < combiner->conn_count; i ++)
+                if (save_conn->inEnd - save_conn->inStart > poll_pending[0])
                 {
-                    conn  = combiner->connections[i];
-                    if (save_conn != conn && conn != NULL)
+                    /* We got data, handle it. */
+                    break;
+                }
+
+                /* Prefetch the data the other connections got. */
+                for (j = 1; j < npoll; j++)
+                {
+                    conn = poll_conns[j];
+                    if (conn->inEnd - conn->inStart > poll_pending[j] ||
+                        HAS_MESSAGE_BUFFERED(conn))
                     {
-                        /* Save the connection state. */
-                        state = conn->state;
-                        if (state == DN_CONNECTION_STATE_QUERY)
+                        bComplete = PreFetchConnection(conn, poll_index[j]);
+                        if (bComplete)
                         {
-                            ret = pgxc_node_receive(1, &conn, &timeout);
-                            if (DNStatus_OK == ret)
-                            {
-                                /* We got data, prefetch it. */
-                                bComplete = PreFetchConnection(conn, i);
-                                if (bComplete)
-                                {
-                                    /* Receive Complete on one connection, we need retry to read from current_conn. */
-                                    break;
-                                }
-                                else
-                                {
-                                    /* Maybe Suspend or Expired, just move to next connection and read. */
-                                    continue;
-                                }
-                            }
-                            else if (DNStatus_EXPIRED == ret)
-                            {
-                                /* Restore the saved state of connection. */
-                                conn->state = state;
-                                continue;
-                            }
-                            else
-                            {
-                                ereport(ERROR,
-                                        (errcode(ERRCODE_INTERNAL_ERROR),
-                                         errmsg("Failed to receive more data from data node %u", conn->nodeoid)));
-                            }
+                            /* Receive Complete on one connection, connections moved, poll again. */
+                            break;
                         }
                     }
-                }    
+                }
             }
+            conn = save_conn;
+            pfree(poll_conns);
+            pfree(poll_states);
+            pfree(poll_index);
+            pfree(poll_pending);
             continue;
 #else
             /* incomplete message, read more */
@@ -2395,7 +2646,7 @@ READ_ROWBUFFER:
              */
             if (combiner->merge_sort || combiner->probing_primary)
             {
-                if (pgxc_node_send_execute(conn, combiner->cursor, PGXLRemoteFetchSize) != 0)
+                if (pgxc_node_send_execute(conn, combiner->cursor, pgxc_node_fetch_size(conn, false)) != 0)
                     ereport(ERROR,
                             (errcode(ERRCODE_INTERNAL_ERROR),
                              errmsg("Failed to send execute cursor '%s' to node %u", combiner->cursor, conn->nodeoid)));
@@ -2414,7 +2665,7 @@ READ_ROWBUFFER:
              * Tell the node to fetch data in background, next loop when we 
              * pgxc_node_receive, data is already there, so we can run faster
              * */
-            if (pgxc_node_send_execute(conn, combiner->cursor, PGXLRemoteFetchSize) != 0)
+            if (pgxc_node_send_execute(conn, combiner->cursor, pgxc_node_fetch_size(conn, false)) != 0)
             {
                 ereport(ERROR,
                         (errcode(ERRCODE_INTERNAL_ERROR),
@@ -3188,6 +3439,8 @@ handle_response(PGXCNodeHandle *conn, ResponseCombiner *combiner)
                     conn->recv_datarows++;
                     combiner->recv_datarows++;
                 }
+                conn->fetch_rows++;
+                conn->fetch_bytes += msg_len;
 #endif
                 /* Do not return if data row has not been actually handled */
                 if (HandleDataRow(combiner, msg, msg_len, conn->nodeoid))
@@ -3275,6 +3528,15 @@ handle_response(PGXCNodeHandle *conn, ResponseCombiner *combiner)
                  * with the connection
                  */
                 conn->transaction_status = msg[0];
+#ifdef __TBASE__
+                /*
+                 * The node tells us whether it has really written, which is
+                 * more precise than the read_only flag of the steps sent to
+                 * it. Nodes that have not written are committed in one phase.
+                 */
+                if (msg_len > 1 && IS_PGXC_COORDINATOR)
+                    conn->read_only = (msg[1] == PGXC_READY_READ_ONLY);
+#endif
                 PGXCNodeSetConnectionState(conn, DN_CONNECTION_STATE_IDLE);
                 conn->combiner = NULL;
 #ifdef DN_CONNECTION_DEBUG
@@ -3642,10 +3904,12 @@ pgxc_node_remote_cleanup_all(void)
     PGXCNodeHandle *new_connections[handles->co_conn_count + handles->dn_conn_count];
     int                new_conn_count = 0;
     int                i;
-    char           *resetcmd = "RESET ALL;"
-                               "RESET SESSION AUTHORIZATION;"
-                               "RESET transaction_isolation;"
-                               "RESET global_session";
+#ifdef __TBASE__
+    char           *resetcmd = enable_session_params_reuse ?
+                        PGXC_GLOBAL_SESSION_RESET_CMD : PGXC_SESSION_RESET_CMD;
+#else
+    char           *resetcmd = PGXC_SESSION_RESET_CMD;
+#endif
 
     elog(DEBUG5, "pgxc_node_remote_cleanup_all - handles->co_conn_count %d,"
             "handles->dn_conn_count %d", handles->co_conn_count,
@@ -3689,6 +3953,17 @@ pgxc_node_remote_cleanup_all(void)
 		{
 			pgxc_node_send_coord_info(handle, 0, 0);
 		}
+
+		/*
+		 * Leave the other session parameters in place, whoever gets the
+		 * connection next resets them unless it is us again, see
+		 * pgxc_node_init(). Only global_session is reset, so an idle pooled
+		 * backend no longer claims to belong to our distributed session.
+		 */
+		if (enable_session_params_reuse)
+			handle->session_global_reset = true;
+		else
+			handle->session_pid = 0;
 #endif
         /*
          * We must go ahead and release connections anyway, so do not throw
@@ -3725,6 +4000,17 @@ pgxc_node_remote_cleanup_all(void)
 		{
 			pgxc_node_send_coord_info(handle, 0, 0);
 		}
+
+		/*
+		 * Leave the other session parameters in place, whoever gets the
+		 * connection next resets them unless it is us again, see
+		 * pgxc_node_init(). Only global_session is reset, so an idle pooled
+		 * backend no longer claims to belong to our distributed session.
+		 */
+		if (enable_session_params_reuse)
+			handle->session_global_reset = true;
+		else
+			handle->session_pid = 0;
 #endif
         /*
          * We must go ahead and release connections anyway, so do not throw
@@ -6001,7 +6287,7 @@ DataNodeCopyIn(char *data_row, int len,
         if (handle->state == DN_CONNECTION_STATE_COPY_IN)
         {
             /* precalculate to speed up access */
-            int bytes_needed = handle->outEnd + 1 + msgLen;
+            size_t bytes_needed = handle->outEnd + 1 + msgLen;
 
             /* flush buffer if it is almost full */
             if (bytes_needed > COPY_BUFFER_SIZE)
@@ -6063,13 +6349,31 @@ DataNodeCopyIn(char *data_row, int len,
                          errmsg("out of memory")));
             }
 
+#ifdef __TBASE__
+            if (COPY_DATA_CAN_APPEND(handle))
+            {
+                /* CopyData needs no row alignment, grow the last message */
+                uint32 newLen = htonl(handle->outEnd - handle->copy_data_off - 1 + msgLen - 4);
+
+                memcpy(handle->outBuffer + handle->copy_data_off + 1, &newLen, 4);
+            }
+            else
+            {
+                handle->copy_data_off = handle->outEnd;
+#endif
             handle->outBuffer[handle->outEnd++] = 'd';
             memcpy(handle->outBuffer + handle->outEnd, &nLen, 4);
             handle->outEnd += 4;
+#ifdef __TBASE__
+            }
+#endif
             memcpy(handle->outBuffer + handle->outEnd, data_row, len);
             handle->outEnd += len;
             if (!binary)
                 handle->outBuffer[handle->outEnd++] = '\n';
+#ifdef __TBASE__
+            handle->copy_data_end = handle->outEnd;
+#endif
 
             handle->in_extended_query = false;
         }
@@ -6512,6 +6816,8 @@ get_exec_connections(RemoteQueryState *planstate,
             {
                 break;
             }
+
+            i++;
         }
         list_free(temp_list);        
         exec_nodes->nodeList = nodelist;
@@ -6713,6 +7019,32 @@ pgxc_start_command_on_connection(PGXCNodeHandle *connection,
  * But does not need an Estate instance and does not do some unnecessary work,
  * like allocating tuple slots.
  */
+/*
+ * Cancel a utility statement on the datanodes still running it after it
+ * failed on the datanode "failed".
+ */
+static void
+CancelRemoteUtility(PGXCNodeHandle **handles, int count, PGXCNodeHandle *failed)
+{
+	int		   *dn_list = (int *) palloc(count * sizeof(int));
+	int			dn_count = 0;
+	int			i;
+
+	for (i = 0; i < count; i++)
+	{
+		if (handles[i] != failed &&
+			handles[i]->state == DN_CONNECTION_STATE_QUERY)
+			dn_list[dn_count++] = PGXCNodeGetNodeId(handles[i]->nodeoid, NULL);
+	}
+
+	if (dn_count > 0 &&
+		!PoolManagerCancelQuery(dn_count, dn_list, 0, NULL, SIGNAL_SIGINT))
+		elog(LOG, "failed to cancel utility statement on %d datanodes after error on %s",
+			 dn_count, failed->nodename);
+
+	pfree(dn_list);
+}
+
 void
 ExecRemoteUtility(RemoteQuery *node)
 {// #lizard forgives
@@ -6730,6 +7062,7 @@ ExecRemoteUtility(RemoteQuery *node)
     int            i;
     CommandId    cid = GetCurrentCommandId(true);    
 	bool                utility_need_transcation = true;
+	bool		cancel_sent = false;
 
     if (!force_autocommit)
         RegisterTransactionLocalNode(true);
@@ -6943,163 +7276,48 @@ ExecRemoteUtility(RemoteQuery *node)
         }
     }
 
-    /*
-	 * DDL will firstly be executed on coordinators then datanodes
-	 * which will avoid deadlocks in cluster.
-	 * Let us assume that user sql and ddl hold conflict locks,
-	 * then there will be two situations:
-	 * 1. The coordinator is not locked, user sql will see datanodes with no lock.
-	 * 2. The coordinator is locked, user sql will wait for ddl to complete.
-     *
-     * Send BEGIN control command to all coordinator nodes
-     */
-    if (pgxc_node_begin(co_conn_count,
-                        pgxc_connections->coord_handles,
-                        gxid,
-                        need_tran_block,
-                        false,
-                        PGXC_NODE_COORDINATOR))
-    {
-        ereport(ERROR,
-                (errcode(ERRCODE_INTERNAL_ERROR),
-                        errmsg("Could not begin transaction on coordinators")));
-    }
+	/*
+	 * Send BEGIN control command to all data nodes
+	 */
+	if (pgxc_node_begin(dn_conn_count,
+						pgxc_connections->datanode_handles,
+						gxid,
+						need_tran_block,
+						false,
+						PGXC_NODE_DATANODE))
+	{
+		ereport(ERROR,
+				(errcode(ERRCODE_INTERNAL_ERROR),
+				 errmsg("Could not begin transaction on Datanodes")));
+	}
 
-    /* Send other txn related messages to coordinator nodes */
-    for (i = 0; i < co_conn_count; i++)
-    {
-        PGXCNodeHandle *conn = pgxc_connections->coord_handles[i];
+	/* Send other txn related messages to data nodes */
+	for (i = 0; i < dn_conn_count; i++)
+	{
+		PGXCNodeHandle *conn = pgxc_connections->datanode_handles[i];
 
-        if (snapshot && pgxc_node_send_snapshot(conn, snapshot))
-        {
-            ereport(ERROR,
-                    (errcode(ERRCODE_INTERNAL_ERROR),
-                            errmsg("Failed to send command to coordinators")));
-        }
-        if (pgxc_node_send_cmd_id(conn, cid) < 0)
-        {
-            ereport(ERROR,
-                    (errcode(ERRCODE_INTERNAL_ERROR),
-                            errmsg("Failed to send command ID to Datanodes")));
-        }
+		if (conn->state == DN_CONNECTION_STATE_QUERY)
+			BufferConnection(conn);
+		if (snapshot && pgxc_node_send_snapshot(conn, snapshot))
+		{
+			ereport(ERROR,
+					(errcode(ERRCODE_INTERNAL_ERROR),
+					 errmsg("Failed to send snapshot to Datanodes")));
+		}
+		if (pgxc_node_send_cmd_id(conn, cid) < 0)
+		{
+			ereport(ERROR,
+					(errcode(ERRCODE_INTERNAL_ERROR),
+					 errmsg("Failed to send command ID to Datanodes")));
+		}
 
-        if (pgxc_node_send_query(conn, node->sql_statement) != 0)
-        {
-            ereport(ERROR,
-                    (errcode(ERRCODE_INTERNAL_ERROR),
-                            errmsg("Failed to send command to coordinators")));
-        }
-    }
-
-    /*
-     * Stop if all commands are completed or we got a data row and
-     * initialized state node for subsequent invocations
-     */
-    while (co_conn_count > 0)
-    {
-        int i = 0;
-
-        /* Wait until one of the connections has data available */
-        if (pgxc_node_receive(co_conn_count,
-                              pgxc_connections->coord_handles,
-                              NULL))
-        {
-            /*
-             * Got error
-             * TODO(Tbase): How do we check the error here?
-             */
-            break;
-        }
-
-        while (i < co_conn_count)
-        {
-            PGXCNodeHandle *conn = pgxc_connections->coord_handles[i];
-            int 			res = handle_response(conn, combiner);
-
-            if (res == RESPONSE_EOF)
-            {
-                i++;
-            }
-            else if (res == RESPONSE_COMPLETE)
-            {
-                /* Ignore, wait for ReadyForQuery */
-                if (conn->state == DN_CONNECTION_STATE_ERROR_FATAL)
-                {
-                    ereport(ERROR,
-                            (errcode(ERRCODE_INTERNAL_ERROR),
-                                    errmsg("Unexpected FATAL ERROR on Connection to "
-                                           "Coordinator %s pid %d",
-                                           pgxc_connections->coord_handles[i]->nodename,
-                                           pgxc_connections->coord_handles[i]->backend_pid)));
-                }
-            }
-            else if (res == RESPONSE_ERROR)
-            {
-                /* Ignore, wait for ReadyForQuery */
-            }
-            else if (res == RESPONSE_READY)
-            {
-                if (i < --co_conn_count)
-                    pgxc_connections->coord_handles[i] =
-                            pgxc_connections->coord_handles[co_conn_count];
-            }
-            else if (res == RESPONSE_TUPDESC)
-            {
-                ereport(ERROR,
-                        (errcode(ERRCODE_INTERNAL_ERROR),
-                                errmsg("Unexpected response from coordinator")));
-            }
-            else if (res == RESPONSE_DATAROW)
-            {
-                ereport(ERROR,
-                        (errcode(ERRCODE_INTERNAL_ERROR),
-                                errmsg("Unexpected response from coordinator")));
-            }
-        }
-    }
-
-	/*
-	 * Send BEGIN control command to all data nodes
-	 */
-	if (pgxc_node_begin(dn_conn_count,
-						pgxc_connections->datanode_handles,
-						gxid,
-						need_tran_block,
-						false,
-						PGXC_NODE_DATANODE))
-	{
-		ereport(ERROR,
-				(errcode(ERRCODE_INTERNAL_ERROR),
-				 errmsg("Could not begin transaction on Datanodes")));
-	}
-
-	/* Send other txn related messages to data nodes */
-	for (i = 0; i < dn_conn_count; i++)
-	{
-		PGXCNodeHandle *conn = pgxc_connections->datanode_handles[i];
-
-		if (conn->state == DN_CONNECTION_STATE_QUERY)
-			BufferConnection(conn);
-		if (snapshot && pgxc_node_send_snapshot(conn, snapshot))
-		{
-			ereport(ERROR,
-					(errcode(ERRCODE_INTERNAL_ERROR),
-					 errmsg("Failed to send snapshot to Datanodes")));
-		}
-		if (pgxc_node_send_cmd_id(conn, cid) < 0)
-		{
-			ereport(ERROR,
-					(errcode(ERRCODE_INTERNAL_ERROR),
-					 errmsg("Failed to send command ID to Datanodes")));
-		}
-
-		if (pgxc_node_send_query(conn, node->sql_statement) != 0)
-		{
-			ereport(ERROR,
-					(errcode(ERRCODE_INTERNAL_ERROR),
-					 errmsg("Failed to send command to Datanodes")));
-		}
-	}
+		if (pgxc_node_send_query(conn, node->sql_statement) != 0)
+		{
+			ereport(ERROR,
+					(errcode(ERRCODE_INTERNAL_ERROR),
+					 errmsg("Failed to send command to Datanodes")));
+		}
+	}
 
 
     /* Make the same for data nodes */
@@ -7147,10 +7365,24 @@ ExecRemoteUtility(RemoteQuery *node)
 			}
 			else if (res == RESPONSE_ERROR)
 			{
-				/* Ignore, wait for ReadyForQuery */
+				/*
+				 * The statement fails as a whole, do not let the other
+				 * datanodes finish their part for nothing. Commands run
+				 * outside a transaction block keep what each node did, so
+				 * they are left alone.
+				 */
+				if (need_tran_block && !cancel_sent && dn_conn_count > 1)
+				{
+					CancelRemoteUtility(pgxc_connections->datanode_handles,
+										dn_conn_count, conn);
+					cancel_sent = true;
+				}
+				/* Wait for ReadyForQuery */
 			}
 			else if (res == RESPONSE_READY)
 			{
+				elog(DEBUG1, "utility statement done on datanode %s, %d left",
+					 conn->nodename, dn_conn_count - 1);
 				if (i < --dn_conn_count)
 					pgxc_connections->datanode_handles[i] =
 						pgxc_connections->datanode_handles[dn_conn_count];
@@ -7186,6 +7418,25 @@ ExecRemoteUtility(RemoteQuery *node)
 void
 PGXCNodeCleanAndRelease(int code, Datum arg)
 {
+#ifdef __TBASE__
+    /*
+     * Do not wait for the confirmations of an asynchronous commit on the way
+     * out, but make sure the connections still owing them are discarded
+     * rather than pooled with unread responses.
+     */
+    if (async_commit_conn_count != 0)
+    {
+        int i;
+
+        for (i = 0; i < async_commit_conn_count; i++)
+            PGXCNodeSetConnectionState(async_commit_conns[i],
+                                       DN_CONNECTION_STATE_ERROR_FATAL);
+        pfree(async_commit_conns);
+        async_commit_conns = NULL;
+        async_commit_conn_count = 0;
+        release_handles(true);
+    }
+#endif
 
     /* Disconnect from Pooler, if any connection is still held Pooler close it */
     PoolManagerDisconnect();
@@ -7498,9 +7749,13 @@ PreCommit_Remote(char *prepareGID, char *nodestring, bool preparedLocalNode)
      * We do not need to set that flag if transaction that has created a temp
      * table finally aborts - remote connections are not holding temporary
      * objects in this case.
+     * Nor if the temp objects are all gone by now, as are ON COMMIT DROP
+     * tables at this point, so that sessions using only those keep returning
+     * their connections to the pool.
      */
     if (IS_PGXC_LOCAL_COORDINATOR &&
-        (MyXactFlags & XACT_FLAGS_ACCESSEDTEMPREL))
+        (MyXactFlags & XACT_FLAGS_ACCESSEDTEMPREL) &&
+        !temp_object_included && TempNamespaceHasObjects())
         temp_object_included = true;
 
 
@@ -7521,7 +7776,9 @@ PreCommit_Remote(char *prepareGID, char *nodestring, bool preparedLocalNode)
         }
         pgxc_node_remote_finish(prepareGID, true, nodestring,
                                 GetAuxilliaryTransactionId(),
-                                GetTopGlobalTransactionId());
+                                GetTopGlobalTransactionId(),
+                                async_distributed_commit &&
+                                whereToSendOutput == DestRemote);
     }
 
     if(!IsTwoPhaseCommitRequired(preparedLocalNode))
@@ -7552,6 +7809,77 @@ PreCommit_Remote(char *prepareGID, char *nodestring, bool preparedLocalNode)
     
 }
 
+#ifdef __TBASE__
+/*
+ * Collect the acknowledgements of COMMIT PREPARED left behind by an
+ * asynchronous distributed commit and forget about the connections.
+ *
+ * The transaction is committed already, so a failure here is only reported
+ * at elevel; a node that did not confirm keeps the prepared transaction until
+ * 2PC cleanup commits it. Connections left in an unknown state are marked
+ * fatal so they are not returned to the pool.
+ */
+static void
+DrainAsyncCommit_Remote(int elevel)
+{
+    PGXCNodeHandle **connections = async_commit_conns;
+    int                conn_count = async_commit_conn_count;
+    ResponseCombiner combiner;
+    int                i;
+
+    async_commit_conns = NULL;
+    async_commit_conn_count = 0;
+
+#ifdef __TWO_PHASE_TRANS__
+    g_twophase_state.response_operation = OTHER_OPERATIONS;
+#endif
+    InitResponseCombiner(&combiner, conn_count, COMBINE_TYPE_NONE);
+    if (pgxc_node_receive_responses(conn_count, connections, NULL, &combiner) ||
+        !validate_combiner(&combiner))
+    {
+        ereport(elevel,
+                (errcode(ERRCODE_INTERNAL_ERROR),
+                 errmsg("failed to confirm COMMIT PREPARED '%s' on one or more nodes",
+                        async_commit_gid),
+                 combiner.errorMessage ?
+                    errdetail("%s", combiner.errorMessage) : 0));
+
+        for (i = 0; i < conn_count; i++)
+        {
+            if (connections[i]->state != DN_CONNECTION_STATE_IDLE)
+                PGXCNodeSetConnectionState(connections[i],
+                                           DN_CONNECTION_STATE_ERROR_FATAL);
+        }
+    }
+    CloseCombiner(&combiner);
+    pfree(connections);
+}
+
+/*
+ * Finish an asynchronous distributed commit and release the connections the
+ * way the commit would have. Called once the client has got its answer and
+ * before the session talks to the remote nodes again, so a failure goes to
+ * the server log only: the client is no longer waiting for this transaction.
+ */
+void
+FinishAsyncCommit_Remote(void)
+{
+    if (async_commit_conn_count == 0)
+        return;
+
+    DrainAsyncCommit_Remote(LOG_SERVER_ONLY);
+
+    if (!temp_object_included)
+    {
+        pgxc_node_remote_cleanup_all();
+        if (PersistentConnections)
+            reset_handles();
+        else
+            release_handles(false);
+    }
+}
+#endif
+
 /*
  * Whether node need clean: last command is not finished
  * 'Z' message: ready for query
@@ -7614,6 +7942,14 @@ PreAbort_Remote(TranscationType txn_type, bool need_release_handle)
 
     if (log_gtm_stats)
         ResetUsageCommon(&start_r, &start_t);
+#ifdef __TBASE__
+    /*
+     * Collect what an asynchronous commit left unread before the connections
+     * are examined, the cleanup below then releases them as usual.
+     */
+    if (async_commit_conn_count != 0)
+        DrainAsyncCommit_Remote(LOG);
+#endif
     all_handles = get_current_handles();
     /*
      * Find "dirty" coordinator connections.
@@ -7980,7 +8316,7 @@ PrePrepare_Remote(char *prepareGID, bool localNode, bool implicit)
 #endif
         pgxc_node_remote_finish(prepareGID, true, nodestring,
                                 GetAuxilliaryTransactionId(),
-                                GetTopGlobalTransactionId());
+                                GetTopGlobalTransactionId(), false);
         pfree(nodestring);
         nodestring = NULL;
     }
@@ -8413,7 +8749,7 @@ FinishRemotePreparedTransaction(char *prepareGID, bool commit)
     }
 #endif
     prepared_local = pgxc_node_remote_finish(prepareGID, commit, nodestring,
-                                             gxid, prepare_gxid);
+                                             gxid, prepare_gxid, false);
     free(nodestring);
 #ifdef __USE_GLOBAL_SNAPSHOT__
 
@@ -8447,11 +8783,13 @@ FinishRemotePreparedTransaction(char *prepareGID, bool commit)
 /*
  * Complete previously prepared transactions on remote nodes.
  * Release remote connection after completion.
+ * If async is set the acknowledgements of COMMIT PREPARED are not waited for,
+ * the connections are kept until FinishAsyncCommit_Remote() collects them.
  */
 static bool
 pgxc_node_remote_finish(char *prepareGID, bool commit,
                         char *nodestring, GlobalTransactionId gxid,
-                        GlobalTransactionId prepare_gxid)
+                        GlobalTransactionId prepare_gxid, bool async)
 {// #lizard forgives
     char               *finish_cmd;
     PGXCNodeHandle **connections = NULL;
@@ -8783,7 +9121,28 @@ pgxc_node_remote_finish(char *prepareGID, bool commit,
         }
     }
 
-    if (conn_count)
+#ifdef __TWO_PHASE_TRANS__
+    /* a failed send is reported below, wait for the others as usual */
+    if (!all_conn_healthy)
+        async = false;
+#endif
+
+    if (conn_count && async && commit)
+    {
+        /*
+         * The transaction is prepared everywhere and its commit timestamp is
+         * recorded, it can not abort any more. Let the client go and leave
+         * the acknowledgements on the connections.
+         */
+        async_commit_conns = (PGXCNodeHandle **)
+            MemoryContextAlloc(TopMemoryContext,
+                               conn_count * sizeof(PGXCNodeHandle *));
+        memcpy(async_commit_conns, connections,
+               conn_count * sizeof(PGXCNodeHandle *));
+        async_commit_conn_count = conn_count;
+        strlcpy(async_commit_gid, prepareGID, GIDSIZE);
+    }
+    else if (conn_count)
     {
         InitResponseCombiner(&combiner, conn_count, COMBINE_TYPE_NONE);
 #ifdef __TWO_PHASE_TRANS__
@@ -8819,7 +9178,7 @@ pgxc_node_remote_finish(char *prepareGID, bool commit,
     }
 #endif    
 
-	if (!temp_object_included)
+	if (!temp_object_included && async_commit_conn_count == 0)
     {
         /* Clean up remote sessions */
         pgxc_node_remote_cleanup_all();
@@ -9358,6 +9717,9 @@ pgxc_connections_cleanup(ResponseCombiner *combiner)
      * Read in and discard remaining data from the connections, if any
      */
     combiner->current_conn = 0;
+#ifdef __TBASE__
+    combiner->discard_rows = true;
+#endif
     while (combiner->conn_count > 0)
     {
         int res;
@@ -9377,7 +9739,7 @@ pgxc_connections_cleanup(ResponseCombiner *combiner)
         /* throw away current message that may be in the buffer */
         if (combiner->currentRow)
         {
-            pfree(combiner->currentRow);
+            ReleaseDataRow(combiner, combiner->currentRow);
             combiner->currentRow = NULL;
         }
 
@@ -9517,6 +9879,9 @@ pgxc_connections_cleanup(ResponseCombiner *combiner)
         }
         
     }
+#ifdef __TBASE__
+    combiner->discard_rows = false;
+#endif
 
     /*
      * Release tuplesort resources
@@ -9942,6 +10307,273 @@ determine_param_types(Plan *plan,  struct find_params_context *context)
 }
 
 
+#ifdef __TBASE__
+static bool
+remote_expr_is_stable(Node *node)
+{
+    return !contain_volatile_functions(node) && !contain_subplans(node);
+}
+
+/*
+ * remote_subplan_is_stable - whether the plan returns the same rows every
+ * time it runs with the same parameters in the same snapshot
+ *
+ * Only plan nodes whose expressions are all checked here qualify, anything
+ * else is assumed to be volatile.
+ */
+static bool
+remote_subplan_is_stable(Plan *plan)
+{// #lizard forgives
+    if (plan == NULL)
+        return true;
+
+    if (plan->initPlan != NIL ||
+        !remote_expr_is_stable((Node *) plan->targetlist) ||
+        !remote_expr_is_stable((Node *) plan->qual))
+        return false;
+
+    switch (nodeTag(plan))
+    {
+        case T_SeqScan:
+        case T_Hash:
+        case T_Sort:
+        case T_Material:
+        case T_Unique:
+        case T_Agg:
+        case T_Group:
+        case T_RemoteSubplan:
+            break;
+        case T_IndexScan:
+            if (!remote_expr_is_stable((Node *) ((IndexScan *) plan)->indexqualorig))
+                return false;
+            break;
+        case T_IndexOnlyScan:
+            if (!remote_expr_is_stable((Node *) ((IndexOnlyScan *) plan)->indexqual))
+                return false;
+            break;
+        case T_BitmapIndexScan:
+            if (!remote_expr_is_stable((Node *) ((BitmapIndexScan *) plan)->indexqualorig))
+                return false;
+            break;
+        case T_BitmapHeapScan:
+            if (!remote_expr_is_stable((Node *) ((BitmapHeapScan *) plan)->bitmapqualorig))
+                return false;
+            break;
+        case T_BitmapAnd:
+        case T_BitmapOr:
+            {
+                List     *plans = IsA(plan, BitmapAnd) ?
+                                    ((BitmapAnd *) plan)->bitmapplans :
+                                    ((BitmapOr *) plan)->bitmapplans;
+                ListCell *lc;
+
+                foreach(lc, plans)
+                {
+                    if (!remote_subplan_is_stable((Plan *) lfirst(lc)))
+                        return false;
+                }
+            }
+            break;
+        case T_NestLoop:
+            if (!remote_expr_is_stable((Node *) ((Join *) plan)->joinqual))
+                return false;
+            break;
+        case T_MergeJoin:
+            if (!remote_expr_is_stable((Node *) ((Join *) plan)->joinqual) ||
+                !remote_expr_is_stable((Node *) ((MergeJoin *) plan)->mergeclauses))
+                return false;
+            break;
+        case T_HashJoin:
+            if (!remote_expr_is_stable((Node *) ((Join *) plan)->joinqual) ||
+                !remote_expr_is_stable((Node *) ((HashJoin *) plan)->hashclauses))
+                return false;
+            break;
+        case T_Result:
+            if (!remote_expr_is_stable(((Result *) plan)->resconstantqual))
+                return false;
+            break;
+        case T_Limit:
+            if (!remote_expr_is_stable(((Limit *) plan)->limitOffset) ||
+                !remote_expr_is_stable(((Limit *) plan)->limitCount))
+                return false;
+            break;
+        default:
+            return false;
+    }
+
+    return remote_subplan_is_stable(plan->lefttree) &&
+           remote_subplan_is_stable(plan->righttree);
+}
+#endif
+
+#ifdef __TBASE__
+/*
+ * A scan of a parameterized remote subplan kept for rescans. Entries are
+ * found by the hash of the encoded parameters, at most one per hash, and
+ * the least recently used ones are dropped when there are more than
+ * remote_rescan_cache_entries of them or their rows outgrow work_mem.
+ */
+typedef struct RemoteRescanEntry
+{
+    uint32        hash;           /* hash of params, hash table key */
+    char         *params;         /* encoded parameters of the scan */
+    int           paramlen;
+    bool          complete;       /* all rows of the scan are stored */
+    MinimalTuple *tuples;
+    int           ntuples;
+    int           maxtuples;
+    Size          nbytes;         /* memory used by params and tuples */
+    dlist_node    lru;
+} RemoteRescanEntry;
+
+static void
+RescanCacheRemove(RemoteSubplanState *node, RemoteRescanEntry *entry)
+{
+    int            i;
+    uint32        hash = entry->hash;
+
+    for (i = 0; i < entry->ntuples; i++)
+        pfree(entry->tuples[i]);
+    if (entry->tuples)
+        pfree(entry->tuples);
+    if (entry->params)
+        pfree(entry->params);
+    node->rescan_bytes -= entry->nbytes;
+    dlist_delete(&entry->lru);
+
+    if (node->rescan_fill == entry)
+        node->rescan_fill = NULL;
+    if (node->rescan_replay == entry)
+        node->rescan_replay = NULL;
+
+    hash_search(node->rescan_cache, &hash, HASH_REMOVE, NULL);
+}
+
+/* Complete stored scan with these parameters, or NULL */
+static RemoteRescanEntry *
+RescanCacheLookup(RemoteSubplanState *node, char *params, int paramlen)
+{
+    RemoteRescanEntry *entry;
+    uint32        hash;
+
+    if (node->rescan_cache == NULL)
+        return NULL;
+
+    hash = paramlen > 0 ? hash_any((unsigned char *) params, paramlen) : 0;
+    entry = (RemoteRescanEntry *) hash_search(node->rescan_cache, &hash,
+                                              HASH_FIND, NULL);
+    if (entry == NULL || !entry->complete ||
+        entry->paramlen != paramlen ||
+        (paramlen > 0 && memcmp(entry->params, params, paramlen) != 0))
+        return NULL;
+
+    dlist_move_head(&node->rescan_lru, &entry->lru);
+    return entry;
+}
+
+/* Start remembering the rows of a scan with these parameters */
+static void
+RescanCacheStart(RemoteSubplanState *node, char *params, int paramlen)
+{
+    RemoteRescanEntry *entry;
+    uint32        hash;
+    bool        found;
+
+    if (node->rescan_cache == NULL)
+    {
+        HASHCTL        ctl;
+
+        node->rescan_cxt = AllocSetContextCreate(node->combiner.ss.ps.state->es_query_cxt,
+                                                 "RemoteSubplan rescan cache",
+                                                 ALLOCSET_DEFAULT_SIZES);
+        MemSet(&ctl, 0, sizeof(ctl));
+        ctl.keysize = sizeof(uint32);
+        ctl.entrysize = sizeof(RemoteRescanEntry);
+        ctl.hcxt = node->rescan_cxt;
+        node->rescan_cache = hash_create("RemoteSubplan rescan cache",
+                                         remote_rescan_cache_entries, &ctl,
+                                         HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+        dlist_init(&node->rescan_lru);
+        node->rescan_bytes = 0;
+    }
+
+    hash = paramlen > 0 ? hash_any((unsigned char *) params, paramlen) : 0;
+
+    /* an entry with other parameters may have the same hash */
+    entry = (RemoteRescanEntry *) hash_search(node->rescan_cache, &hash,
+                                              HASH_FIND, NULL);
+    if (entry)
+        RescanCacheRemove(node, entry);
+
+    while (hash_get_num_entries(node->rescan_cache) >= remote_rescan_cache_entries &&
+           !dlist_is_empty(&node->rescan_lru))
+        RescanCacheRemove(node, dlist_tail_element(RemoteRescanEntry, lru,
+                                                   &node->rescan_lru));
+
+    entry = (RemoteRescanEntry *) hash_search(node->rescan_cache, &hash,
+                                              HASH_ENTER, &found);
+    Assert(!found);
+    entry->params = NULL;
+    entry->paramlen = paramlen;
+    entry->complete = false;
+    entry->tuples = NULL;
+    entry->ntuples = 0;
+    entry->maxtuples = 0;
+    entry->nbytes = 0;
+    if (paramlen > 0)
+    {
+        entry->params = MemoryContextAlloc(node->rescan_cxt, paramlen);
+        memcpy(entry->params, params, paramlen);
+        entry->nbytes = paramlen;
+        node->rescan_bytes += paramlen;
+    }
+    dlist_push_head(&node->rescan_lru, &entry->lru);
+
+    node->rescan_fill = entry;
+}
+
+/*
+ * Add a row of the current scan to its entry. Older entries make room if
+ * needed; a scan which alone does not fit into work_mem is not kept.
+ */
+static void
+RescanCacheAdd(RemoteSubplanState *node, TupleTableSlot *slot)
+{
+    RemoteRescanEntry *entry = node->rescan_fill;
+    MemoryContext oldcontext;
+    MinimalTuple tuple;
+    Size        size;
+
+    oldcontext = MemoryContextSwitchTo(node->rescan_cxt);
+    if (entry->ntuples >= entry->maxtuples)
+    {
+        entry->maxtuples = entry->maxtuples ? entry->maxtuples * 2 : 16;
+        if (entry->tuples)
+            entry->tuples = (MinimalTuple *) repalloc(entry->tuples,
+                                        entry->maxtuples * sizeof(MinimalTuple));
+        else
+            entry->tuples = (MinimalTuple *) palloc(entry->maxtuples * sizeof(MinimalTuple));
+    }
+    tuple = ExecCopySlotMinimalTuple(slot);
+    MemoryContextSwitchTo(oldcontext);
+
+    entry->tuples[entry->ntuples++] = tuple;
+    size = GetMemoryChunkSpace(tuple);
+    entry->nbytes += size;
+    node->rescan_bytes += size;
+
+    while (node->rescan_bytes > work_mem * 1024L)
+    {
+        RemoteRescanEntry *victim = dlist_tail_element(RemoteRescanEntry, lru,
+                                                       &node->rescan_lru);
+
+        RescanCacheRemove(node, victim);
+        if (victim == entry)
+            break;
+    }
+}
+#endif
+
 RemoteSubplanState *
 ExecInitRemoteSubplan(RemoteSubplan *node, EState *estate, int eflags)
 {// #lizard forgives
@@ -9992,6 +10624,8 @@ ExecInitRemoteSubplan(RemoteSubplan *node, EState *estate, int eflags)
     combiner->ss.ps.plan = (Plan *) node;
     combiner->ss.ps.state = estate;
     combiner->ss.ps.ExecProcNode = ExecRemoteSubplan;
+    combiner->rowArena = (RemoteRowArena *) palloc0(sizeof(RemoteRowArena));
+    combiner->rowArena->context = CurrentMemoryContext;
 #ifdef __TBASE__
 	if (estate->es_instrument)
 	{
@@ -10435,6 +11069,21 @@ ExecInitRemoteSubplan(RemoteSubplan *node, EState *estate, int eflags)
             list_length(remotestate->execNodes) > 1)
         combiner->merge_sort = true;
 
+#ifdef __TBASE__
+    /*
+     * A parameterized read-only subplan rescanned with the same parameters,
+     * typically under a nested loop whose outer side repeats join keys,
+     * returns the same rows again; keep them and save the round trip.
+     */
+    remotestate->rescan_cacheable = enable_remote_rescan_cache &&
+        !remotestate->local_exec &&
+        node->cursor != NULL &&
+        remotestate->nParamRemote > 0 &&
+        combineType == COMBINE_TYPE_NONE &&
+        estate->es_plannedstmt->commandType == CMD_SELECT &&
+        remote_subplan_is_stable(outerPlan(node));
+#endif
+
     if (log_remotesubplan_stats)
         ShowUsageCommon("ExecInitRemoteSubplan", &start_r, &start_t);
 
@@ -10793,6 +11442,39 @@ encode_epqcontext(PlanState *planstate, char **result)
 	return buf.len;
 }
 
+#ifdef __TBASE__
+/*
+ * ReportRemoteSubplanMisestimate
+ *
+ * Log a remote subplan whose row count is off from the planner's estimate
+ * by more than log_remote_misestimate_ratio, so that the statistics of the
+ * relations below it can be fixed. Only gathering subplans are checked: a
+ * redistributed subplan hands each consumer just a share of the estimate.
+ */
+static void
+ReportRemoteSubplanMisestimate(RemoteSubplanState *node)
+{
+    RemoteSubplan *plan = (RemoteSubplan *) node->combiner.ss.ps.plan;
+    double         estimated = plan->scan.plan.plan_rows;
+    double         actual = (double) node->scan_rows;
+    double         ratio;
+
+    if (plan->distributionType != LOCATOR_TYPE_NONE || estimated <= 0)
+        return;
+
+    ratio = Max(actual, 1.0) / Max(estimated, 1.0);
+    if (ratio < 1.0)
+        ratio = 1.0 / ratio;
+
+    if (ratio >= log_remote_misestimate_ratio)
+        ereport(LOG,
+                (errmsg("remote subplan %s returned %.0f rows, %.0f were estimated",
+                        plan->cursor ? plan->cursor : "(unnamed)",
+                        actual, estimated),
+                 errdetail("Estimate is off by a factor of %.1f.", ratio)));
+}
+#endif
+
 TupleTableSlot *
 ExecRemoteSubplan(PlanState *pstate)
 {// #lizard forgives
@@ -10902,6 +11584,7 @@ primary_mode_phase_two:
         combiner->recv_tuples     = 0;
         combiner->recv_total_time = -1;
         combiner->recv_datarows = 0;
+        node->scan_rows = 0;
 #endif
 
         /*
@@ -10917,6 +11600,25 @@ primary_mode_phase_two:
 		if (estate->es_epqTuple != NULL)
 			epqctxlen = encode_epqcontext(&combiner->ss.ps, &epqctxdata);
 
+#ifdef __TBASE__
+        if (node->rescan_cacheable && epqctxlen == 0)
+        {
+            RemoteRescanEntry *entry = RescanCacheLookup(node, paramdata, paramlen);
+
+            if (entry)
+            {
+                /* Same parameters as a stored scan, replay it */
+                node->rescan_replay = entry;
+                node->rescan_pos = 0;
+                node->bound = true;
+                goto rescan_replay;
+            }
+
+            /* Remember the rows this scan returns */
+            RescanCacheStart(node, paramdata, paramlen);
+        }
+#endif
+
         /*
          * The subplan being rescanned, need to restore connections and
          * re-bind the portal
@@ -10963,7 +11665,8 @@ primary_mode_phase_two:
                               MyProcPid, conn->backend_pid, conn->nodehost, conn->nodeport, conn->sock, cursor);
                 }
                 /* execute */
-                pgxc_node_send_execute(conn, combiner->cursor, fetch);
+                pgxc_node_send_execute(conn, combiner->cursor,
+                                       fetch ? pgxc_node_fetch_size(conn, true) : 0);
                 /* submit */
                 if (pgxc_node_send_flush(conn))
                 {
@@ -11053,7 +11756,8 @@ primary_mode_phase_two:
                               MyProcPid, conn->backend_pid, conn->nodehost, conn->nodeport, conn->sock, cursor);
                 }
                 /* execute */
-                pgxc_node_send_execute(conn, cursor, fetch);
+                pgxc_node_send_execute(conn, cursor,
+                                       fetch ? pgxc_node_fetch_size(conn, true) : 0);
 
                 /* submit */
                 if (pgxc_node_send_flush(conn))
@@ -11138,11 +11842,37 @@ primary_mode_phase_two:
             node->bound = true;
     }
 
+#ifdef __TBASE__
+    /* runtime join filter came before the subplan was sent down */
+    if (node->bound && node->filter)
+    {
+        ExecRemoteSubplanSendFilter(node, node->filter);
+        pfree(node->filter);
+        node->filter = NULL;
+    }
+
+rescan_replay:
+    if (node->rescan_replay)
+    {
+        RemoteRescanEntry *entry = node->rescan_replay;
+
+        if (node->rescan_pos < entry->ntuples)
+            return ExecStoreMinimalTuple(entry->tuples[node->rescan_pos++],
+                                         resultslot, false);
+        return NULL;
+    }
+#endif
+
     if (combiner->tuplesortstate)
     {
         if (tuplesort_gettupleslot((Tuplesortstate *) combiner->tuplesortstate,
                                    true, true, resultslot, NULL))
         {
+#ifdef __TBASE__
+            if (node->rescan_fill)
+                RescanCacheAdd(node, resultslot);
+            node->scan_rows++;
+#endif
             if (log_remotesubplan_stats)
                 ShowUsageCommon("ExecRemoteSubplan", &start_r, &start_t);
             return resultslot;
@@ -11153,6 +11883,11 @@ primary_mode_phase_two:
         TupleTableSlot *slot = FetchTuple(combiner);
         if (!TupIsNull(slot))
         {
+#ifdef __TBASE__
+            if (node->rescan_fill)
+                RescanCacheAdd(node, slot);
+            node->scan_rows++;
+#endif
             if (log_remotesubplan_stats)
                 ShowUsageCommon("ExecRemoteSubplan", &start_r, &start_t);
             return slot;
@@ -11164,6 +11899,17 @@ primary_mode_phase_two:
     if (combiner->errorMessage)
         pgxc_node_report_error(combiner);
 
+#ifdef __TBASE__
+    if (node->rescan_fill)
+    {
+        node->rescan_fill->complete = true;
+        node->rescan_fill = NULL;
+    }
+
+    if (log_remote_misestimate_ratio > 0)
+        ReportRemoteSubplanMisestimate(node);
+#endif
+
     if (log_remotesubplan_stats)
         ShowUsageCommon("ExecRemoteSubplan", &start_r, &start_t);
 
@@ -11194,6 +11940,25 @@ ExecReScanRemoteSubplan(RemoteSubplanState *node)
 {
     ResponseCombiner *combiner = (ResponseCombiner *)node;
 
+#ifdef __TBASE__
+    /* pending runtime join filter belongs to the previous scan */
+    if (node->filter)
+    {
+        pfree(node->filter);
+        node->filter = NULL;
+    }
+
+    /* rows of a scan not read to its end can not be replayed */
+    if (node->rescan_fill)
+        RescanCacheRemove(node, node->rescan_fill);
+    if (node->rescan_replay)
+    {
+        node->rescan_replay = NULL;
+        node->bound = false;
+        return;
+    }
+#endif
+
     /*
      * If we haven't queried remote nodes yet, just return. If outerplan'
      * chgParam is not NULL then it will be re-scanned by ExecProcNode,
@@ -11227,6 +11992,61 @@ ExecReScanRemoteSubplan(RemoteSubplanState *node)
 }
 
 #ifdef __TBASE__
+/*
+ * ExecRemoteSubplanSetFilter
+ *
+ * Ship runtime join filter to the producers of the subplan. If the subplan
+ * is not sent down yet the filter is kept and sent right after that.
+ */
+void
+ExecRemoteSubplanSetFilter(RemoteSubplanState *node, SQueueFilter *filter)
+{
+    Size          size = SQUEUE_FILTER_SIZE(filter->nbits);
+    MemoryContext oldcontext;
+
+    if (node->bound)
+    {
+        ExecRemoteSubplanSendFilter(node, filter);
+        return;
+    }
+
+    if (node->filter)
+        pfree(node->filter);
+
+    oldcontext = MemoryContextSwitchTo(node->combiner.ss.ps.state->es_query_cxt);
+    node->filter = (SQueueFilter *) palloc(size);
+    memcpy(node->filter, filter, size);
+    MemoryContextSwitchTo(oldcontext);
+}
+
+static void
+ExecRemoteSubplanSendFilter(RemoteSubplanState *node, SQueueFilter *filter)
+{
+    ResponseCombiner *combiner = (ResponseCombiner *) node;
+    int               i;
+
+    /* only distributed subplans have producers to filter on */
+    if (combiner->cursor == NULL)
+        return;
+
+    for (i = 0; i < combiner->conn_count; i++)
+    {
+        PGXCNodeHandle *conn = combiner->connections[i];
+
+        if (conn == NULL || conn->state == DN_CONNECTION_STATE_ERROR_FATAL)
+            continue;
+
+        if (pgxc_node_send_runtime_filter(conn, combiner->cursor, filter))
+            ereport(ERROR,
+                    (errcode(ERRCODE_INTERNAL_ERROR),
+                     errmsg("Failed to send runtime join filter to node %u, pid %d",
+                            conn->nodeoid, conn->backend_pid)));
+    }
+
+    elog(DEBUG1, "sent runtime join filter for cursor %s to %d nodes, %d bits",
+         combiner->cursor, combiner->conn_count, filter->nbits);
+}
+
 /*
  * ExecShutdownRemoteSubplan
  * 
@@ -11445,7 +12265,7 @@ ExecDisconnectRemoteSubplan(RemoteSubplanState *node)
                      * assertion failure. So if we got a tuple, just read and
                      * discard it here.
                      */
-                    pfree(combiner->currentRow);
+                    ReleaseDataRow(combiner, combiner->currentRow);
                     combiner->currentRow = NULL;
                 }
                 else if (RESPONSE_ERROR == res)
@@ -11667,6 +12487,10 @@ ExecEndRemoteSubplan(RemoteSubplanState *node)
         ExecEndNode(outerPlanState(node));
     if (node->locator)
         freeLocator(node->locator);
+#ifdef __TBASE__
+    if (node->rescan_cxt)
+        MemoryContextDelete(node->rescan_cxt);
+#endif
 
     /*
      * Consume any possible pending input
@@ -11861,7 +12685,7 @@ ExecEndRemoteSubplan(RemoteSubplanState *node)
                  * assertion failure. So if we got a tuple, just read and
                  * discard it here.
                  */
-                pfree(combiner->currentRow);
+                ReleaseDataRow(combiner, combiner->currentRow);
                 combiner->currentRow = NULL;
             }
             /* Ignore other possible responses */
@@ -11871,6 +12695,15 @@ ExecEndRemoteSubplan(RemoteSubplanState *node)
     ValidateAndCloseCombiner(combiner);
     combiner->conn_count = 0;
 
+    ReleaseSlotDataRow(combiner);
+    if (combiner->rowArena)
+    {
+        if (combiner->rowArena->block)
+            pfree(combiner->rowArena->block);
+        pfree(combiner->rowArena);
+        combiner->rowArena = NULL;
+    }
+
     if (log_remotesubplan_stats)
         ShowUsageCommon("ExecEndRemoteSubplan", &start_r, &start_t);
 }
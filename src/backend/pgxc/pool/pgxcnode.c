@@ -37,6 +37,7 @@
 #include "access/htup_details.h"
 #include "catalog/pg_type.h"
 #include "commands/prepare.h"
+#include "common/pg_lzcompress.h"
 #include "gtm/gtm_c.h"
 #include "nodes/nodes.h"
 #include "pgxc/pgxcnode.h"
@@ -119,6 +120,11 @@ int            NumDataNodes;
 int         NumCoords;
 int            NumSlaveDataNodes;
 
+#ifdef __TBASE__
+/* skip the session init string on connections that already have it */
+bool        enable_session_params_reuse = true;
+#endif
+
 
 #ifdef XCP
 volatile bool HandlesInvalidatePending = false;
@@ -132,6 +138,10 @@ static List *session_param_list = NIL;
 static List    *local_param_list = NIL;
 static StringInfo     session_params;
 static StringInfo    local_params;
+#ifdef __TBASE__
+/* bumped whenever the session init string changes */
+static uint32        session_params_version = 1;
+#endif
 
 typedef struct
 {
@@ -143,6 +153,12 @@ typedef struct
 
 static bool DoInvalidateRemoteHandles(void);
 static bool DoRefreshRemoteHandles(void);
+#ifdef __TBASE__
+static void CheckRemoteHandlesVersion(void);
+
+/* version of the shared node table the handles were last synced with */
+static uint32 HandlesNodeTableVersion = 0;
+#endif
 #endif
 
 #ifdef XCP
@@ -151,6 +167,9 @@ static void pgxc_node_init(PGXCNodeHandle *handle, int sock,
 #else
 static void pgxc_node_init(PGXCNodeHandle *handle, int sock);
 #endif
+#ifdef __TBASE__
+static int pgxc_node_pooled_pid(PGXCNodeHandle *handle, int pid);
+#endif
 static void pgxc_node_free(PGXCNodeHandle *handle);
 static void pgxc_node_all_free(void);
 
@@ -195,6 +214,11 @@ init_pgxc_handle(PGXCNodeHandle *pgxc_handle)
 	pgxc_handle->sock_fatal_occurred = false;
     pgxc_handle->plpgsql_need_begin_sub_txn = false;
     pgxc_handle->plpgsql_need_begin_txn = false;
+    pgxc_handle->copy_data_off = 0;
+    pgxc_handle->copy_data_end = 0;
+    pgxc_handle->session_pid = 0;
+    pgxc_handle->session_version = 0;
+    pgxc_handle->session_global_reset = false;
 #endif
 #ifndef __USE_GLOBAL_SNAPSHOT__
     pgxc_handle->sendGxidVersion = 0;
@@ -241,6 +265,9 @@ InitMultinodeExecutor(bool is_force)
 
     /* Update node table in the shared memory */
 	PgxcNodeListAndCountWrapTransaction();
+#ifdef __TBASE__
+    HandlesNodeTableVersion = PgxcNodeTableVersion();
+#endif
 
     /* Get classified list of node Oids */
     PgxcNodeGetOidsExtend(&coOids, &dnOids, &sdnOids, &NumCoords, &NumDataNodes, &NumSlaveDataNodes, true);
@@ -647,6 +674,24 @@ pgxc_node_all_free(void)
     HandlesRefreshPending = false;
 }
 
+#ifdef __TBASE__
+/*
+ * Decode a remote backend pid received from the pooler. A negative pid means
+ * the connection comes back to us untouched since we released it, anything
+ * else may have been used or reset by someone else meanwhile, so forget what
+ * we sent there.
+ */
+static int
+pgxc_node_pooled_pid(PGXCNodeHandle *handle, int pid)
+{
+    if (pid < 0)
+        return -pid;
+
+    handle->session_pid = 0;
+    return pid;
+}
+#endif
+
 /*
  * Create and initialise internal structure to communicate to
  * Datanode via supplied socket descriptor.
@@ -656,6 +701,9 @@ static void
 pgxc_node_init(PGXCNodeHandle *handle, int sock, bool global_session, int pid)
 {// #lizard forgives
     char *init_str;
+#ifdef __TBASE__
+    uint32 session_version;
+#endif
 
     handle->sock = sock;
     handle->backend_pid = pid;
@@ -684,6 +732,56 @@ pgxc_node_init(PGXCNodeHandle *handle, int sock, bool global_session, int pid)
      * We got a new connection, set on the remote node the session parameters
      * if defined. The transaction parameter should be sent after BEGIN
      */
+#ifdef __TBASE__
+    /*
+     * The remote backend still runs with what we sent it if we kept the
+     * connection, or the pooler handed it back to us untouched, see
+     * pgxc_node_pooled_pid(). Only global_session was reset there by
+     * pgxc_node_remote_cleanup_all(), so set just that again.
+     *
+     * Anything else may carry the session state of whoever used it last,
+     * with enable_session_params_reuse pgxc_node_remote_cleanup_all() leaves
+     * that to the next user, so reset it in the same round trip. The
+     * parameter is the same for every session of this node, without it the
+     * connection was reset before it went back to the pool.
+     */
+    session_version = global_session ? session_params_version : 0;
+    if (enable_session_params_reuse &&
+        handle->session_pid == pid &&
+        handle->session_version == session_version)
+    {
+        if (global_session && handle->session_global_reset &&
+            IS_PGXC_COORDINATOR)
+        {
+            char cmd[NAMEDATALEN + 64];
+
+            snprintf(cmd, sizeof(cmd), "SET global_session TO %s_%d;",
+                     PGXCNodeName, MyProcPid);
+            pgxc_node_set_query(handle, cmd);
+        }
+    }
+    else
+    {
+        StringInfoData cmd;
+
+        initStringInfo(&cmd);
+        if (enable_session_params_reuse)
+            appendStringInfoString(&cmd, PGXC_SESSION_RESET_CMD);
+        if (global_session)
+        {
+            init_str = PGXCNodeGetSessionParamStr();
+            if (init_str)
+                appendStringInfoString(&cmd, init_str);
+        }
+        if (cmd.len > 0)
+            pgxc_node_set_query(handle, cmd.data);
+        pfree(cmd.data);
+
+        handle->session_pid = pid;
+        handle->session_version = session_version;
+    }
+    handle->session_global_reset = false;
+#else
     if (global_session)
     {
         init_str = PGXCNodeGetSessionParamStr();
@@ -692,6 +790,7 @@ pgxc_node_init(PGXCNodeHandle *handle, int sock, bool global_session, int pid)
             pgxc_node_set_query(handle, init_str);
         }
     }
+#endif
 
 #if 0
     if (global_session)
@@ -1370,6 +1469,55 @@ get_message(PGXCNodeHandle *conn, int *len, char **msg)
         return '\0';
     }
 
+    if (msgtype == 'z')
+    {
+        /*
+         * Compressed chunk of complete messages from a data pump sender.
+         * Replace it in the buffer by its content and parse from there.
+         */
+        size_t      start = conn->inStart;
+        size_t      remaining;
+        uint32      n32;
+        int32       rawlen;
+        char       *raw;
+
+        if (*len < 4)
+            ereport(ERROR,
+                    (errcode(ERRCODE_DATA_CORRUPTED),
+                     errmsg("invalid compressed message from node %u", conn->nodeoid)));
+
+        memcpy(&n32, conn->inBuffer + conn->inCursor, 4);
+        rawlen = (int32) ntohl(n32);
+        if (rawlen <= 0 || rawlen >= (MaxAllocSize >> 1))
+            ereport(ERROR,
+                    (errcode(ERRCODE_DATA_CORRUPTED),
+                     errmsg("invalid compressed message length %d from node %u",
+                            rawlen, conn->nodeoid)));
+
+        raw = palloc(rawlen);
+        if (pglz_decompress(conn->inBuffer + conn->inCursor + 4, *len - 4,
+                            raw, rawlen) != rawlen)
+            ereport(ERROR,
+                    (errcode(ERRCODE_DATA_CORRUPTED),
+                     errmsg("compressed message from node %u is corrupt", conn->nodeoid)));
+
+        conn->inCursor += *len;
+        remaining = conn->inEnd - conn->inCursor;
+        if (ensure_in_buffer_capacity(start + rawlen + remaining, conn) != 0)
+            ereport(ERROR,
+                    (errcode(ERRCODE_OUT_OF_MEMORY),
+                     errmsg("out of memory")));
+
+        memmove(conn->inBuffer + start + rawlen, conn->inBuffer + conn->inCursor, remaining);
+        memcpy(conn->inBuffer + start, raw, rawlen);
+        pfree(raw);
+
+        conn->inEnd = start + rawlen + remaining;
+        conn->inCursor = start;
+        conn->inStart = start;
+        return get_message(conn, len, msg);
+    }
+
     *msg = conn->inBuffer + conn->inCursor;
     conn->inCursor += *len;
     conn->inStart = conn->inCursor;
@@ -3455,9 +3603,10 @@ int
 pgxc_node_send_sessionid(PGXCNodeHandle * handle)
 {
 	int	msgLen = 0;
+	uint32 n32;
 	
-	/* size + sessionid_str + '\0' */
-	msgLen = 4 + strlen(PGXCSessionId) + 1;
+	/* size + sessionid_str + '\0' + queryid */
+	msgLen = 4 + strlen(PGXCSessionId) + 1 + 4;
 	
 	/* msgType + msgLen */
 	if (ensure_out_buffer_capacity(handle->outEnd + 1 + msgLen, handle) != 0)
@@ -3474,6 +3623,10 @@ pgxc_node_send_sessionid(PGXCNodeHandle * handle)
 	
 	memcpy(handle->outBuffer + handle->outEnd, PGXCSessionId, strlen(PGXCSessionId) + 1);
 	handle->outEnd += strlen(PGXCSessionId) + 1;
+
+	n32 = htonl(PGXCQueryId);
+	memcpy(handle->outBuffer + handle->outEnd, &n32, 4);
+	handle->outEnd += 4;
 	return 0;
 }
 #endif
@@ -3628,6 +3781,10 @@ get_any_handle(List *datanodelist)
                  errmsg("Invalid NULL node list")));
     }
 
+#ifdef __TBASE__
+    CheckRemoteHandlesVersion();
+#endif
+
     if (HandlesInvalidatePending)
         if (DoInvalidateRemoteHandles())
             ereport(ERROR,
@@ -3726,6 +3883,9 @@ get_any_handle(List *datanodelist)
                     
                     
                     node_handle = &dn_handles[node];
+#ifdef __TBASE__
+                    pids[0] = pgxc_node_pooled_pid(node_handle, pids[0]);
+#endif
                     pgxc_node_init(node_handle, fds[0], true, pids[0]);
                     datanode_count++;
 
@@ -3771,6 +3931,10 @@ get_handles(List *datanodelist, List *coordlist, bool is_coord_only_query, bool
     /* index of the result array */
     int            i = 0;
 
+#ifdef __TBASE__
+    CheckRemoteHandlesVersion();
+#endif
+
     if (HandlesInvalidatePending)
         if (DoInvalidateRemoteHandles())
             ereport(ERROR,
@@ -3992,6 +4156,9 @@ get_handles(List *datanodelist, List *coordlist, bool is_coord_only_query, bool
                 int            node = lfirst_int(node_list_item);
                 int            fdsock = fds[j];
                 int            be_pid = pids[j++];
+#ifdef __TBASE__
+                bool           untouched = (be_pid < 0);
+#endif
 
                 if (node < 0 || node >= NumDataNodes)
                 {
@@ -4001,6 +4168,9 @@ get_handles(List *datanodelist, List *coordlist, bool is_coord_only_query, bool
                 }
 
                 node_handle = &dn_handles[node];
+#ifdef __TBASE__
+                be_pid = pgxc_node_pooled_pid(node_handle, be_pid);
+#endif
 				
 				if (be_pid == 0 && !raise_error)
 				{
@@ -4042,6 +4212,19 @@ get_handles(List *datanodelist, List *coordlist, bool is_coord_only_query, bool
 								nodetype, NumDataNodes);
 					}
 
+#ifdef __TBASE__
+					/*
+					 * Nobody used the connection since we released it, the
+					 * statements we prepared there are still in place.
+					 */
+					if (untouched)
+					{
+						elog(DEBUG5, "Keep statements on datanode %s, nodeidx %d, "
+								"remote backend PID %d", node_handle->nodename,
+								nodeidx, be_pid);
+						continue;
+					}
+#endif
 					InactivateDatanodeStatementOnNode(nodeidx);
 					elog(DEBUG5, "Inactivate statement on datanode %s, nodeidx %d, "
 							"oid %d, type %c, max nodes %d", node_handle->nodename,
@@ -4066,6 +4249,9 @@ get_handles(List *datanodelist, List *coordlist, bool is_coord_only_query, bool
                 }
 
                 node_handle = &co_handles[node];
+#ifdef __TBASE__
+                be_pid = pgxc_node_pooled_pid(node_handle, be_pid);
+#endif
 				
 				if (be_pid == 0 && !raise_error)
 				{
@@ -4622,6 +4808,9 @@ PGXCNodeSetParam(bool local, const char *name, const char *value, int flags)
         param_list = session_param_list;
         if (session_params)
             resetStringInfo(session_params);
+#ifdef __TBASE__
+        session_params_version++;
+#endif
         oldcontext = MemoryContextSwitchTo(TopMemoryContext);
     }
 
@@ -4675,6 +4864,9 @@ PGXCNodeResetParams(bool only_local)
             pfree(session_params);
             session_params = NULL;
         }
+#ifdef __TBASE__
+        session_params_version++;
+#endif
     }
     /*
      * no need to explicitly destroy the local_param_list and local_params,
@@ -5001,6 +5193,23 @@ RequestRefreshRemoteHandles(void)
     HandlesRefreshPending = true;
 }
 
+#ifdef __TBASE__
+/*
+ * Schedule a refresh of the handles if the node table changed since they were
+ * built.  Done when connections are about to be acquired, so sessions pick up
+ * ALTERed nodes without being signalled and without dropping anything else.
+ */
+static void
+CheckRemoteHandlesVersion(void)
+{
+    if (HandlesInvalidatePending || HandlesRefreshPending)
+        return;
+
+    if (HandlesNodeTableVersion != PgxcNodeTableVersion())
+        HandlesRefreshPending = true;
+}
+#endif
+
 bool
 PoolerMessagesPending(void)
 {
@@ -5032,6 +5241,9 @@ DoInvalidateRemoteHandles(void)
 
 /*
  * Diff handles using shmem, and remove ALTERed handles
+ *
+ * Returns true if one of them was connected, the transaction using it can
+ * not go on then.
  */
 static bool
 DoRefreshRemoteHandles(void)
@@ -5039,11 +5251,14 @@ DoRefreshRemoteHandles(void)
     List            *altered = NIL, *deleted = NIL, *added = NIL;
     Oid                *coOids, *dnOids, *sdnOids;
     int                numCoords, numDNodes, numSlaveDNodes, total_nodes;
-    bool            res = true;
+    bool            res = false;
 
 	HOLD_INTERRUPTS();
 
     HandlesRefreshPending = false;
+#ifdef __TBASE__
+    HandlesNodeTableVersion = PgxcNodeTableVersion();
+#endif
 
     PgxcNodeGetOidsExtend(&coOids, &dnOids, &sdnOids,&numCoords, &numDNodes, &numSlaveDNodes, false);
 
@@ -5117,6 +5332,8 @@ DoRefreshRemoteHandles(void)
                          NameStr(nodeDef->nodename), NameStr(nodeDef->nodehost),
                          nodeDef->nodeport);
                     altered = lappend_oid(altered, nodeoid);
+                    if (handle->sock != NO_SOCKET)
+                        res = true;
                 }
                 /* else do nothing */
             }
@@ -5176,16 +5393,10 @@ DoRefreshRemoteHandles(void)
     }
 
     if (deleted != NIL || added != NIL)
-    {
         elog(LOG, "Nodes added/deleted. Reload needed!");
-        res = false;
-    }
 
     if (altered == NIL)
-    {
-        elog(LOG, "No nodes altered. Returning");
-        res = true;
-    }
+        elog(DEBUG1, "No nodes altered. Returning");
     else
         PgxcNodeRefreshBackendHandlesShmem(altered);
 
@@ -5727,6 +5938,41 @@ pgxc_node_send_disconnect(PGXCNodeHandle * handle, char *cursor, int cons)
 
     return pgxc_node_flush(handle);
 }
+
+/*
+ * Send runtime join filter for the cursor. The remote node does not respond,
+ * so the connection state is left as is.
+ */
+int
+pgxc_node_send_runtime_filter(PGXCNodeHandle * handle, const char *cursor,
+                              SQueueFilter *filter)
+{
+    int            filterLen = SQUEUE_FILTER_SIZE(filter->nbits);
+    /* size */
+    int            msgLen = 4 + strlen(cursor) + 1 + filterLen;
+
+    /* msgType + msgLen */
+    if (ensure_out_buffer_capacity(handle->outEnd + 1 + msgLen, handle) != 0)
+    {
+        add_error_message(handle, "out of memory");
+        return EOF;
+    }
+
+    handle->outBuffer[handle->outEnd++] = 'J';
+    /* size */
+    msgLen = htonl(msgLen);
+    memcpy(handle->outBuffer + handle->outEnd, &msgLen, 4);
+    handle->outEnd += 4;
+
+    memcpy(handle->outBuffer + handle->outEnd, cursor, strlen(cursor) + 1);
+    handle->outEnd += (strlen(cursor) + 1);
+
+    /* nodes of the cluster share the architecture, send as is */
+    memcpy(handle->outBuffer + handle->outEnd, filter, filterLen);
+    handle->outEnd += filterLen;
+
+    return pgxc_node_flush(handle);
+}
 #endif
 
 #ifdef __AUDIT__
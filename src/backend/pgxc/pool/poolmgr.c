@@ -63,6 +63,9 @@
 #include <string.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
 #include "utils/varlena.h"
 #include "port.h"
 #include <math.h>
@@ -81,6 +84,7 @@ int            PoolerPort             = 6667;
 int            PoolConnKeepAlive      = 600;
 int            PoolMaintenanceTimeout = 30;
 int            PoolSizeCheckGap       = 120;  /* max check memory size gap, in seconds */
+int            PoolDemandWindow       = 60;   /* window to track peak pool demand, in seconds */
 int            PoolConnMaxLifetime    = 600;  /* max lifetime of a pooled connection, in seconds */
 int            PoolMaxMemoryLimit     = 10;
 int            PoolConnectTimeOut     = 10;
@@ -111,6 +115,17 @@ ThreadSema   g_AsnyUtilitysem;                  /* used for async warm thread */
 #define      IS_ASYNC_PIPE_FULL()   (PipeIsFull(g_AsynUtilityPipeSender))
 #define      MAX_FREE_CONNECTION_NUM 100
 
+/* how deep into the free stack we look for a slot the agent held last */
+#define      POOL_AFFINITY_SCAN      8
+
+/*
+ * Remote backend pid as reported to the coordinator. The pid is negated when
+ * the slot goes back to the agent that held it last and no reset happened in
+ * between, so the coordinator knows its session parameters are still set.
+ */
+#define      POOL_SLOT_PID(slot) \
+    ((slot)->breused ? -((PGconn *) (slot)->conn)->be_pid : ((PGconn *) (slot)->conn)->be_pid)
+
 
 #define      POOL_SYN_REQ_CONNECTION_NUM   32
 
@@ -160,7 +175,8 @@ unsigned char g_pooler_cmd[POOLER_CMD_COUNT] =
     't',                    /* Close pooler connections*/
     'x',                    /* Get command statistics */
     'y',                    /* Reset command statistics */
-    'z'                     /* Get connection statistics */
+    'z',                    /* Get connection statistics */
+    'w'                     /* Get latency statistics */
 };
 
 /* a map used to change msgtype to id */
@@ -210,6 +226,7 @@ typedef struct
     int32             size;        /* total pool size */
     int32               validSize;  /* valid data element number */    
     bool              failed;
+    struct timeval    build_start; /* when the build was requested */
     PGXCNodePoolSlot  slot[1];    /* var length array */
 } PGXCPoolConnectReq;
 
@@ -394,6 +411,9 @@ typedef struct
 	char              errmsg[POOLER_ERROR_MSG_LEN];
 	pg_time_t         cmd_start_time;   /* command start time, including the processing time in the main process */
     pg_time_t         cmd_end_time;     /* command end time */
+	struct  timeval   acquire_start;    /* when the request was dispatched, for the latency histograms */
+	uint64            acquire_time;     /* us until the connection was ready for the session */
+	uint64            set_time;         /* us spent replaying the session params */
 }PGXCPoolAsyncReq;
 
 static void pooler_subthread_write_log(int elevel, int lineno, const char *filename, const char *funcname, const char *fmt, ...)__attribute__((format(printf, 5, 6)));
@@ -473,6 +493,19 @@ static HTAB     *g_nodemap = NULL; /* used to map nodeOid to nodeindex */
 static int    is_pool_locked = false;
 static int    server_fd = -1;
 
+#ifdef HAVE_SYS_EPOLL_H
+/*
+ * With many agents, rebuilding and polling the whole fd array on every loop
+ * is what keeps the pooler busy, so agent sockets are kept in an epoll set.
+ * Events carry the agent index and fd, both are checked before use.
+ */
+static int    pooler_epfd = -1;
+#define POOLER_EPOLL_SERVER_KEY        (~((uint64) 0))
+#define POOLER_EPOLL_KEY(index, fd)    ((((uint64) (uint32) (index)) << 32) | (uint32) (fd))
+#define POOLER_EPOLL_KEY_INDEX(key)    ((int32) ((key) >> 32))
+#define POOLER_EPOLL_KEY_FD(key)       ((int32) ((key) & 0xFFFFFFFF))
+#endif
+
 static volatile int32 is_pool_release = 0;
 
 static int    node_info_check(PoolAgent *agent);
@@ -506,7 +539,7 @@ static int agent_acquire_connections(PoolAgent *agent, List *datanodelist, List
 									 bool raise_error, int32 *num, int **fd_result, int **pid_result);
 static int send_local_commands(PoolAgent *agent, List *datanodelist, List *coordlist);
 static int cancel_query_on_connections(PoolAgent *agent, List *datanodelist, List *coordlist, int signal);
-static PGXCNodePoolSlot *acquire_connection(DatabasePool *dbPool, PGXCNodePool **pool,int32 nodeidx, Oid node, bool bCoord);
+static PGXCNodePoolSlot *acquire_connection(DatabasePool *dbPool, PGXCNodePool **pool,int32 nodeidx, Oid node, bool bCoord, int32 agent_pid);
 static void agent_release_connections(PoolAgent *agent, bool force_destroy);
 static void agent_return_connections(PoolAgent *agent);
 
@@ -554,6 +587,14 @@ static char *build_node_conn_str(Oid node, DatabasePool *dbPool);
 static void pooler_die(SIGNAL_ARGS);
 static void pooler_quickdie(SIGNAL_ARGS);
 static void pools_maintenance(void);
+static void pool_demand_init(PGXCNodePool *nodePool);
+static void pool_demand_update(PGXCNodePool *nodePool, time_t now);
+static int32 pool_demand_target(PGXCNodePool *nodePool);
+static void pool_demand_prebuild(DatabasePool *dbPool, time_t now);
+static void pool_latency_init(PGXCNodePool *nodePool);
+static void pool_latency_record(PGXCNodePool *nodePool, PoolLatencyType type, uint64 usec);
+static void pool_latency_record_lifetime(PGXCNodePool *nodePool, PGXCNodePoolSlot *slot, time_t now);
+static uint64 pool_time_diff_us(struct timeval *start, struct timeval *end);
 static bool shrink_pool(DatabasePool *pool);
 static bool pooler_pools_warm(void);
 static void pooler_async_warm_database_pool(DatabasePool   *pool);
@@ -610,6 +651,7 @@ static void reset_pooler_cmd_statistics(void);
 static void update_pooler_cmd_statistics(unsigned char qtype, uint64 costtime);
 static void handle_get_cmd_statistics(PoolAgent *agent);
 static void handle_get_conn_statistics(PoolAgent *agent);
+static void handle_get_latency_statistics(PoolAgent *agent);
 
 #define IncreaseSlotRefCount(slot,filename,linenumber)\
 do\
@@ -1068,6 +1110,22 @@ agent_create(int new_fd)
     agentCount++;    
     
     MemoryContextSwitchTo(oldcontext);
+
+#ifdef HAVE_SYS_EPOLL_H
+    if (pooler_epfd >= 0)
+    {
+        struct epoll_event ev;
+
+        ev.events   = EPOLLIN | EPOLLPRI;
+        ev.data.u64 = POOLER_EPOLL_KEY(agentindex, new_fd);
+        if (epoll_ctl(pooler_epfd, EPOLL_CTL_ADD, new_fd, &ev) < 0)
+        {
+            elog(WARNING, POOL_MGR_PREFIX"agent_create could not watch fd:%d, errno:%d", new_fd, errno);
+            agent_destroy(agent);
+            return;
+        }
+    }
+#endif
     if (PoolConnectDebugPrint)
     {
         elog(LOG, POOL_MGR_PREFIX"agent_create end, agentCount:%d, fd:%d", agentCount, new_fd);
@@ -1595,6 +1653,40 @@ PoolManagerGetConnStatistics(StringInfo s)
     return 0;
 }
 
+/*
+ * get pooler latency histograms
+ */
+int
+PoolManagerGetLatencyStatistics(StringInfo s)
+{
+    int qtype = 0;
+    char msgtype = 'w';
+    HOLD_POOLER_RELOAD();
+
+    if (poolHandle == NULL)
+    {
+        ConnectPoolManager();
+    }
+
+    /* Message type */
+    pool_putbytes(&poolHandle->port, &msgtype, 1);
+    pool_flush(&poolHandle->port);
+
+    qtype = pool_getbyte(&poolHandle->port);
+    if (qtype == EOF || (unsigned char)qtype != msgtype)
+    {
+        elog(ERROR, POOL_MGR_PREFIX"get latency statistics error, qtype:%d", qtype);
+        RESUME_POOLER_RELOAD();
+        return -1;
+    }
+
+    /* get all the messages left */
+    pool_getmessage(&poolHandle->port, s, 0);
+
+    RESUME_POOLER_RELOAD();
+    return 0;
+}
+
 /*
  * Init PoolAgent
  */
@@ -1655,6 +1747,12 @@ agent_destroy(PoolAgent *agent)
     
     agentindex = agent->agentindex;
     fd         = Socket(agent->port);
+#ifdef HAVE_SYS_EPOLL_H
+    if (pooler_epfd >= 0)
+    {
+        (void) epoll_ctl(pooler_epfd, EPOLL_CTL_DEL, fd, NULL);
+    }
+#endif
     close(fd);
     
     if (PoolConnectDebugPrint)
@@ -2266,6 +2364,10 @@ agent_handle_input(PoolAgent * agent, StringInfo s)
                 handle_get_conn_statistics(agent);
                 break;
 
+            case 'w':          /* get latency statistics */
+                handle_get_latency_statistics(agent);
+                break;
+
             case EOF:            /* EOF */
                 agent_destroy(agent);
                 return;    
@@ -2948,9 +3050,12 @@ agent_acquire_connections(PoolAgent *agent, List *datanodelist, List *coordlist,
     ListCell         *nodelist_item;
     MemoryContext     oldcontext;
     PGXCASyncTaskCtl *asyncTaskCtl = NULL;
+    struct timeval    acquire_start;
+    struct timeval    acquire_end;
 
     Assert(agent);
 
+    gettimeofday(&acquire_start, NULL);
     acquire_seq = pooler_get_connection_acquire_num();
     if (PoolPrintStatTimeout > 0)
     {
@@ -3087,7 +3192,7 @@ agent_acquire_connections(PoolAgent *agent, List *datanodelist, List *coordlist,
         if (NULL == agent->dn_connections[node])
         {
             slot = acquire_connection(agent->pool, &nodePool, node,
-                                      agent->dn_conn_oids[node], false);
+                                      agent->dn_conn_oids[node], false, agent->pid);
 
             /* Handle failure */
             if (slot == NULL)
@@ -3170,6 +3275,8 @@ agent_acquire_connections(PoolAgent *agent, List *datanodelist, List *coordlist,
                             
                 /* Store in the descriptor */
                 slot->pid = agent->pid;
+                slot->breused = (slot->last_holder == agent->pid);
+                slot->last_holder = agent->pid;
                 agent->dn_connections[node] = slot;
                 if (agent->session_params)
                 {                    
@@ -3213,6 +3320,10 @@ agent_acquire_connections(PoolAgent *agent, List *datanodelist, List *coordlist,
                     {
                         g_pooler_stat.acquire_conn_from_hashtab++;
                     }
+
+                    gettimeofday(&acquire_end, NULL);
+                    pool_latency_record(nodePool, POOL_LATENCY_ACQUIRE,
+                                        pool_time_diff_us(&acquire_start, &acquire_end));
                 }
             }            
         }
@@ -3242,7 +3353,7 @@ agent_acquire_connections(PoolAgent *agent, List *datanodelist, List *coordlist,
         /* Acquire from the pool if none */
         if (NULL == agent->coord_connections[node])
         {
-            PGXCNodePoolSlot *slot = acquire_connection(agent->pool, &nodePool, node, agent->coord_conn_oids[node], true);
+            PGXCNodePoolSlot *slot = acquire_connection(agent->pool, &nodePool, node, agent->coord_conn_oids[node], true, agent->pid);
 
             /* Handle failure */
             if (slot == NULL)
@@ -3306,6 +3417,8 @@ agent_acquire_connections(PoolAgent *agent, List *datanodelist, List *coordlist,
                  * remote nodes.
                 */
                 slot->pid = agent->pid;
+                slot->breused = (slot->last_holder == agent->pid);
+                slot->last_holder = agent->pid;
                 agent->coord_connections[node] = slot;
                 if (agent->session_params)
                 {
@@ -3350,6 +3463,10 @@ agent_acquire_connections(PoolAgent *agent, List *datanodelist, List *coordlist,
                     {
                         g_pooler_stat.acquire_conn_from_hashtab++;
                     }
+
+                    gettimeofday(&acquire_end, NULL);
+                    pool_latency_record(nodePool, POOL_LATENCY_ACQUIRE,
+                                        pool_time_diff_us(&acquire_start, &acquire_end));
                 }
             }
         }        
@@ -3403,7 +3520,7 @@ agent_acquire_connections(PoolAgent *agent, List *datanodelist, List *coordlist,
         {
             node = lfirst_int(nodelist_item);
             (*fd_result)[i] = PQsocket((PGconn *) agent->dn_connections[node]->conn);
-            (*pid_result)[i] = ((PGconn *) agent->dn_connections[node]->conn)->be_pid;
+            (*pid_result)[i] = POOL_SLOT_PID(agent->dn_connections[node]);
 #ifdef     _POOLER_CHECK_    
             hostip[i] = pstrdup(((PGconn *) agent->dn_connections[node]->conn)->pghost);
             hostport[i] = pstrdup(((PGconn *) agent->dn_connections[node]->conn)->pgport);
@@ -3417,7 +3534,7 @@ agent_acquire_connections(PoolAgent *agent, List *datanodelist, List *coordlist,
         {
             node = lfirst_int(nodelist_item);
             (*fd_result)[i] = PQsocket((PGconn *) agent->coord_connections[node]->conn);
-            (*pid_result)[i] = ((PGconn *) agent->coord_connections[node]->conn)->be_pid;
+            (*pid_result)[i] = POOL_SLOT_PID(agent->coord_connections[node]);
 #ifdef     _POOLER_CHECK_    
             hostip[i] = pstrdup(((PGconn *) agent->coord_connections[node]->conn)->pghost);
             hostport[i] = pstrdup(((PGconn *) agent->coord_connections[node]->conn)->pgport);
@@ -4186,6 +4303,8 @@ agent_reset_session(PoolAgent *agent)
             /* Reset given slot with parameters */
             if (slot)
             {
+                /* session state is gone, nobody may skip the init string */
+                slot->last_holder = 0;
                 if (release)
                 {
                     if (PoolConnectDebugPrint)
@@ -4227,6 +4346,8 @@ agent_reset_session(PoolAgent *agent)
             /* Reset given slot with parameters */
             if (slot)
             {
+                /* session state is gone, nobody may skip the init string */
+                slot->last_holder = 0;
                 if (release)
                 {
                     if (PoolConnectDebugPrint)
@@ -4553,7 +4674,7 @@ find_database_pool(const char *database, const char *user_name, const char *pgop
  * Acquire connection
  */
 static PGXCNodePoolSlot *
-acquire_connection(DatabasePool *dbPool, PGXCNodePool **pool,int32 nodeidx, Oid node, bool bCoord)
+acquire_connection(DatabasePool *dbPool, PGXCNodePool **pool,int32 nodeidx, Oid node, bool bCoord, int32 agent_pid)
 {// #lizard forgives
     int32              fd;
     int32              loop = 0;
@@ -4593,6 +4714,33 @@ acquire_connection(DatabasePool *dbPool, PGXCNodePool **pool,int32 nodeidx, Oid
     *pool = nodePool;
          
     slot = NULL;
+
+    /*
+     * Prefer a free connection this agent held last, its session parameters
+     * are still in place and the coordinator can skip re-sending them.
+     */
+    if (nodePool && nodePool->freeSize > 1)
+    {
+        int32 i;
+        int32 top   = nodePool->freeSize - 1;
+        int32 limit = Max(0, top - POOL_AFFINITY_SCAN);
+
+        for (i = top; i >= limit; i--)
+        {
+            if (nodePool->slot[i]->last_holder == agent_pid)
+            {
+                if (i != top)
+                {
+                    slot = nodePool->slot[i];
+                    nodePool->slot[i] = nodePool->slot[top];
+                    nodePool->slot[top] = slot;
+                    slot = NULL;
+                }
+                break;
+            }
+        }
+    }
+
     /* Check available connections */
     while (nodePool && nodePool->freeSize > 0)
     {
@@ -4683,6 +4831,7 @@ retry:
     if (slot)
     {
         PgxcNodeUpdateHealth(node, true);
+        pool_demand_update(nodePool, time(NULL));
     }
     
     /* prebuild connection before next acquire */
@@ -4887,6 +5036,7 @@ release_connection(DatabasePool *dbPool, PGXCNodePoolSlot *slot,
 				nodePool->node_name, slot->backend_pid, nodeidx,
 				nodePool->size, nodePool->freeSize);
         }
+        pool_latency_record_lifetime(nodePool, slot, time(NULL));
         destroy_slot(nodeidx, node, slot);
         
         /* Decrease pool size */
@@ -4954,6 +5104,8 @@ grow_pool(DatabasePool *dbPool, int32 nodeidx, Oid node, bool bCoord)
         nodePool->coord      = bCoord;        
         nodePool->nwarming   = 0;
         nodePool->nquery     = 0;
+        pool_demand_init(nodePool);
+        pool_latency_init(nodePool);
 
         name_str = get_node_name_by_nodeoid(node);
         if (NULL == name_str)
@@ -4974,19 +5126,26 @@ grow_pool(DatabasePool *dbPool, int32 nodeidx, Oid node, bool bCoord)
     /* here, we move the connection build work to async threads */
     if (!nodePool->asyncInProgress && dbPool->bneed_pool)
     {
+        /* keep as many connections as recent peaks needed */
+        int32 demand = pool_demand_target(nodePool);
+
         /* async build connection to other nodes, at least keep 10 free connection in the pool */
-        if (nodePool->size < InitPoolSize || (nodePool->freeSize < MinFreeSize && nodePool->size < MaxPoolSize))
+        if (nodePool->size < InitPoolSize || (nodePool->freeSize < MinFreeSize && nodePool->size < MaxPoolSize) ||
+            (nodePool->size < demand && nodePool->size < MaxPoolSize))
         {
             /* total pool size CAN NOT be larger than agentCount too much, to avoid occupying idle connection slot of datanode */
-            if (nodePool->size < agentCount + MinFreeSize)
+            if (nodePool->size < agentCount + MinFreeSize || nodePool->size < demand)
             {
                 int32 size        = 0;
                 int32 initSize    = 0;
                 int32 minFreeSize = 0;
+                int32 demandSize  = 0;
                 
                 initSize    = nodePool->size < InitPoolSize ? InitPoolSize - nodePool->size : 0;
                 minFreeSize = nodePool->freeSize < MinFreeSize ? MinFreeSize - nodePool->freeSize : 0;
+                demandSize  = nodePool->size < demand ? Min(demand, MaxPoolSize) - nodePool->size : 0;
                 size        = minFreeSize > initSize ? minFreeSize : initSize;
+                size        = demandSize > size ? demandSize : size;
                 
                 if (size)
                 {
@@ -5422,6 +5581,9 @@ PoolerLoop(void)
     StringInfoData input_message;
     int            maxfd       = MaxConnections + 1024;
     struct pollfd *pool_fd;
+#ifdef HAVE_SYS_EPOLL_H
+    struct epoll_event *pool_events = NULL;
+#endif
     int            i;
     int            ret;
     time_t           last_maintenance = (time_t) 0;
@@ -5543,6 +5705,31 @@ PoolerLoop(void)
         pool_fd[i].events = POLLIN | POLLPRI | POLLRDNORM | POLLRDBAND;
     }
 
+#ifdef HAVE_SYS_EPOLL_H
+    pooler_epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (pooler_epfd >= 0)
+    {
+        struct epoll_event ev;
+
+        ev.events   = EPOLLIN;
+        ev.data.u64 = POOLER_EPOLL_SERVER_KEY;
+        if (epoll_ctl(pooler_epfd, EPOLL_CTL_ADD, server_fd, &ev) < 0)
+        {
+            close(pooler_epfd);
+            pooler_epfd = -1;
+        }
+    }
+
+    if (pooler_epfd >= 0)
+    {
+        pool_events = (struct epoll_event *) palloc(maxfd * sizeof(struct epoll_event));
+    }
+    else
+    {
+        elog(LOG, POOL_MGR_PREFIX"PoolerLoop could not set up epoll, errno:%d, use poll instead", errno);
+    }
+#endif
+
 	reset_pooler_statistics();
     init_pooler_cmd_statistics();
 
@@ -5568,21 +5755,26 @@ PoolerLoop(void)
         }
         
         /* watch for incoming messages */
-        RebuildAgentIndex();
-        
-        for (i = 0; i < agentCount; i++)
+#ifdef HAVE_SYS_EPOLL_H
+        if (pooler_epfd < 0)
+#endif
         {
-            int32      index = 0;
-            int        sockfd;
-            PoolAgent *agent = NULL;
+            RebuildAgentIndex();
+        
+            for (i = 0; i < agentCount; i++)
+            {
+                int32      index = 0;
+                int        sockfd;
+                PoolAgent *agent = NULL;
             
-            index  = agentIndexes[i];
-            agent  = poolAgents[index];
+                index  = agentIndexes[i];
+                agent  = poolAgents[index];
             
-            /* skip the agents in async deconstruct progress */
-            sockfd = Socket(agent->port);
-            pool_fd[i + 1].fd = sockfd;
+                /* skip the agents in async deconstruct progress */
+                sockfd = Socket(agent->port);
+                pool_fd[i + 1].fd = sockfd;
             
+            }
         }
 
         if (shutdown_requested)
@@ -5618,10 +5810,20 @@ PoolerLoop(void)
             }
     
             /* wait for event */
+#ifdef HAVE_SYS_EPOLL_H
+            if (pooler_epfd >= 0)
+                retval = epoll_wait(pooler_epfd, pool_events, maxfd, timeout_val * 1000);
+            else
+#endif
             retval = poll(pool_fd, agentCount + 1, timeout_val * 1000);
         }
         else
         {
+#ifdef HAVE_SYS_EPOLL_H
+            if (pooler_epfd >= 0)
+                retval = epoll_wait(pooler_epfd, pool_events, maxfd, -1);
+            else
+#endif
             retval = poll(pool_fd, agentCount + 1, -1);
         }        
         
@@ -5647,20 +5849,49 @@ PoolerLoop(void)
             int32      index;
             PoolAgent *agent;
             int        sockfd;
-            for (i = agentCount - 1; i >= 0; i--)
+            bool       server_ready = false;
+
+#ifdef HAVE_SYS_EPOLL_H
+            if (pooler_epfd >= 0)
             {
-                index  = agentIndexes[i];
-                agent  = poolAgents[index];            
-                
-                sockfd = Socket(agent->port);
-                if ((sockfd == pool_fd[i + 1].fd) && pool_fd[i + 1].revents)
+                /* accept comes last, so an index can not be reused in between */
+                for (i = 0; i < retval; i++)
                 {
-                    agent_handle_input(agent, &input_message);
+                    uint64 key = pool_events[i].data.u64;
+
+                    if (POOLER_EPOLL_SERVER_KEY == key)
+                    {
+                        server_ready = true;
+                        continue;
+                    }
+
+                    index = POOLER_EPOLL_KEY_INDEX(key);
+                    agent = poolAgents[index];
+                    if (agent && Socket(agent->port) == POOLER_EPOLL_KEY_FD(key))
+                    {
+                        agent_handle_input(agent, &input_message);
+                    }
                 }
+            }
+            else
+#endif
+            {
+                for (i = agentCount - 1; i >= 0; i--)
+                {
+                    index  = agentIndexes[i];
+                    agent  = poolAgents[index];            
                 
+                    sockfd = Socket(agent->port);
+                    if ((sockfd == pool_fd[i + 1].fd) && pool_fd[i + 1].revents)
+                    {
+                        agent_handle_input(agent, &input_message);
+                    }
+                
+                }
+                server_ready = (pool_fd[0].revents & POLLIN) != 0;
             }
 
-            if (pool_fd[0].revents & POLLIN)
+            if (server_ready)
             {
                 int new_fd = accept(server_fd, NULL, NULL);
 
@@ -5920,7 +6151,8 @@ shrink_pool(DatabasePool *pool)
         */
         freeCount = 0;
         nodeidx = get_node_index_by_nodeoid(nodePool->nodeoid);
-        for (i = 0; i < nodePool->freeSize && freeCount < MAX_FREE_CONNECTION_NUM && nodePool->size >= MinPoolSize && nodePool->freeSize >= MinFreeSize; )
+        for (i = 0; i < nodePool->freeSize && freeCount < MAX_FREE_CONNECTION_NUM && nodePool->size >= MinPoolSize && nodePool->freeSize >= MinFreeSize &&
+                    nodePool->size > pool_demand_target(nodePool); )
         {
             PGXCNodePoolSlot *slot = nodePool->slot[i];
             if (slot)
@@ -5941,6 +6173,7 @@ shrink_pool(DatabasePool *pool)
 							nodePool->size, nodePool->freeSize);
                     }
                     /* connection is idle for long, close it */                    
+                    pool_latency_record_lifetime(nodePool, slot, now);
                     destroy_slot(nodeidx, nodePool->nodeoid, slot);
                     
                     /* reduce pool size and total number of connections */
@@ -6116,6 +6349,9 @@ pools_maintenance(void)
         }
         else
         {
+            /* get ready for the demand recent windows have seen */
+            pool_demand_prebuild(curr, now);
+
             /* async warm the pool */
             pooler_async_warm_database_pool(curr);
 
@@ -6127,6 +6363,163 @@ pools_maintenance(void)
             difftime(time(NULL), now), count);
 }
 
+/*
+ * Demand tracking. For every node pool we remember the peak number of
+ * connections handed out per window of PoolDemandWindow seconds, for the
+ * last POOL_DEMAND_WINDOWS windows. The pool is kept at least that large, so
+ * periodic bursts find their connections already built instead of waiting for
+ * pooler_async_build_connection.
+ */
+static void
+pool_demand_init(PGXCNodePool *nodePool)
+{
+    nodePool->demand_cur   = 0;
+    nodePool->demand_idx   = 0;
+    nodePool->demand_start = time(NULL);
+    memset(nodePool->demand_hist, 0, sizeof(nodePool->demand_hist));
+}
+
+static void
+pool_demand_update(PGXCNodePool *nodePool, time_t now)
+{
+    int32 inuse   = nodePool->size - nodePool->freeSize;
+    int32 elapsed = 0;
+
+    if (PoolDemandWindow <= 0)
+    {
+        return;
+    }
+
+    elapsed = (int32) (difftime(now, nodePool->demand_start) / PoolDemandWindow);
+    if (elapsed > 0)
+    {
+        int32 i;
+
+        /* close the current window, windows nobody acquired in saw inuse */
+        for (i = 0; i < elapsed && i < POOL_DEMAND_WINDOWS; i++)
+        {
+            nodePool->demand_idx = (nodePool->demand_idx + 1) % POOL_DEMAND_WINDOWS;
+            nodePool->demand_hist[nodePool->demand_idx] = (0 == i) ? nodePool->demand_cur : inuse;
+        }
+        nodePool->demand_cur    = inuse;
+        nodePool->demand_start += (time_t) elapsed * PoolDemandWindow;
+    }
+
+    if (inuse > nodePool->demand_cur)
+    {
+        nodePool->demand_cur = inuse;
+    }
+}
+
+static int32
+pool_demand_target(PGXCNodePool *nodePool)
+{
+    int32 target = 0;
+    int32 i;
+
+    if (PoolDemandWindow <= 0)
+    {
+        return 0;
+    }
+
+    target = nodePool->demand_cur;
+    for (i = 0; i < POOL_DEMAND_WINDOWS; i++)
+    {
+        if (nodePool->demand_hist[i] > target)
+        {
+            target = nodePool->demand_hist[i];
+        }
+    }
+    return target;
+}
+
+static void
+pool_demand_prebuild(DatabasePool *dbPool, time_t now)
+{
+    HASH_SEQ_STATUS hseq_status;
+    PGXCNodePool   *nodePool;
+    List           *grow = NIL;
+    ListCell       *lc;
+
+    if (PoolDemandWindow <= 0 || !dbPool->bneed_pool)
+    {
+        return;
+    }
+
+    hash_seq_init(&hseq_status, dbPool->nodePools);
+    while ((nodePool = (PGXCNodePool *) hash_seq_search(&hseq_status)))
+    {
+        pool_demand_update(nodePool, now);
+        if (!nodePool->asyncInProgress && nodePool->size < pool_demand_target(nodePool))
+        {
+            grow = lappend(grow, nodePool);
+        }
+    }
+
+    /* grow_pool() looks the pool up again, do not do it while scanning */
+    foreach(lc, grow)
+    {
+        nodePool = (PGXCNodePool *) lfirst(lc);
+        grow_pool(dbPool, get_node_index_by_nodeoid(nodePool->nodeoid), nodePool->nodeoid, nodePool->coord);
+    }
+    list_free(grow);
+}
+
+/*
+ * Latency tracking. Every node pool keeps log2 histograms in microseconds of
+ * how long sessions waited for a connection, how long replaying their SET
+ * commands took, how long an async build took to land in the pool and how
+ * long connections lived, so the pool sizes can be tuned from data.
+ */
+static void
+pool_latency_init(PGXCNodePool *nodePool)
+{
+    memset(nodePool->latency, 0, sizeof(nodePool->latency));
+}
+
+static void
+pool_latency_record(PGXCNodePool *nodePool, PoolLatencyType type, uint64 usec)
+{
+    int32 bucket = 0;
+
+    while (usec > 0 && bucket < POOL_LATENCY_BUCKETS - 1)
+    {
+        usec >>= 1;
+        bucket++;
+    }
+    nodePool->latency[type][bucket]++;
+}
+
+static void
+pool_latency_record_lifetime(PGXCNodePool *nodePool, PGXCNodePoolSlot *slot, time_t now)
+{
+    double lifetime;
+
+    if (!slot || slot->created == 0)
+    {
+        return;
+    }
+
+    lifetime = difftime(now, slot->created);
+    pool_latency_record(nodePool, POOL_LATENCY_LIFETIME,
+                        lifetime > 0 ? (uint64) (lifetime * 1000000) : 0);
+}
+
+/* also used by the sync threads, must not touch any shared state */
+static uint64
+pool_time_diff_us(struct timeval *start, struct timeval *end)
+{
+    int64 diff;
+
+    if (start->tv_sec == 0 && start->tv_usec == 0)
+    {
+        return 0;
+    }
+
+    diff = (int64) (end->tv_sec - start->tv_sec) * 1000000 + (end->tv_usec - start->tv_usec);
+    return diff > 0 ? (uint64) diff : 0;
+}
+
 /* Process async msg from async threads */
 static void pooler_handle_sync_response_queue(void)
 {// #lizard forgives
@@ -6155,6 +6548,16 @@ static void pooler_handle_sync_response_queue(void)
                 {        
                     
                     record_time(connRsp->start_time, connRsp->end_time);
+
+                    /* the last request only answers the session, it has no connection of its own */
+                    if (!connRsp->needfree && PoolConnectStaus_done == connRsp->current_status)
+                    {
+                        pool_latency_record(connRsp->nodepool, POOL_LATENCY_ACQUIRE, connRsp->acquire_time);
+                        if (connRsp->set_time)
+                        {
+                            pool_latency_record(connRsp->nodepool, POOL_LATENCY_SET, connRsp->set_time);
+                        }
+                    }
                     
                     switch (get_task_status(connRsp->taskControl))
                     {
@@ -6685,6 +7088,10 @@ static void pooler_sync_connections_to_nodepool(void)
                 }
                 
                 /* time to close the connection */
+                if (nodePool)
+                {
+                    pool_latency_record_lifetime(nodePool, asyncInfo->slot, time(NULL));
+                }
                 destroy_slot(asyncInfo->nodeindex, asyncInfo->node, asyncInfo->slot);
                 if (nodePool)
                 {
@@ -6729,6 +7136,8 @@ static void pooler_sync_connections_to_nodepool(void)
                     nodePool->coord      = false; /* in this case, only datanode */
                     nodePool->nwarming   = 0;
                     nodePool->nquery     = 0;
+                    pool_demand_init(nodePool);
+                    pool_latency_init(nodePool);
 					nodePool->m_version = time(NULL);
 
                     name_str = get_node_name_by_nodeoid(asyncInfo->node);
@@ -6889,6 +7298,8 @@ static void pooler_sync_connections_to_nodepool(void)
                         nodePool->coord      = connRsp->bCoord; 
                         nodePool->nwarming   = 0;
                         nodePool->nquery     = 0;
+                        pool_demand_init(nodePool);
+                        pool_latency_init(nodePool);
 
                         name_str = get_node_name_by_nodeoid(connRsp->nodeoid);
                         if (NULL == name_str)
@@ -6906,6 +7317,15 @@ static void pooler_sync_connections_to_nodepool(void)
 							nodePool->nodeoid, nodePool->node_name);
                     }
 
+                    if (connRsp->validSize > 0)
+                    {
+                        struct timeval build_end;
+
+                        gettimeofday(&build_end, NULL);
+                        pool_latency_record(nodePool, POOL_LATENCY_BUILD,
+                                            pool_time_diff_us(&connRsp->build_start, &build_end));
+                    }
+
                     /* add connection to hash table */
                     for (connIndex = 0; connIndex < connRsp->validSize; connIndex++)
                     {
@@ -7173,6 +7593,7 @@ static bool pooler_async_build_connection(DatabasePool *pool, time_t pool_versio
     connReq->size      = size;
     connReq->validSize = 0;
     connReq->m_version = pool_version;
+    gettimeofday(&connReq->build_start, NULL);
 
 	while (-1 == PipePut(g_PoolConnControl.request[threadid], (void*)connReq))
     {
@@ -7448,6 +7869,8 @@ preconnect_and_warm(DatabasePool *dbPool)
             nodePool->coord    = false;
             nodePool->nwarming   = 0;
             nodePool->nquery     = 0;
+            pool_demand_init(nodePool);
+            pool_latency_init(nodePool);
 
             name_str = get_node_name_by_nodeoid(dnOids[i]);
             if (NULL == name_str)
@@ -7931,6 +8354,9 @@ void *pooler_sync_remote_operator_thread(void *arg)
                             case PoolConnectStaus_set_param:
                             {                        
                                 CommandId commandId = InvalidCommandId;
+                                struct timeval set_start;
+                                struct timeval set_end;
+
                                 if (PoolConnectStaus_set_param == request->final_status)
                                 {
                                     res = 0;
@@ -7956,6 +8382,7 @@ void *pooler_sync_remote_operator_thread(void *arg)
                                         /* record message */
                                         record_task_message(&g_PoolSyncNetworkControl, threadIndex, request->agent->session_params);
                                         
+                                        gettimeofday(&set_start, NULL);
                                         if (request->bCoord)
                                         {
                                             res = PGXCNodeSendSetQuery(request->agent->coord_connections[request->nodeindex]->conn, request->agent->session_params, request->errmsg, POOLER_ERROR_MSG_LEN, &request->setquery_status, &commandId);
@@ -7964,6 +8391,8 @@ void *pooler_sync_remote_operator_thread(void *arg)
                                         {
                                             res = PGXCNodeSendSetQuery(request->agent->dn_connections[request->nodeindex]->conn, request->agent->session_params, request->errmsg, POOLER_ERROR_MSG_LEN, &request->setquery_status, &commandId);
                                         }
+                                        gettimeofday(&set_end, NULL);
+                                        request->set_time = pool_time_diff_us(&set_start, &set_end);
                                     }
 
                                     /* Error, free the connection here only when we build the connection here */
@@ -8067,7 +8496,7 @@ void *pooler_sync_remote_operator_thread(void *arg)
                                         if (request->agent->dn_connections[node])
                                         {
                                             request->taskControl->m_result[node_number] = PQsocket((PGconn *) request->agent->dn_connections[node]->conn);
-                                            request->taskControl->m_pidresult[node_number] = ((PGconn *) request->agent->dn_connections[node]->conn)->be_pid;
+                                            request->taskControl->m_pidresult[node_number] = POOL_SLOT_PID(request->agent->dn_connections[node]);
 #ifdef     _POOLER_CHECK_    
                                             hostip[node_number] = strdup(((PGconn *) request->agent->dn_connections[node]->conn)->pghost);
                                             hostport[node_number] = strdup(((PGconn *) request->agent->dn_connections[node]->conn)->pgport);
@@ -8089,7 +8518,7 @@ void *pooler_sync_remote_operator_thread(void *arg)
                                         if (request->agent->coord_connections[node])
                                         {
                                             request->taskControl->m_result[node_number] = PQsocket((PGconn *) request->agent->coord_connections[node]->conn);
-                                            request->taskControl->m_pidresult[node_number] = ((PGconn *) request->agent->coord_connections[node]->conn)->be_pid;    
+                                            request->taskControl->m_pidresult[node_number] = POOL_SLOT_PID(request->agent->coord_connections[node]);
 #ifdef     _POOLER_CHECK_    
                                             hostip[node_number] = strdup(((PGconn *) request->agent->coord_connections[node]->conn)->pghost);
                                             hostport[node_number] = strdup(((PGconn *) request->agent->coord_connections[node]->conn)->pgport);
@@ -8383,6 +8812,14 @@ void *pooler_sync_remote_operator_thread(void *arg)
                 gettimeofday(&request->end_time, NULL);        
             }
 
+            if ('g' == request->cmd)
+            {
+                struct timeval acquire_end;
+
+                gettimeofday(&acquire_end, NULL);
+                request->acquire_time = pool_time_diff_us(&request->acquire_start, &acquire_end);
+            }
+
             if (request->cmd_start_time != 0)
             {
                 request->cmd_end_time = get_system_time();
@@ -8579,6 +9016,7 @@ static inline bool dispatch_connection_request(PGXCASyncTaskCtl  *taskControl,
     {
         gettimeofday(&req->start_time, NULL);
     }
+    gettimeofday(&req->acquire_start, NULL);
 
     /* only init stauts need to alloc a slot */
     if (PoolConnectStaus_init == status)
@@ -8592,6 +9030,7 @@ static inline bool dispatch_connection_request(PGXCASyncTaskCtl  *taskControl,
         /* set seqnum */
         slot->seqnum     = pooler_get_slot_seq_num();
         slot->pid         = agent->pid;
+        slot->last_holder = agent->pid;
         req->slot        = slot;
         req->needConnect = true;
         MemoryContextSwitchTo(oldcontext);
@@ -11552,3 +11991,54 @@ handle_get_conn_statistics(PoolAgent *agent)
 
     pfree(buf.data);
 }
+
+/*
+ * handle get latency statistics
+ */
+static void
+handle_get_latency_statistics(PoolAgent *agent)
+{
+    DatabasePool     *database_pool = databasePools;
+    HASH_SEQ_STATUS  hseq_status;
+    PGXCNodePool     *node_pool = NULL;
+    uint32           total_node_cnt = 0;
+    uint32           total_node_cnt_offset = 0;
+    int              i = 0;
+    int              j = 0;
+    StringInfoData   buf;
+
+    initStringInfo(&buf);
+    total_node_cnt_offset = buf.len;
+    pq_sendint(&buf, total_node_cnt, sizeof(uint32));
+
+    /* total node count | database | username | node name | is coord | histograms | ... */
+    while (database_pool)
+    {
+        hash_seq_init(&hseq_status, database_pool->nodePools);
+        while ((node_pool = (PGXCNodePool *) hash_seq_search(&hseq_status)))
+        {
+            total_node_cnt++;
+
+            pq_sendstring(&buf, database_pool->database);
+            pq_sendstring(&buf, database_pool->user_name);
+            pq_sendstring(&buf, node_pool->node_name);
+            pq_sendint(&buf, node_pool->coord, sizeof(bool));
+            for (i = 0; i < POOL_LATENCY_COUNT; i++)
+            {
+                for (j = 0; j < POOL_LATENCY_BUCKETS; j++)
+                {
+                    pq_sendint(&buf, node_pool->latency[i][j], sizeof(uint32));
+                }
+            }
+        }
+        database_pool = database_pool->next;
+    }
+
+    total_node_cnt = htonl(total_node_cnt);
+    pq_updatemsgbytes(&buf, total_node_cnt_offset, (char*) &total_node_cnt, sizeof(uint32));
+
+    pool_putmessage(&agent->port, 'w', buf.data, buf.len);
+    pool_flush(&agent->port);
+
+    pfree(buf.data);
+}
@@ -142,6 +142,36 @@ pgxc_pool_reload(PG_FUNCTION_ARGS)
     PG_RETURN_BOOL(true);
 }
 
+/*
+ * pgxc_pool_refresh
+ *
+ * Less destructive version of pgxc_pool_reload, for the case where NODEs
+ * have only been ALTERed, as when a slave is promoted by failover.  Only the
+ * pools of the nodes whose host or port changed are redirected: their idle
+ * connections are closed at once and the busy ones when they are released,
+ * and new connections go to the new address.  Sessions keep their
+ * connections to the other nodes and their transactions.
+ *
+ * Returns false if NODEs were also added or dropped, or the local node was
+ * altered; pgxc_pool_reload is needed then.
+ */
+Datum
+pgxc_pool_refresh(PG_FUNCTION_ARGS)
+{
+    if (IsTransactionBlock())
+        ereport(ERROR,
+                (errcode(ERRCODE_ACTIVE_SQL_TRANSACTION),
+                 errmsg("pgxc_pool_refresh cannot run inside a transaction block")));
+
+    PG_RETURN_BOOL(PgxcNodeRefresh());
+}
+
+/*
+ * PgxcNodeRefresh
+ *
+ * Refresh the pooler and the sessions if NODEs have only been ALTERed.
+ * Returns true if that was the case, false if a reload is needed.
+ */
 bool
 PgxcNodeRefresh(void)
 {
@@ -181,15 +211,17 @@ PgxcNodeRefresh(void)
 
     PgxcNodeRefreshBackendHandlesShmem(nodes_alter);
 
-    /* Signal other sessions to reconnect to pooler if have privileges */
-    if (superuser())
-        ReloadConnInfoOnBackends(true);
+    /*
+     * Other sessions are not signalled: the pooler bumped the node table
+     * version, and each of them refreshes its handles the next time it
+     * needs a connection.
+     */
 
     list_free(nodes_alter);
     list_free(nodes_add);
     list_free(nodes_delete);
 
-    return false;
+    return true;
 }
 
 /*
@@ -85,6 +85,7 @@
 #include "access/genam.h"
 #include "catalog/indexing.h"
 #include "utils/fmgroids.h"
+#include "storage/extentmapping.h"
 
 
 static void
@@ -411,6 +412,9 @@ int64 vacuum_shard_internal(Relation rel, Bitmapset *to_vacuum, Snapshot vacuum_
     HeapTuple    tup;
     int64 n = 0;
     int tuples = 0;
+    ExtentID *extents = NULL;
+    int nextents = 0;
+    int nextextent = 0;
 
     if(!IS_PGXC_DATANODE)
         return 0;
@@ -436,10 +440,29 @@ int64 vacuum_shard_internal(Relation rel, Bitmapset *to_vacuum, Snapshot vacuum_
     }    
 
     scan = heap_beginscan(rel, vacuum_snapshot, 0, NULL);
-    tup = heap_getnext(scan,ForwardScanDirection);
-    
-    while(HeapTupleIsValid(tup))
+
+    /*
+     * The tuples of the shards are all in the extents on their scan lists,
+     * so read just those; start out empty and move on extent by extent.
+     */
+    if(to_vacuum && RelationHasExtent(rel))
+    {
+        extents = GetShardsScanExtents(rel, to_vacuum, &nextents);
+        if(extents)
+            heap_setscanlimits(scan, 0, 0);
+    }
+
+    for(;;)
     {
+        tup = heap_getnext(scan,ForwardScanDirection);
+        if(!HeapTupleIsValid(tup))
+        {
+            if(extents == NULL || nextextent >= nextents)
+                break;
+            (void) heap_setscanextent(scan, extents[nextextent++]);
+            continue;
+        }
+
         if(!to_vacuum || bms_is_member(HeapTupleGetShardId(tup),to_vacuum))
         {
             n++;
@@ -456,10 +479,11 @@ int64 vacuum_shard_internal(Relation rel, Bitmapset *to_vacuum, Snapshot vacuum_
                 }
             }
         }
-        tup = heap_getnext(scan,ForwardScanDirection);
     }
 
     heap_endscan(scan);
+    if(extents)
+        pfree(extents);
 
     return n;
 }
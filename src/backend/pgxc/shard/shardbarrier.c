@@ -100,9 +100,9 @@ typedef struct ShardBarrierInfo
 static ShardBarrierInfo *g_barrier_shards_info = NULL;
 static HTAB                *g_barrier_shards_ht = NULL;
 
-/* process local */
-static bool has_shard_barriered = false;
-static ShardBarrierTag barriered_shard;
+/* process local, one backend may barrier a batch of shards at a time */
+static int    n_barriered_shards = 0;
+static ShardBarrierTag barriered_shards[MAX_BARRIER_SHARDS];
 
 void ShardBarrierShmemInit(void)
 {
@@ -155,9 +155,9 @@ void AddShardBarrier(RelFileNode rel, ShardID sid, BackendId pid)
         elog(ERROR, "add shard barrier failed. because sid %d is invalid.", sid);
     }
 
-    if(has_shard_barriered)
+    if(n_barriered_shards >= MAX_BARRIER_SHARDS)
     {
-        elog(ERROR, "only one shard can be barriered at the same time.");
+        elog(ERROR, "too many shards are barriered by this backend.");
     }
     
     tag.rel = rel;
@@ -178,8 +178,7 @@ void AddShardBarrier(RelFileNode rel, ShardID sid, BackendId pid)
         ent->flags = 0;
         ent->pid = pid;
         ent->start_time = GetCurrentTimestamp();
-        has_shard_barriered = true;
-        memcpy(&barriered_shard, &tag, sizeof(ShardBarrierTag));
+        memcpy(&barriered_shards[n_barriered_shards++], &tag, sizeof(ShardBarrierTag));
         g_barrier_shards_info->n_shards++;
     }
     LWLockRelease(ShardBarrierLock);
@@ -194,6 +193,7 @@ void RemoveOneShardBarrier(RelFileNode rel, ShardID sid)
 {
     bool found = false;
     ShardBarrierTag tag;
+    int  i;
 
     if(!ShardIDIsValid(sid))
     {
@@ -204,13 +204,20 @@ void RemoveOneShardBarrier(RelFileNode rel, ShardID sid)
     tag.sid = sid;
     tag.reserved = 0;
 
+    for(i = 0; i < n_barriered_shards; i++)
+    {
+        if(RelFileNodeEquals(rel, barriered_shards[i].rel) && sid == barriered_shards[i].sid)
+        {
+            barriered_shards[i] = barriered_shards[--n_barriered_shards];
+            break;
+        }
+    }
+
     LWLockAcquire(ShardBarrierLock, LW_EXCLUSIVE);
     (void)hash_search(g_barrier_shards_ht, (void *)&tag, HASH_REMOVE, &found);
 
     if(found)
     {
-        has_shard_barriered = false;
-        memset(&barriered_shard, 0, sizeof(ShardBarrierTag));
         g_barrier_shards_info->n_shards--;
     }
     
@@ -225,10 +232,12 @@ void RemoveOneShardBarrier(RelFileNode rel, ShardID sid)
 
 void RemoveShardBarrier()
 {
-    if(!has_shard_barriered)
-        return;
+    while(n_barriered_shards > 0)
+    {
+        ShardBarrierTag tag = barriered_shards[n_barriered_shards - 1];
 
-    RemoveOneShardBarrier(barriered_shard.rel, barriered_shard.sid);
+        RemoveOneShardBarrier(tag.rel, tag.sid);
+    }
 }
 
 
@@ -262,11 +271,13 @@ bool IsShardBarriered(RelFileNode rel, ShardID sid)
 
 bool LocalHasShardBarriered(RelFileNode rel, ShardID sid)
 {
-    if(!has_shard_barriered)
-        return false;
+    int i;
 
-    if(RelFileNodeEquals(rel,barriered_shard.rel) && sid == barriered_shard.sid)
-        return true;
+    for(i = 0; i < n_barriered_shards; i++)
+    {
+        if(RelFileNodeEquals(rel, barriered_shards[i].rel) && sid == barriered_shards[i].sid)
+            return true;
+    }
 
     return false;
 }
@@ -274,13 +285,13 @@ bool LocalHasShardBarriered(RelFileNode rel, ShardID sid)
 void ATEOXact_CleanUpShardBarrier(void)
 {
 #if 0
-    if(has_shard_barriered)
+    if(n_barriered_shards > 0)
     {
         elog(ERROR, "remove shard barrier[%d/%d/%d|%d] because of exception.",
-                    barriered_shard.rel.dbNode,
-                    barriered_shard.rel.spcNode,
-                    barriered_shard.rel.relNode,
-                    barriered_shard.sid);
+                    barriered_shards[0].rel.dbNode,
+                    barriered_shards[0].rel.spcNode,
+                    barriered_shards[0].rel.relNode,
+                    barriered_shards[0].sid);
     }
 #endif
     RemoveShardBarrier();    
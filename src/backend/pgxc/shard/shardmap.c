@@ -59,7 +59,12 @@
  * 
  */
 #include "postgres.h"
+
+#include <math.h>
+
 #include "storage/extentmapping.h"
+#include "storage/ipc.h"
+#include "port/atomics.h"
 #include "storage/s_lock.h"
 #include "storage/shmem.h"
 #include "storage/smgr.h"
@@ -149,6 +154,7 @@ typedef struct
 {
     bool           inited;
     bool           needLock;                      /* whether we need lock */
+    pg_atomic_uint32 version;                     /* bumped by each writer */
     slock_t           lock[MAX_SHARDING_NODE_GROUP]; /* locks to protect used fields */
     bool            used[MAX_SHARDING_NODE_GROUP];
 
@@ -160,6 +166,7 @@ typedef struct
 {
     bool           inited;
     bool           needLock;                      /* whether we need lock */
+    pg_atomic_uint32 version;                     /* bumped by each writer */
     slock_t           lock; /* locks to protect used fields */
     bool            used;
 
@@ -176,6 +183,23 @@ static ShardNodeGroupInfo_DN *g_GroupShardingMgr_DN = NULL;
 /* used for datanodes */
 Bitmapset                      *g_DatanodeShardgroupBitmap  = NULL;
 
+/*
+ * Backend local copy of the shard to node index array of a group, so routing
+ * a row does not touch the shared hash table nor ShardMapLock.  A copy is
+ * valid as long as the version of the shared map has not moved since it was
+ * taken; writers bump it once they hold ShardMapLock exclusively.
+ */
+typedef struct
+{
+    Oid     group;
+    uint32  version;
+    int32   nshards;
+    int32  *nodeindex;                /* node index of each shard */
+} ShardMapCacheEnt;
+
+static ShardMapCacheEnt g_ShardMapCache[MAX_SHARDING_NODE_GROUP];
+static int              g_ShardMapCacheNum = 0;
+
 typedef struct
 {
     int32 nGroups;
@@ -220,7 +244,66 @@ typedef struct
     pg_crc32c      crc;
 } ShardRecord;
 
-ShardStatistic *shardStatInfo = NULL;
+/*
+ * Shared counters of one shard, padded to a cache line so that backends
+ * bumping neighbouring shards do not bounce the same line.
+ */
+typedef union
+{
+    ShardStatistic stat;
+    char           pad[PG_CACHE_LINE_SIZE];
+} ShardStatisticPadded;
+
+ShardStatisticPadded *shardStatInfo = NULL;
+
+/*
+ * Backend local counters of the shard touched last. Row by row updates of
+ * one shard are summed here and pushed to shared memory in a batch.
+ */
+#define SHARD_STAT_BATCH_SIZE 64
+
+typedef struct
+{
+    ShardID sid;
+    int     nupdates;
+    uint64  ntuples_select;
+    uint64  ntuples_insert;
+    uint64  ntuples_update;
+    uint64  ntuples_delete;
+    int64   ntuples;
+    int64   size;
+} PendingShardStatistic;
+
+static PendingShardStatistic pendingShardStat = {InvalidShardID};
+static bool pendingShardStatRegistered = false;
+
+/*
+ * Buffer accesses per shard, counted by the buffer manager from the shard id
+ * in the page header. Reads and writes cost an I/O anyway and go to shared
+ * memory at once; hits are summed in backend local memory and pushed along
+ * with the pending shard statistic.
+ */
+#define SHARD_IO_HIT_BATCH_SIZE 65536
+
+typedef struct
+{
+    pg_atomic_uint64 blks_read;
+    pg_atomic_uint64 blks_hit;
+    pg_atomic_uint64 blks_written;
+} ShardIOStatistic;
+
+typedef union
+{
+    ShardIOStatistic stat;
+    char             pad[PG_CACHE_LINE_SIZE];
+} ShardIOStatisticPadded;
+
+static ShardIOStatisticPadded *shardIOStatInfo = NULL;
+
+static uint32 pendingShardHits[MAX_SHARDS];
+static ShardID pendingShardHitList[MAX_SHARDS];
+static int    npendingShardHitList = 0;
+static int    npendingShardHits = 0;
 
 #define SHARD_STATISTIC_FILE_PATH "pg_stat/shard.stat"
 
@@ -235,6 +318,21 @@ typedef struct
     ShardStatistic *rec;
 } ShmMgr_State;
 
+typedef struct
+{
+    int      currIdx;
+    uint64 (*rec)[3];        /* blocks read, hit and written per shard */
+} ShardIOStat_State;
+
+typedef struct
+{
+    int      currIdx;
+    int      nmoves;
+    int32   *shardgroup;    /* shard group to move */
+    Oid     *fromnode;        /* its current node */
+    Oid     *tonode;        /* node it should go to */
+} ShardRebalance_State;
+
 bool  show_all_shard_stat = false;
 
 #ifdef __COLD_HOT__
@@ -330,6 +428,9 @@ static void   FreshGroupShardMap(Oid group);
 static void   BuildDatanodeVisibilityMap(Form_pgxc_shard_map tuple, Oid self_oid);
 static void GetShardNodes_CN(Oid group, int32 ** nodes, int32 *num_nodes, bool *isextension);
 static void GetShardNodes_DN(Oid group, int32 ** nodes, int32 *num_nodes, bool *isextension);
+static pg_atomic_uint32 *ShardMapVersion(void);
+static void   ShardMapLockForUpdate(void);
+static ShardMapCacheEnt *GetCachedShardMap(Oid group);
 
 extern Datum  pg_stat_table_shard(PG_FUNCTION_ARGS);
 extern Datum  pg_stat_all_shard(PG_FUNCTION_ARGS);
@@ -341,6 +442,7 @@ static Datum pg_set_cold_access(void);
 static Datum pg_clear_cold_access(void);
 static bool AddDualWriteInfo(Oid relation, AttrNumber attr, int32 gap, char *table, char *column, char *value);
 static long compute_keyvalue_hash(Oid type, Datum value);
+static Timestamp GetManualHotDataTimestamp(void);
 
 #endif
 
@@ -350,6 +452,25 @@ static long compute_keyvalue_hash(Oid type, Datum value);
  *
  -----------------------------------------------------------*/
 
+static pg_atomic_uint32 *
+ShardMapVersion(void)
+{
+    if (IS_PGXC_COORDINATOR)
+        return &g_GroupShardingMgr->version;
+    return &g_GroupShardingMgr_DN->version;
+}
+
+/*
+ * Every change of the shard map is made holding ShardMapLock exclusively;
+ * take it and invalidate the copies cached by the backends.
+ */
+static void
+ShardMapLockForUpdate(void)
+{
+    LWLockAcquire(ShardMapLock, LW_EXCLUSIVE);
+    pg_atomic_fetch_add_u32(ShardMapVersion(), 1);
+}
+
 void InvalidateShmemShardMap(bool iscommit)
 {// #lizard forgives
     int32 i = 0;
@@ -363,7 +484,7 @@ void InvalidateShmemShardMap(bool iscommit)
                 /* tell others use lock to access shard map */
                 g_GroupShardingMgr->needLock = true;
                 
-                LWLockAcquire(ShardMapLock, LW_EXCLUSIVE);
+                ShardMapLockForUpdate();
                 for (i = 0; i < g_UpdateShardingGroupInfo.nGroups; i++)
                 {
                     if (ShardOpType_create == g_UpdateShardingGroupInfo.optype[i])
@@ -393,7 +514,7 @@ void InvalidateShmemShardMap(bool iscommit)
                     }
                     else if (ShardOpType_drop == g_UpdateShardingGroupInfo.optype[i])
                     {
-                        LWLockAcquire(ShardMapLock, LW_EXCLUSIVE);
+                        ShardMapLockForUpdate();
                         RemoveShardMapEntry(g_UpdateShardingGroupInfo.group[i]);
                         LWLockRelease(ShardMapLock);
                     }
@@ -465,6 +586,7 @@ void ShardMapShmemInit_CN(void)
     }
     g_GroupShardingMgr->inited   = false;
     g_GroupShardingMgr->needLock = false;
+    pg_atomic_init_u32(&g_GroupShardingMgr->version, 0);
     
     groupshard = (GroupShardInfo *)ShmemInitStruct("Group shard major",
                                                         MAXALIGN64(sizeof(GroupShardInfo)) + MAXALIGN64(sizeof(ShardMapItemDef)) * (SHARD_MAP_GROUP_NUM - 1),
@@ -531,6 +653,7 @@ void ShardMapShmemInit_DN(void)
     }
     g_GroupShardingMgr_DN->inited   = false;
     g_GroupShardingMgr_DN->needLock = false;
+    pg_atomic_init_u32(&g_GroupShardingMgr_DN->version, 0);
     
     groupshard = (GroupShardInfo *)ShmemInitStruct("Group shard major",
                                                         MAXALIGN64(sizeof(GroupShardInfo)) + MAXALIGN64(sizeof(ShardMapItemDef)) * (SHARD_MAP_GROUP_NUM - 1),
@@ -615,7 +738,7 @@ static void SyncShardMapList_CN(bool force)
     /* tell others use lock to access shard map */
     g_GroupShardingMgr->needLock = true;
 
-    LWLockAcquire(ShardMapLock, LW_EXCLUSIVE);    
+    ShardMapLockForUpdate();    
 
 	/* in case of race conditions */
 	if (!force && g_UpdateShardingGroupInfo.nGroups == 0 && g_GroupShardingMgr->inited)
@@ -658,7 +781,7 @@ static void SyncShardMapList_DN(bool force)
     /* tell others use lock to access shard map */
     g_GroupShardingMgr_DN->needLock = true;
 
-	LWLockAcquire(ShardMapLock, LW_EXCLUSIVE);
+	ShardMapLockForUpdate();
 
 	/* in case of race conditions */
 	if (!force && g_UpdateShardingGroupInfo.nGroups == 0 && g_GroupShardingMgr_DN->inited)
@@ -976,7 +1099,7 @@ static void ShardMapInitDone_CN(int32 map, Oid group, bool need_lock)
 
     if (need_lock)
     {
-        LWLockAcquire(ShardMapLock, LW_EXCLUSIVE);
+        ShardMapLockForUpdate();
     }
 
     /* Add group node to hashmap. */
@@ -1078,7 +1201,7 @@ static void ShardMapInitDone_DN(Oid group, bool need_lock)
 
     if (need_lock)
     {
-        LWLockAcquire(ShardMapLock, LW_EXCLUSIVE);
+        ShardMapLockForUpdate();
     }
     
     /* init shard group nodes of the shard map */
@@ -1269,61 +1392,145 @@ List* ShardMapRouter(Oid group, Oid relation, Oid type, Datum dvalue, RelationAc
     return list_make1_int(GetNodeIndexByHashValue(group, hashvalue));
 }
 #endif
-int32  GetNodeIndexByHashValue(Oid group, long hashvalue)
-{// #lizard forgives    
-    int            shardIdx;
-    int            nodeIdx = 0;
-    bool           needLock = false;
-    bool           found;
-    GroupLookupTag tag;
-    GroupLookupEnt *ent;
-    ShardMapItemDef *shardgroup;
-    int slot = 0;
-    
-    if(IS_PGXC_COORDINATOR && !OidIsValid(group))
+/*
+ * Copy the shard map of a group into backend memory, or return the copy
+ * taken before if no writer came in since.
+ */
+static ShardMapCacheEnt *
+GetCachedShardMap(Oid group)
+{
+    ShardMapCacheEnt *cache = NULL;
+    GroupShardInfo   *groupshard;
+    uint32            version;
+    int               i;
+
+    /* a datanode only knows the shard map of its own group */
+    if (IS_PGXC_DATANODE)
+        group = InvalidOid;
+
+    for (i = 0; i < g_ShardMapCacheNum; i++)
     {
-        elog(PANIC, "[GetNodeIndexByHashValue]group oid can not be invalid.");
+        if (g_ShardMapCache[i].group == group)
+        {
+            cache = &g_ShardMapCache[i];
+            break;
+        }
+    }
+
+    version = pg_atomic_read_u32(ShardMapVersion());
+    if (cache != NULL && cache->nodeindex != NULL && cache->version == version)
+        return cache;
+
+    if (cache == NULL)
+    {
+        if (g_ShardMapCacheNum >= MAX_SHARDING_NODE_GROUP)
+            elog(ERROR, "too many groups in the shard map cache");
+        cache = &g_ShardMapCache[g_ShardMapCacheNum++];
+        cache->group = group;
+        cache->nodeindex = NULL;
+        cache->nshards = 0;
     }
 
+    LWLockAcquire(ShardMapLock, LW_SHARED);
+
+    /* writers hold the lock exclusively, so it is stable now */
+    version = pg_atomic_read_u32(ShardMapVersion());
+
     if (IS_PGXC_COORDINATOR)
     {
-        needLock  = g_GroupShardingMgr->needLock;
-        if (needLock)
-        {
-            LWLockAcquire(ShardMapLock, LW_SHARED);
-        }
+        bool           found;
+        GroupLookupTag tag;
+        GroupLookupEnt *ent;
 
-        tag.group =  group;
-        ent = (GroupLookupEnt*)hash_search(g_GroupHashTab, (void *) &tag, HASH_FIND, &found);            
+        tag.group = group;
+        ent = (GroupLookupEnt*)hash_search(g_GroupHashTab, (void *) &tag, HASH_FIND, &found);
         if (!found)
         {
+            LWLockRelease(ShardMapLock);
             elog(ERROR , "no shard group of %u found", group);
         }
-
-        slot = ent->shardIndex;
-
-        shardIdx     = abs(hashvalue) % (g_GroupShardingMgr->members[slot]->shmemNumShards);
-        shardgroup   = &g_GroupShardingMgr->members[slot]->shmemshardmap[shardIdx];
-        nodeIdx      = shardgroup->nodeindex;
+        groupshard = g_GroupShardingMgr->members[ent->shardIndex];
     }
-    else if (IS_PGXC_DATANODE)
+    else
+        groupshard = g_GroupShardingMgr_DN->members;
+
+    if (cache->nodeindex == NULL || cache->nshards != groupshard->shmemNumShards)
     {
-        needLock  = g_GroupShardingMgr_DN->needLock;
-        if (needLock)
-        {
-            LWLockAcquire(ShardMapLock, LW_SHARED);
-        }
+        if (cache->nodeindex != NULL)
+            pfree(cache->nodeindex);
+        cache->nodeindex = (int32 *) MemoryContextAlloc(TopMemoryContext,
+                                            sizeof(int32) * groupshard->shmemNumShards);
+        cache->nshards = groupshard->shmemNumShards;
+    }
+
+    for (i = 0; i < cache->nshards; i++)
+        cache->nodeindex[i] = groupshard->shmemshardmap[i].nodeindex;
+    cache->version = version;
+
+    LWLockRelease(ShardMapLock);
+
+    return cache;
+}
+
+int32  GetNodeIndexByHashValue(Oid group, long hashvalue)
+{
+    ShardMapCacheEnt *cache;
 
-        shardIdx     = abs(hashvalue) % (g_GroupShardingMgr_DN->members->shmemNumShards);
-        shardgroup   = &g_GroupShardingMgr_DN->members->shmemshardmap[shardIdx];
-        nodeIdx      = shardgroup->nodeindex;
+    if(IS_PGXC_COORDINATOR && !OidIsValid(group))
+    {
+        elog(PANIC, "[GetNodeIndexByHashValue]group oid can not be invalid.");
     }
 
-    if (needLock)
+    cache = GetCachedShardMap(group);
+    if (cache->nshards <= 0)
+        elog(ERROR, "shard map of group %u is empty", group);
+
+    return cache->nodeindex[abs(hashvalue) % cache->nshards];
+}
+
+/* GetNodeIndexByHashValue of many hash values, looking up the map once */
+void
+GetNodeIndexesByHashValues(Oid group, long *hashvalues, int nvalues, int32 *nodeindexes)
+{
+    ShardMapCacheEnt *cache;
+    int32            *map;
+    int32             nshards;
+    int               i;
+
+    if(IS_PGXC_COORDINATOR && !OidIsValid(group))
     {
-        LWLockRelease(ShardMapLock);
+        elog(PANIC, "[GetNodeIndexesByHashValues]group oid can not be invalid.");
     }
-    return nodeIdx;
+
+    cache = GetCachedShardMap(group);
+    if (cache->nshards <= 0)
+        elog(ERROR, "shard map of group %u is empty", group);
+
+    map = cache->nodeindex;
+    nshards = cache->nshards;
+    for (i = 0; i < nvalues; i++)
+        nodeindexes[i] = map[abs(hashvalues[i]) % nshards];
+}
+
+/*
+ * Node owning shard "shardid" of group, or PGXC_INVALID_NODE_IDX when the
+ * shard ids stored in tuples can not be mapped onto the group's shard map.
+ */
+int32
+GetNodeIndexByShardId(Oid group, int32 shardid)
+{
+    ShardMapCacheEnt *cache;
+
+    if (!OidIsValid(group) || shardid < 0 || shardid >= MAX_SHARDS)
+        return PGXC_INVALID_NODE_IDX;
+
+    cache = GetCachedShardMap(group);
+
+    /* shard ids are hash values modulo MAX_SHARDS, see EvaluateShardId */
+    if (cache->nshards != MAX_SHARDS)
+        return PGXC_INVALID_NODE_IDX;
+
+    return cache->nodeindex[shardid];
 }
 
 /* Get node index map of group. */
@@ -1931,7 +2138,7 @@ void UpdateReplicaRelNodes(Oid newnodeid)
 */
 void ForceRefreshShardMap(Oid groupoid)
 {
-    LWLockAcquire(ShardMapLock, LW_EXCLUSIVE);
+    ShardMapLockForUpdate();
     if(!OidIsValid(groupoid))
     {    
         if (IS_PGXC_COORDINATOR)
@@ -2188,19 +2395,29 @@ int32 EvaluateShardId(Oid type, bool isNull, Datum dvalue,
     }
 
     /* check whether the value is key value */
-    get_type_io_data(type, IOFunc_output,
-                     &typlen, &typbyval,
-                     &typalign, &typdelim,
-                     &typioparam, &typiofunc);
-    value = OidOutputFunctionCall(typiofunc, dvalue);
-    if (!IsKeyValues(MyDatabaseId, table, value) && !InTempKeyValueList(relid, value, NULL, NULL))
-    {        
-        /* not the key value, use common map strategy */
-        hashvalue = compute_hash(type, dvalue, LOCATOR_TYPE_SHARD); 
-        pfree(value);
-        return  abs(hashvalue) % MAX_SHARDS;;
+    if (!OidIsValid(GetKeyValuesGroupByDatum(table, type, dvalue, NULL)))
+    {
+        bool    in_temp = false;
+
+        /* temporary key values are only known by their text */
+        if (g_TempKeyValueList != NIL)
+        {
+            get_type_io_data(type, IOFunc_output,
+                             &typlen, &typbyval,
+                             &typalign, &typdelim,
+                             &typioparam, &typiofunc);
+            value = OidOutputFunctionCall(typiofunc, dvalue);
+            in_temp = InTempKeyValueList(relid, value, NULL, NULL);
+            pfree(value);
+        }
+
+        if (!in_temp)
+        {
+            /* not the key value, use common map strategy */
+            hashvalue = compute_hash(type, dvalue, LOCATOR_TYPE_SHARD); 
+            return  abs(hashvalue) % MAX_SHARDS;
+        }
     }
-    pfree(value);
     
     /* secondary sharding map */
     hashvalue = compute_hash(type, dvalue, LOCATOR_TYPE_SHARD);
@@ -2216,13 +2433,19 @@ int32 EvaluateShardId(Oid type, bool isNull, Datum dvalue,
     return abs(hashvalue + sechashvalue) % MAX_SHARDS;
 }
 
-int
-TruncateShard(Oid reloid, ShardID sid, int pausetime)
+/*
+ * Truncate a batch of shards of one relation. All shards are barriered
+ * together, so the checkpoint that flushes their dirty pages and the write
+ * pause it implies are paid once per batch instead of once per shard.
+ */
+static int
+TruncateShardBatch(Oid reloid, ShardID *sids, int nsids, int pausetime)
 {
     ExtentID eid = InvalidExtentID;
     int    tuples = 0;
     Relation rel = NULL;
     Oid        toastoid = InvalidOid;
+    int        i;
 
     StartTransactionCommand();
     rel = heap_open(reloid, AccessShareLock);
@@ -2234,14 +2457,15 @@ TruncateShard(Oid reloid, ShardID sid, int pausetime)
     }
 
     /*
-     * step 1: add shard barrier
+     * step 1: add shard barriers
      */
-    AddShardBarrier(rel->rd_node, sid, MyProcPid);
+    for(i = 0; i < nsids; i++)
+        AddShardBarrier(rel->rd_node, sids[i], MyProcPid);
     heap_close(rel,AccessShareLock);
     CommitTransactionCommand();
 
     /*
-     * step 2: do checkpoint, make sure dirty page of this shard flushed to storage. 
+     * step 2: do checkpoint, make sure dirty pages of these shards flushed to storage. 
      */
     RequestCheckpoint(CHECKPOINT_IMMEDIATE | CHECKPOINT_FORCE | CHECKPOINT_WAIT);
 
@@ -2249,73 +2473,76 @@ TruncateShard(Oid reloid, ShardID sid, int pausetime)
      * step 3: start remove index items and recycle storage space
      */
     StartTransactionCommand();
-    eid = RelOidGetShardScanHead(reloid, sid);
-    
-    while(ExtentIdIsValid(eid))
+    for(i = 0; i < nsids; i++)
     {
-        int deleted_tuples = 0;
+        eid = RelOidGetShardScanHead(reloid, sids[i]);
+    
+        while(ExtentIdIsValid(eid))
+        {
+            int deleted_tuples = 0;
 
-        rel = heap_open(reloid, RowExclusiveLock);
-        /*
-         * delete this extent's tuples and their index entries
-         */
-        truncate_extent_tuples(rel, 
-                                eid * PAGES_PER_EXTENTS, 
-                                (eid+1) * PAGES_PER_EXTENTS, 
-                                false, 
-                                &deleted_tuples);
-        tuples += deleted_tuples;
+            rel = heap_open(reloid, RowExclusiveLock);
+            /*
+             * delete this extent's tuples and their index entries
+             */
+            truncate_extent_tuples(rel, 
+                                    eid * PAGES_PER_EXTENTS, 
+                                    (eid+1) * PAGES_PER_EXTENTS, 
+                                    false, 
+                                    &deleted_tuples);
+            tuples += deleted_tuples;
 
-        /*
-         * end transaction 
-         */
-        heap_close(rel, RowExclusiveLock);
-        rel = NULL;
-        CommitTransactionCommand();
+            /*
+             * end transaction 
+             */
+            heap_close(rel, RowExclusiveLock);
+            rel = NULL;
+            CommitTransactionCommand();
 
-        /*
-         * start another transaction
-         */
-        StartTransactionCommand();
+            /*
+             * start another transaction
+             */
+            StartTransactionCommand();
 
-        rel = heap_open(reloid, AccessExclusiveLock);
+            rel = heap_open(reloid, AccessExclusiveLock);
 
-        RelationOpenSmgr(rel);
+            RelationOpenSmgr(rel);
 #ifndef DISABLE_FALLOCATE
-        log_smgrdealloc(&rel->rd_node, eid, SMGR_DEALLOC_FREESTORAGE);
-        smgrdealloc(rel->rd_smgr, MAIN_FORKNUM, eid * PAGES_PER_EXTENTS);
-        if(trace_extent)
-        {
-            ereport(LOG,
-                (errmsg("[trace extent]Dealloc:[rel:%d/%d/%d]"
-                        "[eid:%d, flags=FREESTORAGE]",
-                        rel->rd_node.dbNode, rel->rd_node.spcNode, rel->rd_node.relNode,
-                        eid)));
-        }
+            log_smgrdealloc(&rel->rd_node, eid, SMGR_DEALLOC_FREESTORAGE);
+            smgrdealloc(rel->rd_smgr, MAIN_FORKNUM, eid * PAGES_PER_EXTENTS);
+            if(trace_extent)
+            {
+                ereport(LOG,
+                    (errmsg("[trace extent]Dealloc:[rel:%d/%d/%d]"
+                            "[eid:%d, flags=FREESTORAGE]",
+                            rel->rd_node.dbNode, rel->rd_node.spcNode, rel->rd_node.relNode,
+                            eid)));
+            }
 #else
-        log_smgrdealloc(&rel->rd_node, eid, SMGR_DEALLOC_REINIT);
-        reinit_extent_pages(rel, eid);
+            log_smgrdealloc(&rel->rd_node, eid, SMGR_DEALLOC_REINIT);
+            reinit_extent_pages(rel, eid);
 
-        if(trace_extent)
-        {
-            ereport(LOG,
-                (errmsg("[trace extent]Dealloc:[rel:%d/%d/%d]"
-                        "[eid:%d, flags=REINIT_PAGE]",
-                        rel->rd_node.dbNode, rel->rd_node.spcNode, rel->rd_node.relNode,
-                        eid)));
-        }
+            if(trace_extent)
+            {
+                ereport(LOG,
+                    (errmsg("[trace extent]Dealloc:[rel:%d/%d/%d]"
+                            "[eid:%d, flags=REINIT_PAGE]",
+                            rel->rd_node.dbNode, rel->rd_node.spcNode, rel->rd_node.relNode,
+                            eid)));
+            }
 #endif        
-        /* 
-         * detach extent
-         */
-        FreeExtent(rel, eid);
-        heap_close(rel, AccessExclusiveLock);
-        rel = NULL;
-        
-        eid = RelOidGetShardScanHead(reloid, sid);
+            /* 
+             * detach extent
+             */
+            FreeExtent(rel, eid);
+            heap_close(rel, AccessExclusiveLock);
+            rel = NULL;
+            
+            eid = RelOidGetShardScanHead(reloid, sids[i]);
 
-        if(ExtentIdIsValid(eid) && pausetime > 0)
-            pg_usleep(pausetime);
+            if(ExtentIdIsValid(eid) && pausetime > 0)
+                pg_usleep(pausetime);
+        }
     }
     CommitTransactionCommand();
 
@@ -2326,23 +2553,51 @@ TruncateShard(Oid reloid, ShardID sid, int pausetime)
      */
 #ifndef DISABLE_FALLOCATE
     rel = heap_open(reloid, AccessShareLock);    
-    DropRelfileNodeShardBuffers(rel->rd_node, sid);
+    for(i = 0; i < nsids; i++)
+        DropRelfileNodeShardBuffers(rel->rd_node, sids[i]);
     heap_close(rel, AccessShareLock);
 #endif
 
     /*
-     * step 5: release barrier
+     * step 5: release barriers
      */
     RemoveShardBarrier();
     CommitTransactionCommand();
     
     if(OidIsValid(toastoid))
     {
-        TruncateShard(toastoid, sid, pausetime);
+        tuples += TruncateShardBatch(toastoid, sids, nsids, pausetime);
     }
     
     return tuples;
 }
+
+/*
+ * Truncate the given shards of a relation, TRUNCATE_SHARD_BATCH shards at a
+ * time so that one backend never holds too much of the shared barrier table.
+ */
+int
+TruncateShards(Oid reloid, ShardID *sids, int nsids, int pausetime)
+{
+    int tuples = 0;
+    int i;
+
+    for(i = 0; i < nsids; i += TRUNCATE_SHARD_BATCH)
+    {
+        tuples += TruncateShardBatch(reloid, sids + i,
+                                     Min(nsids - i, TRUNCATE_SHARD_BATCH),
+                                     pausetime);
+    }
+
+    return tuples;
+}
+
+int
+TruncateShard(Oid reloid, ShardID sid, int pausetime)
+{
+    return TruncateShards(reloid, &sid, 1, pausetime);
+}
+
 void StatShardRelation(Oid relid, ShardStat *shardstat, int32 shardnumber)
 {
     int32        shardid;
@@ -3404,6 +3659,132 @@ pg_stat_node_access(PG_FUNCTION_ARGS)
     }    
 }
 
+typedef struct
+{
+    int32                index;
+    int32                count;
+    Oid                 *partoids;
+    int32               *partidx;
+}ColdPartitionInfo;
+
+/*
+ * List the interval partitions of a cold/hot table lying wholly before the hot
+ * data boundary. Hot group nodes never scan them again (see PruneHotData), so
+ * they are the ones a migration job moves to the cold group and then drops
+ * from the hot group.
+ */
+Datum  
+pg_get_cold_partitions(PG_FUNCTION_ARGS)
+{// #lizard forgives
+#define COLD_PARTITION_ATTR_NUM  2
+    FuncCallContext         *funcctx;
+    ColdPartitionInfo       *pInfo;
+    HeapTuple                tuple;        
+
+    Datum        values[COLD_PARTITION_ATTR_NUM];
+    bool        nulls[COLD_PARTITION_ATTR_NUM];
+
+    if (SRF_IS_FIRSTCALL())
+    {
+        MemoryContext oldcontext;
+        TupleDesc    tupdesc;
+        Oid          relid = PG_GETARG_OID(0);
+        Relation     rel;
+        int32        i;
+        int32        indexnow;
+        Form_pg_partition_interval routerinfo;
+        RelationLocInfo           *locinfo;
+
+        funcctx = SRF_FIRSTCALL_INIT();
+
+        oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+        tupdesc = CreateTemplateTupleDesc(COLD_PARTITION_ATTR_NUM, false);
+        TupleDescInitEntry(tupdesc, (AttrNumber) 1, "partition",
+                           REGCLASSOID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber) 2, "partition_index",
+                           INT4OID, -1, 0);
+        funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+        funcctx->user_fctx = palloc0(sizeof(ColdPartitionInfo));
+        pInfo = (ColdPartitionInfo*)funcctx->user_fctx;
+
+        rel = relation_open(relid, AccessShareLock);
+        if (!RELATION_IS_INTERVAL(rel))
+        {
+            ereport(ERROR,
+                    (errcode(ERRCODE_WRONG_OBJECT_TYPE),
+                     errmsg("\"%s\" is not an interval partitioned table",
+                            RelationGetRelationName(rel))));
+        }
+
+        routerinfo = rel->rd_partitions_info;
+        locinfo    = rel->rd_locator_info;
+
+        /* only tables routed by their partition key have cold partitions */
+        if (routerinfo && locinfo &&
+            AttributeNumberIsValid(locinfo->secAttrNum) &&
+            locinfo->secAttrNum == routerinfo->partpartkey &&
+            (routerinfo->partinterval_type == IntervalType_Day ||
+             routerinfo->partinterval_type == IntervalType_Month))
+        {
+            indexnow = GetPartitionIndex(routerinfo->partstartvalue_ts,
+                                         routerinfo->partinterval_int,
+                                         routerinfo->partinterval_type,
+                                         routerinfo->partnparts,
+                                         GetManualHotDataTimestamp());
+            indexnow = Min(indexnow, routerinfo->partnparts);
+
+            if (indexnow > 0)
+            {
+                pInfo->partoids = palloc(sizeof(Oid) * indexnow);
+                pInfo->partidx  = palloc(sizeof(int32) * indexnow);
+            }
+
+            for (i = 0; i < indexnow; i++)
+            {
+                char *partname = GetPartitionName(relid, i, false);
+                Oid   partoid  = get_relname_relid(partname, RelationGetNamespace(rel));
+
+                pfree(partname);
+
+                /* dropped partition */
+                if (!OidIsValid(partoid))
+                {
+                    continue;
+                }
+
+                pInfo->partoids[pInfo->count] = partoid;
+                pInfo->partidx[pInfo->count]  = i;
+                pInfo->count++;
+            }
+        }
+        relation_close(rel, NoLock);
+
+        MemoryContextSwitchTo(oldcontext);
+    }
+    
+    /* stuff done on every call of the function */
+    funcctx = SRF_PERCALL_SETUP();
+    pInfo = (ColdPartitionInfo*)funcctx->user_fctx; 
+    if (pInfo->index < pInfo->count)
+    {
+        MemSet(values, 0, sizeof(values));
+        MemSet(nulls, 0, sizeof(nulls));
+
+        values[0] = ObjectIdGetDatum(pInfo->partoids[pInfo->index]);
+        values[1] = Int32GetDatum(pInfo->partidx[pInfo->index]);
+        tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+        pInfo->index++;
+        SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));     
+    }
+    else
+    {
+        /* nothing left */
+        SRF_RETURN_DONE(funcctx);
+    }    
+}
+
 
 /*
  * Estimate space needed for shard statistic hashtable 
@@ -3414,9 +3795,10 @@ ShardStatisticShmemSize(void)
     Size space = 0;
     int nelems = MAX_SHARDS;
     int npools = (MaxBackends / g_MaxSessionsPerPool) + 1;
-    Size pool_size = mul_size(nelems, sizeof(ShardStatistic));
+    Size pool_size = mul_size(nelems, sizeof(ShardStatisticPadded));
 
     space = mul_size(npools, pool_size);
+    space = add_size(space, mul_size(nelems, sizeof(ShardIOStatisticPadded)));
     
     return space;
 }
@@ -3430,10 +3812,10 @@ ShardStatisticShmemInit(void)
     bool found;
     int nelems = MAX_SHARDS;
     int npools = (MaxBackends / g_MaxSessionsPerPool) + 1;
-    Size pool_size = mul_size(nelems, sizeof(ShardStatistic));
+    Size pool_size = mul_size(nelems, sizeof(ShardStatisticPadded));
 
     
-    shardStatInfo = (ShardStatistic *)
+    shardStatInfo = (ShardStatisticPadded *)
         ShmemInitStruct("Shard Statistic Info",
                         mul_size(npools, pool_size),
                         &found);
@@ -3446,77 +3828,202 @@ ShardStatisticShmemInit(void)
 
         for (i = 0; i < max_elems; i++)
         {
-            pg_atomic_init_u64(&shardStatInfo[i].ntuples_select, 0);
-            pg_atomic_init_u64(&shardStatInfo[i].ntuples_insert, 0);
-            pg_atomic_init_u64(&shardStatInfo[i].ntuples_update, 0);
-            pg_atomic_init_u64(&shardStatInfo[i].ntuples_delete, 0);
-            pg_atomic_init_u64(&shardStatInfo[i].ntuples, 0);
-            pg_atomic_init_u64(&shardStatInfo[i].size, 0);
+            pg_atomic_init_u64(&shardStatInfo[i].stat.ntuples_select, 0);
+            pg_atomic_init_u64(&shardStatInfo[i].stat.ntuples_insert, 0);
+            pg_atomic_init_u64(&shardStatInfo[i].stat.ntuples_update, 0);
+            pg_atomic_init_u64(&shardStatInfo[i].stat.ntuples_delete, 0);
+            pg_atomic_init_u64(&shardStatInfo[i].stat.ntuples, 0);
+            pg_atomic_init_u64(&shardStatInfo[i].stat.size, 0);
+        }
+    }
+
+    shardIOStatInfo = (ShardIOStatisticPadded *)
+        ShmemInitStruct("Shard IO Statistic Info",
+                        mul_size(nelems, sizeof(ShardIOStatisticPadded)),
+                        &found);
+
+    if (!found)
+    {
+        int i = 0;
+
+        for (i = 0; i < nelems; i++)
+        {
+            pg_atomic_init_u64(&shardIOStatInfo[i].stat.blks_read, 0);
+            pg_atomic_init_u64(&shardIOStatInfo[i].stat.blks_hit, 0);
+            pg_atomic_init_u64(&shardIOStatInfo[i].stat.blks_written, 0);
         }
     }
 }
 
+/*
+ * Push the buffer hits summed in backend local memory to shared memory.
+ */
+static void
+FlushPendingShardHits(void)
+{
+    int i;
+
+    for (i = 0; i < npendingShardHitList; i++)
+    {
+        ShardID sid = pendingShardHitList[i];
+
+        pg_atomic_fetch_add_u64(&shardIOStatInfo[sid].stat.blks_hit,
+                                pendingShardHits[sid]);
+        pendingShardHits[sid] = 0;
+    }
+
+    npendingShardHitList = 0;
+    npendingShardHits = 0;
+}
+
 
 /*
- * update shard statistic info by each backend which do select/insert/update/delete.
+ * Push the locally summed counters of the last touched shard to shared memory.
  */
 void
-UpdateShardStatistic(CmdType cmd, ShardID sid, int64 new_size, int64 old_size)
+FlushPendingShardStatistic(void)
 {
-    int index = 0;
+    PendingShardStatistic *pending = &pendingShardStat;
+    ShardStatistic *stat;
     int nelems = MAX_SHARDS;
     int npools = (MaxBackends / g_MaxSessionsPerPool) + 1;
 
+    if (npendingShardHitList > 0)
+        FlushPendingShardHits();
+
+    if (pending->nupdates == 0)
+        return;
+
+    stat = &shardStatInfo[(MyProc->pgprocno % npools) * nelems + pending->sid].stat;
+
+    if (pending->ntuples_select)
+        pg_atomic_fetch_add_u64(&stat->ntuples_select, pending->ntuples_select);
+    if (pending->ntuples_insert)
+        pg_atomic_fetch_add_u64(&stat->ntuples_insert, pending->ntuples_insert);
+    if (pending->ntuples_update)
+        pg_atomic_fetch_add_u64(&stat->ntuples_update, pending->ntuples_update);
+    if (pending->ntuples_delete)
+        pg_atomic_fetch_add_u64(&stat->ntuples_delete, pending->ntuples_delete);
+
+    if (pending->ntuples > 0)
+        pg_atomic_fetch_add_u64(&stat->ntuples, pending->ntuples);
+    else if (pending->ntuples < 0)
+        pg_atomic_fetch_sub_u64(&stat->ntuples, -pending->ntuples);
+
+    if (pending->size > 0)
+        pg_atomic_fetch_add_u64(&stat->size, pending->size);
+    else if (pending->size < 0)
+        pg_atomic_fetch_sub_u64(&stat->size, -pending->size);
+
+    MemSet(pending, 0, sizeof(PendingShardStatistic));
+    pending->sid = InvalidShardID;
+}
+
+static void
+FlushPendingShardStatisticOnExit(int code, Datum arg)
+{
+    FlushPendingShardStatistic();
+}
+
+/*
+ * update shard statistic info by each backend which do select/insert/update/delete.
+ *
+ * Counters are summed locally while the same shard keeps being touched, and
+ * pushed to shared memory when another shard comes up, after a batch of
+ * updates, when the backend goes idle, or when it exits.
+ */
+void
+UpdateShardStatistic(CmdType cmd, ShardID sid, int64 new_size, int64 old_size)
+{
+    PendingShardStatistic *pending = &pendingShardStat;
+
     if (!ShardIDIsValid(sid))
         return;
 
-    index = (MyProc->pgprocno % npools) * nelems + sid;
-    
+    if (!pendingShardStatRegistered)
+    {
+        before_shmem_exit(FlushPendingShardStatisticOnExit, 0);
+        pendingShardStatRegistered = true;
+    }
+
+    if (pending->sid != sid)
+    {
+        FlushPendingShardStatistic();
+        pending->sid = sid;
+    }
+
     switch(cmd)
     {
         case CMD_SELECT:
             {
-                pg_atomic_fetch_add_u64(&shardStatInfo[index].ntuples_select, 1);
+                pending->ntuples_select++;
             }
             break;
         case CMD_UPDATE:
             {
-                pg_atomic_fetch_add_u64(&shardStatInfo[index].ntuples_update, 1);
-
-                if (new_size > old_size)
-                {
-                    int64 size = new_size - old_size;
+                pending->ntuples_update++;
 
-                    pg_atomic_fetch_add_u64(&shardStatInfo[index].size, size);
-                }
-                else if (new_size < old_size)
-                {
-                    int64 size = old_size - new_size;
-
-                    pg_atomic_fetch_sub_u64(&shardStatInfo[index].size, size);
-                }
+                pending->size += new_size - old_size;
             }
             break;
         case CMD_INSERT:
             {
-                pg_atomic_fetch_add_u64(&shardStatInfo[index].ntuples_insert, 1);
+                pending->ntuples_insert++;
 
-                pg_atomic_fetch_add_u64(&shardStatInfo[index].ntuples, 1);
+                pending->ntuples++;
 
-                pg_atomic_fetch_add_u64(&shardStatInfo[index].size, new_size);
+                pending->size += new_size;
             }
             break;
         case CMD_DELETE:
             {
-                pg_atomic_fetch_add_u64(&shardStatInfo[index].ntuples_delete, 1);
+                pending->ntuples_delete++;
 
-                pg_atomic_fetch_sub_u64(&shardStatInfo[index].ntuples, 1);
+                pending->ntuples--;
 
-                pg_atomic_fetch_sub_u64(&shardStatInfo[index].size, old_size);
+                pending->size -= old_size;
             }
             break;
         default:
             elog(LOG, "Unsupported CmdType %d in UpdateShardStatistic", cmd);
+            return;
+    }
+
+    if (++pending->nupdates >= SHARD_STAT_BATCH_SIZE)
+        FlushPendingShardStatistic();
+}
+
+/*
+ * Count a buffer access to a page of the given shard. Called by the buffer
+ * manager for main fork pages, so it must not allocate or throw.
+ */
+void
+CountShardBufferAccess(ShardID sid, ShardBufferAccess access)
+{
+    if (!g_StatShardInfo || !IS_PGXC_DATANODE || !ShardIDIsValid(sid) ||
+        shardIOStatInfo == NULL)
+        return;
+
+    switch (access)
+    {
+        case SHARD_BUFFER_HIT:
+            if (!pendingShardStatRegistered)
+            {
+                before_shmem_exit(FlushPendingShardStatisticOnExit, 0);
+                pendingShardStatRegistered = true;
+            }
+
+            if (pendingShardHits[sid]++ == 0)
+                pendingShardHitList[npendingShardHitList++] = sid;
+
+            if (++npendingShardHits >= SHARD_IO_HIT_BATCH_SIZE)
+                FlushPendingShardHits();
+            break;
+        case SHARD_BUFFER_READ:
+            pg_atomic_fetch_add_u64(&shardIOStatInfo[sid].stat.blks_read, 1);
+            break;
+        case SHARD_BUFFER_WRITE:
+            pg_atomic_fetch_add_u64(&shardIOStatInfo[sid].stat.blks_written, 1);
             break;
     }
 }
@@ -3583,7 +4090,7 @@ FlushShardStatistic(void)
         {
             int index = i * nelems + j;
 
-            FetchAddShardStatistic(&rec[j].stat, &shardStatInfo[index]);
+            FetchAddShardStatistic(&rec[j].stat, &shardStatInfo[index].stat);
         }
     }
 
@@ -3652,7 +4159,7 @@ RecoverShardStatistic(void)
 
             if (crc == rec[i].crc)
             {
-                FetchAddShardStatistic(&shardStatInfo[i], &rec[i].stat);
+                FetchAddShardStatistic(&shardStatInfo[i].stat, &rec[i].stat);
             }
             else
             {
@@ -3680,9 +4187,9 @@ RefreshShardStatistic(ShardStat *shardstat)
     {
         if (shardstat[i].count)
         {
-            pg_atomic_fetch_add_u64(&shardStatInfo[i].ntuples, shardstat[i].count);
+            pg_atomic_fetch_add_u64(&shardStatInfo[i].stat.ntuples, shardstat[i].count);
 
-            pg_atomic_fetch_add_u64(&shardStatInfo[i].size, shardstat[i].size);
+            pg_atomic_fetch_add_u64(&shardStatInfo[i].stat.size, shardstat[i].size);
         }
     }
 }
@@ -3700,8 +4207,8 @@ ResetShardStatistic(void)
         {
             int index = j * nelems + i;
 
-            pg_atomic_init_u64(&shardStatInfo[index].ntuples, 0);
-            pg_atomic_init_u64(&shardStatInfo[index].size, 0);
+            pg_atomic_init_u64(&shardStatInfo[index].stat.ntuples, 0);
+            pg_atomic_init_u64(&shardStatInfo[index].stat.size, 0);
         }
     }
 }
@@ -3757,6 +4264,9 @@ tbase_shard_statistic(PG_FUNCTION_ARGS)
         status->currIdx = 0;
         rec = (ShardStatistic *)palloc(size);
 
+        /* make our own pending counts visible */
+        FlushPendingShardStatistic();
+
         for (i = 0; i < nelems; i++)
         {
             InitShardStatistic(&rec[i]);
@@ -3775,7 +4285,7 @@ tbase_shard_statistic(PG_FUNCTION_ARGS)
                                    
                     int index = i * nelems + j;
 
-                    FetchAddShardStatistic(&rec[j], &shardStatInfo[index]);
+                    FetchAddShardStatistic(&rec[j], &shardStatInfo[index].stat);
                 }
             }
         }
@@ -3831,6 +4341,304 @@ tbase_shard_statistic(PG_FUNCTION_ARGS)
     SRF_RETURN_DONE(funcctx);
 }
 
+/* display buffer reads, hits and writes per shard */
+Datum
+tbase_shard_io_statistic(PG_FUNCTION_ARGS)
+{
+#define NIOCOLUMNS 5
+    FuncCallContext *funcctx;
+    ShardIOStat_State *status;
+
+    if (SRF_IS_FIRSTCALL())
+    {
+        MemoryContext oldcontext;
+        TupleDesc     tupdesc;
+        int           i;
+
+        funcctx = SRF_FIRSTCALL_INIT();
+
+        oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+        tupdesc = CreateTemplateTupleDesc(NIOCOLUMNS, false);
+        TupleDescInitEntry(tupdesc, (AttrNumber) 1, "node_name",
+                           TEXTOID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber) 2, "shard_id",
+                           INT4OID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber) 3, "blks_read",
+                           INT8OID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber) 4, "blks_hit",
+                           INT8OID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber) 5, "blks_written",
+                           INT8OID, -1, 0);
+
+        funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+        status = (ShardIOStat_State *) palloc(sizeof(ShardIOStat_State));
+        status->currIdx = 0;
+        status->rec = (uint64 (*)[3]) palloc(sizeof(uint64) * 3 * MAX_SHARDS);
+        funcctx->user_fctx = (void *) status;
+
+        /* make our own pending hits visible */
+        FlushPendingShardStatistic();
+
+        for (i = 0; i < MAX_SHARDS; i++)
+        {
+            status->rec[i][0] = pg_atomic_read_u64(&shardIOStatInfo[i].stat.blks_read);
+            status->rec[i][1] = pg_atomic_read_u64(&shardIOStatInfo[i].stat.blks_hit);
+            status->rec[i][2] = pg_atomic_read_u64(&shardIOStatInfo[i].stat.blks_written);
+        }
+
+        MemoryContextSwitchTo(oldcontext);
+    }
+
+    funcctx = SRF_PERCALL_SETUP();
+    status  = (ShardIOStat_State *) funcctx->user_fctx;
+
+    while (status->currIdx < MAX_SHARDS)
+    {
+        Datum       values[NIOCOLUMNS];
+        bool        nulls[NIOCOLUMNS];
+        HeapTuple   tuple;
+        uint64     *rec = status->rec[status->currIdx];
+
+        if (rec[0] == 0 && rec[1] == 0 && rec[2] == 0)
+        {
+            status->currIdx++;
+            continue;
+        }
+
+        MemSet(nulls, 0, sizeof(nulls));
+        values[0] = CStringGetTextDatum(PGXCNodeName);
+        values[1] = Int32GetDatum(status->currIdx);
+        values[2] = Int64GetDatum(rec[0]);
+        values[3] = Int64GetDatum(rec[1]);
+        values[4] = Int64GetDatum(rec[2]);
+
+        status->currIdx++;
+
+        tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+        SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+    }
+
+    SRF_RETURN_DONE(funcctx);
+}
+
+/*
+ * Compute the shard group moves that spread the load of a node group evenly
+ * over its datanodes, typically after new, empty datanodes joined it or when
+ * a few hot shard groups overload one node.
+ *
+ * Without loads every shard group weighs the same and the group ends up with
+ * the same number on each node. With loads, e.g. rows or blocks per shard
+ * group collected from tbase_shard_statistic() on the datanodes, the plan
+ * balances their sum; shard groups without a load count as idle.
+ *
+ * We repeatedly move a shard group from the most to the least loaded node,
+ * picking the one closest to half their difference, as long as that narrows
+ * the gap. Each row can then be carried out with MOVE DATA.
+ */
+Datum
+tbase_shard_rebalance_plan(PG_FUNCTION_ARGS)
+{
+#define NREBALANCECOLUMNS 3
+    FuncCallContext *funcctx;
+    ShardRebalance_State *status;
+
+    if (SRF_IS_FIRSTCALL())
+    {
+        MemoryContext oldcontext;
+        TupleDesc    tupdesc;
+        char        *group_name = text_to_cstring(PG_GETARG_TEXT_PP(0));
+        Oid            group;
+        Oid           *dnoids = NULL;
+        int            ndns;
+        int            total = 0;
+        int32       *shardids;
+        int           *owner;
+        double       *weight;
+        double       *nodeload;
+        int            maxmoves;
+        int            i;
+        Relation    shardmapRel;
+        ScanKeyData skey;
+        SysScanDesc scan;
+        HeapTuple    tuple;
+
+        funcctx = SRF_FIRSTCALL_INIT();
+        oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+        tupdesc = CreateTemplateTupleDesc(NREBALANCECOLUMNS, false);
+        TupleDescInitEntry(tupdesc, (AttrNumber) 1, "shardgroupid",
+                           INT4OID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber) 2, "from_node",
+                           TEXTOID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber) 3, "to_node",
+                           TEXTOID, -1, 0);
+        funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+        group = get_pgxc_groupoid(group_name);
+        if (!OidIsValid(group))
+            elog(ERROR, "group with name:%s not found", group_name);
+
+        ndns = get_pgxc_groupmembers(group, &dnoids);
+        if (ndns <= 0)
+            elog(ERROR, "group %s has no datanode", group_name);
+
+        /* shard groups of the group and the member owning each */
+        shardids = (int32 *) palloc(MAX_SHARDS * sizeof(int32));
+        owner = (int *) palloc(MAX_SHARDS * sizeof(int));
+
+        shardmapRel = heap_open(PgxcShardMapRelationId, AccessShareLock);
+        ScanKeyInit(&skey,
+                    Anum_pgxc_shard_map_nodegroup,
+                    BTEqualStrategyNumber, F_OIDEQ,
+                    ObjectIdGetDatum(group));
+        scan = systable_beginscan(shardmapRel,
+                                  PgxcShardMapGroupIndexId, true,
+                                  NULL, 1, &skey);
+        while (HeapTupleIsValid(tuple = systable_getnext(scan)) &&
+               total < MAX_SHARDS)
+        {
+            Form_pgxc_shard_map pgxc_shard = (Form_pgxc_shard_map) GETSTRUCT(tuple);
+
+            for (i = 0; i < ndns; i++)
+            {
+                if (dnoids[i] == pgxc_shard->primarycopy)
+                {
+                    shardids[total] = pgxc_shard->shardgroupid;
+                    owner[total] = i;
+                    total++;
+                    break;
+                }
+            }
+        }
+        systable_endscan(scan);
+        heap_close(shardmapRel, AccessShareLock);
+
+        weight = (double *) palloc(Max(total, 1) * sizeof(double));
+        for (i = 0; i < total; i++)
+            weight[i] = (PG_NARGS() > 1) ? 0 : 1;
+
+        if (PG_NARGS() > 1)
+        {
+            ArrayType  *idarr;
+            ArrayType  *loadarr;
+            Datum       *ids;
+            Datum       *loads;
+            bool       *idnulls;
+            bool       *loadnulls;
+            int            nids;
+            int            nloads;
+            int            j;
+
+            if (PG_ARGISNULL(1) || PG_ARGISNULL(2))
+                elog(ERROR, "shard group ids and loads must not be null");
+
+            idarr = PG_GETARG_ARRAYTYPE_P(1);
+            loadarr = PG_GETARG_ARRAYTYPE_P(2);
+            deconstruct_array(idarr, INT4OID, sizeof(int32), true, 'i',
+                              &ids, &idnulls, &nids);
+            deconstruct_array(loadarr, FLOAT8OID, sizeof(float8), FLOAT8PASSBYVAL, 'd',
+                              &loads, &loadnulls, &nloads);
+            if (nids != nloads)
+                elog(ERROR, "got %d shard group ids but %d loads", nids, nloads);
+
+            for (j = 0; j < nids; j++)
+            {
+                if (idnulls[j] || loadnulls[j])
+                    continue;
+                if (DatumGetFloat8(loads[j]) < 0)
+                    elog(ERROR, "load of shard group %d must not be negative",
+                         DatumGetInt32(ids[j]));
+
+                for (i = 0; i < total; i++)
+                {
+                    if (shardids[i] == DatumGetInt32(ids[j]))
+                    {
+                        weight[i] += DatumGetFloat8(loads[j]);
+                        break;
+                    }
+                }
+            }
+        }
+
+        nodeload = (double *) palloc0(ndns * sizeof(double));
+        for (i = 0; i < total; i++)
+            nodeload[owner[i]] += weight[i];
+
+        status = (ShardRebalance_State *) palloc0(sizeof(ShardRebalance_State));
+        maxmoves = Max(total, 1);
+        status->shardgroup = (int32 *) palloc(maxmoves * sizeof(int32));
+        status->fromnode = (Oid *) palloc(maxmoves * sizeof(Oid));
+        status->tonode = (Oid *) palloc(maxmoves * sizeof(Oid));
+
+        /*
+         * Every move shrinks the sum of squared node loads, so this ends; a
+         * shard group is moved at most once to keep the plan short.
+         */
+        while (status->nmoves < maxmoves)
+        {
+            int        hi = 0;
+            int        lo = 0;
+            int        best = -1;
+            double    gap;
+
+            for (i = 1; i < ndns; i++)
+            {
+                if (nodeload[i] > nodeload[hi])
+                    hi = i;
+                if (nodeload[i] < nodeload[lo])
+                    lo = i;
+            }
+            gap = nodeload[hi] - nodeload[lo];
+
+            for (i = 0; i < total; i++)
+            {
+                if (owner[i] != hi || weight[i] <= 0 || weight[i] >= gap)
+                    continue;
+                if (best < 0 ||
+                    fabs(weight[i] - gap / 2) < fabs(weight[best] - gap / 2))
+                    best = i;
+            }
+            if (best < 0)
+                break;
+
+            owner[best] = -1;    /* moved already */
+            nodeload[hi] -= weight[best];
+            nodeload[lo] += weight[best];
+
+            status->shardgroup[status->nmoves] = shardids[best];
+            status->fromnode[status->nmoves] = dnoids[hi];
+            status->tonode[status->nmoves] = dnoids[lo];
+            status->nmoves++;
+        }
+
+        funcctx->user_fctx = (void *) status;
+        MemoryContextSwitchTo(oldcontext);
+    }
+
+    funcctx = SRF_PERCALL_SETUP();
+    status = (ShardRebalance_State *) funcctx->user_fctx;
+
+    if (status->currIdx < status->nmoves)
+    {
+        Datum        values[NREBALANCECOLUMNS];
+        bool        nulls[NREBALANCECOLUMNS];
+        HeapTuple    tuple;
+        int            idx = status->currIdx++;
+
+        MemSet(nulls, 0, sizeof(nulls));
+        values[0] = Int32GetDatum(status->shardgroup[idx]);
+        values[1] = CStringGetTextDatum(get_pgxc_nodename(status->fromnode[idx]));
+        values[2] = CStringGetTextDatum(get_pgxc_nodename(status->tonode[idx]));
+
+        tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+        SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+    }
+
+    SRF_RETURN_DONE(funcctx);
+}
+
 #ifdef __COLD_HOT__
 static void LoadAccessControlInfo(void)
 {    
@@ -4585,6 +5393,34 @@ static bool IsTempColdData(Datum secValue, RelationAccessType access, int32 inte
 }
 
 
+/*
+ * Timestamp of the hot data boundary. It only moves when manual_hot_date or
+ * cold_hot_sepration_mode are reassigned, so remember the conversion of the
+ * last boundary seen instead of redoing it for every routing decision.
+ */
+static Timestamp
+GetManualHotDataTimestamp(void)
+{
+    static struct pg_tm cached_tm;
+    static Timestamp    cached_stamp = 0;
+    static bool         cached_valid = false;
+
+    if (!cached_valid || memcmp(&cached_tm, &g_ManualHotDataTime, sizeof(struct pg_tm)) != 0)
+    {
+        cached_valid = false;
+        if (tm2timestamp(&g_ManualHotDataTime, 0, NULL, &cached_stamp) != 0)
+        {
+            ereport(ERROR,
+                (errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
+                 errmsg("timestamp out of range")));
+        }
+        memcpy(&cached_tm, &g_ManualHotDataTime, sizeof(struct pg_tm));
+        cached_valid = true;
+    }
+
+    return cached_stamp;
+}
+
 /*
  * Data is hot or not
  */
@@ -4616,12 +5452,7 @@ bool IsHotData(Datum secValue, RelationAccessType access, int32 interval,
 
     return gap < GetHotDataGap(interval);
 #endif
-    if (tm2timestamp(&g_ManualHotDataTime, 0, NULL, &hotDataTime) != 0)
-    {
-        ereport(ERROR,
-            (errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
-             errmsg("timestamp out of range")));
-    }
+    hotDataTime = GetManualHotDataTimestamp();
 
 	if (enable_cold_hot_router_print)
 	{
@@ -4687,9 +5518,9 @@ List* ShardMapRouter(Oid group, Oid coldgroup, Oid relation, Oid type, Datum dva
 	router_log_print = (enable_cold_hot_router_print && accessType == RELATION_ACCESS_INSERT &&
 						(RELATION_IS_INTERVAL(rel) || RELATION_IS_CHILD(rel)));
 
-    if (g_EnableKeyValue)
+    /* temporary key values are only known by their text */
+    if (g_EnableKeyValue && g_TempKeyValueList != NIL)
     {
-        /* check whether the value is key value */
         get_type_io_data(type, IOFunc_output,
                          &typlen, &typbyval,
                          &typalign, &typdelim,
@@ -4705,7 +5536,13 @@ List* ShardMapRouter(Oid group, Oid coldgroup, Oid relation, Oid type, Datum dva
             bdualwrite = NeedDualWrite(relation, secAttr, secValue);
             if (bdualwrite)
             {
-                elog(LOG, "distribute key:%s timestamp:%s need dual write", value, timestamptz_to_str((TimestampTz) secValue));
+                get_type_io_data(type, IOFunc_output,
+                                 &typlen, &typbyval,
+                                 &typalign, &typdelim,
+                                 &typioparam, &typiofunc);
+                elog(LOG, "distribute key:%s timestamp:%s need dual write",
+                     OidOutputFunctionCall(typiofunc, dvalue),
+                     timestamptz_to_str((TimestampTz) secValue));
             }
         }
     }
@@ -4756,12 +5593,15 @@ List* ShardMapRouter(Oid group, Oid coldgroup, Oid relation, Oid type, Datum dva
 
     if (g_EnableKeyValue)
     {    
-        if (!InTempKeyValueList(relation, value, &keyValueGroup, &secColdGroup))
+        if (value == NULL || !InTempKeyValueList(relation, value, &keyValueGroup, &secColdGroup))
         {
-            keyValueGroup = GetKeyValuesGroup(MyDatabaseId, relation, value, &secColdGroup);
+            keyValueGroup = GetKeyValuesGroupByDatum(relation, type, dvalue, &secColdGroup);
+        }
+        if (value)
+        {
+            pfree(value);
+            value = NULL;
         }
-        pfree(value);
-        value = NULL;
     }
     
     if (InvalidOid == keyValueGroup)
@@ -5003,12 +5843,6 @@ void PruneHotData(Oid relation, Bitmapset *children)
     
     if (routerinfo)
     {
-        lock = g_AccessCtl->needlock;
-        if (lock)
-        {
-            LWLockAcquire(ColdAccessLock, LW_SHARED);
-        }        
-        
         if(routerinfo->partinterval_type != IntervalType_Day 
             && routerinfo->partinterval_type != IntervalType_Month)
         {
@@ -5016,12 +5850,13 @@ void PruneHotData(Oid relation, Bitmapset *children)
             return;
         }
 
-        if (tm2timestamp(&g_ManualHotDataTime, 0, NULL, &tmnow) != 0)
+        lock = g_AccessCtl->needlock;
+        if (lock)
         {
-            ereport(ERROR,
-                (errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
-                 errmsg("timestamp out of range")));
-        }
+            LWLockAcquire(ColdAccessLock, LW_SHARED);
+        }        
+
+        tmnow = GetManualHotDataTimestamp();
         
         //tmnow     = GetCurrentTimestamp();    
         /* here we use the MAX_NUM_PARTITIONS to get actual offset of the partition */
@@ -5219,12 +6054,7 @@ ScanNeedExecute(Relation rel)
                     if(routerinfo->partinterval_type == IntervalType_Day ||
                        routerinfo->partinterval_type == IntervalType_Month)
                     {
-                        if (tm2timestamp(&g_ManualHotDataTime, 0, NULL, &tmnow) != 0)
-                        {
-                            ereport(ERROR,
-                                (errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
-                                 errmsg("timestamp out of range")));
-                        }
+                        tmnow = GetManualHotDataTimestamp();
         
                         indexnow = GetPartitionIndex(routerinfo->partstartvalue_ts,
                                                      routerinfo->partinterval_int,
@@ -5432,17 +6262,10 @@ RangeNeedDualWrite(Oid relation, AttrNumber attr, Datum minValue, Datum maxValue
 List* GetShardMapRangeList(Oid group, Oid coldgroup, Oid relation, Oid type, Datum dvalue, AttrNumber secAttr, Oid secType, 
                     Datum minValue, Datum maxValue, bool equalMin, bool equalMax, RelationAccessType accessType)
 {// #lizard forgives    
-    int16         typlen;
-    bool         typbyval;
-    char         typalign;
-    char         typdelim;
-    Oid          typioparam;
-    Oid          typiofunc;
     Oid          keyValueGroup;
     Oid          keyValueColdGroup;
     long         hashvalue;
     int32         i;
-    char         *value;
     List         *list = NULL;
     
     int           hot_num          = 0;
@@ -5505,15 +6328,7 @@ List* GetShardMapRangeList(Oid group, Oid coldgroup, Oid relation, Oid type, Dat
 
     
     /* check whether the value is key value */
-    get_type_io_data(type, IOFunc_output,
-                     &typlen, &typbyval,
-                     &typalign, &typdelim,
-                     &typioparam, &typiofunc);
-    value = OidOutputFunctionCall(typiofunc, dvalue);        
-    
-    keyValueGroup = GetKeyValuesGroup(MyDatabaseId, relation, value, &keyValueColdGroup);
-    pfree(value);
-    value = NULL;
+    keyValueGroup = GetKeyValuesGroupByDatum(relation, type, dvalue, &keyValueColdGroup);
 
     if (g_EnableDualWrite)
     {
@@ -5573,17 +6388,21 @@ List* GetShardMapRangeList(Oid group, Oid coldgroup, Oid relation, Oid type, Dat
         
         /* range value, both cold and hot group */
         if (minValue && maxValue)
-        {            
-            if (IsHotData(minValue, accessType, partitionStrategy, interval_step, start_timestamp) && IsHotData(maxValue, accessType, partitionStrategy, interval_step, start_timestamp))
+        {
+            /* decide each bound once, IsHotData is not free */
+            bool min_hot = IsHotData(minValue, accessType, partitionStrategy, interval_step, start_timestamp);
+            bool max_hot = IsHotData(maxValue, accessType, partitionStrategy, interval_step, start_timestamp);
+
+            if (min_hot && max_hot)
             {                /* all hot data */
                 list = list_make1_int(GetNodeIndexByHashValue(group, hashvalue));                                    
             }
-            else if (!IsHotData(minValue, accessType, partitionStrategy, interval_step, start_timestamp) && !IsHotData(maxValue, accessType, partitionStrategy, interval_step, start_timestamp))
+            else if (!min_hot && !max_hot)
             {
                 /* all cold data */
                 list = list_make1_int(GetNodeIndexByHashValue(coldgroup, hashvalue));
             }
-            else if(!IsHotData(minValue, accessType, partitionStrategy, interval_step, start_timestamp) && IsHotData(maxValue, accessType, partitionStrategy, interval_step, start_timestamp))
+            else if(!min_hot && max_hot)
             {
                 /* range across cold and hot group */
                 list = list_make1_int(GetNodeIndexByHashValue(group, hashvalue));
@@ -5632,7 +6451,11 @@ List* GetShardMapRangeList(Oid group, Oid coldgroup, Oid relation, Oid type, Dat
     hashvalue = compute_hash(type, dvalue, LOCATOR_TYPE_SHARD); 
     if (minValue && maxValue)
     {
-        if (IsHotData(minValue, accessType, partitionStrategy, interval_step, start_timestamp) && IsHotData(maxValue, accessType, partitionStrategy, interval_step, start_timestamp))
+        /* decide each bound once, IsHotData is not free */
+        bool min_hot = IsHotData(minValue, accessType, partitionStrategy, interval_step, start_timestamp);
+        bool max_hot = IsHotData(maxValue, accessType, partitionStrategy, interval_step, start_timestamp);
+
+        if (min_hot && max_hot)
         {    
             /* all hot */    
             GetShardNodes(keyValueGroup, &hot_data_nodes, &hot_num, NULL);
@@ -5643,7 +6466,7 @@ List* GetShardMapRangeList(Oid group, Oid coldgroup, Oid relation, Oid type, Dat
             pfree(hot_data_nodes);
             hot_data_nodes = NULL;                                
         }
-        else if (!IsHotData(minValue, accessType, partitionStrategy, interval_step, start_timestamp) && !IsHotData(maxValue, accessType, partitionStrategy, interval_step, start_timestamp))
+        else if (!min_hot && !max_hot)
         {
             /* all cold */
             GetShardNodes(keyValueColdGroup, &cold_data_nodes, &cold_num, NULL);
@@ -5654,7 +6477,7 @@ List* GetShardMapRangeList(Oid group, Oid coldgroup, Oid relation, Oid type, Dat
             pfree(cold_data_nodes);
             cold_data_nodes = NULL;
         }
-        else if(!IsHotData(minValue, accessType, partitionStrategy, interval_step, start_timestamp) && IsHotData(maxValue, accessType, partitionStrategy, interval_step, start_timestamp))
+        else if(!min_hot && max_hot)
         {
             /* range across cold and hot group */
             /* all hot */    
@@ -26,22 +26,32 @@
 #include "access/gtm.h"
 #include "catalog/pgxc_node.h"
 #include "commands/prepare.h"
+#include "common/pg_lzcompress.h"
 #include "executor/executor.h"
 #include "nodes/pg_list.h"
 #include "pgxc/nodemgr.h"
 #include "pgxc/pgxc.h"
 #include "pgxc/pgxcnode.h"
 #include "pgxc/squeue.h"
+#include "storage/ipc.h"
 #include "storage/latch.h"
 #include "storage/lwlock.h"
+#include "storage/numa.h"
 #include "storage/shmem.h"
+#include "utils/freepage.h"
 #include "utils/hsearch.h"
 #include "utils/resowner.h"
 #include "pgstat.h"
 #ifdef __TBASE__
 #include <pthread.h>
+#include <poll.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
+#if defined(MSG_ZEROCOPY) && defined(SO_ZEROCOPY)
+#include <netinet/in.h>
+#include <linux/errqueue.h>
+#define USE_DATAPUMP_ZEROCOPY 1
+#endif
 #include "storage/spin.h"
 #include "storage/s_lock.h"
 #include "miscadmin.h"
@@ -59,9 +69,21 @@
 #include "utils/memutils.h"
 #include "utils/elog.h"
 #include "commands/vacuum.h"
+#include "access/hash.h"
+#include "access/xact.h"
+#include "executor/producerReceiver.h"
+#include "libpq/libpq.h"
+#include "libpq/pqformat.h"
+#include "storage/dsm.h"
+#include "tcop/pquery.h"
+#include "tcop/tcopprot.h"
+#include "utils/portal.h"
+#include "funcapi.h"
+#include "utils/builtins.h"
 #endif
 int   NSQueues = 64;
-int   SQueueSize = 64;
+int   SQueueSize = 1024;
+int   SQueueMemory = 1048576;
 
 #ifdef __TBASE__
 extern ProtocolVersion FrontendProtocol;
@@ -71,11 +93,18 @@ bool  g_DataPumpDebug       = false;/* enable debug info */
 int32 g_SndThreadNum        = 8;    /* Two sender threads default.  */
 int32 g_SndThreadBufferSize = 16;   /* in Kilo bytes. */
 int32 g_SndBatchSize        = 8;    /* in Kilo bytes. */
+bool  g_DataPumpZeroCopy    = false;/* send with MSG_ZEROCOPY if possible */
+bool  g_DataPumpCompress    = false;/* compress tuple chunks sent by data pump */
 int   consumer_connect_timeout = 128; /* in seconds */
 int   g_DisConsumer_timeout = 60; /* in minutes */
+bool  enable_runtime_join_filter = false; /* ship hash join bloom filters to producers */
 
 #define MAX_CURSOR_LEN      64 
 #define DATA_PUMP_SOCKET_DIR  "pg_datapump"   /* socket dir for data pump */
+#define DATA_PUMP_LISTENER_NAME  "backend.%d"  /* listener socket of a producer backend */
+#define DATA_PUMP_LISTEN_BACKLOG SOMAXCONN
+#define DATA_PUMP_CONVERT_ATTACHED  'a'        /* listener took the socket */
+#define DATA_PUMP_CONVERT_NO_QUEUE  'n'        /* queue not registered (yet or anymore) */
 
 #define PARALLEL_SEND_SHARE_DATA       UINT64CONST(0xFFFFFFFFFFFFFF01)
 #define PARALLEL_SEND_CONS_MAP         UINT64CONST(0xFFFFFFFFFFFFFF02)
@@ -139,6 +168,31 @@ typedef struct SQueueSync
 #define CONSUMER_DONE 3
 
 
+#ifdef __TBASE__
+/*
+ * Throughput counters of one consumer of a queue. Each field has a single
+ * writer, the producer, its DataPump threads or the consumer, and readers
+ * only need approximate values, so no locking is done for them. When the
+ * queue goes away they are added to the totals of the consumer's node.
+ */
+typedef struct SQueueStat
+{
+    uint64      rows;           /* rows written for the consumer */
+    uint64      bytes;          /* bytes of those rows */
+    uint64      full;           /* times a row found the queue or ring full */
+    uint64      full_wait_us;   /* time the producer waited for room */
+    uint64      read_wait_us;   /* time the consumer waited in SharedQueueRead */
+    uint64      spill_rows;     /* rows put into the producer's tuplestore */
+    uint64      spill_bytes;    /* bytes moved back out of the tuplestore */
+    uint64      send_bytes;     /* bytes the DataPump wrote to the socket */
+    uint64      send_blocked;   /* DataPump socket writes that would block */
+    uint64      send_errors;    /* DataPump socket writes that failed */
+} SQueueStat;
+
+/* Totals per consumer node, protected by SQueuesLock */
+static SQueueStat *SQueueNodeStats = NULL;
+#endif
+
 /* State of a single consumer */
 typedef struct
 {
@@ -155,9 +209,13 @@ typedef struct
     int            cs_qlength;        /* The size of the consumer queue */
     int            cs_qreadpos;    /* The read position in the consumer queue */
     int            cs_qwritepos;    /* The write position in the consumer queue */
+    int            cs_longpos;        /* Bytes of a long tuple the producer has
+                                 * written so far, 0 if none in progress */
 #ifdef __TBASE__
     bool        send_fd;        /* true if send fd to producer */
     bool        cs_done;
+    dsm_handle  cs_filter;      /* runtime join filter sent by the consumer */
+    SQueueStat  cs_stat;
 #endif
 #ifdef SQUEUE_STAT
     long         stat_writes;
@@ -176,6 +234,8 @@ typedef struct SQueueHeader
     int            sq_pid;         /* Process id of the producer session */
     int            sq_nodeid;        /* Node id of the producer parent */
     SQueueSync *sq_sync;        /* Associated sinchronization objects */
+    Size        sq_ringpage;    /* First page of the rings in the ring pool */
+    Size        sq_ringpages;    /* Number of pages of the rings, 0 if none */
     int            sq_refcnt;        /* Reference count to this entry */
 #ifdef SQUEUE_STAT
     bool        stat_finish;
@@ -208,6 +268,15 @@ typedef struct SQueueHeader
 static HTAB *SharedQueues = NULL;
 static LWLockPadded *SQueueLocks = NULL;
 
+/*
+ * Consumer rings are carved out of one pool of shared_queue_memory, so that
+ * queues only hold the memory their consumers need. The free page manager
+ * sits at the start of the pool, protected by SQueuesLock.
+ */
+static FreePageManager *SQueueRingPool = NULL;
+
+#define SQUEUE_POOL_META_PAGES fpm_size_to_pages(sizeof(FreePageManager))
+
 /*
  * Pool of synchronization items
  */
@@ -270,10 +339,52 @@ static void *SQueueSyncs;
     } while(0)
 
 
+#define QUEUE_PEEK_LEN(cstate, len) \
+    do \
+    { \
+        if ((cstate)->cs_qreadpos + sizeof(int) <= (cstate)->cs_qlength) \
+            memcpy(&(len), (cstate)->cs_qstart + (cstate)->cs_qreadpos, sizeof(int)); \
+        else \
+        { \
+            int part = (cstate)->cs_qlength - (cstate)->cs_qreadpos; \
+            memcpy(&(len), (cstate)->cs_qstart + (cstate)->cs_qreadpos, part); \
+            memcpy(((char *) &(len)) + part, (cstate)->cs_qstart, sizeof(int) - part); \
+        } \
+    } while(0)
+
+
 static bool sq_push_long_tuple(ConsState *cstate, RemoteDataRow datarow);
 static void sq_pull_long_tuple(ConsState *cstate, RemoteDataRow datarow,
                                 int consumerIdx, SQueueSync *sqsync);
 
+#ifdef __TBASE__
+bool  g_SQueueBatchRead     = true; /* drain consumer queue in batches */
+
+/*
+ * Backend local buffer a consumer drains its queue into. While it holds
+ * tuples SharedQueueRead serves them without touching the queue locks, and
+ * the producer gets the whole queue back at once. Only one queue is buffered
+ * at a time; others are read tuple by tuple as before.
+ */
+typedef struct SQueueReadBuf
+{
+    SharedQueue squeue;                 /* queue the tuples came from */
+    int         consumerIdx;
+    char        sq_key[SQUEUE_KEYSIZE]; /* to recognize a recycled queue */
+    char       *data;                   /* length prefixed data rows */
+    int         size;                   /* allocated size of data */
+    int         len;                    /* bytes stored */
+    int         pos;                    /* next row to return */
+    int         ntuples;                /* rows not yet returned */
+} SQueueReadBuf;
+
+static SQueueReadBuf sq_readbuf = {NULL, -1};
+
+static void sq_readbuf_discard(SharedQueue squeue);
+static bool sq_readbuf_available(SharedQueue squeue, int consumerIdx);
+static void sq_readbuf_fill(SharedQueue squeue, int consumerIdx);
+#endif
+
 #ifdef __TBASE__
 typedef struct DisConsumer
 {
@@ -319,7 +430,31 @@ typedef struct
     volatile uint32    m_Tail;       /* Tail of the buffer */
     volatile uint32    m_Border;     /* end of last tuple, so that we can send a complete tuple */
     volatile uint32    m_WrapAround; /* wrap around of the queue , for read only */
+    volatile uint32    m_Inflight;   /* bytes before m_Tail still owned by kernel(zero copy) */
 }DataPumpBuf;
+
+/*
+ * Zero copy sends are tracked in a small ring per node, holding the length of
+ * every sendmsg() call for which the kernel has not reported completion yet.
+ */
+#define DATA_PUMP_ZC_SLOTS       256
+#define DATA_PUMP_ZC_MIN_SEND    (16 * 1024)  /* not worth it below this */
+#define DATA_PUMP_ZC_WAIT_MS     10
+#define DATA_PUMP_ZC_MAX_WAIT_MS (60 * 1000)
+
+/*
+ * Chunks of complete tuples are compressed into a single 'z' message, that is
+ * 1 byte type, 4 bytes length, 4 bytes raw length and the pglz data. When the
+ * data keeps refusing to compress we stop trying for a while.
+ */
+#define DATA_PUMP_Z_HDRSZ        9
+#define DATA_PUMP_Z_MIN_INPUT    1024
+#define DATA_PUMP_Z_MAX_FAIL     8
+#define DATA_PUMP_Z_SKIP_CHUNKS  64
+
+/* Start of the region writers must not touch, that is m_Tail minus inflight */
+#define DATA_PUMP_FREE_TAIL(buf) \
+    (((buf)->m_Tail + (buf)->m_Length - (buf)->m_Inflight) % (buf)->m_Length)
 /*
 typedef enum  
 { 
@@ -360,6 +495,20 @@ typedef struct
     size_t                nfast_send;  /* counter for tuple */
 
     size_t                sleep_count; /* counter sleep */
+
+    SQueueStat          *stat;       /* counters of the consumer in shared memory */
+
+    bool                zc_enabled;  /* socket accepts MSG_ZEROCOPY */
+    uint32              zc_next_id;  /* id the kernel assigns to our next send */
+    uint32              zc_done_id;  /* first id not reported done */
+    uint32              zc_len[DATA_PUMP_ZC_SLOTS]; /* bytes of each pending send */
+
+    char                *zbuf;       /* compressed block being sent, NULL if compression is off */
+    uint32              zlen;        /* length of the block in zbuf */
+    uint32              zoff;        /* bytes of the block already sent */
+    bool                zsync;       /* m_Tail is known to be at a message boundary */
+    int32               zfail;       /* consecutive chunks that did not compress */
+    int32               zskip;       /* chunks left to send raw before trying again */
 }DataPumpNodeControl;
 
 typedef struct
@@ -380,6 +529,11 @@ typedef struct
     bool               thread_running;     /* running flag */
     ThreadSema         send_sem;         /* used to wait for data */
     ThreadSema         quit_sem;         /* used to wait for thread quit */
+
+    PGLZ_Workspace     *pglz_ws;         /* compression history, NULL if compression is off */
+
+    bool               numa_bind;        /* bind to numa_cpus at start */
+    NumaCpuMask        numa_cpus;        /* CPUs of the node owning the buffers */
 }DataPumpThreadControl;
 
 /* */
@@ -409,8 +563,30 @@ typedef struct DataPumpSenderControl
 
     TupleTableSlot        *temp_slot;     /* temp slot used to put_tuplestore */
     int32                  tuple_len;      /* MAX tuplelen of sent tuple */
+
+    bool                   convert_attached;  /* registered with the backend listener */
+    struct DataPumpSenderControl *convert_next;/* next sender registered with the listener */
 }DataPumpSenderControl;
 
+/*
+ * Convert listener of a producer backend.  It is started with the first data
+ * pump sender of the session and kept afterwards, so later queries neither
+ * bind a socket nor start a thread to receive consumer sockets.  Consumers
+ * name the queue they attach to and the listener hands the socket to the
+ * sender registered under that name.
+ */
+typedef struct DataPumpListener
+{
+    pg_spin_lock           lock;          /* protects senders and lstatus */
+    DataPumpSenderControl *senders;       /* senders waiting for consumer sockets */
+    ConvertStatus          lstatus;
+    int                    errNO;
+    int                    listen_fd;
+    char                   sock_path[MAXPGPATH];
+}DataPumpListener;
+
+static DataPumpListener *g_DataPumpListener = NULL;
+
 /*
   *
   * This part is used for parallel workers to send tuples directly without gather/gatherMerge.
@@ -580,7 +756,12 @@ typedef struct ParallelSendDestReceiver
 } ParallelSendDestReceiver;
 
 static bool DataPumpNodeCheck(void *sndctl, int32 nodeindex);
+#ifdef USE_DATAPUMP_ZEROCOPY
+static bool DataPumpReapZeroCopy(DataPumpNodeControl *node, bool wait);
+#endif
 static int    DataPumpRawSendData(DataPumpNodeControl *node, int32 sock, char *data, int32 len, int32 *reason);
+static int    DataPumpSendPendingBlock(DataPumpNodeControl *node, int32 *reason);
+static int    DataPumpSendChunk(DataPumpNodeControl *node, PGLZ_Workspace *ws, char *data, uint32 len, int32 *reason);
 static uint32 DataSize(DataPumpBuf *buf);
 static uint32 FreeSpace(DataPumpBuf *buf);
 static char  *GetData(DataPumpBuf *buf, uint32 *uiLen);
@@ -609,8 +790,12 @@ static int convert_connect(char *sqname);
 static int convert_listen(char *sqname, int maxconn);
 static int convert_sendfds(int fd, int *fds_to_send, int count, int *err);
 static int convert_recvfds(int fd, int *fds, int count);
-static bool send_fd_with_nodeid(char *sqname, int nodeid, int consumerIdx);
-static void *ConvertThreadMain(void *arg);
+static bool send_fd_with_nodeid(SharedQueue squeue, int nodeid, int consumerIdx);
+static void *DataPumpListenerMain(void *arg);
+static bool DataPumpListenerStart(void);
+static bool DataPumpListenerAttach(DataPumpSenderControl *sender);
+static void DataPumpListenerDetach(DataPumpSenderControl *sender);
+static void DataPumpListenerExit(int code, Datum arg);
 static bool ConvertDone(ConvertControl *convert);
 static int32 DataPumpNodeReadyForSend(void *sndctl, int32 nodeindex, int32 nodeId);
 static int32 DataPumpSendToNode(void *sndctl, char *data, size_t len, int32 nodeindex);
@@ -620,6 +805,24 @@ static bool DataPumpTupleStoreDump(void *sndctl, int32 nodeindex, int32 nodeId,
 static bool socket_set_nonblocking(int fd, bool non_block);
 static void DataPumpWakeupSender(void *sndctl, int32 nodeindex);
 static bool ExecFastSendDatarow(TupleTableSlot *slot, void *sndctl, int32 nodeindex, MemoryContext tmpcxt);
+
+/*
+ * Output function info for the columns of the tuples we are sending, looked
+ * up once per tuple descriptor rather than once per datum.
+ */
+typedef struct DataRowOutputInfo
+{
+    TupleDesc       tdesc;          /* descriptor the info was built for */
+    int             natts;
+    Oid            *atttypids;      /* to detect a recycled descriptor */
+    FmgrInfo       *finfo;          /* output functions */
+    bool           *isvarlena;
+    MemoryContext   mcxt;           /* holds all of the above */
+} DataRowOutputInfo;
+
+static DataRowOutputInfo datarow_output_info = {NULL, 0};
+
+static DataRowOutputInfo *GetDataRowOutputInfo(TupleDesc tdesc);
 static int  ReturnSpace(DataPumpBuf *buf, uint32 offset);
 static uint32 BufferOffsetAdd(DataPumpBuf *buf, uint32 pointer, uint32 offset);
 
@@ -667,6 +870,7 @@ static bool CreateParallelSenderThread(ParallelSendControl *sender);
 static bool ConsumerExit(SharedQueue sq, ParallelSendControl *sender, int numParallelWorkers, 
                               int *count, Bitmapset **unconnect);
 static void ReportErrorConsumer(SharedQueue squeue);
+static bool sq_poll_filter(void);
 
 #endif
 
@@ -683,11 +887,7 @@ SharedQueuesInit(void)
     bool     found;
 
     info.keysize = SQUEUE_KEYSIZE;
-
-    if(g_UseDataPump)
-        info.entrysize = SQUEUE_HDR_SIZE(TBASE_MAX_DATANODE_NUMBER);
-    else
-        info.entrysize = SQUEUE_SIZE;
+    info.entrysize = SQUEUE_HDR_SIZE(TBASE_MAX_DATANODE_NUMBER);
 
     /*
      * Create hash table of fixed size to avoid running out of
@@ -697,6 +897,23 @@ SharedQueuesInit(void)
 
     SharedQueues = ShmemInitHash("Shared Queues", NUM_SQUEUES,
                                  NUM_SQUEUES, &info, hash_flags);
+
+    /* the data pump sends tuples over sockets and never uses the rings */
+    if (!g_UseDataPump)
+    {
+        Size    pool_pages = fpm_size_to_pages(SQUEUE_POOL_SIZE);
+        char   *base;
+
+        base = ShmemInitStruct("Shared Queue Rings",
+                               (SQUEUE_POOL_META_PAGES + pool_pages) * FPM_PAGE_SIZE,
+                               &found);
+        SQueueRingPool = (FreePageManager *) base;
+        if (!found)
+        {
+            FreePageManagerInitialize(SQueueRingPool, base);
+            FreePageManagerPut(SQueueRingPool, SQUEUE_POOL_META_PAGES, pool_pages);
+        }
+    }
 #ifdef __TBASE__
     if (g_UseDataPump)
     {
@@ -711,6 +928,14 @@ SharedQueuesInit(void)
         DisConsumerHash = ShmemInitHash("Disconnect Consumers", NUM_SQUEUES,
                              NUM_SQUEUES, &ctl, flags);
     }
+
+    SQueueNodeStats = ShmemInitStruct("Shared Queue Node Stats",
+                                      sizeof(SQueueStat) * TBASE_MAX_DATANODE_NUMBER,
+                                      &found);
+    if (!found)
+    {
+        memset(SQueueNodeStats, 0, sizeof(SQueueStat) * TBASE_MAX_DATANODE_NUMBER);
+    }
 #endif
 
     /*
@@ -778,12 +1003,83 @@ SharedQueueShmemSize(void)
     {
         sqs_size = add_size(sqs_size, hash_estimate_size(NUM_SQUEUES, sizeof(DisConsumer)));
     }
+    sqs_size = add_size(sqs_size, mul_size(sizeof(SQueueStat), TBASE_MAX_DATANODE_NUMBER));
 #endif
 
-    if(g_UseDataPump)
-        return add_size(sqs_size, hash_estimate_size(NUM_SQUEUES, SQUEUE_HDR_SIZE(TBASE_MAX_DATANODE_NUMBER)));
-    else
-        return add_size(sqs_size, hash_estimate_size(NUM_SQUEUES, SQUEUE_SIZE));
+    if (!g_UseDataPump)
+    {
+        sqs_size = add_size(sqs_size,
+                            mul_size(add_size(SQUEUE_POOL_META_PAGES,
+                                              fpm_size_to_pages(SQUEUE_POOL_SIZE)),
+                                     FPM_PAGE_SIZE));
+    }
+
+    return add_size(sqs_size, hash_estimate_size(NUM_SQUEUES, SQUEUE_HDR_SIZE(TBASE_MAX_DATANODE_NUMBER)));
+}
+
+/*
+ * Give every consumer of a new queue its ring from the ring pool. Rings get
+ * shared_queue_size each, when the pool is short they are halved down to a
+ * single page instead of failing the query, long tuples are streamed through
+ * small rings anyway. Caller holds SQueuesLock exclusively.
+ */
+static bool
+sq_alloc_rings(SharedQueue sq)
+{
+    Size    ring_pages = Max(fpm_size_to_pages(SQUEUE_RING_SIZE), 1);
+    Size    first_page = 0;
+    char   *heapPtr;
+    int     i;
+
+    sq->sq_ringpage = 0;
+    sq->sq_ringpages = 0;
+
+    if (g_UseDataPump)
+    {
+        for (i = 0; i < sq->sq_nconsumers; i++)
+        {
+            sq->sq_consumers[i].cs_qstart = NULL;
+            sq->sq_consumers[i].cs_qlength = ring_pages * FPM_PAGE_SIZE;
+        }
+        return true;
+    }
+
+    while (!FreePageManagerGet(SQueueRingPool, ring_pages * sq->sq_nconsumers,
+                               &first_page))
+    {
+        if (ring_pages == 1)
+            return false;
+        ring_pages /= 2;
+    }
+
+    sq->sq_ringpage = first_page;
+    sq->sq_ringpages = ring_pages * sq->sq_nconsumers;
+
+    heapPtr = fpm_page_to_pointer((char *) SQueueRingPool, first_page);
+    for (i = 0; i < sq->sq_nconsumers; i++)
+    {
+        sq->sq_consumers[i].cs_qstart = heapPtr;
+        sq->sq_consumers[i].cs_qlength = ring_pages * FPM_PAGE_SIZE;
+        heapPtr += ring_pages * FPM_PAGE_SIZE;
+    }
+
+    elog(DEBUG1, "SQueue %s got %d rings of %zu bytes", sq->sq_key,
+         sq->sq_nconsumers, ring_pages * FPM_PAGE_SIZE);
+    return true;
+}
+
+/*
+ * Return the rings of a queue to the ring pool. Caller holds SQueuesLock
+ * exclusively.
+ */
+static void
+sq_free_rings(SharedQueue sq)
+{
+    if (sq->sq_ringpages > 0)
+    {
+        FreePageManagerPut(SQueueRingPool, sq->sq_ringpage, sq->sq_ringpages);
+        sq->sq_ringpages = 0;
+    }
 }
 
 /*
@@ -836,9 +1132,7 @@ tryagain:
     /* First process acquiring queue should format it */
     if (!found)
     {
-        int        qsize;   /* Size of one queue */
         int        i;
-        char   *heapPtr;
 #ifdef __TBASE__
         SQueueSync *sqsync = NULL;
 #endif
@@ -868,6 +1162,24 @@ tryagain:
 
         SpinLockInit(&sq->lock);
 #endif
+        if (g_UseDataPump)
+        {
+            sq->sq_nconsumers = ncons + 1;
+        }
+        else
+        {
+            sq->sq_nconsumers = ncons;
+        }
+
+        /* Set up consumer queues */
+        if (!sq_alloc_rings(sq))
+        {
+            hash_search(SharedQueues, sqname, HASH_REMOVE, NULL);
+            LWLockRelease(SQueuesLock);
+            ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+                    errmsg("out of shared queue memory, please increase shared_queue_memory")));
+        }
+
         /*
          * Assign sync object (latches to wait on)
          * XXX We may want to optimize this and do smart search instead of
@@ -886,22 +1198,6 @@ tryagain:
 
         Assert(sq->sq_sync != NULL);
 
-        if (g_UseDataPump)
-        {
-            sq->sq_nconsumers = ncons + 1;
-        }
-        else
-        {
-            sq->sq_nconsumers = ncons;
-        }
-        
-        /* Determine queue size for a single consumer */
-        qsize = (SQUEUE_SIZE - SQUEUE_HDR_SIZE(sq->sq_nconsumers)) / sq->sq_nconsumers;
-
-        heapPtr = (char *) sq;
-        /* Skip header */
-        heapPtr += SQUEUE_HDR_SIZE(sq->sq_nconsumers);
-
 #ifdef __TBASE__
 		/* Init latch */
 		sqsync = sq->sq_sync;
@@ -917,19 +1213,17 @@ tryagain:
             cstate->cs_node = -1;
             cstate->cs_ntuples = 0;
             cstate->cs_status = CONSUMER_ACTIVE;
-            cstate->cs_qstart = heapPtr;
-            cstate->cs_qlength = qsize;
             cstate->cs_qreadpos = 0;
             cstate->cs_qwritepos = 0;
+            cstate->cs_longpos = 0;
 #ifdef __TBASE__
             cstate->send_fd = false;
             cstate->cs_done = false;
+            cstate->cs_filter = DSM_HANDLE_INVALID;
+            memset(&cstate->cs_stat, 0, sizeof(SQueueStat));
             InitSharedLatch(&sqsync->sqs_consumer_sync[i].cs_latch);
 #endif
-            heapPtr += qsize;
         }
-        
-        Assert(heapPtr <= ((char *) sq) + SQUEUE_SIZE);
     }
     else
     {
@@ -1414,6 +1708,8 @@ SharedQueueBind(const char *sqname, List *consNodes,
 
                         role = Squeue_Consumer;
                         share_sq = sq;
+                        /* whatever we buffered from a previous use is stale */
+                        sq_readbuf_discard(sq);
 #if 0
                         if (g_UseDataPump)
                         {
@@ -1421,7 +1717,7 @@ SharedQueueBind(const char *sqname, List *consNodes,
                             
                             while(1)
                             {
-                                if (send_fd_with_nodeid(sq->sq_key, nodeid, i))
+                                if (send_fd_with_nodeid(sq, nodeid, i))
                                 {
                                     if (g_DataPumpDebug)
                                     {
@@ -1565,13 +1861,15 @@ SharedQueueDump(SharedQueue squeue, int consumerIdx,
         Assert(tmpslot->tts_datarow);
 
         /* check if queue has enough room for the data */
-        if (QUEUE_FREE_SPACE(cstate) < sizeof(int) + tmpslot->tts_datarow->msglen)
+        if (cstate->cs_longpos > 0 ||
+            QUEUE_FREE_SPACE(cstate) < sizeof(int) + tmpslot->tts_datarow->msglen)
         {
             /*
-             * If stored tuple does not fit empty queue we are entering special
-             * procedure of pushing it through.
+             * If stored tuple does not fit empty queue we stream it through
+             * in parts, as the consumer frees up room.
              */
-            if (cstate->cs_ntuples <= 0)
+            if (cstate->cs_longpos > 0 ||
+                sizeof(int) + tmpslot->tts_datarow->msglen > cstate->cs_qlength)
             {
                 /*
                  * If pushing throw is completed wake up and proceed to next
@@ -1610,6 +1908,11 @@ SharedQueueDump(SharedQueue squeue, int consumerIdx,
             /* Enqueue data */
             QUEUE_WRITE(cstate, sizeof(int), (char *) &tmpslot->tts_datarow->msglen);
             QUEUE_WRITE(cstate, tmpslot->tts_datarow->msglen, tmpslot->tts_datarow->msg);
+#ifdef __TBASE__
+            cstate->cs_stat.rows++;
+            cstate->cs_stat.bytes += tmpslot->tts_datarow->msglen;
+            cstate->cs_stat.spill_bytes += tmpslot->tts_datarow->msglen;
+#endif
 
             /* Increment tuple counter. If it was 0 consumer may be waiting for
              * data so try to wake it up */
@@ -1677,6 +1980,10 @@ SharedQueueWrite(SharedQueue squeue, int consumerIdx,
              * and exit */
 #ifdef SQUEUE_STAT
             cstate->stat_buff_writes++;
+#endif
+#ifdef __TBASE__
+            cstate->cs_stat.full++;
+            cstate->cs_stat.spill_rows++;
 #endif
             LWLockRelease(clwlock);
             tuplestore_puttupleslot(*tuplestore, slot);
@@ -1701,6 +2008,10 @@ SharedQueueWrite(SharedQueue squeue, int consumerIdx,
     }
     if (QUEUE_FREE_SPACE(cstate) < sizeof(int) + datarow->msglen)
     {
+#ifdef __TBASE__
+        cstate->cs_stat.full++;
+        cstate->cs_stat.spill_rows++;
+#endif
         /* Not enough room, store tuple locally */
         LWLockRelease(clwlock);
 
@@ -1749,6 +2060,10 @@ SharedQueueWrite(SharedQueue squeue, int consumerIdx,
             /* write out the data */
             QUEUE_WRITE(cstate, sizeof(int), (char *) &datarow->msglen);
             QUEUE_WRITE(cstate, datarow->msglen, datarow->msg);
+#ifdef __TBASE__
+            cstate->cs_stat.rows++;
+            cstate->cs_stat.bytes += datarow->msglen;
+#endif
             /* Increment tuple counter. If it was 0 consumer may be waiting for
              * data so try to wake it up */
             if ((cstate->cs_ntuples)++ == 0)
@@ -1786,6 +2101,25 @@ SharedQueueRead(SharedQueue squeue, int consumerIdx,
 
 
 #ifdef __TBASE__
+    /* serve rows drained earlier, the queue locks are not needed for that */
+    if (sq_readbuf.squeue == squeue && sq_readbuf.consumerIdx == consumerIdx &&
+        sq_readbuf.ntuples > 0)
+    {
+        memcpy(&datalen, sq_readbuf.data + sq_readbuf.pos, sizeof(int));
+        sq_readbuf.pos += sizeof(int);
+        datarow = (RemoteDataRow) palloc(sizeof(RemoteDataRowData) + datalen);
+        datarow->msgnode = InvalidOid;
+        datarow->msglen = datalen;
+        memcpy(datarow->msg, sq_readbuf.data + sq_readbuf.pos, datalen);
+        sq_readbuf.pos += datalen;
+        sq_readbuf.ntuples--;
+        ExecStoreDataRowTuple(datarow, slot, true);
+#ifdef SQUEUE_STAT
+        cstate->stat_reads++;
+#endif
+        return false;
+    }
+
     if (g_UseDataPump)
     {
         if (!cstate->send_fd)
@@ -1801,7 +2135,7 @@ SharedQueueRead(SharedQueue squeue, int consumerIdx,
             
             while(1)
             {
-                if (send_fd_with_nodeid(squeue->sq_key, nodeid, consumerIdx))
+                if (send_fd_with_nodeid(squeue, nodeid, consumerIdx))
                 {
                     if (g_DataPumpDebug)
                     {
@@ -1961,6 +2295,9 @@ SharedQueueRead(SharedQueue squeue, int consumerIdx,
 #endif
         if (canwait)
         {
+#ifdef __TBASE__
+            TimestampTz wait_start;
+#endif
             /* Prepare waiting on empty buffer */
             ResetLatch(&sqsync->sqs_consumer_sync[consumerIdx].cs_latch);
             LWLockRelease(sqsync->sqs_consumer_sync[consumerIdx].cs_lwlock);
@@ -1975,10 +2312,27 @@ SharedQueueRead(SharedQueue squeue, int consumerIdx,
             SetLatch(&sqsync->sqs_producer_latch);
             LWLockRelease(sqsync->sqs_producer_lwlock);
 
+#ifdef __TBASE__
+            wait_start = GetCurrentTimestamp();
+
+            /*
+             * Parent node may send runtime join filter while we are waiting,
+             * pass it to the producer and wake up on further client input.
+             */
+            if (sq_poll_filter())
+                WaitLatchOrSocket(&sqsync->sqs_consumer_sync[consumerIdx].cs_latch,
+                        WL_LATCH_SET | WL_POSTMASTER_DEATH | WL_TIMEOUT |
+                        WL_SOCKET_READABLE, MyProcPort->sock, 1000L,
+                        WAIT_EVENT_MQ_INTERNAL);
+            else
+#endif
             /* Wait for notification about available info */
             WaitLatch(&sqsync->sqs_consumer_sync[consumerIdx].cs_latch,
                     WL_LATCH_SET | WL_POSTMASTER_DEATH | WL_TIMEOUT, 1000L,
                     WAIT_EVENT_MQ_INTERNAL);
+#ifdef __TBASE__
+            cstate->cs_stat.read_wait_us += GetCurrentTimestamp() - wait_start;
+#endif
 
             /* got the notification, restore lock and try again */
             LWLockAcquire(sqsync->sqs_producer_lwlock, LW_SHARED);
@@ -2018,6 +2372,12 @@ SharedQueueRead(SharedQueue squeue, int consumerIdx,
     (cstate->cs_ntuples)--;
 #ifdef SQUEUE_STAT
     cstate->stat_reads++;
+#endif
+#ifdef __TBASE__
+    /* take the rest of the queue while we hold the locks anyway */
+    if (g_SQueueBatchRead && cstate->cs_ntuples > 0 &&
+        sq_readbuf_available(squeue, consumerIdx))
+        sq_readbuf_fill(squeue, consumerIdx);
 #endif
     /* sanity check */
     Assert((cstate->cs_ntuples == 0) == (cstate->cs_qreadpos == cstate->cs_qwritepos));
@@ -2115,6 +2475,7 @@ SharedQueueReset(SharedQueue squeue, int consumerIdx)
                 cstate->cs_ntuples = 0;
                 /* keep consistent with cs_ntuples*/
                 cstate->cs_qreadpos = cstate->cs_qwritepos = 0;
+                cstate->cs_longpos = 0;
 
                 /* wake up consumer if it is sleeping */
                 SetLatch(&sqsync->sqs_consumer_sync[i].cs_latch);
@@ -2135,7 +2496,11 @@ SharedQueueReset(SharedQueue squeue, int consumerIdx)
     else
     {
         ConsState  *cstate = &(squeue->sq_consumers[consumerIdx]);
-        
+
+#ifdef __TBASE__
+        /* rows we drained are of no use anymore */
+        sq_readbuf_discard(squeue);
+#endif
         LWLockAcquire(sqsync->sqs_producer_lwlock, LW_SHARED);
 
         if (g_DataPumpDebug)
@@ -2275,17 +2640,409 @@ IsConsumerDisConnect(char *sqname, int nodeid)
 
     LWLockRelease(DisconnectConsLock);
 
-    return disconnect;
-}
+    return disconnect;
+}
+
+void
+RemoveDisConsumerHash(char *sqname)
+{
+    LWLockAcquire(DisconnectConsLock, LW_EXCLUSIVE);
+
+    hash_search(DisConsumerHash, sqname, HASH_REMOVE, NULL);
+    
+    LWLockRelease(DisconnectConsLock);
+}
+
+/*
+ * Runtime join filters
+ *
+ * A consumer gets the filter from its parent node and publishes it in a DSM
+ * segment, the handle is put into the ConsState. The producer picks the
+ * handle up, copies the filter into local memory and from then on skips
+ * tuples for that consumer which have no chance to find a join partner.
+ */
+struct SQueueFilterCache
+{
+    SQueueFilter   *filter;        /* local copy of the filter, NULL if none */
+    bool            checked;       /* filter is already picked up */
+    FmgrInfo        hashfuncs[SQUEUE_FILTER_MAX_KEYS];
+};
+
+/* number of bits set per hash value */
+#define SQUEUE_FILTER_NPROBES        3
+/* bitmap size per expected inner tuple */
+#define SQUEUE_FILTER_BITS_PER_TUPLE 16
+
+/* segments published by this backend, detached at the end of transaction */
+static List *sq_filter_segs = NIL;
+static bool sq_filter_callback_registered = false;
+
+/*
+ * Create an empty filter sized for the expected number of distinct hash
+ * values.
+ */
+SQueueFilter *
+SQueueFilterCreate(double ntuples)
+{
+    SQueueFilter *filter;
+    double        nbits = Max(ntuples, 1.0) * SQUEUE_FILTER_BITS_PER_TUPLE;
+    int32         size = SQUEUE_FILTER_MIN_BITS;
+
+    while (size < nbits && size < SQUEUE_FILTER_MAX_BITS)
+        size <<= 1;
+
+    filter = (SQueueFilter *) palloc0(SQUEUE_FILTER_SIZE(size));
+    filter->consumerIdx = -1;
+    filter->nbits = size;
+
+    return filter;
+}
+
+/*
+ * Add hash value to the filter. The probes are derived from the value by
+ * double hashing, so the join hash is computed once per tuple.
+ */
+void
+SQueueFilterAdd(SQueueFilter *filter, uint32 hashvalue)
+{
+    uint32        step = DatumGetUInt32(hash_uint32(hashvalue)) | 1;
+    uint32        mask = filter->nbits - 1;
+    uint32        bit = hashvalue;
+    int            i;
+
+    for (i = 0; i < SQUEUE_FILTER_NPROBES; i++)
+    {
+        uint32 pos = bit & mask;
+
+        filter->bitmap[pos / BITS_IN_LONGLONG] |= UINT64CONST(1) << (pos % BITS_IN_LONGLONG);
+        bit += step;
+    }
+}
+
+static bool
+sq_filter_test(SQueueFilter *filter, uint32 hashvalue)
+{
+    uint32        step = DatumGetUInt32(hash_uint32(hashvalue)) | 1;
+    uint32        mask = filter->nbits - 1;
+    uint32        bit = hashvalue;
+    int            i;
+
+    for (i = 0; i < SQUEUE_FILTER_NPROBES; i++)
+    {
+        uint32 pos = bit & mask;
+
+        if ((filter->bitmap[pos / BITS_IN_LONGLONG] &
+             (UINT64CONST(1) << (pos % BITS_IN_LONGLONG))) == 0)
+            return false;
+        bit += step;
+    }
+
+    return true;
+}
+
+static void
+sq_filter_cache_init(SQueueFilterCache *cache, SQueueFilter *filter)
+{
+    Size        size = SQUEUE_FILTER_SIZE(filter->nbits);
+    int            i;
+
+    cache->filter = (SQueueFilter *) palloc(size);
+    memcpy(cache->filter, filter, size);
+    for (i = 0; i < filter->nkeys; i++)
+        fmgr_info(filter->hashfuncs[i], &cache->hashfuncs[i]);
+    cache->checked = true;
+}
+
+/*
+ * Prepare filter for the producer's own consumer, the filter is copied into
+ * the current memory context.
+ */
+SQueueFilterCache *
+SQueueFilterCacheCreate(SQueueFilter *filter)
+{
+    SQueueFilterCache *cache;
+
+    cache = (SQueueFilterCache *) palloc0(sizeof(SQueueFilterCache));
+    sq_filter_cache_init(cache, filter);
+
+    return cache;
+}
+
+/*
+ * Check if the tuple may have a join partner on the consumer. The hash value
+ * of the keys is combined the same way ExecHashGetHashValue does.
+ */
+bool
+SQueueFilterMatch(SQueueFilterCache *cache, TupleTableSlot *slot)
+{
+    SQueueFilter *filter = cache->filter;
+    uint32        hashkey = 0;
+    int            i;
+
+    if (filter == NULL)
+        return true;
+
+    for (i = 0; i < filter->nkeys; i++)
+    {
+        Datum        value;
+        bool        isnull;
+
+        if (filter->keys[i] > slot->tts_tupleDescriptor->natts)
+        {
+            /* should not happen, but do not risk losing rows */
+            cache->filter = NULL;
+            return true;
+        }
+
+        /* rotate hashkey left 1 bit at each step */
+        hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
+
+        /* filters are built for joins where NULL outer key never matches */
+        value = slot_getattr(slot, filter->keys[i], &isnull);
+        if (isnull)
+            return false;
+        hashkey ^= DatumGetUInt32(FunctionCall1(&cache->hashfuncs[i], value));
+    }
+
+    return sq_filter_test(filter, hashkey);
+}
+
+static void
+sq_filter_attach(SharedQueue squeue, int consumerIdx, dsm_handle handle,
+                 SQueueFilterCache *cache)
+{
+    dsm_segment  *seg;
+    SQueueFilter *filter;
+    Size          len;
+
+    seg = dsm_attach(handle);
+    if (seg == NULL)
+    {
+        elog(DEBUG1, "SQueue %s, runtime filter of consumer %d is gone",
+             squeue->sq_key, consumerIdx);
+        return;
+    }
+
+    /* the consumer may have finished and the handle got reused, verify */
+    filter = (SQueueFilter *) dsm_segment_address(seg);
+    len = dsm_segment_map_length(seg);
+    if (len >= offsetof(SQueueFilter, bitmap) &&
+        strncmp(filter->sq_key, squeue->sq_key, SQUEUE_KEYSIZE) == 0 &&
+        filter->consumerIdx == consumerIdx &&
+        len >= SQUEUE_FILTER_SIZE(filter->nbits))
+    {
+        sq_filter_cache_init(cache, filter);
+        elog(DEBUG1, "SQueue %s, got runtime filter of consumer %d, %d bits",
+             squeue->sq_key, consumerIdx, filter->nbits);
+    }
+
+    dsm_detach(seg);
+}
+
+/*
+ * Check if the tuple should be sent to the consumer. The caches array has an
+ * entry per consumer and is allocated in the current memory context upon the
+ * first call.
+ */
+bool
+SharedQueueFilterTuple(SharedQueue squeue, int consumerIdx,
+                       TupleTableSlot *slot, SQueueFilterCache **caches)
+{
+    SQueueFilterCache *cache;
+
+    if (*caches == NULL)
+        *caches = (SQueueFilterCache *)
+            palloc0(squeue->sq_nconsumers * sizeof(SQueueFilterCache));
+    cache = &(*caches)[consumerIdx];
+
+    if (!cache->checked)
+    {
+        volatile ConsState *cstate = &squeue->sq_consumers[consumerIdx];
+        dsm_handle    handle = cstate->cs_filter;
+
+        if (handle == DSM_HANDLE_INVALID)
+            return true;
+
+        cache->checked = true;
+        sq_filter_attach(squeue, consumerIdx, handle, cache);
+    }
+
+    return SQueueFilterMatch(cache, slot);
+}
+
+static void
+sq_filter_xact_callback(XactEvent event, void *arg)
+{
+    ListCell   *lc;
+
+    if (event != XACT_EVENT_COMMIT && event != XACT_EVENT_ABORT &&
+        event != XACT_EVENT_PREPARE)
+        return;
+
+    foreach(lc, sq_filter_segs)
+        dsm_detach((dsm_segment *) lfirst(lc));
+    list_free(sq_filter_segs);
+    sq_filter_segs = NIL;
+}
+
+/*
+ * Make the filter visible to the producer of the queue. The segment is
+ * kept until the end of transaction, the producer may pick it up late.
+ */
+static void
+sq_filter_publish(SharedQueue squeue, int consumerIdx, SQueueFilter *filter)
+{
+    ConsState     *cstate = &(squeue->sq_consumers[consumerIdx]);
+    LWLockId       clwlock = squeue->sq_sync->sqs_consumer_sync[consumerIdx].cs_lwlock;
+    Size           size = SQUEUE_FILTER_SIZE(filter->nbits);
+    dsm_segment   *seg;
+    bool           installed = false;
+    MemoryContext  oldcontext;
+
+    if (dynamic_shared_memory_type == DSM_IMPL_NONE)
+        return;
+
+    seg = dsm_create(size, DSM_CREATE_NULL_IF_MAXSEGMENTS);
+    if (seg == NULL)
+    {
+        elog(DEBUG1, "SQueue %s, no DSM segment for runtime filter",
+             squeue->sq_key);
+        return;
+    }
+    dsm_pin_mapping(seg);
+
+    strncpy(filter->sq_key, squeue->sq_key, SQUEUE_KEYSIZE);
+    filter->consumerIdx = consumerIdx;
+    memcpy(dsm_segment_address(seg), filter, size);
+
+    LWLockAcquire(clwlock, LW_EXCLUSIVE);
+    if (cstate->cs_status == CONSUMER_ACTIVE &&
+        cstate->cs_filter == DSM_HANDLE_INVALID)
+    {
+        cstate->cs_filter = dsm_segment_handle(seg);
+        installed = true;
+    }
+    LWLockRelease(clwlock);
+
+    if (!installed)
+    {
+        dsm_detach(seg);
+        return;
+    }
+
+    if (!sq_filter_callback_registered)
+    {
+        RegisterXactCallback(sq_filter_xact_callback, NULL);
+        sq_filter_callback_registered = true;
+    }
+
+    oldcontext = MemoryContextSwitchTo(TopMemoryContext);
+    sq_filter_segs = lappend(sq_filter_segs, seg);
+    MemoryContextSwitchTo(oldcontext);
+
+    elog(DEBUG1, "SQueue %s, consumer %d published runtime filter, %d bits",
+         squeue->sq_key, consumerIdx, filter->nbits);
+}
+
+/*
+ * Process runtime join filter message sent by the parent node
+ * (pgxc_node_send_runtime_filter). The filter is applied by the producer of
+ * the named cursor to the tuples it sends to us.
+ */
+void
+SharedQueueRecvFilter(StringInfo msg)
+{
+    const char   *cursor;
+    int           len;
+    SQueueFilter *filter;
+    Portal        portal;
+    QueryDesc    *queryDesc;
+
+    cursor = pq_getmsgstring(msg);
+    len = msg->len - msg->cursor;
+    if (len < offsetof(SQueueFilter, bitmap))
+        ereport(ERROR,
+                (errcode(ERRCODE_PROTOCOL_VIOLATION),
+                 errmsg("invalid runtime join filter message")));
+
+    filter = (SQueueFilter *) palloc(len);
+    pq_copymsgbytes(msg, (char *) filter, len);
+    pq_getmsgend(msg);
+
+    if (filter->nkeys <= 0 || filter->nkeys > SQUEUE_FILTER_MAX_KEYS ||
+        filter->nbits < SQUEUE_FILTER_MIN_BITS ||
+        filter->nbits > SQUEUE_FILTER_MAX_BITS ||
+        (filter->nbits & (filter->nbits - 1)) != 0 ||
+        len != SQUEUE_FILTER_SIZE(filter->nbits))
+        ereport(ERROR,
+                (errcode(ERRCODE_PROTOCOL_VIOLATION),
+                 errmsg("invalid runtime join filter message")));
+
+    portal = GetPortalByName(cursor);
+    if (!PortalIsValid(portal) || portal->queryDesc == NULL)
+    {
+        elog(DEBUG1, "runtime filter for cursor %s ignored, no such portal",
+             cursor);
+        pfree(filter);
+        return;
+    }
+
+    queryDesc = portal->queryDesc;
+    if (queryDesc->myindex >= 0 && queryDesc->squeue)
+    {
+        /* we are consumer, the producer is another session */
+        sq_filter_publish(queryDesc->squeue, queryDesc->myindex, filter);
+    }
+    else if (queryDesc->myindex == -1 && queryDesc->dest &&
+             queryDesc->dest->mydest == DestProducer)
+    {
+        /* we are producer, the filter is for tuples we keep for ourselves */
+        MemoryContext oldcontext;
+
+        oldcontext = MemoryContextSwitchTo(PortalGetHeapMemory(portal));
+        SetProducerSelfFilter(queryDesc->dest, SQueueFilterCacheCreate(filter));
+        MemoryContextSwitchTo(oldcontext);
+    }
+
+    pfree(filter);
+}
+
+/*
+ * Take runtime join filter from the client connection if that is the next
+ * message there. Consumer does this while waiting for the producer, the
+ * parent node sends the filter when the query is already running.
+ * Returns true if there is no other pending input, so the caller may wait
+ * on the socket.
+ */
+static bool
+sq_poll_filter(void)
+{
+    unsigned char c;
+    int           r;
+    StringInfoData msg;
+
+    if (whereToSendOutput != DestRemote || MyProcPort == NULL ||
+        !IsConnFromDatanode())
+        return false;
+
+    pq_startmsgread();
+    r = pq_peekbyte_if_available(&c);
+    if (r != 1 || c != 'J')
+    {
+        pq_endmsgread();
+        return r == 0;
+    }
 
-void
-RemoveDisConsumerHash(char *sqname)
-{
-    LWLockAcquire(DisconnectConsLock, LW_EXCLUSIVE);
+    (void) pq_getbyte();
+    initStringInfo(&msg);
+    if (pq_getmessage(&msg, 0))
+        ereport(FATAL,
+                (errcode(ERRCODE_CONNECTION_FAILURE),
+                 errmsg("unexpected EOF while reading runtime join filter")));
+    SharedQueueRecvFilter(&msg);
+    pfree(msg.data);
 
-    hash_search(DisConsumerHash, sqname, HASH_REMOVE, NULL);
-    
-    LWLockRelease(DisconnectConsLock);
+    return true;
 }
 #endif
 
@@ -2362,6 +3119,7 @@ SharedQueueDisconnectConsumer(const char *sqname)
             cstate->cs_ntuples = 0;
             /* keep consistent with cs_ntuples*/
             cstate->cs_qreadpos = cstate->cs_qwritepos = 0;
+            cstate->cs_longpos = 0;
 
             LWLockRelease(sqsync->sqs_consumer_sync[i].cs_lwlock);
 
@@ -2382,6 +3140,7 @@ SharedQueueDisconnectConsumer(const char *sqname)
             cstate->cs_ntuples = 0;
             /* keep consistent with cs_ntuples*/
             cstate->cs_qreadpos = cstate->cs_qwritepos = 0;
+            cstate->cs_longpos = 0;
 
             LWLockRelease(sqsync->sqs_consumer_sync[i].cs_lwlock);
 
@@ -2435,6 +3194,7 @@ SharedQueueResetNotConnected(SharedQueue squeue)
             cstate->cs_ntuples = 0;
             /* keep consistent with cs_ntuples*/
             cstate->cs_qreadpos = cstate->cs_qwritepos = 0;
+            cstate->cs_longpos = 0;
 
             /* wake up consumer if it is sleeping */
             SetLatch(&sqsync->sqs_consumer_sync[i].cs_latch);
@@ -3209,6 +3969,39 @@ CHECK:
 }
 
 
+#ifdef __TBASE__
+/*
+ * Add the counters of the queue consumers to the totals of their nodes before
+ * the queue is removed. Caller must hold SQueuesLock exclusively.
+ */
+static void
+SharedQueueAccumStats(SharedQueue sq)
+{
+    int i;
+
+    for (i = 0; i < sq->sq_nconsumers; i++)
+    {
+        ConsState  *cstate = &sq->sq_consumers[i];
+        SQueueStat *total;
+
+        if (cstate->cs_node < 0 || cstate->cs_node >= TBASE_MAX_DATANODE_NUMBER)
+            continue;
+
+        total = &SQueueNodeStats[cstate->cs_node];
+        total->rows += cstate->cs_stat.rows;
+        total->bytes += cstate->cs_stat.bytes;
+        total->full += cstate->cs_stat.full;
+        total->full_wait_us += cstate->cs_stat.full_wait_us;
+        total->read_wait_us += cstate->cs_stat.read_wait_us;
+        total->spill_rows += cstate->cs_stat.spill_rows;
+        total->spill_bytes += cstate->cs_stat.spill_bytes;
+        total->send_bytes += cstate->cs_stat.send_bytes;
+        total->send_blocked += cstate->cs_stat.send_blocked;
+        total->send_errors += cstate->cs_stat.send_errors;
+    }
+}
+#endif
+
 /*
  * If queue with specified name still exists set mark respective consumer as
  * "Done". Due to executor optimization consumer may never connect the queue,
@@ -3374,6 +4167,10 @@ done:
         /* Now it is OK to remove hash table entry */
         sq->sq_sync->queue = NULL;
         sq->sq_sync = NULL;
+#ifdef __TBASE__
+        SharedQueueAccumStats(sq);
+#endif
+        sq_free_rings(sq);
         if (hash_search(SharedQueues, sq->sq_key, HASH_REMOVE, NULL) != sq)
             elog(PANIC, "Shared queue data corruption");
     }
@@ -3407,88 +4204,69 @@ SharedQueuesCleanup(int code, Datum arg)
 
 /*
  * sq_push_long_tuple
- *    Routine to push through the consumer state tuple longer the the consumer
- *    queue. Long tuple is written by a producer partially, and only when the
- *    consumer queue is empty.
- *    The consumer can determine that the tuple being read is long if the length
- *    of the tuple which is read before data is exceeding queue length.
- *       Consumers is switching to the long tuple mode and read in the portion of
- *      data which is already in the queue. After reading in each portion of data
- *    consumer sets cs_ntuples to LONG_TUPLE to indicate it is in long tuple
- *    mode, and writes out number of already read bytes to the beginning of the
- *    queue.
- *    While Consumer is reading in tuple data Producer may work on other task:
- *    execute query and send tuples to other Customers. If Producer sees the
- *    LONG_TUPLE indicator it may write out next portion. The tuple remains
- *    current in the tuplestore, and Producer just needs to read offset from
- *    the buffer to know what part of data to write next.
- *    After tuple is completely written the Producer is advancing to next tuple
- *    and continue operation in normal mode.
+ *    Routine to push through the consumer queue a tuple longer than the
+ *    queue. The long tuple is streamed through the ring in parts: the
+ *    producer writes out the length followed by as much data as there is room
+ *    for, and on later calls appends more data as the consumer frees up
+ *    space. cs_longpos tracks how much of the tuple is written, and nothing
+ *    else is written to the queue until the tuple is complete, so the tuple
+ *    remains current in the tuplestore until then.
+ *    The long tuple counts as one queued tuple from the moment its length is
+ *    written. If the consumer drains the queue before the tuple is complete,
+ *    it sets cs_ntuples to LONG_TUPLE to mark the queue empty and waits; the
+ *    producer sets it back to 1 when it writes more data.
+ *    Returns true when the tuple has been completely written.
  */
 static bool
 sq_push_long_tuple(ConsState *cstate, RemoteDataRow datarow)
 {
-    if (cstate->cs_ntuples == 0)
+    int            len;
+
+    if (cstate->cs_longpos == 0)
     {
-        /* the tuple is too big to fit the queue, start pushing it through */
-        int len;
+        /* Need room for the length and at least some of the data */
+        if (QUEUE_FREE_SPACE(cstate) <= sizeof(int))
+            return false;
+
         /*
          * Output actual message size, to prepare consumer:
          * allocate memory and set up transmission.
          */
         QUEUE_WRITE(cstate, sizeof(int), (char *) &datarow->msglen);
-        /* Output as much as possible */
-        len = cstate->cs_qlength - sizeof(int);
-        Assert(datarow->msglen > len);
-        QUEUE_WRITE(cstate, len, datarow->msg);
-        cstate->cs_ntuples = 1;
-        return false;
+        (cstate->cs_ntuples)++;
     }
-    else
-    {
-        int offset;
-        int    len;
 
-        /* Continue pushing through long tuple */
-        Assert(cstate->cs_ntuples == LONG_TUPLE);
-        /*
-         * Consumer outputs number of bytes already read at the beginning of
-         * the queue.
-         */
-        memcpy(&offset, cstate->cs_qstart, sizeof(int));
-
-        Assert(offset > 0 && offset < datarow->msglen);
+    /* Output as much as possible */
+    len = Min(QUEUE_FREE_SPACE(cstate), datarow->msglen - cstate->cs_longpos);
+    if (len > 0)
+    {
+        QUEUE_WRITE(cstate, len, datarow->msg + cstate->cs_longpos);
+        cstate->cs_longpos += len;
 
-        /* remaining data */
-        len = datarow->msglen - offset;
-        /*
-         * We are sending remaining lengs just for sanity check at the consumer
-         * side
-         */
-        QUEUE_WRITE(cstate, sizeof(int), (char *) &len);
-        if (len > cstate->cs_qlength - sizeof(int))
-        {
-            /* does not fit yet */
-            len = cstate->cs_qlength - sizeof(int);
-            QUEUE_WRITE(cstate, len, datarow->msg + offset);
-            cstate->cs_ntuples = 1;
-            return false;
-        }
-        else
-        {
-            /* now we are done */
-            QUEUE_WRITE(cstate, len, datarow->msg + offset);
+        /* the consumer has drained the queue and waits for more */
+        if (cstate->cs_ntuples == LONG_TUPLE)
             cstate->cs_ntuples = 1;
-            return true;
-        }
     }
+
+    if (cstate->cs_longpos < datarow->msglen)
+        return false;
+
+    /* now we are done */
+    cstate->cs_longpos = 0;
+#ifdef __TBASE__
+    cstate->cs_stat.rows++;
+    cstate->cs_stat.bytes += datarow->msglen;
+    cstate->cs_stat.spill_bytes += datarow->msglen;
+#endif
+    return true;
 }
 
 
 /*
  * sq_pull_long_tuple
  *    Read in from the queue data of a long tuple which does not the queue.
- *    See sq_push_long_tuple for more details
+ *    See sq_push_long_tuple for more details. The data is assembled right in
+ *    the data row, which is allocated with the full tuple length.
  *
  *    The function is entered with LWLocks held on the consumer as well as
  *    procuder sync. The function exits with both of those locks held, even
@@ -3499,16 +4277,15 @@ sq_pull_long_tuple(ConsState *cstate, RemoteDataRow datarow,
                                int consumerIdx, SQueueSync *sqsync)
 {
     int offset = 0;
-    int len = datarow->msglen;
+    int len;
     ConsumerSync *sync = &sqsync->sqs_consumer_sync[consumerIdx];
 
     for (;;)
     {
-        /* determine how many bytes to read */
-        if (len > cstate->cs_qlength - sizeof(int))
-            len = cstate->cs_qlength - sizeof(int);
-
-        /* read data */
+        /* read as much of the tuple as the producer has written out */
+        len = cstate->cs_qlength - QUEUE_FREE_SPACE(cstate);
+        if (len > datarow->msglen - offset)
+            len = datarow->msglen - offset;
         QUEUE_READ(cstate, len, datarow->msg + offset);
 
         /* remember how many we read already */
@@ -3518,11 +4295,10 @@ sq_pull_long_tuple(ConsState *cstate, RemoteDataRow datarow,
         if (offset == datarow->msglen)
             return;
 
-        /* need more, set up queue to accept data from the producer */
+        /* need more, the queue is empty now */
         Assert(cstate->cs_ntuples == 1); /* allow exactly one incomplete tuple */
+        Assert(cstate->cs_qreadpos == cstate->cs_qwritepos);
         cstate->cs_ntuples = LONG_TUPLE; /* long tuple mode marker */
-        /* Inform producer how many bytes we have already */
-        memcpy(cstate->cs_qstart, &offset, sizeof(int));
         /* Release locks and wait until producer supply more data */
         while (cstate->cs_ntuples == LONG_TUPLE)
         {
@@ -3550,17 +4326,100 @@ sq_pull_long_tuple(ConsState *cstate, RemoteDataRow datarow,
             LWLockAcquire(sqsync->sqs_producer_lwlock, LW_SHARED);
             LWLockAcquire(sync->cs_lwlock, LW_EXCLUSIVE);
         }
-        /* Read length of remaining data */
-        QUEUE_READ(cstate, sizeof(int), (char *) &len);
-
-        /* Make sure we are doing the same tuple */
-        Assert(offset + len == datarow->msglen);
 
         /* next iteration */
     }
 }
 
 #ifdef __TBASE__
+/*
+ * sq_readbuf_discard
+ *    Forget rows drained from the specified queue, if any.
+ */
+static void
+sq_readbuf_discard(SharedQueue squeue)
+{
+    if (sq_readbuf.squeue != squeue)
+        return;
+
+    sq_readbuf.squeue = NULL;
+    sq_readbuf.consumerIdx = -1;
+    sq_readbuf.len = sq_readbuf.pos = 0;
+    sq_readbuf.ntuples = 0;
+}
+
+/*
+ * sq_readbuf_available
+ *    Check if the read buffer may take rows of the specified consumer queue.
+ *    The buffer is free if it is empty, or if the queue it still has rows of
+ *    has been released or recycled, since nobody is going to read them then.
+ */
+static bool
+sq_readbuf_available(SharedQueue squeue, int consumerIdx)
+{
+    SharedQueue owner = sq_readbuf.squeue;
+
+    if (owner == NULL || sq_readbuf.ntuples <= 0)
+        return true;
+
+    if (owner == squeue && sq_readbuf.consumerIdx == consumerIdx)
+        return false;
+
+    if (strncmp(owner->sq_key, sq_readbuf.sq_key, SQUEUE_KEYSIZE) != 0 ||
+        owner->sq_consumers[sq_readbuf.consumerIdx].cs_pid != MyProcPid ||
+        owner->sq_consumers[sq_readbuf.consumerIdx].cs_status == CONSUMER_DONE)
+    {
+        sq_readbuf_discard(owner);
+        return true;
+    }
+
+    return false;
+}
+
+/*
+ * sq_readbuf_fill
+ *    Move all complete rows from the consumer queue to the read buffer.
+ *    Must be called with the consumer lock held. Stops at a long tuple, which
+ *    is left in the queue for sq_pull_long_tuple.
+ */
+static void
+sq_readbuf_fill(SharedQueue squeue, int consumerIdx)
+{
+    ConsState  *cstate = &(squeue->sq_consumers[consumerIdx]);
+    int         datalen;
+
+    if (sq_readbuf.data == NULL || sq_readbuf.size < cstate->cs_qlength)
+    {
+        if (sq_readbuf.data)
+            pfree(sq_readbuf.data);
+        sq_readbuf.data = MemoryContextAlloc(TopMemoryContext,
+                                             cstate->cs_qlength);
+        sq_readbuf.size = cstate->cs_qlength;
+    }
+
+    sq_readbuf.squeue = squeue;
+    sq_readbuf.consumerIdx = consumerIdx;
+    strncpy(sq_readbuf.sq_key, squeue->sq_key, SQUEUE_KEYSIZE);
+    sq_readbuf.len = sq_readbuf.pos = 0;
+    sq_readbuf.ntuples = 0;
+
+    while (cstate->cs_ntuples > 0)
+    {
+        QUEUE_PEEK_LEN(cstate, datalen);
+        if (datalen > cstate->cs_qlength - sizeof(int))
+            break;
+
+        /* queued bytes always fit, since the buffer is as long as the queue */
+        Assert(sq_readbuf.len + sizeof(int) + datalen <= sq_readbuf.size);
+        QUEUE_READ(cstate, sizeof(int), sq_readbuf.data + sq_readbuf.len);
+        sq_readbuf.len += sizeof(int);
+        QUEUE_READ(cstate, datalen, sq_readbuf.data + sq_readbuf.len);
+        sq_readbuf.len += datalen;
+        sq_readbuf.ntuples++;
+        (cstate->cs_ntuples)--;
+    }
+}
+
 void ThreadSemaInit(ThreadSema *sema, int32 init)
 {
     if (sema)
@@ -3745,7 +4604,7 @@ char *GetWriteOff(DataPumpBuf *buf, uint32 *uiLen)
     {
         spinlock_lock(&(buf->pointerlock));
         head = buf->m_Head;
-        tail = buf->m_Tail;
+        tail = DATA_PUMP_FREE_TAIL(buf);
         spinlock_unlock(&(buf->pointerlock));
         
         if (head >=  tail)
@@ -3856,7 +4715,7 @@ uint32 FreeSpace(DataPumpBuf *buf)
     {
         spinlock_lock(&(buf->pointerlock));
         head = buf->m_Head;
-        tail = buf->m_Tail;
+        tail = DATA_PUMP_FREE_TAIL(buf);
         spinlock_unlock(&(buf->pointerlock));
 
         if (tail <= head)
@@ -3976,6 +4835,7 @@ DataPumpBuf *BuildDataPumpBuf(void)
     buff->m_Tail            = 0;    
     buff->m_WrapAround     = 0;    
     buff->m_Border          = INVALID_BORDER;        
+    buff->m_Inflight        = 0;
     return buff;
 }
 /*
@@ -3990,6 +4850,19 @@ void InitDataPumpNodeControl(int32 nodeindex, DataPumpNodeControl *control)
     control->buffer      = BuildDataPumpBuf();
     control->ntuples_get = 0;
     control->ntuples_put = 0;
+    control->zc_enabled  = false;
+    control->zc_next_id  = 0;
+    control->zc_done_id  = 0;
+    control->zbuf        = NULL;
+    if (g_DataPumpCompress)
+    {
+        control->zbuf = (char*)palloc(DATA_PUMP_Z_HDRSZ + PGLZ_MAX_OUTPUT(control->buffer->m_Length));
+    }
+    control->zlen        = 0;
+    control->zoff        = 0;
+    control->zsync       = true;
+    control->zfail       = 0;
+    control->zskip       = 0;
 }
 /*
  * Build data pump thread control.
@@ -4005,6 +4878,13 @@ void InitDataPumpThreadControl(DataPumpThreadControl *control, DataPumpNodeContr
     control->thread_running    = false;
     ThreadSemaInit(&control->send_sem, 0);
     ThreadSemaInit(&control->quit_sem, 0);
+
+    /* pglz keeps its history in static memory, every thread needs its own */
+    control->pglz_ws           = NULL;
+    if (g_DataPumpCompress)
+    {
+        control->pglz_ws = (PGLZ_Workspace*)palloc(pglz_workspace_size());
+    }
 }
 /*
  * Create data pump sender thread.
@@ -4029,13 +4909,8 @@ bool CreateSenderThread(DataPumpSenderControl *sender)
 
     if (succeed)
     {
-        /* create convert thread */
-        ThreadSemaInit(&sender->convert_control.quit_sem, 0);
-        ret = CreateThread(ConvertThreadMain, (void *)sender, MT_THR_DETACHED);
-        if(ret)
-            succeed = false;
-        else
-            sender->convert_control.cstatus = ConvertRunning;
+        /* receive consumer sockets through the listener of this backend */
+        succeed = DataPumpListenerStart() && DataPumpListenerAttach(sender);
     }
     
     if (!succeed)
@@ -4055,6 +4930,14 @@ DataPumpSender BuildDataPumpSenderControl(SharedQueue sq)
     int32     step = 0;    
     int32     end  = 0;    
     DataPumpSenderControl *sender_control = NULL;
+    int       numa_node = -1;
+
+    /*
+     * The node buffers are first touched by us below and so live on our
+     * NUMA node; keep the sender threads next to them.
+     */
+    if (numa_shared_memory)
+        numa_node = NumaCurrentNode();
 
     sender_control = palloc0(sizeof(DataPumpSenderControl));
     sender_control->node_num = sq->sq_nconsumers;
@@ -4065,6 +4948,7 @@ DataPumpSender BuildDataPumpSenderControl(SharedQueue sq)
         ConsState  *cstate = &(sq->sq_consumers[i]);
 
         InitDataPumpNodeControl(cstate->cs_node, &sender_control->nodes[i]);
+        sender_control->nodes[i].stat = &cstate->cs_stat;
     }
 
     /* Use the minimal one as thread number. */
@@ -4087,6 +4971,8 @@ DataPumpSender BuildDataPumpSenderControl(SharedQueue sq)
             end = sender_control->node_num;
         }
         InitDataPumpThreadControl(&sender_control->thread_control[i], sender_control->nodes, base, end, sender_control->node_num);
+        sender_control->thread_control[i].numa_bind =
+            NumaGetNodeCpus(numa_node, &sender_control->thread_control[i].numa_cpus);
         
 		/* Set running status for the thread. not running now */
 		sender_control->thread_control[i].thread_running = false;		
@@ -4125,6 +5011,13 @@ void DestoryDataPumpSenderControl (void* sndctl, int nodeid)
 
     if (sender->thread_control)
     {
+        for (i = 0; i < sender->thread_num; i++)
+        {
+            if (sender->thread_control[i].pglz_ws)
+            {
+                pfree(sender->thread_control[i].pglz_ws);
+            }
+        }
         pfree(sender->thread_control);
         sender->thread_control = NULL;
     }
@@ -4134,6 +5027,11 @@ void DestoryDataPumpSenderControl (void* sndctl, int nodeid)
         for (i = 0; i < sender->node_num; i++)
         {        
             DestoryDataPumpBuf(sender->nodes[i].buffer);
+            if (sender->nodes[i].zbuf)
+            {
+                pfree(sender->nodes[i].zbuf);
+                sender->nodes[i].zbuf = NULL;
+            }
 
             if (sender->nodes[i].sock != NO_SOCKET && sender->nodes[i].nodeindex != nodeid)
             {
@@ -4177,12 +5075,17 @@ void DataPumpSendLoop(DataPumpNodeControl  *nodes, DataPumpThreadControl* contro
             /* status is valid */
             if (status >= DataPumpSndStatus_set_socket && status  <= DataPumpSndStatus_data_sending)
             {
+#ifdef USE_DATAPUMP_ZEROCOPY
+                /* give space of completed zero copy sends back to the writer */
+                if (nodes[nodeindex].zc_next_id != nodes[nodeindex].zc_done_id)
+                    DataPumpReapZeroCopy(&nodes[nodeindex], false);
+#endif
                 do 
                 {
                     data = GetData(nodes[nodeindex].buffer, &len);
                     if (data)
                     {
-                        ret = DataPumpRawSendData(&nodes[nodeindex], nodes[nodeindex].sock, data, len, &reason);                
+                        ret = DataPumpSendChunk(&nodes[nodeindex], control->pglz_ws, data, len, &reason);
                         if (EOF == ret)
                         {
                             /* We got error. */
@@ -4200,7 +5103,7 @@ void DataPumpSendLoop(DataPumpNodeControl  *nodes, DataPumpThreadControl* contro
                         if (reason == EAGAIN || reason == EWOULDBLOCK)
                         {
                             len = DataSize(nodes[nodeindex].buffer);
-                            if (len > 0)
+                            if (len > 0 || nodes[nodeindex].zlen)
                             {
                                 /* Break sending to the node, switch to the next one. */
                                 stuck_nodes++;
@@ -4262,7 +5165,7 @@ bool DataPumpFlushAllData(DataPumpNodeControl  *nodes, DataPumpThreadControl* co
                     data = GetData(nodes[nodeindex].buffer, &len);
                     if (data)
                     {
-                        ret = DataPumpRawSendData(&nodes[nodeindex], nodes[nodeindex].sock, data, len, &reason);                
+                        ret = DataPumpSendChunk(&nodes[nodeindex], control->pglz_ws, data, len, &reason);
                         if (EOF == ret)
                         {
                             /* We got error. */
@@ -4281,7 +5184,7 @@ bool DataPumpFlushAllData(DataPumpNodeControl  *nodes, DataPumpThreadControl* co
                         if (reason == EAGAIN || reason == EWOULDBLOCK)
                         {
                             len = DataSize(nodes[nodeindex].buffer);
-                            if (len > 0)
+                            if (len > 0 || nodes[nodeindex].zlen)
                             {
                                 /* Break sending to the node, switch to the next one. */
                                 stuck_nodes++;
@@ -4300,6 +5203,37 @@ bool DataPumpFlushAllData(DataPumpNodeControl  *nodes, DataPumpThreadControl* co
                             spinlock_unlock(&nodes[nodeindex].lock);
                             succeed = false;
                         }    
+                        else if (nodes[nodeindex].zlen)
+                        {
+                            /* The last compressed block is still on its way. */
+                            if (EOF == DataPumpSendPendingBlock(&nodes[nodeindex], &reason))
+                            {
+                                spinlock_lock(&nodes[nodeindex].lock);
+                                nodes[nodeindex].status  = DataPumpSndStatus_error;
+                                nodes[nodeindex].errorno = errno;
+                                spinlock_unlock(&nodes[nodeindex].lock);
+                                succeed = false;
+                                break;
+                            }
+                            if (nodes[nodeindex].zlen)
+                            {
+                                stuck_nodes++;
+                                break;
+                            }
+                            continue;
+                        }
+#ifdef USE_DATAPUMP_ZEROCOPY
+                        /* the buffer goes away after us, kernel must be done with it */
+                        else if (nodes[nodeindex].zc_next_id != nodes[nodeindex].zc_done_id &&
+                                 !DataPumpReapZeroCopy(&nodes[nodeindex], true))
+                        {
+                            spinlock_lock(&nodes[nodeindex].lock);
+                            nodes[nodeindex].status  = DataPumpSndStatus_error;
+                            nodes[nodeindex].errorno = errno;
+                            spinlock_unlock(&nodes[nodeindex].lock);
+                            succeed = false;
+                        }
+#endif
                         else
                         {
                             /* Job done, set status. */
@@ -4331,6 +5265,9 @@ void *DataPumpSenderThread(void *arg)
     thread = (DataPumpThreadControl*)arg;
     nodes  =  thread->nodes;
     ThreadSigmask();
+    /* failing to bind only costs locality */
+    if (thread->numa_bind)
+        (void) NumaBindThread(&thread->numa_cpus);
     thread->thread_running = true;
     while (1)
     {
@@ -4383,12 +5320,139 @@ static bool DataPumpNodeCheck(void *sndctl, int32 nodeindex)
     return true;
 }
 
+#ifdef USE_DATAPUMP_ZEROCOPY
+/*
+ * Process MSG_ZEROCOPY completion notifications of the node socket and
+ * release the buffer space of finished sends. If wait is true, keep waiting
+ * until all sends are done. Return false if the socket failed, or we gave up
+ * waiting.
+ */
+static bool
+DataPumpReapZeroCopy(DataPumpNodeControl *node, bool wait)
+{
+    int waited = 0;
+
+    while (node->zc_next_id != node->zc_done_id)
+    {
+        char            control[CMSG_SPACE(sizeof(struct sock_extended_err)) + 64];
+        struct msghdr   msg;
+        struct cmsghdr *cm;
+        int             ret;
+
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        ret = recvmsg(node->sock, &msg, MSG_ERRQUEUE | MSG_DONTWAIT);
+        if (ret < 0)
+        {
+            struct pollfd pfd;
+
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                return false;
+            if (!wait)
+                return true;
+            if (waited >= DATA_PUMP_ZC_MAX_WAIT_MS)
+            {
+                errno = ETIMEDOUT;
+                return false;
+            }
+
+            /* pending notifications are signalled as POLLERR */
+            pfd.fd = node->sock;
+            pfd.events = 0;
+            pfd.revents = 0;
+            (void) poll(&pfd, 1, DATA_PUMP_ZC_WAIT_MS);
+            waited += DATA_PUMP_ZC_WAIT_MS;
+            continue;
+        }
+
+        for (cm = CMSG_FIRSTHDR(&msg); cm != NULL; cm = CMSG_NXTHDR(&msg, cm))
+        {
+            struct sock_extended_err *serr;
+            uint32  id;
+            uint32  bytes = 0;
+
+            if (!((cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+                  (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR)))
+                continue;
+
+            serr = (struct sock_extended_err *) CMSG_DATA(cm);
+            if (serr->ee_errno != 0 || serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+                continue;
+
+            /* TCP reports completions in order, [ee_info, ee_data] inclusive */
+            for (id = node->zc_done_id; (int32) (serr->ee_data - id) >= 0; id++)
+                bytes += node->zc_len[id % DATA_PUMP_ZC_SLOTS];
+            node->zc_done_id = id;
+
+            spinlock_lock(&(node->buffer->pointerlock));
+            node->buffer->m_Inflight -= bytes;
+            spinlock_unlock(&(node->buffer->pointerlock));
+
+            /* the kernel had to copy anyway, stop paying for notifications */
+            if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+                node->zc_enabled = false;
+        }
+    }
+
+    return true;
+}
+#endif
+
 /* Return data write to the socket. */
 static int DataPumpRawSendData(DataPumpNodeControl *node, int32 sock, char *data, int32 len, int32 *reason)
 {
     int32  offset       = 0;
     int32  nbytes_write = 0;
 
+#ifdef USE_DATAPUMP_ZEROCOPY
+    /*
+     * Hand large chunks to the kernel without copying. The bytes stay
+     * accounted in m_Inflight and are not reused by the writer until the
+     * completion shows up.
+     */
+    while (node->zc_enabled && len - offset >= DATA_PUMP_ZC_MIN_SEND &&
+           data >= node->buffer->m_buf && data < node->buffer->m_buf + node->buffer->m_Length &&
+           node->zc_next_id - node->zc_done_id < DATA_PUMP_ZC_SLOTS)
+    {
+        nbytes_write = send(sock, data + offset, len - offset, MSG_ZEROCOPY);
+        if (nbytes_write <= 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == ENOBUFS)
+            {
+                /* out of optmem for pinned pages, copy this time */
+                break;
+            }
+            if (errno == EAGAIN ||
+                errno == EWOULDBLOCK)
+            {
+                pg_usleep(1000L);
+                node->sleep_count++;
+                node->stat->send_blocked++;
+                *reason = errno;
+                return offset;
+            }
+            node->stat->send_errors++;
+            *reason = errno;
+            return EOF;
+        }
+
+        /* must be accounted before our caller advances m_Tail */
+        spinlock_lock(&(node->buffer->pointerlock));
+        node->buffer->m_Inflight += nbytes_write;
+        spinlock_unlock(&(node->buffer->pointerlock));
+        node->zc_len[node->zc_next_id % DATA_PUMP_ZC_SLOTS] = nbytes_write;
+        node->zc_next_id++;
+        node->stat->send_bytes += nbytes_write;
+        offset += nbytes_write;
+    }
+#endif
+
     while (offset < len)
     {
         nbytes_write = send(sock, data + offset, len - offset, 0);
@@ -4408,18 +5472,126 @@ static int DataPumpRawSendData(DataPumpNodeControl *node, int32 sock, char *data
             {                
                 pg_usleep(1000L);
                 node->sleep_count++;
+                node->stat->send_blocked++;
                 *reason = errno;
                 return offset;
             }
+            node->stat->send_errors++;
             *reason = errno;
             return EOF;
         }
+        node->stat->send_bytes += nbytes_write;
         offset += nbytes_write;
     }
     
     return offset;
 }
 
+/*
+ * Push out what is left of the compressed block of the node. The block is
+ * gone once zlen drops back to zero.
+ */
+static int DataPumpSendPendingBlock(DataPumpNodeControl *node, int32 *reason)
+{
+    int ret = 0;
+
+    if (node->zoff >= node->zlen)
+    {
+        return 0;
+    }
+
+    ret = DataPumpRawSendData(node, node->sock, node->zbuf + node->zoff, node->zlen - node->zoff, reason);
+    if (EOF == ret)
+    {
+        return EOF;
+    }
+
+    node->zoff += ret;
+    if (node->zoff == node->zlen)
+    {
+        node->zoff = 0;
+        node->zlen = 0;
+    }
+    return 0;
+}
+
+/*
+ * Send a chunk returned by GetData, as one compressed 'z' message when that
+ * pays off. Only chunks starting and ending at a tuple border are candidates,
+ * so the receiver can splice the decompressed bytes back into its stream.
+ * Returns the number of chunk bytes consumed or EOF.
+ */
+static int DataPumpSendChunk(DataPumpNodeControl *node, PGLZ_Workspace *ws, char *data, uint32 len, int32 *reason)
+{
+    bool   wrap = false;
+    int32  clen = 0;
+    int    ret  = 0;
+    uint32 n32  = 0;
+
+    if (NULL == ws || NULL == node->zbuf)
+    {
+        return DataPumpRawSendData(node, node->sock, data, len, reason);
+    }
+
+    /* The previous block must be completely out first. */
+    if (EOF == DataPumpSendPendingBlock(node, reason))
+    {
+        return EOF;
+    }
+    if (node->zlen)
+    {
+        return 0;
+    }
+
+    /* A wrapped chunk stops at the end of the buffer, maybe inside a tuple. */
+    wrap = (data + len == node->buffer->m_buf + node->buffer->m_Length);
+    if (node->zsync && !wrap && len >= DATA_PUMP_Z_MIN_INPUT)
+    {
+        if (node->zskip > 0)
+        {
+            node->zskip--;
+        }
+        else
+        {
+            clen = pglz_compress_workspace(data, len, node->zbuf + DATA_PUMP_Z_HDRSZ,
+                                           PGLZ_strategy_default, ws);
+            if (clen >= 0)
+            {
+                node->zbuf[0] = 'z';
+                n32 = htonl((uint32) (clen + 8));
+                memcpy(node->zbuf + 1, &n32, 4);
+                n32 = htonl(len);
+                memcpy(node->zbuf + 5, &n32, 4);
+                node->zlen  = DATA_PUMP_Z_HDRSZ + clen;
+                node->zoff  = 0;
+                node->zfail = 0;
+
+                /* The raw bytes live on in zbuf, give them back to the writer. */
+                if (EOF == DataPumpSendPendingBlock(node, reason))
+                {
+                    return EOF;
+                }
+                return len;
+            }
+
+            /* Data does not compress, stop wasting cycles on it for a while. */
+            if (++node->zfail >= DATA_PUMP_Z_MAX_FAIL)
+            {
+                node->zfail = 0;
+                node->zskip = DATA_PUMP_Z_SKIP_CHUNKS;
+            }
+        }
+    }
+
+    ret = DataPumpRawSendData(node, node->sock, data, len, reason);
+    if (ret != EOF)
+    {
+        /* We are back at a tuple border only after sending up to m_Border. */
+        node->zsync = (ret == len && !wrap);
+    }
+    return ret;
+}
+
 bool
 DataPumpTupleStoreDump(void *sndctl, int32 nodeindex, int32 nodeId,
                                  TupleTableSlot *tmpslot, 
@@ -4517,6 +5689,8 @@ DataPumpTupleStoreDump(void *sndctl, int32 nodeindex, int32 nodeId,
             }
             else
             {
+                node->stat->spill_bytes += tmpslot->tts_datarow->msglen;
+
                 /* Big enough, send data. */
                 if (DataSize(node->buffer) > g_SndBatchSize * 1024)
                 {    
@@ -4547,6 +5721,7 @@ int32 DataPumpSendToNode(void *sndctl, char *data, size_t len, int32 nodeindex)
     bool                  long_tuple = false;
     int                   cursor     = 0;
     size_t                   tuple_len = 0;
+    TimestampTz           wait_start;
 
     DataPumpSenderControl *sender   = (DataPumpSenderControl*)sndctl;
     DataPumpNodeControl *node = &sender->nodes[nodeindex];
@@ -4565,6 +5740,7 @@ int32 DataPumpSendToNode(void *sndctl, char *data, size_t len, int32 nodeindex)
     
     if (FreeSpace(node->buffer) < (uint32)tuple_len)
     {
+        node->stat->full++;
         if (!long_tuple)
         {
             DataPumpWakeupSender(sndctl, nodeindex);
@@ -4602,6 +5778,7 @@ int32 DataPumpSendToNode(void *sndctl, char *data, size_t len, int32 nodeindex)
         }
         
         /* put message 'D' */
+        wait_start = GetCurrentTimestamp();
         while (data_len < header_len)
         {
             DataPumpWakeupSender(sndctl, nodeindex);
@@ -4653,9 +5830,12 @@ int32 DataPumpSendToNode(void *sndctl, char *data, size_t len, int32 nodeindex)
                 }
             }
         }
+        node->stat->full_wait_us += GetCurrentTimestamp() - wait_start;
     }
     
     node->ntuples++;
+    node->stat->rows++;
+    node->stat->bytes += tuple_len;
 
     return DataPumpOK;
 }
@@ -4736,7 +5916,6 @@ int32  DataPumpSendDataRow(void *sndctl, int32 nodeindex, int32 nodeId,  char *d
 bool DataPumpWaitSenderDone(void *sndctl, bool error)
 {// #lizard forgives
     bool                   succeed   = true;
-    bool                  ret       = 0;
     int32                   threadid  = 0;
     int32                 nodeindex = 0;
     DataPumpNodeControl   *node     = NULL;
@@ -4800,11 +5979,8 @@ bool DataPumpWaitSenderDone(void *sndctl, bool error)
 
     pfree(send_quit);
     
-    /* tell convert to exit */
-    ret = ConvertDone(&sender->convert_control);
-
-    if (succeed)
-        succeed = ret;
+    /* stop receiving consumer sockets */
+    DataPumpListenerDetach(sender);
 
     elog(DEBUG1, "Squeue:%s(Pid:%d), destroy %d sender, 1 convert.", sender->convert_control.sqname, MyProcPid, sender->thread_num);
     
@@ -4840,7 +6016,7 @@ void DataPumpCleanThread(DataPumpSenderControl *sender)
 		}
     }
 
-    ConvertDone(&sender->convert_control);    
+    DataPumpListenerDetach(sender);
 }
 
 /*
@@ -4864,6 +6040,16 @@ int32  DataPumpSetNodeSocket(void *sndctl, int32 nodeindex, int32 nodeId,  int32
 
     /* Use lock to check status and socket */
     socket_set_nonblocking(socket, true);
+#ifdef USE_DATAPUMP_ZEROCOPY
+    if (g_DataPumpZeroCopy)
+    {
+        int one = 1;
+
+        /* fails for sockets that don't support it, just copy then */
+        node->zc_enabled = (setsockopt(socket, SOL_SOCKET, SO_ZEROCOPY,
+                                       &one, sizeof(one)) == 0);
+    }
+#endif
     spinlock_lock(&node->lock);
     if (NO_SOCKET == node->sock && DataPumpSndStatus_no_socket == node->status)
     {
@@ -5103,21 +6289,38 @@ failure:
     return EOF;
 }
 
-/* send nodeid and consumerIdx to convert */
+/*
+ * Send nodeid, consumerIdx and our socket to the producer.  Parallel senders
+ * still listen on a socket of their own per queue, everybody else goes through
+ * the listener of the producer backend, naming the queue and waiting for the
+ * listener to confirm the queue is registered.
+ */
 static bool
-send_fd_with_nodeid(char *sqname, int nodeid, int consumerIdx)
+send_fd_with_nodeid(SharedQueue squeue, int nodeid, int consumerIdx)
 {// #lizard forgives
-    int fd;
-    int n32;
-    int ret;
-    int err;
-    
-    fd = convert_connect(sqname);
+    int  fd;
+    int  n32;
+    int  ret;
+    int  err;
+    char reply;
+    char name[MAX_CURSOR_LEN];
+    bool via_listener = !squeue->parallelWorkerSendTuple;
+
+    if (via_listener)
+    {
+        snprintf(name, MAX_CURSOR_LEN, DATA_PUMP_LISTENER_NAME, squeue->sq_pid);
+    }
+    else
+    {
+        snprintf(name, MAX_CURSOR_LEN, "%s", squeue->sq_key);
+    }
+
+    fd = convert_connect(name);
     if (fd < 0)
     {
         ereport(LOG,
                 (errmsg("could not connect to convert with cursor \"%s\", pid:%di to node %di",
-                        sqname, MyProcPid, nodeid)));
+                        squeue->sq_key, MyProcPid, nodeid)));
         return false;
     }
 
@@ -5160,6 +6363,28 @@ send_fd_with_nodeid(char *sqname, int nodeid, int consumerIdx)
             elog(ERROR, "could not send consumerIdx to convert, errmsg:%s.", strerror(err));
     }
 
+    /* send queue name, the listener serves all queues of the producer */
+    if (via_listener)
+    {
+        MemSet(name, 0, MAX_CURSOR_LEN);
+        snprintf(name, MAX_CURSOR_LEN, "%s", squeue->sq_key);
+        ret = send(fd, name, MAX_CURSOR_LEN, 0);
+        if(ret != MAX_CURSOR_LEN)
+        {
+            err = errno;
+
+            close(fd);
+
+            if (err == EPIPE || err == ECONNRESET)
+            {
+                elog(LOG, "could not send sqname to convert, errmsg:%s; producer may have finished work.", strerror(err));
+                return false;
+            }
+            else
+                elog(ERROR, "could not send sqname to convert, errmsg:%s.", strerror(err));
+        }
+    }
+
     /* send fd */
     if(convert_sendfds(fd, (int *)&MyProcPort->sock, 1, &err) != 0)
     {
@@ -5175,137 +6400,250 @@ send_fd_with_nodeid(char *sqname, int nodeid, int consumerIdx)
             elog(ERROR, "could not send sockfd to convert, errmsg:%s.", strerror(err));
     }
 
+    /* 
+     * The queue may not be registered yet, or not anymore if the producer has
+     * finished, the caller tells those apart by the consumer status.
+     */
+    if (via_listener)
+    {
+        ret = recv(fd, &reply, 1, 0);
+        if (ret != 1 || reply != DATA_PUMP_CONVERT_ATTACHED)
+        {
+            close(fd);
+            return false;
+        }
+    }
+
     close(fd);
 
     return true;
 }
 
+/*
+ * Start the convert listener of this backend unless it is running already.
+ * The socket is bound here rather than in the thread, consumers only have to
+ * retry while no sender has been registered for their queue.
+ */
+static bool
+DataPumpListenerStart(void)
+{
+    DataPumpListener *listener = g_DataPumpListener;
+    ConvertStatus     lstatus;
+    int               ret;
+
+    if (NULL == listener)
+    {
+        listener = (DataPumpListener *) MemoryContextAllocZero(TopMemoryContext,
+                                                               sizeof(DataPumpListener));
+        spinlock_init(&listener->lock);
+        listener->senders   = NULL;
+        listener->lstatus   = ConvertExit;
+        listener->listen_fd = -1;
+        snprintf(listener->sock_path, MAXPGPATH, "%s/"DATA_PUMP_LISTENER_NAME,
+                 DATA_PUMP_SOCKET_DIR, MyProcPid);
+        on_proc_exit(DataPumpListenerExit, (Datum) 0);
+        g_DataPumpListener = listener;
+    }
+
+    spinlock_lock(&listener->lock);
+    lstatus = listener->lstatus;
+    spinlock_unlock(&listener->lock);
+
+    if (ConvertRunning == lstatus)
+    {
+        return true;
+    }
+
+    /* the listener failed before, or a backend with our pid left its socket */
+    unlink(listener->sock_path);
+    listener->listen_fd = convert_listen(listener->sock_path, DATA_PUMP_LISTEN_BACKLOG);
+    if (listener->listen_fd < 0)
+    {
+        listener->errNO = errno;
+        elog(LOG, DATA_PUMP_PREFIX"listen on %s failed for %s", listener->sock_path, strerror(listener->errNO));
+        return false;
+    }
+
+    listener->lstatus = ConvertRunning;
+    ret = CreateThread(DataPumpListenerMain, (void *)listener, MT_THR_DETACHED);
+    if (ret)
+    {
+        close(listener->listen_fd);
+        unlink(listener->sock_path);
+        listener->listen_fd = -1;
+        listener->lstatus   = ConvertExit;
+        return false;
+    }
+
+    elog(DEBUG1, "Pid:%d start data pump listener on %s.", MyProcPid, listener->sock_path);
+    return true;
+}
+
+/*
+ * Register a sender so that the listener hands it the sockets of its queue.
+ */
+static bool
+DataPumpListenerAttach(DataPumpSenderControl *sender)
+{
+    DataPumpListener *listener = g_DataPumpListener;
+    bool              succeed  = false;
+
+    sender->convert_control.begin_stamp = GetCurrentTimestamp();
+
+    spinlock_lock(&listener->lock);
+    if (ConvertRunning == listener->lstatus)
+    {
+        sender->convert_control.cstatus = ConvertRunning;
+        sender->convert_next     = listener->senders;
+        listener->senders        = sender;
+        sender->convert_attached = true;
+        succeed = true;
+    }
+    spinlock_unlock(&listener->lock);
+
+    return succeed;
+}
+
+/*
+ * Unregister a sender.  Once we have the lock the listener is not using the
+ * sender anymore and never will, the caller is free to release it.
+ */
+static void
+DataPumpListenerDetach(DataPumpSenderControl *sender)
+{
+    DataPumpListener       *listener = g_DataPumpListener;
+    DataPumpSenderControl **prev     = NULL;
+
+    if (!sender->convert_attached)
+    {
+        return;
+    }
+
+    spinlock_lock(&listener->lock);
+    for (prev = &listener->senders; *prev; prev = &(*prev)->convert_next)
+    {
+        if (*prev == sender)
+        {
+            *prev = sender->convert_next;
+            break;
+        }
+    }
+    spinlock_unlock(&listener->lock);
+
+    sender->convert_next     = NULL;
+    sender->convert_attached = false;
+    sender->convert_control.finish_stamp = GetCurrentTimestamp();
+
+    elog(DEBUG1, "Squeue:%s establish connection cost %ld us, %d connections",
+                 sender->convert_control.sqname,
+                 sender->convert_control.finish_stamp - sender->convert_control.begin_stamp,
+                 sender->convert_control.connect_num);
+}
+
+/*
+ * The listener thread dies with the process, just remove its socket.
+ */
+static void
+DataPumpListenerExit(int code, Datum arg)
+{
+    if (g_DataPumpListener && g_DataPumpListener->listen_fd >= 0)
+    {
+        unlink(g_DataPumpListener->sock_path);
+    }
+}
+
 static void *
-ConvertThreadMain(void *arg)
+DataPumpListenerMain(void *arg)
 {// #lizard forgives
-#define SOCK_PATH_LEN 128
-    bool exit_flag = false;
     int nodeid;
     int consumerIdx;
     int sockfd;
-    int listen_fd;
     int con_fd;
-    int ret;
-    DataPumpSenderControl *control = NULL;
-    char sock_path[SOCK_PATH_LEN];
+    int err = 0;
+    char reply;
+    char sqname[MAX_CURSOR_LEN];
+    ConvertStatus status = ConvertExit;
+    DataPumpListener      *listener = (DataPumpListener *)arg;
+    DataPumpSenderControl *sender   = NULL;
 
     ThreadSigmask();
 
-    control = (DataPumpSenderControl *)arg;
-    control->convert_control.begin_stamp = GetCurrentTimestamp();
-    
-    snprintf(sock_path, SOCK_PATH_LEN, "%s/%s", DATA_PUMP_SOCKET_DIR, control->convert_control.sqname);
-    
-    listen_fd = convert_listen(sock_path, control->convert_control.maxConn);
-    if(listen_fd < 0)
-    {
-        control->convert_control.errNO = errno;
-        control->convert_control.cstatus = ConvertListenError;
-        return NULL;
-    }    
-
     while(true)
     {
-#if 0
-        if (control->convert_control.connect_num == (control->convert_control.maxConn - 1))
-        {
-            control->convert_control.finish_stamp = GetCurrentTimestamp();
-        }
-        
-        if (exit_flag && control->convert_control.connect_num == control->convert_control.maxConn)
-        {
-            close(listen_fd);
-            control->convert_control.cstatus = ConvertExit;
-            unlink(sock_path);
-            break;
-        }
-#endif
-        if (exit_flag)
-        {
-            control->convert_control.finish_stamp = GetCurrentTimestamp();
-            close(listen_fd);
-            control->convert_control.cstatus = ConvertExit;
-            unlink(sock_path);
-            break;
-        }
-        
-        con_fd = accept(listen_fd, NULL, NULL);
+        con_fd = accept(listener->listen_fd, NULL, NULL);
         if (con_fd < 0)
         {
-            close(listen_fd);
-            control->convert_control.errNO = errno;
-            control->convert_control.cstatus = ConvertAcceptError;
-            unlink(sock_path);
-            break;
-        }
-
-        control->convert_control.connect_num++;
-        
-        /* recv nodeid */
-        ret = recv(con_fd, (char *)&nodeid, 4, 0);
-        if(ret != 4)
-        {
-            close(con_fd);
-            close(listen_fd);
-            control->convert_control.errNO = errno;
-            control->convert_control.cstatus = ConvertRecvNodeidError;
-            unlink(sock_path);
+            if (errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+            err    = errno;
+            status = ConvertAcceptError;
             break;
         }
-        
-        nodeid = ntohl(nodeid);
 
-        if(nodeid == -1)
+        /* recv nodeid, consumer index, queue name and fd */
+        if (recv(con_fd, (char *)&nodeid, 4, MSG_WAITALL) != 4 ||
+            recv(con_fd, (char *)&consumerIdx, 4, MSG_WAITALL) != 4 ||
+            recv(con_fd, sqname, MAX_CURSOR_LEN, MSG_WAITALL) != MAX_CURSOR_LEN ||
+            convert_recvfds(con_fd, (int *)&sockfd, 1) != 0)
         {
-            exit_flag = true;
+            /* only this consumer is affected, it finds out by itself */
             close(con_fd);
             continue;
         }
 
-        /* recv consumer index  */
-        ret = recv(con_fd, (char *)&consumerIdx, 4, 0);
-        if(ret != 4)
-        {
-            close(con_fd);
-            close(listen_fd);
-            control->convert_control.errNO = errno;
-            control->convert_control.cstatus = ConvertRecvNodeindexError;
-            unlink(sock_path);
-            break;
-        }
-
+        nodeid      = ntohl(nodeid);
         consumerIdx = ntohl(consumerIdx);
+        sqname[MAX_CURSOR_LEN - 1] = '\0';
 
-        /* recv fd */
-        if(convert_recvfds(con_fd, (int *)&sockfd, 1) != 0)
+        reply = DATA_PUMP_CONVERT_NO_QUEUE;
+        spinlock_lock(&listener->lock);
+        for (sender = listener->senders; sender; sender = sender->convert_next)
         {
-            close(con_fd);
-            close(listen_fd);
-            control->convert_control.errNO   = errno;
-            control->convert_control.cstatus = ConvertRecvSockfdError;
-            unlink(sock_path);
-            break;
+            if (strcmp(sender->convert_control.sqname, sqname) == 0)
+            {
+                break;
+            }
         }
 
-        /* store nodeid, consumerIdx, sockfd */
-        if(DataPumpSetNodeSocket(arg, consumerIdx, nodeid, sockfd) != DataPumpOK)
+        if (sender)
         {
-            close(con_fd);
-            close(listen_fd);
-            control->convert_control.cstatus = ConvertSetSockfdError;
-            unlink(sock_path);
-            break;
+            sender->convert_control.connect_num++;
+
+            /* store nodeid, consumerIdx, sockfd */
+            if (DataPumpSetNodeSocket(sender, consumerIdx, nodeid, sockfd) != DataPumpOK)
+            {
+                sender->convert_control.cstatus = ConvertSetSockfdError;
+                close(sockfd);
+            }
+            reply = DATA_PUMP_CONVERT_ATTACHED;
+        }
+        else
+        {
+            close(sockfd);
         }
+        spinlock_unlock(&listener->lock);
 
+        /* SIGPIPE is blocked, a consumer gone meanwhile just fails the send */
+        send(con_fd, &reply, 1, 0);
         close(con_fd);
     }
 
-    ThreadSemaUp(&control->convert_control.quit_sem);
+    /* fail the registered senders, the next sender starts a new listener */
+    spinlock_lock(&listener->lock);
+    close(listener->listen_fd);
+    unlink(listener->sock_path);
+    listener->listen_fd = -1;
+    listener->errNO     = err;
+    listener->lstatus   = status;
+    for (sender = listener->senders; sender; sender = sender->convert_next)
+    {
+        sender->convert_control.errNO   = err;
+        sender->convert_control.cstatus = status;
+    }
+    spinlock_unlock(&listener->lock);
+
     return NULL;
 }
 
@@ -5697,6 +7035,7 @@ SendDataRemote(SharedQueue squeue, int32 consumerIdx, TupleTableSlot *slot, Tupl
     in_data_pump = false;
 
     node->ntuples_put++;
+    node->stat->spill_rows++;
     
     return;
 
@@ -5736,6 +7075,59 @@ bool socket_set_nonblocking(int fd, bool non_block)
     return true;
 }
 
+/*
+ * GetDataRowOutputInfo
+ *    Return output function info for the specified tuple descriptor, building
+ *    it if the cached info was made for another descriptor.
+ */
+static DataRowOutputInfo *
+GetDataRowOutputInfo(TupleDesc tdesc)
+{
+    DataRowOutputInfo *info = &datarow_output_info;
+    MemoryContext      oldcxt;
+    int                i;
+
+    if (info->tdesc == tdesc && info->natts == tdesc->natts)
+    {
+        for (i = 0; i < tdesc->natts; i++)
+        {
+            if (info->atttypids[i] != tdesc->attrs[i]->atttypid)
+                break;
+        }
+        if (i == tdesc->natts)
+            return info;
+    }
+
+    if (info->mcxt == NULL)
+        info->mcxt = AllocSetContextCreate(TopMemoryContext,
+                                           "DataRow output info",
+                                           ALLOCSET_SMALL_SIZES);
+    else
+        MemoryContextReset(info->mcxt);
+
+    oldcxt = MemoryContextSwitchTo(info->mcxt);
+    info->natts = tdesc->natts;
+    info->atttypids = (Oid *) palloc0(Max(tdesc->natts, 1) * sizeof(Oid));
+    info->finfo = (FmgrInfo *) palloc0(Max(tdesc->natts, 1) * sizeof(FmgrInfo));
+    info->isvarlena = (bool *) palloc0(Max(tdesc->natts, 1) * sizeof(bool));
+    MemoryContextSwitchTo(oldcxt);
+
+    /* don't leave half built info behind if a lookup fails */
+    info->tdesc = NULL;
+    for (i = 0; i < tdesc->natts; i++)
+    {
+        Oid typOutput;
+
+        getTypeOutputInfo(tdesc->attrs[i]->atttypid, &typOutput,
+                          &info->isvarlena[i]);
+        fmgr_info_cxt(typOutput, &info->finfo[i], info->mcxt);
+        info->atttypids[i] = tdesc->attrs[i]->atttypid;
+    }
+    info->tdesc = tdesc;
+
+    return info;
+}
+
 bool
 ExecFastSendDatarow(TupleTableSlot *slot, void *sndctl, int32 nodeindex, MemoryContext tmpcxt)
 {// #lizard forgives
@@ -5748,6 +7140,7 @@ ExecFastSendDatarow(TupleTableSlot *slot, void *sndctl, int32 nodeindex, MemoryC
     DataPumpSenderControl *sender   = NULL;
     DataPumpNodeControl   *node     = NULL;
     TupleDesc         tdesc = slot->tts_tupleDescriptor;
+    DataRowOutputInfo *outinfo = NULL;
     StringInfoData      data;
     uint32 head = 0;
 
@@ -5803,6 +7196,7 @@ ExecFastSendDatarow(TupleTableSlot *slot, void *sndctl, int32 nodeindex, MemoryC
         
         /* ensure we have all values */
         slot_getallattrs(slot);
+        outinfo = GetDataRowOutputInfo(tdesc);
         
         /* if temporary memory context is specified reset it */
         if (tmpcxt)
@@ -5909,14 +7303,13 @@ ExecFastSendDatarow(TupleTableSlot *slot, void *sndctl, int32 nodeindex, MemoryC
             {
                 Form_pg_attribute attr = tdesc->attrs[i];
                 uint32  reserve_len  = 0;
-                Oid        typOutput;
                 bool    typIsVarlena;
                 Datum    pval;
                 char   *pstring;
                 int        len;
 
                 /* Get info needed to output the value */
-                getTypeOutputInfo(attr->atttypid, &typOutput, &typIsVarlena);
+                typIsVarlena = outinfo->isvarlena[i];
                 /*
                  * If we have a toasted datum, forcibly detoast it here to avoid
                  * memory leakage inside the type's output routine.
@@ -6104,7 +7497,7 @@ ExecFastSendDatarow(TupleTableSlot *slot, void *sndctl, int32 nodeindex, MemoryC
                 }
                 
                 /* Convert Datum to string */
-                pstring = OidOutputFunctionCall(typOutput, pval);
+                pstring = OutputFunctionCall(&outinfo->finfo[i], pval);
 
                 /* copy data to the buffer */
                 len = strlen(pstring);
@@ -6305,11 +7698,14 @@ ExecFastSendDatarow(TupleTableSlot *slot, void *sndctl, int32 nodeindex, MemoryC
         
         node->ntuples++;
         node->nfast_send++;
+        node->stat->rows++;
+        node->stat->bytes += write_len;
         return true;
     }
     else
     {
         /* Not enough space, wakeup sender. */
+        node->stat->full++;
         DataPumpWakeupSender(sndctl, nodeindex);
         if (!DataPumpNodeCheck(sndctl, nodeindex))
         {
@@ -8126,6 +9522,7 @@ ParallelFastSendDatarow(ParallelSendDataQueue *buf, TupleTableSlot *slot, void *
     int             i                = 0;
     ParallelWorkerControl *control  = NULL;
     TupleDesc         tdesc = slot->tts_tupleDescriptor;
+    DataRowOutputInfo *outinfo = NULL;
     uint32 head = 0;
     uint32 tail PG_USED_FOR_ASSERTS_ONLY = 0;
     StringInfoData        data;
@@ -8181,6 +9578,7 @@ ParallelFastSendDatarow(ParallelSendDataQueue *buf, TupleTableSlot *slot, void *
         
         /* ensure we have all values */
         slot_getallattrs(slot);
+        outinfo = GetDataRowOutputInfo(tdesc);
 
         /* if temporary memory context is specified reset it */
         if (tmpcxt)
@@ -8271,14 +9669,13 @@ ParallelFastSendDatarow(ParallelSendDataQueue *buf, TupleTableSlot *slot, void *
             {
                 Form_pg_attribute attr = tdesc->attrs[i];
                 uint32  reserve_len  = 0;
-                Oid        typOutput;
                 bool    typIsVarlena;
                 Datum    pval;
                 char   *pstring;
                 int        len;
 
                 /* Get info needed to output the value */
-                getTypeOutputInfo(attr->atttypid, &typOutput, &typIsVarlena);
+                typIsVarlena = outinfo->isvarlena[i];
                 /*
                  * If we have a toasted datum, forcibly detoast it here to avoid
                  * memory leakage inside the type's output routine.
@@ -8452,7 +9849,7 @@ ParallelFastSendDatarow(ParallelSendDataQueue *buf, TupleTableSlot *slot, void *
                 }
 
                 /* Convert Datum to string */
-                pstring = OidOutputFunctionCall(typOutput, pval);
+                pstring = OutputFunctionCall(&outinfo->finfo[i], pval);
 
                 /* copy data to the buffer */
                 len = strlen(pstring);
@@ -9444,6 +10841,146 @@ int PipeLength(PGPipe *pPipe)
 
 #endif
 
+#ifdef __TBASE__
+/*
+ * Prepare a materialize mode result set for the shared queue functions.
+ */
+static Tuplestorestate *
+SharedQueueStatBegin(FunctionCallInfo fcinfo, TupleDesc *tupdesc)
+{
+    ReturnSetInfo   *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+    Tuplestorestate *tupstore;
+    MemoryContext    oldcontext;
+
+    if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo))
+        ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                 errmsg("set-valued function called in context that cannot accept a set")));
+    if (!(rsinfo->allowedModes & SFRM_Materialize))
+        ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                 errmsg("materialize mode required, but it is not " \
+                        "allowed in this context")));
+
+    if (get_call_result_type(fcinfo, NULL, tupdesc) != TYPEFUNC_COMPOSITE)
+        elog(ERROR, "return type must be a row type");
+
+    oldcontext = MemoryContextSwitchTo(rsinfo->econtext->ecxt_per_query_memory);
+    *tupdesc = CreateTupleDescCopy(*tupdesc);
+    tupstore = tuplestore_begin_heap(true, false, work_mem);
+    rsinfo->returnMode = SFRM_Materialize;
+    rsinfo->setResult = tupstore;
+    rsinfo->setDesc = *tupdesc;
+    MemoryContextSwitchTo(oldcontext);
+
+    return tupstore;
+}
+
+/* Put the counters into values starting at index off */
+static void
+SharedQueueStatValues(SQueueStat *stat, Datum *values, int off)
+{
+    values[off++] = Int64GetDatum((int64) stat->rows);
+    values[off++] = Int64GetDatum((int64) stat->bytes);
+    values[off++] = Int64GetDatum((int64) stat->full);
+    values[off++] = Int64GetDatum((int64) stat->full_wait_us);
+    values[off++] = Int64GetDatum((int64) stat->read_wait_us);
+    values[off++] = Int64GetDatum((int64) stat->spill_rows);
+    values[off++] = Int64GetDatum((int64) stat->spill_bytes);
+    values[off++] = Int64GetDatum((int64) stat->send_bytes);
+    values[off++] = Int64GetDatum((int64) stat->send_blocked);
+    values[off++] = Int64GetDatum((int64) stat->send_errors);
+}
+
+/*
+ * pg_stat_get_squeues - one row per consumer of every shared queue which
+ * currently exists on this node, with its throughput counters.
+ */
+Datum
+pg_stat_get_squeues(PG_FUNCTION_ARGS)
+{
+#define PG_STAT_GET_SQUEUES_COLS    18
+    static const char *status_names[] = {"active", "eof", "error", "done"};
+    TupleDesc        tupdesc;
+    Tuplestorestate *tupstore = SharedQueueStatBegin(fcinfo, &tupdesc);
+    HASH_SEQ_STATUS  hash_seq;
+    SharedQueue      sq;
+
+    LWLockAcquire(SQueuesLock, LW_SHARED);
+
+    hash_seq_init(&hash_seq, SharedQueues);
+    while ((sq = (SharedQueue) hash_seq_search(&hash_seq)) != NULL)
+    {
+        int i;
+
+        for (i = 0; i < sq->sq_nconsumers; i++)
+        {
+            ConsState  *cstate = &sq->sq_consumers[i];
+            Datum       values[PG_STAT_GET_SQUEUES_COLS];
+            bool        nulls[PG_STAT_GET_SQUEUES_COLS];
+            int         status = cstate->cs_status;
+
+            MemSet(nulls, false, sizeof(nulls));
+            values[0] = CStringGetTextDatum(sq->sq_key);
+            values[1] = Int32GetDatum(sq->sq_pid);
+            values[2] = Int32GetDatum(sq->sq_nodeid);
+            values[3] = Int32GetDatum(i);
+            values[4] = Int32GetDatum(cstate->cs_node);
+            values[5] = Int32GetDatum(cstate->cs_pid);
+            if (status >= CONSUMER_ACTIVE && status <= CONSUMER_DONE)
+                values[6] = CStringGetTextDatum(status_names[status]);
+            else
+                nulls[6] = true;
+            values[7] = Int32GetDatum(cstate->cs_ntuples);
+            SharedQueueStatValues(&cstate->cs_stat, values, 8);
+
+            tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+        }
+    }
+
+    LWLockRelease(SQueuesLock);
+
+    tuplestore_donestoring(tupstore);
+    return (Datum) 0;
+}
+
+/*
+ * pg_stat_get_squeue_nodes - throughput counters of the shared queues which
+ * already went away, summed up per consumer node.
+ */
+Datum
+pg_stat_get_squeue_nodes(PG_FUNCTION_ARGS)
+{
+#define PG_STAT_GET_SQUEUE_NODES_COLS    11
+    TupleDesc        tupdesc;
+    Tuplestorestate *tupstore = SharedQueueStatBegin(fcinfo, &tupdesc);
+    int              i;
+
+    LWLockAcquire(SQueuesLock, LW_SHARED);
+
+    for (i = 0; i < TBASE_MAX_DATANODE_NUMBER; i++)
+    {
+        SQueueStat *stat = &SQueueNodeStats[i];
+        Datum       values[PG_STAT_GET_SQUEUE_NODES_COLS];
+        bool        nulls[PG_STAT_GET_SQUEUE_NODES_COLS];
+
+        if (stat->rows == 0 && stat->full == 0 && stat->send_errors == 0)
+            continue;
+
+        MemSet(nulls, false, sizeof(nulls));
+        values[0] = Int32GetDatum(i);
+        SharedQueueStatValues(stat, values, 1);
+
+        tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+    }
+
+    LWLockRelease(SQueuesLock);
+
+    tuplestore_donestoring(tupstore);
+    return (Datum) 0;
+}
+#endif
+
 const char *
 SqueueName(SharedQueue sq)
 {
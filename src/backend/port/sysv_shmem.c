@@ -36,6 +36,7 @@
 #include "storage/dsm.h"
 #include "storage/fd.h"
 #include "storage/ipc.h"
+#include "storage/numa.h"
 #include "storage/pg_shmem.h"
 #include "utils/guc.h"
 #include "utils/pidfile.h"
@@ -78,6 +79,9 @@ void       *UsedShmemSegAddr = NULL;
 #ifdef USE_ANONYMOUS_SHMEM
 static Size AnonymousShmemSize;
 static void *AnonymousShmem = NULL;
+#ifdef __TBASE__
+static bool AnonymousShmemHuge = false;
+#endif
 #endif
 
 static void *InternalIpcMemoryCreate(IpcMemoryKey memKey, Size size);
@@ -483,6 +487,9 @@ CreateAnonymousSegment(Size *size)
         if (huge_pages == HUGE_PAGES_TRY && ptr == MAP_FAILED)
             elog(DEBUG1, "mmap(%zu) with MAP_HUGETLB failed, huge pages disabled: %m",
                  allocsize);
+#ifdef __TBASE__
+        AnonymousShmemHuge = (ptr != MAP_FAILED);
+#endif
     }
 #endif
 
@@ -580,6 +587,30 @@ PGSharedMemoryCreate(Size size, bool makePrivate, int port,
     AnonymousShmem = CreateAnonymousSegment(&size);
     AnonymousShmemSize = size;
 
+#ifdef __TBASE__
+    /*
+     * Interleave the segment across NUMA nodes before anything touches it,
+     * so that shared_buffers and the shared queues don't all end up on the
+     * node the postmaster runs on.
+     */
+    if (numa_shared_memory)
+    {
+        int            nnodes = NumaNumNodes();
+
+        if (nnodes <= 1)
+            ereport(LOG,
+                    (errmsg("numa_shared_memory has no effect on a single NUMA node")));
+        else if (!NumaInterleaveMemory(AnonymousShmem, size))
+            ereport(WARNING,
+                    (errmsg("could not interleave shared memory across NUMA nodes: %m")));
+        else
+            ereport(LOG,
+                    (errmsg("shared memory segment of %zu MB interleaved across %d NUMA nodes, using %s pages",
+                            size / (1024 * 1024), nnodes,
+                            AnonymousShmemHuge ? "huge" : "normal")));
+    }
+#endif
+
     /* Register on-exit routine to unmap the anonymous segment */
     on_shmem_exit(AnonymousShmemDetach, (Datum) 0);
 
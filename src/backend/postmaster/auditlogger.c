@@ -151,6 +151,7 @@ typedef struct AuditLogQueue
 	slock_t					q_lock;
 	volatile int			q_head;
 	volatile int			q_tail;
+	pg_atomic_uint32		q_dropped;	/* records dropped since last reported */
 	char					q_area[FLEXIBLE_ARRAY_MEMBER];
 } AlogQueue;
 
@@ -248,6 +249,7 @@ int							Maintain_trace_log_cache_size_kb = 64;
  */
 bool                        am_auditlogger = false;
 bool                        enable_auditlogger_warning = false;
+int							AuditLog_queue_full_action = ALOG_QUEUE_FULL_WAIT;
 
 /*
  * Logger Private state
@@ -353,6 +355,7 @@ static bool     alog_queue_pushn(AlogQueue * queue, char * buff[], int len[], in
 static int         alog_queue_get_str_len(AlogQueue * queue, int offset);
 static bool     alog_queue_pop_to_queue(AlogQueue * from, AlogQueue * to);
 static bool     alog_queue_pop_to_file(AlogQueue * from, int destination);
+static bool     alog_queue_report_dropped(AlogQueue * from, AlogQueue * to);
 #endif
 
 #ifdef AuditLog_005_For_ThreadWorker
@@ -1828,6 +1831,7 @@ static void alog_queue_init(AlogQueue * queue, int queue_size_kb)
     SpinLockInit(&(queue->q_lock));
     queue->q_head = 0;
     queue->q_tail = 0;
+    pg_atomic_init_u32(&(queue->q_dropped), 0);
     MemSet(queue->q_area, 0, queue->q_size);
 }
 
@@ -2105,6 +2109,38 @@ static int alog_queue_get_str_len(AlogQueue * queue, int offset)
     return len;
 }
 
+/*
+ * put a record telling how many records the backend of from dropped
+ * into to, see AuditLog_queue_full_action
+ */
+static bool alog_queue_report_dropped(AlogQueue * from, AlogQueue * to)
+{
+	char buff[128];
+	uint32 dropped = pg_atomic_read_u32(&(from->q_dropped));
+	int len = 0;
+
+	if (dropped == 0)
+	{
+		return false;
+	}
+
+	/* |<- strlen value ->|<- string message content ->| */
+	len = snprintf(buff + sizeof(int), sizeof(buff) - sizeof(int),
+				   "audit log queue of backend %d was full, %u audit records dropped\n",
+				   (int) from->q_pid, dropped);
+	memcpy(buff, (char *)(&len), sizeof(int));
+
+	if (!alog_queue_push(to, buff, sizeof(int) + len))
+	{
+		/* try again next time */
+		return false;
+	}
+
+	pg_atomic_fetch_sub_u32(&(from->q_dropped), dropped);
+
+	return true;
+}
+
 /*
  * copy message from queue to another as much as possible
  *
@@ -2601,6 +2637,7 @@ static void * alog_consumer_main(void * arg)
 			if (sharedIdx < MaxBackends)
 			{
 				bool local_is_empty = false;
+				bool reported = false;
 
 				/* get shared common queue entry from AuditCommonLogQueueArray */
 				shared_common_queue = alog_get_shared_common_queue(sharedIdx);
@@ -2618,7 +2655,8 @@ static void * alog_consumer_main(void * arg)
 				}
 
 				/* read from shared queue, and write to local cache queue */
-				if (alog_queue_pop_to_queue(shared_common_queue, local_common_cache))
+				reported = alog_queue_report_dropped(shared_common_queue, local_common_cache);
+				if (alog_queue_pop_to_queue(shared_common_queue, local_common_cache) || reported)
 				{
 					if (local_is_empty)
 					{
@@ -2632,7 +2670,8 @@ static void * alog_consumer_main(void * arg)
 					local_is_empty = true;
 				}
 
-				if (alog_queue_pop_to_queue(shared_fga_queue, local_fga_cache))
+				reported = alog_queue_report_dropped(shared_fga_queue, local_fga_cache);
+				if (alog_queue_pop_to_queue(shared_fga_queue, local_fga_cache) || reported)
 				{
 					if (local_is_empty)
 					{
@@ -2646,7 +2685,8 @@ static void * alog_consumer_main(void * arg)
 					local_is_empty = true;
 				}
 
-				if (alog_queue_pop_to_queue(shared_trace_queue, local_trace_cache))
+				reported = alog_queue_report_dropped(shared_trace_queue, local_trace_cache);
+				if (alog_queue_pop_to_queue(shared_trace_queue, local_trace_cache) || reported)
 				{
 					if (local_is_empty)
 					{
@@ -2971,6 +3011,14 @@ void alog(int destination, const char *fmt,...)
 			SendPostmasterSignal(PMSIGNAL_WAKEN_AUDIT_LOGGER);
 		}
 
+		/* the consumer reports the count the next time it reads the queue */
+		if (AuditLog_queue_full_action == ALOG_QUEUE_FULL_DROP)
+		{
+			pg_atomic_fetch_add_u32(&(queue->q_dropped), 1);
+			pfree(buf.data);
+			return;
+		}
+
 		pg_usleep(AUDIT_SLEEP_MICROSEC);
 	}
 
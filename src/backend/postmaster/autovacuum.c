@@ -200,6 +200,18 @@ typedef struct av_relation
                                  * reloptions, or NULL if none */
 } av_relation;
 
+/*
+ * struct to order the tables found in the 1st pass: those at risk of
+ * wraparound go first, oldest first, then by fraction of dead tuples
+ */
+typedef struct av_candidate
+{
+    Oid            ac_relid;
+    bool        ac_wraparound;
+    uint32        ac_xid_age;        /* age of relfrozenxid */
+    float4        ac_dead_frac;    /* dead tuples per live tuple */
+} av_candidate;
+
 /* struct to keep track of tables to vacuum and/or analyze, after rechecking */
 typedef struct autovac_table
 {
@@ -343,6 +355,7 @@ static void launch_worker(TimestampTz now);
 static List *get_database_list(void);
 static void rebuild_database_list(Oid newdb);
 static int    db_comparator(const void *a, const void *b);
+static int    av_candidate_comparator(const void *a, const void *b);
 static void autovac_balance_cost(void);
 
 static void do_autovacuum(void);
@@ -1995,6 +2008,25 @@ get_database_list(void)
     return dblist;
 }
 
+/*
+ * qsort comparator for av_candidate, in the order the tables should be
+ * processed
+ */
+static int
+av_candidate_comparator(const void *a, const void *b)
+{
+    const av_candidate *ca = (const av_candidate *) a;
+    const av_candidate *cb = (const av_candidate *) b;
+
+    if (ca->ac_wraparound != cb->ac_wraparound)
+        return ca->ac_wraparound ? -1 : 1;
+    if (ca->ac_wraparound && ca->ac_xid_age != cb->ac_xid_age)
+        return (ca->ac_xid_age > cb->ac_xid_age) ? -1 : 1;
+    if (ca->ac_dead_frac != cb->ac_dead_frac)
+        return (ca->ac_dead_frac > cb->ac_dead_frac) ? -1 : 1;
+    return 0;
+}
+
 /*
  * Process a database table-by-table
  *
@@ -2010,6 +2042,10 @@ do_autovacuum(void)
     Form_pg_database dbForm;
     List       *table_oids = NIL;
 	List	   *interval_parent_oids = NIL;
+    av_candidate *candidates;
+    int            ncandidates = 0;
+    int            maxcandidates = 64;
+    int            i;
     List       *orphan_oids = NIL;
     HASHCTL        ctl;
     HTAB       *table_toast_map;
@@ -2119,6 +2155,7 @@ do_autovacuum(void)
      * TOAST table than in its parent.
      */
     relScan = heap_beginscan_catalog(classRel, 0, NULL);
+    candidates = (av_candidate *) palloc(maxcandidates * sizeof(av_candidate));
 
     /*
      * On the first pass, we collect main tables to vacuum, and also the main
@@ -2186,7 +2223,21 @@ do_autovacuum(void)
 			}
 			else 
 			{
-				table_oids = lappend_oid(table_oids, relid);
+                av_candidate *cand;
+
+                if (ncandidates >= maxcandidates)
+                {
+                    maxcandidates *= 2;
+                    candidates = (av_candidate *)
+                        repalloc(candidates, maxcandidates * sizeof(av_candidate));
+                }
+                cand = &candidates[ncandidates++];
+                cand->ac_relid = relid;
+                cand->ac_wraparound = wraparound;
+                cand->ac_xid_age = TransactionIdIsNormal(classForm->relfrozenxid) ?
+                    (uint32) (recentXid - classForm->relfrozenxid) : 0;
+                cand->ac_dead_frac = tabentry ?
+                    tabentry->n_dead_tuples / Max(classForm->reltuples, 1) : 0;
 			}
 		}
 
@@ -2219,6 +2270,16 @@ do_autovacuum(void)
         }
     }
 
+    /*
+     * Work on the tables in order of urgency rather than pg_class order, so
+     * that busy tables, typically the current interval partitions, do not
+     * wait behind many old partitions which only need a little work.
+     */
+    qsort(candidates, ncandidates, sizeof(av_candidate), av_candidate_comparator);
+    for (i = 0; i < ncandidates; i++)
+        table_oids = lappend_oid(table_oids, candidates[i].ac_relid);
+    pfree(candidates);
+
 	table_oids = list_concat(table_oids, interval_parent_oids);
 
     heap_endscan(relScan);
@@ -2754,6 +2815,10 @@ perform_work_item(AutoVacuumWorkItem *workitem)
                                     ObjectIdGetDatum(workitem->avw_relation),
                                     Int64GetDatum((int64) workitem->avw_blockNumber));
                 break;
+            case AVW_GINCleanPendingList:
+                DirectFunctionCall1(gin_clean_pending_list,
+                                    ObjectIdGetDatum(workitem->avw_relation));
+                break;
             default:
                 elog(WARNING, "unrecognized work item found: type %d",
                      workitem->avw_type);
@@ -2840,6 +2905,13 @@ get_pgstat_tabentry_relid(Oid relid, bool isshared, PgStat_StatDBEntry *shared,
 {
     PgStat_StatTabEntry *tabentry = NULL;
 
+#ifdef __TBASE__
+    tabentry = pgstat_fetch_shared_tabentry(isshared ? InvalidOid : MyDatabaseId,
+                                            relid);
+    if (tabentry != NULL)
+        return tabentry;
+#endif
+
     if (isshared)
     {
         if (PointerIsValid(shared))
@@ -3267,6 +3339,10 @@ autovac_report_workitem(AutoVacuumWorkItem *workitem,
             snprintf(activity, MAX_AUTOVAC_ACTIV_LEN,
                      "autovacuum: BRIN summarize");
             break;
+        case AVW_GINCleanPendingList:
+            snprintf(activity, MAX_AUTOVAC_ACTIV_LEN,
+                     "autovacuum: GIN pending list cleanup");
+            break;
     }
 
     /*
@@ -3303,8 +3379,9 @@ AutoVacuumingActive(void)
 
 /*
  * Request one work item to the next autovacuum run processing our database.
+ * Returns false if the request could not be queued.
  */
-void
+bool
 AutoVacuumRequestWork(AutoVacuumWorkItemType type, Oid relationId,
                       BlockNumber blkno)
 {
@@ -3314,11 +3391,6 @@ AutoVacuumRequestWork(AutoVacuumWorkItemType type, Oid relationId,
 
     LWLockAcquire(AutovacuumLock, LW_EXCLUSIVE);
 
-    /*
-     * It may be useful to de-duplicate the list upon insertion.  For the only
-     * currently existing caller, this is not necessary.
-     */
-
     /* First use in this process?  Set up DSA */
     if (!AutoVacuumDSA)
     {
@@ -3326,7 +3398,7 @@ AutoVacuumRequestWork(AutoVacuumWorkItemType type, Oid relationId,
         {
             /* autovacuum launcher not started; nothing can be done */
             LWLockRelease(AutovacuumLock);
-            return;
+            return false;
         }
         AutoVacuumDSA = dsa_attach(AutoVacuumShmem->av_dsa_handle);
         dsa_pin_mapping(AutoVacuumDSA);
@@ -3349,7 +3421,7 @@ AutoVacuumRequestWork(AutoVacuumWorkItemType type, Oid relationId,
             LWLockRelease(AutovacuumLock);
             dsa_detach(AutoVacuumDSA);
             AutoVacuumDSA = NULL;
-            return;
+            return false;
         }
 
         /* Initialize each array entry as a member of the free list */
@@ -3378,13 +3450,38 @@ AutoVacuumRequestWork(AutoVacuumWorkItemType type, Oid relationId,
     workitems = (AutovacWorkItems *)
         dsa_get_address(AutoVacuumDSA, AutoVacuumShmem->av_workitems);
 
+    /*
+     * GIN pending list cleanups are requested over and over by inserters
+     * until a worker gets to them; one queued item per index is enough.  An
+     * item already being processed doesn't count, it may have stopped short
+     * of the newest pending pages.
+     */
+    if (type == AVW_GINCleanPendingList)
+    {
+        for (wi_ptr = workitems->avs_usedItems; wi_ptr != InvalidDsaPointer;
+             wi_ptr = workitem->avw_next)
+        {
+            workitem = dsa_get_address(AutoVacuumDSA, wi_ptr);
+            if (workitem->avw_type == type &&
+                workitem->avw_database == MyDatabaseId &&
+                workitem->avw_relation == relationId &&
+                !workitem->avw_active)
+            {
+                LWLockRelease(AutovacuumLock);
+                dsa_detach(AutoVacuumDSA);
+                AutoVacuumDSA = NULL;
+                return true;
+            }
+        }
+    }
+
     /* If array is full, disregard the request */
     if (workitems->avs_freeItems == InvalidDsaPointer)
     {
         LWLockRelease(AutovacuumLock);
         dsa_detach(AutoVacuumDSA);
         AutoVacuumDSA = NULL;
-        return;
+        return false;
     }
 
     /* remove workitem struct from free list ... */
@@ -3406,6 +3503,8 @@ AutoVacuumRequestWork(AutoVacuumWorkItemType type, Oid relationId,
 
     dsa_detach(AutoVacuumDSA);
     AutoVacuumDSA = NULL;
+
+    return true;
 }
 
 /*
@@ -78,8 +78,10 @@
 #include "access/parallel.h"
 #include "miscadmin.h"
 #include "pgstat.h"
+#include "pgxc/globaldeadlock.h"
 #include "port/atomics.h"
 #include "postmaster/bgworker_internals.h"
+#include "postmaster/ckptwriter.h"
 #include "postmaster/postmaster.h"
 #include "replication/logicallauncher.h"
 #include "replication/logicalworker.h"
@@ -198,6 +200,14 @@ static const struct
     {
         "ApplyWorkerMain", ApplyWorkerMain
     }
+#ifdef __TBASE__
+    ,{
+        "CheckpointWriterMain", CheckpointWriterMain
+    }
+    ,{
+        "GlobalDeadlockDetectorMain", GlobalDeadlockDetectorMain
+    }
+#endif
 #ifdef __AUDIT_FGA__
     ,{
         "ApplyAuditFgaMain", ApplyAuditFgaMain
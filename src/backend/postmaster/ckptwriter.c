@@ -0,0 +1,470 @@
+/*
+ * Tencent is pleased to support the open source community by making TBase available.  
+ * 
+ * Copyright (C) 2019 THL A29 Limited, a Tencent company.  All rights reserved.
+ * 
+ * TBase is licensed under the BSD 3-Clause License, except for the third-party component listed below. 
+ * 
+ * A copy of the BSD 3-Clause License is included in this file.
+ * 
+ * Other dependencies and licenses:
+ * 
+ * Open Source Software Licensed Under the PostgreSQL License: 
+ * --------------------------------------------------------------------
+ * 1. Postgres-XL XL9_5_STABLE
+ * Portions Copyright (c) 2015-2016, 2ndQuadrant Ltd
+ * Portions Copyright (c) 2012-2015, TransLattice, Inc.
+ * Portions Copyright (c) 2010-2017, Postgres-XC Development Group
+ * Portions Copyright (c) 1996-2015, The PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, The Regents of the University of California
+ * 
+ * Terms of the PostgreSQL License: 
+ * --------------------------------------------------------------------
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation for any purpose, without fee, and without a written agreement
+ * is hereby granted, provided that the above copyright notice and this
+ * paragraph and the following two paragraphs appear in all copies.
+ * 
+ * IN NO EVENT SHALL THE UNIVERSITY OF CALIFORNIA BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING
+ * LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS
+ * DOCUMENTATION, EVEN IF THE UNIVERSITY OF CALIFORNIA HAS BEEN ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ * 
+ * THE UNIVERSITY OF CALIFORNIA SPECIFICALLY DISCLAIMS ANY WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE UNIVERSITY OF CALIFORNIA HAS NO OBLIGATIONS TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ * 
+ * 
+ * Terms of the BSD 3-Clause License:
+ * --------------------------------------------------------------------
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of THL A29 Limited nor the names of its contributors may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH 
+ * DAMAGE.
+ * 
+ */
+/*-------------------------------------------------------------------------
+ *
+ * ckptwriter.c
+ *
+ * Checkpoint writers are background workers that write out the dirty
+ * buffers of a checkpoint together with the checkpointer.  A single
+ * process can not keep fast storage busy when shared_buffers is large, so
+ * checkpoints would take long and stall the I/O of everybody else.
+ *
+ * BufferSync() sorts the buffers to be written into CkptBufferIds as
+ * usual, and then hands consecutive chunks of the sorted array out to the
+ * writers, so each writer still writes mostly sequentially within a file.
+ * The checkpointer paces the writers: they may only take chunks below a
+ * limit which it moves forward by a small window whenever the checkpoint
+ * is behind its schedule, so CheckpointWriteDelay() keeps working as the
+ * throttle.  The writers forward their fsync requests to the checkpointer
+ * like any backend does, where requests for the same segment collapse into
+ * one fsync.
+ *
+ * Whatever the writers did not get to, e.g. because one of them failed or
+ * they were stopped for shutdown, is written by BufferSync() itself
+ * afterwards, so correctness never depends on the writers.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ *
+ *
+ * IDENTIFICATION
+ *      src/backend/postmaster/ckptwriter.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <signal.h>
+
+#include "miscadmin.h"
+#include "pgstat.h"
+#include "postmaster/bgworker.h"
+#include "postmaster/bgwriter.h"
+#include "postmaster/ckptwriter.h"
+#include "storage/buf_internals.h"
+#include "storage/bufmgr.h"
+#include "storage/ipc.h"
+#include "storage/latch.h"
+#include "storage/proc.h"
+#include "storage/shmem.h"
+#include "storage/spin.h"
+#include "tcop/tcopprot.h"
+#include "utils/guc.h"
+#include "utils/resowner.h"
+
+/* number of sorted buffers a writer takes at a time */
+#define CKPT_WRITER_CHUNK        32
+
+typedef struct CheckpointWriterShmemStruct
+{
+    slock_t        mutex;            /* protects all the fields below */
+
+    int            num_to_scan;    /* entries of CkptBufferIds in this round */
+    int            next;            /* next entry to hand out */
+    int            limit;            /* hand out entries below this only */
+    int            busy;            /* writers working on a chunk */
+    int            processed;        /* entries finished by the writers */
+    int            written;        /* buffers written by the writers */
+
+    Latch       *ckpt_latch;        /* latch of the process in BufferSync */
+    Latch       *writer_latch[MAX_CHECKPOINT_WRITERS];    /* NULL if the
+                                                         * writer is not
+                                                         * running */
+} CheckpointWriterShmemStruct;
+
+static CheckpointWriterShmemStruct *CkptWriterShmem = NULL;
+
+int            checkpoint_writers = 0;
+
+static volatile sig_atomic_t got_SIGHUP = false;
+
+/* slot of this writer, and whether it is working on a chunk */
+static int    MyWriterSlot = -1;
+static bool MyWriterBusy = false;
+
+static void ckptwriter_sighup(SIGNAL_ARGS);
+static void ckptwriter_detach(int code, Datum arg);
+static bool ckptwriter_claim(int *from, int *to);
+static void ckptwriter_finish(int processed, int written);
+
+/*
+ * Register the checkpoint writers.  Like ApplyLauncherRegister() this has to
+ * be called by the postmaster before InitializeMaxBackends().
+ */
+void
+CheckpointWritersRegister(void)
+{
+    BackgroundWorker bgw;
+    int            i;
+
+    for (i = 0; i < checkpoint_writers; i++)
+    {
+        memset(&bgw, 0, sizeof(bgw));
+        bgw.bgw_flags = BGWORKER_SHMEM_ACCESS;
+        bgw.bgw_start_time = BgWorkerStart_PostmasterStart;
+        snprintf(bgw.bgw_library_name, BGW_MAXLEN, "postgres");
+        snprintf(bgw.bgw_function_name, BGW_MAXLEN, "CheckpointWriterMain");
+        snprintf(bgw.bgw_name, BGW_MAXLEN, "checkpoint writer %d", i + 1);
+        bgw.bgw_restart_time = 5;
+        bgw.bgw_notify_pid = 0;
+        bgw.bgw_main_arg = Int32GetDatum(i);
+
+        RegisterBackgroundWorker(&bgw);
+    }
+}
+
+Size
+CheckpointWriterShmemSize(void)
+{
+    return MAXALIGN(sizeof(CheckpointWriterShmemStruct));
+}
+
+void
+CheckpointWriterShmemInit(void)
+{
+    bool        found;
+
+    CkptWriterShmem = (CheckpointWriterShmemStruct *)
+        ShmemInitStruct("Checkpoint Writer Data",
+                        CheckpointWriterShmemSize(),
+                        &found);
+
+    if (!found)
+    {
+        memset(CkptWriterShmem, 0, CheckpointWriterShmemSize());
+        SpinLockInit(&CkptWriterShmem->mutex);
+    }
+}
+
+/* SIGHUP: set flag to reload configuration at next convenient time */
+static void
+ckptwriter_sighup(SIGNAL_ARGS)
+{
+    int            save_errno = errno;
+
+    got_SIGHUP = true;
+
+    /* Waken anything waiting on the process latch */
+    SetLatch(MyLatch);
+
+    errno = save_errno;
+}
+
+/*
+ * Leave the pool of writers.  If we die in the middle of a chunk, the rest
+ * of it is left to BufferSync().
+ */
+static void
+ckptwriter_detach(int code, Datum arg)
+{
+    Latch       *ckpt_latch;
+
+    SpinLockAcquire(&CkptWriterShmem->mutex);
+    CkptWriterShmem->writer_latch[MyWriterSlot] = NULL;
+    if (MyWriterBusy)
+        CkptWriterShmem->busy--;
+    ckpt_latch = CkptWriterShmem->ckpt_latch;
+    SpinLockRelease(&CkptWriterShmem->mutex);
+
+    MyWriterBusy = false;
+
+    if (ckpt_latch)
+        SetLatch(ckpt_latch);
+}
+
+/*
+ * Take the next chunk of CkptBufferIds, if the checkpointer allows it.
+ */
+static bool
+ckptwriter_claim(int *from, int *to)
+{
+    bool        claimed = false;
+
+    SpinLockAcquire(&CkptWriterShmem->mutex);
+    if (CkptWriterShmem->next < CkptWriterShmem->limit)
+    {
+        *from = CkptWriterShmem->next;
+        *to = Min(*from + CKPT_WRITER_CHUNK, CkptWriterShmem->limit);
+        CkptWriterShmem->next = *to;
+        CkptWriterShmem->busy++;
+        claimed = true;
+    }
+    SpinLockRelease(&CkptWriterShmem->mutex);
+
+    MyWriterBusy = claimed;
+
+    return claimed;
+}
+
+/*
+ * Report a finished chunk and wake up the checkpointer.
+ */
+static void
+ckptwriter_finish(int processed, int written)
+{
+    Latch       *ckpt_latch;
+
+    SpinLockAcquire(&CkptWriterShmem->mutex);
+    CkptWriterShmem->busy--;
+    CkptWriterShmem->processed += processed;
+    CkptWriterShmem->written += written;
+    ckpt_latch = CkptWriterShmem->ckpt_latch;
+    SpinLockRelease(&CkptWriterShmem->mutex);
+
+    MyWriterBusy = false;
+
+    if (ckpt_latch)
+        SetLatch(ckpt_latch);
+}
+
+/*
+ * Main entry point of a checkpoint writer.
+ */
+void
+CheckpointWriterMain(Datum main_arg)
+{
+    WritebackContext wb_context;
+
+    MyWriterSlot = DatumGetInt32(main_arg);
+    Assert(MyWriterSlot >= 0 && MyWriterSlot < MAX_CHECKPOINT_WRITERS);
+
+    /* Establish signal handlers. */
+    pqsignal(SIGHUP, ckptwriter_sighup);
+    pqsignal(SIGTERM, die);
+    BackgroundWorkerUnblockSignals();
+
+    /* We need a resource owner to keep track of the buffer pins */
+    CurrentResourceOwner = ResourceOwnerCreate(NULL, "Checkpoint Writer");
+
+    WritebackContextInit(&wb_context, &checkpoint_flush_after);
+
+    before_shmem_exit(ckptwriter_detach, (Datum) 0);
+
+    SpinLockAcquire(&CkptWriterShmem->mutex);
+    CkptWriterShmem->writer_latch[MyWriterSlot] = MyLatch;
+    SpinLockRelease(&CkptWriterShmem->mutex);
+
+    for (;;)
+    {
+        int            from;
+        int            to;
+        int            rc;
+
+        CHECK_FOR_INTERRUPTS();
+
+        ResetLatch(MyLatch);
+
+        if (got_SIGHUP)
+        {
+            got_SIGHUP = false;
+            ProcessConfigFile(PGC_SIGHUP);
+        }
+
+        while (ckptwriter_claim(&from, &to))
+        {
+            int            written;
+
+            written = BufferSyncRange(from, to, &wb_context);
+            ckptwriter_finish(to - from, written);
+
+            CHECK_FOR_INTERRUPTS();
+        }
+
+        /* issue all pending flushes */
+        IssuePendingWritebacks(&wb_context);
+
+        rc = WaitLatch(MyLatch,
+                       WL_LATCH_SET | WL_POSTMASTER_DEATH,
+                       -1L,
+                       WAIT_EVENT_CHECKPOINT_WRITER_MAIN);
+
+        /* emergency bailout if postmaster has died */
+        if (rc & WL_POSTMASTER_DEATH)
+            proc_exit(1);
+    }
+}
+
+/*
+ * Can BufferSync() hand its work to checkpoint writers?
+ *
+ * Only the checkpointer can use them, because the writers forward their
+ * fsync requests to the checkpointer.  A checkpoint run by the startup
+ * process or a standalone backend would not fsync what they wrote.
+ */
+bool
+CheckpointWritersAvailable(void)
+{
+    bool        available = false;
+    int            i;
+
+    if (checkpoint_writers == 0 || !AmCheckpointerProcess())
+        return false;
+
+    SpinLockAcquire(&CkptWriterShmem->mutex);
+    for (i = 0; i < MAX_CHECKPOINT_WRITERS; i++)
+    {
+        if (CkptWriterShmem->writer_latch[i] != NULL)
+        {
+            available = true;
+            break;
+        }
+    }
+    SpinLockRelease(&CkptWriterShmem->mutex);
+
+    return available;
+}
+
+/*
+ * Let the checkpoint writers write the first num_to_scan entries of the
+ * sorted CkptBufferIds, and wait for them.  Returns the number of buffers
+ * they wrote.
+ *
+ * The writers only get chunks below a limit, which is kept a window of two
+ * chunks per writer ahead of the finished entries.  While the checkpoint is
+ * ahead of its schedule CheckpointWriteDelay() naps and the writers run out
+ * of work; once it falls behind we keep moving the window as fast as the
+ * writers get through it.
+ */
+int
+CheckpointWritersSync(int flags, int num_to_scan)
+{
+    int            written = 0;
+
+    SpinLockAcquire(&CkptWriterShmem->mutex);
+    Assert(CkptWriterShmem->busy == 0);
+    CkptWriterShmem->num_to_scan = num_to_scan;
+    CkptWriterShmem->next = 0;
+    CkptWriterShmem->limit = 0;
+    CkptWriterShmem->processed = 0;
+    CkptWriterShmem->written = 0;
+    CkptWriterShmem->ckpt_latch = MyLatch;
+    SpinLockRelease(&CkptWriterShmem->mutex);
+
+    for (;;)
+    {
+        Latch       *writer_latch[MAX_CHECKPOINT_WRITERS];
+        int            nwriters = 0;
+        int            processed;
+        bool        finished;
+        int            rc;
+        int            i;
+
+        ResetLatch(MyLatch);
+
+        SpinLockAcquire(&CkptWriterShmem->mutex);
+        for (i = 0; i < MAX_CHECKPOINT_WRITERS; i++)
+        {
+            writer_latch[i] = CkptWriterShmem->writer_latch[i];
+            if (writer_latch[i] != NULL)
+                nwriters++;
+        }
+        processed = CkptWriterShmem->processed;
+
+        /*
+         * We are done once everything has been handed out and written, or
+         * when all the writers are gone; BufferSync() writes what is left.
+         */
+        finished = (CkptWriterShmem->busy == 0 &&
+                    (CkptWriterShmem->next >= num_to_scan || nwriters == 0));
+        if (finished)
+        {
+            written = CkptWriterShmem->written;
+            CkptWriterShmem->num_to_scan = 0;
+            CkptWriterShmem->next = 0;
+            CkptWriterShmem->limit = 0;
+            CkptWriterShmem->ckpt_latch = NULL;
+        }
+        else
+            CkptWriterShmem->limit =
+                Min(num_to_scan,
+                    Max(CkptWriterShmem->limit,
+                        processed + nwriters * 2 * CKPT_WRITER_CHUNK));
+        SpinLockRelease(&CkptWriterShmem->mutex);
+
+        if (finished)
+            break;
+
+        for (i = 0; i < MAX_CHECKPOINT_WRITERS; i++)
+        {
+            if (writer_latch[i] != NULL)
+                SetLatch(writer_latch[i]);
+        }
+
+        /* the writers' fsync requests pile up in our queue meanwhile */
+        AbsorbFsyncRequests();
+
+        /* Sleep to throttle the writers if we are ahead of schedule */
+        CheckpointWriteDelay(flags, (double) processed / num_to_scan);
+
+        rc = WaitLatch(MyLatch,
+                       WL_LATCH_SET | WL_TIMEOUT | WL_POSTMASTER_DEATH,
+                       10L,
+                       WAIT_EVENT_CHECKPOINT_WRITERS);
+
+        /*
+         * Emergency bailout if postmaster has died.  This is to avoid the
+         * necessity for manual cleanup of all postmaster children.
+         */
+        if (rc & WL_POSTMASTER_DEATH)
+            exit(1);
+    }
+
+    return written;
+}
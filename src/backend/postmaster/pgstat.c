@@ -58,8 +58,10 @@
 #include "storage/ipc.h"
 #include "storage/latch.h"
 #include "storage/lmgr.h"
+#include "storage/lwlock.h"
 #include "storage/pg_shmem.h"
 #include "storage/procsignal.h"
+#include "storage/shmem.h"
 #include "storage/sinvaladt.h"
 #include "utils/ascii.h"
 #include "utils/guc.h"
@@ -337,6 +339,18 @@ static void pgstat_recv_funcpurge(PgStat_MsgFuncpurge *msg, int len);
 static void pgstat_recv_recoveryconflict(PgStat_MsgRecoveryConflict *msg, int len);
 static void pgstat_recv_deadlock(PgStat_MsgDeadlock *msg, int len);
 static void pgstat_recv_tempfile(PgStat_MsgTempFile *msg, int len);
+#ifdef __TBASE__
+static void pgstat_update_tabstat(PgStat_StatTabEntry *tabentry,
+                      PgStat_TableEntry *tabmsg, bool found);
+static bool shared_tabstat_apply(Oid databaseid, PgStat_TableEntry *tabmsg,
+                     PgStat_TableCounts *totals);
+static bool shared_tabstat_recv_vacuum(PgStat_MsgVacuum *msg);
+static bool shared_tabstat_recv_analyze(PgStat_MsgAnalyze *msg);
+static void shared_tabstat_remove(Oid databaseid, Oid tableid);
+static void shared_tabstat_purge(Oid databaseid, HTAB *oids);
+static void shared_tabstat_purge_databases(HTAB *oids);
+static void shared_tabstat_reset(void);
+#endif
 
 /* ------------------------------------------------------------
  * Public functions called from postmaster follow
@@ -687,8 +701,580 @@ pgstat_reset_all(void)
 {
     pgstat_reset_remove_files(pgstat_stat_directory);
     pgstat_reset_remove_files(PGSTAT_STAT_PERMANENT_DIRECTORY);
+#ifdef __TBASE__
+    shared_tabstat_reset();
+#endif
+}
+
+#ifdef __TBASE__
+/* ----------
+ * Shared-memory table statistics
+ *
+ * With shared_table_stats_size > 0, backends add their per-table counts
+ * straight into a partitioned hash table in shared memory at transaction
+ * end, and VACUUM and ANALYZE store their results there as well, instead of
+ * sending them to the collector, which would have to keep them in and
+ * rewrite them with its stats files.  Readers look there first.  The table
+ * is written to disk at every checkpoint, including the shutdown one, and
+ * loaded again at startup.  Tables that find no room are still counted by
+ * the collector.
+ * ----------
+ */
+#define SHARED_TABSTAT_PARTITIONS    64
+
+typedef struct SharedTabStatKey
+{
+    Oid            databaseid;        /* InvalidOid for shared relations */
+    Oid            tableid;
+} SharedTabStatKey;
+
+typedef struct SharedTabStatEntry
+{
+    SharedTabStatKey key;
+    PgStat_StatTabEntry stat;
+} SharedTabStatEntry;
+
+int            shared_table_stats_size = 0;
+
+static HTAB *SharedTabStatHash = NULL;
+static LWLockPadded *SharedTabStatLocks = NULL;
+
+/* shared entries copied out in this transaction, see pgstat_clear_snapshot */
+static HTAB *sharedTabStatSnapshot = NULL;
+
+#define SharedTabStatPartitionLock(hashcode) \
+    (&SharedTabStatLocks[(hashcode) % SHARED_TABSTAT_PARTITIONS].lock)
+
+Size
+SharedTabStatShmemSize(void)
+{
+    Size        size;
+
+    if (shared_table_stats_size <= 0)
+        return 0;
+
+    size = mul_size(SHARED_TABSTAT_PARTITIONS, sizeof(LWLockPadded));
+    size = add_size(size, hash_estimate_size(shared_table_stats_size,
+                                             sizeof(SharedTabStatEntry)));
+    return size;
 }
 
+void
+SharedTabStatShmemInit(void)
+{
+    HASHCTL        info;
+    bool        found;
+    int            i;
+
+    if (shared_table_stats_size <= 0)
+        return;
+
+    SharedTabStatLocks = (LWLockPadded *)
+        ShmemInitStruct("Shared Table Statistics Locks",
+                        SHARED_TABSTAT_PARTITIONS * sizeof(LWLockPadded),
+                        &found);
+    LWLockRegisterTranche(LWTRANCHE_SHARED_TABSTAT, "shared_tabstat");
+    if (!found)
+    {
+        for (i = 0; i < SHARED_TABSTAT_PARTITIONS; i++)
+            LWLockInitialize(&SharedTabStatLocks[i].lock,
+                             LWTRANCHE_SHARED_TABSTAT);
+    }
+
+    MemSet(&info, 0, sizeof(info));
+    info.keysize = sizeof(SharedTabStatKey);
+    info.entrysize = sizeof(SharedTabStatEntry);
+    info.num_partitions = SHARED_TABSTAT_PARTITIONS;
+
+    SharedTabStatHash = ShmemInitHash("Shared Table Statistics",
+                                      shared_table_stats_size,
+                                      shared_table_stats_size,
+                                      &info,
+                                      HASH_ELEM | HASH_BLOBS | HASH_PARTITION);
+}
+
+static void
+shared_tabstat_lock_all(LWLockMode mode)
+{
+    int            i;
+
+    for (i = 0; i < SHARED_TABSTAT_PARTITIONS; i++)
+        LWLockAcquire(&SharedTabStatLocks[i].lock, mode);
+}
+
+static void
+shared_tabstat_unlock_all(void)
+{
+    int            i;
+
+    for (i = SHARED_TABSTAT_PARTITIONS; --i >= 0;)
+        LWLockRelease(&SharedTabStatLocks[i].lock);
+}
+
+/*
+ * Find or create the shared entry of a table and return it with its
+ * partition lock, returned in *lock, held exclusively.  Returns NULL without
+ * any lock held if the table has no entry and there is no room for one.
+ */
+static PgStat_StatTabEntry *
+shared_tabstat_enter(Oid databaseid, Oid tableid, LWLock **lock)
+{
+    SharedTabStatKey key;
+    SharedTabStatEntry *entry;
+    uint32        hashcode;
+
+    key.databaseid = databaseid;
+    key.tableid = tableid;
+    hashcode = get_hash_value(SharedTabStatHash, (void *) &key);
+    *lock = SharedTabStatPartitionLock(hashcode);
+
+    LWLockAcquire(*lock, LW_EXCLUSIVE);
+
+    entry = (SharedTabStatEntry *)
+        hash_search_with_hash_value(SharedTabStatHash, (void *) &key,
+                                    hashcode, HASH_FIND, NULL);
+    if (entry != NULL)
+        return &entry->stat;
+
+    /* the size limit is soft, other partitions may be adding entries */
+    if (hash_get_num_entries(SharedTabStatHash) < shared_table_stats_size)
+        entry = (SharedTabStatEntry *)
+            hash_search_with_hash_value(SharedTabStatHash, (void *) &key,
+                                        hashcode, HASH_ENTER_NULL, NULL);
+    if (entry == NULL)
+    {
+        LWLockRelease(*lock);
+        return NULL;
+    }
+
+    MemSet(&entry->stat, 0, sizeof(PgStat_StatTabEntry));
+    entry->stat.tableid = tableid;
+    return &entry->stat;
+}
+
+/*
+ * Apply one table's counts to shared memory, rolling them up into the
+ * partitioned parent as well, and add them to *totals for the collector's
+ * database counters.  Returns false if the counts still have to be sent to
+ * the collector as tabmsg, which may have been rewritten to carry only the
+ * parent's part.
+ */
+static bool
+shared_tabstat_apply(Oid databaseid, PgStat_TableEntry *tabmsg,
+                     PgStat_TableCounts *totals)
+{
+    PgStat_StatTabEntry *tabentry;
+    LWLock       *lock;
+
+    tabentry = shared_tabstat_enter(databaseid, tabmsg->t_id, &lock);
+    if (tabentry == NULL)
+        return false;
+    pgstat_update_tabstat(tabentry, tabmsg, true);
+    tabentry->n_live_tuples = Max(tabentry->n_live_tuples, 0);
+    tabentry->n_dead_tuples = Max(tabentry->n_dead_tuples, 0);
+    LWLockRelease(lock);
+
+    if (OidIsValid(tabmsg->t_parent_id))
+    {
+        tabentry = shared_tabstat_enter(databaseid, tabmsg->t_parent_id, &lock);
+        if (tabentry == NULL)
+        {
+            /* let the collector roll up the parent, and count the database */
+            tabmsg->t_id = tabmsg->t_parent_id;
+            tabmsg->t_parent_id = InvalidOid;
+            return false;
+        }
+        pgstat_update_tabstat(tabentry, tabmsg, true);
+        tabentry->n_live_tuples = Max(tabentry->n_live_tuples, 0);
+        tabentry->n_dead_tuples = Max(tabentry->n_dead_tuples, 0);
+        LWLockRelease(lock);
+    }
+
+    totals->t_tuples_returned += tabmsg->t_counts.t_tuples_returned;
+    totals->t_tuples_fetched += tabmsg->t_counts.t_tuples_fetched;
+    totals->t_tuples_inserted += tabmsg->t_counts.t_tuples_inserted;
+    totals->t_tuples_updated += tabmsg->t_counts.t_tuples_updated;
+    totals->t_tuples_deleted += tabmsg->t_counts.t_tuples_deleted;
+    totals->t_blocks_fetched += tabmsg->t_counts.t_blocks_fetched;
+    totals->t_blocks_hit += tabmsg->t_counts.t_blocks_hit;
+    return true;
+}
+
+/* Shared-memory counterpart of pgstat_recv_vacuum */
+static bool
+shared_tabstat_recv_vacuum(PgStat_MsgVacuum *msg)
+{
+    PgStat_StatTabEntry *tabentry;
+    LWLock       *lock;
+
+    tabentry = shared_tabstat_enter(msg->m_databaseid, msg->m_tableoid, &lock);
+    if (tabentry == NULL)
+        return false;
+
+    tabentry->n_live_tuples = msg->m_live_tuples;
+    tabentry->n_dead_tuples = msg->m_dead_tuples;
+
+    if (msg->m_autovacuum)
+    {
+        tabentry->autovac_vacuum_timestamp = msg->m_vacuumtime;
+        tabentry->autovac_vacuum_count++;
+    }
+    else
+    {
+        tabentry->vacuum_timestamp = msg->m_vacuumtime;
+        tabentry->vacuum_count++;
+    }
+
+    LWLockRelease(lock);
+    return true;
+}
+
+/* Shared-memory counterpart of pgstat_recv_analyze */
+static bool
+shared_tabstat_recv_analyze(PgStat_MsgAnalyze *msg)
+{
+    PgStat_StatTabEntry *tabentry;
+    LWLock       *lock;
+
+    tabentry = shared_tabstat_enter(msg->m_databaseid, msg->m_tableoid, &lock);
+    if (tabentry == NULL)
+        return false;
+
+    tabentry->n_live_tuples = msg->m_live_tuples;
+    tabentry->n_dead_tuples = msg->m_dead_tuples;
+
+    if (msg->m_resetcounter)
+        tabentry->changes_since_analyze = 0;
+
+    if (msg->m_autovacuum)
+    {
+        tabentry->autovac_analyze_timestamp = msg->m_analyzetime;
+        tabentry->autovac_analyze_count++;
+    }
+    else
+    {
+        tabentry->analyze_timestamp = msg->m_analyzetime;
+        tabentry->analyze_count++;
+    }
+
+    LWLockRelease(lock);
+    return true;
+}
+
+static void
+shared_tabstat_remove(Oid databaseid, Oid tableid)
+{
+    SharedTabStatKey key;
+    uint32        hashcode;
+    LWLock       *lock;
+
+    key.databaseid = databaseid;
+    key.tableid = tableid;
+    hashcode = get_hash_value(SharedTabStatHash, (void *) &key);
+    lock = SharedTabStatPartitionLock(hashcode);
+
+    LWLockAcquire(lock, LW_EXCLUSIVE);
+    (void) hash_search_with_hash_value(SharedTabStatHash, (void *) &key,
+                                       hashcode, HASH_REMOVE, NULL);
+    LWLockRelease(lock);
+}
+
+/*
+ * Remove the entries of a database whose table OID is not in oids; all of
+ * them if oids is NULL.
+ */
+static void
+shared_tabstat_purge(Oid databaseid, HTAB *oids)
+{
+    HASH_SEQ_STATUS hstat;
+    SharedTabStatEntry *entry;
+
+    shared_tabstat_lock_all(LW_EXCLUSIVE);
+    hash_seq_init(&hstat, SharedTabStatHash);
+    while ((entry = (SharedTabStatEntry *) hash_seq_search(&hstat)) != NULL)
+    {
+        if (entry->key.databaseid != databaseid)
+            continue;
+        if (oids != NULL &&
+            hash_search(oids, (void *) &entry->key.tableid, HASH_FIND, NULL) != NULL)
+            continue;
+        (void) hash_search(SharedTabStatHash, (void *) &entry->key,
+                           HASH_REMOVE, NULL);
+    }
+    shared_tabstat_unlock_all();
+}
+
+/*
+ * Remove the entries of databases whose OID is not in oids; all entries if
+ * oids is NULL.  Shared relations are only dropped in the latter case.
+ */
+static void
+shared_tabstat_purge_databases(HTAB *oids)
+{
+    HASH_SEQ_STATUS hstat;
+    SharedTabStatEntry *entry;
+
+    shared_tabstat_lock_all(LW_EXCLUSIVE);
+    hash_seq_init(&hstat, SharedTabStatHash);
+    while ((entry = (SharedTabStatEntry *) hash_seq_search(&hstat)) != NULL)
+    {
+        if (oids != NULL &&
+            (!OidIsValid(entry->key.databaseid) ||
+             hash_search(oids, (void *) &entry->key.databaseid,
+                         HASH_FIND, NULL) != NULL))
+            continue;
+        (void) hash_search(SharedTabStatHash, (void *) &entry->key,
+                           HASH_REMOVE, NULL);
+    }
+    shared_tabstat_unlock_all();
+}
+
+/*
+ * Throw away the shared table statistics, in memory and on disk.
+ */
+static void
+shared_tabstat_reset(void)
+{
+    unlink(PGSTAT_SHARED_TABSTAT_FILENAME);
+    unlink(PGSTAT_SHARED_TABSTAT_TMPFILE);
+    if (SharedTabStatHash != NULL)
+        shared_tabstat_purge_databases(NULL);
+}
+
+/*
+ * Write the shared table statistics to disk; called at checkpoints.
+ */
+void
+pgstat_save_shared_tabstats(void)
+{
+    HASH_SEQ_STATUS hstat;
+    SharedTabStatEntry *entry;
+    SharedTabStatEntry *entries;
+    long        nentries;
+    long        i;
+    FILE       *fpout;
+    int32        format_id;
+    int            rc;
+
+    if (SharedTabStatHash == NULL)
+        return;
+
+    /*
+     * Copy the entries out first, so that backends reporting their counts
+     * do not have to wait for the file to be written.
+     */
+    shared_tabstat_lock_all(LW_SHARED);
+    nentries = hash_get_num_entries(SharedTabStatHash);
+    entries = (SharedTabStatEntry *)
+        MemoryContextAllocExtended(CurrentMemoryContext,
+                                   Max(nentries, 1) * sizeof(SharedTabStatEntry),
+                                   MCXT_ALLOC_HUGE | MCXT_ALLOC_NO_OOM);
+    if (entries == NULL)
+    {
+        shared_tabstat_unlock_all();
+        ereport(LOG,
+                (errcode(ERRCODE_OUT_OF_MEMORY),
+                 errmsg("out of memory while saving shared table statistics")));
+        return;
+    }
+    i = 0;
+    hash_seq_init(&hstat, SharedTabStatHash);
+    while ((entry = (SharedTabStatEntry *) hash_seq_search(&hstat)) != NULL)
+        memcpy(&entries[i++], entry, sizeof(SharedTabStatEntry));
+    shared_tabstat_unlock_all();
+
+    fpout = AllocateFile(PGSTAT_SHARED_TABSTAT_TMPFILE, PG_BINARY_W);
+    if (fpout == NULL)
+    {
+        ereport(LOG,
+                (errcode_for_file_access(),
+                 errmsg("could not open temporary statistics file \"%s\": %m",
+                        PGSTAT_SHARED_TABSTAT_TMPFILE)));
+        pfree(entries);
+        return;
+    }
+
+    format_id = PGSTAT_FILE_FORMAT_ID;
+    rc = fwrite(&format_id, sizeof(format_id), 1, fpout);
+    (void) rc;                    /* we'll check for error with ferror */
+
+    for (i = 0; i < nentries; i++)
+    {
+        fputc('T', fpout);
+        rc = fwrite(&entries[i], sizeof(SharedTabStatEntry), 1, fpout);
+        (void) rc;                /* we'll check for error with ferror */
+    }
+    fputc('E', fpout);
+    pfree(entries);
+
+    if (ferror(fpout))
+    {
+        ereport(LOG,
+                (errcode_for_file_access(),
+                 errmsg("could not write temporary statistics file \"%s\": %m",
+                        PGSTAT_SHARED_TABSTAT_TMPFILE)));
+        FreeFile(fpout);
+        unlink(PGSTAT_SHARED_TABSTAT_TMPFILE);
+    }
+    else if (FreeFile(fpout) < 0)
+    {
+        ereport(LOG,
+                (errcode_for_file_access(),
+                 errmsg("could not close temporary statistics file \"%s\": %m",
+                        PGSTAT_SHARED_TABSTAT_TMPFILE)));
+        unlink(PGSTAT_SHARED_TABSTAT_TMPFILE);
+    }
+    else if (rename(PGSTAT_SHARED_TABSTAT_TMPFILE,
+                    PGSTAT_SHARED_TABSTAT_FILENAME) < 0)
+    {
+        ereport(LOG,
+                (errcode_for_file_access(),
+                 errmsg("could not rename temporary statistics file \"%s\" to \"%s\": %m",
+                        PGSTAT_SHARED_TABSTAT_TMPFILE,
+                        PGSTAT_SHARED_TABSTAT_FILENAME)));
+        unlink(PGSTAT_SHARED_TABSTAT_TMPFILE);
+    }
+}
+
+/*
+ * Load the shared table statistics saved by the last checkpoint; called by
+ * the startup process.  pgstat_reset_all() throws them away again if crash
+ * recovery is needed.
+ */
+void
+pgstat_restore_shared_tabstats(void)
+{
+    SharedTabStatEntry saved;
+    PgStat_StatTabEntry *tabentry;
+    LWLock       *lock;
+    FILE       *fpin;
+    int32        format_id;
+
+    if (SharedTabStatHash == NULL)
+        return;
+
+    if ((fpin = AllocateFile(PGSTAT_SHARED_TABSTAT_FILENAME, PG_BINARY_R)) == NULL)
+    {
+        if (errno != ENOENT)
+            ereport(LOG,
+                    (errcode_for_file_access(),
+                     errmsg("could not open statistics file \"%s\": %m",
+                            PGSTAT_SHARED_TABSTAT_FILENAME)));
+        return;
+    }
+
+    if (fread(&format_id, 1, sizeof(format_id), fpin) != sizeof(format_id) ||
+        format_id != PGSTAT_FILE_FORMAT_ID)
+    {
+        ereport(LOG,
+                (errmsg("corrupted statistics file \"%s\"",
+                        PGSTAT_SHARED_TABSTAT_FILENAME)));
+        goto done;
+    }
+
+    for (;;)
+    {
+        switch (fgetc(fpin))
+        {
+            case 'T':
+                if (fread(&saved, 1, sizeof(saved), fpin) != sizeof(saved))
+                {
+                    ereport(LOG,
+                            (errmsg("corrupted statistics file \"%s\"",
+                                    PGSTAT_SHARED_TABSTAT_FILENAME)));
+                    goto done;
+                }
+
+                tabentry = shared_tabstat_enter(saved.key.databaseid,
+                                                saved.key.tableid, &lock);
+                if (tabentry == NULL)
+                    goto done;
+                memcpy(tabentry, &saved.stat, sizeof(PgStat_StatTabEntry));
+                LWLockRelease(lock);
+                break;
+
+            case 'E':
+                goto done;
+
+            default:
+                ereport(LOG,
+                        (errmsg("corrupted statistics file \"%s\"",
+                                PGSTAT_SHARED_TABSTAT_FILENAME)));
+                goto done;
+        }
+    }
+
+done:
+    FreeFile(fpin);
+}
+
+/*
+ * Return the shared-memory statistics of a table, or NULL if it has none.
+ * The entry is copied into the statistics snapshot, so it stays the same
+ * until pgstat_clear_snapshot().
+ */
+PgStat_StatTabEntry *
+pgstat_fetch_shared_tabentry(Oid dbid, Oid relid)
+{
+    SharedTabStatKey key;
+    SharedTabStatEntry *entry;
+    SharedTabStatEntry copy;
+    uint32        hashcode;
+    LWLock       *lock;
+
+    if (SharedTabStatHash == NULL)
+        return NULL;
+
+    key.databaseid = dbid;
+    key.tableid = relid;
+
+    if (sharedTabStatSnapshot != NULL)
+    {
+        entry = (SharedTabStatEntry *) hash_search(sharedTabStatSnapshot,
+                                                   (void *) &key,
+                                                   HASH_FIND, NULL);
+        if (entry != NULL)
+            return &entry->stat;
+    }
+
+    hashcode = get_hash_value(SharedTabStatHash, (void *) &key);
+    lock = SharedTabStatPartitionLock(hashcode);
+
+    LWLockAcquire(lock, LW_SHARED);
+    entry = (SharedTabStatEntry *)
+        hash_search_with_hash_value(SharedTabStatHash, (void *) &key,
+                                    hashcode, HASH_FIND, NULL);
+    if (entry != NULL)
+        memcpy(&copy, entry, sizeof(SharedTabStatEntry));
+    LWLockRelease(lock);
+
+    if (entry == NULL)
+        return NULL;
+
+    if (sharedTabStatSnapshot == NULL)
+    {
+        HASHCTL        hash_ctl;
+
+        pgstat_setup_memcxt();
+
+        memset(&hash_ctl, 0, sizeof(hash_ctl));
+        hash_ctl.keysize = sizeof(SharedTabStatKey);
+        hash_ctl.entrysize = sizeof(SharedTabStatEntry);
+        hash_ctl.hcxt = pgStatLocalContext;
+        sharedTabStatSnapshot = hash_create("Shared table statistics snapshot",
+                                            PGSTAT_TAB_HASH_SIZE,
+                                            &hash_ctl,
+                                            HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+    }
+
+    entry = (SharedTabStatEntry *) hash_search(sharedTabStatSnapshot,
+                                               (void *) &key,
+                                               HASH_ENTER, NULL);
+    memcpy(entry, &copy, sizeof(SharedTabStatEntry));
+    return &entry->stat;
+}
+#endif                            /* __TBASE__ */
+
 #ifdef EXEC_BACKEND
 
 /*
@@ -859,6 +1445,10 @@ pgstat_report_stat(bool force)
     shared_msg.m_databaseid = InvalidOid;
     regular_msg.m_nentries = 0;
     shared_msg.m_nentries = 0;
+#ifdef __TBASE__
+    MemSet(&regular_msg.m_shared_counts, 0, sizeof(PgStat_TableCounts));
+    MemSet(&shared_msg.m_shared_counts, 0, sizeof(PgStat_TableCounts));
+#endif
 
     for (tsa = pgStatTabList; tsa != NULL; tsa = tsa->tsa_next)
     {
@@ -890,6 +1480,13 @@ pgstat_report_stat(bool force)
 #endif
             memcpy(&this_ent->t_counts, &entry->t_counts,
                    sizeof(PgStat_TableCounts));
+#ifdef __TBASE__
+            /* counts kept in shared memory need no slot in the message */
+            if (SharedTabStatHash != NULL &&
+                shared_tabstat_apply(this_msg->m_databaseid, this_ent,
+                                     &this_msg->m_shared_counts))
+                continue;
+#endif
             if (++this_msg->m_nentries >= PGSTAT_NUM_TABENTRIES)
             {
                 pgstat_send_tabstat(this_msg);
@@ -906,11 +1503,23 @@ pgstat_report_stat(bool force)
      * Send partial messages.  Make sure that any pending xact commit/abort
      * gets counted, even if there are no table stats to send.
      */
+#ifdef __TBASE__
+    if (regular_msg.m_nentries > 0 ||
+        pgStatXactCommit > 0 || pgStatXactRollback > 0 ||
+        memcmp(&regular_msg.m_shared_counts, &all_zeroes,
+               sizeof(PgStat_TableCounts)) != 0)
+        pgstat_send_tabstat(&regular_msg);
+    if (shared_msg.m_nentries > 0 ||
+        memcmp(&shared_msg.m_shared_counts, &all_zeroes,
+               sizeof(PgStat_TableCounts)) != 0)
+        pgstat_send_tabstat(&shared_msg);
+#else
     if (regular_msg.m_nentries > 0 ||
         pgStatXactCommit > 0 || pgStatXactRollback > 0)
         pgstat_send_tabstat(&regular_msg);
     if (shared_msg.m_nentries > 0)
         pgstat_send_tabstat(&shared_msg);
+#endif
 
     /* Now, send function statistics */
     pgstat_send_funcstats();
@@ -958,6 +1567,9 @@ pgstat_send_tabstat(PgStat_MsgTabstat *tsmsg)
 
     pgstat_setheader(&tsmsg->m_hdr, PGSTAT_MTYPE_TABSTAT);
     pgstat_send(tsmsg, len);
+#ifdef __TBASE__
+    MemSet(&tsmsg->m_shared_counts, 0, sizeof(PgStat_TableCounts));
+#endif
 }
 
 /*
@@ -1065,9 +1677,27 @@ pgstat_vacuum_stat(void)
             pgstat_drop_database(dbid);
     }
 
+#ifdef __TBASE__
+    if (SharedTabStatHash != NULL)
+        shared_tabstat_purge_databases(htab);
+#endif
+
     /* Clean up */
     hash_destroy(htab);
 
+#ifdef __TBASE__
+    /*
+     * Entries in shared memory are purged here directly, with the same list
+     * of relations the collector's entries are checked against below.
+     */
+    htab = NULL;
+    if (SharedTabStatHash != NULL)
+    {
+        htab = pgstat_collect_oids(RelationRelationId);
+        shared_tabstat_purge(MyDatabaseId, htab);
+    }
+#endif
+
     /*
      * Lookup our own database entry; if not found, nothing more to do.
      */
@@ -1075,11 +1705,20 @@ pgstat_vacuum_stat(void)
                                                  (void *) &MyDatabaseId,
                                                  HASH_FIND, NULL);
     if (dbentry == NULL || dbentry->tables == NULL)
+    {
+#ifdef __TBASE__
+        if (htab != NULL)
+            hash_destroy(htab);
+#endif
         return;
+    }
 
     /*
      * Similarly to above, make a list of all known relations in this DB.
      */
+#ifdef __TBASE__
+    if (htab == NULL)
+#endif
     htab = pgstat_collect_oids(RelationRelationId);
 
     /*
@@ -1255,6 +1894,11 @@ pgstat_drop_database(Oid databaseid)
 {
     PgStat_MsgDropdb msg;
 
+#ifdef __TBASE__
+    if (SharedTabStatHash != NULL)
+        shared_tabstat_purge(databaseid, NULL);
+#endif
+
     if (pgStatSock == PGINVALID_SOCKET)
         return;
 
@@ -1311,6 +1955,11 @@ pgstat_reset_counters(void)
 {
     PgStat_MsgResetcounter msg;
 
+#ifdef __TBASE__
+    if (SharedTabStatHash != NULL)
+        shared_tabstat_purge(MyDatabaseId, NULL);
+#endif
+
     if (pgStatSock == PGINVALID_SOCKET)
         return;
 
@@ -1364,6 +2013,11 @@ pgstat_reset_single_counter(Oid objoid, PgStat_Single_Reset_Type type)
 {
     PgStat_MsgResetsinglecounter msg;
 
+#ifdef __TBASE__
+    if (SharedTabStatHash != NULL && type == RESET_TABLE)
+        shared_tabstat_remove(MyDatabaseId, objoid);
+#endif
+
     if (pgStatSock == PGINVALID_SOCKET)
         return;
 
@@ -1421,6 +2075,10 @@ pgstat_report_vacuum(Oid tableoid, bool shared,
     msg.m_vacuumtime = GetCurrentTimestamp();
     msg.m_live_tuples = livetuples;
     msg.m_dead_tuples = deadtuples;
+#ifdef __TBASE__
+    if (SharedTabStatHash != NULL && shared_tabstat_recv_vacuum(&msg))
+        return;
+#endif
     pgstat_send(&msg, sizeof(msg));
 }
 
@@ -1477,6 +2135,10 @@ pgstat_report_analyze(Relation rel,
     msg.m_analyzetime = GetCurrentTimestamp();
     msg.m_live_tuples = livetuples;
     msg.m_dead_tuples = deadtuples;
+#ifdef __TBASE__
+    if (SharedTabStatHash != NULL && shared_tabstat_recv_analyze(&msg))
+        return;
+#endif
     pgstat_send(&msg, sizeof(msg));
 }
 
@@ -2484,6 +3146,15 @@ pgstat_fetch_stat_tabentry(Oid relid)
     PgStat_StatDBEntry *dbentry;
     PgStat_StatTabEntry *tabentry;
 
+#ifdef __TBASE__
+    /* tables kept in shared memory need no stats file read at all */
+    tabentry = pgstat_fetch_shared_tabentry(MyDatabaseId, relid);
+    if (tabentry == NULL)
+        tabentry = pgstat_fetch_shared_tabentry(InvalidOid, relid);
+    if (tabentry != NULL)
+        return tabentry;
+#endif
+
     /*
      * If not done for this transaction, read the statistics collector stats
      * file into some hash tables.
@@ -3226,6 +3897,24 @@ pgstat_progress_end_command(void)
     pgstat_increment_changecount_after(beentry);
 }
 
+/*-----------
+ * pgstat_progress_command() -
+ *
+ * Return the command this backend is reporting progress for, so code shared
+ * by several commands only reports for the one it belongs to.
+ *-----------
+ */
+ProgressCommandType
+pgstat_progress_command(void)
+{
+    volatile PgBackendStatus *beentry = MyBEEntry;
+
+    if (!beentry)
+        return PROGRESS_COMMAND_INVALID;
+
+    return beentry->st_progress_command;
+}
+
 /* ----------
  * pgstat_report_appname() -
  *
@@ -3555,6 +4244,12 @@ pgstat_get_wait_activity(WaitEventActivity w)
         case WAIT_EVENT_CHECKPOINTER_MAIN:
             event_name = "CheckpointerMain";
             break;
+        case WAIT_EVENT_CHECKPOINT_WRITER_MAIN:
+            event_name = "CheckpointWriterMain";
+            break;
+        case WAIT_EVENT_GLOBAL_DEADLOCK_DETECTOR_MAIN:
+            event_name = "GlobalDeadlockDetectorMain";
+            break;
         case WAIT_EVENT_LOGICAL_LAUNCHER_MAIN:
             event_name = "LogicalLauncherMain";
             break;
@@ -3666,6 +4361,9 @@ pgstat_get_wait_ipc(WaitEventIPC w)
         case WAIT_EVENT_BTREE_PAGE:
             event_name = "BtreePage";
             break;
+        case WAIT_EVENT_CHECKPOINT_WRITERS:
+            event_name = "CheckpointWriters";
+            break;
         case WAIT_EVENT_EXECUTE_GATHER:
             event_name = "ExecuteGather";
             break;
@@ -5677,6 +6375,9 @@ pgstat_clear_snapshot(void)
     pgStatDBHash = NULL;
     localBackendStatusTable = NULL;
     localNumBackends = 0;
+#ifdef __TBASE__
+    sharedTabStatSnapshot = NULL;
+#endif
 }
 
 
@@ -5854,6 +6555,16 @@ pgstat_recv_tabstat(PgStat_MsgTabstat *msg, int len)
     dbentry->n_xact_rollback += (PgStat_Counter) (msg->m_xact_rollback);
     dbentry->n_block_read_time += msg->m_block_read_time;
     dbentry->n_block_write_time += msg->m_block_write_time;
+#ifdef __TBASE__
+    /* counts of tables kept in shared memory */
+    dbentry->n_tuples_returned += msg->m_shared_counts.t_tuples_returned;
+    dbentry->n_tuples_fetched += msg->m_shared_counts.t_tuples_fetched;
+    dbentry->n_tuples_inserted += msg->m_shared_counts.t_tuples_inserted;
+    dbentry->n_tuples_updated += msg->m_shared_counts.t_tuples_updated;
+    dbentry->n_tuples_deleted += msg->m_shared_counts.t_tuples_deleted;
+    dbentry->n_blocks_fetched += msg->m_shared_counts.t_blocks_fetched;
+    dbentry->n_blocks_hit += msg->m_shared_counts.t_blocks_hit;
+#endif
 
     /*
      * Process all table entries in the message.
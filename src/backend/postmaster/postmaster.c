@@ -118,8 +118,10 @@
 #endif
 #include "pg_getopt.h"
 #include "pgstat.h"
+#include "pgxc/globaldeadlock.h"
 #include "postmaster/autovacuum.h"
 #include "postmaster/bgworker_internals.h"
+#include "postmaster/ckptwriter.h"
 #include "postmaster/fork_process.h"
 #include "postmaster/pgarch.h"
 #include "postmaster/postmaster.h"
@@ -468,6 +470,7 @@ bool        IsPGXCMainCluster = false;
 int            PGXCNodeId = 0;
 #ifdef __TBASE__
 char             PGXCSessionId[NAMEDATALEN];
+uint32            PGXCQueryId = 0;
 #endif
 /*
  * When a particular node starts up, store the node identifier in this variable
@@ -619,6 +622,7 @@ typedef struct
     bool        IsBinaryUpgrade;
     int            max_safe_fds;
     int            MaxBackends;
+    int            FastPathLockGroupsPerBackend;
 #ifdef WIN32
     HANDLE        PostmasterHandle;
     HANDLE        initial_signal_pipe;
@@ -1140,6 +1144,14 @@ PostmasterMain(int argc, char *argv[])
      */
     ApplyLauncherRegister();
 
+#ifdef __TBASE__
+    /* Register the checkpoint writers, for the same reasons. */
+    CheckpointWritersRegister();
+
+    /* And the global deadlock detector of a coordinator. */
+    GlobalDeadlockDetectorRegister();
+#endif
+
     /*
         * Register Audit FGA worker
         */
@@ -6706,6 +6718,7 @@ save_backend_variables(BackendParameters *param, Port *port,
     param->max_safe_fds = max_safe_fds;
 
     param->MaxBackends = MaxBackends;
+    param->FastPathLockGroupsPerBackend = FastPathLockGroupsPerBackend;
 
 #ifdef WIN32
     param->PostmasterHandle = PostmasterHandle;
@@ -6938,6 +6951,7 @@ restore_backend_variables(BackendParameters *param, Port *port)
     max_safe_fds = param->max_safe_fds;
 
     MaxBackends = param->MaxBackends;
+    FastPathLockGroupsPerBackend = param->FastPathLockGroupsPerBackend;
 
 #ifdef WIN32
     PostmasterHandle = param->PostmasterHandle;
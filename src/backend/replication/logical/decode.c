@@ -153,6 +153,7 @@ static void DecodeAbort(LogicalDecodingContext *ctx, XLogRecordBuffer *buf,
 static void DecodeXLogTuple(char *data, Size len, ReorderBufferTupleBuf *tup);
 #ifdef __STORAGE_SCALABLE__
 static bool RelationShardIsTarget(Oid relid, int32 shardid);
+static bool ShardIsSkipped(int32 shardid);
 static void SetSkipSpecConfirm(TransactionId xid);
 static bool SkipSpecConfirm(TransactionId xid);
 #endif
@@ -832,6 +833,26 @@ DecodeInsert(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
         char       *data;
         xl_heap_header xlhdr;
         Oid relationId;
+
+        /* check the shard first, it needs no catalog access */
+        if (MyReplicationSlot->shards &&
+            (xlrec->flags & XLH_INSERT_CONTAINS_NEW_TUPLE))
+        {
+            data = XLogRecGetBlockData(r, 0, &datalen);
+            memcpy((char *) &xlhdr, data, SizeOfHeapHeader);
+
+            /* not our target shard */
+            if (!bms_is_member(xlhdr.t_shardid, MyReplicationSlot->shards))
+            {
+                if (xlrec->flags & XLH_INSERT_IS_SPECULATIVE)
+                {
+                    TransactionId xid = XLogRecGetXid(r);
+                    SetSkipSpecConfirm(xid);
+                }
+                MyReplicationSlot->nshard_skipped++;
+                return;
+            }
+        }
         
         StartTransactionCommand();
         
@@ -850,23 +871,6 @@ DecodeInsert(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
             return;
         }
 
-        data = XLogRecGetBlockData(r, 0, &datalen);
-        memcpy((char *) &xlhdr, data, SizeOfHeapHeader);
-
-        if (MyReplicationSlot->shards)
-        {
-            /* not our target shard */
-            if (!bms_is_member(xlhdr.t_shardid, MyReplicationSlot->shards))
-            {
-                if (xlrec->flags & XLH_INSERT_IS_SPECULATIVE)
-                {
-                    TransactionId xid = XLogRecGetXid(r);
-                    SetSkipSpecConfirm(xid);
-                }
-                return;
-            }
-        }
-
         //MyReplicationSlot->ntups_insert++;
     }
     else if (MyReplicationSlot->npubs)
@@ -879,6 +883,18 @@ DecodeInsert(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
 
         if (xlrec->flags & XLH_INSERT_CONTAINS_NEW_TUPLE)
         {
+            data = XLogRecGetBlockData(r, 0, &datalen);
+            memcpy((char *) &xlhdr, data, SizeOfHeapHeader);
+
+            if (ShardIsSkipped(xlhdr.t_shardid))
+            {
+                if (xlrec->flags & XLH_INSERT_IS_SPECULATIVE)
+                {
+                    TransactionId xid = XLogRecGetXid(r);
+                    SetSkipSpecConfirm(xid);
+                }
+                return;
+            }
 
             StartTransactionCommand();
             
@@ -886,9 +902,6 @@ DecodeInsert(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
 
             AbortCurrentTransaction();
 
-            data = XLogRecGetBlockData(r, 0, &datalen);
-            memcpy((char *) &xlhdr, data, SizeOfHeapHeader);
-
             found = RelationShardIsTarget(relationId, xlhdr.t_shardid);
 
             if (!found)
@@ -984,18 +997,6 @@ DecodeUpdate(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
         xl_heap_header xlhdr;
         Oid relationId;
 
-        StartTransactionCommand();
-        
-        relationId = RelidByRelfilenode(target_node.spcNode, target_node.relNode);
-
-        AbortCurrentTransaction();
-
-        /* not our target relation */
-        if (relationId != MyReplicationSlot->relid)
-        {
-            return;
-        }
-
         memset(&xlhdr, 0, sizeof(xl_heap_header));
         
         if (xlrec->flags & XLH_UPDATE_CONTAINS_NEW_TUPLE)
@@ -1009,14 +1010,30 @@ DecodeUpdate(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
             memcpy((char *) &xlhdr, data, SizeOfHeapHeader);
         }
 
+        /* check the shard first, it needs no catalog access */
         if (MyReplicationSlot->shards)
         {
             /* not our target shard */
             if (!bms_is_member(xlhdr.t_shardid, MyReplicationSlot->shards))
             {
+                ReorderBufferReturnChange(ctx->reorder, change);
+                MyReplicationSlot->nshard_skipped++;
                 return;
             }
         }
+
+        StartTransactionCommand();
+        
+        relationId = RelidByRelfilenode(target_node.spcNode, target_node.relNode);
+
+        AbortCurrentTransaction();
+
+        /* not our target relation */
+        if (relationId != MyReplicationSlot->relid)
+        {
+            ReorderBufferReturnChange(ctx->reorder, change);
+            return;
+        }
 #if 0
         if (xlrec->flags & XLH_UPDATE_CONTAINS_NEW_TUPLE)
         {
@@ -1037,12 +1054,6 @@ DecodeUpdate(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
         xl_heap_header xlhdr;
         Oid relationId;
 
-        StartTransactionCommand();
-        
-        relationId = RelidByRelfilenode(target_node.spcNode, target_node.relNode);
-
-        AbortCurrentTransaction();
-
         memset(&xlhdr, 0, sizeof(xl_heap_header));
         
         if (xlrec->flags & XLH_UPDATE_CONTAINS_NEW_TUPLE)
@@ -1060,10 +1071,23 @@ DecodeUpdate(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
             xlhdr.t_shardid = InvalidShardID;
         }
 
+        if (ShardIsSkipped(xlhdr.t_shardid))
+        {
+            ReorderBufferReturnChange(ctx->reorder, change);
+            return;
+        }
+
+        StartTransactionCommand();
+        
+        relationId = RelidByRelfilenode(target_node.spcNode, target_node.relNode);
+
+        AbortCurrentTransaction();
+
         found = RelationShardIsTarget(relationId, xlhdr.t_shardid);
 
         if (!found)
         {
+            ReorderBufferReturnChange(ctx->reorder, change);
             return;
         }
     }
@@ -1157,18 +1181,7 @@ DecodeDelete(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
         xl_heap_header xlhdr;
         Oid relationId;
 
-        StartTransactionCommand();
-        
-        relationId = RelidByRelfilenode(target_node.spcNode, target_node.relNode);
-
-        AbortCurrentTransaction();
-
-        /* not our target relation */
-        if (relationId != MyReplicationSlot->relid)
-        {
-            return;
-        }
-
+        /* check the shard first, it needs no catalog access */
         if (xlrec->flags & XLH_DELETE_CONTAINS_OLD)
         {
             memcpy((char *) &xlhdr, (char *) xlrec + SizeOfHeapDelete, SizeOfHeapHeader);
@@ -1178,12 +1191,25 @@ DecodeDelete(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
                 /* not our target shard */
                 if (!bms_is_member(xlhdr.t_shardid, MyReplicationSlot->shards))
                 {
+                    MyReplicationSlot->nshard_skipped++;
                     return;
                 }
             }
 
             //MyReplicationSlot->ntups_delete++;
         }
+
+        StartTransactionCommand();
+        
+        relationId = RelidByRelfilenode(target_node.spcNode, target_node.relNode);
+
+        AbortCurrentTransaction();
+
+        /* not our target relation */
+        if (relationId != MyReplicationSlot->relid)
+        {
+            return;
+        }
     }
     else if (MyReplicationSlot->npubs)
     {
@@ -1193,6 +1219,10 @@ DecodeDelete(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
 
         if (xlrec->flags & XLH_DELETE_CONTAINS_OLD)
         {
+            memcpy((char *) &xlhdr, (char *) xlrec + SizeOfHeapDelete, SizeOfHeapHeader);
+
+            if (ShardIsSkipped(xlhdr.t_shardid))
+                return;
 
             StartTransactionCommand();
             
@@ -1200,9 +1230,6 @@ DecodeDelete(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
 
             AbortCurrentTransaction();
 
-
-            memcpy((char *) &xlhdr, (char *) xlrec + SizeOfHeapDelete, SizeOfHeapHeader);
-
             found = RelationShardIsTarget(relationId, xlhdr.t_shardid);
 
             if (!found)
@@ -1304,6 +1331,19 @@ DecodeMultiInsert(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
             if (OidIsValid(MyReplicationSlot->relid))
             {
                 Oid relationId;
+
+                /* check the shard first, it needs no catalog access */
+                if (MyReplicationSlot->shards)
+                {
+                    /* not our target shard */
+                    if (!bms_is_member(xlhdr->t_shardid, MyReplicationSlot->shards))
+                    {
+                        data += datalen;
+                        ReorderBufferReturnChange(ctx->reorder, change);
+                        MyReplicationSlot->nshard_skipped++;
+                        continue;
+                    }
+                }
                 
                 StartTransactionCommand();
                 
@@ -1319,17 +1359,6 @@ DecodeMultiInsert(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
                     continue;
                 }
         
-                if (MyReplicationSlot->shards)
-                {
-                    /* not our target shard */
-                    if (!bms_is_member(xlhdr->t_shardid, MyReplicationSlot->shards))
-                    {
-                        data += datalen;
-                        ReorderBufferReturnChange(ctx->reorder, change);
-                        continue;
-                    }
-                }
-        
                 //MyReplicationSlot->ntups_insert++;
             }
             else if (MyReplicationSlot->npubs)
@@ -1337,6 +1366,13 @@ DecodeMultiInsert(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
                 bool found;
                 Oid relationId;
 
+                if (ShardIsSkipped(xlhdr->t_shardid))
+                {
+                    data += datalen;
+                    ReorderBufferReturnChange(ctx->reorder, change);
+                    continue;
+                }
+
                 StartTransactionCommand();
                 
                 relationId = RelidByRelfilenode(rnode.spcNode, rnode.relNode);
@@ -1381,6 +1417,9 @@ DecodeMultiInsert(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
             header->t_infomask = xlhdr->t_infomask;
             header->t_infomask2 = xlhdr->t_infomask2;
             header->t_hoff = xlhdr->t_hoff;
+#ifdef __STORAGE_SCALABLE__
+            header->t_shardid = xlhdr->t_shardid;
+#endif
         }
 
         /*
@@ -1480,6 +1519,10 @@ DecodeXLogTuple(char *data, Size len, ReorderBufferTupleBuf *tuple)
     header->t_infomask = xlhdr.t_infomask;
     header->t_infomask2 = xlhdr.t_infomask2;
     header->t_hoff = xlhdr.t_hoff;
+#ifdef __STORAGE_SCALABLE__
+    /* old tuples and keys route by shard as well, see pgoutput_change */
+    header->t_shardid = xlhdr.t_shardid;
+#endif
 }
 #ifdef __STORAGE_SCALABLE__
 static bool
@@ -1502,6 +1545,26 @@ RelationShardIsTarget(Oid relid, int32 shardid)
 
     return found;
 }
+
+/*
+ * Is a change of the given shard not wanted by any of the publications? This
+ * needs no catalog access, unlike RelationShardIsTarget, so it is checked
+ * before looking up the relation of the change.
+ */
+static bool
+ShardIsSkipped(int32 shardid)
+{
+    if (MyReplicationSlot->pubshards_union == NULL)
+        return false;
+
+    if (ShardIDIsValid(shardid) &&
+        bms_is_member(shardid, MyReplicationSlot->pubshards_union))
+        return false;
+
+    MyReplicationSlot->nshard_skipped++;
+    return true;
+}
+
 static void
 SetSkipSpecConfirm(TransactionId xid)
 {
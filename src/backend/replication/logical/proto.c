@@ -955,6 +955,17 @@ int32 logicalrep_dml_calc_hash(Relation rel, HeapTuple tuple)
     uint64        sum = 0;
     int32        ret = 0;
 
+#ifdef __STORAGE_SCALABLE__
+    /*
+     * Rows of a sharded table never change their shard, so the shard id sends
+     * all changes of a row, and of a whole shard, to the same parallel
+     * sub-subscription. It saves deforming and hashing the key columns of
+     * every change.
+     */
+    if (RelationIsSharded(rel) && ShardIDIsValid(tuple->t_data->t_shardid))
+        return tuple->t_data->t_shardid % logicalrep_dml_hashmod;
+#endif
+
     desc = RelationGetDescr(rel);
     heap_deform_tuple(tuple, desc, values, isnull);
 
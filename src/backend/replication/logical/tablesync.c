@@ -88,6 +88,7 @@
 #include "miscadmin.h"
 #include "pgstat.h"
 
+#include "access/transam.h"
 #include "access/xact.h"
 
 #include "catalog/pg_subscription_rel.h"
@@ -95,6 +96,8 @@
 
 #include "commands/copy.h"
 
+#include "nodes/makefuncs.h"
+
 #include "parser/parse_relation.h"
 
 #include "replication/logicallauncher.h"
@@ -108,6 +111,7 @@
 #include "utils/builtins.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
+#include "utils/syscache.h"
 #ifdef __STORAGE_SCALABLE__
 #include "replication/logicalrelation.h"
 #include "replication/logical_statistic.h"
@@ -721,6 +725,49 @@ make_copy_attnamelist(LogicalRepRelMapEntry *rel)
     return attnamelist;
 }
 
+#ifdef __SUBSCRIPTION__
+/*
+ * Can the initial copy be done in binary format?
+ *
+ * Binary COPY skips the output/input functions on both sides, which is a
+ * big part of the cost of syncing large tables. It requires every column
+ * to have the same type on both sides, so only accept built-in types, whose
+ * OIDs are the same everywhere, with a binary receive function.
+ */
+static bool
+copy_table_binary_ok(LogicalRepRelMapEntry *relmapentry)
+{
+    TupleDesc   desc = RelationGetDescr(relmapentry->localrel);
+    int         i;
+
+    for (i = 0; i < desc->natts; i++)
+    {
+        Form_pg_attribute attr = desc->attrs[i];
+        int         remoteattnum = relmapentry->attrmap[i];
+        HeapTuple   typtup;
+        bool        hasrecv;
+
+        if (attr->attisdropped || remoteattnum < 0)
+            continue;
+
+        if (attr->atttypid >= FirstBootstrapObjectId ||
+            attr->atttypid != relmapentry->remoterel.atttyps[remoteattnum])
+            return false;
+
+        typtup = SearchSysCache1(TYPEOID, ObjectIdGetDatum(attr->atttypid));
+        if (!HeapTupleIsValid(typtup))
+            return false;
+        hasrecv = OidIsValid(((Form_pg_type) GETSTRUCT(typtup))->typreceive);
+        ReleaseSysCache(typtup);
+
+        if (!hasrecv)
+            return false;
+    }
+
+    return true;
+}
+#endif
+
 /*
  * Data source callback for the COPY FROM, which reads from the remote
  * connection and passes the data back to our local COPY.
@@ -926,6 +973,7 @@ copy_table(Relation rel)
     CopyState    cstate;
     List       *attnamelist;
     ParseState *pstate;
+    List       *options = NIL;
 #ifdef __STORAGE_SCALABLE__
     uint64 nCopyIn = 0;
 #endif
@@ -940,6 +988,12 @@ copy_table(Relation rel)
     relmapentry = logicalrep_rel_open(lrel.remoteid, NoLock);
     Assert(rel == relmapentry->localrel);
 
+#ifdef __SUBSCRIPTION__
+    if (copy_table_binary_ok(relmapentry))
+        options = list_make1(makeDefElem("format",
+                                         (Node *) makeString("binary"), -1));
+#endif
+
     /* Start copy on the publisher. */
     initStringInfo(&cmd);
 #ifdef __STORAGE_SCALABLE__
@@ -966,12 +1020,16 @@ copy_table(Relation rel)
         }
         
         appendStringInfoString(&cmd, ") TO STDOUT");
+        if (options)
+            appendStringInfoString(&cmd, " WITH (FORMAT binary)");
     }
     else
     {
 #endif
     appendStringInfo(&cmd, "COPY %s TO STDOUT",
                      quote_qualified_identifier(lrel.nspname, lrel.relname));
+    if (options)
+        appendStringInfoString(&cmd, " WITH (FORMAT binary)");
 #ifdef __STORAGE_SCALABLE__
     }
 #endif
@@ -989,7 +1047,7 @@ copy_table(Relation rel)
     addRangeTableEntryForRelation(pstate, rel, NULL, false, false);
 
     attnamelist = make_copy_attnamelist(relmapentry);
-    cstate = BeginCopyFrom(pstate, rel, NULL, false, copy_read_data, attnamelist, NIL);
+    cstate = BeginCopyFrom(pstate, rel, NULL, false, copy_read_data, attnamelist, options);
 
     /* Do the copy */
 #ifdef __STORAGE_SCALABLE__
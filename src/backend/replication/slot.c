@@ -323,6 +323,8 @@ ReplicationSlotCreate(const char *name, bool db_specific,
     slot->npubs = 0;
     slot->alltables = NULL;
     slot->pubshards = NULL;
+    slot->pubshards_union = NULL;
+    slot->nshard_skipped = 0;
     slot->tables = NULL;
     slot->ntups_insert = 0;
     slot->ntups_delete = 0;
@@ -1730,6 +1732,8 @@ RestoreSlotFromDisk(const char *name)
 	slot->npubs = 0;
 	slot->alltables = NULL;
 	slot->pubshards = NULL;
+	slot->pubshards_union = NULL;
+	slot->nshard_skipped = 0;
 	slot->tables = NULL;
 	slot->ntups_insert = 0;
 	slot->ntups_delete = 0;
@@ -2067,6 +2071,8 @@ static void replication_slot_redo_create(xl_replication_slot_create * xlrec)
     slot->npubs = 0;
     slot->alltables = NULL;
     slot->pubshards = NULL;
+    slot->pubshards_union = NULL;
+    slot->nshard_skipped = 0;
     slot->tables = NULL;
     slot->ntups_insert = 0;
     slot->ntups_delete = 0;
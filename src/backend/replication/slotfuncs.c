@@ -183,7 +183,7 @@ pg_drop_replication_slot(PG_FUNCTION_ARGS)
 Datum
 pg_get_replication_slots(PG_FUNCTION_ARGS)
 {// #lizard forgives
-#define PG_GET_REPLICATION_SLOTS_COLS 11
+#define PG_GET_REPLICATION_SLOTS_COLS 12
     ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
     TupleDesc    tupdesc;
     Tuplestorestate *tupstore;
@@ -235,6 +235,9 @@ pg_get_replication_slots(PG_FUNCTION_ARGS)
         XLogRecPtr    restart_lsn;
         XLogRecPtr    confirmed_flush_lsn;
         pid_t        active_pid;
+#ifdef __STORAGE_SCALABLE__
+        uint64        nshard_skipped;
+#endif
         Oid            database;
         NameData    slot_name;
         NameData    plugin;
@@ -254,6 +257,9 @@ pg_get_replication_slots(PG_FUNCTION_ARGS)
         namecpy(&plugin, &slot->data.plugin);
         active_pid = slot->active_pid;
         persistency = slot->data.persistency;
+#ifdef __STORAGE_SCALABLE__
+        nshard_skipped = slot->nshard_skipped;
+#endif
 
         SpinLockRelease(&slot->mutex);
 
@@ -305,6 +311,13 @@ pg_get_replication_slots(PG_FUNCTION_ARGS)
         else
             nulls[i++] = true;
 
+#ifdef __STORAGE_SCALABLE__
+        if (database != InvalidOid)
+            values[i++] = Int64GetDatum((int64) nshard_skipped);
+        else
+#endif
+            nulls[i++] = true;
+
         tuplestore_putvalues(tupstore, tupdesc, values, nulls);
     }
     LWLockRelease(ReplicationSlotControlLock);
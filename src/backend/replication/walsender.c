@@ -1408,6 +1408,7 @@ StartLogicalReplication(StartReplicationCmd *cmd)
                 MemoryContextSwitchTo(temp);
 
                 list_free(shard);
+                i++;
             }
 
             /*
@@ -1419,6 +1420,26 @@ StartLogicalReplication(StartReplicationCmd *cmd)
             AbortCurrentTransaction();
 
             MemoryContextSwitchTo(old);
+
+            /*
+             * Union of the shards of all publications, used by decoding to
+             * throw away changes of other shards before looking up their
+             * relation.
+             */
+            MyReplicationSlot->pubshards_union = NULL;
+            for (i = 0; i < MyReplicationSlot->npubs; i++)
+            {
+                if (MyReplicationSlot->pubshards[i] == NULL)
+                {
+                    bms_free(MyReplicationSlot->pubshards_union);
+                    MyReplicationSlot->pubshards_union = NULL;
+                    break;
+                }
+
+                MyReplicationSlot->pubshards_union =
+                    bms_add_members(MyReplicationSlot->pubshards_union,
+                                    MyReplicationSlot->pubshards[i]);
+            }
         }
     }
 #endif
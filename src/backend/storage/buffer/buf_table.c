@@ -9,6 +9,11 @@
  * in most cases the caller needs to adjust the buffer header contents
  * before the lock is released (see notes in README).
  *
+ * The one exception is BufTableLookupHint(), which peeks into a lock-free
+ * array of hints remembering which buffer was last mapped for a hash code.
+ * A hint can be stale or belong to another tag with the same hash slot, so
+ * the caller must pin the buffer and check its tag before trusting it.
+ *
  *
  * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
  * Portions Copyright (c) 1994, Regents of the University of California
@@ -21,8 +26,11 @@
  */
 #include "postgres.h"
 
+#include "port/atomics.h"
 #include "storage/bufmgr.h"
 #include "storage/buf_internals.h"
+#include "storage/shmem.h"
+#include "utils/dynahash.h"
 
 
 /* entry for buffer lookup hashtable */
@@ -34,6 +42,22 @@ typedef struct
 
 static HTAB *SharedBufHash;
 
+#ifdef __TBASE__
+/*
+ * Lookup hints, indexed by the low bits of the hash code.  Each slot holds
+ * buffer ID + 1 of the latest buffer mapped for a tag hashing there, or 0.
+ */
+static pg_atomic_uint32 *SharedBufHints;
+static uint32 SharedBufHintMask;
+
+/* twice as many slots as buffers keeps collisions rare */
+static uint32
+BufTableHintSlots(void)
+{
+    return (uint32) 1 << my_log2((long) NBuffers * 2);
+}
+#endif
+
 
 /*
  * Estimate space needed for mapping hashtable
@@ -42,7 +66,12 @@ static HTAB *SharedBufHash;
 Size
 BufTableShmemSize(int size)
 {
+#ifdef __TBASE__
+    return add_size(hash_estimate_size(size, sizeof(BufferLookupEnt)),
+                    mul_size(BufTableHintSlots(), sizeof(pg_atomic_uint32)));
+#else
     return hash_estimate_size(size, sizeof(BufferLookupEnt));
+#endif
 }
 
 /*
@@ -53,6 +82,10 @@ void
 InitBufTable(int size)
 {
     HASHCTL        info;
+#ifdef __TBASE__
+    bool        found;
+    uint32        nslots = BufTableHintSlots();
+#endif
 
     /* assume no locking is needed yet */
 
@@ -65,6 +98,22 @@ InitBufTable(int size)
                                   size, size,
                                   &info,
                                   HASH_ELEM | HASH_BLOBS | HASH_PARTITION);
+
+#ifdef __TBASE__
+    SharedBufHints = (pg_atomic_uint32 *)
+        ShmemInitStruct("Shared Buffer Lookup Hints",
+                        mul_size(nslots, sizeof(pg_atomic_uint32)),
+                        &found);
+    SharedBufHintMask = nslots - 1;
+
+    if (!found)
+    {
+        uint32        i;
+
+        for (i = 0; i < nslots; i++)
+            pg_atomic_init_u32(&SharedBufHints[i], 0);
+    }
+#endif
 }
 
 /*
@@ -103,9 +152,40 @@ BufTableLookup(BufferTag *tagPtr, uint32 hashcode)
     if (!result)
         return -1;
 
+#ifdef __TBASE__
+    /*
+     * Restore the hint if a colliding tag took the slot over.  Only write
+     * when it differs, to keep the cache line shared among readers.
+     */
+    if (pg_atomic_read_u32(&SharedBufHints[hashcode & SharedBufHintMask]) !=
+        (uint32) result->id + 1)
+        pg_atomic_write_u32(&SharedBufHints[hashcode & SharedBufHintMask],
+                            (uint32) result->id + 1);
+#endif
+
     return result->id;
 }
 
+#ifdef __TBASE__
+/*
+ * BufTableLookupHint
+ *        Guess the buffer ID for the given hash code without any locking;
+ *        return -1 if there is no guess
+ *
+ * The returned buffer may hold any page.  The caller has to pin it, which
+ * keeps its tag from changing, and then compare the tag with the wanted one.
+ */
+int
+BufTableLookupHint(uint32 hashcode)
+{
+    uint32        hint;
+
+    hint = pg_atomic_read_u32(&SharedBufHints[hashcode & SharedBufHintMask]);
+
+    return (int) hint - 1;
+}
+#endif
+
 /*
  * BufTableInsert
  *        Insert a hashtable entry for given tag and buffer ID,
@@ -137,6 +217,11 @@ BufTableInsert(BufferTag *tagPtr, uint32 hashcode, int buf_id)
 
     result->id = buf_id;
 
+#ifdef __TBASE__
+    pg_atomic_write_u32(&SharedBufHints[hashcode & SharedBufHintMask],
+                        (uint32) buf_id + 1);
+#endif
+
     return -1;
 }
 
@@ -150,6 +235,25 @@ void
 BufTableDelete(BufferTag *tagPtr, uint32 hashcode)
 {
     BufferLookupEnt *result;
+#ifdef __TBASE__
+    uint32        expected;
+
+    /*
+     * Fetch the buffer id while the entry is still live; once HASH_REMOVE
+     * returns, the entry is back on the freelist and may be reused.
+     */
+    result = (BufferLookupEnt *)
+        hash_search_with_hash_value(SharedBufHash,
+                                    (void *) tagPtr,
+                                    hashcode,
+                                    HASH_FIND,
+                                    NULL);
+
+    if (!result)                /* shouldn't happen */
+        elog(ERROR, "shared buffer hash table corrupted");
+
+    expected = (uint32) result->id + 1;
+#endif
 
     result = (BufferLookupEnt *)
         hash_search_with_hash_value(SharedBufHash,
@@ -160,4 +264,10 @@ BufTableDelete(BufferTag *tagPtr, uint32 hashcode)
 
     if (!result)                /* shouldn't happen */
         elog(ERROR, "shared buffer hash table corrupted");
+
+#ifdef __TBASE__
+    /* leave the slot alone if another tag took it over */
+    pg_atomic_compare_exchange_u32(&SharedBufHints[hashcode & SharedBufHintMask],
+                                   &expected, 0);
+#endif
 }
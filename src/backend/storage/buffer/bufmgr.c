@@ -44,6 +44,9 @@
 #include "pg_trace.h"
 #include "pgstat.h"
 #include "postmaster/bgwriter.h"
+#ifdef __TBASE__
+#include "postmaster/ckptwriter.h"
+#endif
 #include "storage/buf_internals.h"
 #include "storage/bufmgr.h"
 #include "storage/ipc.h"
@@ -57,6 +60,10 @@
 #include "utils/mls.h"
 #include "utils/relcrypt.h"
 #include "storage/relcryptstorage.h"
+#include "storage/decrypt_cache.h"
+#endif
+#ifdef __TBASE__
+#include "pgxc/shardmap.h"
 #endif
 
 
@@ -625,6 +632,48 @@ PrefetchBuffer(Relation reln, ForkNumber forkNum, BlockNumber blockNum)
 #endif                            /* USE_PREFETCH */
 }
 
+#ifdef __TBASE__
+/*
+ * PrefetchRedoBuffer -- initiate asynchronous read of a block WAL redo is
+ * going to need
+ *
+ * Unlike PrefetchBuffer, the relation may not exist yet, or be shorter than
+ * the block; such blocks are silently skipped. Returns true if a read was
+ * initiated.
+ */
+bool
+PrefetchRedoBuffer(RelFileNode rnode, ForkNumber forkNum, BlockNumber blockNum)
+{
+#ifdef USE_PREFETCH
+    SMgrRelation smgr;
+    BufferTag    newTag;        /* identity of requested block */
+    uint32        newHash;    /* hash value for newTag */
+    LWLock       *newPartitionLock;    /* buffer partition lock for it */
+    int            buf_id;
+
+    INIT_BUFFERTAG(newTag, rnode, forkNum, blockNum);
+    newHash = BufTableHashCode(&newTag);
+    newPartitionLock = BufMappingPartitionLock(newHash);
+
+    /* nothing to do if the block is in the buffer pool already */
+    LWLockAcquire(newPartitionLock, LW_SHARED);
+    buf_id = BufTableLookup(&newTag, newHash);
+    LWLockRelease(newPartitionLock);
+    if (buf_id >= 0)
+        return false;
+
+    smgr = smgropen(rnode, InvalidBackendId);
+    if (!smgrexists(smgr, forkNum) || blockNum >= smgrnblocks(smgr, forkNum))
+        return false;
+
+    smgrprefetch(smgr, forkNum, blockNum);
+    return true;
+#else
+    return false;
+#endif                            /* USE_PREFETCH */
+}
+#endif
+
 
 /*
  * ReadBuffer -- a shorthand for ReadBufferExtended, for reading from main
@@ -751,6 +800,7 @@ ReadBuffer_common(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
     bool        isLocalBuf = SmgrIsTemp(smgr);
 #ifdef _MLS_
     int16       algo_id;
+    bool        from_cache = false;
 #endif
     *hit = false;
 
@@ -802,6 +852,11 @@ ReadBuffer_common(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
             /* Just need to update stats before we exit */
             *hit = true;
             VacuumPageHit++;
+#ifdef __TBASE__
+            if (!isLocalBuf && forkNum == MAIN_FORKNUM)
+                CountShardBufferAccess(PageGetShardId(BufHdrGetBlock(bufHdr)),
+                                       SHARD_BUFFER_HIT);
+#endif
 
             if (VacuumCostActive)
                 VacuumCostBalance += VacuumCostPageHit;
@@ -903,6 +958,27 @@ ReadBuffer_common(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 
     bufBlock = isLocalBuf ? LocalBufHdrGetBlock(bufHdr) : BufHdrGetBlock(bufHdr);
 
+#ifdef _MLS_
+    /*
+     * A block going into shared buffers always leaves the decrypted page
+     * cache, so that the cache never holds an older version of a block than
+     * the buffer pool does.
+     */
+    if (!isLocalBuf && DecryptCacheEnabled() &&
+        (MAIN_FORKNUM == forkNum || EXTENT_FORKNUM == forkNum))
+    {
+        if (isExtend ||
+            mode == RBM_ZERO_AND_LOCK || mode == RBM_ZERO_AND_CLEANUP_LOCK)
+            DecryptCacheForget(&bufHdr->tag);
+        else
+        {
+            BufDisableMemoryProtection(bufBlock, isLocalBuf);
+            from_cache = DecryptCacheLookup(&bufHdr->tag, (char *) bufBlock);
+            BufEnableMemoryProtection(bufBlock, isLocalBuf);
+        }
+    }
+#endif
+
     if (isExtend)
     {
         /* new buffers are zero-filled */
@@ -932,6 +1008,12 @@ ReadBuffer_common(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
             MemSet((char *) bufBlock, 0, BLCKSZ);
 			BufEnableMemoryProtection(bufBlock, isLocalBuf);
 		}
+#ifdef _MLS_
+        else if (from_cache)
+        {
+            /* already decrypted and verified when it was read the last time */
+        }
+#endif
         else
         {
             instr_time    io_start,
@@ -1039,6 +1121,13 @@ ReadBuffer_common(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
     if (VacuumCostActive)
         VacuumCostBalance += VacuumCostPageMiss;
 
+#ifdef __TBASE__
+    /* pages zeroed or added by the caller carry no shard yet */
+    if (!isLocalBuf && !isExtend && forkNum == MAIN_FORKNUM &&
+        mode != RBM_ZERO_AND_LOCK && mode != RBM_ZERO_AND_CLEANUP_LOCK)
+        CountShardBufferAccess(PageGetShardId(bufBlock), SHARD_BUFFER_READ);
+#endif
+
     TRACE_POSTGRESQL_BUFFER_READ_DONE(forkNum, blockNum,
                                       smgr->smgr_rnode.node.spcNode,
                                       smgr->smgr_rnode.node.dbNode,
@@ -1101,6 +1190,9 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
     BufferDesc *buf;
     bool        valid;
     uint32        buf_state;
+#ifdef _MLS_
+    bool        cached;            /* old page went to decrypted page cache */
+#endif
 
     /* create a tag so we can lookup the buffer */
     INIT_BUFFERTAG(newTag, smgr->smgr_rnode.node, forkNum, blockNum);
@@ -1109,6 +1201,45 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
     newHash = BufTableHashCode(&newTag);
     newPartitionLock = BufMappingPartitionLock(newHash);
 
+#ifdef __TBASE__
+    /*
+     * Try to find the block without taking the mapping partition lock.  The
+     * hint may point to any buffer, but once we hold a pin the buffer can't
+     * be given another tag: a victim buffer is only retagged while its
+     * evictor holds the only pin, and InvalidateBuffer waits for pins to go
+     * away.  So a pinned buffer whose tag is valid and matches ours is the
+     * same buffer the mapping table would have returned.
+     */
+    buf_id = BufTableLookupHint(newHash);
+    if (buf_id >= 0)
+    {
+        buf = GetBufferDescriptor(buf_id);
+
+        valid = PinBuffer(buf, strategy);
+
+        /* pairs with the barrier implied by the header lock of the retagger */
+        pg_read_barrier();
+
+        if ((pg_atomic_read_u32(&buf->state) & BM_TAG_VALID) &&
+            BUFFERTAGS_EQUAL(buf->tag, newTag))
+        {
+            *foundPtr = TRUE;
+
+            if (!valid)
+            {
+                /* see below */
+                if (StartBufferIO(buf, true))
+                    *foundPtr = FALSE;
+            }
+
+            return buf;
+        }
+
+        /* wrong guess, take the slow path */
+        UnpinBuffer(buf, true);
+    }
+#endif
+
     /* see if the block is in the buffer pool already */
     LWLockAcquire(newPartitionLock, LW_SHARED);
     buf_id = BufTableLookup(&newTag, newHash);
@@ -1384,6 +1515,24 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
             return buf;
         }
 
+#ifdef _MLS_
+        /*
+         * Hand a decrypted page to the decrypted page cache before its old
+         * tag goes away, so that nobody can read the block from disk in
+         * between.  If we can't recycle the buffer after all, the entry is
+         * forgotten again below.
+         */
+        cached = false;
+        if (DecryptCacheEnabled() && oldPartitionLock != NULL &&
+            (oldFlags & BM_VALID) &&
+            (oldTag.forkNum == MAIN_FORKNUM || oldTag.forkNum == EXTENT_FORKNUM) &&
+            TRANSP_CRYPT_ALGO_ID_IS_VALID(PageGetAlgorithmId(BufHdrGetBlock(buf))))
+        {
+            DecryptCacheInsert(&oldTag, (char *) BufHdrGetBlock(buf));
+            cached = true;
+        }
+#endif
+
         /*
          * Need to lock the buffer header too in order to change its tag.
          */
@@ -1400,6 +1549,10 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
             break;
 
         UnlockBufHdr(buf, buf_state);
+#ifdef _MLS_
+        if (cached)
+            DecryptCacheForget(&oldTag);
+#endif
         BufTableDelete(&newTag, newHash);
         if (oldPartitionLock != NULL &&
             oldPartitionLock != newPartitionLock)
@@ -1916,6 +2069,9 @@ BufferSync(int flags)
     ListCell   *l = NULL;
 #endif
     WritebackContext wb_context;
+#ifdef __TBASE__
+    int            num_parallel_written = 0;
+#endif
 
     /* Make sure we can handle the pin inside SyncOneBuffer */
     ResourceOwnerEnlargeBuffers(CurrentResourceOwner);
@@ -1994,6 +2150,38 @@ BufferSync(int flags)
     qsort(CkptBufferIds, num_to_scan, sizeof(CkptSortItem),
           ckpt_buforder_comparator);
 
+#ifdef __TBASE__
+    /*
+     * If there are checkpoint writers, let them write the sorted buffers in
+     * parallel first.  Whatever they left behind is still marked
+     * BM_CHECKPOINT_NEEDED; squeeze those entries together, which keeps them
+     * sorted, and write them ourselves below.
+     */
+    if (CheckpointWritersAvailable())
+    {
+        int            j = 0;
+
+        num_parallel_written = CheckpointWritersSync(flags, num_to_scan);
+
+        for (i = 0; i < num_to_scan; i++)
+        {
+            BufferDesc *bufHdr = GetBufferDescriptor(CkptBufferIds[i].buf_id);
+
+            if (pg_atomic_read_u32(&bufHdr->state) & BM_CHECKPOINT_NEEDED)
+                CkptBufferIds[j++] = CkptBufferIds[i];
+        }
+        num_to_scan = j;
+
+        if (num_to_scan == 0)
+        {
+            CheckpointStats.ckpt_bufs_written += num_parallel_written;
+            BgWriterStats.m_buf_written_checkpoints += num_parallel_written;
+            TRACE_POSTGRESQL_BUFFER_SYNC_DONE(NBuffers, num_parallel_written, 0);
+            return;
+        }
+    }
+#endif
+
     num_spaces = 0;
 
     /*
@@ -2215,6 +2403,10 @@ BufferSync(int flags)
      * Update checkpoint statistics. As noted above, this doesn't include
      * buffers written by other backends or bgwriter scan.
      */
+#ifdef __TBASE__
+    num_written += num_parallel_written;
+    BgWriterStats.m_buf_written_checkpoints += num_parallel_written;
+#endif
     CheckpointStats.ckpt_bufs_written += num_written;
 
     TRACE_POSTGRESQL_BUFFER_SYNC_DONE(NBuffers, num_written, num_to_scan);
@@ -2225,6 +2417,43 @@ BufferSync(int flags)
 #endif    
 }
 
+#ifdef __TBASE__
+/*
+ * BufferSyncRange -- Write out entries [from, to) of the sorted checkpoint
+ * buffer array.
+ *
+ * Used by the checkpoint writers while BufferSync() waits for them.  Buffers
+ * that are no longer marked BM_CHECKPOINT_NEEDED have been written by someone
+ * else already and are skipped.  Returns the number of buffers written.
+ */
+int
+BufferSyncRange(int from, int to, WritebackContext *wb_context)
+{
+    int            num_written = 0;
+    int            i;
+
+    for (i = from; i < to; i++)
+    {
+        int            buf_id = CkptBufferIds[i].buf_id;
+        BufferDesc *bufHdr = GetBufferDescriptor(buf_id);
+
+        /* see the comment in BufferSync() about the unlocked check */
+        if (pg_atomic_read_u32(&bufHdr->state) & BM_CHECKPOINT_NEEDED)
+        {
+            ResourceOwnerEnlargeBuffers(CurrentResourceOwner);
+
+            if (SyncOneBuffer(buf_id, false, wb_context) & BUF_WRITTEN)
+            {
+                TRACE_POSTGRESQL_BUFFER_SYNC_WRITTEN(buf_id);
+                num_written++;
+            }
+        }
+    }
+
+    return num_written;
+}
+#endif
+
 /*
  * BgBufferSync -- Write out some dirty buffers in the pool.
  *
@@ -2996,6 +3225,10 @@ FlushBuffer(BufferDesc *buf, SMgrRelation reln)
         }
 
         pgBufferUsage.shared_blks_written++;
+#ifdef __TBASE__
+        if (buf->tag.forkNum == MAIN_FORKNUM)
+            CountShardBufferAccess(PageGetShardId(bufBlock), SHARD_BUFFER_WRITE);
+#endif
 #ifdef _SHARDING_
     }
 #endif
@@ -3160,6 +3393,10 @@ DropRelFileNodeBuffers(RelFileNodeBackend rnode, ForkNumber forkNum,
         else
             UnlockBufHdr(bufHdr, buf_state);
     }
+
+#ifdef _MLS_
+    DecryptCacheDropRelFileNodes(&rnode.node, 1, forkNum, firstDelBlock);
+#endif
 }
 
 /* ---------------------------------------------------------------------
@@ -3260,6 +3497,10 @@ DropRelFileNodesAllBuffers(RelFileNodeBackend *rnodes, int nnodes)
             UnlockBufHdr(bufHdr, buf_state);
     }
 
+#ifdef _MLS_
+    DecryptCacheDropRelFileNodes(nodes, n, InvalidForkNumber, 0);
+#endif
+
     pfree(nodes);
 }
 
@@ -3302,6 +3543,10 @@ DropDatabaseBuffers(Oid dbid)
         else
             UnlockBufHdr(bufHdr, buf_state);
     }
+
+#ifdef _MLS_
+    DecryptCacheDropDatabase(dbid);
+#endif
 }
 
 #ifdef _SHARDING_
@@ -3343,6 +3588,10 @@ void DropRelfileNodeShardBuffers(RelFileNode rnode, ShardID sid)
         else
             UnlockBufHdr(bufHdr, buf_state);
     }
+
+#ifdef _MLS_
+    DecryptCacheDropShard(&rnode, sid);
+#endif
 }
 
 void DropRelfileNodeExtentBuffers(RelFileNode rnode, ExtentID eid)
@@ -3386,6 +3635,11 @@ void DropRelfileNodeExtentBuffers(RelFileNode rnode, ExtentID eid)
         else
             UnlockBufHdr(bufHdr, buf_state);
     }
+
+#ifdef _MLS_
+    DecryptCacheDropBlocks(&rnode, MAIN_FORKNUM, eid * PAGES_PER_EXTENTS,
+                           (eid + 1) * PAGES_PER_EXTENTS);
+#endif
 }
 #endif
 
@@ -5097,6 +5351,11 @@ static void SyncBufferPostPhase2(List * buf_id_list)
         }
 
         pgBufferUsage.shared_blks_written++;
+#ifdef __TBASE__
+        if (buf->tag.forkNum == MAIN_FORKNUM)
+            CountShardBufferAccess(PageGetShardId(BufHdrGetBlock(buf)),
+                                   SHARD_BUFFER_WRITE);
+#endif
         
         /*
          * Mark the buffer as clean (unless BM_JUST_DIRTIED has become set) and
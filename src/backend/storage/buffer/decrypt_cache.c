@@ -0,0 +1,495 @@
+/*
+ * Tencent is pleased to support the open source community by making TBase available.  
+ * 
+ * Copyright (C) 2019 THL A29 Limited, a Tencent company.  All rights reserved.
+ * 
+ * TBase is licensed under the BSD 3-Clause License, except for the third-party component listed below. 
+ * 
+ * A copy of the BSD 3-Clause License is included in this file.
+ * 
+ * Other dependencies and licenses:
+ * 
+ * Open Source Software Licensed Under the PostgreSQL License: 
+ * --------------------------------------------------------------------
+ * 1. Postgres-XL XL9_5_STABLE
+ * Portions Copyright (c) 2015-2016, 2ndQuadrant Ltd
+ * Portions Copyright (c) 2012-2015, TransLattice, Inc.
+ * Portions Copyright (c) 2010-2017, Postgres-XC Development Group
+ * Portions Copyright (c) 1996-2015, The PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, The Regents of the University of California
+ * 
+ * Terms of the PostgreSQL License: 
+ * --------------------------------------------------------------------
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation for any purpose, without fee, and without a written agreement
+ * is hereby granted, provided that the above copyright notice and this
+ * paragraph and the following two paragraphs appear in all copies.
+ * 
+ * IN NO EVENT SHALL THE UNIVERSITY OF CALIFORNIA BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING
+ * LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS
+ * DOCUMENTATION, EVEN IF THE UNIVERSITY OF CALIFORNIA HAS BEEN ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ * 
+ * THE UNIVERSITY OF CALIFORNIA SPECIFICALLY DISCLAIMS ANY WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE UNIVERSITY OF CALIFORNIA HAS NO OBLIGATIONS TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ * 
+ * 
+ * Terms of the BSD 3-Clause License:
+ * --------------------------------------------------------------------
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of THL A29 Limited nor the names of its contributors may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH 
+ * DAMAGE.
+ * 
+ */
+/*-------------------------------------------------------------------------
+ *
+ * decrypt_cache.c
+ *      shared cache of decrypted pages evicted from the buffer pool.
+ *
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *      src/backend/storage/buffer/decrypt_cache.c
+ *
+ * NOTES:
+ *
+ *    Pages of encrypted relations are decrypted in place when they are read
+ *    into shared buffers, so every re-read of a page that has dropped out of
+ *    the buffer pool pays for a read and a decrypt again. When the buffer
+ *    manager recycles a clean buffer holding such a page it hands the
+ *    plaintext page to this cache, and a later read of the block takes it
+ *    from here instead of from disk.
+ *
+ *    The cache is exclusive: a block is either in shared buffers or in this
+ *    cache, never in both. Every read of a main or extent fork block into a
+ *    buffer consumes the cache entry of the block, whether or not the entry
+ *    is used, and a block that enters the buffer pool without being read
+ *    (extension and the zeroing read modes) forgets its entry. An entry thus
+ *    always holds the latest version of its block as long as the block only
+ *    changes through shared buffers. Everything that drops blocks or changes
+ *    them on disk behind the buffer manager's back has to invalidate their
+ *    entries: dropping a relation, a fork tail or a database, dropping the
+ *    buffers of a shard or an extent, and deallocating or reallocating the
+ *    storage of an extent.
+ *
+ *    Entries are only removed by lookups and drops, never touched by them,
+ *    so there is no use count to keep; each partition reuses its slots in
+ *    insertion order.
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "storage/bufpage.h"
+#include "storage/decrypt_cache.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "utils/hsearch.h"
+
+/* must be a power of 2 */
+#define DECRYPT_CACHE_PARTITIONS    16
+
+#define DecryptCachePartitionOf(hashcode) \
+    ((hashcode) % DECRYPT_CACHE_PARTITIONS)
+
+typedef struct DecryptCacheEnt
+{
+    BufferTag   key;            /* tag of the cached page */
+    int         slot;           /* index into DecryptCachePages */
+} DecryptCacheEnt;
+
+typedef struct DecryptCacheSlot
+{
+    BufferTag   tag;
+    bool        valid;
+} DecryptCacheSlot;
+
+typedef struct DecryptCachePartition
+{
+    int         first;          /* first slot owned by the partition */
+    int         hand;           /* next slot to reuse, relative to first */
+    int         nvalid;         /* number of used slots */
+} DecryptCachePartition;
+
+typedef struct DecryptCacheCtlData
+{
+    int                   lwlock_tranche_id;
+    int                   slots_per_partition;
+    LWLockPadded          locks[DECRYPT_CACHE_PARTITIONS];
+    DecryptCachePartition partitions[DECRYPT_CACHE_PARTITIONS];
+    DecryptCacheSlot      slots[FLEXIBLE_ARRAY_MEMBER];
+} DecryptCacheCtlData;
+
+#define DecryptCacheSlotPage(slot) \
+    (DecryptCachePages + (Size) (slot) * BLCKSZ)
+
+int decrypt_page_cache_size = 0;
+
+static DecryptCacheCtlData *DecryptCacheCtl = NULL;
+static char *DecryptCachePages = NULL;
+static HTAB *DecryptCacheHash = NULL;
+
+static int
+DecryptCacheSlotsPerPartition(void)
+{
+    return (decrypt_page_cache_size + DECRYPT_CACHE_PARTITIONS - 1) /
+        DECRYPT_CACHE_PARTITIONS;
+}
+
+static int
+DecryptCacheNumSlots(void)
+{
+    return DecryptCacheSlotsPerPartition() * DECRYPT_CACHE_PARTITIONS;
+}
+
+static Size
+DecryptCacheCtlSize(void)
+{
+    return add_size(offsetof(DecryptCacheCtlData, slots),
+                    mul_size(DecryptCacheNumSlots(), sizeof(DecryptCacheSlot)));
+}
+
+Size
+DecryptCacheShmemSize(void)
+{
+    Size        size;
+
+    if (!DecryptCacheEnabled())
+        return 0;
+
+    size = MAXALIGN64(DecryptCacheCtlSize());
+    /* pages, plus alignment padding */
+    size = add_size(size, mul_size(DecryptCacheNumSlots(), BLCKSZ));
+    size = add_size(size, PG_CACHE_LINE_SIZE);
+    size = add_size(size, MAXALIGN64(hash_estimate_size(DecryptCacheNumSlots(),
+                                                        sizeof(DecryptCacheEnt))));
+    return size;
+}
+
+void
+DecryptCacheShmemInit(void)
+{
+    HASHCTL     info;
+    bool        found;
+    int         nslots;
+    int         i;
+
+    if (!DecryptCacheEnabled())
+        return;
+
+    nslots = DecryptCacheNumSlots();
+
+    info.keysize = sizeof(BufferTag);
+    info.entrysize = sizeof(DecryptCacheEnt);
+    info.num_partitions = DECRYPT_CACHE_PARTITIONS;
+    DecryptCacheHash = ShmemInitHash("decrypted page cache table",
+                                     nslots, nslots,
+                                     &info,
+                                     HASH_ELEM | HASH_BLOBS | HASH_PARTITION);
+
+    DecryptCacheCtl = (DecryptCacheCtlData *)
+        ShmemInitStruct("decrypted page cache control",
+                        DecryptCacheCtlSize(), &found);
+    DecryptCachePages = (char *)
+        CACHELINEALIGN(ShmemInitStruct("decrypted page cache pages",
+                                       add_size(mul_size(nslots, BLCKSZ),
+                                                PG_CACHE_LINE_SIZE),
+                                       &found));
+    if (!found)
+    {
+        DecryptCacheCtl->lwlock_tranche_id = LWTRANCHE_DECRYPT_CACHE;
+        DecryptCacheCtl->slots_per_partition = DecryptCacheSlotsPerPartition();
+
+        for (i = 0; i < DECRYPT_CACHE_PARTITIONS; i++)
+        {
+            LWLockInitialize(&DecryptCacheCtl->locks[i].lock,
+                             DecryptCacheCtl->lwlock_tranche_id);
+            DecryptCacheCtl->partitions[i].first =
+                i * DecryptCacheCtl->slots_per_partition;
+            DecryptCacheCtl->partitions[i].hand = 0;
+            DecryptCacheCtl->partitions[i].nvalid = 0;
+        }
+
+        for (i = 0; i < nslots; i++)
+        {
+            CLEAR_BUFFERTAG(DecryptCacheCtl->slots[i].tag);
+            DecryptCacheCtl->slots[i].valid = false;
+        }
+
+        LWLockRegisterTranche(DecryptCacheCtl->lwlock_tranche_id,
+                              "decrypt page cache");
+    }
+}
+
+/*
+ * Unlink the entry of a used slot. Caller holds the partition lock
+ * exclusively.
+ */
+static void
+DecryptCacheReleaseSlot(DecryptCachePartition *part, int slot, uint32 hashcode)
+{
+    DecryptCacheSlot *s = &DecryptCacheCtl->slots[slot];
+
+    Assert(s->valid);
+
+    hash_search_with_hash_value(DecryptCacheHash, (void *) &s->tag,
+                                hashcode, HASH_REMOVE, NULL);
+    CLEAR_BUFFERTAG(s->tag);
+    s->valid = false;
+    part->nvalid--;
+}
+
+/*
+ * Take the entry of a block out of the cache. When it is there and page is
+ * not NULL, the cached page is copied into it. Returns whether the block was
+ * cached.
+ */
+static bool
+DecryptCacheTake(BufferTag *tag, char *page)
+{
+    uint32      hashcode;
+    int         partno;
+    LWLock     *lock;
+    DecryptCacheEnt *ent;
+
+    hashcode = get_hash_value(DecryptCacheHash, (void *) tag);
+    partno = DecryptCachePartitionOf(hashcode);
+    lock = &DecryptCacheCtl->locks[partno].lock;
+
+    LWLockAcquire(lock, LW_EXCLUSIVE);
+
+    ent = (DecryptCacheEnt *)
+        hash_search_with_hash_value(DecryptCacheHash, (void *) tag,
+                                    hashcode, HASH_FIND, NULL);
+    if (ent == NULL)
+    {
+        LWLockRelease(lock);
+        return false;
+    }
+
+    if (page != NULL)
+        memcpy(page, DecryptCacheSlotPage(ent->slot), BLCKSZ);
+
+    DecryptCacheReleaseSlot(&DecryptCacheCtl->partitions[partno], ent->slot,
+                            hashcode);
+    LWLockRelease(lock);
+
+    return true;
+}
+
+/*
+ * Called for every read of a block into a shared buffer. The entry of the
+ * block is consumed either way.
+ */
+bool
+DecryptCacheLookup(BufferTag *tag, char *page)
+{
+    Assert(DecryptCacheEnabled());
+
+    return DecryptCacheTake(tag, page);
+}
+
+/*
+ * Called when a block enters the buffer pool without being read.
+ */
+void
+DecryptCacheForget(BufferTag *tag)
+{
+    Assert(DecryptCacheEnabled());
+
+    DecryptCacheTake(tag, NULL);
+}
+
+/*
+ * Remember the contents of a clean page which is about to leave the buffer
+ * pool. The caller must make sure the buffer can not change under us.
+ */
+void
+DecryptCacheInsert(BufferTag *tag, char *page)
+{
+    uint32      hashcode;
+    int         partno;
+    int         slot;
+    LWLock     *lock;
+    DecryptCachePartition *part;
+    DecryptCacheEnt *ent;
+    bool        found;
+
+    Assert(DecryptCacheEnabled());
+
+    hashcode = get_hash_value(DecryptCacheHash, (void *) tag);
+    partno = DecryptCachePartitionOf(hashcode);
+    lock = &DecryptCacheCtl->locks[partno].lock;
+    part = &DecryptCacheCtl->partitions[partno];
+
+    LWLockAcquire(lock, LW_EXCLUSIVE);
+
+    ent = (DecryptCacheEnt *)
+        hash_search_with_hash_value(DecryptCacheHash, (void *) tag,
+                                    hashcode, HASH_FIND, NULL);
+    if (ent != NULL)
+    {
+        /* can not really happen, see the notes above; just refresh it */
+        slot = ent->slot;
+    }
+    else
+    {
+        DecryptCacheSlot *victim;
+
+        slot = part->first + part->hand;
+        part->hand = (part->hand + 1) % DecryptCacheCtl->slots_per_partition;
+
+        victim = &DecryptCacheCtl->slots[slot];
+        if (victim->valid)
+            DecryptCacheReleaseSlot(part,
+                                    slot,
+                                    get_hash_value(DecryptCacheHash,
+                                                   (void *) &victim->tag));
+
+        ent = (DecryptCacheEnt *)
+            hash_search_with_hash_value(DecryptCacheHash, (void *) tag,
+                                        hashcode, HASH_ENTER_NULL, &found);
+        if (ent == NULL)
+        {
+            LWLockRelease(lock);
+            return;
+        }
+
+        ent->slot = slot;
+        victim->tag = *tag;
+        victim->valid = true;
+        part->nvalid++;
+    }
+
+    memcpy(DecryptCacheSlotPage(slot), page, BLCKSZ);
+
+    LWLockRelease(lock);
+}
+
+/*
+ * Drop all cached pages satisfying the given test. Callers have already
+ * dropped the buffers of the affected relations, so no new page of them can
+ * come in meanwhile.
+ */
+#define DecryptCacheDropMatching(test) \
+do { \
+    int     partno_; \
+    int     i_; \
+    for (partno_ = 0; partno_ < DECRYPT_CACHE_PARTITIONS; partno_++) \
+    { \
+        DecryptCachePartition *part_ = &DecryptCacheCtl->partitions[partno_]; \
+        LWLockAcquire(&DecryptCacheCtl->locks[partno_].lock, LW_EXCLUSIVE); \
+        for (i_ = part_->first; \
+             i_ < part_->first + DecryptCacheCtl->slots_per_partition && \
+             part_->nvalid > 0; \
+             i_++) \
+        { \
+            BufferTag  *tag = &DecryptCacheCtl->slots[i_].tag; \
+            if (!DecryptCacheCtl->slots[i_].valid || !(test)) \
+                continue; \
+            DecryptCacheReleaseSlot(part_, i_, \
+                                    get_hash_value(DecryptCacheHash, \
+                                                   (void *) tag)); \
+        } \
+        LWLockRelease(&DecryptCacheCtl->locks[partno_].lock); \
+    } \
+} while (0)
+
+static bool
+DecryptCacheTagMatchesNodes(BufferTag *tag, RelFileNode *nodes, int nnodes,
+                            ForkNumber forkNum, BlockNumber firstDelBlock)
+{
+    int         i;
+
+    if (forkNum != InvalidForkNumber &&
+        (tag->forkNum != forkNum || tag->blockNum < firstDelBlock))
+        return false;
+
+    for (i = 0; i < nnodes; i++)
+    {
+        if (RelFileNodeEquals(tag->rnode, nodes[i]))
+            return true;
+    }
+    return false;
+}
+
+/*
+ * Drop the cached pages of the given relations, at or after firstDelBlock
+ * in forkNum, or all of them when forkNum is InvalidForkNumber.
+ */
+void
+DecryptCacheDropRelFileNodes(RelFileNode *nodes, int nnodes,
+                             ForkNumber forkNum, BlockNumber firstDelBlock)
+{
+    if (!DecryptCacheEnabled() || nnodes == 0)
+        return;
+
+    DecryptCacheDropMatching(DecryptCacheTagMatchesNodes(tag, nodes, nnodes,
+                                                         forkNum,
+                                                         firstDelBlock));
+}
+
+void
+DecryptCacheDropDatabase(Oid dbid)
+{
+    if (!DecryptCacheEnabled())
+        return;
+
+    DecryptCacheDropMatching(tag->rnode.dbNode == dbid);
+}
+
+/*
+ * Drop the cached pages of blocks firstBlock up to, but not including,
+ * endBlock of a relation fork.
+ */
+void
+DecryptCacheDropBlocks(RelFileNode *rnode, ForkNumber forkNum,
+                       BlockNumber firstBlock, BlockNumber endBlock)
+{
+    BufferTag   tag;
+    BlockNumber blkno;
+
+    if (!DecryptCacheEnabled())
+        return;
+
+    for (blkno = firstBlock; blkno < endBlock; blkno++)
+    {
+        INIT_BUFFERTAG(tag, *rnode, forkNum, blkno);
+        DecryptCacheTake(&tag, NULL);
+    }
+}
+
+#ifdef _SHARDING_
+/*
+ * Drop the cached main fork pages of a relation which belong to a shard.
+ */
+void
+DecryptCacheDropShard(RelFileNode *rnode, ShardID sid)
+{
+    if (!DecryptCacheEnabled())
+        return;
+
+    DecryptCacheDropMatching(RelFileNodeEquals(tag->rnode, *rnode) &&
+                             tag->forkNum == MAIN_FORKNUM &&
+                             PageGetShardId(DecryptCacheSlotPage(i_)) == sid);
+}
+#endif
@@ -2112,6 +2112,37 @@ FileDealloc(File file, off_t offset, uint32 len,  uint32 wait_event_info)
     return 0;
 #endif
 }
+
+/*
+ * Allocate disk space for [offset, offset + len) of a file, extending it if
+ * the range lies beyond its end.  Returns -1 with errno set if the
+ * filesystem can not do it, in which case the caller has to write zeroes.
+ */
+int
+FileAllocate(File file, off_t offset, off_t len, uint32 wait_event_info)
+{
+#ifndef DISABLE_FALLOCATE
+    int            returnCode;
+
+    Assert(FileIsValid(file));
+
+    DO_DB(elog(LOG, "FileAllocate %d (%s)",
+               file, VfdCache[file].fileName));
+
+    returnCode = FileAccess(file);
+    if (returnCode < 0)
+        return returnCode;
+
+    pgstat_report_wait_start(wait_event_info);
+    returnCode = fallocate(VfdCache[file].fd, 0, offset, len);
+    pgstat_report_wait_end();
+
+    return returnCode;
+#else
+    errno = EOPNOTSUPP;
+    return -1;
+#endif
+}
 #endif
 
 /*
@@ -94,6 +94,7 @@
 #include "storage/extentmapping.h"
 #include "storage/freespace.h"
 #include "storage/extent_xlog.h"
+#include "storage/extent_zonemap.h"
 #include "storage/lmgr.h"
 #include "storage/smgr.h"
 #include "utils/builtins.h"
@@ -1522,6 +1523,43 @@ ema_get_eme_extract(Relation rel, ExtentID eid,
 }
 
 
+/*
+ * ema_get_extent_shard - shard an extent belongs to, read from the EMA only
+ *
+ * Unlike ema_get_eme_extract this does not complain about extents the EMA
+ * does not cover yet or that are free; it returns false for them, so scans
+ * can use it on any block they are about to read.
+ */
+bool
+ema_get_extent_shard(Relation rel, ExtentID eid, ShardID *sid)
+{
+    EMAAddress    addr;
+    Buffer         buf;
+    EMAPage        pg;
+    bool        found = false;
+
+    addr = ema_eid_to_address(eid);
+    if (!EMAAddressIsValid(&addr))
+        return false;
+
+    buf = extent_readbuffer(rel, addr.physical_page_number, false);
+    if (!BufferIsValid(buf))
+        return false;
+    LockBuffer(buf, BUFFER_LOCK_SHARE);
+
+    pg = (EMAPage)PageGetContents(BufferGetPage(buf));
+    if (addr.local_idx < pg->n_emes && pg->ema[addr.local_idx].is_occupied)
+    {
+        *sid = (ShardID)pg->ema[addr.local_idx].shardid;
+        found = true;
+    }
+
+    UnlockReleaseBuffer(buf);
+
+    return found;
+}
+
+
 void 
 ema_page_get_eme_extract(Page pg, int32 local_index, 
                                 bool *is_occupied, ShardID     *sid, int *hwm, uint8 *freespace)
@@ -5119,6 +5157,9 @@ reget_eid:
     /* init eme */
     //ema_init_eme(rel, eid, sid);
 
+    /* the extent is empty and nobody can put tuples in it before it is added */
+    ZoneMapResetExtent(rel, eid);
+
     if(!shard_add_extent(rel, sid, eid))
         goto reget_eid;
     return eid;
@@ -5141,9 +5182,43 @@ GetExtentWithFreeSpace(Relation rel, ShardID sid, uint8 min_cat)
     ExtentID    e_next;
     ExtentID    result = InvalidExtentID;
     uint8        avail;
+    ExtentID    hint;
+
+    RelationOpenSmgr(rel);
+    hint = smgr_get_freeext_hint(rel->rd_smgr, sid);
 
     LockShard(rel, sid, AccessShareLock);
-    if(ExtentIdIsValid(anchor.alloc_head))
+
+    /*
+     * Start from the extent which had room last time, most inserts go to the
+     * tail of the shard. Fall back to walking the whole list if the rest of
+     * the list after the hint is full, or the hint no longer belongs to us.
+     */
+    if(ExtentIdIsValid(hint) && ExtentIdIsValid(anchor.alloc_head))
+    {
+        ShardID e_sid = InvalidShardID;
+        bool    occupied = false;
+
+        e_idx = hint;
+        e_next = ema_next_alloc(rel, e_idx, false, &occupied, &e_sid, NULL, &avail);
+
+        while(occupied && e_sid == sid)
+        {
+            if(avail >= min_cat)
+            {
+                result = e_idx;
+                break;
+            }
+
+            e_idx = e_next;
+            if(!ExtentIdIsValid(e_idx))
+                break;
+
+            e_next = ema_next_alloc(rel, e_idx, true, &occupied, &e_sid, NULL, &avail);
+        }
+    }
+
+    if(!ExtentIdIsValid(result) && ExtentIdIsValid(anchor.alloc_head))
     {
         e_idx = anchor.alloc_head;
 
@@ -5181,6 +5256,9 @@ GetExtentWithFreeSpace(Relation rel, ShardID sid, uint8 min_cat)
         result = shard_apply_free_extent(rel,sid);
     }
 
+    RelationOpenSmgr(rel);
+    smgr_set_freeext_hint(rel->rd_smgr, sid, result);
+
     return result;
 }
 
@@ -5351,6 +5429,10 @@ ExtendExtentForShard(Relation rel, ShardID sid, ExtentID eid, uint8 freespace, b
     UnlockReleaseBuffer(ema_buf);
     UnlockReleaseBuffer(eob_buf);
 
+    /* a new extent is empty, a rebuilt one may already hold tuples */
+    if(!for_rebuild)
+        ZoneMapResetExtent(rel, eid);
+
     /*
      * STEP 3: link to shard lists(scan list and alloc list)
      */
@@ -5616,6 +5698,8 @@ FreeExtent(Relation rel, ExtentID eid)
 
     bool    occupied = false;
     ShardID    sid = InvalidShardID;
+
+    ZoneMapForgetExtent(rel, eid);
     
     (void)ema_next_scan(rel, eid, false, &occupied, &sid, NULL, NULL);
     
@@ -5732,6 +5816,81 @@ GetShardScanHead(Relation rel, ShardID sid)
 }
 
 
+/*
+ * Collect the extents on the scan list of the shard into extents, which has
+ * room for maxextents entries. Returns the number of extents, or -1 if the
+ * list turns out to be longer.
+ */
+int
+GetShardScanExtents(Relation rel, ShardID sid, ExtentID *extents, int maxextents)
+{
+    EMAShardAnchor anchor;
+    ExtentID    curr;
+    int         n = 0;
+
+    LockShard(rel, sid, AccessShareLock);
+    anchor = esa_get_anchor(rel, sid);
+
+    curr = anchor.scan_head;
+    while (ExtentIdIsValid(curr))
+    {
+        if (n >= maxextents)
+        {
+            n = -1;
+            break;
+        }
+        extents[n++] = curr;
+
+        if (curr == anchor.scan_tail)
+            break;
+        curr = ema_next_scan(rel, curr, true, NULL, NULL, NULL, NULL);
+    }
+    UnlockShard(rel, sid, AccessShareLock);
+
+    return n;
+}
+
+/*
+ * Collect the extents on the scan lists of the given shards, for scans which
+ * read only those shards. Returns a palloc'd array, or NULL if a scan list
+ * is inconsistent and the caller has to read the whole relation.
+ */
+ExtentID *
+GetShardsScanExtents(Relation rel, Bitmapset *shards, int *nextents)
+{
+    ExtentID   *extents;
+    int         maxextents;
+    int         n = 0;
+    int         sid;
+
+    maxextents = RelationGetNumberOfBlocks(rel) / PAGES_PER_EXTENTS + 1;
+    extents = (ExtentID *) palloc(maxextents * sizeof(ExtentID));
+
+    sid = -1;
+    while ((sid = bms_next_member(shards, sid)) >= 0)
+    {
+        int         got;
+
+        if (!ShardIDIsValid(sid))
+            continue;
+
+        got = GetShardScanExtents(rel, (ShardID) sid, extents + n, maxextents - n);
+        if (got < 0)
+        {
+            /* scan list is longer than the relation, do not trust it */
+            elog(LOG, "scan list of shard %d of relation %s is inconsistent",
+                 sid, RelationGetRelationName(rel));
+            pfree(extents);
+            *nextents = 0;
+            return NULL;
+        }
+        n += got;
+    }
+
+    *nextents = n;
+    return extents;
+}
+
 ExtentID
 RelOidGetShardScanHead(Oid reloid, ShardID sid)
 {
@@ -7072,6 +7231,9 @@ RebuildExtentMap(Relation rel)
         elog(ERROR, "relation %s storage is not organized by extent.", RelationGetRelationName(rel));
     }
 
+    /* extents are mapped again from the pages, their summaries go with the map */
+    ZoneMapForgetRelFileNode(rel->rd_node);
+
     /*
      * truncate exist extent file 
      */        
@@ -0,0 +1,494 @@
+/*
+ * Tencent is pleased to support the open source community by making TBase available.  
+ * 
+ * Copyright (C) 2019 THL A29 Limited, a Tencent company.  All rights reserved.
+ * 
+ * TBase is licensed under the BSD 3-Clause License, except for the third-party component listed below. 
+ * 
+ * A copy of the BSD 3-Clause License is included in this file.
+ * 
+ * Other dependencies and licenses:
+ * 
+ * Open Source Software Licensed Under the PostgreSQL License: 
+ * --------------------------------------------------------------------
+ * 1. Postgres-XL XL9_5_STABLE
+ * Portions Copyright (c) 2015-2016, 2ndQuadrant Ltd
+ * Portions Copyright (c) 2012-2015, TransLattice, Inc.
+ * Portions Copyright (c) 2010-2017, Postgres-XC Development Group
+ * Portions Copyright (c) 1996-2015, The PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, The Regents of the University of California
+ * 
+ * Terms of the PostgreSQL License: 
+ * --------------------------------------------------------------------
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation for any purpose, without fee, and without a written agreement
+ * is hereby granted, provided that the above copyright notice and this
+ * paragraph and the following two paragraphs appear in all copies.
+ * 
+ * IN NO EVENT SHALL THE UNIVERSITY OF CALIFORNIA BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING
+ * LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS
+ * DOCUMENTATION, EVEN IF THE UNIVERSITY OF CALIFORNIA HAS BEEN ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ * 
+ * THE UNIVERSITY OF CALIFORNIA SPECIFICALLY DISCLAIMS ANY WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE UNIVERSITY OF CALIFORNIA HAS NO OBLIGATIONS TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ * 
+ * 
+ * Terms of the BSD 3-Clause License:
+ * --------------------------------------------------------------------
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of THL A29 Limited nor the names of its contributors may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH 
+ * DAMAGE.
+ * 
+ */
+/*-------------------------------------------------------------------------
+ *
+ * extent_zonemap.c
+ *      min/max summaries of the extents of shard tables.
+ *
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *      src/backend/storage/freespace/extent_zonemap.c
+ *
+ * NOTES:
+ *
+ *    For every extent handed out to a shard we keep, in shared memory, the
+ *    smallest and the largest value of the first few integer and datetime
+ *    columns of the tuples placed in it. Sequential scans use them to step
+ *    over extents which can not hold a matching tuple.
+ *
+ *    The summaries are not WAL logged and do not survive a restart. An
+ *    extent without one is always read, so a summary is only ever created
+ *    for an extent that is empty, at the time it is attached to a shard,
+ *    and from then on every tuple put into the extent widens it. Nothing
+ *    narrows a summary again; deleted tuples just keep it wider than
+ *    needed until the extent is freed.
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "access/xlog.h"
+#include "catalog/pg_class.h"
+#include "catalog/pg_type.h"
+#include "storage/extent_zonemap.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "storage/spin.h"
+#include "utils/date.h"
+#include "utils/hsearch.h"
+#include "utils/rel.h"
+#include "utils/timestamp.h"
+
+typedef struct ZoneMapTag
+{
+    RelFileNode rnode;
+    ExtentID    eid;
+} ZoneMapTag;
+
+typedef struct ZoneMapEnt
+{
+    ZoneMapTag  tag;                /* hash key, must be first */
+    slock_t     mutex;              /* protects the values below */
+    int         ncols;
+    AttrNumber  attnum[ZONEMAP_MAX_COLUMNS];
+    Oid         typid[ZONEMAP_MAX_COLUMNS];    /* InvalidOid once unusable */
+    bool        hasvalue[ZONEMAP_MAX_COLUMNS]; /* any non-NULL value seen */
+    int64       min[ZONEMAP_MAX_COLUMNS];
+    int64       max[ZONEMAP_MAX_COLUMNS];
+} ZoneMapEnt;
+
+/* GUC, number of extents summaries are kept for, 0 turns them off */
+int extent_zonemap_entries = 0;
+
+static HTAB *ZoneMapHash = NULL;
+
+#define ZoneMapTracksRelation(rel) \
+    (ZoneMapHash != NULL && RelationHasExtent(rel) && \
+     (rel)->rd_rel->relkind == RELKIND_RELATION)
+
+static inline void
+ZoneMapInitTag(ZoneMapTag *tag, RelFileNode rnode, ExtentID eid)
+{
+    /* tag_hash hashes padding too */
+    MemSet(tag, 0, sizeof(ZoneMapTag));
+    tag->rnode = rnode;
+    tag->eid = eid;
+}
+
+Size
+ExtentZoneMapShmemSize(void)
+{
+    if (extent_zonemap_entries <= 0)
+        return 0;
+
+    return hash_estimate_size(extent_zonemap_entries, sizeof(ZoneMapEnt));
+}
+
+void
+ExtentZoneMapShmemInit(void)
+{
+    HASHCTL        info;
+
+    if (extent_zonemap_entries <= 0)
+        return;
+
+    info.keysize = sizeof(ZoneMapTag);
+    info.entrysize = sizeof(ZoneMapEnt);
+    info.hash = tag_hash;
+
+    ZoneMapHash = ShmemInitHash("Extent Zone Map",
+                                extent_zonemap_entries,
+                                extent_zonemap_entries,
+                                &info,
+                                HASH_ELEM | HASH_FUNCTION);
+}
+
+/*
+ * Types a summary can be kept for. Their values are ordered like their
+ * int64 representation returned by ZoneMapDatumGetInt64.
+ */
+bool
+ZoneMapTypeSupported(Oid typid)
+{
+    switch (typid)
+    {
+        case INT2OID:
+        case INT4OID:
+        case INT8OID:
+        case DATEOID:
+        case TIMESTAMPOID:
+        case TIMESTAMPTZOID:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/*
+ * Can a value of valtype be checked against the summary of a column of
+ * coltype? Integers of any width compare with each other, the datetime
+ * types only with themselves.
+ */
+bool
+ZoneMapTypesComparable(Oid coltype, Oid valtype)
+{
+#define ZONEMAP_INTEGER_TYPE(typid) \
+    ((typid) == INT2OID || (typid) == INT4OID || (typid) == INT8OID)
+
+    if (!ZoneMapTypeSupported(coltype) || !ZoneMapTypeSupported(valtype))
+        return false;
+    if (coltype == valtype)
+        return true;
+    return ZONEMAP_INTEGER_TYPE(coltype) && ZONEMAP_INTEGER_TYPE(valtype);
+}
+
+int64
+ZoneMapDatumGetInt64(Oid typid, Datum value)
+{
+    switch (typid)
+    {
+        case INT2OID:
+            return (int64) DatumGetInt16(value);
+        case INT4OID:
+            return (int64) DatumGetInt32(value);
+        case INT8OID:
+            return DatumGetInt64(value);
+        case DATEOID:
+            return (int64) DatumGetDateADT(value);
+        case TIMESTAMPOID:
+            return (int64) DatumGetTimestamp(value);
+        case TIMESTAMPTZOID:
+            return (int64) DatumGetTimestampTz(value);
+        default:
+            elog(ERROR, "type %u is not supported by extent zone maps", typid);
+    }
+
+    return 0;                    /* keep compiler quiet */
+}
+
+/*
+ * Start an empty summary for an extent just attached to a shard of rel.
+ *
+ * The caller guarantees the extent holds no tuples. A summary left behind
+ * by a former owner of the extent is overwritten.
+ */
+void
+ZoneMapResetExtent(Relation rel, ExtentID eid)
+{
+    TupleDesc    tupdesc = RelationGetDescr(rel);
+    ZoneMapTag    tag;
+    ZoneMapEnt *ent;
+    bool        found;
+    AttrNumber    attnum[ZONEMAP_MAX_COLUMNS];
+    Oid            typid[ZONEMAP_MAX_COLUMNS];
+    int            ncols = 0;
+    int            i;
+
+    /* the summary would miss the tuples the redo of the extent put there */
+    if (!ZoneMapTracksRelation(rel) || RecoveryInProgress())
+        return;
+
+    for (i = 0; i < tupdesc->natts && ncols < ZONEMAP_MAX_COLUMNS; i++)
+    {
+        Form_pg_attribute attr = tupdesc->attrs[i];
+
+        if (attr->attisdropped || !ZoneMapTypeSupported(attr->atttypid))
+            continue;
+        attnum[ncols] = attr->attnum;
+        typid[ncols] = attr->atttypid;
+        ncols++;
+    }
+    if (ncols == 0)
+        return;
+
+    ZoneMapInitTag(&tag, rel->rd_node, eid);
+
+    LWLockAcquire(ExtentZoneMapLock, LW_EXCLUSIVE);
+    ent = (ZoneMapEnt *) hash_search(ZoneMapHash, &tag, HASH_FIND, NULL);
+    if (ent == NULL)
+    {
+        /* stay within what the shared memory was sized for */
+        if (hash_get_num_entries(ZoneMapHash) >= extent_zonemap_entries)
+        {
+            LWLockRelease(ExtentZoneMapLock);
+            return;
+        }
+        ent = (ZoneMapEnt *) hash_search(ZoneMapHash, &tag, HASH_ENTER_NULL,
+                                         &found);
+        if (ent == NULL)
+        {
+            LWLockRelease(ExtentZoneMapLock);
+            return;
+        }
+        SpinLockInit(&ent->mutex);
+    }
+
+    ent->ncols = ncols;
+    for (i = 0; i < ncols; i++)
+    {
+        ent->attnum[i] = attnum[i];
+        ent->typid[i] = typid[i];
+        ent->hasvalue[i] = false;
+        ent->min[i] = PG_INT64_MAX;
+        ent->max[i] = PG_INT64_MIN;
+    }
+    LWLockRelease(ExtentZoneMapLock);
+}
+
+/*
+ * Drop the summary of an extent detached from its shard.
+ */
+void
+ZoneMapForgetExtent(Relation rel, ExtentID eid)
+{
+    ZoneMapTag    tag;
+
+    if (ZoneMapHash == NULL)
+        return;
+
+    ZoneMapInitTag(&tag, rel->rd_node, eid);
+
+    LWLockAcquire(ExtentZoneMapLock, LW_EXCLUSIVE);
+    (void) hash_search(ZoneMapHash, &tag, HASH_REMOVE, NULL);
+    LWLockRelease(ExtentZoneMapLock);
+}
+
+/*
+ * Drop the summaries of all extents of a relation file, for its storage is
+ * going away or its extents are about to be mapped again from scratch.
+ */
+void
+ZoneMapForgetRelFileNode(RelFileNode rnode)
+{
+    HASH_SEQ_STATUS status;
+    ZoneMapEnt *ent;
+
+    if (ZoneMapHash == NULL)
+        return;
+
+    LWLockAcquire(ExtentZoneMapLock, LW_EXCLUSIVE);
+    if (hash_get_num_entries(ZoneMapHash) > 0)
+    {
+        hash_seq_init(&status, ZoneMapHash);
+        while ((ent = (ZoneMapEnt *) hash_seq_search(&status)) != NULL)
+        {
+            if (RelFileNodeEquals(ent->tag.rnode, rnode))
+                (void) hash_search(ZoneMapHash, &ent->tag, HASH_REMOVE, NULL);
+        }
+    }
+    LWLockRelease(ExtentZoneMapLock);
+}
+
+/*
+ * Drop the summaries of all relations of a database that is dropped.
+ */
+void
+ZoneMapForgetDatabase(Oid dbid)
+{
+    HASH_SEQ_STATUS status;
+    ZoneMapEnt *ent;
+
+    if (ZoneMapHash == NULL)
+        return;
+
+    LWLockAcquire(ExtentZoneMapLock, LW_EXCLUSIVE);
+    if (hash_get_num_entries(ZoneMapHash) > 0)
+    {
+        hash_seq_init(&status, ZoneMapHash);
+        while ((ent = (ZoneMapEnt *) hash_seq_search(&status)) != NULL)
+        {
+            if (ent->tag.rnode.dbNode == dbid)
+                (void) hash_search(ZoneMapHash, &ent->tag, HASH_REMOVE, NULL);
+        }
+    }
+    LWLockRelease(ExtentZoneMapLock);
+}
+
+/*
+ * Widen the summary of the extent of blkno by a tuple just put there.
+ *
+ * This has to happen before the tuple can become visible to anybody, that
+ * is before the inserting transaction commits.
+ */
+void
+ZoneMapAddTuple(Relation rel, BlockNumber blkno, HeapTuple tuple)
+{
+    TupleDesc    tupdesc = RelationGetDescr(rel);
+    ZoneMapTag    tag;
+    ZoneMapEnt *ent;
+    Datum        values[ZONEMAP_MAX_COLUMNS];
+    bool        isnull[ZONEMAP_MAX_COLUMNS];
+    bool        usable[ZONEMAP_MAX_COLUMNS];
+    int            i;
+
+    if (ZoneMapHash == NULL)
+        return;
+
+    ZoneMapInitTag(&tag, rel->rd_node, (ExtentID) (blkno / PAGES_PER_EXTENTS));
+
+    LWLockAcquire(ExtentZoneMapLock, LW_SHARED);
+    ent = (ZoneMapEnt *) hash_search(ZoneMapHash, &tag, HASH_FIND, NULL);
+    if (ent == NULL)
+    {
+        LWLockRelease(ExtentZoneMapLock);
+        return;
+    }
+
+    /* the columns are only set under the exclusive lock */
+    for (i = 0; i < ent->ncols; i++)
+    {
+        AttrNumber    attnum = ent->attnum[i];
+
+        usable[i] = attnum <= tupdesc->natts &&
+            !tupdesc->attrs[attnum - 1]->attisdropped &&
+            tupdesc->attrs[attnum - 1]->atttypid == ent->typid[i];
+        if (usable[i])
+            values[i] = heap_getattr(tuple, attnum, tupdesc, &isnull[i]);
+    }
+
+    SpinLockAcquire(&ent->mutex);
+    for (i = 0; i < ent->ncols; i++)
+    {
+        int64        val;
+
+        if (!usable[i])
+        {
+            /* the column changed under the summary, never trust it again */
+            ent->typid[i] = InvalidOid;
+            continue;
+        }
+        if (isnull[i] || ent->typid[i] == InvalidOid)
+            continue;
+
+        val = ZoneMapDatumGetInt64(ent->typid[i], values[i]);
+        if (val < ent->min[i])
+            ent->min[i] = val;
+        if (val > ent->max[i])
+            ent->max[i] = val;
+        ent->hasvalue[i] = true;
+    }
+    SpinLockRelease(&ent->mutex);
+    LWLockRelease(ExtentZoneMapLock);
+}
+
+/*
+ * Could the extent hold a tuple within the ranges of filter? Only false if
+ * its summary proves it can not.
+ */
+bool
+ZoneMapExtentMayMatch(Relation rel, ExtentID eid, ExtentZoneFilter *filter)
+{
+    ZoneMapTag    tag;
+    ZoneMapEnt *ent;
+    ZoneMapEnt    summary;
+    bool        found = false;
+    int            i;
+    int            j;
+
+    if (ZoneMapHash == NULL || filter == NULL || filter->nkeys == 0)
+        return true;
+
+    ZoneMapInitTag(&tag, rel->rd_node, eid);
+
+    LWLockAcquire(ExtentZoneMapLock, LW_SHARED);
+    ent = (ZoneMapEnt *) hash_search(ZoneMapHash, &tag, HASH_FIND, NULL);
+    if (ent != NULL)
+    {
+        SpinLockAcquire(&ent->mutex);
+        memcpy(&summary, ent, sizeof(ZoneMapEnt));
+        SpinLockRelease(&ent->mutex);
+        found = true;
+    }
+    LWLockRelease(ExtentZoneMapLock);
+
+    if (!found)
+        return true;
+
+    for (i = 0; i < filter->nkeys; i++)
+    {
+        ExtentZoneKey *key = &filter->keys[i];
+
+        for (j = 0; j < summary.ncols; j++)
+        {
+            if (summary.attnum[j] != key->attnum ||
+                summary.typid[j] != key->typid)
+                continue;
+
+            /* only NULLs here, and they satisfy no comparison */
+            if (!summary.hasvalue[j])
+                return false;
+            if (key->has_lo &&
+                (summary.max[j] < key->lo ||
+                 (summary.max[j] == key->lo && !key->lo_incl)))
+                return false;
+            if (key->has_hi &&
+                (summary.min[j] > key->hi ||
+                 (summary.min[j] == key->hi && !key->hi_incl)))
+                return false;
+        }
+    }
+
+    return true;
+}
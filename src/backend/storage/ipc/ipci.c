@@ -93,6 +93,7 @@
 #include "postmaster/clustermon.h"
 #include "postmaster/bgworker_internals.h"
 #include "postmaster/bgwriter.h"
+#include "postmaster/ckptwriter.h"
 #include "postmaster/postmaster.h"
 #include "replication/logicallauncher.h"
 #include "replication/slot.h"
@@ -101,6 +102,9 @@
 #include "replication/origin.h"
 #include "storage/bufmgr.h"
 #include "storage/dsm.h"
+#ifdef _SHARDING_
+#include "storage/extent_zonemap.h"
+#endif
 #include "storage/ipc.h"
 #include "storage/pg_shmem.h"
 #include "storage/pmsignal.h"
@@ -117,6 +121,7 @@
 #endif
 #include "utils/backend_random.h"
 #ifdef _MLS_
+#include "storage/decrypt_cache.h"
 #include "utils/mls.h"
 #endif
 #include "utils/snapmgr.h"
@@ -132,6 +137,8 @@
 #include "storage/nodelock.h"
 #include "commands/vacuum.h"
 #include "libpq/auth.h"
+#include "access/gtm.h"
+#include "commands/sequence.h"
 #endif
 
 #ifdef __AUDIT__
@@ -225,6 +232,9 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 #ifdef __TBASE__        
         size = add_size(size, GTSTrackSize());
         size = add_size(size, RecoveryGTMHostSize());
+        size = add_size(size, GTSBrokerShmemSize());
+        size = add_size(size, SharedSeqCacheShmemSize());
+        size = add_size(size, UniqueIdShmemSize());
 #endif
 #ifdef __TBASE_DEBUG__
         size = add_size(size, SnapTableShmemSize());
@@ -240,6 +250,7 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
         size = add_size(size, PMSignalShmemSize());
         size = add_size(size, ProcSignalShmemSize());
         size = add_size(size, CheckpointerShmemSize());
+        size = add_size(size, CheckpointWriterShmemSize());
         size = add_size(size, AutoVacuumShmemSize());
         size = add_size(size, ReplicationSlotsShmemSize());
         size = add_size(size, ReplicationOriginShmemSize());
@@ -289,14 +300,17 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 #endif
 #ifdef _SHARDING_
         size = add_size(size, ShardBarrierShmemSize());
+        size = add_size(size, ExtentZoneMapShmemSize());
 #endif
 #ifdef _MLS_
         size = add_size(size, MlsShmemSize());
+        size = add_size(size, DecryptCacheShmemSize());
 #endif
 #ifdef __TBASE__
         size = add_size(size, UserAuthShmemSize());
         size = add_size(size, NodeLockShmemSize());
         size = add_size(size, ShardStatisticShmemSize());
+        size = add_size(size, SharedTabStatShmemSize());
         size = add_size(size, QueryAnalyzeInfoShmemSize());
 #endif
 #ifdef __AUDIT__
@@ -371,6 +385,9 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 #ifdef __TBASE__
     GTSTrackInit();
     RecoveryGTMHostInit();
+    GTSBrokerShmemInit();
+    SharedSeqCacheShmemInit();
+    UniqueIdShmemInit();
 #endif
 
 #ifdef __TBASE_DEBUG__
@@ -411,6 +428,7 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
     PMSignalShmemInit();
     ProcSignalShmemInit();
     CheckpointerShmemInit();
+    CheckpointWriterShmemInit();
     AutoVacuumShmemInit();
     ReplicationSlotsShmemInit();
     ReplicationOriginShmemInit();
@@ -459,17 +477,20 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 
 #ifdef _SHARDING_
     ShardBarrierShmemInit();
+    ExtentZoneMapShmemInit();
 #endif
 
 #ifdef __TBASE__
     NodeLockShmemInit();
     ShardStatisticShmemInit();
+    SharedTabStatShmemInit();
     QueryAnalyzeInfoInit();
     UserAuthShmemInit();
 #endif
 
 #ifdef _MLS_
     MlsShmemInit();
+    DecryptCacheShmemInit();
 #endif
 
 
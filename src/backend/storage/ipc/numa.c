@@ -0,0 +1,270 @@
+/*
+ * Tencent is pleased to support the open source community by making TBase available.  
+ * 
+ * Copyright (C) 2019 THL A29 Limited, a Tencent company.  All rights reserved.
+ * 
+ * TBase is licensed under the BSD 3-Clause License, except for the third-party component listed below. 
+ * 
+ * A copy of the BSD 3-Clause License is included in this file.
+ * 
+ * Other dependencies and licenses:
+ * 
+ * Open Source Software Licensed Under the PostgreSQL License: 
+ * --------------------------------------------------------------------
+ * 1. Postgres-XL XL9_5_STABLE
+ * Portions Copyright (c) 2015-2016, 2ndQuadrant Ltd
+ * Portions Copyright (c) 2012-2015, TransLattice, Inc.
+ * Portions Copyright (c) 2010-2017, Postgres-XC Development Group
+ * Portions Copyright (c) 1996-2015, The PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, The Regents of the University of California
+ * 
+ * Terms of the PostgreSQL License: 
+ * --------------------------------------------------------------------
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation for any purpose, without fee, and without a written agreement
+ * is hereby granted, provided that the above copyright notice and this
+ * paragraph and the following two paragraphs appear in all copies.
+ * 
+ * IN NO EVENT SHALL THE UNIVERSITY OF CALIFORNIA BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING
+ * LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS
+ * DOCUMENTATION, EVEN IF THE UNIVERSITY OF CALIFORNIA HAS BEEN ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ * 
+ * THE UNIVERSITY OF CALIFORNIA SPECIFICALLY DISCLAIMS ANY WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE UNIVERSITY OF CALIFORNIA HAS NO OBLIGATIONS TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ * 
+ * 
+ * Terms of the BSD 3-Clause License:
+ * --------------------------------------------------------------------
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of THL A29 Limited nor the names of its contributors may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH 
+ * DAMAGE.
+ * 
+ */
+/*-------------------------------------------------------------------------
+ *
+ * numa.c
+ *      NUMA placement of shared memory and threads.
+ *
+ * On machines with several memory nodes, the main shared memory segment is
+ * by default placed wherever the postmaster or the first backend touching
+ * a page happens to run, which tends to pile shared_buffers and the shared
+ * queues up on one node.  With numa_shared_memory the segment is
+ * interleaved page by page across all nodes instead, so that every socket
+ * sees the same average latency and bandwidth is spread over all memory
+ * controllers.
+ *
+ * DataPump buffers are private to the backend that builds them and are
+ * first touched by it, so its sender threads are kept on the backend's
+ * node.
+ *
+ * We talk to the kernel directly, so neither libnuma nor its headers are
+ * needed.  Everything here is a no-op returning failure on other systems.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ *
+ *
+ * IDENTIFICATION
+ *      src/backend/storage/ipc/numa.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+#include "storage/numa.h"
+
+/* from <numaif.h> */
+#ifndef MPOL_INTERLEAVE
+#define MPOL_INTERLEAVE        3
+#endif
+
+#define NUMA_SYSFS_DIR        "/sys/devices/system/node"
+
+bool        numa_shared_memory = false;
+
+#ifdef __linux__
+/*
+ * Parse a sysfs list like "0-23,48-71" into a bitmap of nbits bits.
+ * Returns the number of bits set, or -1 if the file can't be read.
+ */
+static int
+numa_read_list(const char *path, uint64 *bits, int nbits)
+{
+    FILE       *file;
+    char        buf[4096];
+    char       *p;
+    int            count = 0;
+
+    file = fopen(path, "r");
+    if (file == NULL)
+        return -1;
+    if (fgets(buf, sizeof(buf), file) == NULL)
+    {
+        fclose(file);
+        return -1;
+    }
+    fclose(file);
+
+    memset(bits, 0, nbits / 8);
+
+    p = buf;
+    while (*p >= '0' && *p <= '9')
+    {
+        long        first;
+        long        last;
+        long        i;
+
+        first = last = strtol(p, &p, 10);
+        if (*p == '-')
+            last = strtol(p + 1, &p, 10);
+
+        for (i = first; i <= last && i < nbits; i++)
+        {
+            bits[i / 64] |= UINT64CONST(1) << (i % 64);
+            count++;
+        }
+
+        if (*p == ',')
+            p++;
+    }
+
+    return count;
+}
+#endif
+
+/*
+ * NumaNumNodes
+ *        Number of online NUMA nodes, 1 if unknown
+ */
+int
+NumaNumNodes(void)
+{
+#ifdef __linux__
+    uint64        nodes[NUMA_MAX_NODES / 64];
+    int            count;
+
+    count = numa_read_list(NUMA_SYSFS_DIR "/online", nodes, NUMA_MAX_NODES);
+    if (count > 0)
+        return count;
+#endif
+    return 1;
+}
+
+/*
+ * NumaCurrentNode
+ *        NUMA node the calling thread runs on right now, -1 if unknown
+ */
+int
+NumaCurrentNode(void)
+{
+#if defined(__linux__) && defined(SYS_getcpu)
+    unsigned    cpu;
+    unsigned    node;
+
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0)
+        return (int) node;
+#endif
+    return -1;
+}
+
+/*
+ * NumaInterleaveMemory
+ *        Spread the pages of a mapping over all online nodes
+ *
+ * addr must be page aligned.  Only pages not touched yet are affected, so
+ * call this right after mapping the memory.  Returns false with errno set
+ * on failure.
+ */
+bool
+NumaInterleaveMemory(void *addr, Size size)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+    unsigned long nodes[NUMA_MAX_NODES / (8 * sizeof(unsigned long))];
+
+    if (numa_read_list(NUMA_SYSFS_DIR "/online",
+                       (uint64 *) nodes, NUMA_MAX_NODES) <= 0)
+    {
+        errno = ENOENT;
+        return false;
+    }
+
+    /* the kernel wants one more than the number of bits in the mask */
+    return syscall(SYS_mbind, addr, (unsigned long) size, MPOL_INTERLEAVE,
+                   nodes, (unsigned long) NUMA_MAX_NODES + 1, 0) == 0;
+#else
+    errno = ENOSYS;
+    return false;
+#endif
+}
+
+/*
+ * NumaGetNodeCpus
+ *        Fetch the CPUs of a node, for binding threads with NumaBindThread
+ */
+bool
+NumaGetNodeCpus(int node, NumaCpuMask *mask)
+{
+#ifdef __linux__
+    char        path[MAXPGPATH];
+
+    if (node < 0)
+        return false;
+
+    snprintf(path, sizeof(path), NUMA_SYSFS_DIR "/node%d/cpulist", node);
+
+    return numa_read_list(path, mask->bits, NUMA_MAX_CPUS) > 0;
+#else
+    return false;
+#endif
+}
+
+/*
+ * NumaBindThread
+ *        Restrict the calling thread to the given CPUs
+ *
+ * This neither allocates nor reports errors, so it is safe to call from
+ * the DataPump threads.
+ */
+bool
+NumaBindThread(const NumaCpuMask *mask)
+{
+#ifdef __linux__
+    cpu_set_t    set;
+    int            i;
+
+    CPU_ZERO(&set);
+    for (i = 0; i < NUMA_MAX_CPUS && i < CPU_SETSIZE; i++)
+    {
+        if (mask->bits[i / 64] & (UINT64CONST(1) << (i % 64)))
+            CPU_SET(i, &set);
+    }
+
+    /* pid 0 is the calling thread */
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
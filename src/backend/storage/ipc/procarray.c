@@ -80,6 +80,7 @@
 #include "utils/guc.h"
 /* PGXC_DATANODE */
 #include "postmaster/autovacuum.h"
+#include "postmaster/walwriter.h"
 #include "utils/memutils.h"
 #endif
 
@@ -126,6 +127,16 @@ typedef struct ProcArrayStruct
     /* oldest catalog xmin of any replication slot */
     TransactionId replication_slot_catalog_xmin;
 
+#ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+    /*
+     * Advanced whenever a transaction id leaves the proc array or a prepare
+     * timestamp is published, so that a backend can tell whether the xid
+     * arrays of its last snapshot are still current.  Prepare timestamps are
+     * set without ProcArrayLock, hence the atomic.
+     */
+    pg_atomic_uint64 snapshot_generation;
+#endif
+
     /* indexes into allPgXact[], has PROCARRAY_MAXPROCS entries */
     int            pgprocnos[FLEXIBLE_ARRAY_MEMBER];
 } ProcArrayStruct;
@@ -214,12 +225,20 @@ GlobalSnapshotData globalSnapshot = {
 static void GetGlobalTimestampFromGTM(Snapshot snapshot);
 static void
 GetGlobalTimestampFromGlobalSnapshot(Snapshot snapshot);
+#ifdef __TBASE__
+static void WaitForStandbyReplayGTS(GlobalTimestamp start_ts);
+#endif
 #if 0
 static void GetSnapshotFromGlobalSnapshot(Snapshot snapshot);
 static void GetSnapshotDataFromGTM(Snapshot snapshot);
 #endif
 #endif
 
+#ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+static bool GetSnapshotDataReuse(Snapshot snapshot, uint64 generation);
+static void SetRecentCommitTs(Snapshot snapshot);
+#endif
+
 /* Primitives for KnownAssignedXids array handling for standby */
 static void KnownAssignedXidsCompress(bool force);
 static void KnownAssignedXidsAdd(TransactionId from_xid, TransactionId to_xid,
@@ -245,6 +264,23 @@ static void ProcArrayGroupClearXid(PGPROC *proc, TransactionId latestXid);
 int    GlobalSnapshotSource;
 #endif
 
+#ifdef __TBASE__
+/*
+ * Global timestamp set by snapshot_global_timestamp.  Sessions not working
+ * for another node take their snapshots at it instead of asking GTM, which
+ * lets clients connected to different nodes read the same data.
+ */
+char   *snapshot_global_timestamp_string = NULL;
+GlobalTimestamp ImportedGlobalTimestamp = InvalidGlobalTimestamp;
+
+/*
+ * How long, in milliseconds, a hot standby datanode waits for replay to reach
+ * the global timestamp of a snapshot sent by a coordinator.  Zero disables
+ * the check and leaves consistency to standby_plane_query_delay.
+ */
+int     standby_read_wait_timeout = 0;
+#endif
+
 /*
  * Report shared-memory space needed by CreateSharedProcArray.
  */
@@ -318,6 +354,10 @@ CreateSharedProcArray(void)
         procArray->headKnownAssignedXids = 0;
         SpinLockInit(&procArray->known_assigned_xids_lck);
         procArray->lastOverflowedXid = InvalidTransactionId;
+#ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+        /* snapshots start with generation 0, which never matches */
+        pg_atomic_init_u64(&procArray->snapshot_generation, 1);
+#endif
     }
 
     allProcs = ProcGlobal->allProcs;
@@ -345,6 +385,18 @@ CreateSharedProcArray(void)
 #endif
 }
 
+#ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+/*
+ * Tell snapshot builders that the running/prepared transaction set changed,
+ * see GetSnapshotDataReuse().
+ */
+void
+ProcArrayAdvanceGeneration(void)
+{
+    pg_atomic_fetch_add_u64(&procArray->snapshot_generation, 1);
+}
+#endif
+
 /*
  * Add the specified PGPROC to the shared array.
  */
@@ -456,6 +508,8 @@ ProcArrayRemove(PGPROC *proc, TransactionId latestXid)
             ShmemVariableCache->latestCompletedXid = latestXid;
 
 #ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+        ProcArrayAdvanceGeneration();
+
         LWLockAcquire(CommitTsLock, LW_EXCLUSIVE);
         if(MyProc->commitTs > ShmemVariableCache->latestCommitTs)
         {
@@ -621,6 +675,8 @@ ProcArrayEndTransactionInternal(PGPROC *proc, PGXACT *pgxact,
         ShmemVariableCache->latestCompletedXid = latestXid;
 
 #ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+    ProcArrayAdvanceGeneration();
+
     /* avoid concurrency conflicts with the checkpoint */
 
     LWLockAcquire(CommitTsLock, LW_EXCLUSIVE);
@@ -2002,6 +2058,83 @@ TransactionId GetLocalTransactionId(const char *globalXid)
     return InvalidTransactionId;
 
 }
+
+/*
+ * Copy the global xid of the backend with the given pid into globalXid,
+ * which must have room for NAMEDATALEN bytes. Returns false if there is no
+ * such backend or it is not in a distributed transaction.
+ */
+bool
+GetGlobalXidOfPid(int pid, char *globalXid)
+{
+    PGPROC *proc;
+    bool    found = false;
+
+    if (pid == 0)                /* never match dummy PGPROCs */
+        return false;
+
+    LWLockAcquire(ProcArrayLock, LW_SHARED);
+    proc = BackendPidGetProcWithLock(pid);
+    if (proc != NULL)
+    {
+        LWLockAcquire(&proc->globalxidLock, LW_SHARED);
+        if (proc->hasGlobalXid)
+        {
+            strlcpy(globalXid, proc->globalXid, NAMEDATALEN);
+            found = true;
+        }
+        LWLockRelease(&proc->globalxidLock);
+    }
+    LWLockRelease(ProcArrayLock);
+
+    return found;
+}
+
+/*
+ * Send the given signal to every backend working for the distributed
+ * transaction globalXid. Returns the number of backends signalled.
+ */
+int
+SignalGlobalXidBackends(const char *globalXid, ProcSignalReason reason)
+{
+    ProcArrayStruct *arrayP = procArray;
+    int           *pids;
+    BackendId  *backendIds;
+    int            nsignal = 0;
+    int            index;
+    int            i;
+
+    pids = (int *) palloc(arrayP->maxProcs * sizeof(int));
+    backendIds = (BackendId *) palloc(arrayP->maxProcs * sizeof(BackendId));
+
+    LWLockAcquire(ProcArrayLock, LW_SHARED);
+    for (index = 0; index < arrayP->numProcs; index++)
+    {
+        PGPROC *proc = &allProcs[arrayP->pgprocnos[index]];
+
+        if (proc->pid == 0)
+            continue;
+
+        LWLockAcquire(&proc->globalxidLock, LW_SHARED);
+        if (proc->hasGlobalXid && strcmp(globalXid, proc->globalXid) == 0)
+        {
+            pids[nsignal] = proc->pid;
+            backendIds[nsignal] = proc->backendId;
+            nsignal++;
+        }
+        LWLockRelease(&proc->globalxidLock);
+    }
+    LWLockRelease(ProcArrayLock);
+
+    /* the signals can go out without holding the lock */
+    for (i = 0; i < nsignal; i++)
+        (void) SendProcSignal(pids[i], reason, backendIds[i]);
+
+    pfree(pids);
+    pfree(backendIds);
+
+    return nsignal;
+}
 #endif
 
 char *GetGlobalTransactionId(const TransactionId pid)
@@ -2095,6 +2228,9 @@ GetSnapshotData_shard(Snapshot snapshot, bool latest, bool need_shardmap)
     int            count = 0;
     int            subcount = 0;
     bool        suboverflowed = false;
+#ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+    uint64        generation;
+#endif
     volatile TransactionId replication_slot_xmin = InvalidTransactionId;
     volatile TransactionId replication_slot_catalog_xmin = InvalidTransactionId;
 #ifdef __USE_GLOBAL_SNAPSHOT__
@@ -2219,12 +2355,38 @@ GetSnapshotData_shard(Snapshot snapshot, bool latest, bool need_shardmap)
 
     }
 
+#ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+    /* try without ProcArrayLock first, see GetSnapshotDataReuse() */
+    generation = pg_atomic_read_u64(&procArray->snapshot_generation);
+    pg_read_barrier();
+
+    if (GetSnapshotDataReuse(snapshot, generation))
+    {
+        SetRecentCommitTs(snapshot);
+
+        /* the new start timestamp may hold back data cleanup further */
+        if (!snapshot->local &&
+            snapshot->start_ts < RecentDataTs + (vacuum_delta * TIMESTAMP_SHIFT))
+        {
+            if (snapshot->start_ts < (vacuum_delta * TIMESTAMP_SHIFT))
+                RecentDataTs = InvalidGlobalTimestamp;
+            else
+                RecentDataTs = snapshot->start_ts - (vacuum_delta * TIMESTAMP_SHIFT);
+        }
+        goto snapshot_ready;
+    }
+#endif
+
     /*
      * It is sufficient to get shared lock on ProcArrayLock, even if we are
      * going to set MyPgXact->xmin.
      */
     LWLockAcquire(ProcArrayLock, LW_SHARED);
 
+#ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+    generation = pg_atomic_read_u64(&procArray->snapshot_generation);
+#endif
+
     /* xmax is always latestCompletedXid + 1 */
     xmax = ShmemVariableCache->latestCompletedXid;
     Assert(TransactionIdIsNormal(xmax));
@@ -2519,27 +2681,9 @@ prepare_finished:
         prepare_xmin = xmin;
     }
     snapshot->prepare_xmin = prepare_xmin;
+    snapshot->generation = generation;
 
-
-    {
-        if(RecentCommitTs < (vacuum_delta * TIMESTAMP_SHIFT))
-        {
-            RecentCommitTs = InvalidGlobalTimestamp;
-        }
-        else
-        {
-            RecentCommitTs = RecentCommitTs - (vacuum_delta * TIMESTAMP_SHIFT);
-        }
-        
-        if(!snapshot->local 
-            && TestForOldTimestamp(snapshot->start_ts, RecentCommitTs))
-        {
-            ereport(ERROR,
-                        (errcode(ERRCODE_INTERNAL_ERROR),
-                    errmsg("start timestamp " INT64_FORMAT " is too old to execute, recentCommitTs " INT64_FORMAT , 
-                    snapshot->start_ts, RecentCommitTs + (vacuum_delta * TIMESTAMP_SHIFT))));
-        }
-    }
+    SetRecentCommitTs(snapshot);
     
     if(!snapshot->local && (snapshot->start_ts < tmin))
     {
@@ -2563,6 +2707,9 @@ prepare_finished:
              xmin, xmax, count, globalxmin);
 #endif
 
+#ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+snapshot_ready:
+#endif
     /*
      * This is a new snapshot, so set both refcounts are zero, and mark it as
      * not copied in persistent memory.
@@ -2589,12 +2736,101 @@ prepare_finished:
          */
         snapshot->lsn = GetXLogInsertRecPtr();
         snapshot->whenTaken = GetSnapshotCurrentTimestamp();
-        MaintainOldSnapshotTimeMapping(snapshot->whenTaken, xmin);
+        MaintainOldSnapshotTimeMapping(snapshot->whenTaken, snapshot->xmin);
     }
 
     return snapshot;
 }
 
+#ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+/*
+ * GetSnapshotDataReuse -- keep the xid arrays of the previous snapshot
+ *
+ * With global timestamps, a transaction sees another one's changes if its
+ * start timestamp is past their commit timestamp; the xid arrays are only
+ * consulted for transactions that are prepared or committed locally.  If
+ * no xid has left the proc array and no prepare timestamp was published
+ * since the arrays of this snapshot were built, a new scan would produce the
+ * same arrays (xids assigned meanwhile are all >= xmax), so read-only
+ * transactions just take the new start timestamp and skip the scan.
+ *
+ * This runs without ProcArrayLock, so that taking a snapshot costs a few
+ * atomic reads while nothing completes.  The generation is advanced while
+ * ProcArrayLock is held exclusively, after the xid was cleared, so anybody
+ * computing a horizon under the lock either runs before the transaction
+ * ends, and still counts its xid, or after the generation moved on.
+ */
+static bool
+GetSnapshotDataReuse(Snapshot snapshot, uint64 generation)
+{
+    if (snapshot->generation != generation)
+        return false;
+
+    if (TransactionIdIsValid(MyPgXact->xid))
+        return false;
+
+    if (snapshot->takenDuringRecovery || RecoveryInProgress())
+        return false;
+
+    /*
+     * Nothing has finished since the xmin was computed, so it can not be
+     * behind anybody's horizon yet.  Publish it, then make sure that still
+     * held: if a transaction ended meanwhile, a horizon may have passed it
+     * before it became visible, so back off and build a new snapshot.
+     */
+    if (!TransactionIdIsValid(MyPgXact->xmin))
+    {
+        MyPgXact->xmin = snapshot->xmin;
+        pg_memory_barrier();
+        if (pg_atomic_read_u64(&procArray->snapshot_generation) != generation)
+        {
+            MyPgXact->xmin = InvalidTransactionId;
+            return false;
+        }
+        TransactionXmin = snapshot->xmin;
+    }
+
+    if (!snapshot->local)
+    {
+        pg_atomic_write_u64(&MyPgXact->tmin, snapshot->start_ts);
+    }
+
+    RecentCommitTs = ShmemVariableCache->latestGTS > ShmemVariableCache->latestCommitTs ?
+                        ShmemVariableCache->latestGTS : ShmemVariableCache->latestCommitTs;
+    RecentXmin = snapshot->xmin;
+
+    snapshot->curcid = GetCurrentCommandId(false);
+
+    return true;
+}
+
+/*
+ * Move RecentCommitTs back by vacuum_delta and make sure the snapshot does
+ * not start before it, as the data it needs may have been cleaned up.
+ */
+static void
+SetRecentCommitTs(Snapshot snapshot)
+{
+    if(RecentCommitTs < (vacuum_delta * TIMESTAMP_SHIFT))
+    {
+        RecentCommitTs = InvalidGlobalTimestamp;
+    }
+    else
+    {
+        RecentCommitTs = RecentCommitTs - (vacuum_delta * TIMESTAMP_SHIFT);
+    }
+
+    if(!snapshot->local
+        && TestForOldTimestamp(snapshot->start_ts, RecentCommitTs))
+    {
+        ereport(ERROR,
+                    (errcode(ERRCODE_INTERNAL_ERROR),
+                errmsg("start timestamp " INT64_FORMAT " is too old to execute, recentCommitTs " INT64_FORMAT ,
+                snapshot->start_ts, RecentCommitTs + (vacuum_delta * TIMESTAMP_SHIFT))));
+    }
+}
+#endif
+
 /*
  * ProcArrayInstallImportedXmin -- install imported xmin into MyPgXact->xmin
  *
@@ -3952,6 +4188,10 @@ XidCacheRemoveRunningXids(TransactionId xid,
                               latestXid))
         ShmemVariableCache->latestCompletedXid = latestXid;
 
+#ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+    ProcArrayAdvanceGeneration();
+#endif
+
     LWLockRelease(ProcArrayLock);
 }
 
@@ -4047,7 +4287,8 @@ GetPGXCSnapshotData(Snapshot snapshot, bool latest)
      */
     if (RecoveryInProgress() || IsInitProcessingMode() || latest)
     {
-        if (IsStandbyPostgres() && !latest && query_delay)
+        if (IsStandbyPostgres() && !latest &&
+            (query_delay || standby_read_wait_timeout > 0))
         {
             /* need global snapshot now */
         }
@@ -4100,6 +4341,21 @@ GetPGXCSnapshotData(Snapshot snapshot, bool latest)
     }
     else 
     {
+#ifdef __TBASE__
+        if (GlobalTimestampIsValid(ImportedGlobalTimestamp))
+        {
+            snapshot->start_ts = ImportedGlobalTimestamp;
+            if (CommitTimestampIsLocal(snapshot->start_ts))
+            {
+                snapshot->local = true;
+            }
+            if (enable_distri_print)
+            {
+                elog(LOG, "Get imported global timestamp " INT64_FORMAT, snapshot->start_ts);
+            }
+            return;
+        }
+#endif
         if(enable_distri_print)
         {
             elog(LOG, "postmaster gets timestamp from GTM for snapshot latest %d GetForceXidFromGTM() %d IsInitProcessingMode %d"
@@ -4121,7 +4377,7 @@ GetGlobalTimestampFromGTM(Snapshot snapshot)
 {
     GlobalTimestamp start_ts;
 
-    start_ts = (GlobalTimestamp) GetGlobalTimestampGTM();
+    start_ts = (GlobalTimestamp) GetSnapshotTimestampGTM();
     snapshot->start_ts = start_ts;
     
     if (!GlobalTimestampIsValid(start_ts))
@@ -4159,6 +4415,13 @@ GetGlobalTimestampFromGlobalSnapshot(Snapshot snapshot)
         {
             elog(LOG, "Get global timestamp from global " INT64_FORMAT, snapshot->start_ts);
         }
+#ifdef __TBASE__
+        if (!snapshot->local && standby_read_wait_timeout > 0 &&
+            RecoveryInProgress())
+        {
+            WaitForStandbyReplayGTS(snapshot->start_ts);
+        }
+#endif
     }
     else
     {
@@ -4170,6 +4433,58 @@ GetGlobalTimestampFromGlobalSnapshot(Snapshot snapshot)
 }
 #endif
 
+#ifdef __TBASE__
+/*
+ * On a hot standby datanode, a snapshot taken at start_ts only sees the same
+ * data as on the master once every transaction committed before start_ts has
+ * been replayed.  Wait until the replayed global timestamp passes start_ts,
+ * and refuse the query if that does not happen in time.
+ *
+ * This narrows the window for stale reads but does not close it: commit
+ * records are not written in global timestamp order, so one with a smaller
+ * timestamp may still follow the record that moved latestGTS past start_ts.
+ *
+ * latestGTS moves with replayed commit records and with the global
+ * timestamp the master's autovacuum launcher logs every gts_acquire_gap
+ * seconds.  On a quiet master that heartbeat is all there is, so the wait
+ * is never cut shorter than one gap; this assumes the standby uses the same
+ * gts_acquire_gap as its master.
+ */
+static void
+WaitForStandbyReplayGTS(GlobalTimestamp start_ts)
+{
+    TimestampTz deadline;
+    int         timeout_ms;
+
+    if (GetLatestCommitTS() >= start_ts)
+        return;
+
+    timeout_ms = Max(standby_read_wait_timeout, WalGTSAcquireDelay * 1000);
+    deadline = TimestampTzPlusMilliseconds(GetCurrentTimestamp(), timeout_ms);
+    while (GetLatestCommitTS() < start_ts)
+    {
+        if (!RecoveryInProgress())
+            return;
+
+        if (GetCurrentTimestamp() >= deadline)
+            ereport(ERROR,
+                    (errcode(ERRCODE_T_R_SERIALIZATION_FAILURE),
+                     errmsg("standby has not replayed up to global timestamp " INT64_FORMAT,
+                            start_ts),
+                     errdetail("Replay has reached global timestamp " INT64_FORMAT " after waiting %d ms.",
+                               GetLatestCommitTS(), timeout_ms)));
+
+        CHECK_FOR_INTERRUPTS();
+        pg_usleep(1000L); /* 1ms */
+    }
+
+    if (enable_distri_print)
+    {
+        elog(LOG, "standby replay reached global timestamp " INT64_FORMAT, start_ts);
+    }
+}
+#endif
+
 #if 0
 static void
 GetSnapshotDataFromGTM(Snapshot snapshot)
@@ -5400,6 +5715,9 @@ SetLatestCompletedXid(TransactionId latestCompletedXid)
     }
 
     ShmemVariableCache->latestCompletedXid = latestCompletedXid;
+#ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+    ProcArrayAdvanceGeneration();
+#endif
     LWLockRelease(ProcArrayLock);
 }
 #ifdef __TBASE__
@@ -347,6 +347,9 @@ procsignal_sigusr1_handler(SIGNAL_ARGS)
 #ifdef __TBASE__
     if (CheckProcSignal(PROCSIG_PARALLEL_EXIT))
         HandleParallelExecutionError();
+
+    if (CheckProcSignal(PROCSIG_GLOBAL_DEADLOCK))
+        HandleGlobalDeadlockInterrupt();
 #endif
 
     if (CheckProcSignal(PROCSIG_WALSND_INIT_STOPPING))
@@ -117,6 +117,9 @@ int            max_locks_per_xact; /* set by guc.c */
 #define NLOCKENTS() \
     mul_size(max_locks_per_xact, add_size(MaxBackends, max_prepared_xacts))
 
+/* Number of fast-path lock groups, derived from max_locks_per_xact */
+int            FastPathLockGroupsPerBackend = 0;
+
 
 /*
  * Data structures defining the semantics of the standard lock methods.
@@ -229,25 +232,41 @@ typedef struct TwoPhaseLockRecord
  * our locks to the primary lock table, but it can never be lower than the
  * real value, since only we can acquire locks on our own behalf.
  */
-static int    FastPathLocalUseCount = 0;
+static int    FastPathLocalUseCounts[FP_LOCK_GROUPS_PER_BACKEND_MAX];
 
-/* Macros for manipulating proc->fpLockBits */
+/*
+ * Macros for manipulating proc->fpLockBits.  Slot n belongs to group
+ * n / FP_LOCK_SLOTS_PER_GROUP, whose lock bits are fpLockBits[group].
+ */
 #define FAST_PATH_BITS_PER_SLOT            3
 #define FAST_PATH_LOCKNUMBER_OFFSET        1
 #define FAST_PATH_MASK                    ((1 << FAST_PATH_BITS_PER_SLOT) - 1)
+#define FAST_PATH_GROUP(n) \
+    (AssertMacro((uint32) (n) < FastPathLockSlotsPerBackend()), \
+     ((n) / FP_LOCK_SLOTS_PER_GROUP))
+#define FAST_PATH_INDEX(n) \
+    (AssertMacro((uint32) (n) < FastPathLockSlotsPerBackend()), \
+     ((n) % FP_LOCK_SLOTS_PER_GROUP))
+#define FAST_PATH_SLOT(group, index) \
+    (AssertMacro((uint32) (group) < FastPathLockGroupsPerBackend), \
+     AssertMacro((uint32) (index) < FP_LOCK_SLOTS_PER_GROUP), \
+     ((group) * FP_LOCK_SLOTS_PER_GROUP + (index)))
+/* the number of groups is a power of two */
+#define FAST_PATH_REL_GROUP(relid) \
+    ((uint32) (((uint64) (relid) * 49157) & (FastPathLockGroupsPerBackend - 1)))
+#define FAST_PATH_BITS(proc, n)            ((proc)->fpLockBits[FAST_PATH_GROUP(n)])
 #define FAST_PATH_GET_BITS(proc, n) \
-    (((proc)->fpLockBits >> (FAST_PATH_BITS_PER_SLOT * n)) & FAST_PATH_MASK)
+    ((FAST_PATH_BITS(proc, n) >> (FAST_PATH_BITS_PER_SLOT * FAST_PATH_INDEX(n))) & FAST_PATH_MASK)
 #define FAST_PATH_BIT_POSITION(n, l) \
     (AssertMacro((l) >= FAST_PATH_LOCKNUMBER_OFFSET), \
      AssertMacro((l) < FAST_PATH_BITS_PER_SLOT+FAST_PATH_LOCKNUMBER_OFFSET), \
-     AssertMacro((n) < FP_LOCK_SLOTS_PER_BACKEND), \
-     ((l) - FAST_PATH_LOCKNUMBER_OFFSET + FAST_PATH_BITS_PER_SLOT * (n)))
+     ((l) - FAST_PATH_LOCKNUMBER_OFFSET + FAST_PATH_BITS_PER_SLOT * FAST_PATH_INDEX(n)))
 #define FAST_PATH_SET_LOCKMODE(proc, n, l) \
-     (proc)->fpLockBits |= UINT64CONST(1) << FAST_PATH_BIT_POSITION(n, l)
+     FAST_PATH_BITS(proc, n) |= UINT64CONST(1) << FAST_PATH_BIT_POSITION(n, l)
 #define FAST_PATH_CLEAR_LOCKMODE(proc, n, l) \
-     (proc)->fpLockBits &= ~(UINT64CONST(1) << FAST_PATH_BIT_POSITION(n, l))
+     FAST_PATH_BITS(proc, n) &= ~(UINT64CONST(1) << FAST_PATH_BIT_POSITION(n, l))
 #define FAST_PATH_CHECK_LOCKMODE(proc, n, l) \
-     ((proc)->fpLockBits & (UINT64CONST(1) << FAST_PATH_BIT_POSITION(n, l)))
+     (FAST_PATH_BITS(proc, n) & (UINT64CONST(1) << FAST_PATH_BIT_POSITION(n, l)))
 
 /*
  * The fast-path lock mechanism is concerned only with relation locks on
@@ -426,6 +445,25 @@ static void GetSingleProcBlockerStatusData(PGPROC *blocked_proc,
                                BlockedProcsData *data);
 
 
+/*
+ * InitializeFastPathLocks -- size the per-backend fast-path lock arrays.
+ *
+ * Allow about as many fast-path locks as max_locks_per_transaction, rounded
+ * up to a power of two number of groups.  Called from InitializeMaxBackends(),
+ * since both feed into the shared memory size.
+ */
+void
+InitializeFastPathLocks(void)
+{
+    int            groups = 1;
+
+    while (groups < FP_LOCK_GROUPS_PER_BACKEND_MAX &&
+           groups * FP_LOCK_SLOTS_PER_GROUP < max_locks_per_xact)
+        groups *= 2;
+
+    FastPathLockGroupsPerBackend = groups;
+}
+
 /*
  * InitLocks -- Initialize the lock manager's data structures.
  *
@@ -939,7 +977,8 @@ LockAcquireExtendedXC(const LOCKTAG *locktag,
      * for now we don't worry about that case either.
      */
     if (EligibleForRelationFastPath(locktag, lockmode) &&
-        FastPathLocalUseCount < FP_LOCK_SLOTS_PER_BACKEND)
+        FastPathLocalUseCounts[FAST_PATH_REL_GROUP(locktag->locktag_field2)] <
+        FP_LOCK_SLOTS_PER_GROUP)
     {
         uint32        fasthashcode = FastPathStrongLockHashPartition(hashcode);
         bool        acquired;
@@ -2095,7 +2134,7 @@ LockRelease(const LOCKTAG *locktag, LOCKMODE lockmode, bool sessionLock)
 
     /* Attempt fast release of any lock eligible for the fast path. */
     if (EligibleForRelationFastPath(locktag, lockmode) &&
-        FastPathLocalUseCount > 0)
+        FastPathLocalUseCounts[FAST_PATH_REL_GROUP(locktag->locktag_field2)] > 0)
     {
         bool        released;
 
@@ -2672,12 +2711,15 @@ LockReassignOwner(LOCALLOCK *locallock, ResourceOwner parent)
 static bool
 FastPathGrantRelationLock(Oid relid, LOCKMODE lockmode)
 {
-    uint32        f;
-    uint32        unused_slot = FP_LOCK_SLOTS_PER_BACKEND;
+    uint32        i;
+    uint32        unused_slot = FastPathLockSlotsPerBackend();
+    uint32        group = FAST_PATH_REL_GROUP(relid);
 
     /* Scan for existing entry for this relid, remembering empty slot. */
-    for (f = 0; f < FP_LOCK_SLOTS_PER_BACKEND; f++)
+    for (i = 0; i < FP_LOCK_SLOTS_PER_GROUP; i++)
     {
+        uint32        f = FAST_PATH_SLOT(group, i);
+
         if (FAST_PATH_GET_BITS(MyProc, f) == 0)
             unused_slot = f;
         else if (MyProc->fpRelId[f] == relid)
@@ -2689,11 +2731,11 @@ FastPathGrantRelationLock(Oid relid, LOCKMODE lockmode)
     }
 
     /* If no existing entry, use any empty slot. */
-    if (unused_slot < FP_LOCK_SLOTS_PER_BACKEND)
+    if (unused_slot < FastPathLockSlotsPerBackend())
     {
         MyProc->fpRelId[unused_slot] = relid;
         FAST_PATH_SET_LOCKMODE(MyProc, unused_slot, lockmode);
-        ++FastPathLocalUseCount;
+        ++FastPathLocalUseCounts[group];
         return true;
     }
 
@@ -2709,22 +2751,25 @@ FastPathGrantRelationLock(Oid relid, LOCKMODE lockmode)
 static bool
 FastPathUnGrantRelationLock(Oid relid, LOCKMODE lockmode)
 {
-    uint32        f;
+    uint32        i;
     bool        result = false;
+    uint32        group = FAST_PATH_REL_GROUP(relid);
 
-    FastPathLocalUseCount = 0;
-    for (f = 0; f < FP_LOCK_SLOTS_PER_BACKEND; f++)
+    FastPathLocalUseCounts[group] = 0;
+    for (i = 0; i < FP_LOCK_SLOTS_PER_GROUP; i++)
     {
+        uint32        f = FAST_PATH_SLOT(group, i);
+
         if (MyProc->fpRelId[f] == relid
             && FAST_PATH_CHECK_LOCKMODE(MyProc, f, lockmode))
         {
             Assert(!result);
             FAST_PATH_CLEAR_LOCKMODE(MyProc, f, lockmode);
             result = true;
-            /* we continue iterating so as to update FastPathLocalUseCount */
+            /* we continue iterating so as to update FastPathLocalUseCounts */
         }
         if (FAST_PATH_GET_BITS(MyProc, f) != 0)
-            ++FastPathLocalUseCount;
+            ++FastPathLocalUseCounts[group];
     }
     return result;
 }
@@ -2742,6 +2787,7 @@ FastPathTransferRelationLocks(LockMethod lockMethodTable, const LOCKTAG *locktag
 {// #lizard forgives
     LWLock       *partitionLock = LockHashPartitionLock(hashcode);
     Oid            relid = locktag->locktag_field2;
+    uint32        group = FAST_PATH_REL_GROUP(relid);
     uint32        i;
 
     /*
@@ -2753,7 +2799,7 @@ FastPathTransferRelationLocks(LockMethod lockMethodTable, const LOCKTAG *locktag
     for (i = 0; i < ProcGlobal->allProcCount; i++)
     {
         PGPROC       *proc = &ProcGlobal->allProcs[i];
-        uint32        f;
+        uint32        j;
 
         LWLockAcquire(&proc->backendLock, LW_EXCLUSIVE);
 
@@ -2778,9 +2824,11 @@ FastPathTransferRelationLocks(LockMethod lockMethodTable, const LOCKTAG *locktag
             continue;
         }
 
-        for (f = 0; f < FP_LOCK_SLOTS_PER_BACKEND; f++)
+        /* The relation can only be in the slots of its group. */
+        for (j = 0; j < FP_LOCK_SLOTS_PER_GROUP; j++)
         {
             uint32        lockmode;
+            uint32        f = FAST_PATH_SLOT(group, j);
 
             /* Look for an allocated slot matching the given relid. */
             if (relid != proc->fpRelId[f] || FAST_PATH_GET_BITS(proc, f) == 0)
@@ -2832,13 +2880,15 @@ FastPathGetRelationLockEntry(LOCALLOCK *locallock)
     PROCLOCK   *proclock = NULL;
     LWLock       *partitionLock = LockHashPartitionLock(locallock->hashcode);
     Oid            relid = locktag->locktag_field2;
-    uint32        f;
+    uint32        group = FAST_PATH_REL_GROUP(relid);
+    uint32        i;
 
     LWLockAcquire(&MyProc->backendLock, LW_EXCLUSIVE);
 
-    for (f = 0; f < FP_LOCK_SLOTS_PER_BACKEND; f++)
+    for (i = 0; i < FP_LOCK_SLOTS_PER_GROUP; i++)
     {
         uint32        lockmode;
+        uint32        f = FAST_PATH_SLOT(group, i);
 
         /* Look for an allocated slot matching the given relid. */
         if (relid != MyProc->fpRelId[f] || FAST_PATH_GET_BITS(MyProc, f) == 0)
@@ -2976,6 +3026,7 @@ GetLockConflicts(const LOCKTAG *locktag, LOCKMODE lockmode)
     {
         int            i;
         Oid            relid = locktag->locktag_field2;
+        uint32        group = FAST_PATH_REL_GROUP(relid);
         VirtualTransactionId vxid;
 
         /*
@@ -2991,7 +3042,7 @@ GetLockConflicts(const LOCKTAG *locktag, LOCKMODE lockmode)
         for (i = 0; i < ProcGlobal->allProcCount; i++)
         {
             PGPROC       *proc = &ProcGlobal->allProcs[i];
-            uint32        f;
+            uint32        j;
 
             /* A backend never blocks itself */
             if (proc == MyProc)
@@ -3013,9 +3064,10 @@ GetLockConflicts(const LOCKTAG *locktag, LOCKMODE lockmode)
                 continue;
             }
 
-            for (f = 0; f < FP_LOCK_SLOTS_PER_BACKEND; f++)
+            for (j = 0; j < FP_LOCK_SLOTS_PER_GROUP; j++)
             {
                 uint32        lockmask;
+                uint32        f = FAST_PATH_SLOT(group, j);
 
                 /* Look for an allocated slot matching the given relid. */
                 if (relid != proc->fpRelId[f])
@@ -3614,7 +3666,7 @@ GetLockStatusData(void)
 
         LWLockAcquire(&proc->backendLock, LW_SHARED);
 
-        for (f = 0; f < FP_LOCK_SLOTS_PER_BACKEND; ++f)
+        for (f = 0; f < FastPathLockSlotsPerBackend(); ++f)
         {
             LockInstanceData *instance;
             uint32        lockbits = FAST_PATH_GET_BITS(proc, f);
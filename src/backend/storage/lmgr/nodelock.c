@@ -90,6 +90,8 @@
 #include "tcop/utility.h"
 #include "catalog/pg_type.h"
 #include "utils/formatting.h"
+#include "utils/memutils.h"
+#include "port/atomics.h"
 
 
 
@@ -180,11 +182,44 @@ static NodeLockData *nodelock = NULL;
 
 static NodeLockData nodelock_Copy;
 
+/*
+ * Bumped whenever the light locks change, kept apart from NodeLockData so
+ * that the layout of the control file stays the same.
+ */
+static pg_atomic_uint32 *nodelockGeneration = NULL;
+
+/*
+ * Backend-local copy of the light locks, used by LightLockCheck which runs
+ * for every DML row.  It is rebuilt whenever the shared generation moves;
+ * in steady state no light lock is set and the check ends after comparing
+ * the generation.
+ */
+typedef struct LightLockCache
+{
+    bool    valid;
+    uint32  generation;
+    bool    active[NUM_LIGHT_LOCK];          /* any table or shard locked */
+    bool    hasTables[NUM_LIGHT_LOCK];       /* any table locked */
+    Oid     lastTable[NUM_LIGHT_LOCK];       /* result of the last table lookup */
+    bool    lastTableLocked[NUM_LIGHT_LOCK];
+    Bitmapset *shard[NUM_LIGHT_LOCK];       /* copies of the shard bitmaps */
+} LightLockCache;
+
+static LightLockCache lightLockCache;
+
+/* tell all backends to rebuild their light lock cache */
+static inline void
+NodeLockChanged(void)
+{
+    pg_atomic_fetch_add_u32(nodelockGeneration, 1);
+}
+
 Size NodeLockShmemSize(void)
 {
     Size size = 0;
 
     size = add_size(size, NODELOCKSIZE);
+    size = add_size(size, sizeof(pg_atomic_uint32));
 
     return size;
 }
@@ -195,6 +230,12 @@ void NodeLockShmemInit(void)
     bool found = false;
     Bitmapset *shardbitmap = NULL;
 
+    nodelockGeneration = (pg_atomic_uint32 *)ShmemInitStruct("Node Lock Generation",
+                                             sizeof(pg_atomic_uint32),
+                                             &found);
+    if (!found)
+        pg_atomic_init_u32(nodelockGeneration, 0);
+
     nodelock = (NodeLockData *)ShmemInitStruct("Node Locks",
                                              NODELOCKSIZE,
                                              &found);
@@ -901,6 +942,8 @@ bool NodeLock(char *lockActions, char objectType, char *param1, char *param2, in
             memcpy((char *)nodelock, (char *)&nodelock_Copy, NODELOCKSIZE);
         }
 
+        NodeLockChanged();
+
         LWLockRelease(NodeLockMgrLock);
     }
 
@@ -956,6 +999,8 @@ bool NodeLock(char *lockActions, char objectType, char *param1, char *param2, in
 
                 memcpy((char *)nodelock, (char *)&nodelock_Copy, NODELOCKSIZE);
 
+                NodeLockChanged();
+
                 LWLockRelease(NodeLockMgrLock);
 
                 elog(NOTICE, "Failed to lock node: There are running transactions.");
@@ -1057,6 +1102,8 @@ bool NodeUnLock(char *lockActions, char objectType, char *param1, char *param2)
             memcpy((char *)nodelock, (char *)&nodelock_Copy, NODELOCKSIZE);
         }
 
+        NodeLockChanged();
+
         if (ret)
         {
             WriteNodeLockFile();
@@ -1184,7 +1231,9 @@ isDDL(void *parsetree)
 void
 LightLockCheck(CmdType cmd, Oid table, int shard)
 {
-	DMLLockContent *lock = NULL;
+	LightLockCache *cache = &lightLockCache;
+	uint32      generation;
+	int         i;
 
 	if (cmd < CMD_SELECT || cmd > CMD_DELETE)
 	{
@@ -1195,37 +1244,60 @@ LightLockCheck(CmdType cmd, Oid table, int shard)
 	{
 		cmd = CMD_SELECT + 4;
 	}
-	lock = &nodelock->lock[cmd - OFFSET];
-
-	//LWLockAcquire(NodeLockMgrLock, LW_SHARED);
+	i = cmd - OFFSET;
 
-    if (lock->nTables > 0 && OidIsValid(table))
-    {
-        int idx = 0;
+	generation = pg_atomic_read_u32(nodelockGeneration);
+	if (!cache->valid || cache->generation != generation)
+	{
+		/*
+		 * Take a new copy of the light locks.  Should they change while we
+		 * copy, the generation moves again and the next check rebuilds.
+		 */
+		pg_read_barrier();
+		for (i = 0; i < NUM_LIGHT_LOCK; i++)
+		{
+			DMLLockContent *lock = &nodelock->lock[i];
+
+			if (cache->shard[i] == NULL)
+				cache->shard[i] = (Bitmapset *) MemoryContextAlloc(TopMemoryContext,
+																   SHARD_BITMAP_SIZE);
+			memcpy(cache->shard[i], lock->shard, SHARD_BITMAP_SIZE);
+			cache->hasTables[i] = lock->nTables > 0;
+			cache->active[i] = cache->hasTables[i] ||
+				!bms_is_empty(cache->shard[i]);
+			cache->lastTable[i] = InvalidOid;
+			cache->lastTableLocked[i] = false;
+		}
+		cache->generation = generation;
+		cache->valid = true;
+		i = cmd - OFFSET;
+	}
 
-        idx = HashSearch(lock, table, FIND);
+	/* no table or shard is locked for this command */
+	if (!cache->active[i])
+	{
+		return;
+	}
 
-        if (idx > 0)
+    if (cache->hasTables[i] && OidIsValid(table))
+    {
+        if (cache->lastTable[i] != table)
         {
-			//LWLockRelease(NodeLockMgrLock);
+            cache->lastTableLocked[i] = HashSearch(&nodelock->lock[i], table, FIND) > 0;
+            cache->lastTable[i] = table;
+        }
 
-            elog(ERROR, "%s on table %s is not permitted.", LockMessages[cmd - OFFSET], get_rel_name(table));
+        if (cache->lastTableLocked[i])
+        {
+            elog(ERROR, "%s on table %s is not permitted.", LockMessages[i], get_rel_name(table));
         }
     }
 
-    if (ShardIDIsValid(shard) && lock->nShards[shard] > 0 )
+    if (ShardIDIsValid(shard) &&
+        bms_is_member(shard, cache->shard[i]))
     {
-        Bitmapset *shardbitmap = (Bitmapset *)lock->shard;
-        
-        if (bms_is_member(shard, shardbitmap))
-        {
-			//LWLockRelease(NodeLockMgrLock);
-
-            elog(ERROR, "%s on shard %d is not permitted.", LockMessages[cmd - OFFSET], shard);
-        }
+        elog(ERROR, "%s on shard %d is not permitted.", LockMessages[i], shard);
     }
-    
-	//LWLockRelease(NodeLockMgrLock);
 }
 
 
@@ -1649,6 +1721,8 @@ void nodeLockRecovery(void)
                 errmsg("could not read control file \"%s\"", controlFile)));
         }
         close(fd);
+
+        NodeLockChanged();
     }
 }
 
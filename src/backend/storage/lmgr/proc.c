@@ -125,6 +125,11 @@ ProcGlobalShmemSize(void)
     size = add_size(size, mul_size(NUM_AUXILIARY_PROCS, sizeof(PGXACT)));
     size = add_size(size, mul_size(max_prepared_xacts, sizeof(PGXACT)));
 
+    /* Fast-path lock arrays, sized by InitializeFastPathLocks() */
+    size = add_size(size,
+                    mul_size(MaxBackends + NUM_AUXILIARY_PROCS + max_prepared_xacts,
+                             FastPathLockShmemSize()));
+
     return size;
 }
 
@@ -170,6 +175,7 @@ InitProcGlobal(void)
 {// #lizard forgives
     PGPROC       *procs;
     PGXACT       *pgxacts;
+    char       *fpPtr;
     int            i,
                 j;
     bool        found;
@@ -220,9 +226,20 @@ InitProcGlobal(void)
     MemSet(pgxacts, 0, TotalProcs * sizeof(PGXACT));
     ProcGlobal->allPgXact = pgxacts;
 
+    /*
+     * Allocate the fast-path lock arrays in one chunk.  Their size depends on
+     * max_locks_per_transaction, so they can't be embedded in PGPROC.
+     */
+    fpPtr = (char *) ShmemAlloc(TotalProcs * FastPathLockShmemSize());
+    MemSet(fpPtr, 0, TotalProcs * FastPathLockShmemSize());
+
     for (i = 0; i < TotalProcs; i++)
     {
         /* Common initialization for all PGPROCs, regardless of type. */
+        procs[i].fpLockBits = (uint64 *) fpPtr;
+        fpPtr += MAXALIGN(FastPathLockGroupsPerBackend * sizeof(uint64));
+        procs[i].fpRelId = (Oid *) fpPtr;
+        fpPtr += MAXALIGN(FastPathLockSlotsPerBackend() * sizeof(Oid));
 
         /*
          * Set up per-PGPROC semaphore, latch, and backendLock. Prepared xact
@@ -15,6 +15,19 @@
 
 #include "storage/checksum.h"
 
+/*
+ * The checksum loop is written so that the compiler can vectorize it, but the
+ * multiplications only vectorize well with AVX2 and later, which we can not
+ * assume at build time. Where the compiler and the dynamic linker allow it,
+ * build AVX-512 and AVX2 clones of pg_checksum_block() as well; the best one
+ * the CPU supports is picked when the backend is loaded.
+ */
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 7 && \
+    defined(__x86_64__) && defined(__linux__)
+#define PG_CHECKSUM_BLOCK_ATTRIBUTES \
+    __attribute__((target_clones("avx512f", "avx2", "default")))
+#endif
+
 /*
  * The actual code is in storage/checksum_impl.h.  This is done so that
  * external programs can incorporate the checksum code by #include'ing
@@ -1534,9 +1534,48 @@ void mddealloc(SMgrRelation reln, ForkNumber forknum, BlockNumber from_blk)
 #endif
 }
 
+/*
+ *    mdrealloc() -- Allocate the storage of the extent beginning at from_blk.
+ *
+ *        The extent may lie beyond the current end of the file, in which case
+ *        the file is extended by the whole extent at once; its blocks read as
+ *        zeroes.  Filesystems without fallocate() get the missing blocks
+ *        written as zeroes instead.
+ */
 void mdrealloc(SMgrRelation reln, ForkNumber forknum, BlockNumber from_blk)
 {
-    
+    off_t        seekpos;
+    MdfdVec    *v;
+
+    if(from_blk % PAGES_PER_EXTENTS != 0)
+    {
+        ereport(ERROR,
+                (errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+                 errmsg("reallocing must begin with first block of a extent, but from_blk is %d",
+                        from_blk)));
+    }
+
+    v = _mdfd_getseg(reln, forknum, from_blk, false, EXTENSION_CREATE);
+
+    seekpos = (off_t) BLCKSZ * (from_blk % ((BlockNumber) RELSEG_SIZE));
+    Assert(seekpos + (off_t) BLCKSZ * PAGES_PER_EXTENTS <= (off_t) BLCKSZ * RELSEG_SIZE);
+
+    if (FileAllocate(v->mdfd_vfd, seekpos, (off_t) BLCKSZ * PAGES_PER_EXTENTS,
+                     WAIT_EVENT_DATA_FILE_EXTEND) != 0)
+    {
+        char       *zerobuf = palloc0(BLCKSZ);
+        BlockNumber segstart = from_blk - from_blk % ((BlockNumber) RELSEG_SIZE);
+        BlockNumber blkno;
+
+        for (blkno = Max(from_blk, segstart + _mdnblocks(reln, forknum, v));
+             blkno < from_blk + PAGES_PER_EXTENTS; blkno++)
+            mdextend(reln, forknum, blkno, zerobuf, true);
+
+        pfree(zerobuf);
+    }
+
+    if (!SmgrIsTemp(reln))
+        register_dirty_segment(reln, forknum, v);
 }
 #endif
 
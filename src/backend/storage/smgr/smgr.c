@@ -24,6 +24,7 @@
 #include "utils/hsearch.h"
 #include "utils/inval.h"
 #ifdef _MLS_
+#include "storage/decrypt_cache.h"
 #include "storage/relcryptstorage.h"
 #endif
 
@@ -187,6 +188,7 @@ smgropen(RelFileNode rnode, BackendId backend)
         //MemSet(reln->smgr_shard_targblocks, 0, sizeof(reln->smgr_shard_targblocks));
         //reln->smgr_shard_tb_lasthit = -1;
         reln->smgr_ema_nblocks = InvalidBlockNumber;
+        smgr_reset_freeext_hints(reln);
 #endif
         reln->smgr_fsm_nblocks = InvalidBlockNumber;
         reln->smgr_vm_nblocks = InvalidBlockNumber;
@@ -816,6 +818,11 @@ smgrdealloc(SMgrRelation reln, ForkNumber forknum, BlockNumber from_blk)
 {
 #ifndef DISABLE_FALLOCATE
     (*(smgrsw[reln->smgr_which].smgr_dealloc)) (reln, forknum, from_blk);
+#ifdef _MLS_
+    /* the extent now reads as zeroes, forget what it held */
+    DecryptCacheDropBlocks(&reln->smgr_rnode.node, forknum, from_blk,
+                           from_blk + PAGES_PER_EXTENTS);
+#endif
 #endif
 }
 
@@ -823,6 +830,10 @@ void
 smgrrealloc(SMgrRelation reln, ForkNumber forknum, BlockNumber from_blk)
 {
     (*(smgrsw[reln->smgr_which].smgr_realloc)) (reln, forknum, from_blk);
+#ifdef _MLS_
+    DecryptCacheDropBlocks(&reln->smgr_rnode.node, forknum, from_blk,
+                           from_blk + PAGES_PER_EXTENTS);
+#endif
 }
 #endif
 
@@ -931,4 +942,44 @@ smgr_set_target_block(SMgrRelation rel, ShardID shardid, BlockNumber blkno)
 #endif
 }
 
+/*
+ * Hints for GetExtentWithFreeSpace, so that inserts into a shard need not
+ * walk its whole extent list to find room. They are only hints, the caller
+ * must check the extent still belongs to the shard.
+ */
+void
+smgr_reset_freeext_hints(SMgrRelation rel)
+{
+    int i;
+
+    for (i = 0; i < SMGR_FREEEXT_HINTS; i++)
+    {
+        rel->smgr_freeext_sid[i] = InvalidShardID;
+        rel->smgr_freeext_eid[i] = InvalidExtentID;
+    }
+}
+
+ExtentID
+smgr_get_freeext_hint(SMgrRelation rel, ShardID shardid)
+{
+    int i = shardid % SMGR_FREEEXT_HINTS;
+
+    if (!ShardIDIsValid(shardid) || rel->smgr_freeext_sid[i] != shardid)
+        return InvalidExtentID;
+
+    return rel->smgr_freeext_eid[i];
+}
+
+void
+smgr_set_freeext_hint(SMgrRelation rel, ShardID shardid, ExtentID eid)
+{
+    int i = shardid % SMGR_FREEEXT_HINTS;
+
+    if (!ShardIDIsValid(shardid))
+        return;
+
+    rel->smgr_freeext_sid[i] = shardid;
+    rel->smgr_freeext_eid[i] = eid;
+}
+
 #endif
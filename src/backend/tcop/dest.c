@@ -105,6 +105,9 @@
 #include "libpq/pqformat.h"
 #include "utils/portal.h"
 #include "miscadmin.h"
+#ifdef __TBASE__
+#include "pgxc/pgxc.h"
+#endif
 
 
 
@@ -329,6 +332,17 @@ ReadyForQuery(CommandDest dest)
 
                 pq_beginmessage(&buf, 'Z');
                 pq_sendbyte(&buf, TransactionBlockStatusCode());
+#ifdef __TBASE__
+                /*
+                 * Tell the coordinator whether this node has written in the
+                 * current transaction, so that it prepares only the nodes
+                 * which really need it. Not sent outside of a transaction,
+                 * where the pooler may still talk to us through libpq.
+                 */
+                if (IsConnFromCoord() && TransactionBlockStatusCode() != 'I')
+                    pq_sendbyte(&buf, TransactionIdIsValid(GetTopTransactionIdIfAny()) ?
+                                PGXC_READY_WRITTEN : PGXC_READY_READ_ONLY);
+#endif
                 pq_endmessage(&buf);
             }
             else
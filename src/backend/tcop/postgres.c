@@ -105,6 +105,7 @@
 #include "access/twophase.h"
 #include "executor/execParallel.h"
 #include "pgxc/poolutils.h"
+#include "pgxc/shardmap.h"
 #include "commands/vacuum.h"
 #include "commands/explain_dist.h"
 #endif
@@ -207,6 +208,9 @@ static bool RecoveryConflictRetryable = true;
 static ProcSignalReason RecoveryConflictReason;
 
 #ifdef __TBASE__
+/* whether we were canceled as the victim of a global deadlock */
+static volatile sig_atomic_t GlobalDeadlockPending = false;
+
 static char *remotePrepareGID = NULL;
 /* for error code contrib */
 bool g_is_in_init_phase = false;
@@ -654,6 +658,7 @@ SocketBackend(StringInfo inBuf)
 #ifdef PGXC /* PGXC_DATANODE */
 #ifdef __TBASE__
         case 'N':
+        case 'J':                /* runtime join filter */
 		case 'U':				/* coord info: coord_pid and top_xid */
 		case 'o':               /* global session id */
 #endif
@@ -1181,6 +1186,12 @@ exec_simple_query(const char *query_string)
      */
     start_xact_command();
 
+#ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+    /* Let GTM work on the snapshot timestamp while we parse and plan. */
+    if (IS_PGXC_LOCAL_COORDINATOR)
+        PrefetchGlobalTimestampGTM();
+#endif
+
     /*
      * Zap any pre-existing unnamed statement.  (While not strictly necessary,
      * it seems best to define simple-Query mode as if it used the unnamed
@@ -3478,6 +3489,11 @@ start_xact_command(void)
 {
     if (!xact_started)
     {
+#ifdef __TBASE__
+        /* the connections must be done with the previous commit */
+        if (IS_PGXC_LOCAL_COORDINATOR)
+            FinishAsyncCommit_Remote();
+#endif
         StartTransactionCommand();
 
         /* Set statement timeout running, if any */
@@ -3769,6 +3785,33 @@ PostgresSigHupHandler(SIGNAL_ARGS)
     errno = save_errno;
 }
 
+#ifdef __TBASE__
+/*
+ * HandleGlobalDeadlockInterrupt: the global deadlock detector picked our
+ * transaction as the victim of a wait-for cycle spanning several nodes.
+ * Called from the SIGUSR1 handler. The signal is ignored unless we are
+ * still waiting for a lock, so that a backend whose wait ended meanwhile
+ * is not cancelled for nothing.
+ */
+void
+HandleGlobalDeadlockInterrupt(void)
+{
+    int            save_errno = errno;
+
+    if (!proc_exit_inprogress && MyProc != NULL && MyProc->waitLock != NULL)
+    {
+        GlobalDeadlockPending = true;
+        QueryCancelPending = true;
+        InterruptPending = true;
+    }
+
+    /* Set the process latch, so the lock wait notices the cancel */
+    SetLatch(MyLatch);
+
+    errno = save_errno;
+}
+#endif
+
 /*
  * RecoveryConflictInterrupt: out-of-line portion of recovery conflict
  * handling following receipt of SIGUSR1. Designed to be similar to die()
@@ -4001,6 +4044,13 @@ ProcessInterrupts(void)
          */
         if (QueryCancelHoldoffCount != 0)
         {
+#ifdef __TBASE__
+            /*
+             * We are reading a message, not waiting for a lock, so whatever
+             * wait the global deadlock detector saw is over.
+             */
+            GlobalDeadlockPending = false;
+#endif
             /*
              * Re-arm InterruptPending so that we process the cancel request
              * as soon as we're done reading the message.
@@ -4059,6 +4109,19 @@ ProcessInterrupts(void)
                      errmsg("canceling statement due to conflict with recovery"),
                      errdetail_recovery_conflict()));
         }
+#ifdef __TBASE__
+        if (GlobalDeadlockPending)
+        {
+            GlobalDeadlockPending = false;
+            if (!DoingCommandRead)
+            {
+                LockErrorCleanup();
+                ereport(ERROR,
+                        (errcode(ERRCODE_T_R_DEADLOCK_DETECTED),
+                         errmsg("canceling statement due to global deadlock")));
+            }
+        }
+#endif
 
         /*
          * If we are reading a command from the client, just ignore the cancel
@@ -5116,6 +5179,9 @@ PostgresMain(int argc, char *argv[],
          */
         disable_all_timeouts(false);
         QueryCancelPending = false; /* second to avoid race condition */
+#ifdef __TBASE__
+        GlobalDeadlockPending = false;
+#endif
 
         /* Not reading from the client anymore. */
         DoingCommandRead = false;
@@ -5303,6 +5369,11 @@ PostgresMain(int argc, char *argv[],
          */
         if (send_ready_for_query)
         {
+#ifdef __TBASE__
+            /* publish the shard statistic counted by the last statement */
+            FlushPendingShardStatistic();
+#endif
+
             if (IsAbortedTransactionBlockState())
             {
                 set_ps_display("idle in transaction (aborted)", false);
@@ -5358,6 +5429,21 @@ PostgresMain(int argc, char *argv[],
             if ((IS_PGXC_DATANODE || IsConnFromCoord()) && !IsAnyAfterTriggerDeferred())
                 UnsetGlobalSnapshotData();
 #endif
+#ifdef __TBASE__
+            /*
+             * The client has its answer, collect the confirmations of an
+             * asynchronous distributed commit while it prepares the next
+             * command.
+             */
+            if (IS_PGXC_LOCAL_COORDINATOR)
+                FinishAsyncCommit_Remote();
+
+            /*
+             * Likewise, drop the 2pc record files of prepared transactions
+             * this participant committed asynchronously.
+             */
+            AtIdle_AsyncCommitRecords();
+#endif
 
             send_ready_for_query = false;
         }
@@ -5719,6 +5805,9 @@ PostgresMain(int argc, char *argv[],
                         pq_flush();
                     }
                 }
+                break;
+            case 'J':                /* runtime join filter, no response */
+                SharedQueueRecvFilter(&input_message);
                 break;
 			case 'U':			/* coord info: coord_pid and coord_vxid */
 				{
@@ -5733,11 +5822,13 @@ PostgresMain(int argc, char *argv[],
 					elog(DEBUG5, "Received coord_pid: %d, coord_vxid: %u", coord_pid, coord_vxid);
 				}
 				break;
-			case 'o':       /* session id */
+			case 'o':       /* session id and global query id */
 				{
 					const char *sessionid = pq_getmsgstring(&input_message);
+					uint32      queryid = (uint32) pq_getmsgint(&input_message, 4);
 					pq_getmsgend(&input_message);
 					strncpy((char *) PGXCSessionId, sessionid, NAMEDATALEN);
+					PGXCQueryId = queryid;
 				}
 				break;
 #endif
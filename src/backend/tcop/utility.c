@@ -3256,8 +3256,11 @@ ProcessUtilitySlow(ParseState *pstate,
 #ifdef __TBASE__
                             CreateStmt *createStmt = (CreateStmt *)stmt;
 
-                            /* Set temporary object object flag in pooler */
-                            if (is_temp)
+                            /*
+                             * Set temporary object object flag in pooler,
+                             * unless the table goes away at commit
+                             */
+                            if (is_temp && createStmt->oncommit != ONCOMMIT_DROP)
                             {
                                 PoolManagerSetCommand(NULL, 0, POOL_CMD_TEMP, NULL);
                             }
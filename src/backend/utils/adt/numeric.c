@@ -3199,6 +3199,16 @@ typedef struct NumericAggState
     int            maxScale;        /* maximum scale seen so far */
     int64        maxScaleCount;    /* number of values seen with maximum scale */
     int64        NaNcount;        /* count of NaN values (not included in N!) */
+#ifdef HAVE_INT128
+    /*
+     * sum/avg fast path: inputs that fit are summed into fastSum, scaled by
+     * 10^fastScale, and only folded into sumX on overflow or when the state
+     * is combined, serialized or finalized.
+     */
+    bool        fastPending;    /* fastSum holds values not yet in sumX */
+    int            fastScale;        /* decimal scale of fastSum */
+    int128        fastSum;        /* pending part of sumX, times 10^fastScale */
+#endif
 } NumericAggState;
 
 /*
@@ -3242,6 +3252,164 @@ makeNumericAggStateCurrentContext(bool calcSumX2)
     return state;
 }
 
+#ifdef HAVE_INT128
+#define NUMERIC_INT128_MAX ((int128) (((uint128) 1 << 127) - 1))
+
+/*
+ * Multiply *val by 10^exp, returning false if the result would not fit.
+ */
+static bool
+int128_mul_pow10(int128 *val, int exp)
+{
+    int128        v = *val;
+
+    for (; exp > 0; exp--)
+    {
+        if (v > NUMERIC_INT128_MAX / 10 || v < -(NUMERIC_INT128_MAX / 10))
+            return false;
+        v *= 10;
+    }
+    *val = v;
+    return true;
+}
+
+/*
+ * Convert var to the integer var * 10^scale, where scale >= var->dscale.
+ * Returns false if that does not fit into an int128.
+ */
+static bool
+numericvar_to_scaled_int128(NumericVar *var, int scale, int128 *result)
+{
+    int128        val = 0;
+    int            exp;
+    int            i;
+
+    Assert(scale >= var->dscale);
+
+    if (var->ndigits == 0)
+    {
+        *result = 0;
+        return true;
+    }
+
+    for (i = 0; i < var->ndigits; i++)
+    {
+        if (val > (NUMERIC_INT128_MAX - (NBASE - 1)) / NBASE)
+            return false;
+        val = val * NBASE + var->digits[i];
+    }
+
+    /* decimal exponent of the last digit, relative to the requested scale */
+    exp = (var->weight - var->ndigits + 1) * DEC_DIGITS + scale;
+    if (exp > 0)
+    {
+        if (!int128_mul_pow10(&val, exp))
+            return false;
+    }
+    else
+    {
+        /* only the zero padding of the last digit past dscale is cut off */
+        for (; exp < 0; exp++)
+            val /= 10;
+    }
+
+    *result = (var->sign == NUMERIC_NEG) ? -val : val;
+    return true;
+}
+
+/*
+ * Fold the pending int128 sum of a sum/avg state into its sumX.
+ */
+static void
+numeric_fast_sum_flush(NumericAggState *state)
+{
+    static const int pad_powers[] = {1, 10, 100, 1000};
+    NumericVar    X;
+    MemoryContext old_context;
+
+    if (!state->fastPending)
+        return;
+
+    init_var(&X);
+    if (state->fastSum == 0)
+        set_var_from_var(&const_zero, &X);
+    else
+    {
+        NumericVar    intval;
+        NumericVar    pad;
+        int            shift;
+
+        /*
+         * Pad the integer with zeroes up to a whole number of NBASE digits
+         * below the decimal point, then move the point by adjusting weight.
+         */
+        shift = (DEC_DIGITS - state->fastScale % DEC_DIGITS) % DEC_DIGITS;
+        init_var(&intval);
+        init_var(&pad);
+        int128_to_numericvar(state->fastSum, &intval);
+        int64_to_numericvar(pad_powers[shift], &pad);
+        mul_var(&intval, &pad, &X, 0);
+        X.weight -= (state->fastScale + shift) / DEC_DIGITS;
+        free_var(&intval);
+        free_var(&pad);
+    }
+    X.dscale = state->fastScale;
+
+    old_context = MemoryContextSwitchTo(state->agg_context);
+    accum_sum_add(&(state->sumX), &X);
+    MemoryContextSwitchTo(old_context);
+
+    free_var(&X);
+    state->fastSum = 0;
+    state->fastPending = false;
+}
+
+/*
+ * Try to add X to the int128 sum of a sum/avg state.  On overflow the
+ * pending sum is folded into sumX and summing restarts from X; false is
+ * returned only if X itself does not fit.
+ */
+static bool
+do_numeric_fast_accum(NumericAggState *state, NumericVar *X)
+{
+    int128        val;
+    int            scale;
+
+    if (!state->fastPending)
+        state->fastScale = X->dscale;
+
+    scale = Max(state->fastScale, X->dscale);
+    if (!numericvar_to_scaled_int128(X, scale, &val))
+        return false;
+
+    if (scale > state->fastScale)
+    {
+        if (!int128_mul_pow10(&state->fastSum, scale - state->fastScale))
+            numeric_fast_sum_flush(state);
+        state->fastScale = scale;
+    }
+
+    if ((val > 0 && state->fastSum > NUMERIC_INT128_MAX - val) ||
+        (val < 0 && state->fastSum < -NUMERIC_INT128_MAX - val))
+        numeric_fast_sum_flush(state);
+
+    state->fastSum += val;
+    state->fastPending = true;
+    return true;
+}
+#endif
+
+/*
+ * Fold any pending fast-path sum of the state into sumX.
+ */
+static inline void
+numeric_agg_state_flush(NumericAggState *state)
+{
+#ifdef HAVE_INT128
+    numeric_fast_sum_flush(state);
+#endif
+}
+
 /*
  * Accumulate a new input value for numeric aggregate functions.
  */
@@ -3274,6 +3442,15 @@ do_numeric_accum(NumericAggState *state, Numeric newval)
     else if (X.dscale == state->maxScale)
         state->maxScaleCount++;
 
+#ifdef HAVE_INT128
+    /* sum/avg inputs that fit in 128 bits skip the digit accumulator */
+    if (!state->calcSumX2 && do_numeric_fast_accum(state, &X))
+    {
+        state->N++;
+        return;
+    }
+#endif
+
     /* if we need X^2, calculate that in short-lived context */
     if (state->calcSumX2)
     {
@@ -3357,6 +3534,8 @@ do_numeric_discard(NumericAggState *state, Numeric newval)
         }
     }
 
+    numeric_agg_state_flush(state);
+
     /* if we need X^2, calculate that in short-lived context */
     if (state->calcSumX2)
     {
@@ -3523,6 +3702,8 @@ numeric_avg_combine(PG_FUNCTION_ARGS)
     if (state2 == NULL)
         PG_RETURN_POINTER(state1);
 
+    numeric_agg_state_flush(state2);
+
     /* manually copy all fields from state2 to state1 */
     if (state1 == NULL)
     {
@@ -3590,6 +3771,9 @@ numeric_avg_serialize(PG_FUNCTION_ARGS)
 
     state = (NumericAggState *) PG_GETARG_POINTER(0);
 
+    /* the serialized state only carries sumX */
+    numeric_agg_state_flush(state);
+
     /*
      * This is a little wasteful since make_result converts the NumericVar
      * into a Numeric and numeric_send converts it back again. Is it worth
@@ -4604,6 +4788,8 @@ numeric_avg(PG_FUNCTION_ARGS)
     if (state->NaNcount > 0)    /* there was at least one NaN input */
         PG_RETURN_NUMERIC(make_result(&const_nan));
 
+    numeric_agg_state_flush(state);
+
     N_datum = DirectFunctionCall1(int8_numeric, Int64GetDatum(state->N));
 
     init_var(&sumX_var);
@@ -4630,6 +4816,8 @@ numeric_sum(PG_FUNCTION_ARGS)
     if (state->NaNcount > 0)    /* there was at least one NaN input */
         PG_RETURN_NUMERIC(make_result(&const_nan));
 
+    numeric_agg_state_flush(state);
+
     init_var(&sumX_var);
     accum_sum_final(&state->sumX, &sumX_var);
     result = make_result(&sumX_var);
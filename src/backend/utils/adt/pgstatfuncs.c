@@ -467,6 +467,8 @@ pg_stat_get_progress_info(PG_FUNCTION_ARGS)
     /* Translate command name into command type code. */
     if (pg_strcasecmp(cmd, "VACUUM") == 0)
         cmdtype = PROGRESS_COMMAND_VACUUM;
+    else if (pg_strcasecmp(cmd, "CREATE INDEX") == 0)
+        cmdtype = PROGRESS_COMMAND_CREATE_INDEX;
     else
         ereport(ERROR,
                 (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
@@ -2116,6 +2116,7 @@ timestamp_cmp(PG_FUNCTION_ARGS)
     PG_RETURN_INT32(timestamp_cmp_internal(dt1, dt2));
 }
 
+#ifndef USE_FLOAT8_BYVAL
 /* note: this is used for timestamptz also */
 static int
 timestamp_fastcmp(Datum x, Datum y, SortSupport ssup)
@@ -2125,13 +2126,19 @@ timestamp_fastcmp(Datum x, Datum y, SortSupport ssup)
 
     return timestamp_cmp_internal(a, b);
 }
+#endif
 
 Datum
 timestamp_sortsupport(PG_FUNCTION_ARGS)
 {
     SortSupport ssup = (SortSupport) PG_GETARG_POINTER(0);
 
+#ifdef USE_FLOAT8_BYVAL
+    /* timestamps order like int64, this is used for timestamptz also */
+    ssup->comparator = ssup_datum_signed_cmp;
+#else
     ssup->comparator = timestamp_fastcmp;
+#endif
     PG_RETURN_VOID();
 }
 
@@ -4805,6 +4805,33 @@ pg_column_size(PG_FUNCTION_ARGS)
     PG_RETURN_INT32(result);
 }
 
+/*
+ * Return the compression method of a varlena datum, NULL if it is not
+ * compressed
+ */
+Datum
+pg_column_compression(PG_FUNCTION_ARGS)
+{
+    Oid            argtypeid = get_fn_expr_argtype(fcinfo->flinfo, 0);
+    int            cmethod;
+
+    if (get_typlen(argtypeid) != -1)
+        PG_RETURN_NULL();
+
+    cmethod = toast_get_compression_method((struct varlena *) DatumGetPointer(PG_GETARG_DATUM(0)));
+    switch (cmethod)
+    {
+        case TOAST_PGLZ_COMPRESSION_ID:
+            PG_RETURN_TEXT_P(cstring_to_text("pglz"));
+        case TOAST_LZ4_COMPRESSION_ID:
+            PG_RETURN_TEXT_P(cstring_to_text("lz4"));
+        case TOAST_ZSTD_COMPRESSION_ID:
+            PG_RETURN_TEXT_P(cstring_to_text("zstd"));
+        default:
+            PG_RETURN_NULL();
+    }
+}
+
 /*
  * string_agg - Concatenates values and returns string.
  *
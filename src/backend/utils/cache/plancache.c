@@ -121,6 +121,10 @@ static TupleDesc PlanCacheComputeResultDesc(List *stmt_list);
 static void PlanCacheRelCallback(Datum arg, Oid relid);
 static void PlanCacheFuncCallback(Datum arg, int cacheid, uint32 hashvalue);
 static void PlanCacheSysCallback(Datum arg, int cacheid, uint32 hashvalue);
+#ifdef __TBASE__
+static void ResetRemoteSubplanCache(void);
+static void RemoteSubplanCacheCallback(Datum arg, int cacheid, uint32 hashvalue);
+#endif
 
 
 /*
@@ -138,6 +142,10 @@ InitPlanCache(void)
     CacheRegisterSyscacheCallback(AMOPOPID, PlanCacheSysCallback, (Datum) 0);
     CacheRegisterSyscacheCallback(FOREIGNSERVEROID, PlanCacheSysCallback, (Datum) 0);
     CacheRegisterSyscacheCallback(FOREIGNDATAWRAPPEROID, PlanCacheSysCallback, (Datum) 0);
+#ifdef __TBASE__
+    /* decoded remote subplans resolved type names, the rest is covered above */
+    CacheRegisterSyscacheCallback(TYPEOID, RemoteSubplanCacheCallback, (Datum) 0);
+#endif
 }
 
 /*
@@ -1851,6 +1859,10 @@ PlanCacheRelCallback(Datum arg, Oid relid)
 {// #lizard forgives
     CachedPlanSource *plansource;
 
+#ifdef __TBASE__
+    ResetRemoteSubplanCache();
+#endif
+
     for (plansource = first_saved_plan; plansource; plansource = plansource->next_saved)
     {
         Assert(plansource->magic == CACHEDPLANSOURCE_MAGIC);
@@ -1940,6 +1952,10 @@ PlanCacheFuncCallback(Datum arg, int cacheid, uint32 hashvalue)
 {// #lizard forgives
     CachedPlanSource *plansource;
 
+#ifdef __TBASE__
+    ResetRemoteSubplanCache();
+#endif
+
     for (plansource = first_saved_plan; plansource; plansource = plansource->next_saved)
     {
         ListCell   *lc;
@@ -2028,6 +2044,10 @@ ResetPlanCache(void)
 {
     CachedPlanSource *plansource;
 
+#ifdef __TBASE__
+    ResetRemoteSubplanCache();
+#endif
+
     for (plansource = first_saved_plan; plansource; plansource = plansource->next_saved)
     {
         ListCell   *lc;
@@ -2073,32 +2093,17 @@ ResetPlanCache(void)
 
 
 #ifdef XCP
-void
-SetRemoteSubplan(CachedPlanSource *plansource, const char *plan_string)
-{// #lizard forgives
-    CachedPlan            *plan;
-    MemoryContext         plan_context;
-    MemoryContext         oldcxt;
+/*
+ * Decode a plan string sent by pgxc_node_send_plan into a PlannedStmt,
+ * allocated in the current memory context.  The portal name is left for
+ * the caller to fill in.
+ */
+static PlannedStmt *
+DecodeRemoteSubplan(const char *plan_string, bool *parallelWorkerSendTuple)
+{
     RemoteStmt            *rstmt;
     PlannedStmt        *stmt;
 
-    Assert(IS_PGXC_DATANODE);
-    Assert(plansource->raw_parse_tree == NULL);
-    Assert(plansource->query_list == NIL);
-
-    /*
-     * Make dedicated query context to store cached plan. It is in current
-     * memory context for now, later it will be reparented to
-     * CachedMemoryContext. If it is in CachedMemoryContext initially we would
-     * have to destroy it in case of error.
-     */
-    plan_context = AllocSetContextCreate(CurrentMemoryContext,
-                                         "CachedPlan",
-                                         ALLOCSET_SMALL_MINSIZE,
-                                         ALLOCSET_SMALL_INITSIZE,
-                                         ALLOCSET_DEFAULT_MAXSIZE);
-    oldcxt = MemoryContextSwitchTo(plan_context);
-
     /*
      * Restore query plan.
      *
@@ -2141,7 +2146,6 @@ SetRemoteSubplan(CachedPlanSource *plansource, const char *plan_string)
     stmt->nParamExec = rstmt->nParamExec;
     stmt->nParamRemote = rstmt->nParamRemote;
     stmt->remoteparams = rstmt->remoteparams;
-    stmt->pname = plansource->stmt_name;
     stmt->distributionType = rstmt->distributionType;
     stmt->distributionKey = rstmt->distributionKey;
     stmt->distributionNodes = rstmt->distributionNodes;
@@ -2153,14 +2157,173 @@ SetRemoteSubplan(CachedPlanSource *plansource, const char *plan_string)
     stmt->partrelindex = rstmt->partrelindex;
     stmt->partpruning = rstmt->partpruning;
 
-    HeavyLockCheck(NULL, stmt->commandType, NULL, NULL);
+    *parallelWorkerSendTuple = rstmt->parallelWorkerSendTuple;
 #endif
-            
+
 #ifdef __AUDIT__
     stmt->queryString = rstmt->queryString;
     stmt->parseTree = rstmt->parseTree;
 #endif
 
+    return stmt;
+}
+
+#ifdef __TBASE__
+/*
+ * Remote subplans decoded by this backend, keyed by the hash of their plan
+ * string.  Decoding a portable plan resolves every object name through the
+ * catalogs, copying the decoded tree is much cheaper.  The whole cache is
+ * dropped on any invalidation that could change how names resolve.
+ */
+typedef struct RemoteSubplanCacheEntry
+{
+    uint32        hashvalue;        /* hash of plan_string, the hash key */
+    char       *plan_string;
+    PlannedStmt *stmt;
+    bool        parallelWorkerSendTuple;
+} RemoteSubplanCacheEntry;
+
+int            remote_subplan_cache_size = 64;
+
+static HTAB *RemoteSubplanCache = NULL;
+static MemoryContext RemoteSubplanCacheContext = NULL;
+
+static void
+ResetRemoteSubplanCache(void)
+{
+    if (RemoteSubplanCache == NULL)
+        return;
+
+    /* the hash table lives in the context too */
+    RemoteSubplanCache = NULL;
+    MemoryContextReset(RemoteSubplanCacheContext);
+}
+
+static PlannedStmt *
+RemoteSubplanCacheLookup(const char *plan_string, bool *parallelWorkerSendTuple)
+{
+    RemoteSubplanCacheEntry *entry;
+    uint32        hashvalue;
+
+    if (RemoteSubplanCache == NULL)
+        return NULL;
+
+    hashvalue = string_hash(plan_string, 0);
+    entry = (RemoteSubplanCacheEntry *) hash_search(RemoteSubplanCache,
+                                                    &hashvalue,
+                                                    HASH_FIND, NULL);
+    if (entry == NULL || strcmp(entry->plan_string, plan_string) != 0)
+        return NULL;
+
+    *parallelWorkerSendTuple = entry->parallelWorkerSendTuple;
+    return copyObject(entry->stmt);
+}
+
+static void
+RemoteSubplanCacheStore(const char *plan_string, PlannedStmt *stmt,
+                        bool parallelWorkerSendTuple)
+{
+    RemoteSubplanCacheEntry *entry;
+    MemoryContext oldcxt;
+    char       *copy_string;
+    PlannedStmt *copy_stmt;
+    uint32        hashvalue;
+    bool        found;
+
+    if (remote_subplan_cache_size <= 0)
+        return;
+
+    if (RemoteSubplanCacheContext == NULL)
+        RemoteSubplanCacheContext = AllocSetContextCreate(CacheMemoryContext,
+                                                          "RemoteSubplanCache",
+                                                          ALLOCSET_DEFAULT_SIZES);
+
+    /* simply start over when the cache is full */
+    if (RemoteSubplanCache != NULL &&
+        hash_get_num_entries(RemoteSubplanCache) >= remote_subplan_cache_size)
+        ResetRemoteSubplanCache();
+
+    if (RemoteSubplanCache == NULL)
+    {
+        HASHCTL        ctl;
+
+        MemSet(&ctl, 0, sizeof(ctl));
+        ctl.keysize = sizeof(uint32);
+        ctl.entrysize = sizeof(RemoteSubplanCacheEntry);
+        ctl.hcxt = RemoteSubplanCacheContext;
+        RemoteSubplanCache = hash_create("Remote subplan cache",
+                                         remote_subplan_cache_size,
+                                         &ctl,
+                                         HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+    }
+
+    oldcxt = MemoryContextSwitchTo(RemoteSubplanCacheContext);
+    copy_string = pstrdup(plan_string);
+    copy_stmt = copyObject(stmt);
+    MemoryContextSwitchTo(oldcxt);
+
+    /* a colliding plan is replaced, its copy is freed with the next reset */
+    hashvalue = string_hash(plan_string, 0);
+    entry = (RemoteSubplanCacheEntry *) hash_search(RemoteSubplanCache,
+                                                    &hashvalue,
+                                                    HASH_ENTER, &found);
+    entry->plan_string = copy_string;
+    entry->stmt = copy_stmt;
+    entry->parallelWorkerSendTuple = parallelWorkerSendTuple;
+}
+
+static void
+RemoteSubplanCacheCallback(Datum arg, int cacheid, uint32 hashvalue)
+{
+    ResetRemoteSubplanCache();
+}
+#endif
+
+void
+SetRemoteSubplan(CachedPlanSource *plansource, const char *plan_string)
+{// #lizard forgives
+    CachedPlan            *plan;
+    MemoryContext         plan_context;
+    MemoryContext         oldcxt;
+    bool                parallelWorkerSendTuple = false;
+    PlannedStmt        *stmt;
+
+    Assert(IS_PGXC_DATANODE);
+    Assert(plansource->raw_parse_tree == NULL);
+    Assert(plansource->query_list == NIL);
+
+    /*
+     * Make dedicated query context to store cached plan. It is in current
+     * memory context for now, later it will be reparented to
+     * CachedMemoryContext. If it is in CachedMemoryContext initially we would
+     * have to destroy it in case of error.
+     */
+    plan_context = AllocSetContextCreate(CurrentMemoryContext,
+                                         "CachedPlan",
+                                         ALLOCSET_SMALL_MINSIZE,
+                                         ALLOCSET_SMALL_INITSIZE,
+                                         ALLOCSET_DEFAULT_MAXSIZE);
+    oldcxt = MemoryContextSwitchTo(plan_context);
+
+#ifdef __TBASE__
+    /*
+     * A pooled connection receives the same plan over and over under new
+     * statement names, copy the decoded one if we have seen it before.
+     */
+    stmt = RemoteSubplanCacheLookup(plan_string, &parallelWorkerSendTuple);
+    if (stmt == NULL)
+    {
+        stmt = DecodeRemoteSubplan(plan_string, &parallelWorkerSendTuple);
+        RemoteSubplanCacheStore(plan_string, stmt, parallelWorkerSendTuple);
+    }
+    stmt->pname = plansource->stmt_name;
+
+    HeavyLockCheck(NULL, stmt->commandType, NULL, NULL);
+#else
+    stmt = DecodeRemoteSubplan(plan_string, &parallelWorkerSendTuple);
+    stmt->pname = plansource->stmt_name;
+#endif
+
 #ifdef __TBASE__
     /* register sigusr2 handler for remotesubplan */
     pqsignal(SIGUSR2, RemoteSubplanSigusr2Handler);
@@ -2177,7 +2340,7 @@ SetRemoteSubplan(CachedPlanSource *plansource, const char *plan_string)
         bool with_params = false;
         int numParallelWorkers = 0;
 
-        if (rstmt->parallelWorkerSendTuple)
+        if (parallelWorkerSendTuple)
         {
             Gather *gather_plan = (Gather *)stmt->planTree;
 
@@ -2192,7 +2355,7 @@ SetRemoteSubplan(CachedPlanSource *plansource, const char *plan_string)
          
         SharedQueueAcquire(stmt->pname,
                            list_length(stmt->distributionRestrict) - 1,
-                           rstmt->parallelWorkerSendTuple, numParallelWorkers, with_params);
+                           parallelWorkerSendTuple, numParallelWorkers, with_params);
     }
     else
     {
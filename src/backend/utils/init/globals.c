@@ -193,6 +193,9 @@ bool        enableFsync = true;
 bool        allowSystemTableMods = false;
 int            work_mem = 1024;
 int            maintenance_work_mem = 16384;
+#ifdef __TBASE__
+int            query_work_mem = 0;
+#endif
 int            replacement_sort_tuples = 150000;
 
 /*
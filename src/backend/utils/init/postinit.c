@@ -502,7 +502,8 @@ pg_split_opts(char **argv, int *argcp, const char *optstr)
 }
 
 /*
- * Initialize MaxBackends value from config options.
+ * Initialize MaxBackends value from config options, along with the size of
+ * the fast-path lock arrays.
  *
  * This must be called after modules have had the chance to register background
  * workers in shared_preload_libraries, and before shared memory size is
@@ -525,6 +526,8 @@ InitializeMaxBackends(void)
     /* internal error because the values were all checked previously */
     if (MaxBackends > MAX_BACKENDS)
         elog(ERROR, "too many backends configured");
+
+    InitializeFastPathLocks();
 }
 
 /*
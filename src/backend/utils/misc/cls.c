@@ -85,6 +85,8 @@
 #include "utils/builtins.h"
 #include "utils/palloc.h"
 #include "utils/fmgroids.h"
+#include "utils/hsearch.h"
+#include "utils/inval.h"
 #include "utils/relcache.h"
 #include "utils/memutils.h"
 #include "utils/syscache.h"
@@ -137,6 +139,27 @@ typedef struct tagClsGroupInfo
     bool    valid;
 }ClsGroupInfo;
 
+/*
+ * verdict of one row label for current user, both user authority and labels are fixed
+ * between catalog changes, so rows of the same label share one check result.
+ */
+typedef struct tagClsCheckKey
+{
+    int16   polid;
+    int16   labelid;
+    int16   cmdtag;
+}ClsCheckKey;
+
+typedef struct tagClsCheckEntry
+{
+    ClsCheckKey key;
+    bool        result;
+}ClsCheckEntry;
+
+static HTAB *g_cls_check_cache       = NULL;
+static bool  g_cls_check_cache_valid = false;
+static bool  g_cls_check_callback_registered = false;
+
 /* every user has one of this global variable */
 ClsUserAuthority g_user_cls_priv;
 
@@ -762,6 +785,88 @@ static bool  cls_check_read(ClsItem *arg)
 }
 #endif
 
+/*
+ * any change to labels, groups or user authorities may change the verdicts, just drop them all.
+ */
+static void cls_check_cache_invalidate(Datum arg, int cacheid, uint32 hashvalue)
+{
+    g_cls_check_cache_valid = false;
+}
+
+static void cls_check_cache_reset(void)
+{
+    HASHCTL ctl;
+
+    if (!g_cls_check_callback_registered)
+    {
+        CacheRegisterSyscacheCallback(CLSLABELOID, cls_check_cache_invalidate, (Datum) 0);
+        CacheRegisterSyscacheCallback(CLSGRPOID, cls_check_cache_invalidate, (Datum) 0);
+        CacheRegisterSyscacheCallback(CLSUSEROID, cls_check_cache_invalidate, (Datum) 0);
+        g_cls_check_callback_registered = true;
+    }
+
+    if (g_cls_check_cache)
+    {
+        hash_destroy(g_cls_check_cache);
+    }
+
+    MemSet(&ctl, 0, sizeof(ctl));
+    ctl.keysize   = sizeof(ClsCheckKey);
+    ctl.entrysize = sizeof(ClsCheckEntry);
+    ctl.hcxt      = CacheMemoryContext;
+
+    g_cls_check_cache = hash_create("cls check cache",
+                                    64,
+                                    &ctl,
+                                    HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+    g_cls_check_cache_valid = true;
+}
+
+/*
+ * evaluate the row label against current user, remembering the verdict until catalogs change.
+ */
+static bool cls_check_cached(ClsItem *arg, int cmdtag)
+{
+    ClsCheckKey     key;
+    ClsCheckEntry * entry;
+    bool            found;
+    bool            ret;
+
+    if (!g_cls_check_cache_valid)
+    {
+        cls_check_cache_reset();
+    }
+
+    MemSet(&key, 0, sizeof(key));
+    key.polid   = arg->polid;
+    key.labelid = arg->labelid;
+    key.cmdtag  = cmdtag;
+
+    entry = (ClsCheckEntry *) hash_search(g_cls_check_cache, &key, HASH_FIND, NULL);
+    if (entry)
+    {
+        return entry->result;
+    }
+
+    if (CLS_CMD_READ == cmdtag)
+    {
+        ret = cls_check_read(arg);
+    }
+    else
+    {
+        ret = cls_check_write(arg);
+    }
+
+    /* catalog lookups above may have processed invalidations, do not keep a stale verdict */
+    if (g_cls_check_cache_valid)
+    {
+        entry = (ClsCheckEntry *) hash_search(g_cls_check_cache, &key, HASH_ENTER, &found);
+        entry->result = ret;
+    }
+
+    return ret;
+}
+
 #if MARK("external api")
 /*
  * this is the enterance of cls check process, all cls work strategies work and judge here, 
@@ -778,13 +883,10 @@ Datum pg_cls_check(PG_FUNCTION_ARGS)
     {
         ret = false;
         
-        if (CLS_CMD_READ == g_command_tag_enum)
-        {
-            ret = cls_check_read(arg);
-        }
-        else if (CLS_CMD_WRITE == g_command_tag_enum)
+        if (CLS_CMD_READ == g_command_tag_enum
+            || CLS_CMD_WRITE == g_command_tag_enum)
         {
-            ret = cls_check_write(arg);
+            ret = cls_check_cached(arg, g_command_tag_enum);
         }
 /*        
         else if (CLS_CMD_ROW == g_command_tag_enum)
@@ -792,9 +894,6 @@ Datum pg_cls_check(PG_FUNCTION_ARGS)
             
         }
 */      
-        /* TODO: we just output the datum value, later there would be policies algorithm */
-        elog(LOG, "[neoqguo]pg_cls_check is ready, get value:%d:%d", arg->polid, arg->labelid);
-        
         PG_RETURN_BOOL(ret);
     }
 
@@ -927,6 +1026,9 @@ void mls_assign_user_clsitem(void)
         MemoryContextResetAndDeleteChildren(g_user_cls_priv.mctx);
     }
 
+    /* verdicts were made for the former authority */
+    g_cls_check_cache_valid = false;
+
     /* STEP 1. get the label values of current user */
     ScanKeyInit(&skey[0],
                     Anum_pg_cls_user_userid,
@@ -762,12 +762,34 @@ static void fill_att_mask_info(Oid relid, Form_pg_attribute attr, DataMaskAttSca
     heap_close(rel, AccessShareLock);
 }
 
+/*
+ * return the masked value of one column, taking the one computed in init_datamask_desc
+ * when the mask does not depend on the input.
+ */
+static inline Datum datamask_masked_col_value(Form_pg_attribute attr, Datum inputval, bool isnull,
+                                              DataMaskAttScan *mask, bool *datumvalid)
+{
+    if (mask->constvalid)
+    {
+        *datumvalid = true;
+        return mask->constval;
+    }
+
+    return datamask_exchange_one_col_value(attr, inputval, isnull, mask, datumvalid);
+}
+
+/*
+ * build the masking descriptor of one relation for current user. all catalog lookups happen here,
+ * once per scan, together with the masked values that do not depend on the input, so the per tuple
+ * work is left to the columns really masked.
+ */
 DataMaskState *init_datamask_desc(Oid relid, Form_pg_attribute *attrs, Datamask *datamask)
 {
     DataMaskAttScan *att_info;
     DataMaskState *desc;
     int attno;
     int natts;
+    bool datumvalid;
 
     natts = datamask->attmasknum;
 
@@ -779,6 +801,9 @@ DataMaskState *init_datamask_desc(Oid relid, Form_pg_attribute *attrs, Datamask
     if (desc->maskinfo == NULL)
         elog(ERROR, "out of memory");
 
+    desc->nmasked       = 0;
+    desc->masked_attnos = palloc(sizeof(int) * natts);
+
     for (attno = 0; attno < natts; attno++)
     {
         att_info = &desc->maskinfo[attno];
@@ -797,6 +822,19 @@ DataMaskState *init_datamask_desc(Oid relid, Form_pg_attribute *attrs, Datamask
 
         att_info->enable = true;
         fill_att_mask_info(relid, attrs[attno], att_info);
+
+        if (!att_info->enable)
+            continue;
+
+        /* value masking and default values replace the input whatever it is */
+        if (DATAMASK_KIND_VALUE == att_info->option || DATAMASK_KIND_DEFAULT_VAL == att_info->option)
+        {
+            att_info->constval   = datamask_exchange_one_col_value(attrs[attno], (Datum) 0, true,
+                                                                   att_info, &datumvalid);
+            att_info->constvalid = datumvalid;
+        }
+
+        desc->masked_attnos[desc->nmasked++] = attno;
     }
 
     return desc;
@@ -821,11 +859,14 @@ void datamask_exchange_all_cols_value(Node *node, TupleTableSlot *slot)
     MemoryContext      old_memctx;
     Form_pg_attribute *att;
     ScanState       *scanstate;
+    DataMaskState   *maskDesc;
     DataMaskAttScan *maskState;
+    int         i;
 
     scanstate   = (ScanState *)node;
     tupleDesc   = slot->tts_tupleDescriptor;
-    maskState   = scanstate->ss_currentMaskDesc->maskinfo;
+    maskDesc    = scanstate->ss_currentMaskDesc;
+    maskState   = maskDesc->maskinfo;
     datamask    = tupleDesc->tdatamask;
     natts       = tupleDesc->natts;
 
@@ -835,6 +876,10 @@ void datamask_exchange_all_cols_value(Node *node, TupleTableSlot *slot)
 
     need_exchange_slot_tts_tuple = false;
 
+    /* current user sees every column in clear, nothing to rebuild */
+    if (maskDesc->nmasked == 0)
+        return;
+
     if (datamask)
     {
         if (slot->tts_tuple)
@@ -853,43 +898,46 @@ void datamask_exchange_all_cols_value(Node *node, TupleTableSlot *slot)
 
         }
 
-        for (attnum = 0; attnum < natts; attnum++)
+        /* only the columns masked for current user, see init_datamask_desc */
+        for (i = 0; i < maskDesc->nmasked; i++)
         {
-            if (datamask_attr_mask_is_valid(datamask, attnum))
-            {
-                Form_pg_attribute thisatt = att[attnum];
+            Form_pg_attribute thisatt;
 
-                datumvalid = false;
-                if (need_exchange_slot_tts_tuple)
-                {
-                    slot_values[attnum]  = datamask_exchange_one_col_value(
-                            thisatt,
-                            tuple_values[attnum],
-                            tuple_isnull[attnum],
-                            &maskState[attnum],
-                            &datumvalid);
-                }
-                else
-                {
-                    /* tuple_values are null, so try slot_values */
-                    slot_values[attnum]  = datamask_exchange_one_col_value(
-                            thisatt,
-                            slot_values[attnum],
-                            slot_isnull[attnum],
-                            &maskState[attnum],
-                            &datumvalid);
-                }
-                slot_isnull[attnum]  = false;
+            attnum  = maskDesc->masked_attnos[i];
+            if (attnum >= natts)
+                break;
+            thisatt = att[attnum];
 
-                /* 
-                 * if datum is invalid, slot_values is invalid either, keep orginal value in tuple_value
-                 * it seems a little bored
-                 */
-                if (need_exchange_slot_tts_tuple && datumvalid)
-                {
-                    tuple_values[attnum] = slot_values[attnum];
-                    tuple_isnull[attnum] = slot_isnull[attnum];
-                }
+            datumvalid = false;
+            if (need_exchange_slot_tts_tuple)
+            {
+                slot_values[attnum]  = datamask_masked_col_value(
+                        thisatt,
+                        tuple_values[attnum],
+                        tuple_isnull[attnum],
+                        &maskState[attnum],
+                        &datumvalid);
+            }
+            else
+            {
+                /* tuple_values are null, so try slot_values */
+                slot_values[attnum]  = datamask_masked_col_value(
+                        thisatt,
+                        slot_values[attnum],
+                        slot_isnull[attnum],
+                        &maskState[attnum],
+                        &datumvalid);
+            }
+            slot_isnull[attnum]  = false;
+
+            /* 
+             * if datum is invalid, slot_values is invalid either, keep orginal value in tuple_value
+             * it seems a little bored
+             */
+            if (need_exchange_slot_tts_tuple && datumvalid)
+            {
+                tuple_values[attnum] = slot_values[attnum];
+                tuple_isnull[attnum] = slot_isnull[attnum];
             }
         }
 
@@ -1200,7 +1248,7 @@ void dmask_exchg_all_cols_value_copy(TupleDesc tupleDesc, Datum   *tuple_values,
 
             datumvalid = false;
 
-            datum_ret = datamask_exchange_one_col_value(
+            datum_ret = datamask_masked_col_value(
                     thisatt,
                     tuple_values[attnum],
                     tuple_isnull[attnum],
@@ -35,9 +35,11 @@
 #endif
 #include "access/rmgr.h"
 #include "access/transam.h"
+#include "access/tuptoaster.h"
 #include "access/twophase.h"
 #include "access/xact.h"
 #include "access/xlog_internal.h"
+#include "access/xlogprefetch.h"
 #include "access/heapam_xlog.h"
 #include "access/lru.h"
 #include "catalog/namespace.h"
@@ -79,12 +81,15 @@
 #include "commands/sequence.h"
 #include "parser/parse_utilcmd.h"
 #include "pgxc/nodemgr.h"
+#include "pgxc/globaldeadlock.h"
+#include "pgxc/pause.h"
 #include "pgxc/squeue.h"
 #include "utils/snapmgr.h"
 #endif
 #include "postmaster/autovacuum.h"
 #include "postmaster/bgworker_internals.h"
 #include "postmaster/bgwriter.h"
+#include "postmaster/ckptwriter.h"
 #include "postmaster/postmaster.h"
 #include "postmaster/syslogger.h"
 #include "postmaster/walwriter.h"
@@ -97,6 +102,7 @@
 #include "storage/dsm_impl.h"
 #include "storage/standby.h"
 #include "storage/fd.h"
+#include "storage/numa.h"
 #include "storage/pg_shmem.h"
 #include "storage/proc.h"
 #include "storage/predicate.h"
@@ -113,6 +119,7 @@
 #include "utils/rls.h"
 #include "utils/snapmgr.h"
 #include "utils/tzparser.h"
+#include "utils/tuplestore.h"
 #include "utils/varlena.h"
 #include "utils/xml.h"
 #include "utils/syscache.h"
@@ -121,9 +128,11 @@
 #include "postmaster/pgarch.h"
 #include "optimizer/planner.h"
 #include "optimizer/pathnode.h"
+#include "optimizer/pgxcship.h"
 #include "tcop/pquery.h"
 #include "optimizer/plancat.h"
 #include "parser/analyze.h"
+#include "utils/int8.h"
 #endif
 
 #ifdef __AUDIT__
@@ -139,6 +148,7 @@
 #include "replication/logical_statistic.h"
 #endif
 #ifdef _MLS_
+#include "storage/decrypt_cache.h"
 #include "utils/relcrypt.h"
 #include "utils/datamask.h"
 #endif
@@ -147,6 +157,11 @@
 #include "executor/nodeAgg.h"
 #include "catalog/pg_partition_interval.h"
 #endif
+#ifdef _SHARDING_
+#include "commands/copy.h"
+#include "executor/nodeSeqscan.h"
+#include "storage/extent_zonemap.h"
+#endif
 
 #ifdef _PUB_SUB_RELIABLE_
 #include "access/xlog.h"
@@ -179,6 +194,9 @@ extern char *default_tablespace;
 extern char *temp_tablespaces;
 extern bool ignore_checksum_failure;
 extern bool synchronize_seqscans;
+#ifdef __TBASE__
+extern int seqscan_prefetch_pages;
+#endif
 extern bool enable_cold_hot_router_print;
 #ifdef _PUB_SUB_RELIABLE_
 static char * g_wal_stream_type_str;
@@ -192,6 +210,7 @@ extern bool optimize_bounded_sort;
 #endif
 
 #ifdef __TBASE__
+extern bool    enable_radix_sort;
 extern bool    PoolConnectDebugPrint;
 extern bool       GTMDebugPrint;
 extern bool    g_GTM_skip_catalog;
@@ -290,6 +309,8 @@ static void strreplace_all(char *str, char *needle, char *replacement);
 #ifdef __TBASE__
 static bool set_warm_shared_buffer(bool *newval, void **extra, GucSource source);
 static const char *show_total_memorysize(void);
+static bool check_snapshot_global_timestamp(char **newval, void **extra, GucSource source);
+static void assign_snapshot_global_timestamp(const char *newval, void *extra);
 #endif
 #ifdef __COLD_HOT__
 static void assign_cold_hot_partition_type(const char *newval, void *extra);
@@ -564,6 +585,14 @@ static const struct config_enum_entry shard_visible_modes[] = {
  };
 #endif
 
+#ifdef __AUDIT__
+static const struct config_enum_entry alog_queue_full_action_options[] = {
+    {"wait", ALOG_QUEUE_FULL_WAIT, false},
+    {"drop", ALOG_QUEUE_FULL_DROP, false},
+    {NULL, 0, false}
+};
+#endif
+
 #ifdef __TBASE__
 /*
  * Although only "break", "continue" are documented, we
@@ -583,6 +612,8 @@ static const struct config_enum_entry archive_status_control_options[] = {
  */
 extern const struct config_enum_entry wal_level_options[];
 extern const struct config_enum_entry archive_mode_options[];
+extern const struct config_enum_entry wal_compression_options[];
+extern const struct config_enum_entry default_toast_compression_options[];
 extern const struct config_enum_entry sync_method_options[];
 extern const struct config_enum_entry dynamic_shared_memory_options[];
 
@@ -726,6 +757,7 @@ static bool assert_enabled;
 
 #ifdef __TBASE__
 bool g_enable_copy_silence = false;
+bool g_enable_copy_fast_route = false;
 bool g_enable_user_authority_force_check = false;
 #endif
 
@@ -1077,6 +1109,17 @@ static struct config_bool ConfigureNamesBool[] =
 		true,
 		NULL, NULL, NULL
 	},
+#ifdef __TBASE__
+	{
+		{"enable_radix_sort", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables radix sorting of in-memory sorts on integer keys."),
+			NULL
+		},
+		&enable_radix_sort,
+		true,
+		NULL, NULL, NULL
+	},
+#endif
 	{
 		{"enable_hashagg", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Enables the planner's use of hashed aggregation plans."),
@@ -1341,16 +1384,17 @@ static struct config_bool ConfigureNamesBool[] =
         false,
         NULL, NULL, NULL
     },
-
+#ifdef __TBASE__
     {
-        {"wal_compression", PGC_SUSET, WAL_SETTINGS,
-            gettext_noop("Compresses full-page writes written in WAL file."),
-            NULL
+        {"async_distributed_commit", PGC_USERSET, WAL_SETTINGS,
+            gettext_noop("Acknowledges a distributed commit before the remote nodes confirm COMMIT PREPARED."),
+            gettext_noop("The confirmations are collected right after the client is answered.")
         },
-        &wal_compression,
+        &async_distributed_commit,
         false,
         NULL, NULL, NULL
     },
+#endif
 
     {
         {"log_checkpoints", PGC_SIGHUP, LOGGING_WHAT,
@@ -1748,6 +1792,16 @@ static struct config_bool ConfigureNamesBool[] =
         true,
         NULL, NULL, NULL
     },
+    {
+        {"gin_pending_list_background_cleanup", PGC_USERSET, CLIENT_CONN_STATEMENT,
+            gettext_noop("Leaves the cleanup of too long GIN pending lists to autovacuum."),
+            gettext_noop("When off, the insert that finds the pending list too long "
+                         "moves its entries to the main index structure itself.")
+        },
+        &gin_pending_list_background_cleanup,
+        false,
+        NULL, NULL, NULL
+    },
     {
         {"array_nulls", PGC_USERSET, COMPAT_OPTIONS_PREVIOUS,
             gettext_noop("Enable input of NULL elements in arrays."),
@@ -2066,6 +2120,47 @@ static struct config_bool ConfigureNamesBool[] =
 		NULL, NULL, NULL
 	},
 
+    {
+        {"squeue_batch_read", PGC_USERSET, CUSTOM_OPTIONS,
+            gettext_noop("Let shared queue consumers drain their queue in batches."),
+            NULL
+        },
+        &g_SQueueBatchRead,
+        true,
+        NULL, NULL, NULL
+    },
+
+    {
+        {"datarow_spill_compress", PGC_USERSET, RESOURCES_DISK,
+            gettext_noop("Compresses data rows that shared queues and remote subplans spill to temporary files."),
+            NULL
+        },
+        &datarow_spill_compress,
+        false,
+        NULL, NULL, NULL
+    },
+
+    {
+        {"data_pump_zerocopy", PGC_SIGHUP, CUSTOM_OPTIONS,
+            gettext_noop("Send large data pump chunks with MSG_ZEROCOPY where the socket supports it."),
+            NULL
+        },
+        &g_DataPumpZeroCopy,
+        false,
+        NULL, NULL, NULL
+    },
+
+    {
+        {"data_pump_compress", PGC_USERSET, CUSTOM_OPTIONS,
+            gettext_noop("Compress tuple chunks redistributed by the data pump with pglz."),
+            gettext_noop("Chunks that do not compress are sent as is, and compression "
+                         "is paused for a while when that keeps happening.")
+        },
+        &g_DataPumpCompress,
+        false,
+        NULL, NULL, NULL
+    },
+
     {
         {"debug_data_pump", PGC_SIGHUP, CUSTOM_OPTIONS,
             gettext_noop("enable debug to trace data pump."),
@@ -2076,6 +2171,38 @@ static struct config_bool ConfigureNamesBool[] =
         NULL, NULL, NULL
     },
 
+#ifdef _SHARDING_
+    {
+        {"enable_parallel_shard_scan", PGC_USERSET, CUSTOM_OPTIONS,
+            gettext_noop("Parallel seq scan reads only the extents of the shards selected by the quals."),
+            NULL
+        },
+        &enable_parallel_shard_scan,
+        true,
+        NULL, NULL, NULL
+    },
+#endif
+
+    {
+        {"enable_runtime_join_filter", PGC_USERSET, CUSTOM_OPTIONS,
+            gettext_noop("Ship bloom filters of hash join inner keys to the producers of the outer remote subplan."),
+            NULL
+        },
+        &enable_runtime_join_filter,
+        false,
+        NULL, NULL, NULL
+    },
+
+    {
+        {"enable_remote_rescan_cache", PGC_USERSET, CUSTOM_OPTIONS,
+            gettext_noop("Replay the rows of a remote subplan rescanned with unchanged parameters."),
+            NULL
+        },
+        &enable_remote_rescan_cache,
+        true,
+        NULL, NULL, NULL
+    },
+
     {
         {"enable_pullup_subquery", PGC_USERSET, CUSTOM_OPTIONS,
             gettext_noop("pullup subquery to make execution more efficient."),
@@ -2101,6 +2228,17 @@ static struct config_bool ConfigureNamesBool[] =
         NULL, NULL, NULL
     },
 
+    {
+        {
+            "interval_incremental_analyze", PGC_USERSET, CUSTOM_OPTIONS,
+            gettext_noop("Skips interval partitions not modified since their last analyze when analyzing the parent."),
+            NULL
+        },
+        &interval_incremental_analyze,
+        true,
+        NULL, NULL, NULL
+    },
+
 	{
 		{
 			"enable_pgbouncer", PGC_SIGHUP, STATS_COLLECTOR,
@@ -2123,6 +2261,26 @@ static struct config_bool ConfigureNamesBool[] =
         NULL, NULL, NULL
     },
 
+    {
+        {"enable_gts_broker", PGC_SIGHUP, CUSTOM_OPTIONS,
+            gettext_noop("Share global timestamp requests of concurrent backends in one GTM round trip."),
+            NULL
+        },
+        &enable_gts_broker,
+        false,
+        NULL, NULL, NULL
+    },
+
+    {
+        {"enable_gts_prefetch", PGC_USERSET, CUSTOM_OPTIONS,
+            gettext_noop("Request the snapshot global timestamp from GTM while the statement is parsed and planned."),
+            NULL
+        },
+        &enable_gts_prefetch,
+        false,
+        NULL, NULL, NULL
+    },
+
     {
         {"vacuum_debug_print", PGC_POSTMASTER, CUSTOM_OPTIONS,
             gettext_noop("vacuum debug print."),
@@ -2173,6 +2331,16 @@ static struct config_bool ConfigureNamesBool[] =
         NULL, NULL, NULL
     },    
 
+    {
+        {"enable_distinct_agg_dedup", PGC_USERSET, CUSTOM_OPTIONS,
+            gettext_noop("Remove duplicate rows on datanodes before DISTINCT-only aggregation."),
+            NULL
+        },
+        &enable_distinct_agg_dedup,
+        true,
+        NULL, NULL, NULL
+    },
+
     {
         {"enable_concurrently_index", PGC_USERSET, CUSTOM_OPTIONS,
             gettext_noop("enable create index concurrently."),
@@ -2480,6 +2648,16 @@ static struct config_bool ConfigureNamesBool[] =
         false,
         NULL, NULL, NULL
     },
+
+    {
+        {"enable_async_commit_prepared", PGC_SUSET, CUSTOM_OPTIONS,
+            gettext_noop("Participants commit prepared transactions of a remote start node without waiting for the commit record to be flushed."),
+            NULL
+        },
+        &enable_async_commit_prepared,
+        false,
+        NULL, NULL, NULL
+    },
         
     {
         {"enable_distri_debug", PGC_SUSET, CUSTOM_OPTIONS,
@@ -2533,6 +2711,26 @@ static struct config_bool ConfigureNamesBool[] =
         false,
         NULL, NULL, NULL
     },
+    {
+        {"enable_session_params_reuse", PGC_POSTMASTER, CUSTOM_OPTIONS,
+            gettext_noop("Skip re-sending session parameters to pooled connections that already have them."),
+            gettext_noop("Released connections keep their session state and are reset by "
+                         "their next user, unless the pooler hands them back to this session. "
+                         "All sessions of a node must agree on this, so it is set at server start.")
+        },
+        &enable_session_params_reuse,
+        true,
+        NULL, NULL, NULL
+    },
+    {
+        {"enable_copy_fast_route", PGC_USERSET, CUSTOM_OPTIONS,
+            gettext_noop("Convert only the distribution columns of text COPY FROM rows on the coordinator."),
+            gettext_noop("Other columns are forwarded as is and validated by the datanodes.")
+        },
+        &g_enable_copy_fast_route,
+        false,
+        NULL, NULL, NULL
+    },
     {
         {"enable_user_authority_force_check", PGC_POSTMASTER, CUSTOM_OPTIONS,
             gettext_noop("control users to get the list of tables and functions which can be accessed and executed by these user."),
@@ -2776,6 +2974,15 @@ static struct config_bool ConfigureNamesBool[] =
 #endif
 		NULL, NULL, NULL
 	},
+    {
+        {"numa_shared_memory", PGC_POSTMASTER, RESOURCES_MEM,
+            gettext_noop("Interleaves shared memory across NUMA nodes."),
+            gettext_noop("DataPump sender threads are also kept on the NUMA node of their backend.")
+        },
+        &numa_shared_memory,
+        false,
+        NULL, NULL, NULL
+    },
 
 #endif
 
@@ -3047,6 +3254,21 @@ static struct config_int ConfigureNamesInt[] =
         4096, 64, MAX_KILOBYTES,
         NULL, NULL, NULL
     },
+#ifdef __TBASE__
+    {
+        {"query_work_mem", PGC_USERSET, RESOURCES_MEM,
+            gettext_noop("Sets the memory budget shared by the workspaces of one query fragment."),
+            gettext_noop("Sorts, hash tables and tuplestores of a plan fragment "
+                         "divide this budget evenly and spill to temporary disk "
+                         "files once their share is used up, even if work_mem "
+                         "would allow more. Zero disables the budget."),
+            GUC_UNIT_KB
+        },
+        &query_work_mem,
+        0, 0, MAX_KILOBYTES,
+        NULL, NULL, NULL
+    },
+#endif
 
     {
         {"maintenance_work_mem", PGC_USERSET, RESOURCES_MEM,
@@ -3502,6 +3724,19 @@ static struct config_int ConfigureNamesInt[] =
         NULL, NULL, NULL
     },
 
+#ifdef __TBASE__
+    {
+        {"checkpoint_writers", PGC_POSTMASTER, WAL_CHECKPOINTS,
+            gettext_noop("Sets the number of processes writing out buffers at checkpoint in parallel."),
+            gettext_noop("Checkpoint writers are background workers and count against max_worker_processes. "
+                         "Zero lets the checkpointer write all buffers itself.")
+        },
+        &checkpoint_writers,
+        0, 0, MAX_CHECKPOINT_WRITERS,
+        NULL, NULL, NULL
+    },
+#endif
+
     {
         {"wal_buffers", PGC_POSTMASTER, WAL_SETTINGS,
             gettext_noop("Sets the number of disk-page buffers in shared memory for WAL."),
@@ -3513,6 +3748,19 @@ static struct config_int ConfigureNamesInt[] =
         check_wal_buffers, NULL, NULL
     },
 
+#ifdef __TBASE__
+    {
+        {"wal_insert_locks", PGC_POSTMASTER, WAL_SETTINGS,
+            gettext_noop("Sets the number of locks used for concurrent WAL insertion."),
+            gettext_noop("More locks let more backends copy records into the WAL "
+                         "buffers at the same time, at the cost of a slower flush.")
+        },
+        &wal_insert_locks,
+        8, 1, 128,
+        NULL, NULL, NULL
+    },
+#endif
+
     {
         {"wal_writer_delay", PGC_SIGHUP, WAL_SETTINGS,
             gettext_noop("Time between WAL flushes performed in the WAL writer."),
@@ -3547,6 +3795,17 @@ static struct config_int ConfigureNamesInt[] =
         NULL, NULL, NULL
     },
 
+    {
+        {"recovery_prefetch_distance", PGC_SIGHUP, WAL_SETTINGS,
+            gettext_noop("Amount of WAL ahead of redo whose data blocks are prefetched."),
+            gettext_noop("0 disables prefetching during recovery."),
+            GUC_UNIT_KB
+        },
+        &recovery_prefetch_distance,
+        256, 0, MAX_KILOBYTES,
+        NULL, NULL, NULL
+    },
+
     {
         /* see max_connections */
         {"max_wal_senders", PGC_POSTMASTER, REPLICATION_SENDING,
@@ -3687,6 +3946,20 @@ static struct config_int ConfigureNamesInt[] =
         check_effective_io_concurrency, assign_effective_io_concurrency, NULL
     },
 
+#ifdef __TBASE__
+    {
+        {"seqscan_prefetch_pages",
+            PGC_USERSET,
+            RESOURCES_ASYNCHRONOUS,
+            gettext_noop("Number of blocks a sequential scan requests ahead of the one it reads."),
+            gettext_noop("0 leaves read-ahead to the operating system.")
+        },
+        &seqscan_prefetch_pages,
+        0, 0, MAX_IO_CONCURRENCY,
+        NULL, NULL, NULL
+    },
+#endif
+
     {
         {"backend_flush_after", PGC_USERSET, RESOURCES_ASYNCHRONOUS,
             gettext_noop("Number of pages after which previously performed writes are flushed to disk."),
@@ -3803,7 +4076,27 @@ static struct config_int ConfigureNamesInt[] =
         &query_delay,
         0, 0, 31536000,
         NULL, NULL, NULL
+    },
+    {
+        {"standby_read_wait_timeout", PGC_USERSET, CUSTOM_OPTIONS,
+            gettext_noop("Maximum time a hot standby datanode waits for replay to reach the global timestamp of a query."),
+            gettext_noop("Queries whose snapshot is newer than the replayed global timestamp fail after this "
+                         "time, but never before gts_acquire_gap has passed. Zero disables the check."),
+            GUC_UNIT_MS
+        },
+        &standby_read_wait_timeout,
+        0, 0, INT_MAX,
+        NULL, NULL, NULL
     },
+	{
+		{"commit_ts_buffers", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the number of commit timestamp buffers of each tlog partition."),
+			gettext_noop("0 sizes them automatically from shared_buffers.")
+		},
+		&commit_ts_buffers,
+		0, 0, 1024,
+		NULL, NULL, NULL
+	},
 	{
 		{"max_relcache_relations", PGC_POSTMASTER, RESOURCES,
 			gettext_noop("max relcache relations per session."),
@@ -4293,6 +4586,17 @@ static struct config_int ConfigureNamesInt[] =
         1000, 1, INT_MAX,
         NULL, NULL, NULL
     },
+#ifdef __TBASE__
+    {
+        {"shared_sequence_cache_size", PGC_POSTMASTER, COORDINATORS,
+            gettext_noop("Number of sequences whose GTM ranges are shared by all sessions of a coordinator."),
+            gettext_noop("0 keeps the ranges fetched from GTM private to each session.")
+        },
+        &shared_sequence_cache_size,
+        0, 0, INT_MAX / 2,
+        NULL, NULL, NULL
+    },
+#endif
 
 #ifdef __TBASE__
     {
@@ -4365,6 +4669,17 @@ static struct config_int ConfigureNamesInt[] =
         120, 10, 7200,
         NULL, NULL, NULL
     },
+    {
+        {"pool_demand_window", PGC_SIGHUP, DATA_NODES,
+            gettext_noop("Window used to track the peak connection demand of node pools."),
+            gettext_noop("Pools keep as many connections as the peak of the last 64 windows. "
+                         "In seconds, 0 disables it."),
+            GUC_UNIT_S
+        },
+        &PoolDemandWindow,
+        60, 0, 3600,
+        NULL, NULL, NULL
+    },
     {
         {"pool_session_max_lifetime", PGC_SIGHUP, DATA_NODES,
             gettext_noop("Datanode session max lifetime."),
@@ -4464,6 +4779,16 @@ static struct config_int ConfigureNamesInt[] =
         32, 4, 64,
         NULL, NULL, NULL
     },
+    {
+        {"decrypt_page_cache_size", PGC_POSTMASTER, RESOURCES_MEM,
+            gettext_noop("Sets the number of decrypted pages kept after they leave shared buffers."),
+            gettext_noop("0 disables the cache."),
+            GUC_UNIT_BLOCKS
+        },
+        &decrypt_page_cache_size,
+        0, 0, INT_MAX / 2,
+        NULL, NULL, NULL
+    },
 #endif
     {
         {"pooler_port", PGC_POSTMASTER, DATA_NODES,
@@ -4495,14 +4820,50 @@ static struct config_int ConfigureNamesInt[] =
         {"shared_queue_size", PGC_POSTMASTER, RESOURCES_MEM,
             gettext_noop("Sets the amount of memory allocated for a shared"
                     " memory queue per datanode."),
-            NULL,
+            gettext_noop("Queues get less when shared_queue_memory runs short."),
             GUC_UNIT_KB
         },
         &SQueueSize,
-        32, 1, MAX_KILOBYTES,
+        1024, 4, MAX_KILOBYTES,
         NULL, NULL, NULL
     },
 
+    {
+        {"shared_queue_memory", PGC_POSTMASTER, RESOURCES_MEM,
+            gettext_noop("Sets the amount of memory shared by the queues of"
+                    " all queries."),
+            NULL,
+            GUC_UNIT_KB
+        },
+        &SQueueMemory,
+        1048576, 1024, MAX_KILOBYTES,
+        NULL, NULL, NULL
+    },
+#ifdef _SHARDING_
+    {
+        {"extent_zonemap_entries", PGC_POSTMASTER, RESOURCES_MEM,
+            gettext_noop("Sets the number of extents of shard tables min/max summaries "
+                    "are kept for in shared memory, 0 disables them."),
+            NULL
+        },
+        &extent_zonemap_entries,
+        0, 0, INT_MAX / 2,
+        NULL, NULL, NULL
+    },
+
+    {
+        {"shard_copy_rate_limit", PGC_USERSET, CUSTOM_OPTIONS,
+            gettext_noop("Limits the amount of data COPY ... SHARDING TO reads and sends "
+                    "per second, 0 for no limit."),
+            NULL,
+            GUC_UNIT_KB
+        },
+        &shard_copy_rate_limit,
+        0, 0, MAX_KILOBYTES,
+        NULL, NULL, NULL
+    },
+#endif
+
     {
         {"parentPGXCPid", PGC_USERSET, UNGROUPED,
             gettext_noop("PID of the remote process attached to this session."),
@@ -4518,7 +4879,8 @@ static struct config_int ConfigureNamesInt[] =
     {
         {"pgxl_remote_fetch_size", PGC_USERSET, UNGROUPED,
             gettext_noop("Number of maximum tuples to fetch in one remote iteration"),
-            NULL,
+            gettext_noop("Following iterations of a cursor fetch twice as many, "
+                         "up to what work_mem holds."),
             0
         },
         &PGXLRemoteFetchSize,
@@ -4592,6 +4954,25 @@ static struct config_int ConfigureNamesInt[] =
         32, 0, INT_MAX,
         NULL, NULL, NULL
     },
+    {
+        {"copy_send_buffer_size", PGC_USERSET, CUSTOM_OPTIONS,
+            gettext_noop("Amount of COPY data buffered per datanode connection before it is sent."),
+            NULL,
+            GUC_UNIT_KB
+        },
+        &CopySendBufferSize,
+        64, 8, 65536,
+        NULL, NULL, NULL
+    },
+    {
+        {"fqs_cache_size", PGC_USERSET, CUSTOM_OPTIONS,
+            gettext_noop("Number of fast query shipping decisions cached per session."),
+            gettext_noop("Zero disables the cache.")
+        },
+        &fqs_cache_size,
+        512, 0, 65536,
+        NULL, NULL, NULL
+    },
 
     {
         {"replication_level", PGC_USERSET, CUSTOM_OPTIONS,
@@ -4612,6 +4993,54 @@ static struct config_int ConfigureNamesInt[] =
 		32, 1, INT_MAX,
 		NULL, NULL, NULL
 	},
+	{
+		{"remote_subplan_cache_size", PGC_USERSET, CUSTOM_OPTIONS,
+			gettext_noop("Maximum number of decoded remote subplans cached by a datanode session."),
+			gettext_noop("Zero disables the cache.")
+		},
+		&remote_subplan_cache_size,
+		64, 0, INT_MAX,
+		NULL, NULL, NULL
+	},
+	{
+		{"remote_rescan_cache_entries", PGC_USERSET, CUSTOM_OPTIONS,
+			gettext_noop("Maximum number of scans a parameterized remote subplan keeps for rescans."),
+			gettext_noop("The kept rows are also limited by work_mem.")
+		},
+		&remote_rescan_cache_entries,
+		64, 1, INT_MAX,
+		NULL, NULL, NULL
+	},
+	{
+		{"cluster_pause_drain_timeout", PGC_SUSET, CUSTOM_OPTIONS,
+			gettext_noop("Maximum time PAUSE CLUSTER waits for running transactions to finish."),
+			gettext_noop("New transactions are held back while it waits. Zero waits forever."),
+			GUC_UNIT_MS
+		},
+		&cluster_pause_drain_timeout,
+		0, 0, INT_MAX,
+		NULL, NULL, NULL
+	},
+	{
+		{"global_deadlock_detector_interval", PGC_SIGHUP, CUSTOM_OPTIONS,
+			gettext_noop("Time between global deadlock checks of the coordinator."),
+			gettext_noop("Zero disables the global deadlock detector."),
+			GUC_UNIT_MS
+		},
+		&global_deadlock_detector_interval,
+		0, 0, INT_MAX,
+		NULL, NULL, NULL
+	},
+	{
+		{"shared_table_stats_size", PGC_POSTMASTER, CUSTOM_OPTIONS,
+			gettext_noop("Sets the number of tables whose cumulative statistics are kept in shared memory."),
+			gettext_noop("Statistics of other tables go through the statistics collector. "
+						 "Zero keeps all of them in the collector.")
+		},
+		&shared_table_stats_size,
+		0, 0, INT_MAX / 2,
+		NULL, NULL, NULL
+	},
 #endif
 #ifdef __TWO_PHASE_TESTS__
     {
@@ -4864,6 +5293,17 @@ static struct config_real ConfigureNamesReal[] =
     },
 #endif
 
+#ifdef __TBASE__
+    {
+        {"log_remote_misestimate_ratio", PGC_USERSET, CUSTOM_OPTIONS,
+            gettext_noop("Logs remote subplans whose row count is off from the estimate by at least this factor."),
+            gettext_noop("Zero turns this off.")
+        },
+        &log_remote_misestimate_ratio,
+        0, 0, DBL_MAX, NULL, NULL
+    },
+#endif
+
     {
         {"geqo_selection_bias", PGC_USERSET, QUERY_TUNING_GEQO,
             gettext_noop("GEQO: selective pressure within the population."),
@@ -5644,6 +6084,29 @@ static struct config_string ConfigureNamesString[] =
         "mls_admin",
         NULL, NULL, NULL
     },
+    {
+        {"snapshot_global_timestamp", PGC_SUSET, CUSTOM_OPTIONS,
+            gettext_noop("Global timestamp the snapshots of the session are taken at."),
+            gettext_noop("Set it to the value of pg_export_global_timestamp() in another "
+                         "session, before the first query of a transaction, to see the "
+                         "same data as that session. An empty string takes a new "
+                         "timestamp from GTM for every snapshot."),
+            GUC_NOT_IN_SAMPLE
+        },
+        &snapshot_global_timestamp_string,
+        "",
+        check_snapshot_global_timestamp, assign_snapshot_global_timestamp, NULL
+    },
+    {
+        {"shard_local_relation", PGC_USERSET, CUSTOM_OPTIONS,
+            gettext_noop("Relation whose distribution routes calls of a shard-local function."),
+            gettext_noop("Only meaningful in the SET clause of a function: a call is then "
+                         "executed on the datanode owning the value of its first argument.")
+        },
+        &shard_local_relation,
+        "",
+        NULL, NULL, NULL
+    },
 #endif
 #ifdef _PG_ORCL_
     {
@@ -5981,6 +6444,16 @@ static struct config_enum ConfigureNamesEnum[] =
         NULL, assign_xlog_sync_method, NULL
     },
 
+    {
+        {"wal_compression", PGC_SUSET, WAL_SETTINGS,
+            gettext_noop("Compresses full-page writes written in WAL file with the specified method."),
+            NULL
+        },
+        &wal_compression,
+        WAL_COMPRESSION_NONE, wal_compression_options,
+        NULL, NULL, NULL
+    },
+
     {
         {"xmlbinary", PGC_USERSET, CLIENT_CONN_STATEMENT,
             gettext_noop("Sets how binary values are to be encoded in XML."),
@@ -6078,6 +6551,26 @@ static struct config_enum ConfigureNamesEnum[] =
         ARCHSTATUS_CONTINUE, archive_status_control_options,
         NULL, NULL, NULL
     },
+    {
+        {"default_toast_compression", PGC_USERSET, CUSTOM_OPTIONS,
+            gettext_noop("Sets the compression method of toasted values."),
+            gettext_noop("Columns can choose their own with the \"compression\" attribute option.")
+        },
+        &default_toast_compression,
+        TOAST_PGLZ_COMPRESSION_ID, default_toast_compression_options,
+        NULL, NULL, NULL
+    },
+#endif
+#ifdef __AUDIT__
+    {
+        {"alog_queue_full_action", PGC_SIGHUP, LOGGING_WHERE,
+            gettext_noop("Action of a backend whose audit log queue is full."),
+            gettext_noop("wait for the audit logger, or drop the record and report the number of dropped records in the audit log.")
+        },
+        &AuditLog_queue_full_action,
+        ALOG_QUEUE_FULL_WAIT, alog_queue_full_action_options,
+        NULL, NULL, NULL
+    },
 #endif
     /* End-of-list marker */
     {
@@ -13486,6 +13979,31 @@ show_total_memorysize(void)
 	snprintf(buf, sizeof(buf), "%dM", size);
     return buf;
 }
+
+static bool
+check_snapshot_global_timestamp(char **newval, void **extra, GucSource source)
+{
+    int64        value = InvalidGlobalTimestamp;
+    int64       *myextra;
+
+    if (**newval != '\0' &&
+        (!scanint8(*newval, true, &value) || value <= 0))
+    {
+        GUC_check_errdetail("A global timestamp is a positive integer.");
+        return false;
+    }
+
+    myextra = (int64 *) guc_malloc(ERROR, sizeof(int64));
+    *myextra = value;
+    *extra = (void *) myextra;
+    return true;
+}
+
+static void
+assign_snapshot_global_timestamp(const char *newval, void *extra)
+{
+    ImportedGlobalTimestamp = *((int64 *) extra);
+}
 #endif
 #ifdef __COLD_HOT__
 static void
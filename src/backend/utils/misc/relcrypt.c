@@ -95,7 +95,10 @@
 #include "contrib/pgcrypto/pgp.h"
 #include "contrib/sm/sm4.h"
 
+#include "access/sysattr.h"
 #include "miscadmin.h"
+#include "nodes/plannodes.h"
+#include "optimizer/var.h"
 
 
 #include "utils/syscache.h"
@@ -1769,8 +1772,88 @@ void trsprt_crypt_free_strut_in_tupdesc(TupleDesc tupledesc, int natts)
 
 
 
+/*
+ * collect the columns of the scanned relation which the scan node itself
+ * references, in its target list or its quals; nothing above the scan can see
+ * any other column. Only done for plain relation scans, every other node is
+ * treated as referencing all columns.
+ */
+static void trsprt_crypt_collect_scan_attrs(ScanState *node)
+{
+    Plan       *plan    = node->ps.plan;
+    Index       scanrelid;
+    Bitmapset  *varattnos = NULL;
+    int         attno;
+    MemoryContext old_memctx;
+
+    node->ss_crypt_attrs_ready = true;
+    node->ss_crypt_attrs_all   = true;
+    node->ss_crypt_attrs       = NULL;
+
+    if (plan == NULL)
+    {
+        return;
+    }
+
+    switch (nodeTag(plan))
+    {
+        case T_SeqScan:
+        case T_SampleScan:
+        case T_IndexScan:
+        case T_BitmapHeapScan:
+        case T_TidScan:
+            break;
+        default:
+            return;
+    }
+
+#ifdef __AUDIT_FGA__
+    /* audit policies evaluate their own quals over the scan tuple */
+    if (node->ps.audit_fga_qual != NIL)
+    {
+        return;
+    }
+#endif
+
+    scanrelid = ((Scan *) plan)->scanrelid;
+    if (scanrelid == 0)
+    {
+        return;
+    }
+
+    pull_varattnos((Node *) plan->targetlist, scanrelid, &varattnos);
+    pull_varattnos((Node *) plan->qual, scanrelid, &varattnos);
+
+    /* whole-row reference */
+    if (bms_is_member(0 - FirstLowInvalidHeapAttributeNumber, varattnos))
+    {
+        return;
+    }
+
+    old_memctx = MemoryContextSwitchTo(node->ps.state->es_query_cxt);
+    while ((attno = bms_first_member(varattnos)) >= 0)
+    {
+        attno += FirstLowInvalidHeapAttributeNumber;
+        if (attno > 0)
+        {
+            node->ss_crypt_attrs = bms_add_member(node->ss_crypt_attrs, attno - 1);
+        }
+    }
+    MemoryContextSwitchTo(old_memctx);
+
+    node->ss_crypt_attrs_all = false;
+}
+
+#define TRSPRT_CRYPT_SCAN_NEEDS_ATTR(node, attnum) \
+    ((node)->ss_crypt_attrs_all || bms_is_member((attnum), (node)->ss_crypt_attrs))
+
 /* 
  * after tuple deform to slot, exchange the col values with decrypt result.
+ *
+ * only the columns the scan node references are decrypted. the others are
+ * set to null in the rebuilt tuple, and when none of the referenced columns
+ * is encrypted or placed after an encrypted one, the tuple is left alone:
+ * its referenced columns can then be fetched with the plain attrs.
  */
 void trsprt_crypt_dcrpt_all_col_vale(ScanState *node, TupleTableSlot *slot, Oid relid)
 {// #lizard forgives
@@ -1789,6 +1872,33 @@ void trsprt_crypt_dcrpt_all_col_vale(ScanState *node, TupleTableSlot *slot, Oid
 
     if (transp_crypt)
     {
+        bool    crypt_seen    = false;
+        bool    need_decrypt  = false;
+
+        if (!node->ss_crypt_attrs_ready)
+        {
+            trsprt_crypt_collect_scan_attrs(node);
+        }
+
+        for (attnum = 0; attnum < numberOfAttributes; attnum++)
+        {
+            if (TRANSP_CRYPT_INVALID_ALGORITHM_ID != transp_crypt[attnum].algo_id)
+            {
+                crypt_seen = true;
+            }
+
+            if (crypt_seen && TRSPRT_CRYPT_SCAN_NEEDS_ATTR(node, attnum))
+            {
+                need_decrypt = true;
+                break;
+            }
+        }
+
+        if (!need_decrypt)
+        {
+            return;
+        }
+
         old_memctx = MemoryContextSwitchTo(slot->tts_mls_mcxt);
         
         if (slot->tts_tuple)
@@ -1820,6 +1930,16 @@ void trsprt_crypt_dcrpt_all_col_vale(ScanState *node, TupleTableSlot *slot, Oid
             
             if (TRANSP_CRYPT_INVALID_ALGORITHM_ID != transp_crypt[attnum].algo_id)
             {
+                if (!TRSPRT_CRYPT_SCAN_NEEDS_ATTR(node, attnum))
+                {
+                    /* nobody looks at it, do not pay for decrypting it */
+                    if (need_exchange_slot_tts_tuple)
+                    {
+                        tuple_isnull[attnum] = true;
+                    }
+                    continue;
+                }
+
                 if (need_exchange_slot_tts_tuple)
                 {
                     slot_values[attnum]  = trsprt_crypt_decrypt_one_col_value(&transp_crypt[attnum],
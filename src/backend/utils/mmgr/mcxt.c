@@ -535,6 +535,24 @@ MemoryContextStatsDetail(MemoryContext context, int max_children)
             grand_totals.totalspace - grand_totals.freespace);
 }
 
+#ifdef __TBASE__
+/*
+ * MemoryContextTotalSpace
+ *        Return the space in bytes held by the context and its descendants.
+ */
+Size
+MemoryContextTotalSpace(MemoryContext context)
+{
+    MemoryContextCounters totals;
+
+    memset(&totals, 0, sizeof(totals));
+
+    MemoryContextStatsInternal(context, 0, false, 0, &totals);
+
+    return totals.totalspace;
+}
+#endif
+
 /*
  * MemoryContextStatsInternal
  *        One recursion level for MemoryContextStats
@@ -166,6 +166,9 @@ bool        trace_sort = false;
 #ifdef DEBUG_BOUNDED_SORT
 bool        optimize_bounded_sort = true;
 #endif
+#ifdef __TBASE__
+bool        enable_radix_sort = true;
+#endif
 
 
 /*
@@ -295,6 +298,7 @@ struct Tuplesortstate
     LogicalTapeSet *tapeset;    /* logtape.c object for tapes in a temp file */
 #ifdef PGXC
     ResponseCombiner *combiner; /* tuple source, alternate to tapeset */
+    int           *losers;            /* loser tree over the combiner streams */
 #endif /* PGXC */
 
     /*
@@ -637,6 +641,8 @@ static void readtup_heap(Tuplesortstate *state, SortTuple *stup,
 #ifdef PGXC
 static unsigned int getlen_datanode(Tuplesortstate *state, int tapenum,
                 bool eofOK);
+static void beginmerge_streams(Tuplesortstate *state);
+static void merge_stream_adjust(Tuplesortstate *state, int stream);
 static void readtup_datanode(Tuplesortstate *state, SortTuple *stup,
                  int tapenum, unsigned int len);
 #endif
@@ -674,6 +680,11 @@ static void free_sort_tuple(Tuplesortstate *state, SortTuple *stup);
  */
 #include "qsort_tuple.c"
 
+#ifdef __TBASE__
+static bool tuplesort_radix_sortable(Tuplesortstate *state, int *keybytes);
+static void radix_sort_tuple(SortTuple *begin, size_t n, int level,
+                 int keybytes, Tuplesortstate *state);
+#endif
 
 /*
  *        tuplesort_begin_xxx
@@ -1240,7 +1251,10 @@ tuplesort_begin_merge(TupleDesc tupDesc,
 
     init_slab_allocator(state, 0);
 
-    beginmerge(state);
+    if (combiner->conn_count > 1 && combiner->conn_count <= state->memtupsize)
+        beginmerge_streams(state);
+    else
+        beginmerge(state);
     state->status = TSS_FINALMERGE;
 
     MemoryContextSwitchTo(oldcontext);
@@ -2184,6 +2198,25 @@ tuplesort_gettuple_common(Tuplesortstate *state, bool forward,
                 state->lastReturnedTuple = NULL;
             }
 
+#ifdef PGXC
+            if (state->losers)
+            {
+                int            srcTape = state->losers[0];
+
+                if (!state->mergeactive[srcTape])
+                    return false;
+
+                *stup = state->memtuples[srcTape];
+                state->lastReturnedTuple = stup->tuple;
+
+                /* Refill the winner's leaf and replay its matches */
+                if (mergereadnext(state, srcTape, &state->memtuples[srcTape]))
+                    state->memtuples[srcTape].tupindex = srcTape;
+                merge_stream_adjust(state, srcTape);
+                return true;
+            }
+#endif
+
             /*
              * This code should match the inner loop of mergeonerun().
              */
@@ -3584,6 +3617,55 @@ tuplesort_sort_memtuples(Tuplesortstate *state)
 {
     if (state->memtupcount > 1)
     {
+#ifdef __TBASE__
+        int         keybytes;
+
+        if (tuplesort_radix_sortable(state, &keybytes))
+        {
+            SortTuple  *begin = state->memtuples;
+            size_t      n = state->memtupcount;
+            size_t      nnulls = 0;
+            size_t      i;
+
+            /* move the NULLs of the leading key to the end they sort to */
+            if (state->sortKeys->ssup_nulls_first)
+            {
+                for (i = 0; i < n; i++)
+                {
+                    if (begin[i].isnull1)
+                    {
+                        SortTuple   tmp = begin[i];
+
+                        begin[i] = begin[nnulls];
+                        begin[nnulls++] = tmp;
+                    }
+                }
+                if (nnulls > 1 && state->onlyKey == NULL)
+                    qsort_tuple(begin, nnulls, state->comparetup, state);
+                radix_sort_tuple(begin + nnulls, n - nnulls, 0,
+                                 keybytes, state);
+            }
+            else
+            {
+                for (i = n; i > 0; i--)
+                {
+                    if (begin[i - 1].isnull1)
+                    {
+                        SortTuple   tmp = begin[i - 1];
+
+                        nnulls++;
+                        begin[i - 1] = begin[n - nnulls];
+                        begin[n - nnulls] = tmp;
+                    }
+                }
+                if (nnulls > 1 && state->onlyKey == NULL)
+                    qsort_tuple(begin + n - nnulls, nnulls,
+                                state->comparetup, state);
+                radix_sort_tuple(begin, n - nnulls, 0, keybytes, state);
+            }
+            return;
+        }
+#endif
         /* Can we use the single-key sort function? */
         if (state->onlyKey != NULL)
             qsort_ssup(state->memtuples, state->memtupcount,
@@ -3596,6 +3678,180 @@ tuplesort_sort_memtuples(Tuplesortstate *state)
     }
 }
 
+#ifdef __TBASE__
+/*
+ * Sort comparators for integer keys.  Opclasses whose keys order like plain
+ * signed integers use these, which lets tuplesort recognize them and sort
+ * the leading key with a radix sort on datum1 instead of comparing.
+ */
+int
+ssup_datum_int32_cmp(Datum x, Datum y, SortSupport ssup)
+{
+    int32       xx = DatumGetInt32(x);
+    int32       yy = DatumGetInt32(y);
+
+    if (xx < yy)
+        return -1;
+    else if (xx > yy)
+        return 1;
+    else
+        return 0;
+}
+
+#ifdef USE_FLOAT8_BYVAL
+int
+ssup_datum_signed_cmp(Datum x, Datum y, SortSupport ssup)
+{
+    int64       xx = DatumGetInt64(x);
+    int64       yy = DatumGetInt64(y);
+
+    if (xx < yy)
+        return -1;
+    else if (xx > yy)
+        return 1;
+    else
+        return 0;
+}
+#endif
+
+/* below this many tuples a bucket is finished with qsort */
+#define RADIX_SORT_QSORT_THRESHOLD  64
+/* below this many tuples radix sort is not worth its counting passes */
+#define RADIX_SORT_MIN_TUPLES       1024
+
+/*
+ * Can memtuples be radix sorted on datum1?  That requires the leading key
+ * to be held unabbreviated in datum1 and to use one of the integer
+ * comparators above.  *keybytes is set to the width of the key.
+ */
+static bool
+tuplesort_radix_sortable(Tuplesortstate *state, int *keybytes)
+{
+    SortSupport sortKey = state->sortKeys;
+
+    if (!enable_radix_sort || sortKey == NULL ||
+        state->memtupcount < RADIX_SORT_MIN_TUPLES ||
+        sortKey->abbrev_converter != NULL)
+        return false;
+
+    /* CLUSTER leaves datum1 unset when the leading key is an expression */
+    if (state->comparetup == comparetup_cluster &&
+        state->indexInfo->ii_KeyAttrNumbers[0] == 0)
+        return false;
+
+    if (sortKey->comparator == ssup_datum_int32_cmp)
+    {
+        *keybytes = sizeof(int32);
+        return true;
+    }
+#ifdef USE_FLOAT8_BYVAL
+    if (sortKey->comparator == ssup_datum_signed_cmp)
+    {
+        *keybytes = sizeof(int64);
+        return true;
+    }
+#endif
+    return false;
+}
+
+/*
+ * Map datum1 of a non-NULL tuple to an unsigned key that orders the same
+ * way as the sort, so its bytes can be used as radix digits.
+ */
+static inline uint64
+radix_sort_key(const SortTuple *tup, int keybytes, bool reverse)
+{
+    uint64      key;
+
+    if (keybytes == sizeof(int32))
+    {
+        key = (uint32) DatumGetInt32(tup->datum1) ^ UINT64CONST(0x80000000);
+        if (reverse)
+            key ^= UINT64CONST(0xFFFFFFFF);
+    }
+    else
+    {
+        key = (uint64) DatumGetInt64(tup->datum1) ^ (UINT64CONST(1) << 63);
+        if (reverse)
+            key = ~key;
+    }
+
+    return key;
+}
+
+/*
+ * In-place MSD radix sort of non-NULL tuples on the leading key, one byte
+ * per level.  Small buckets are handed to qsort_tuple(), and so are the
+ * buckets of equal leading keys when more keys remain to break the ties.
+ */
+static void
+radix_sort_tuple(SortTuple *begin, size_t n, int level, int keybytes,
+                 Tuplesortstate *state)
+{
+    bool        reverse = state->sortKeys->ssup_reverse;
+    int         shift = (keybytes - 1 - level) * BITS_PER_BYTE;
+    size_t      counts[256];
+    size_t      next[256];
+    size_t      ends[256];
+    size_t      i;
+    int         b;
+
+    if (n < RADIX_SORT_QSORT_THRESHOLD)
+    {
+        if (n > 1)
+            qsort_tuple(begin, n, state->comparetup, state);
+        return;
+    }
+
+    CHECK_FOR_INTERRUPTS();
+
+    memset(counts, 0, sizeof(counts));
+    for (i = 0; i < n; i++)
+        counts[(radix_sort_key(&begin[i], keybytes, reverse) >> shift) & 0xFF]++;
+
+    next[0] = 0;
+    for (b = 0; b < 256; b++)
+    {
+        if (b > 0)
+            next[b] = ends[b - 1];
+        ends[b] = next[b] + counts[b];
+    }
+
+    /* permute every tuple into its bucket */
+    for (b = 0; b < 256; b++)
+    {
+        while (next[b] < ends[b])
+        {
+            int         d;
+
+            d = (radix_sort_key(&begin[next[b]], keybytes, reverse) >> shift) & 0xFF;
+            if (d == b)
+                next[b]++;
+            else
+            {
+                SortTuple   tmp = begin[next[b]];
+
+                begin[next[b]] = begin[next[d]];
+                begin[next[d]++] = tmp;
+            }
+        }
+    }
+
+    for (b = 0; b < 256; b++)
+    {
+        SortTuple  *bucket = begin + ends[b] - counts[b];
+
+        if (counts[b] < 2)
+            continue;
+
+        if (level + 1 < keybytes)
+            radix_sort_tuple(bucket, counts[b], level + 1, keybytes, state);
+        else if (state->onlyKey == NULL)
+            qsort_tuple(bucket, counts[b], state->comparetup, state);
+    }
+}
+#endif
+
 /*
  * Insert a new tuple into an empty or existing heap, maintaining the
  * heap invariant.  Caller is responsible for ensuring there's room.
@@ -3977,6 +4233,80 @@ readtup_heap(Tuplesortstate *state, SortTuple *stup,
 }
 
 #ifdef PGXC
+/*
+ * Merge of the sorted streams of a combiner through a loser tree.
+ *
+ * memtuples[i] holds the current tuple of stream i and mergeactive[i] tells
+ * whether there is one. losers[0] is the stream whose current tuple comes
+ * first, losers[n] for 0 < n < maxTapes the stream that lost the match at
+ * inner node n. Replacing the winner replays only the matches on its path,
+ * one comparison per level, where sifting a binary heap takes two.
+ */
+static bool
+merge_stream_beats(Tuplesortstate *state, int a, int b)
+{
+    /* stream maxTapes stands for a tuple before all others, see below */
+    if (a == state->maxTapes)
+        return true;
+    if (b == state->maxTapes)
+        return false;
+    if (!state->mergeactive[a])
+        return false;
+    if (!state->mergeactive[b])
+        return true;
+    return COMPARETUP(state, &state->memtuples[a], &state->memtuples[b]) < 0;
+}
+
+static void
+merge_stream_adjust(Tuplesortstate *state, int stream)
+{
+    int        *losers = state->losers;
+    int            node;
+
+    for (node = (stream + state->maxTapes) / 2; node > 0; node /= 2)
+    {
+        if (merge_stream_beats(state, losers[node], stream))
+        {
+            int            winner = losers[node];
+
+            losers[node] = stream;
+            stream = winner;
+        }
+    }
+    losers[0] = stream;
+}
+
+static void
+beginmerge_streams(Tuplesortstate *state)
+{
+    int            stream;
+
+    Assert(state->memtupcount == 0);
+    Assert(state->maxTapes <= state->memtupsize);
+
+    state->activeTapes = state->maxTapes;
+    for (stream = 0; stream < state->maxTapes; stream++)
+        state->mergeactive[stream] = true;
+
+    /* Load each leaf with the first tuple of its stream */
+    for (stream = 0; stream < state->maxTapes; stream++)
+    {
+        if (mergereadnext(state, stream, &state->memtuples[stream]))
+            state->memtuples[stream].tupindex = stream;
+    }
+
+    /*
+     * Start with every match won by a virtual stream that beats all others,
+     * then let each real stream play its way up; once all have, the virtual
+     * stream is gone from the tree.
+     */
+    state->losers = (int *) palloc(state->maxTapes * sizeof(int));
+    for (stream = 0; stream < state->maxTapes; stream++)
+        state->losers[stream] = state->maxTapes;
+    for (stream = state->maxTapes - 1; stream >= 0; stream--)
+        merge_stream_adjust(state, stream);
+}
+
 static unsigned int
 getlen_datanode(Tuplesortstate *state, int tapenum, bool eofOK)
 {
@@ -119,6 +119,9 @@
 
 #include "access/htup_details.h"
 #include "commands/tablespace.h"
+#ifdef XCP
+#include "common/pg_lzcompress.h"
+#endif
 #include "executor/executor.h"
 #include "miscadmin.h"
 #include "storage/buffile.h"
@@ -194,11 +197,17 @@ struct Tuplestorestate
     bool        truncated;        /* tuplestore_trim has removed tuples? */
     int64        availMem;        /* remaining memory available, in bytes */
     int64        allowedMem;        /* total memory allowed, in bytes */
+#ifdef __TBASE__
+    int64        peakMem;        /* most memory used at once, in bytes */
+#endif
     int64        tuples;            /* number of tuples added */
     BufFile    *myfile;            /* underlying file, or NULL if none */
     MemoryContext context;        /* memory context for holding tuples */
 #ifdef XCP
     MemoryContext tmpcxt;        /* memory context for holding temporary data */
+    bool        compress;        /* pglz datarows written to the file? */
+    char       *zbuf;            /* (de)compression buffer, in context */
+    int            zbufsize;        /* allocated length of zbuf */
 #endif
     ResourceOwner resowner;        /* resowner for holding temp files */
 
@@ -326,6 +335,10 @@ struct Tuplestorestate
  *--------------------
  */
 
+#ifdef XCP
+/* GUC: pglz-compress datarows that a datarow store spills to its temp file */
+bool        datarow_spill_compress = false;
+#endif
 
 static Tuplestorestate *tuplestore_begin_common(int eflags,
                         bool interXact,
@@ -365,6 +378,11 @@ tuplestore_begin_common(int eflags, bool interXact, int maxKBytes)
     state->availMem = state->allowedMem;
     state->myfile = NULL;
     state->context = CurrentMemoryContext;
+#ifdef XCP
+    state->compress = false;
+    state->zbuf = NULL;
+    state->zbufsize = 0;
+#endif
     state->resowner = CurrentResourceOwner;
 
     state->memtupdeleted = 0;
@@ -586,6 +604,10 @@ tuplestore_end(Tuplestorestate *state)
         pfree(state->memtuples);
     }
     pfree(state->readptrs);
+#ifdef XCP
+    if (state->zbuf)
+        pfree(state->zbuf);
+#endif
     pfree(state);
 }
 
@@ -927,6 +949,11 @@ tuplestore_puttuple_common(Tuplestorestate *state, void *tuple)
     if (state->stat_name)
         state->stat_write_count++;
     state->tuples++;
+#ifdef __TBASE__
+    /* the caller has charged the tuple already, it may be dumped below */
+    if (state->allowedMem - state->availMem > state->peakMem)
+        state->peakMem = state->allowedMem - state->availMem;
+#endif
 
     switch (state->status)
     {
@@ -1658,6 +1685,19 @@ tuplestore_in_memory(Tuplestorestate *state)
     return (state->status == TSS_INMEM);
 }
 
+#ifdef __TBASE__
+/*
+ * tuplestore_space_peak
+ *
+ * Returns the most memory in bytes the tuplestore held at once.
+ */
+int64
+tuplestore_space_peak(Tuplestorestate *state)
+{
+    return state->peakMem;
+}
+#endif
+
 
 /*
  * Tape interface routines
@@ -1777,6 +1817,7 @@ tuplestore_begin_datarow(bool interXact, int maxKBytes,
     state->writetup = writetup_datarow;
     state->readtup = readtup_datarow;
     state->tmpcxt = tmpcxt;
+    state->compress = datarow_spill_compress;
 
     return state;
 }
@@ -1792,10 +1833,43 @@ copytup_datarow(Tuplestorestate *state, void *tup)
     return NULL;
 }
 
+/*
+ * Make sure zbuf can hold len bytes.
+ */
+static char *
+datarow_zbuf(Tuplestorestate *state, int len)
+{
+    if (state->zbufsize < len)
+    {
+        if (state->zbuf)
+            pfree(state->zbuf);
+        state->zbufsize = Max(len, BLCKSZ);
+        state->zbuf = MemoryContextAlloc(state->context, state->zbufsize);
+    }
+    return state->zbuf;
+}
+
+static void
+datarow_spill_error_callback(void *arg)
+{
+    Tuplestorestate *state = (Tuplestorestate *) arg;
+
+    errcontext("spilling rows of \"%s\" to a temporary file", state->stat_name);
+}
+
+/*
+ * With compression on, the message of a datarow is written as pglz data when
+ * that saves space. Such a record has DATAROW_PGLZ set in its length word and
+ * the raw message length stored ahead of the compressed bytes. Stores read
+ * backward need plain length words to seek, so they are never compressed.
+ */
+#define DATAROW_PGLZ    0x80000000
+
 static void
 writetup_datarow(Tuplestorestate *state, void *tup)
 {
     RemoteDataRow tuple = (RemoteDataRow) tup;
+    ErrorContextCallback errcallback;
 
     /* the part of the MinimalTuple we'll write: */
     char       *tupbody = tuple->msg;
@@ -1803,6 +1877,32 @@ writetup_datarow(Tuplestorestate *state, void *tup)
 
     /* total on-disk footprint: */
     unsigned int tuplen = tupbodylen + sizeof(int) + sizeof(tuple->msgnode);
+    int32        rawlen = 0;
+
+    /* tell which queue or buffer hit temp_file_limit or ran out of disk */
+    if (state->stat_name)
+    {
+        errcallback.callback = datarow_spill_error_callback;
+        errcallback.arg = (void *) state;
+        errcallback.previous = error_context_stack;
+        error_context_stack = &errcallback;
+    }
+
+    if (state->compress && !state->backward)
+    {
+        char   *zbuf = datarow_zbuf(state, PGLZ_MAX_OUTPUT(tupbodylen));
+        int32    zlen = pglz_compress(tupbody, tupbodylen, zbuf,
+                                     PGLZ_strategy_default);
+
+        if (zlen >= 0)
+        {
+            rawlen = tupbodylen;
+            tupbody = zbuf;
+            tupbodylen = zlen;
+            tuplen = (tupbodylen + sizeof(int) + sizeof(tuple->msgnode) +
+                      sizeof(rawlen)) | DATAROW_PGLZ;
+        }
+    }
 
     if (BufFileWrite(state->myfile, (void *) &tuplen,
                      sizeof(int)) != sizeof(int))
@@ -1810,6 +1910,10 @@ writetup_datarow(Tuplestorestate *state, void *tup)
     if (BufFileWrite(state->myfile, (void *) &tuple->msgnode,
                      sizeof(tuple->msgnode)) != sizeof(tuple->msgnode))
         elog(ERROR, "write failed");
+    if (rawlen > 0 &&
+        BufFileWrite(state->myfile, (void *) &rawlen,
+                     sizeof(rawlen)) != sizeof(rawlen))
+        elog(ERROR, "write failed");
     if (BufFileWrite(state->myfile, (void *) tupbody,
                      tupbodylen) != (size_t) tupbodylen)
         elog(ERROR, "write failed");
@@ -1818,6 +1922,9 @@ writetup_datarow(Tuplestorestate *state, void *tup)
                          sizeof(tuplen)) != sizeof(tuplen))
             elog(ERROR, "write failed");
 
+    if (state->stat_name)
+        error_context_stack = errcallback.previous;
+
     FREEMEM(state, GetMemoryChunkSpace(tuple));
     pfree(tuple);
 }
@@ -1825,8 +1932,39 @@ writetup_datarow(Tuplestorestate *state, void *tup)
 static void *
 readtup_datarow(Tuplestorestate *state, unsigned int len)
 {
-    RemoteDataRow tuple = (RemoteDataRow) palloc(len);
-    unsigned int tupbodylen = len - sizeof(int) - sizeof(tuple->msgnode);
+    RemoteDataRow tuple;
+    unsigned int tupbodylen;
+
+    if (len & DATAROW_PGLZ)
+    {
+        Oid        msgnode;
+        int32    rawlen;
+        char   *zbuf;
+
+        tupbodylen = (len & ~DATAROW_PGLZ) - sizeof(int) - sizeof(msgnode) -
+                     sizeof(rawlen);
+        if (BufFileRead(state->myfile, (void *) &msgnode,
+                        sizeof(msgnode)) != sizeof(msgnode))
+            elog(ERROR, "unexpected end of data");
+        if (BufFileRead(state->myfile, (void *) &rawlen,
+                        sizeof(rawlen)) != sizeof(rawlen))
+            elog(ERROR, "unexpected end of data");
+        zbuf = datarow_zbuf(state, tupbodylen);
+        if (BufFileRead(state->myfile, (void *) zbuf,
+                        tupbodylen) != (size_t) tupbodylen)
+            elog(ERROR, "unexpected end of data");
+
+        tuple = (RemoteDataRow) palloc(rawlen + sizeof(int) + sizeof(msgnode));
+        USEMEM(state, GetMemoryChunkSpace(tuple));
+        tuple->msgnode = msgnode;
+        tuple->msglen = rawlen;
+        if (pglz_decompress(zbuf, tupbodylen, tuple->msg, rawlen) != rawlen)
+            elog(ERROR, "compressed data row in tuplestore temporary file is corrupt");
+        return (void *) tuple;
+    }
+
+    tuple = (RemoteDataRow) palloc(len);
+    tupbodylen = len - sizeof(int) - sizeof(tuple->msgnode);
 
     USEMEM(state, GetMemoryChunkSpace(tuple));
     /* read in the tuple proper */
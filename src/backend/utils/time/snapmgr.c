@@ -651,6 +651,7 @@ SetTransactionSnapshot(Snapshot sourcesnap, VirtualTransactionId *sourcevxid,
     CurrentSnapshot->prepare_xcnt = sourcesnap->prepare_xcnt;
     CurrentSnapshot->prepare_subxcnt = sourcesnap->prepare_subxcnt;
     CurrentSnapshot->prepare_xmin = sourcesnap->prepare_xmin;
+    CurrentSnapshot->generation = 0;
     memcpy(CurrentSnapshot->prepare_xip, sourcesnap->prepare_xip,
            sourcesnap->prepare_xcnt * sizeof(TransactionId));
     memcpy(CurrentSnapshot->prepare_subxip, sourcesnap->prepare_subxip,
@@ -761,6 +762,9 @@ CopySnapshot(Snapshot snapshot)
     newsnap->regd_count = 0;
     newsnap->active_count = 0;
     newsnap->copied = true;
+#ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+    newsnap->generation = 0;
+#endif
 
     /* setup XID array */
     if (snapshot->xcnt > 0)
@@ -1536,6 +1540,28 @@ pg_export_snapshot(PG_FUNCTION_ARGS)
     PG_RETURN_TEXT_P(cstring_to_text(snapshotName));
 }
 
+#ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
+/*
+ * pg_export_global_timestamp
+ *        Return the global timestamp of the transaction snapshot.
+ *
+ * Sessions on any node that set snapshot_global_timestamp to it see the same
+ * data as this transaction, which is how a dump reads datanodes directly.
+ */
+Datum
+pg_export_global_timestamp(PG_FUNCTION_ARGS)
+{
+    Snapshot    snapshot = GetTransactionSnapshot();
+
+    if (snapshot->local || !GlobalTimestampIsValid(snapshot->start_ts))
+        ereport(ERROR,
+                (errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+                 errmsg("the current snapshot has no global timestamp")));
+
+    PG_RETURN_INT64(snapshot->start_ts);
+}
+#endif
+
 
 /*
  * Parsing subroutines for ImportSnapshot: parse a line with the given
@@ -2506,6 +2532,7 @@ RestoreSnapshot(char *start_address)
     snapshot->prepare_xmin = serialized_snapshot.prepare_xmin;
     snapshot->prepare_xcnt = serialized_snapshot.prepare_xcnt;
     snapshot->prepare_subxcnt = serialized_snapshot.prepare_subxcnt;
+    snapshot->generation = 0;
     if(enable_distri_print)
     {
         elog(LOG, "restore snapshot "INT64_FORMAT, snapshot->start_ts);
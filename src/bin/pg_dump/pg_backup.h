@@ -169,6 +169,9 @@ typedef struct _dumpOptions
     char       *outputSuperuser;
 
     int            sequence_data;    /* dump sequence data even in schema-only mode */
+#ifdef __TBASE__
+    int            datanode_direct;    /* read distributed tables from datanodes */
+#endif
 } DumpOptions;
 
 /*
@@ -201,6 +204,11 @@ typedef struct Archive
     bool        exit_on_error;    /* whether to exit on SQL errors... */
     int            n_errors;        /* number of errors (if no die) */
 
+#ifdef __TBASE__
+    PGconn      **nodeConns;        /* direct datanode connections, by node */
+    int            numNodeConns;    /* allocated length of nodeConns */
+#endif
+
     /* The rest is private */
 } Archive;
 
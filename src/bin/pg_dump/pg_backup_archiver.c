@@ -4634,6 +4634,10 @@ CloneArchive(ArchiveHandle *AH)
     clone->currSchema = NULL;
     clone->currTablespace = NULL;
     clone->currWithOids = -1;
+#ifdef __TBASE__
+    clone->public.nodeConns = NULL;
+    clone->public.numNodeConns = 0;
+#endif
 
     /* savedPassword must be local in case we change it while connecting */
     if (clone->savedPassword)
@@ -364,6 +364,16 @@ DisconnectDatabase(Archive *AHX)
 {
     ArchiveHandle *AH = (ArchiveHandle *) AHX;
     char        errbuf[1];
+#ifdef __TBASE__
+    int            i;
+
+    for (i = 0; i < AHX->numNodeConns; i++)
+    {
+        if (AHX->nodeConns[i])
+            PQfinish(AHX->nodeConns[i]);
+        AHX->nodeConns[i] = NULL;
+    }
+#endif
 
     if (!AH->connection)
         return;
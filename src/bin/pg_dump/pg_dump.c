@@ -127,6 +127,19 @@ static SimpleOidList  dump_shards = {NULL, NULL};
 static char * shardstring = NULL;
 static bool with_dropped_column = false;
 #endif
+#ifdef __TBASE__
+/* datanodes distributed tables are read from with --datanode-direct */
+typedef struct
+{
+    char       *name;
+    char       *host;
+    char       *port;
+} DatanodeInfo;
+
+static DatanodeInfo *datanodes = NULL;
+static int    numDatanodes = 0;
+static char *cluster_gts = NULL;    /* global timestamp they are read at */
+#endif
 char        g_opaque_type[10];    /* name for the opaque type */
 
 /* placeholders for the delimiters for comments */
@@ -276,6 +289,14 @@ static bool nonemptyReloptions(const char *reloptions);
 static void appendReloptionsArrayAH(PQExpBuffer buffer, const char *reloptions,
                         const char *prefix, Archive *fout);
 static char *get_synchronized_snapshot(Archive *fout);
+#ifdef __TBASE__
+static void setupDatanodeDirect(Archive *fout);
+static PGconn *getDatanodeConnection(Archive *fout, int node);
+static PGresult *executeDatanodeQuery(PGconn *conn, int node,
+                     const char *query, ExecStatusType status);
+static bool dumpTableDataByDatanode(Archive *fout, TableDataInfo *tdinfo,
+                        const char *copyStmt);
+#endif
 static void setupDumpWorker(Archive *AHX);
 
 
@@ -350,6 +371,9 @@ main(int argc, char **argv)
         {"attribute-inserts", no_argument, &dopt.column_inserts, 1},
         {"binary-upgrade", no_argument, &dopt.binary_upgrade, 1},
         {"column-inserts", no_argument, &dopt.column_inserts, 1},
+#ifdef __TBASE__
+        {"datanode-direct", no_argument, &dopt.datanode_direct, 1},
+#endif
         {"disable-dollar-quoting", no_argument, &dopt.disable_dollar_quoting, 1},
         {"disable-triggers", no_argument, &dopt.disable_triggers, 1},
         {"enable-row-security", no_argument, &dopt.enable_row_security, 1},
@@ -655,6 +679,14 @@ main(int argc, char **argv)
     if (dopt.if_exists && !dopt.outputClean)
         exit_horribly(NULL, "option --if-exists requires option -c/--clean\n");
 
+#ifdef __TBASE__
+    if (dopt.datanode_direct && dopt.dump_inserts)
+        exit_horribly(NULL, "options --datanode-direct and --inserts/--column-inserts cannot be used together\n");
+
+    if (dopt.datanode_direct && shardstring)
+        exit_horribly(NULL, "options --datanode-direct and -r/--shards cannot be used together\n");
+#endif
+
     /* Identify archive format to emit */
     archiveFormat = parseArchiveFormat(format, &archiveMode);
 
@@ -724,6 +756,10 @@ main(int argc, char **argv)
      */
     ConnectDatabase(fout, dopt.dbname, dopt.pghost, dopt.pgport, dopt.username, prompt_password);
     setup_connection(fout, dumpencoding, dumpsnapshot, use_role);
+#ifdef __TBASE__
+    if (dopt.datanode_direct)
+        setupDatanodeDirect(fout);
+#endif
 
     /*
      * Disable security label support if server version < v9.1.x (prevents
@@ -1006,6 +1042,9 @@ help(const char *progname)
     printf(_("  -x, --no-privileges          do not dump privileges (grant/revoke)\n"));
     printf(_("  --binary-upgrade             for use by upgrade utilities only\n"));
     printf(_("  --column-inserts             dump data as INSERT commands with column names\n"));
+#ifdef __TBASE__
+    printf(_("  --datanode-direct            read distributed tables directly from the datanodes\n"));
+#endif
     printf(_("  --disable-dollar-quoting     disable dollar quoting, use SQL standard quoting\n"));
     printf(_("  --disable-triggers           disable triggers during data-only restore\n"));
     printf(_("  --enable-row-security        enable row security (dump only content user has\n"
@@ -1244,6 +1283,152 @@ get_synchronized_snapshot(Archive *fout)
     return result;
 }
 
+#ifdef __TBASE__
+/*
+ * setupDatanodeDirect -
+ *      prepare for reading distributed tables directly from the datanodes
+ *
+ * The datanodes are read at the global timestamp of our transaction, so
+ * they see the data the coordinator does.  We open a transaction on each of
+ * them right away, which checks that they can be reached and holds a
+ * snapshot there for the whole dump, like ours on the coordinator.
+ */
+static void
+setupDatanodeDirect(Archive *fout)
+{
+    PGresult   *res;
+    int            i;
+
+    if (!fout->isPostgresXL)
+        exit_horribly(NULL, "option --datanode-direct requires a connection to a coordinator\n");
+
+    res = ExecuteSqlQueryForSingleRow(fout,
+                                      "SELECT pg_catalog.pg_export_global_timestamp()");
+    cluster_gts = pg_strdup(PQgetvalue(res, 0, 0));
+    PQclear(res);
+
+    res = ExecuteSqlQuery(fout,
+                          "SELECT node_name, node_host, node_port "
+                          "FROM pg_catalog.pgxc_node "
+                          "WHERE node_type = 'D' ORDER BY node_name",
+                          PGRES_TUPLES_OK);
+    numDatanodes = PQntuples(res);
+    datanodes = (DatanodeInfo *) pg_malloc(numDatanodes * sizeof(DatanodeInfo));
+    for (i = 0; i < numDatanodes; i++)
+    {
+        datanodes[i].name = pg_strdup(PQgetvalue(res, i, 0));
+        datanodes[i].host = pg_strdup(PQgetvalue(res, i, 1));
+        datanodes[i].port = pg_strdup(PQgetvalue(res, i, 2));
+    }
+    PQclear(res);
+
+    if (g_verbose)
+        write_msg(NULL, "reading distributed tables from %d datanodes at global timestamp %s\n",
+                  numDatanodes, cluster_gts);
+
+    for (i = 0; i < numDatanodes; i++)
+        (void) getDatanodeConnection(fout, i);
+}
+
+/*
+ * getDatanodeConnection -
+ *      return the connection of this archive handle to a datanode, opening
+ *      it if needed
+ *
+ * Each parallel worker has its own.  The session is set up the way
+ * setup_connection sets up the coordinator's, and its transaction reads at
+ * the global timestamp of the dump.
+ */
+static PGconn *
+getDatanodeConnection(Archive *fout, int node)
+{
+    DumpOptions *dopt = fout->dopt;
+    PGconn       *cnconn = GetConnection(fout);
+    PGconn       *conn;
+    PQExpBuffer query;
+    const char *keywords[7];
+    const char *values[7];
+
+    if (fout->nodeConns == NULL)
+    {
+        fout->nodeConns = (PGconn **) pg_malloc0(numDatanodes * sizeof(PGconn *));
+        fout->numNodeConns = numDatanodes;
+    }
+    if (fout->nodeConns[node] != NULL)
+        return fout->nodeConns[node];
+
+    keywords[0] = "host";
+    values[0] = datanodes[node].host;
+    keywords[1] = "port";
+    values[1] = datanodes[node].port;
+    keywords[2] = "user";
+    values[2] = PQuser(cnconn);
+    keywords[3] = "password";
+    values[3] = PQpass(cnconn);
+    keywords[4] = "dbname";
+    values[4] = PQdb(cnconn);
+    keywords[5] = "fallback_application_name";
+    values[5] = progname;
+    keywords[6] = NULL;
+    values[6] = NULL;
+
+    conn = PQconnectdbParams(keywords, values, false);
+    if (!conn)
+        exit_horribly(NULL, "failed to connect to datanode \"%s\"\n",
+                      datanodes[node].name);
+    if (PQstatus(conn) == CONNECTION_BAD)
+        exit_horribly(NULL, "connection to datanode \"%s\" failed: %s",
+                      datanodes[node].name, PQerrorMessage(conn));
+    fout->nodeConns[node] = conn;
+
+    if (PQsetClientEncoding(conn, pg_encoding_to_char(fout->encoding)) < 0)
+        exit_horribly(NULL, "could not set client encoding on datanode \"%s\": %s",
+                      datanodes[node].name, PQerrorMessage(conn));
+
+    query = createPQExpBuffer();
+    if (fout->use_role)
+        appendPQExpBuffer(query, "SET ROLE %s;", fmtId(fout->use_role));
+    appendPQExpBufferStr(query,
+                         "SET DATESTYLE = ISO;"
+                         "SET INTERVALSTYLE = POSTGRES;"
+                         "SET extra_float_digits TO 3;"
+                         "SET synchronize_seqscans TO off;"
+                         "SET statement_timeout = 0;"
+                         "SET lock_timeout = 0;"
+                         "SET idle_in_transaction_session_timeout = 0;");
+    appendPQExpBuffer(query, "SET row_security = %s;",
+                      dopt->enable_row_security ? "on" : "off");
+    PQclear(executeDatanodeQuery(conn, node, query->data, PGRES_COMMAND_OK));
+
+    resetPQExpBuffer(query);
+    appendPQExpBuffer(query,
+                      "BEGIN;"
+                      "SET TRANSACTION ISOLATION LEVEL REPEATABLE READ;"
+                      "SET LOCAL snapshot_global_timestamp = '%s';",
+                      cluster_gts);
+    PQclear(executeDatanodeQuery(conn, node, query->data, PGRES_COMMAND_OK));
+
+    /* take the transaction snapshot now */
+    PQclear(executeDatanodeQuery(conn, node, "SELECT 1", PGRES_TUPLES_OK));
+
+    destroyPQExpBuffer(query);
+    return conn;
+}
+
+static PGresult *
+executeDatanodeQuery(PGconn *conn, int node, const char *query,
+                     ExecStatusType status)
+{
+    PGresult   *res = PQexec(conn, query);
+
+    if (PQresultStatus(res) != status)
+        exit_horribly(NULL, "query failed on datanode \"%s\": %s"
+                      "query was: %s\n",
+                      datanodes[node].name, PQerrorMessage(conn), query);
+    return res;
+}
+#endif
+
 static ArchiveFormat
 parseArchiveFormat(const char *format, ArchiveMode *mode)
 {// #lizard forgives
@@ -1783,6 +1968,23 @@ dumpTableData_copy(Archive *fout, void *dcontext)
      * regclass, etc columns.
      */
     selectSourceSchema(fout, tbinfo->dobj.namespace->dobj.name);
+#ifdef __TBASE__
+    /* the rows of a distributed table on one datanode are read from it */
+    if (tdinfo->datanode >= 0)
+    {
+        conn = getDatanodeConnection(fout, tdinfo->datanode);
+        if (g_verbose)
+            write_msg(NULL, "reading table \"%s.%s\" from datanode \"%s\"\n",
+                      tbinfo->dobj.namespace->dobj.name, classname,
+                      datanodes[tdinfo->datanode].name);
+
+        appendPQExpBuffer(q, "SET search_path = %s, pg_catalog",
+                          fmtId(tbinfo->dobj.namespace->dobj.name));
+        PQclear(executeDatanodeQuery(conn, tdinfo->datanode, q->data,
+                                     PGRES_COMMAND_OK));
+        resetPQExpBuffer(q);
+    }
+#endif
 
     /*
      * Specify the column list explicitly so that we have no possibility of
@@ -1861,6 +2063,12 @@ dumpTableData_copy(Archive *fout, void *dcontext)
                                          classname),
                           column_list);
     }
+#ifdef __TBASE__
+    if (tdinfo->datanode >= 0)
+        res = executeDatanodeQuery(conn, tdinfo->datanode, q->data,
+                                   PGRES_COPY_OUT);
+    else
+#endif
     res = ExecuteSqlQuery(fout, q->data, PGRES_COPY_OUT);
     PQclear(res);
     destroyPQExpBuffer(clistBuf);
@@ -2198,6 +2406,12 @@ dumpTableData(Archive *fout, TableDataInfo *tdinfo)
      * dependency on its table as "special" and pass it to ArchiveEntry now.
      * See comments for BuildArchiveDependencies.
      */
+#ifdef __TBASE__
+    if ((tdinfo->dobj.dump & DUMP_COMPONENT_DATA) &&
+        dumpTableDataByDatanode(fout, tdinfo, copyStmt))
+        ;
+    else
+#endif
     if (tdinfo->dobj.dump & DUMP_COMPONENT_DATA)
         ArchiveEntry(fout, tdinfo->dobj.catId, tdinfo->dobj.dumpId,
                      tbinfo->dobj.name, tbinfo->dobj.namespace->dobj.name,
@@ -2211,6 +2425,86 @@ dumpTableData(Archive *fout, TableDataInfo *tdinfo)
     destroyPQExpBuffer(clistBuf);
 }
 
+#ifdef __TBASE__
+/*
+ * dumpTableDataByDatanode -
+ *      with --datanode-direct, archive the data of a distributed table as
+ *      one TABLE DATA entry per datanode, each read from its node directly
+ *
+ * The entries go to separate files in the directory format, so parallel
+ * workers read the nodes side by side.  The first one keeps the dump ID of
+ * the table data and the others depend on it, so on restore the rows of the
+ * first node are loaded first, into the table truncated for them.
+ *
+ * Returns false if the table is not read this way.
+ */
+static bool
+dumpTableDataByDatanode(Archive *fout, TableDataInfo *tdinfo,
+                        const char *copyStmt)
+{
+    TableInfo  *tbinfo = tdinfo->tdtable;
+    DumpId        firstId = 0;
+    char       *nodelist;
+    char       *nodename;
+
+    if (!fout->dopt->datanode_direct || copyStmt == NULL ||
+        tdinfo->filtercond != NULL ||
+        tbinfo->relkind != RELKIND_RELATION ||
+        tbinfo->pgxc_node_names == NULL)
+        return false;
+
+    /* replicated tables are read once, through the coordinator */
+    if (tbinfo->pgxclocatortype != 'S' && tbinfo->pgxclocatortype != 'H' &&
+        tbinfo->pgxclocatortype != 'M' && tbinfo->pgxclocatortype != 'N')
+        return false;
+
+    nodelist = pg_strdup(tbinfo->pgxc_node_names);
+    for (nodename = strtok(nodelist, ","); nodename != NULL;
+         nodename = strtok(NULL, ","))
+    {
+        TableDataInfo *slice;
+        DumpId        sliceId;
+        DumpId        dep;
+        int            node;
+
+        for (node = 0; node < numDatanodes; node++)
+        {
+            if (strcmp(datanodes[node].name, nodename) == 0)
+                break;
+        }
+        if (node >= numDatanodes)
+            exit_horribly(NULL, "table \"%s\" is distributed to unknown datanode \"%s\"\n",
+                          tbinfo->dobj.name, nodename);
+
+        slice = (TableDataInfo *) pg_malloc(sizeof(TableDataInfo));
+        memcpy(slice, tdinfo, sizeof(TableDataInfo));
+        slice->datanode = node;
+
+        if (firstId == 0)
+        {
+            sliceId = firstId = tdinfo->dobj.dumpId;
+            dep = tbinfo->dobj.dumpId;
+        }
+        else
+        {
+            sliceId = createDumpId();
+            dep = firstId;
+        }
+
+        ArchiveEntry(fout, tdinfo->dobj.catId, sliceId,
+                     tbinfo->dobj.name, tbinfo->dobj.namespace->dobj.name,
+                     NULL, tbinfo->rolname,
+                     false, "TABLE DATA", SECTION_DATA,
+                     "", "", copyStmt,
+                     &dep, 1,
+                     dumpTableData_copy, slice);
+    }
+    free(nodelist);
+
+    return firstId != 0;
+}
+#endif
+
 /*
  * refreshMatViewData -
  *      load or refresh the contents of a single materialized view
@@ -2332,6 +2626,9 @@ makeTableDataInfo(DumpOptions *dopt, TableInfo *tbinfo, bool oids)
     tdinfo->tdtable = tbinfo;
     tdinfo->oids = oids;
     tdinfo->filtercond = NULL;    /* might get set later */
+#ifdef __TBASE__
+    tdinfo->datanode = -1;
+#endif
     addObjectDependency(&tdinfo->dobj, tbinfo->dobj.dumpId);
 
     tbinfo->dataObj = tdinfo;
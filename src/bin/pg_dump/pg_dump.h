@@ -438,6 +438,9 @@ typedef struct _tableDataInfo
     TableInfo  *tdtable;        /* link to table to dump */
     bool        oids;            /* include OIDs in data? */
     char       *filtercond;        /* WHERE condition to limit rows dumped */
+#ifdef __TBASE__
+    int            datanode;        /* datanode read directly, or -1 */
+#endif
 } TableDataInfo;
 
 typedef struct _indxInfo
@@ -230,8 +230,17 @@ start_postmaster(ClusterInfo *cluster, bool throw_error)
      * crash, the new cluster has to be recreated anyway.  fsync=off is a big
      * win on ext4.
      */
+#ifdef PGXC
+    /*
+     * Run the node on its own: in restore mode, DDL is neither forwarded to
+     * nor expected from the other nodes of the cluster.
+     */
+    snprintf(cmd, sizeof(cmd),
+             "\"%s/pg_ctl\" -w -Z restoremode -l \"%s\" -D \"%s\" -o \"-p %d%s%s %s%s\" start",
+#else
     snprintf(cmd, sizeof(cmd),
              "\"%s/pg_ctl\" -w -l \"%s\" -D \"%s\" -o \"-p %d%s%s %s%s\" start",
+#endif
              cluster->bindir, SERVER_LOG_FILE, cluster->pgconfig, cluster->port,
              (cluster->controldata.cat_ver >=
               BINARY_UPGRADE_SERVER_FLAG_CAT_VER) ? " -b" :
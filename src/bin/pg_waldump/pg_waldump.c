@@ -510,8 +510,7 @@ XLogDumpDisplayRecord(XLogDumpConfig *config, XLogReaderState *record)
                    blk);
             if (XLogRecHasBlockImage(record, block_id))
             {
-                if (record->blocks[block_id].bimg_info &
-                    BKPIMAGE_IS_COMPRESSED)
+                if (BKPIMAGE_COMPRESSED(record->blocks[block_id].bimg_info))
                 {
                     printf(" (FPW%s); hole: offset: %u, length: %u, "
                            "compression saved: %u\n",
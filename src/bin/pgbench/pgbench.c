@@ -157,6 +157,15 @@ char       *index_tablespace = NULL;
 
 #ifdef PGXC
 bool        use_branch = false;    /* use branch id in DDL and DML */
+bool        use_shard = false;    /* distribute tables by shard */
+int            init_jobs = 0;        /* connections generating pgbench_accounts
+                                 * on the servers, 0 to COPY it from here */
+bool        cluster_report = false; /* report node, GTM and pooler metrics */
+
+/* coordinators given by --coordinators, clients are spread over them */
+char      **coord_hosts = NULL;
+char      **coord_ports = NULL;
+int            ncoords = 0;
 #endif
 /*
  * The scale factor at/beyond which 32bit integers are incapable of storing
@@ -225,6 +234,15 @@ typedef struct SimpleStats
     double        sum2;            /* sum of squared values */
 } SimpleStats;
 
+/*
+ * Transaction latencies are also counted in a log-linear histogram, with
+ * LATENCY_HIST_SUB buckets per power of two microseconds, to report
+ * percentiles within about 3%.
+ */
+#define LATENCY_HIST_SUB_BITS    5
+#define LATENCY_HIST_SUB        (1 << LATENCY_HIST_SUB_BITS)
+#define LATENCY_HIST_BUCKETS    ((64 - LATENCY_HIST_SUB_BITS) * LATENCY_HIST_SUB)
+
 /*
  * Data structure to hold various statistics: per-thread and per-script stats
  * are maintained and merged together.
@@ -354,6 +372,7 @@ typedef struct
     instr_time    conn_time;
     StatsData    stats;
     int64        latency_late;    /* executed but late transactions */
+    int64       *latency_hist;    /* LATENCY_HIST_BUCKETS transaction counts */
 } TState;
 
 #define INVALID_THREAD        ((pthread_t) 0)
@@ -534,6 +553,10 @@ usage(void)
            "                           create indexes in the specified tablespace\n"
            "  --tablespace=TABLESPACE  create tables in the specified tablespace\n"
            "  --unlogged-tables        create tables as unlogged tables\n"
+#ifdef PGXC
+           "  --init-jobs=NUM          generate accounts on the servers using NUM connections\n"
+           "  --shard                  distribute tables by shard instead of hash\n"
+#endif
            "\nOptions to select what to run:\n"
            "  -b, --builtin=NAME[@W]   add builtin script NAME weighted at W (default: 1)\n"
            "                           (use \"-b list\" to list available scripts)\n"
@@ -568,6 +591,12 @@ usage(void)
            "                           (default: \"pgbench_log\")\n"
            "  --progress-timestamp     use Unix epoch timestamps for progress\n"
            "  --sampling-rate=NUM      fraction of transactions to log (e.g., 0.01 for 1%%)\n"
+#ifdef PGXC
+           "  --cluster-report         report per-node, GTM and pooler statistics of the run\n"
+           "                           (clears GTM latency statistics at start)\n"
+           "  --coordinators=HOST:PORT[,...]\n"
+           "                           spread clients over these coordinators\n"
+#endif
            "\nCommon options:\n"
            "  -d, --debug              print debugging output\n"
            "  -h, --host=HOSTNAME      database server host or socket directory\n"
@@ -866,6 +895,39 @@ accumStats(StatsData *stats, bool skipped, double lat, double lag)
     }
 }
 
+/*
+ * Histogram bucket of a latency in microseconds.
+ */
+static int
+latencyBucket(int64 usec)
+{
+    int            shift = 0;
+
+    if (usec < LATENCY_HIST_SUB)
+        return usec < 0 ? 0 : (int) usec;
+
+    while ((usec >> shift) >= 2 * LATENCY_HIST_SUB)
+        shift++;
+
+    return (shift + 1) * LATENCY_HIST_SUB + (int) (usec >> shift) - LATENCY_HIST_SUB;
+}
+
+/*
+ * Middle of the latency range of a histogram bucket, in microseconds.
+ */
+static double
+latencyBucketValue(int bucket)
+{
+    int            shift;
+
+    if (bucket < LATENCY_HIST_SUB)
+        return bucket;
+
+    shift = bucket / LATENCY_HIST_SUB - 1;
+    return ((double) (LATENCY_HIST_SUB + bucket % LATENCY_HIST_SUB) +
+            (shift > 0 ? 0.5 : 0.0)) * ((int64) 1 << shift);
+}
+
 /* call PQexec() and exit() on failure */
 static void
 executeStatement(PGconn *con, const char *sql)
@@ -896,9 +958,9 @@ tryExecuteStatement(PGconn *con, const char *sql)
     PQclear(res);
 }
 
-/* set up a connection to the backend */
+/* set up a connection to the backend at host and port */
 static PGconn *
-doConnect(void)
+doConnectHost(const char *host, const char *port)
 {// #lizard forgives
     PGconn       *conn;
     bool        new_pass;
@@ -917,9 +979,9 @@ doConnect(void)
         const char *values[PARAMS_ARRAY_SIZE];
 
         keywords[0] = "host";
-        values[0] = pghost;
+        values[0] = host;
         keywords[1] = "port";
-        values[1] = pgport;
+        values[1] = port;
         keywords[2] = "user";
         values[2] = login;
         keywords[3] = "password";
@@ -965,6 +1027,68 @@ doConnect(void)
     return conn;
 }
 
+/* set up a connection to the backend */
+static PGconn *
+doConnect(void)
+{
+    return doConnectHost(pghost, pgport);
+}
+
+#ifdef PGXC
+/* parse the HOST[:PORT][,...] list of --coordinators */
+static void
+parseCoordinators(const char *arg)
+{
+    char       *list = pg_strdup(arg);
+    char       *item;
+    int            n = 1;
+    const char *p;
+
+    for (p = arg; *p; p++)
+        if (*p == ',')
+            n++;
+
+    coord_hosts = (char **) pg_malloc(sizeof(char *) * n);
+    coord_ports = (char **) pg_malloc(sizeof(char *) * n);
+    ncoords = 0;
+
+    for (item = strtok(list, ","); item != NULL; item = strtok(NULL, ","))
+    {
+        char       *port = strrchr(item, ':');
+
+        if (port != NULL)
+            *port++ = '\0';
+        if (*item == '\0' || (port != NULL && *port == '\0'))
+        {
+            fprintf(stderr, "invalid coordinator: \"%s\"\n", arg);
+            exit(1);
+        }
+
+        coord_hosts[ncoords] = item;
+        coord_ports[ncoords] = port;    /* NULL means -p */
+        ncoords++;
+    }
+
+    if (ncoords == 0)
+    {
+        fprintf(stderr, "invalid coordinator: \"%s\"\n", arg);
+        exit(1);
+    }
+}
+#endif
+
+/* set up the connection of a client, with --coordinators round robin */
+static PGconn *
+doConnectClient(int id)
+{
+#ifdef PGXC
+    if (ncoords > 0)
+        return doConnectHost(coord_hosts[id % ncoords],
+                             coord_ports[id % ncoords] ? coord_ports[id % ncoords] : pgport);
+#endif
+    return doConnect();
+}
+
 /* throw away response from backend */
 static void
 discard_response(CState *state)
@@ -2141,7 +2265,7 @@ doCustom(TState *thread, CState *st, StatsData *agg)
                     if (INSTR_TIME_IS_ZERO(now))
                         INSTR_TIME_SET_CURRENT(now);
                     start = now;
-                    if ((st->con = doConnect()) == NULL)
+                    if ((st->con = doConnectClient(st->id)) == NULL)
                     {
                         fprintf(stderr, "client %d aborted while establishing connection\n",
                                 st->id);
@@ -2581,6 +2705,8 @@ processXactStats(TState *thread, CState *st, instr_time *now,
         /* compute latency & lag */
         latency = INSTR_TIME_GET_MICROSEC(*now) - st->txn_scheduled;
         lag = INSTR_TIME_GET_MICROSEC(st->txn_begin) - st->txn_scheduled;
+
+        thread->latency_hist[latencyBucket((int64) latency)]++;
     }
 
     if (progress || throttle_delay || latency_limit)
@@ -2619,6 +2745,165 @@ disconnect_all(CState *state, int length)
     }
 }
 
+/* fill pgbench_accounts by COPY from this client */
+static void
+copyAccounts(PGconn *con)
+{// #lizard forgives
+    PGresult   *res;
+    char        sql[256];
+    int64        k;
+
+    /* used to track elapsed time and estimate of the remaining time */
+    instr_time    start,
+                diff;
+    double        elapsed_sec,
+                remaining_sec;
+    int            log_interval = 1;
+
+    executeStatement(con, "begin");
+    executeStatement(con, "truncate pgbench_accounts");
+
+    res = PQexec(con, "copy pgbench_accounts from stdin");
+    if (PQresultStatus(res) != PGRES_COPY_IN)
+    {
+        fprintf(stderr, "%s", PQerrorMessage(con));
+        exit(1);
+    }
+    PQclear(res);
+
+    INSTR_TIME_SET_CURRENT(start);
+
+    for (k = 0; k < (int64) naccounts * scale; k++)
+    {
+        int64        j = k + 1;
+
+        /* "filler" column defaults to blank padded empty string */
+        snprintf(sql, sizeof(sql),
+                 INT64_FORMAT "\t" INT64_FORMAT "\t%d\t\n",
+                 j, k / naccounts + 1, 0);
+        if (PQputline(con, sql))
+        {
+            fprintf(stderr, "PQputline failed\n");
+            exit(1);
+        }
+
+        /*
+         * If we want to stick with the original logging, print a message each
+         * 100k inserted rows.
+         */
+        if ((!use_quiet) && (j % 100000 == 0))
+        {
+            INSTR_TIME_SET_CURRENT(diff);
+            INSTR_TIME_SUBTRACT(diff, start);
+
+            elapsed_sec = INSTR_TIME_GET_DOUBLE(diff);
+            remaining_sec = ((double) scale * naccounts - j) * elapsed_sec / j;
+
+            fprintf(stderr, INT64_FORMAT " of " INT64_FORMAT " tuples (%d%%) done (elapsed %.2f s, remaining %.2f s)\n",
+                    j, (int64) naccounts * scale,
+                    (int) (((int64) j * 100) / (naccounts * (int64) scale)),
+                    elapsed_sec, remaining_sec);
+        }
+        /* let's not call the timing for each row, but only each 100 rows */
+        else if (use_quiet && (j % 100 == 0))
+        {
+            INSTR_TIME_SET_CURRENT(diff);
+            INSTR_TIME_SUBTRACT(diff, start);
+
+            elapsed_sec = INSTR_TIME_GET_DOUBLE(diff);
+            remaining_sec = ((double) scale * naccounts - j) * elapsed_sec / j;
+
+            /* have we reached the next interval (or end)? */
+            if ((j == scale * naccounts) || (elapsed_sec >= log_interval * LOG_STEP_SECONDS))
+            {
+                fprintf(stderr, INT64_FORMAT " of " INT64_FORMAT " tuples (%d%%) done (elapsed %.2f s, remaining %.2f s)\n",
+                        j, (int64) naccounts * scale,
+                        (int) (((int64) j * 100) / (naccounts * (int64) scale)), elapsed_sec, remaining_sec);
+
+                /* skip to the next interval */
+                log_interval = (int) ceil(elapsed_sec / LOG_STEP_SECONDS);
+            }
+        }
+
+    }
+    if (PQputline(con, "\\.\n"))
+    {
+        fprintf(stderr, "very last PQputline failed\n");
+        exit(1);
+    }
+    if (PQendcopy(con))
+    {
+        fprintf(stderr, "PQendcopy failed\n");
+        exit(1);
+    }
+    executeStatement(con, "commit");
+}
+
+#ifdef PGXC
+/*
+ * Fill pgbench_accounts with rows generated on the servers. init_jobs
+ * connections, spread over the coordinators, each insert the accounts of a
+ * slice of the branches in parallel, so the rows never pass through this
+ * client.
+ */
+static void
+generateAccounts(void)
+{
+    PGconn      **conns;
+    PGresult   *res;
+    char        sql[256];
+    int            njobs = Min(init_jobs, nbranches * scale);
+    int            i;
+    instr_time    start,
+                diff;
+
+    fprintf(stderr, "generating accounts on the servers with %d connections...\n",
+            njobs);
+    INSTR_TIME_SET_CURRENT(start);
+
+    conns = (PGconn **) pg_malloc(sizeof(PGconn *) * njobs);
+    for (i = 0; i < njobs; i++)
+    {
+        int64        first = (int64) naccounts * (nbranches * scale * i / njobs) + 1;
+        int64        last = (int64) naccounts * (nbranches * scale * (i + 1) / njobs);
+
+        snprintf(sql, sizeof(sql),
+                 "insert into pgbench_accounts(aid,bid,abalance,filler) "
+                 "select aid, (aid - 1) / %d + 1, 0, '' "
+                 "from generate_series(" INT64_FORMAT ", " INT64_FORMAT ") aid",
+                 naccounts, first, last);
+
+        if ((conns[i] = doConnectClient(i)) == NULL)
+            exit(1);
+        if (!PQsendQuery(conns[i], sql))
+        {
+            fprintf(stderr, "%s", PQerrorMessage(conns[i]));
+            exit(1);
+        }
+    }
+
+    for (i = 0; i < njobs; i++)
+    {
+        while ((res = PQgetResult(conns[i])) != NULL)
+        {
+            if (PQresultStatus(res) != PGRES_COMMAND_OK)
+            {
+                fprintf(stderr, "%s", PQerrorMessage(conns[i]));
+                exit(1);
+            }
+            PQclear(res);
+        }
+        PQfinish(conns[i]);
+    }
+    pg_free(conns);
+
+    INSTR_TIME_SET_CURRENT(diff);
+    INSTR_TIME_SUBTRACT(diff, start);
+    fprintf(stderr, INT64_FORMAT " tuples done (elapsed %.2f s)\n",
+            (int64) naccounts * scale, INSTR_TIME_GET_DOUBLE(diff));
+}
+#endif
+
 /* create tables and setup data */
 static void
 init(bool is_no_vacuum)
@@ -2651,6 +2936,7 @@ init(bool is_no_vacuum)
         int            declare_fillfactor;
 #ifdef PGXC
         char       *distribute_by;
+        char       *shard_key;        /* --shard distribution key without -k */
 #endif
     };
     static const struct ddlinfo DDLs[] = {
@@ -2660,7 +2946,7 @@ init(bool is_no_vacuum)
             "tid int,bid int,aid bigint,delta int,mtime timestamp,filler char(22)",
             0
 #ifdef PGXC
-            , "distribute by hash (bid)"
+            , "distribute by hash (bid)", "aid"
 #endif
         },
         {
@@ -2669,7 +2955,7 @@ init(bool is_no_vacuum)
             "tid int not null,bid int,tbalance int,filler char(84)",
             1
 #ifdef PGXC
-            , "distribute by hash (bid)"
+            , "distribute by hash (bid)", "tid"
 #endif
         },
         {
@@ -2678,7 +2964,7 @@ init(bool is_no_vacuum)
             "aid bigint not null,bid int,abalance int,filler char(84)",
             1
 #ifdef PGXC
-            , "distribute by hash (bid)"
+            , "distribute by hash (bid)", "aid"
 #endif
         },
         {
@@ -2687,7 +2973,7 @@ init(bool is_no_vacuum)
             "bid int not null,bbalance int,filler char(88)",
             1
 #ifdef PGXC
-            , "distribute by hash (bid)"
+            , "distribute by hash (bid)", "bid"
 #endif
         }
     };
@@ -2713,17 +2999,8 @@ init(bool is_no_vacuum)
 #endif
 
     PGconn       *con;
-    PGresult   *res;
     char        sql[256];
     int            i;
-    int64        k;
-
-    /* used to track elapsed time and estimate of the remaining time */
-    instr_time    start,
-                diff;
-    double        elapsed_sec,
-                remaining_sec;
-    int            log_interval = 1;
 
     if ((con = doConnect()) == NULL)
         exit(1);
@@ -2759,7 +3036,11 @@ init(bool is_no_vacuum)
 
 #ifdef PGXC
         /* Add distribution columns if necessary */
-        if (use_branch)
+        if (use_shard)
+            snprintf(buffer, sizeof(buffer), "create%s table %s(%s)%s distribute by shard (%s)",
+                     unlogged_tables ? " unlogged" : "",
+                     ddl->table, cols, opts, use_branch ? "bid" : ddl->shard_key);
+        else if (use_branch)
             snprintf(buffer, sizeof(buffer), "create%s table %s(%s)%s %s",
                      unlogged_tables ? " unlogged" : "",
                      ddl->table, cols, opts, ddl->distribute_by);
@@ -2799,83 +3080,12 @@ init(bool is_no_vacuum)
      */
     fprintf(stderr, "creating tables...\n");
 
-    executeStatement(con, "begin");
-    executeStatement(con, "truncate pgbench_accounts");
-
-    res = PQexec(con, "copy pgbench_accounts from stdin");
-    if (PQresultStatus(res) != PGRES_COPY_IN)
-    {
-        fprintf(stderr, "%s", PQerrorMessage(con));
-        exit(1);
-    }
-    PQclear(res);
-
-    INSTR_TIME_SET_CURRENT(start);
-
-    for (k = 0; k < (int64) naccounts * scale; k++)
-    {
-        int64        j = k + 1;
-
-        /* "filler" column defaults to blank padded empty string */
-        snprintf(sql, sizeof(sql),
-                 INT64_FORMAT "\t" INT64_FORMAT "\t%d\t\n",
-                 j, k / naccounts + 1, 0);
-        if (PQputline(con, sql))
-        {
-            fprintf(stderr, "PQputline failed\n");
-            exit(1);
-        }
-
-        /*
-         * If we want to stick with the original logging, print a message each
-         * 100k inserted rows.
-         */
-        if ((!use_quiet) && (j % 100000 == 0))
-        {
-            INSTR_TIME_SET_CURRENT(diff);
-            INSTR_TIME_SUBTRACT(diff, start);
-
-            elapsed_sec = INSTR_TIME_GET_DOUBLE(diff);
-            remaining_sec = ((double) scale * naccounts - j) * elapsed_sec / j;
-
-            fprintf(stderr, INT64_FORMAT " of " INT64_FORMAT " tuples (%d%%) done (elapsed %.2f s, remaining %.2f s)\n",
-                    j, (int64) naccounts * scale,
-                    (int) (((int64) j * 100) / (naccounts * (int64) scale)),
-                    elapsed_sec, remaining_sec);
-        }
-        /* let's not call the timing for each row, but only each 100 rows */
-        else if (use_quiet && (j % 100 == 0))
-        {
-            INSTR_TIME_SET_CURRENT(diff);
-            INSTR_TIME_SUBTRACT(diff, start);
-
-            elapsed_sec = INSTR_TIME_GET_DOUBLE(diff);
-            remaining_sec = ((double) scale * naccounts - j) * elapsed_sec / j;
-
-            /* have we reached the next interval (or end)? */
-            if ((j == scale * naccounts) || (elapsed_sec >= log_interval * LOG_STEP_SECONDS))
-            {
-                fprintf(stderr, INT64_FORMAT " of " INT64_FORMAT " tuples (%d%%) done (elapsed %.2f s, remaining %.2f s)\n",
-                        j, (int64) naccounts * scale,
-                        (int) (((int64) j * 100) / (naccounts * (int64) scale)), elapsed_sec, remaining_sec);
-
-                /* skip to the next interval */
-                log_interval = (int) ceil(elapsed_sec / LOG_STEP_SECONDS);
-            }
-        }
-
-    }
-    if (PQputline(con, "\\.\n"))
-    {
-        fprintf(stderr, "very last PQputline failed\n");
-        exit(1);
-    }
-    if (PQendcopy(con))
-    {
-        fprintf(stderr, "PQendcopy failed\n");
-        exit(1);
-    }
-    executeStatement(con, "commit");
+#ifdef PGXC
+    if (init_jobs > 0)
+        generateAccounts();
+    else
+#endif
+    copyAccounts(con);
 
     /* vacuum */
     if (!is_no_vacuum)
@@ -3597,6 +3807,47 @@ printSimpleStats(char *prefix, SimpleStats *ss)
     printf("%s stddev = %.3f ms\n", prefix, 0.001 * stddev);
 }
 
+/* print latency percentiles from the histograms of all threads */
+static void
+printLatencyPercentiles(TState *threads)
+{
+    static const double percentiles[] = {50.0, 90.0, 99.0, 99.9};
+    int64       *hist;
+    int64        total = 0;
+    int64        seen = 0;
+    int            bucket = 0;
+    int            i,
+                j;
+
+    hist = (int64 *) pg_malloc0(sizeof(int64) * LATENCY_HIST_BUCKETS);
+    for (i = 0; i < nthreads; i++)
+    {
+        for (j = 0; j < LATENCY_HIST_BUCKETS; j++)
+        {
+            hist[j] += threads[i].latency_hist[j];
+            total += threads[i].latency_hist[j];
+        }
+    }
+
+    if (total > 0)
+    {
+        printf("latency percentiles:");
+        for (i = 0; i < lengthof(percentiles); i++)
+        {
+            int64        target = (int64) ceil(total * percentiles[i] / 100.0);
+
+            while (bucket < LATENCY_HIST_BUCKETS - 1 && seen + hist[bucket] < target)
+                seen += hist[bucket++];
+
+            printf("%s %g%% = %.3f ms", i > 0 ? "," : "", percentiles[i],
+                   latencyBucketValue(bucket) / 1000.0);
+        }
+        printf("\n");
+    }
+
+    pg_free(hist);
+}
+
 /* print out results */
 static void
 printResults(TState *threads, StatsData *total, instr_time total_time,
@@ -3618,6 +3869,10 @@ printResults(TState *threads, StatsData *total, instr_time total_time,
     printf("query mode: %s\n", QUERYMODE[querymode]);
     printf("number of clients: %d\n", nclients);
     printf("number of threads: %d\n", nthreads);
+#ifdef PGXC
+    if (ncoords > 0)
+        printf("number of coordinators: %d\n", ncoords);
+#endif
     if (duration <= 0)
     {
         printf("number of transactions per client: %d\n", nxacts);
@@ -3653,6 +3908,7 @@ printResults(TState *threads, StatsData *total, instr_time total_time,
         printf("latency average = %.3f ms\n",
                1000.0 * time_include * nclients / total->cnt);
     }
+    printLatencyPercentiles(threads);
 
     if (throttle_delay)
     {
@@ -3717,6 +3973,203 @@ printResults(TState *threads, StatsData *total, instr_time total_time,
     }
 }
 
+#ifdef PGXC
+/*
+ * Counters of one node for --cluster-report, read from pg_stat_database
+ * through EXECUTE DIRECT before and after the run.
+ */
+#define NODE_STAT_COLS 6
+
+typedef struct NodeStats
+{
+    char        name[NAMEDATALEN];
+    char        type;            /* node_type of pgxc_node */
+    int64        counters[NODE_STAT_COLS];
+} NodeStats;
+
+static const char *const node_stat_names[NODE_STAT_COLS] = {
+    "commits", "rollbacks", "blks_read", "blks_hit", "rows_read", "rows_written"
+};
+
+#define GTM_LATENCY_QUERY \
+    "select command, sum(requests) as requests, " \
+    "min(latency_below_us) filter (where running >= total * 0.5) as p50_us, " \
+    "min(latency_below_us) filter (where running >= total * 0.99) as p99_us " \
+    "from (select command, latency_below_us, requests, " \
+    "sum(requests) over (partition by command order by latency_below_us nulls last) as running, " \
+    "sum(requests) over (partition by command) as total " \
+    "from (select command, latency_below_us, sum(requests) as requests " \
+    "from pg_gtm_latency_statistics(false) group by 1, 2) h) s " \
+    "group by command having sum(requests) > 0 order by command"
+
+#define POOLER_LATENCY_QUERY \
+    "select node_name, metric, count, p50_us, p90_us, p99_us, max_us " \
+    "from tbase_pooler_latency where count > 0 order by 1, 2"
+
+/* read the counters of all coordinators and datanodes */
+static NodeStats *
+getNodeStats(PGconn *con, int *nnodes)
+{
+    PGresult   *res;
+    NodeStats  *nodes;
+    int            i,
+                j;
+
+    res = PQexec(con, "select node_name, node_type from pgxc_node "
+                 "where node_type in ('C', 'D') order by node_type, node_name");
+    if (PQresultStatus(res) != PGRES_TUPLES_OK)
+    {
+        fprintf(stderr, "%s", PQerrorMessage(con));
+        exit(1);
+    }
+
+    *nnodes = PQntuples(res);
+    nodes = (NodeStats *) pg_malloc0(sizeof(NodeStats) * Max(*nnodes, 1));
+    for (i = 0; i < *nnodes; i++)
+    {
+        strlcpy(nodes[i].name, PQgetvalue(res, i, 0), NAMEDATALEN);
+        nodes[i].type = *PQgetvalue(res, i, 1);
+    }
+    PQclear(res);
+
+    for (i = 0; i < *nnodes; i++)
+    {
+        char        sql[512];
+        char       *name;
+
+        name = PQescapeIdentifier(con, nodes[i].name, strlen(nodes[i].name));
+        snprintf(sql, sizeof(sql),
+                 "execute direct on (%s) 'select sum(xact_commit), sum(xact_rollback), "
+                 "sum(blks_read), sum(blks_hit), sum(tup_returned + tup_fetched), "
+                 "sum(tup_inserted + tup_updated + tup_deleted) from pg_stat_database'",
+                 name);
+        PQfreemem(name);
+
+        res = PQexec(con, sql);
+        if (PQresultStatus(res) != PGRES_TUPLES_OK || PQntuples(res) != 1)
+        {
+            fprintf(stderr, "could not read statistics of node \"%s\": %s",
+                    nodes[i].name, PQerrorMessage(con));
+            PQclear(res);
+            continue;
+        }
+
+        for (j = 0; j < NODE_STAT_COLS; j++)
+            if (!PQgetisnull(res, 0, j))
+                nodes[i].counters[j] = strtoint64(PQgetvalue(res, 0, j));
+        PQclear(res);
+    }
+
+    return nodes;
+}
+
+/* run a report query and print its result as a table */
+static void
+printReportQuery(PGconn *con, const char *title, const char *sql)
+{
+    PGresult   *res;
+    int           *widths;
+    int            nfields;
+    int            i,
+                j;
+
+    printf("%s:\n", title);
+
+    res = PQexec(con, sql);
+    if (PQresultStatus(res) != PGRES_TUPLES_OK)
+    {
+        printf("  not available: %s", PQerrorMessage(con));
+        PQclear(res);
+        return;
+    }
+
+    nfields = PQnfields(res);
+    widths = (int *) pg_malloc(sizeof(int) * nfields);
+    for (j = 0; j < nfields; j++)
+    {
+        widths[j] = strlen(PQfname(res, j));
+        for (i = 0; i < PQntuples(res); i++)
+            widths[j] = Max(widths[j], PQgetlength(res, i, j));
+    }
+
+    printf(" ");
+    for (j = 0; j < nfields; j++)
+        printf(" %*s", widths[j], PQfname(res, j));
+    printf("\n");
+
+    for (i = 0; i < PQntuples(res); i++)
+    {
+        printf(" ");
+        for (j = 0; j < nfields; j++)
+            printf(" %*s", widths[j], PQgetvalue(res, i, j));
+        printf("\n");
+    }
+
+    pg_free(widths);
+    PQclear(res);
+}
+
+/*
+ * Print what the run cost each node of the cluster, and the GTM and pooler
+ * latencies seen meanwhile.
+ */
+static void
+printClusterReport(NodeStats *before, int nbefore)
+{
+    PGconn       *con;
+    NodeStats  *after;
+    int            nafter;
+    int            i,
+                j,
+                k;
+
+    if ((con = doConnect()) == NULL)
+        exit(1);
+
+    /* give the statistics collector time to count the last transactions */
+    pg_usleep(1000000L);
+
+    after = getNodeStats(con, &nafter);
+
+    printf("per-node statistics:\n");
+    printf("  %-20s %4s", "node", "type");
+    for (j = 0; j < NODE_STAT_COLS; j++)
+        printf(" %14s", node_stat_names[j]);
+    printf("\n");
+
+    for (i = 0; i < nafter; i++)
+    {
+        NodeStats  *prev = NULL;
+
+        for (k = 0; k < nbefore; k++)
+        {
+            if (strcmp(before[k].name, after[i].name) == 0)
+            {
+                prev = &before[k];
+                break;
+            }
+        }
+
+        printf("  %-20s %4c", after[i].name, after[i].type);
+        for (j = 0; j < NODE_STAT_COLS; j++)
+        {
+            char        buf[32];
+
+            snprintf(buf, sizeof(buf), INT64_FORMAT,
+                     after[i].counters[j] - (prev ? prev->counters[j] : 0));
+            printf(" %14s", buf);
+        }
+        printf("\n");
+    }
+
+    printReportQuery(con, "GTM latency (us)", GTM_LATENCY_QUERY);
+    printReportQuery(con, "pooler latency (us)", POOLER_LATENCY_QUERY);
+
+    pg_free(after);
+    PQfinish(con);
+}
+#endif
+
 
 int
 main(int argc, char **argv)
@@ -3758,6 +4211,12 @@ main(int argc, char **argv)
         {"aggregate-interval", required_argument, NULL, 5},
         {"progress-timestamp", no_argument, NULL, 6},
         {"log-prefix", required_argument, NULL, 7},
+#ifdef PGXC
+        {"init-jobs", required_argument, NULL, 8},
+        {"shard", no_argument, NULL, 9},
+        {"cluster-report", no_argument, NULL, 10},
+        {"coordinators", required_argument, NULL, 11},
+#endif
         {NULL, 0, NULL, 0}
     };
 
@@ -3797,6 +4256,10 @@ main(int argc, char **argv)
     PGconn       *con;
     PGresult   *res;
     char       *env;
+#ifdef PGXC
+    NodeStats  *before_nodes = NULL;
+    int            nbefore_nodes = 0;
+#endif
 
     progname = get_progname(argv[0]);
 
@@ -4120,6 +4583,29 @@ main(int argc, char **argv)
                 benchmarking_option_set = true;
                 logfile_prefix = pg_strdup(optarg);
                 break;
+#ifdef PGXC
+            case 8:
+                initialization_option_set = true;
+                init_jobs = atoi(optarg);
+                if (init_jobs <= 0 || init_jobs > MAXCLIENTS)
+                {
+                    fprintf(stderr, "invalid number of init jobs: \"%s\"\n",
+                            optarg);
+                    exit(1);
+                }
+                break;
+            case 9:
+                initialization_option_set = true;
+                use_shard = true;
+                break;
+            case 10:
+                benchmarking_option_set = true;
+                cluster_report = true;
+                break;
+            case 11:
+                parseCoordinators(optarg);
+                break;
+#endif
             default:
                 fprintf(stderr, _("Try \"%s --help\" for more information.\n"), progname);
                 exit(1);
@@ -4399,6 +4885,19 @@ main(int argc, char **argv)
             fprintf(stderr, "end.\n");
         }
     }
+
+#ifdef PGXC
+    if (cluster_report)
+    {
+        before_nodes = getNodeStats(con, &nbefore_nodes);
+
+        /* GTM latencies are only kept in total, start them over */
+        res = PQexec(con, "select count(*) from pg_gtm_latency_statistics(true)");
+        if (PQresultStatus(res) != PGRES_TUPLES_OK)
+            fprintf(stderr, "%s", PQerrorMessage(con));
+        PQclear(res);
+    }
+#endif
     PQfinish(con);
 
     /* set random seed */
@@ -4422,6 +4921,7 @@ main(int argc, char **argv)
         thread->random_state[2] = random();
         thread->logfile = NULL; /* filled in later */
         thread->latency_late = 0;
+        thread->latency_hist = (int64 *) pg_malloc0(sizeof(int64) * LATENCY_HIST_BUCKETS);
         initStats(&thread->stats, 0);
 
         nclients_dealt += thread->nstate;
@@ -4517,6 +5017,11 @@ main(int argc, char **argv)
     INSTR_TIME_SUBTRACT(total_time, start_time);
     printResults(threads, &stats, total_time, conn_total_time, latency_late);
 
+#ifdef PGXC
+    if (cluster_report)
+        printClusterReport(before_nodes, nbefore_nodes);
+#endif
+
     return 0;
 }
 
@@ -4578,7 +5083,7 @@ threadRun(void *arg)
         /* make connections to the database */
         for (i = 0; i < nstate; i++)
         {
-            if ((state[i].con = doConnect()) == NULL)
+            if ((state[i].con = doConnectClient(state[i].id)) == NULL)
                 goto done;
         }
     }
@@ -249,12 +249,27 @@ const PGLZ_Strategy *const PGLZ_strategy_always = &strategy_always_data;
 static int16 hist_start[PGLZ_MAX_HISTORY_LISTS];
 static PGLZ_HistEntry hist_entries[PGLZ_HISTORY_SIZE + 1];
 
+/*
+ * Work arrays supplied by the caller of pglz_compress_workspace(), so that
+ * several threads can compress at the same time.
+ */
+struct PGLZ_Workspace
+{
+    int16        hist_start[PGLZ_MAX_HISTORY_LISTS];
+    PGLZ_HistEntry hist_entries[PGLZ_HISTORY_SIZE + 1];
+};
+
 /*
  * Element 0 in hist_entries is unused, and means 'invalid'. Likewise,
  * INVALID_ENTRY_PTR in next/prev pointers mean 'invalid'.
  */
 #define INVALID_ENTRY            0
-#define INVALID_ENTRY_PTR        (&hist_entries[INVALID_ENTRY])
+#define INVALID_ENTRY_PTR(_he)    (&(_he)[INVALID_ENTRY])
+
+static int32 pglz_compress_internal(const char *source, int32 slen,
+                                   char *dest, const PGLZ_Strategy *strategy,
+                                   int16 *hist_start,
+                                   PGLZ_HistEntry *hist_entries);
 
 /* ----------
  * pglz_hist_idx -
@@ -390,7 +405,8 @@ do { \
  * ----------
  */
 static inline int
-pglz_find_match(int16 *hstart, const char *input, const char *end,
+pglz_find_match(int16 *hstart, PGLZ_HistEntry *hentries,
+                const char *input, const char *end,
                 int *lenp, int *offp, int good_match, int good_drop, int mask)
 {// #lizard forgives
     PGLZ_HistEntry *hent;
@@ -402,8 +418,8 @@ pglz_find_match(int16 *hstart, const char *input, const char *end,
      * Traverse the linked history list until a good enough match is found.
      */
     hentno = hstart[pglz_hist_idx(input, end, mask)];
-    hent = &hist_entries[hentno];
-    while (hent != INVALID_ENTRY_PTR)
+    hent = &hentries[hentno];
+    while (hent != INVALID_ENTRY_PTR(hentries))
     {
         const char *ip = input;
         const char *hp = hent->pos;
@@ -469,7 +485,7 @@ pglz_find_match(int16 *hstart, const char *input, const char *end,
          * Be happy with lesser good matches the more entries we visited. But
          * no point in doing calculation if we're at end of list.
          */
-        if (hent != INVALID_ENTRY_PTR)
+        if (hent != INVALID_ENTRY_PTR(hentries))
         {
             if (len >= good_match)
                 break;
@@ -502,6 +518,42 @@ pglz_find_match(int16 *hstart, const char *input, const char *end,
 int32
 pglz_compress(const char *source, int32 slen, char *dest,
               const PGLZ_Strategy *strategy)
+{
+    return pglz_compress_internal(source, slen, dest, strategy,
+                                  hist_start, hist_entries);
+}
+
+/* ----------
+ * pglz_workspace_size -
+ *
+ *        Returns the size of the memory to pass to pglz_compress_workspace.
+ * ----------
+ */
+size_t
+pglz_workspace_size(void)
+{
+    return sizeof(PGLZ_Workspace);
+}
+
+/* ----------
+ * pglz_compress_workspace -
+ *
+ *        Like pglz_compress, but uses the caller's work arrays rather than
+ *        the static ones, which makes it safe to call from threads.
+ * ----------
+ */
+int32
+pglz_compress_workspace(const char *source, int32 slen, char *dest,
+                        const PGLZ_Strategy *strategy, PGLZ_Workspace *ws)
+{
+    return pglz_compress_internal(source, slen, dest, strategy,
+                                  ws->hist_start, ws->hist_entries);
+}
+
+static int32
+pglz_compress_internal(const char *source, int32 slen, char *dest,
+                       const PGLZ_Strategy *strategy,
+                       int16 *hist_start, PGLZ_HistEntry *hist_entries)
 {// #lizard forgives
     unsigned char *bp = (unsigned char *) dest;
     unsigned char *bstart = bp;
@@ -624,7 +676,7 @@ pglz_compress(const char *source, int32 slen, char *dest,
         /*
          * Try to find a match in the history
          */
-        if (pglz_find_match(hist_start, dp, dend, &match_len,
+        if (pglz_find_match(hist_start, hist_entries, dp, dend, &match_len,
                             &match_off, good_match, good_drop, mask))
         {
             /*
@@ -428,6 +428,17 @@ break;
                 result->gr_status = GTM_RESULT_ERROR;
                 break;
             }
+            /*
+             * The read-only flag is optional as for TXN_BEGIN_GETGTS_RESULT,
+             * but a proxy may have further responses buffered behind this
+             * one, so go by the message length rather than EOF.
+             */
+            result->gr_resdata.grd_gts.gtm_readonly = false;
+            if (result->gr_msglen > sizeof(GTM_Timestamp) &&
+                gtmpqGetc(&result->gr_resdata.grd_gts.gtm_readonly, conn) == EOF)
+            {
+                result->gr_status = GTM_RESULT_ERROR;
+            }
             break;
 
 
@@ -1078,6 +1089,77 @@ result->gr_status = GTM_RESULT_ERROR;
                 }
             }
 
+            if (result->gr_status != GTM_RESULT_OK)
+                break;
+
+            /* replication progress, only sent by newer GTMs */
+            result->gr_resdata.statistic_result.has_xlog_stat = false;
+            result->gr_resdata.statistic_result.standby_count = 0;
+            if (result->gr_msglen > 2 * sizeof(int64) + 2 * sizeof(int32) +
+                                    CMD_STATISTICS_TYPE_COUNT * 4 * sizeof(int32))
+            {
+                GTM_StatisticsResult *stat = &result->gr_resdata.statistic_result;
+                int standby_count;
+                int is_standby;
+
+                if (gtmpqGetInt(&is_standby, sizeof(int32), conn) ||
+                    gtmpqGetInt64((int64 *) &stat->write_ptr, conn) ||
+                    gtmpqGetInt64((int64 *) &stat->flush_ptr, conn) ||
+                    gtmpqGetInt64((int64 *) &stat->apply_ptr, conn) ||
+                    gtmpqGetInt(&standby_count, sizeof(int32), conn))
+                {
+                    result->gr_status = GTM_RESULT_ERROR;
+                    break;
+                }
+                stat->is_standby = is_standby != 0;
+
+                for (i = 0; i < standby_count; i++)
+                {
+                    GTM_StandbyStatItem item;
+                    int                 namelen;
+
+                    if (gtmpqGetInt(&namelen, sizeof(int32), conn) ||
+                        namelen <= 0 || namelen > GTM_STAT_NAME_LEN ||
+                        gtmpqGetnchar(item.application_name, namelen, conn) ||
+                        gtmpqGetInt64((int64 *) &item.write_ptr, conn) ||
+                        gtmpqGetInt64((int64 *) &item.flush_ptr, conn) ||
+                        gtmpqGetInt64((int64 *) &item.replay_ptr, conn))
+                    {
+                        result->gr_status = GTM_RESULT_ERROR;
+                        break;
+                    }
+                    item.application_name[namelen - 1] = '\0';
+
+                    if (stat->standby_count < GTM_STAT_MAX_STANDBYS)
+                        stat->standbys[stat->standby_count++] = item;
+                }
+                stat->has_xlog_stat = (result->gr_status == GTM_RESULT_OK);
+            }
+
+            break;
+        }
+        case MSG_GET_GTM_LATENCY_STATISTICS_RESULT:
+        {
+            if (result->grd_latency.threads)
+            {
+                free(result->grd_latency.threads);
+                result->grd_latency.threads = NULL;
+            }
+
+            if (gtmpqGetInt(&result->grd_latency.count, sizeof(int32), conn))
+            {
+                result->gr_status = GTM_RESULT_ERROR;
+                break;
+            }
+
+            result->grd_latency.threads = (GTM_ThreadLatencyItem *)
+                    malloc(sizeof(GTM_ThreadLatencyItem) * (result->grd_latency.count + 1));
+            if (gtmpqGetnchar((char *) result->grd_latency.threads,
+                              sizeof(GTM_ThreadLatencyItem) * result->grd_latency.count, conn))
+            {
+                result->gr_status = GTM_RESULT_ERROR;
+                break;
+            }
             break;
         }
 	    case MSG_GET_GTM_ERRORLOG_RESULT:
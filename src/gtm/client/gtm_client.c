@@ -470,13 +470,15 @@ send_failed:
 }
 
 
-Get_GTS_Result
-get_global_timestamp(GTM_Conn *conn)
-{// #lizard forgives
-    GTM_Result    *res = NULL;
-    Get_GTS_Result ret = {InvalidGlobalTimestamp,false};
-    time_t finish_time;
-    
+/*
+ * Send a global timestamp request without waiting for the reply, so that
+ * the caller can do other work while GTM answers. The reply must be read
+ * with get_global_timestamp_receive() before anything else is sent over the
+ * connection, GTM answers the requests of a connection in order.
+ */
+int
+get_global_timestamp_send(GTM_Conn *conn)
+{
      /* Start the message. */
     if (gtmpqPutMsgStart('C', true, conn) ||
         gtmpqPutInt(MSG_GETGTS, sizeof (GTM_MessageType), conn))
@@ -490,6 +492,21 @@ get_global_timestamp(GTM_Conn *conn)
     if (gtmpqFlush(conn))
         goto send_failed;
 
+    return 0;
+
+send_failed:
+    conn->result = makeEmptyResultIfIsNull(conn->result);
+    conn->result->gr_status = GTM_RESULT_COMM_ERROR;
+    return -1;
+}
+
+Get_GTS_Result
+get_global_timestamp_receive(GTM_Conn *conn)
+{
+    GTM_Result    *res = NULL;
+    Get_GTS_Result ret = {InvalidGlobalTimestamp,false};
+    time_t finish_time;
+
     finish_time = time(NULL) + CLIENT_GTM_TIMEOUT;
     if (gtmpqWaitTimed(true, false, conn, finish_time) ||
         gtmpqReadData(conn) < 0)
@@ -502,19 +519,26 @@ get_global_timestamp(GTM_Conn *conn)
     {
         ret.gts = res->gr_resdata.grd_gts.grd_gts;
         ret.gtm_readonly = res->gr_resdata.grd_gts.gtm_readonly;
-        
-        return ret;
     }
-    else
-        return ret;
+    return ret;
 
 receive_failed:
-send_failed:
     conn->result = makeEmptyResultIfIsNull(conn->result);
     conn->result->gr_status = GTM_RESULT_COMM_ERROR;
     return ret;
 }
 
+Get_GTS_Result
+get_global_timestamp(GTM_Conn *conn)
+{
+    Get_GTS_Result ret = {InvalidGlobalTimestamp,false};
+
+    if (get_global_timestamp_send(conn))
+        return ret;
+
+    return get_global_timestamp_receive(conn);
+}
+
 
 int
 check_gtm_status(GTM_Conn *conn, int *status, GTM_Timestamp *master,XLogRecPtr *master_ptr,int *standby_count,int **slave_is_sync, GTM_Timestamp **standby
@@ -625,6 +649,58 @@ send_failed:
     return GTM_RESULT_ERROR;
 }
 
+/*
+ * to get the latency histograms and ready connection counts of GTM worker
+ * threads, returns the number of threads or -1 on failure
+ */
+int
+get_gtm_latency_statistics(GTM_Conn *conn, int clear_flag, int timeout_seconds, GTM_ThreadLatencyItem** threads)
+{
+    GTM_Result *res = NULL;
+    time_t finish_time;
+
+    /* Start the message. */
+    if (gtmpqPutMsgStart('C', true, conn) ||
+        gtmpqPutInt(MSG_GET_LATENCY_STATISTICS, sizeof (GTM_MessageType), conn))
+        goto send_failed;
+
+    if (gtmpqPutInt(clear_flag,sizeof(int),conn))
+        goto send_failed;
+
+    /* Finish the message. */
+    if (gtmpqPutMsgEnd(conn))
+        goto send_failed;
+
+    /* Flush to ensure backend gets it. */
+    if (gtmpqFlush(conn))
+        goto send_failed;
+
+    /* add two seconds to allow extra wait */
+    finish_time = time(NULL) + timeout_seconds + 2;
+    if (gtmpqWaitTimed(true, false, conn, finish_time) ||
+        gtmpqReadData(conn) < 0)
+        goto receive_failed;
+
+    if ((res = GTMPQgetResult(conn)) == NULL)
+        goto receive_failed;
+
+    if (GTM_RESULT_OK == res->gr_status)
+    {
+        *threads = res->grd_latency.threads;
+        return res->grd_latency.count;
+    }
+    else
+    {
+        return -1;
+    }
+
+receive_failed:
+send_failed:
+    conn->result = makeEmptyResultIfIsNull(conn->result);
+    conn->result->gr_status = GTM_RESULT_COMM_ERROR;
+    return -1;
+}
+
 /*
  * to get gtm error log
  */
@@ -422,8 +422,12 @@ gtm_get_transactions_size(GTM_Transactions *data)
 
     len += sizeof(int32); /* txn_count */
 
+    /* only the slots in use are serialized */
     for (i = 0; i < GTM_MAX_GLOBAL_TRANSACTIONS; i++)
     {
+        if (data->gt_transactions_array[i].gti_in_use != TRUE)
+            continue;
+
         len += sizeof(size_t); /* length */
         len += gtm_get_transactioninfo_size(&data->gt_transactions_array[i]);
     }
@@ -514,7 +518,6 @@ gtm_serialize_transactions(GTM_Transactions *data, char *buf, size_t buflen)
      */
     for (i = 0; i < GTM_MAX_GLOBAL_TRANSACTIONS; i++)
     {
-        char *buf2;
         size_t buflen2, len2;
 
         /*
@@ -529,17 +532,14 @@ gtm_serialize_transactions(GTM_Transactions *data, char *buf, size_t buflen)
         memcpy(buf + len, &buflen2, sizeof(size_t));
         len += sizeof(size_t);
 
-        buf2 = (char *)malloc(buflen2);
-
+        /*
+         * Store a serialized GTM_TransactionInfo structure, straight into
+         * the output buffer whose size was checked above.
+         */
         len2 = gtm_serialize_transactioninfo(&data->gt_transactions_array[i],
-                          buf2,
+                          buf + len,
                           buflen2);
-
-        /* store a serialized GTM_TransactionInfo structure. */
-        memcpy(buf + len, buf2, len2);
         len += len2;
-
-        free(buf2);
     }
 
     /* NOTE: nothing to be done for gt_TransArrayLock */
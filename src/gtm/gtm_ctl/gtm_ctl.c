@@ -1107,6 +1107,82 @@ do_status(void)
 }
 
 
+/*
+ * Print the latency histograms of the GTM worker threads, merged over all
+ * threads, as percentiles per command group.
+ */
+static void
+print_gtm_latency(GTM_Conn *gtm_conn)
+{
+    int    i;
+    int    j;
+    int    k;
+    int    nthreads;
+    GTM_ThreadLatencyItem *threads = NULL;
+    static char* latency_name_tab[LATENCY_CMD_COUNT] = {
+        "TXN_BEGIN",
+        "GET_GTS",
+        "SNAPSHOT",
+        "TXN_COMMIT",
+        "SEQUENCE",
+        "OTHER"
+    };
+
+    nthreads = get_gtm_latency_statistics(gtm_conn, clear_flag, wait_seconds, &threads);
+    if (nthreads < 0)
+    {
+        /* older GTMs do not know the command */
+        return;
+    }
+
+    printf(_("latency info:\n"));
+    for (i = 0; i < nthreads; i++)
+    {
+        printf(_("thread %u: ready connections last: %u, max: %u\n"),
+               threads[i].thread_id, threads[i].last_ready, threads[i].max_ready);
+    }
+
+    for (j = 0; j < LATENCY_CMD_COUNT; j++)
+    {
+        uint64 buckets[GTM_LATENCY_BUCKETS];
+        uint64 total = 0;
+        uint64 seen = 0;
+        int    p50 = -1;
+        int    p99 = -1;
+        int    max = 0;
+
+        memset(buckets, 0, sizeof(buckets));
+        for (i = 0; i < nthreads; i++)
+        {
+            for (k = 0; k < GTM_LATENCY_BUCKETS; k++)
+            {
+                buckets[k] += threads[i].latency[j][k];
+                total += threads[i].latency[j][k];
+            }
+        }
+
+        if (total == 0)
+            continue;
+
+        for (k = 0; k < GTM_LATENCY_BUCKETS; k++)
+        {
+            seen += buckets[k];
+            if (p50 < 0 && seen * 2 >= total)
+                p50 = k;
+            if (p99 < 0 && seen * 100 >= total * 99)
+                p99 = k;
+            if (buckets[k])
+                max = k;
+        }
+
+        /* bucket k holds latencies below 2^k us */
+        printf(_("%s latency: requests: " UINT64_FORMAT ", p50 < %lu(us), p99 < %lu(us), max < %lu(us)%s\n"),
+               latency_name_tab[j], total,
+               1UL << p50, 1UL << p99, 1UL << max,
+               max == GTM_LATENCY_BUCKETS - 1 ? " or more" : "");
+    }
+}
+
 static void
 do_stat(void)
 {
@@ -1189,6 +1265,31 @@ do_stat(void)
                 printf(_("requests per minute: %u\n"), calcu_result[i]);
             }
         }
+
+        if (result->has_xlog_stat)
+        {
+            printf(_("xlog info:\n"));
+            printf(_("role: %s\n"), result->is_standby ? "standby" : "master");
+            printf(_("write pos: %X/%X\n"), (uint32) (result->write_ptr >> 32), (uint32) result->write_ptr);
+            printf(_("flush pos: %X/%X\n"), (uint32) (result->flush_ptr >> 32), (uint32) result->flush_ptr);
+            printf(_("apply pos: %X/%X\n"), (uint32) (result->apply_ptr >> 32), (uint32) result->apply_ptr);
+
+            for (i = 0; i < result->standby_count; i++)
+            {
+                GTM_StandbyStatItem *standby = &result->standbys[i];
+                uint64 lag = 0;
+
+                if (result->flush_ptr > standby->replay_ptr)
+                    lag = result->flush_ptr - standby->replay_ptr;
+
+                printf(_("standby %s: write pos: %X/%X, flush pos: %X/%X, replay pos: %X/%X, replay lag: " UINT64_FORMAT "(bytes)\n"),
+                       standby->application_name,
+                       (uint32) (standby->write_ptr >> 32), (uint32) standby->write_ptr,
+                       (uint32) (standby->flush_ptr >> 32), (uint32) standby->flush_ptr,
+                       (uint32) (standby->replay_ptr >> 32), (uint32) standby->replay_ptr,
+                       lag);
+            }
+        }
     }
     else
     {
@@ -1196,6 +1297,9 @@ do_stat(void)
                progname);
     }
 
+    if (!ret)
+        print_gtm_latency(gtm_conn);
+
     disconnect_gtm(gtm_conn);
     return;
 }
@@ -30,6 +30,7 @@
 #include "gtm/gtm_opt_tables.h"
 #include "gtm/gtm_opt.h"
 #include "gtm/gtm_standby.h"
+#include "gtm/gtm_seq.h"
 
 
 #define CONFIG_FILENAME "gtm.conf"
@@ -59,8 +60,12 @@ extern int            scale_factor_threads;
 extern int            worker_thread_number;
 #ifdef __TBASE__
 extern bool    enable_gtm_sequence_debug;
+extern int      gtm_sequence_reserve_count;
 extern int      wal_writer_delay;
+extern int      wal_commit_delay;
 extern int      checkpoint_interval;
+extern int      checkpoint_flush_after;
+extern int      checkpoint_write_delay;
 extern char     *archive_command;
 extern bool     archive_mode;
 extern int      max_reserved_wal_number;
@@ -300,6 +305,19 @@ struct config_int ConfigureNamesInt[] =
 		2, 0, INT_MAX, NULL, NULL,
         0, NULL
     },            
+#ifdef __TBASE__
+    {
+        {
+            GTM_OPTNAME_SEQUENCE_RESERVE_COUNT, GTMC_SIGHUP,
+            gettext_noop("Number of sequence values made durable ahead of the ones handed out."),
+            NULL,
+            0
+        },
+        &gtm_sequence_reserve_count,
+		SEQ_RESERVE_COUNT, 1, 1000000, NULL, NULL,
+        0, NULL
+    },
+#endif
 #ifdef __XLOG__
     {
         {
@@ -312,6 +330,17 @@ struct config_int ConfigureNamesInt[] =
 		100, 10, INT_MAX, NULL, NULL,
         0, NULL
     },
+    {
+        {
+			GTM_OPTNAME_WAL_COMMIT_DELAY, GTMC_SIGHUP,
+            gettext_noop("Microseconds an xlog flush waits for concurrent flushes to join it."),
+            NULL,
+            0
+        },
+        &wal_commit_delay,
+		0, 0, 100000, NULL, NULL,
+        0, NULL
+    },
     {
         {
 			GTM_OPTNAME_CHECKPOINT_INTERVAL, GTMC_STARTUP,
@@ -323,6 +352,28 @@ struct config_int ConfigureNamesInt[] =
 		30, 1, INT_MAX, NULL, NULL,
         0, NULL
     },
+    {
+        {
+			GTM_OPTNAME_CHECKPOINT_FLUSH_AFTER, GTMC_SIGHUP,
+            gettext_noop("Kilobytes of map file a checkpoint writes before starting their writeback, 0 disables."),
+            NULL,
+            0
+        },
+        &checkpoint_flush_after,
+		256, 0, 2097152, NULL, NULL,
+        0, NULL
+    },
+    {
+        {
+			GTM_OPTNAME_CHECKPOINT_WRITE_DELAY, GTMC_SIGHUP,
+            gettext_noop("Milliseconds a checkpoint sleeps after each checkpoint_flush_after chunk."),
+            NULL,
+            0
+        },
+        &checkpoint_write_delay,
+		0, 0, 10000, NULL, NULL,
+        0, NULL
+    },
     {
         {
             GTM_OPTNAME_MAX_RESERVED_WAL_NUMBER, GTMC_STARTUP,
@@ -595,14 +595,14 @@ GTM_SeqOpen(GTM_SequenceKey seqkey,
         seqinfo->gs_store_handle = seq_handle;
         if (seqinfo->gs_reserved)
         {
-            ret = GTM_StoreReserveSeqValue(seqinfo->gs_store_handle, SEQ_RESERVE_COUNT);
+            ret = GTM_StoreReserveSeqValue(seqinfo->gs_store_handle, gtm_sequence_reserve_count);
             if (ret)
             {
                 ereport(ERROR,
                     (ERANGE,
                      errmsg("GTM_StoreReserveSeqValue for gxid:%d failed", gxid)));
             }
-            seqinfo->gs_left_reserve_seq_number = SEQ_RESERVE_COUNT;
+            seqinfo->gs_left_reserve_seq_number = gtm_sequence_reserve_count;
         }
 
         if (enable_gtm_sequence_debug)
@@ -691,14 +691,14 @@ int GTM_SeqAlter(GTM_SequenceKey seqkey,
     /* if newly start reserve the sequence value. */
     if (is_restart && seqinfo->gs_reserved)
     {
-        ret = GTM_StoreReserveSeqValue(seqinfo->gs_store_handle, SEQ_RESERVE_COUNT);
+        ret = GTM_StoreReserveSeqValue(seqinfo->gs_store_handle, gtm_sequence_reserve_count);
         if (ret)
         {
             ereport(LOG,
                     (ERANGE,
                      errmsg("GTM_SeqAlter GTM_StoreReserveSeqValue failed")));
         }
-        seqinfo->gs_left_reserve_seq_number = SEQ_RESERVE_COUNT;
+        seqinfo->gs_left_reserve_seq_number = gtm_sequence_reserve_count;
     }
 #endif
 
@@ -1209,14 +1209,14 @@ GTM_SeqSetVal(GTM_SequenceKey seqkey, char *coord_name,
 
     if (seqinfo->gs_reserved)
     {
-        ret = GTM_StoreReserveSeqValue(seqinfo->gs_store_handle, SEQ_RESERVE_COUNT);
+        ret = GTM_StoreReserveSeqValue(seqinfo->gs_store_handle, gtm_sequence_reserve_count);
         if (ret)
         {
             ereport(ERROR,
                     (ERANGE,
                      errmsg("GTM_SeqSetVal GTM_StoreReserveSeqValue failed")));
         }
-        seqinfo->gs_left_reserve_seq_number = SEQ_RESERVE_COUNT;
+        seqinfo->gs_left_reserve_seq_number = gtm_sequence_reserve_count;
     }
 #endif
 
@@ -1397,18 +1397,31 @@ GTM_SeqGetNext(GTM_SequenceKey seqkey, char *coord_name,
     
     if (seqinfo->gs_reserved)
     {
-        seqinfo->gs_left_reserve_seq_number -= used_count;
-        while (seqinfo->gs_reserved && 0 >= seqinfo->gs_left_reserve_seq_number)
+        /* a range request can consume far more than an int32 holds */
+        int64 left = (int64) seqinfo->gs_left_reserve_seq_number - (int64) used_count;
+
+        /*
+         * Move the high-water mark past what this call consumed plus a full
+         * reservation in one durable write, instead of one write per reserve
+         * chunk.  Only a shortfall beyond PG_INT32_MAX needs a second write.
+         */
+        while (0 >= left)
         {
-            ret = GTM_StoreReserveSeqValue(seqinfo->gs_store_handle, SEQ_RESERVE_COUNT);
+            int64 reserve = (int64) gtm_sequence_reserve_count - left;
+
+            if (reserve > PG_INT32_MAX)
+                reserve = PG_INT32_MAX;
+
+            ret = GTM_StoreReserveSeqValue(seqinfo->gs_store_handle, (int32) reserve);
             if (ret)
             {
                 ereport(ERROR,
                         (ERANGE,
                          errmsg("GTM_SeqGetNext GTM_StoreReserveSeqValue failed")));
             }
-            seqinfo->gs_left_reserve_seq_number += SEQ_RESERVE_COUNT;
+            left += reserve;
         }
+        seqinfo->gs_left_reserve_seq_number = (int32) left;
     }    
 #endif
 
@@ -1548,14 +1561,14 @@ GTM_SeqReset(GTM_SequenceKey seqkey)
     /* if newly start reserve the sequence value. */
     if (seqinfo->gs_reserved)
     {
-        ret = GTM_StoreReserveSeqValue(seqinfo->gs_store_handle, SEQ_RESERVE_COUNT);
+        ret = GTM_StoreReserveSeqValue(seqinfo->gs_store_handle, gtm_sequence_reserve_count);
         if (ret)
         {
             ereport(LOG,
                     (ERANGE,
                      errmsg("GTM_SeqReset GTM_StoreReserveSeqValue failed")));
         }
-        seqinfo->gs_left_reserve_seq_number = SEQ_RESERVE_COUNT;
+        seqinfo->gs_left_reserve_seq_number = gtm_sequence_reserve_count;
     }
 #endif
 
@@ -3187,7 +3200,7 @@ static void GTM_JudgeReserve(GTM_SeqInfo *seqinfo)
         int32 ret;
         if (!SEQ_IS_ASCENDING(seqinfo))
         {
-            if ((seqinfo->gs_min_value - seqinfo->gs_max_value) >= SEQ_RESERVE_COUNT * SEQ_RESERVE_MIN_GAP)
+            if ((seqinfo->gs_min_value - seqinfo->gs_max_value) >= (GTM_Sequence) gtm_sequence_reserve_count * SEQ_RESERVE_MIN_GAP)
             {
                 seqinfo->gs_reserved                 = true;
                 seqinfo->gs_left_reserve_seq_number = 0;
@@ -3199,7 +3212,7 @@ static void GTM_JudgeReserve(GTM_SeqInfo *seqinfo)
         }
         else
         {
-            if ((seqinfo->gs_max_value - seqinfo->gs_min_value) >= SEQ_RESERVE_COUNT * SEQ_RESERVE_MIN_GAP)
+            if ((seqinfo->gs_max_value - seqinfo->gs_min_value) >= (GTM_Sequence) gtm_sequence_reserve_count * SEQ_RESERVE_MIN_GAP)
             {
                 seqinfo->gs_reserved                 = true;
                 seqinfo->gs_left_reserve_seq_number = 0;
@@ -3263,7 +3276,7 @@ GTM_FormSeqOfStore(GTM_SequenceKey seqkey)
     seqinfo->gs_store_handle = seq_handle;
     if (seqinfo->gs_reserved)
     {
-        ret = GTM_StoreReserveSeqValue(seqinfo->gs_store_handle, SEQ_RESERVE_COUNT);
+        ret = GTM_StoreReserveSeqValue(seqinfo->gs_store_handle, gtm_sequence_reserve_count);
         if (ret)
         {
             GTM_RWLockDestroy(&seqinfo->gs_lock);
@@ -3273,7 +3286,7 @@ GTM_FormSeqOfStore(GTM_SequenceKey seqkey)
                     (ERANGE,
                      errmsg("GTM_StoreReserveSeqValue failed")));
         }
-        seqinfo->gs_left_reserve_seq_number = SEQ_RESERVE_COUNT;
+        seqinfo->gs_left_reserve_seq_number = gtm_sequence_reserve_count;
     }
     MemoryContextSwitchTo(old_memorycontext);
     
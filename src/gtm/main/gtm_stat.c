@@ -18,8 +18,12 @@
 #include "gtm/gtm_msg.h"
 #include "gtm/libpq.h"
 #include "gtm/pqformat.h"
+#include "gtm/gtm_xlog.h"
+#include "gtm/standby_utils.h"
 #include <sys/timeb.h>
 
+extern int max_wal_sender;
+
 extern int32  GTM_StoreGetUsedSeq(void);
 extern int32  GTM_StoreGetUsedTxn(void);
 
@@ -50,6 +54,9 @@ GTM_InitStatisticsInfo(GTM_WorkerStatistics *stat_handle)
         pg_atomic_init_u32(&stat_handle->cmd_statistics[i].max_costtime, 0);
         pg_atomic_init_u32(&stat_handle->cmd_statistics[i].min_costtime, PG_UINT32_MAX);
     }
+    memset(stat_handle->latency, 0, sizeof(stat_handle->latency));
+    stat_handle->last_ready = 0;
+    stat_handle->max_ready = 0;
 }
 
 /*
@@ -68,6 +75,16 @@ GTM_ResetStatisticsInfo(GTM_WorkerStatistics *stat_handle)
     }
 }
 
+/*
+ * Reset the latency histograms of a worker
+ */
+static void
+GTM_ResetLatencyInfo(GTM_WorkerStatistics *stat_handle)
+{
+    memset(stat_handle->latency, 0, sizeof(stat_handle->latency));
+    stat_handle->max_ready = 0;
+}
+
 /*
  * Init the statistics item
  */
@@ -148,6 +165,73 @@ GTM_UpdateStatistics(GTM_WorkerStatistics* stat_handle, GTM_MessageType mtype, u
     }
 }
 
+/*
+ * Add a command to the latency histogram of its group
+ */
+void
+GTM_UpdateLatency(GTM_WorkerStatistics* stat_handle, GTM_MessageType mtype, uint64 costtime_us)
+{
+    GTM_LatencyCmd mCmd;
+    int            bucket = 0;
+
+    switch (mtype)
+    {
+        case MSG_TXN_BEGIN:
+        case MSG_TXN_BEGIN_GETGXID:
+        case MSG_TXN_BEGIN_GETGXID_MULTI:
+        case MSG_TXN_BEGIN_GETGXID_AUTOVACUUM:
+        case MSG_TXN_START_PREPARED:
+            mCmd = LATENCY_TXN_BEGIN;
+            break;
+        case MSG_GETGTS:
+        case MSG_GETGTS_MULTI:
+            mCmd = LATENCY_GETGTS;
+            break;
+        case MSG_SNAPSHOT_GET:
+        case MSG_SNAPSHOT_GET_MULTI:
+            mCmd = LATENCY_SNAPSHOT;
+            break;
+        case MSG_TXN_PREPARE:
+        case MSG_TXN_COMMIT:
+        case MSG_TXN_COMMIT_MULTI:
+        case MSG_TXN_COMMIT_PREPARED:
+            mCmd = LATENCY_TXN_COMMIT;
+            break;
+        case MSG_SEQUENCE_GET_CURRENT:
+        case MSG_SEQUENCE_GET_NEXT:
+        case MSG_SEQUENCE_GET_LAST:
+        case MSG_SEQUENCE_SET_VAL:
+            mCmd = LATENCY_SEQUENCE;
+            break;
+        default:
+            mCmd = LATENCY_OTHER;
+            break;
+    }
+
+    while (costtime_us > 0 && bucket < GTM_LATENCY_BUCKETS - 1)
+    {
+        costtime_us >>= 1;
+        bucket++;
+    }
+
+    stat_handle->latency[mCmd][bucket]++;
+}
+
+/*
+ * Remember how many connections one epoll wakeup of the worker returned,
+ * a lasting high count means the thread cannot keep up with its clients.
+ */
+void
+GTM_UpdateReadyCount(GTM_WorkerStatistics* stat_handle, int nready)
+{
+    if (nready < 0)
+        return;
+
+    stat_handle->last_ready = nready;
+    if (stat_handle->max_ready < nready)
+        stat_handle->max_ready = nready;
+}
+
 /*
  * Combine the statistics of each thread and calculate the result
  */
@@ -222,6 +306,67 @@ GTM_GetMergeResult(int clear_flag, pg_time_t *stat_start_time, pg_time_t *stat_e
     SpinLockRelease(&GTMStatistics.lock);
 }
 
+/*
+ * Append replication progress to a statistics result, so that lag can be
+ * watched from the master as well as from each standby.
+ */
+static void
+GTM_SendXLogStatistics(StringInfo buf)
+{
+    int        i;
+    int        count = 0;
+    int        namelen;
+    GTM_StandbyStatItem *items;
+
+    items = (GTM_StandbyStatItem *) palloc(Max(max_wal_sender, 1) * sizeof(GTM_StandbyStatItem));
+
+    pq_sendint(buf, Recovery_IsStandby() ? 1 : 0, sizeof(int32));
+    if (Recovery_IsStandby())
+    {
+        pq_sendint64(buf, GetStandbyWriteBuffPos());
+        pq_sendint64(buf, GetXLogFlushRecPtr());
+        pq_sendint64(buf, GetStandbyApplyPos());
+    }
+    else
+    {
+        XLogRecPtr flush = GetXLogFlushRecPtr();
+
+        pq_sendint64(buf, flush);
+        pq_sendint64(buf, flush);
+        pq_sendint64(buf, flush);
+
+        for (i = 0; i < max_wal_sender; i++)
+        {
+            GTM_MutexLockAcquire(&g_StandbyReplication[i].lock);
+            if (g_StandbyReplication[i].is_use)
+            {
+                strlcpy(items[count].application_name, g_StandbyReplication[i].application_name, GTM_STAT_NAME_LEN);
+
+                GTM_MutexLockAcquire(&g_StandbyReplication[i].pos_status_lck);
+                items[count].write_ptr  = g_StandbyReplication[i].write_ptr;
+                items[count].flush_ptr  = g_StandbyReplication[i].flush_ptr;
+                items[count].replay_ptr = g_StandbyReplication[i].replay_ptr;
+                GTM_MutexLockRelease(&g_StandbyReplication[i].pos_status_lck);
+                count++;
+            }
+            GTM_MutexLockRelease(&g_StandbyReplication[i].lock);
+        }
+    }
+
+    pq_sendint(buf, count, sizeof(int32));
+    for (i = 0; i < count; i++)
+    {
+        namelen = strlen(items[i].application_name) + 1;
+        pq_sendint(buf, namelen, sizeof(int32));
+        pq_sendbytes(buf, items[i].application_name, namelen);
+        pq_sendint64(buf, items[i].write_ptr);
+        pq_sendint64(buf, items[i].flush_ptr);
+        pq_sendint64(buf, items[i].replay_ptr);
+    }
+
+    pfree(items);
+}
+
 /*
  * Process MSG_GET_STATISTICS message
  */
@@ -266,6 +411,79 @@ ProcessGetStatisticsCommand(Port *myport, StringInfo message)
         pq_sendint(&buf, result_info[i].min_costtime, sizeof(int32));
     }
 
+    GTM_SendXLogStatistics(&buf);
+
+    pq_endmessage(myport, &buf);
+
+    if (myport->remote_type != GTM_NODE_GTM_PROXY)
+    {
+        /* Don't flush to the backup because this does not change the internal status */
+        pq_flush(myport);
+    }
+}
+
+/*
+ * Process MSG_GET_LATENCY_STATISTICS message
+ */
+void
+ProcessGetLatencyStatisticsCommand(Port *myport, StringInfo message)
+{
+    int clear_flag = 0;
+    int count = 0;
+    uint32 i = 0;
+    StringInfoData buf;
+    GTM_ThreadLatencyItem *items;
+
+    clear_flag = pq_getmsgint(message, sizeof (int));
+    pq_getmsgend(message);
+
+    SpinLockAcquire(&GTMStatistics.lock);
+    GTM_RWLockAcquire(&GTMThreads->gt_lock, GTM_LOCKMODE_READ);
+
+    items = (GTM_ThreadLatencyItem *) palloc0(GTMThreads->gt_array_size * sizeof(GTM_ThreadLatencyItem));
+    for (i = 0; i < GTMThreads->gt_array_size; i++)
+    {
+        GTM_ThreadInfo *thrinfo = GTMThreads->gt_threads[i];
+        GTM_WorkerStatistics *stat_handle;
+
+        if (NULL == thrinfo || false == thrinfo->thr_epoll_ok || NULL == thrinfo->stat_handle)
+        {
+            continue;
+        }
+
+        stat_handle = thrinfo->stat_handle;
+        items[count].thread_id = i;
+        items[count].last_ready = stat_handle->last_ready;
+        items[count].max_ready = stat_handle->max_ready;
+        memcpy(items[count].latency, stat_handle->latency, sizeof(items[count].latency));
+        count++;
+
+        if (clear_flag)
+        {
+            GTM_ResetLatencyInfo(stat_handle);
+        }
+    }
+
+    GTM_RWLockRelease(&GTMThreads->gt_lock);
+    SpinLockRelease(&GTMStatistics.lock);
+
+    pq_beginmessage(&buf, 'S');
+    pq_sendint(&buf, MSG_GET_GTM_LATENCY_STATISTICS_RESULT, 4);
+
+    if (myport->remote_type == GTM_NODE_GTM_PROXY)
+    {
+        GTM_ProxyMsgHeader proxyhdr;
+        proxyhdr.ph_conid = myport->conn_id;
+        pq_sendbytes(&buf, (char *)&proxyhdr, sizeof (GTM_ProxyMsgHeader));
+    }
+
+    pq_sendint(&buf, count, sizeof(int32));
+    for (i = 0; i < count; i++)
+    {
+        pq_sendbytes(&buf, (char *) &items[i], sizeof(GTM_ThreadLatencyItem));
+    }
+    pfree(items);
+
     pq_endmessage(myport, &buf);
 
     if (myport->remote_type != GTM_NODE_GTM_PROXY)
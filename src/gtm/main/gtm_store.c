@@ -152,8 +152,7 @@ static GTM_StoredSeqInfo         *g_GTM_Store_SeqInfo    = NULL;
 static GTM_StoredTransactionInfo *g_GTM_Store_TxnInfo    = NULL;
 static GTM_TransactionDebugInfo *g_GTM_TxnDebugInfo = NULL;
 static GTMDebugControlHeader    g_GTM_DebugHeader;
-static GTM_RWLock                g_GTM_Debug_Lock;
-static GTM_RWLock                g_GTM_Scan_Debug_Lock;
+static char                     *g_GTM_TxnLogRecordBuf = NULL;
 
 #ifdef __XLOG__
 GTM_TimerHandle  g_GTM_Backup_Timer;
@@ -579,8 +578,7 @@ int32 GTM_StoreMasterInit(char *data_dir)
         
         g_GTM_DebugHeader.m_txn_buffer_len = GTM_MAX_DEBUG_TXN_INFO;
         g_GTM_DebugHeader.m_txn_buffer_last = 0;
-        GTM_RWLockInit(&g_GTM_Debug_Lock);
-        GTM_RWLockInit(&g_GTM_Scan_Debug_Lock);
+        g_GTM_TxnLogRecordBuf = palloc(GTM_TXN_LOG_MAX_RECORD_LEN);
     }
     
     if (bneed_create)
@@ -2148,10 +2146,14 @@ static void GTM_StoreReserveSeqValueIntern(GTM_StoredSeqInfo *seqinfo, int32 cou
 }
 /*
  * Reserve the specific seq value, and flush the new result to disk.
+ *
+ * However many values are reserved, the new high-water mark costs a single
+ * durable write.
  */
 int32 GTM_StoreReserveSeqValue(GTMStorageHandle seq_handle, int32 value)
 {
     GTM_StoredSeqInfo        *seq_info  = NULL;
+    int32                    left       = value;
     
     if (INVALID_STORAGE_HANDLE == seq_handle || seq_handle >= GTM_MAX_SEQ_NUMBER)
     {
@@ -2159,7 +2161,11 @@ int32 GTM_StoreReserveSeqValue(GTMStorageHandle seq_handle, int32 value)
     }
 
     seq_info = GetSeqStore(seq_handle);
-    GTM_StoreReserveSeqValueIntern(seq_info, value);
+    do
+    {
+        GTM_StoreReserveSeqValueIntern(seq_info, left);
+        left -= MAX_SEQUENCE_RESERVED;
+    } while (left > 0);
     
     /* first call */
     if (!seq_info->gs_called)
@@ -2701,7 +2707,12 @@ static void GTM_PrintAndClearLogEntry(GTM_TransactionDebugInfo *gti)
 }
 
 
-int32 GTM_StoreLogTransaction(GlobalTransactionId gxid,
+/*
+ * Match a transaction trace record against the debug entries, printing an
+ * entry once all of its nodes have reported.  Only the log collector thread
+ * calls this, so the debug entries need no locking.
+ */
+static int32 GTM_StoreApplyLogTransaction(GlobalTransactionId gxid,
                                         const char *gid, 
                                         const char *node_string, 
                                         int node_count, 
@@ -2712,17 +2723,12 @@ int32 GTM_StoreLogTransaction(GlobalTransactionId gxid,
 {// #lizard forgives
     GTM_TransactionDebugInfo *gti;
 
-    elog(DEBUG1, "Store log transaction gxid %u gid %s node string %s node count %d isGlobal %d isCommit %d "
-                "prepare ts "INT64_FORMAT " commit ts "INT64_FORMAT,
-                gxid, gid, node_string, node_count, isGlobal, isCommit, prepare_ts, commit_ts);
-    GTM_RWLockAcquire(&g_GTM_Debug_Lock, GTM_LOCKMODE_WRITE);
     if(!isGlobal)
     {
         gti = GTM_SearchLogEntry(gid);
         if(NULL == gti)
         {
             elog(LOG, "no entry found for gid %s", gid);
-            GTM_RWLockRelease(&g_GTM_Debug_Lock);
             return GTM_STORE_ERROR;
         }
         gti->complete_node_count++;
@@ -2739,7 +2745,7 @@ int32 GTM_StoreLogTransaction(GlobalTransactionId gxid,
         gti->node_list_tail->next = NULL;
         if(node_string)
         {
-            strcpy(gti->node_list_tail->node_name, node_string);
+            snprintf(gti->node_list_tail->node_name, GTM_MAX_SESSION_ID_LEN, "%s", node_string);
         }
         else
         {
@@ -2764,14 +2770,12 @@ int32 GTM_StoreLogTransaction(GlobalTransactionId gxid,
             if(isCommit)
             {
                 elog(LOG, "existing entry found for global commit gid %s", gid);
-                GTM_RWLockRelease(&g_GTM_Debug_Lock);
                 return GTM_STORE_ERROR;
             }
             else //abort condition 
             {
                 gti->isCommit = false;
                 GTM_PrintAndClearLogEntry(gti);
-                GTM_RWLockRelease(&g_GTM_Debug_Lock);
                 return GTM_STORE_OK;
             }
         }
@@ -2780,7 +2784,6 @@ int32 GTM_StoreLogTransaction(GlobalTransactionId gxid,
         if(NULL == gti)
         {
             elog(LOG, "no empty slot for gid %s", gid);
-            GTM_RWLockRelease(&g_GTM_Debug_Lock);
             return GTM_STORE_ERROR;
         }
 
@@ -2803,11 +2806,76 @@ int32 GTM_StoreLogTransaction(GlobalTransactionId gxid,
         gti->gxid = gxid;
         gti->state = GTMTxnInit;
     }
-    
 
-    GTM_RWLockRelease(&g_GTM_Debug_Lock);
     return GTM_STORE_OK;
 }
+
+/*
+ * Queue a trace record into the current thread's buffer.  The buffer has a
+ * single producer and a single consumer, the log collector thread, so this
+ * takes no lock shared with other service threads.  When the collector falls
+ * behind the record is dropped rather than stalling the thread.
+ */
+static int32 GTM_StorePutTxnLog(GTM_TxnLogRecord *rec,
+                                const char *gid,
+                                const char *nodestring,
+                                const char *rel_name)
+{
+    DataPumpBuf *buff = GetMyThreadInfo->txnlog_buff;
+
+    if (NULL == buff)
+    {
+        return GTM_STORE_SKIP;
+    }
+
+    rec->gid_len = (gid ? strnlen(gid, GTM_MAX_SESSION_ID_LEN - 1) : 0) + 1;
+    rec->nodestring_len = (nodestring ? strnlen(nodestring, NODE_STRING_MAX_LENGTH - 1) : 0) + 1;
+    rec->rel_name_len = (rel_name ? strnlen(rel_name, GTM_TXN_LOG_MAX_RELNAME_LEN - 1) : 0) + 1;
+
+    if (FreeSpace(buff) < sizeof(GTM_TxnLogRecord) + rec->gid_len + rec->nodestring_len + rec->rel_name_len)
+    {
+        return GTM_STORE_ERROR;
+    }
+
+    PutData(buff, (char *) rec, sizeof(GTM_TxnLogRecord));
+    PutData(buff, gid ? (char *) gid : "", rec->gid_len - 1);
+    PutData(buff, "", 1);
+    PutData(buff, nodestring ? (char *) nodestring : "", rec->nodestring_len - 1);
+    PutData(buff, "", 1);
+    PutData(buff, rel_name ? (char *) rel_name : "", rec->rel_name_len - 1);
+    PutData(buff, "", 1);
+    SetBorder(buff);
+
+    return GTM_STORE_OK;
+}
+
+int32 GTM_StoreLogTransaction(GlobalTransactionId gxid,
+                                        const char *gid,
+                                        const char *node_string,
+                                        int node_count,
+                                        int isGlobal,
+                                        int isCommit,
+                                        GlobalTimestamp prepare_ts,
+                                        GlobalTimestamp commit_ts)
+{
+    GTM_TxnLogRecord rec;
+
+    elog(DEBUG1, "Store log transaction gxid %u gid %s node string %s node count %d isGlobal %d isCommit %d "
+                "prepare ts "INT64_FORMAT " commit ts "INT64_FORMAT,
+                gxid, gid, node_string, node_count, isGlobal, isCommit, prepare_ts, commit_ts);
+
+    memset(&rec, 0, sizeof(GTM_TxnLogRecord));
+    rec.entryType = GTMTypeTransaction;
+    rec.gxid = gxid;
+    rec.node_count = node_count;
+    rec.isGlobal = isGlobal;
+    rec.isCommit = isCommit;
+    rec.prepare_timestamp = prepare_ts;
+    rec.commit_timestamp = commit_ts;
+
+    return GTM_StorePutTxnLog(&rec, gid, node_string, NULL);
+}
+
 int32 GTM_StoreLogScan(GlobalTransactionId gxid,
                                  const char *nodestring,
                                 GlobalTimestamp start_ts,
@@ -2817,23 +2885,109 @@ int32 GTM_StoreLogScan(GlobalTransactionId gxid,
                                  const char *rel_name,
                                  int64 scan_number)
 {
+    GTM_TxnLogRecord rec;
 
-    elog(DEBUG1, "Store log scan gxid %u node string %s start_ts "INT64_FORMAT 
+    elog(DEBUG1, "Store log scan gxid %u node string %s start_ts "INT64_FORMAT
         " local start ts "INT64_FORMAT
         " local complete ts "INT64_FORMAT
         " scan_type %s rel_name %s scan number "INT64_FORMAT,
-                gxid, nodestring, start_ts, local_start_ts, local_complete_ts, 
+                gxid, nodestring, start_ts, local_start_ts, local_complete_ts,
                 scan_type_tab[scan_type].name, rel_name, scan_number);
-    GTM_RWLockAcquire(&g_GTM_Scan_Debug_Lock, GTM_LOCKMODE_WRITE);
-
-    fprintf(g_GTMDebugScanLogFile, "[%s] scan entry gxid %d node %s start_ts "INT64_FORMAT
-                    " local start ts "INT64_FORMAT
-                    " local complete ts "INT64_FORMAT
-                    " scantype %s rel_name %s scan number "INT64_FORMAT "\n", 
-            log_time(), gxid, nodestring, start_ts, local_start_ts, local_complete_ts, 
-                    scan_type_tab[scan_type].name, rel_name, scan_number);
-    GTM_RWLockRelease(&g_GTM_Scan_Debug_Lock);
-    return GTM_STORE_OK;
+
+    memset(&rec, 0, sizeof(GTM_TxnLogRecord));
+    rec.entryType = GTMTypeScan;
+    rec.gxid = gxid;
+    rec.scan_type = scan_type;
+    rec.start_timestamp = start_ts;
+    rec.local_start_timestamp = local_start_ts;
+    rec.local_complete_timestamp = local_complete_ts;
+    rec.scan_number = scan_number;
+
+    return GTM_StorePutTxnLog(&rec, NULL, nodestring, rel_name);
+}
+
+/*
+ * Copy len bytes out of a datapump buffer, following the wrap around.
+ */
+static void GTM_StoreReadTxnLog(DataPumpBuf *buff, char *dst, uint32 len)
+{
+    char   *data;
+    uint32  data_len;
+
+    while (len > 0)
+    {
+        data = GetData(buff, &data_len);
+        AssertState(data != NULL && data_len > 0);
+        data_len = Min(data_len, len);
+        memcpy(dst, data, data_len);
+        IncDataOff(buff, data_len);
+        dst += data_len;
+        len -= data_len;
+    }
+}
+
+/*
+ * Drain the trace records queued by all threads, called by the log collector
+ * thread.  A record is only visible once SetBorder has published all of it.
+ */
+void GTM_StoreProcessTxnLog(void)
+{// #lizard forgives
+    GTM_ThreadInfo   *thrinfo;
+    DataPumpBuf      *buff;
+    GTM_TxnLogRecord *rec = (GTM_TxnLogRecord *) g_GTM_TxnLogRecordBuf;
+    char             *gid;
+    char             *nodestring;
+    char             *rel_name;
+    uint32            i;
+
+    if (NULL == rec)
+    {
+        return;
+    }
+
+    GTM_RWLockAcquire(&GTMThreads->gt_lock, GTM_LOCKMODE_READ);
+
+    for (i = 0; i < GTMThreads->gt_array_size; i++)
+    {
+        thrinfo = GTMThreads->gt_threads[i];
+        if (NULL == thrinfo || NULL == thrinfo->txnlog_buff)
+        {
+            continue;
+        }
+
+        buff = thrinfo->txnlog_buff;
+        while (DataSize(buff) > 0)
+        {
+            GTM_StoreReadTxnLog(buff, (char *) rec, sizeof(GTM_TxnLogRecord));
+            GTM_StoreReadTxnLog(buff, (char *) (rec + 1),
+                                rec->gid_len + rec->nodestring_len + rec->rel_name_len);
+            gid = (char *) (rec + 1);
+            nodestring = gid + rec->gid_len;
+            rel_name = nodestring + rec->nodestring_len;
+
+            if (GTMTypeScan == rec->entryType)
+            {
+                fprintf(g_GTMDebugScanLogFile, "[%s] scan entry gxid %d node %s start_ts "INT64_FORMAT
+                                " local start ts "INT64_FORMAT
+                                " local complete ts "INT64_FORMAT
+                                " scantype %s rel_name %s scan number "INT64_FORMAT "\n",
+                        log_time(), rec->gxid, nodestring, rec->start_timestamp,
+                                rec->local_start_timestamp, rec->local_complete_timestamp,
+                                scan_type_tab[rec->scan_type].name, rel_name, rec->scan_number);
+            }
+            else
+            {
+                GTM_StoreApplyLogTransaction(rec->gxid, gid, nodestring, rec->node_count,
+                                             rec->isGlobal, rec->isCommit,
+                                             rec->prepare_timestamp, rec->commit_timestamp);
+            }
+        }
+    }
+
+    GTM_RWLockRelease(&GTMThreads->gt_lock);
+
+    fflush(g_GTMDebugLogFile);
+    fflush(g_GTMDebugScanLogFile);
 }
 
 /*
@@ -280,6 +280,9 @@ GTM_ThreadCreate(void *(* startroutine)(void *), int32 max_lock)
     thrinfo->last_sync_gts = 0;
     thrinfo->stat_handle = NULL;
     thrinfo->datapump_buff = GTM_BuildDataPumpBuf(GTM_THREAD_ERRLOG_DATAPUMP_SIZE);
+    thrinfo->txnlog_buff = NULL;
+    if (enable_gtm_debug)
+        thrinfo->txnlog_buff = GTM_BuildDataPumpBuf(GTM_THREAD_TXNLOG_DATAPUMP_SIZE);
 #endif
 
 	/*
@@ -320,6 +323,8 @@ GTM_ThreadCreate(void *(* startroutine)(void *), int32 max_lock)
 		GTM_RWLockDestroy(&thrinfo->thr_lock);
 #ifdef __TBASE__
         GTM_DestroyDataPumpBuf(thrinfo->datapump_buff);
+        if (thrinfo->txnlog_buff != NULL)
+            GTM_DestroyDataPumpBuf(thrinfo->txnlog_buff);
 #endif
 		pfree(thrinfo);
 
@@ -408,6 +413,8 @@ GTM_ThreadCleanup(void *argp)
 		pfree(thrinfo->write_locks_hold);
 	if(thrinfo->datapump_buff != NULL)
         GTM_DestroyDataPumpBuf(thrinfo->datapump_buff);
+	if(thrinfo->txnlog_buff != NULL)
+        GTM_DestroyDataPumpBuf(thrinfo->txnlog_buff);
 #endif
     /*
      * Switch to the memory context of the main process so that we can free up
@@ -90,6 +90,7 @@ GTM_InitTxnManager(void)
     pg_atomic_init_u32(&GTMTransactions.gt_global_xid, FirstNormalGlobalTransactionId);
     pg_atomic_init_u64(&GTMTransactions.gt_access_ts_seq, 0);
     pg_atomic_init_u64(&GTMTransactions.gt_last_access_ts_seq, 0);
+    pg_atomic_init_u32(&GTMTransactions.gt_timestamp_seq, 0);
     /*
      * XXX The gt_oldestXid is the cluster level oldest Xid
      */
@@ -1168,15 +1169,39 @@ GetNextGlobalTimestamp(void)
 {
     GlobalTimestamp gts, now, delta, tv_sec, tv_nsec;
 
-    if(enable_gtm_debug)
+    if(!enable_gtm_debug)
     {
-        AcquireWriteLock();
-    }
-    else
-    {
-        AcquireReadLock();
+        GlobalTimestamp base;
+        GlobalTimestamp cycle;
+        uint32          seq;
+
+        /*
+         * Read the clock base like a seqlock, so that service threads never
+         * write to shared memory to get a timestamp.  The timekeeper moves
+         * gt_global_timestamp and gt_last_cycle forward by the same amount,
+         * so any consistent pair gives the same result.
+         */
+        for (;;)
+        {
+            seq = pg_atomic_read_u32(&GTMTransactions.gt_timestamp_seq);
+            if (seq & 1)
+                continue;
+
+            pg_read_barrier();
+            base  = GTMTransactions.gt_global_timestamp;
+            cycle = GTMTransactions.gt_last_cycle;
+            now   = GTM_TimestampGetMonotonicRaw();
+            pg_read_barrier();
+
+            if (pg_atomic_read_u32(&GTMTransactions.gt_timestamp_seq) == seq)
+                break;
+        }
+
+        return base + (now - cycle);
     }
-    
+
+    AcquireWriteLock();
+
     now = GTM_TimestampGetMonotonicRawPrecise(&tv_sec, &tv_nsec);
 
     if(enable_gtm_debug)
@@ -1239,20 +1264,10 @@ GetNextGlobalTimestamp(void)
         
     }
     
-    if(enable_gtm_debug)
-    {
-        ReleaseWriteLock();
-    }
-    else
-    {
-        ReleaseReadLock();
-    }
+    ReleaseWriteLock();
 
-    if(enable_gtm_debug)
-    {
-        elog(LOG, "get global timestamp "INT64_FORMAT " last cycle " INT64_FORMAT " now " INT64_FORMAT, 
-                            gts, GTMTransactions.gt_last_cycle, now); 
-    }
+    elog(LOG, "get global timestamp "INT64_FORMAT " last cycle " INT64_FORMAT " now " INT64_FORMAT, 
+                        gts, GTMTransactions.gt_last_cycle, now); 
     
     return gts;
 
@@ -1334,8 +1349,10 @@ SyncGlobalTimestamp(void)
     }
 
     delta = now - GTMTransactions.gt_last_cycle;
+    pg_atomic_fetch_add_u32(&GTMTransactions.gt_timestamp_seq, 1);
     GTMTransactions.gt_global_timestamp += delta;
     GTMTransactions.gt_last_cycle = now;
+    pg_atomic_fetch_add_u32(&GTMTransactions.gt_timestamp_seq, 1);
     gts = GTMTransactions.gt_global_timestamp;
 
     if(enable_gtm_debug)
@@ -1354,8 +1371,10 @@ void
 SetNextGlobalTimestamp(GlobalTimestamp gts)
 {
     AcquireWriteLock();
+    pg_atomic_fetch_add_u32(&GTMTransactions.gt_timestamp_seq, 1);
     GTMTransactions.gt_global_timestamp = gts;
     GTMTransactions.gt_last_cycle = GTM_TimestampGetMonotonicRaw();
+    pg_atomic_fetch_add_u32(&GTMTransactions.gt_timestamp_seq, 1);
     GTMTransactions.gt_last_issue_timestamp = gts - 1;
     ReleaseWriteLock();
     
@@ -1364,28 +1383,17 @@ SetNextGlobalTimestamp(GlobalTimestamp gts)
 }
 
 /*
- * Add for global timestamp; Process MSG_GETGTS message
+ * Get a global timestamp to hand out to a client, making sure the clock
+ * is still synchronized with the standby.
  */
-void
-ProcessGetGTSCommand(Port *myport, StringInfo message)
-{// #lizard forgives
-    StringInfoData buf;
+static GTM_Timestamp
+GetNextGlobalTimestampForClient(void)
+{
     GTM_Timestamp timestamp;
 #ifdef __XLOG__
     time_t        now;
 #endif
-    
-    pq_getmsgend(message);    
-    
-    if (Recovery_IsStandby())
-    {
-        if (myport->remote_type != GTM_NODE_GTM_CTL && myport->remote_type != GTM_NODE_GTM)
-        {
-            elog(ERROR, "gtm standby can't provide global timestamp.");
-        }
-    }
 
-    /* Get a GTM timestamp */
     timestamp = GetNextGlobalTimestamp();
 #ifdef __XLOG__
     now       = GTM_TimestampGetMonotonicRaw();
@@ -1403,6 +1411,31 @@ ProcessGetGTSCommand(Port *myport, StringInfo message)
             elog(ERROR,"sync time exceeded last:%lu now:%lu",GetMyThreadInfo->last_sync_gts,now);
     }
 #endif
+
+    return timestamp;
+}
+
+/*
+ * Add for global timestamp; Process MSG_GETGTS message
+ */
+void
+ProcessGetGTSCommand(Port *myport, StringInfo message)
+{
+    StringInfoData buf;
+    GTM_Timestamp timestamp;
+    
+    pq_getmsgend(message);    
+    
+    if (Recovery_IsStandby())
+    {
+        if (myport->remote_type != GTM_NODE_GTM_CTL && myport->remote_type != GTM_NODE_GTM)
+        {
+            elog(ERROR, "gtm standby can't provide global timestamp.");
+        }
+    }
+
+    /* Get a GTM timestamp */
+    timestamp = GetNextGlobalTimestampForClient();
         
     /* Respond to the client */
     pq_beginmessage(&buf, 'S');
@@ -1450,8 +1483,12 @@ ProcessGetGTSCommandMulti(Port *myport, StringInfo message)
     if (gts_count <= 0)
         elog(PANIC, "Zero or less transaction count");
 
-    /* Get a GTM timestamp */
-    timestamp = GTM_TimestampGetCurrent();
+    /*
+     * A single global timestamp answers the whole group: each requester
+     * asked for it before this point, so it is as fresh as a timestamp
+     * taken for any one of them.
+     */
+    timestamp = GetNextGlobalTimestampForClient();
 
     elog(DEBUG7, "GTM processes timestamp.\n");
     
@@ -1467,6 +1504,10 @@ ProcessGetGTSCommandMulti(Port *myport, StringInfo message)
         pq_sendbytes(&buf, (char *)&proxyhdr, sizeof (GTM_ProxyMsgHeader));
     }
     pq_sendbytes(&buf, (char *)&timestamp, sizeof(GTM_Timestamp));
+    if (GTMClusterReadOnly)
+    {
+        pq_sendbyte(&buf, true);
+    }
     pq_endmessage(myport, &buf);
 
     if (myport->remote_type != GTM_NODE_GTM_PROXY)
@@ -2536,6 +2577,8 @@ ProcessGXIDListCommand(Port *myport, StringInfo message)
     oldContext = MemoryContextSwitchTo(TopMemoryContext);
 
     GTM_RWLockAcquire(&GTMTransactions.gt_XidGenLock, GTM_LOCKMODE_WRITE);
+    /* the size only covers slots in use, keep them from changing meanwhile */
+    GTM_RWLockAcquire(&GTMTransactions.gt_TransArrayLock, GTM_LOCKMODE_READ);
 
     estlen = gtm_get_transactions_size(&GTMTransactions);
     data = malloc(estlen+1);
@@ -2544,6 +2587,7 @@ ProcessGXIDListCommand(Port *myport, StringInfo message)
 
     elog(DEBUG1, "gtm_serialize_transactions: estlen=%ld, actlen=%ld", estlen, actlen);
 
+    GTM_RWLockRelease(&GTMTransactions.gt_TransArrayLock);
     GTM_RWLockRelease(&GTMTransactions.gt_XidGenLock);
 
     MemoryContextSwitchTo(oldContext);
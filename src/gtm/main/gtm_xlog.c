@@ -106,12 +106,20 @@
 #define MIN(a,b) ((a) < (b) ? (a) : (b))
 #define BLANK_CHARACTERS " \t\n"
 
+/* granularity of map file dirty tracking and checkpoint writes */
+#define GTM_STORE_DIRTY_PAGE_SIZE 4096
+#define GTM_STORE_DIRTY_PAGES \
+    ((g_GTMStoreSize + GTM_STORE_DIRTY_PAGE_SIZE - 1) / GTM_STORE_DIRTY_PAGE_SIZE)
+
 extern bool enalbe_gtm_xlog_debug;
 
 extern GTM_ThreadInfo    *g_basebackup_thread;
 extern bool                 enable_sync_commit;
 extern bool              first_init;
 extern int               max_wal_sender;
+extern int               wal_commit_delay;
+extern int               checkpoint_flush_after;
+extern int               checkpoint_write_delay;
 extern int32             g_GTMStoreMapFile;
 extern size_t            g_GTMStoreSize;
 extern GTMControlHeader  *g_GTM_Store_Header;
@@ -131,7 +139,7 @@ extern bool             recovery_pitr_mode;
 extern int  GTMStartupGTSDelta;
 
 static bool      g_recovery_finish;
-static bool     *g_GTMStoreDirtyMap;
+static bool     *g_GTMStoreDirtyMap;    /* one entry per store page */
 static GTM_MutexLock g_CheckPointLock;
 
 XLogCtlData     *XLogCtl;
@@ -625,18 +633,29 @@ UpdateStandbyWriteBuffPos(XLogRecPtr pos)
     GTM_RWLockAcquire(&XLogCtl->standby_info_lck,GTM_LOCKMODE_WRITE);
     XLogCtl->write_buff_pos = pos;
     GTM_RWLockRelease(&XLogCtl->standby_info_lck);
+
+    /* wake up the redoer if it is waiting for this xlog */
+    GTM_MutexLockAcquire(&XLogCtl->redo_wait_lck);
+    GTM_CVBcast(&XLogCtl->redo_wait_cv);
+    GTM_MutexLockRelease(&XLogCtl->redo_wait_lck);
 }
 
 void
 UpdateStandbyApplyPos(XLogRecPtr pos)
 {
-    if(enalbe_gtm_xlog_debug)
+    bool moved;
+
+    GTM_RWLockAcquire(&XLogCtl->standby_info_lck,GTM_LOCKMODE_WRITE);
+    /* called for every step of the redo loop, skip it if nothing moved */
+    moved = (pos != XLogCtl->apply);
+    if(moved)
+        XLogCtl->apply = pos;
+    GTM_RWLockRelease(&XLogCtl->standby_info_lck);
+
+    if(moved && enalbe_gtm_xlog_debug)
         elog(LOG,"update apply pos to %X/%X",
              (uint32_t)(pos >>32),
              (uint32_t)pos);
-    GTM_RWLockAcquire(&XLogCtl->standby_info_lck,GTM_LOCKMODE_WRITE);
-    XLogCtl->apply = pos;
-    GTM_RWLockRelease(&XLogCtl->standby_info_lck);
 }
 
 XLogRecPtr
@@ -1138,8 +1157,8 @@ GTM_XLogFileInit(char *data_dir)
     flush      = XLogCtl->LogwrtResult.Flush;
     segment_no = flush / GTM_XLOG_SEG_SIZE;
 
-    g_GTMStoreDirtyMap = (bool *)palloc0(g_GTMStoreSize * sizeof(bool));
-    memset(g_GTMStoreDirtyMap,0,g_GTMStoreSize * sizeof(bool));
+    g_GTMStoreDirtyMap = (bool *)palloc0(GTM_STORE_DIRTY_PAGES * sizeof(bool));
+    memset(g_GTMStoreDirtyMap,0,GTM_STORE_DIRTY_PAGES * sizeof(bool));
 
     if(Recovery_IsStandby())
         return ;
@@ -1199,6 +1218,9 @@ GTM_XLogCtlDataInit(void)
 
     GTM_RWLockInit(&XLogCtl->segment_lck);
     GTM_MutexLockInit(&XLogCtl->walwrite_lck);
+    GTM_MutexLockInit(&XLogCtl->commit_delay_lck);
+    GTM_MutexLockInit(&XLogCtl->redo_wait_lck);
+    GTM_CVInit(&XLogCtl->redo_wait_cv);
     SpinLockInit(&XLogCtl->walwirte_info_lck);
     SpinLockInit(&XLogCtl->timeline_lck);
 
@@ -1223,8 +1245,8 @@ GTM_XLogCtlDataInit(void)
     Insert->PrevBytePos = ControlData->PrevBytePos;
 
     g_checkpointMapperBuff = (char *)palloc(g_GTMStoreSize);
-    g_checkpointDirtySize  = (uint32 *)palloc(sizeof(uint32) * g_GTMStoreSize);
-    g_checkpointDirtyStart = (uint32 *)palloc(sizeof(uint32) * g_GTMStoreSize);
+    g_checkpointDirtySize  = (uint32 *)palloc(sizeof(uint32) * GTM_STORE_DIRTY_PAGES);
+    g_checkpointDirtyStart = (uint32 *)palloc(sizeof(uint32) * GTM_STORE_DIRTY_PAGES);
 
     if(enalbe_gtm_xlog_debug || enalbe_gtm_xlog_debug)
     {
@@ -1441,7 +1463,15 @@ GTM_RedoerWaitForData(XLogRecPtr pos)
         if(GTM_SHUTTING_DOWN == GTMTransactions.gt_gtm_state || Recovery_IsStandby() == false)
             return InvalidXLogRecPtr;
 
-        pg_usleep(1000);
+        /*
+         * Sleep until the receiver hands us more xlog instead of polling,
+         * so a burst is replayed as soon as it arrives. The timeout keeps
+         * the shutdown and promotion checks above going.
+         */
+        GTM_MutexLockAcquire(&XLogCtl->redo_wait_lck);
+        if(GetStandbyWriteBuffPos() < pos)
+            GTM_CVTimeWait(&XLogCtl->redo_wait_cv, &XLogCtl->redo_wait_lck, 100 * 1000);
+        GTM_MutexLockRelease(&XLogCtl->redo_wait_lck);
     }
 
 
@@ -1743,7 +1773,7 @@ GTM_ThreadWalRedoer_Internal()
     if(xlog_rec != NULL)
         pfree(xlog_rec);
 
-    for(i = 0; i < g_GTMStoreSize;i++)
+    for(i = 0; i < GTM_STORE_DIRTY_PAGES;i++)
         g_GTMStoreDirtyMap[i] = true;
 
     if(Recovery_IsStandby())
@@ -2522,6 +2552,7 @@ DoMasterCheckPoint(bool shutdown)
     int ret;
     XLogRecPtr flush_ptr;
     int idx;
+    size_t unflushed;
 
     Assert(g_GTMStoreMapFile != -1);
 
@@ -2538,25 +2569,30 @@ DoMasterCheckPoint(bool shutdown)
 
     /* we lock header lock here ,because we want to shorten the interval of header lock holding */
     GTM_RWLockAcquire(g_GTM_Store_Head_Lock,GTM_LOCKMODE_READ);
-    memcpy(g_checkpointMapperBuff,g_GTMStoreMapAddr,g_GTMStoreSize);
 
-    for(i = 0 ; i < g_GTMStoreSize ; i++)
+    /*
+     * Collect runs of dirty pages and snapshot only those, so the time spent
+     * under the store lock follows the amount of change since the last
+     * checkpoint rather than the size of the store.
+     */
+    for(i = 0 ; i < GTM_STORE_DIRTY_PAGES ; i++)
     {
-        while(i < g_GTMStoreSize && !g_GTMStoreDirtyMap[i]) i++;
-
-        write_start = i;
+        while(i < GTM_STORE_DIRTY_PAGES && !g_GTMStoreDirtyMap[i]) i++;
 
-        if( i == g_GTMStoreSize )
+        if( i == GTM_STORE_DIRTY_PAGES )
             break;
 
-        size = 0;
-        while(i < g_GTMStoreSize && g_GTMStoreDirtyMap[i])
+        write_start = i * GTM_STORE_DIRTY_PAGE_SIZE;
+
+        while(i < GTM_STORE_DIRTY_PAGES && g_GTMStoreDirtyMap[i])
         {
             g_GTMStoreDirtyMap[i] = false;
-            size++;
             i++;
         }
 
+        size = MIN((size_t) i * GTM_STORE_DIRTY_PAGE_SIZE, g_GTMStoreSize) - write_start;
+        memcpy(g_checkpointMapperBuff + write_start, g_GTMStoreMapAddr + write_start, size);
+
         g_checkpointDirtySize[idx]    = size;
         g_checkpointDirtyStart[idx++] = write_start;
     }
@@ -2577,7 +2613,20 @@ DoMasterCheckPoint(bool shutdown)
         GTM_StoreUnLock();
     }
 
-    /* writes all dirty section */
+    /*
+     * The checkpoint record is in the xlog buffer, and ControlData is only
+     * moved to it after the map file has been synced below, so other
+     * flushers need not wait for our writes.
+     */
+    ReleaseXLogInsertLock();
+
+    /*
+     * Writes all dirty sections.  Every checkpoint_flush_after kB we start
+     * the writeback of what we have written so far, so the final fsync has
+     * little left to do, and pause for checkpoint_write_delay to spread the
+     * I/O out.  A shutdown checkpoint is not spread.
+     */
+    unflushed = 0;
     for(i = 0 ; i < idx ; i++)
     {
         write_start = g_checkpointDirtyStart[i];
@@ -2596,6 +2645,19 @@ DoMasterCheckPoint(bool shutdown)
             elog(LOG, "could not write map for: %s, required bytes:%d, return bytes:%d", strerror(errno), size, nbytes);
             exit(1);
         }
+
+        unflushed += size;
+        if(checkpoint_flush_after > 0 &&
+           unflushed >= (size_t) checkpoint_flush_after * 1024)
+        {
+#ifdef HAVE_SYNC_FILE_RANGE
+            (void) sync_file_range(g_GTMStoreMapFile, 0, 0, SYNC_FILE_RANGE_WRITE);
+#endif
+            unflushed = 0;
+
+            if(!shutdown && checkpoint_write_delay > 0)
+                pg_usleep(checkpoint_write_delay * 1000L);
+        }
     }
 
     ret = fsync(g_GTMStoreMapFile);
@@ -2605,8 +2667,6 @@ DoMasterCheckPoint(bool shutdown)
         exit(1);
     }
 
-    ReleaseXLogInsertLock();
-
     XLogFlush(flush_ptr);
 
     /* save checkpoint position to ControlData */
@@ -2839,11 +2899,12 @@ XLogRegisterRangeOverwrite(offset_t offset,
     if(enalbe_gtm_xlog_debug)
         elog(LOG,"%lu %d",offset,len);
 
-    i = offset;
-    while(len)
+    if(len > 0)
     {
-        g_GTMStoreDirtyMap[i++] = true;
-        len--;
+        for(i = offset / GTM_STORE_DIRTY_PAGE_SIZE;
+            i <= (offset + len - 1) / GTM_STORE_DIRTY_PAGE_SIZE;
+            i++)
+            g_GTMStoreDirtyMap[i] = true;
     }
 
 }
@@ -3506,6 +3567,33 @@ XLogFlush(XLogRecPtr ptr)
     if(flush_pos >= ptr)
         return ;
 
+    /*
+     * Group commit: the first flush sleeps for wal_commit_delay while holding
+     * commit_delay_lck, concurrent ones queue on the lock meanwhile. The
+     * leader then writes everything inserted so far with a single fsync,
+     * which usually covers the followers' records too.
+     */
+    if(wal_commit_delay > 0 && Recovery_IsStandby() == false)
+    {
+        if(GTM_MutexLockConditionalAcquire(&XLogCtl->commit_delay_lck))
+        {
+            pg_usleep(wal_commit_delay);
+            GTM_MutexLockRelease(&XLogCtl->commit_delay_lck);
+        }
+        else
+        {
+            GTM_MutexLockAcquire(&XLogCtl->commit_delay_lck);
+            GTM_MutexLockRelease(&XLogCtl->commit_delay_lck);
+        }
+
+        SpinLockAcquire(&XLogCtl->walwirte_info_lck);
+        flush_pos = XLogCtl->LogwrtResult.Flush;
+        SpinLockRelease(&XLogCtl->walwirte_info_lck);
+
+        if(flush_pos >= ptr)
+            return ;
+    }
+
     if(Recovery_IsStandby() == false)
         write_pos = WaitXLogInsertionsToFinish(ptr);
     else
@@ -99,7 +99,10 @@ int            scale_factor_threads = 1;
 int            worker_thread_number = 2;
 #ifdef __TBASE__
 int         wal_writer_delay;
+int         wal_commit_delay = 0;
 int         checkpoint_interval;
+int         checkpoint_flush_after = 256;
+int         checkpoint_write_delay = 0;
 char        *archive_command;
 bool        archive_mode;
 int         max_reserved_wal_number;
@@ -122,6 +125,7 @@ GTM_MutexLock   control_lock;
 
 #ifdef __TBASE__
 bool        enable_gtm_sequence_debug = false;
+int         gtm_sequence_reserve_count = SEQ_RESERVE_COUNT;
 bool        enalbe_gtm_xlog_debug = false;
 bool        enable_gtm_debug   = false;
 bool        enable_sync_commit = false;
@@ -2383,6 +2387,8 @@ GTM_ThreadLogCollector(void *argp)
     sigjmp_buf  local_sigjmp_buf;
     struct sigaction action;
     int ret = 0;
+    long cycle = GTM_LOG_COLLECT_CYCLE;
+    long elapsed = 0;
     action.sa_flags = 0;
     action.sa_handler = GTM_ThreadSigHandler;
 
@@ -2392,6 +2398,12 @@ GTM_ThreadLogCollector(void *argp)
         elog(LOG, "register thread quit handler failed");
     }
 
+    /* transaction traces are drained more often than the error logs */
+    if (enable_gtm_debug)
+    {
+        cycle = GTM_TXN_LOG_COLLECT_CYCLE;
+    }
+
     elog(DEBUG8, "Starting the log collector thread");
     MessageContext = AllocSetContextCreate(TopMemoryContext,
                                            "MessageContext",
@@ -2447,10 +2459,20 @@ GTM_ThreadLogCollector(void *argp)
            break;
         }
 
-        /* sleep GTM_LOG_COLLECT_CYCLE */
-        usleep(GTM_LOG_COLLECT_CYCLE);
+        usleep(cycle);
 
-        GTM_ProcessLogCollection();
+        if (enable_gtm_debug)
+        {
+            GTM_StoreProcessTxnLog();
+        }
+
+        /* collect error logs every GTM_LOG_COLLECT_CYCLE */
+        elapsed += cycle;
+        if (elapsed >= GTM_LOG_COLLECT_CYCLE)
+        {
+            GTM_ProcessLogCollection();
+            elapsed = 0;
+        }
     }
 
     GTM_DeInitLogCollector();
@@ -3174,6 +3196,9 @@ GTM_ThreadMain(void *argp)
         n = epoll_wait (efd, events, GTM_MAX_CONNECTIONS_PER_THREAD, -1);
 
         elog(DEBUG8, "epoll_wait wakeup %d", n);
+
+        if (thrinfo->stat_handle)
+            GTM_UpdateReadyCount(thrinfo->stat_handle, n);
         
         for(i = 0; i < n; i++)
         {
@@ -3534,6 +3559,8 @@ ProcessCommand(Port *myport, StringInfo input_message)
     GTM_ThreadInfo *my_threadinfo = NULL;
     long long  start_time;
     long long  cost_time;
+    struct timeval start_tv;
+    struct timeval end_tv;
     my_threadinfo = GetMyThreadInfo;
 #ifndef __XLOG__
     GTM_ConnectionInfo *conn;
@@ -3560,6 +3587,7 @@ ProcessCommand(Port *myport, StringInfo input_message)
     elog(DEBUG1, "mtype = %s (%d).", gtm_util_message_name(mtype), (int)mtype);
 #ifdef __TBASE__
     start_time = getSystemTime();
+    gettimeofday(&start_tv, NULL);
     /*
      * Get Timestamp does not need to sync with standby
      */
@@ -3762,6 +3790,11 @@ ProcessCommand(Port *myport, StringInfo input_message)
             ProcessGetErrorlogCommand(myport,input_message);
             break;
         }
+        case MSG_GET_LATENCY_STATISTICS:
+        {
+            ProcessGetLatencyStatisticsCommand(myport,input_message);
+            break;
+        }
 #endif
         default:
             ereport(FATAL,
@@ -3779,6 +3812,11 @@ ProcessCommand(Port *myport, StringInfo input_message)
 
     GTM_UpdateStatistics(my_threadinfo->stat_handle, mtype, cost_time);
 
+    gettimeofday(&end_tv, NULL);
+    cost_time = (end_tv.tv_sec - start_tv.tv_sec) * 1000000LL +
+                (end_tv.tv_usec - start_tv.tv_usec);
+    GTM_UpdateLatency(my_threadinfo->stat_handle, mtype, cost_time > 0 ? cost_time : 0);
+
     if (my_threadinfo->handle_standby)
     {
         GTM_RWLockRelease(&my_threadinfo->thr_lock);
@@ -1670,6 +1670,9 @@ ProcessCommand(GTMProxy_ConnectionInfo *conninfo, GTM_Conn *gtm_conn,
         case MSG_TXN_COMMIT_MULTI:
         case MSG_TXN_ROLLBACK:
         case MSG_TXN_GET_GXID:
+#ifdef __TBASE__
+        case MSG_GETGTS:
+#endif
             ProcessTransactionCommand(conninfo, gtm_conn, mtype, input_message);
             break;
 
@@ -2001,6 +2004,45 @@ ProcessResponse(GTMProxy_ThreadInfo *thrinfo, GTMProxy_CommandInfo *cmdinfo,
             ReleaseCmdBackup(cmdinfo);
             break;
 
+#ifdef __TBASE__
+        case MSG_GETGTS:
+            /*
+             * A grouped timestamp request. Every backend in the group gets
+             * the timestamp returned for the group, which was taken after
+             * each of them asked for one.
+             */
+            if (res->gr_status == GTM_RESULT_OK)
+            {
+                if (res->gr_type != TXN_BEGIN_GETGTS_MULTI_RESULT)
+                {
+                    ReleaseCmdBackup(cmdinfo);
+                    elog(ERROR, "Wrong result");
+                }
+
+                timestamp = res->gr_resdata.grd_gts.grd_gts;
+
+                pq_beginmessage(&buf, 'S');
+                pq_sendint(&buf, TXN_BEGIN_GETGTS_RESULT, 4);
+                pq_sendbytes(&buf, (char *)&timestamp, sizeof (GTM_Timestamp));
+                if (res->gr_resdata.grd_gts.gtm_readonly)
+                {
+                    pq_sendbyte(&buf, true);
+                }
+                pq_endmessage(cmdinfo->ci_conn->con_port, &buf);
+                pq_flush(cmdinfo->ci_conn->con_port);
+            }
+            else
+            {
+                pq_beginmessage(&buf, 'E');
+                pq_sendbytes(&buf, res->gr_proxy_data, res->gr_msglen);
+                pq_endmessage(cmdinfo->ci_conn->con_port, &buf);
+                pq_flush(cmdinfo->ci_conn->con_port);
+            }
+            cmdinfo->ci_conn->con_pending_msg = MSG_TYPE_INVALID;
+            ReleaseCmdBackup(cmdinfo);
+            break;
+#endif
+
         case MSG_TXN_BEGIN:
         case MSG_TXN_BEGIN_GETGXID_AUTOVACUUM:
         case MSG_TXN_PREPARE:
@@ -2238,6 +2280,18 @@ ProcessTransactionCommand(GTMProxy_ConnectionInfo *conninfo, GTM_Conn *gtm_conn,
             GTMProxy_CommandPending(conninfo, mtype, cmd_data);
             break;
 
+#ifdef __TBASE__
+        case MSG_GETGTS:
+            /*
+             * All the timestamp requests which arrive before the next round
+             * trip to GTM are answered by a single MSG_GETGTS_MULTI.
+             */
+            pq_getmsgend(message);
+            memset(&cmd_data, 0, sizeof (cmd_data));
+            GTMProxy_CommandPending(conninfo, mtype, cmd_data);
+            break;
+#endif
+
         case MSG_TXN_BEGIN:
         case MSG_TXN_GET_GXID:
             elog(FATAL, "Support not yet added for these message types");
@@ -2669,6 +2723,43 @@ GTMProxy_ProcessPendingCommands(GTMProxy_ThreadInfo *thrinfo)
                 break;
 
 
+#ifdef __TBASE__
+            case MSG_GETGTS:
+                if (gtmpqPutInt(MSG_GETGTS_MULTI, sizeof (GTM_MessageType), gtm_conn) ||
+                    gtmpqPutInt(gtm_list_length(thrinfo->thr_pending_commands[ii]), sizeof(int), gtm_conn))
+                    elog(ERROR, "Error sending data");
+
+                /* All the requests share the single timestamp in the result */
+                gtm_foreach (elem, thrinfo->thr_pending_commands[ii])
+                {
+                    cmdinfo = (GTMProxy_CommandInfo *)gtm_lfirst(elem);
+                    Assert(cmdinfo->ci_mtype == ii);
+                    cmdinfo->ci_res_index = res_index++;
+                }
+
+                /* Finish the message. */
+                Enable_Longjmp();
+                if (gtmpqPutMsgEnd(gtm_conn))
+                    elog(ERROR, "Error finishing the message");
+                Disable_Longjmp();
+
+                /*
+                 * Move the entire list to the processed command
+                 */
+                thrinfo->thr_processed_commands = gtm_list_concat(thrinfo->thr_processed_commands,
+                        thrinfo->thr_pending_commands[ii]);
+                /*
+                 * Free the list header of the second list, unless
+                 * gtm_list_concat actually returned the second list as-is
+                 * because the first list was empty
+                 */
+                if ((thrinfo->thr_processed_commands != thrinfo->thr_pending_commands[ii]) &&
+                    (thrinfo->thr_pending_commands[ii] != gtm_NIL))
+                    pfree(thrinfo->thr_pending_commands[ii]);
+                thrinfo->thr_pending_commands[ii] = gtm_NIL;
+                break;
+#endif
+
             default:
                 elog(ERROR, "This message type (%d) can not be grouped together", ii);
         }
@@ -151,7 +151,10 @@ bool        isStartUp;
 int            scale_factor_threads = 1;
 #ifdef __TBASE__
 int         wal_writer_delay;
+int         wal_commit_delay;
 int         checkpoint_interval;
+int         checkpoint_flush_after;
+int         checkpoint_write_delay;
 char        *archive_command;
 bool        archive_mode;
 int         max_reserved_wal_number;
@@ -164,6 +167,7 @@ GTM_MutexLock   control_lock;
 
 #ifdef __TBASE__
 bool        enable_gtm_sequence_debug = false;
+int         gtm_sequence_reserve_count = SEQ_RESERVE_COUNT;
 bool        enalbe_gtm_xlog_replay_debug = true;
 bool        enalbe_gtm_xlog_debug = true;
 bool        enable_gtm_debug   = false;
@@ -1508,7 +1512,8 @@ void bind_service_threads(void)
 }
 
 /* time keeper thread will not handle any signal, any signal will cause the thread exit. */
-void *
+void 
+*
 GTM_ThreadTimeKeeper(void *argp)
 {
     GTM_ThreadInfo *my_threadinfo = (GTM_ThreadInfo *)argp;
@@ -1621,7 +1626,8 @@ shutdown:
 
 
 /* time keeper thread will not handle any signal, any signal will cause the thread exit. */
-void *
+void 
+*
 GTM_ThreadTimeBackup(void *argp)
 {
     GTM_ThreadInfo *my_threadinfo = (GTM_ThreadInfo *)argp;
@@ -3925,7 +3931,8 @@ void GTM_TimerRun(void)
     }
 }
 
-    void *
+    void 
+*
 GTM_TimerThread(void *argp)
 {
     GTM_ThreadInfo *thrinfo = (GTM_ThreadInfo *)argp;
@@ -19,6 +19,7 @@
 
 extern bool track_commit_timestamp;
 extern PGDLLIMPORT bool track_commit_timestamp_guc;
+extern int commit_ts_buffers;
 
 extern bool check_track_commit_timestamp(bool *newval, void **extra,
                              GucSource source);
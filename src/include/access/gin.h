@@ -68,6 +68,7 @@ typedef char GinTernaryValue;
 /* GUC parameters */
 extern PGDLLIMPORT int GinFuzzySearchLimit;
 extern int    gin_pending_list_limit;
+extern bool gin_pending_list_background_cleanup;
 
 /* ginutil.c */
 extern void ginGetStats(Relation index, GinStatsData *stats);
@@ -105,6 +105,11 @@ extern GlobalTransactionId currentGxid;
 #ifdef __TBASE__
 extern char *NewGtmHost;
 extern int     NewGtmPort;
+extern bool  enable_gts_broker;
+extern bool  enable_gts_prefetch;
+
+extern Size GTSBrokerShmemSize(void);
+extern void GTSBrokerShmemInit(void);
 #endif
 
 extern bool IsGTMConnected(void);
@@ -112,6 +117,8 @@ extern void InitGTM(void);
 extern void CloseGTM(void);
 extern GTM_Timestamp 
 GetGlobalTimestampGTM(void);
+extern GTM_Timestamp GetSnapshotTimestampGTM(void);
+extern void PrefetchGlobalTimestampGTM(void);
 extern GlobalTransactionId BeginTranGTM(GTM_Timestamp *timestamp, const char *globalSession);
 extern GlobalTransactionId BeginTranAutovacuumGTM(void);
 extern int CommitTranGTM(GlobalTransactionId gxid, int waited_xid_count,
@@ -191,6 +198,7 @@ extern Datum pg_list_storage_sequence(PG_FUNCTION_ARGS);
 extern Datum pg_list_storage_transaction(PG_FUNCTION_ARGS);
 extern Datum pg_check_storage_sequence(PG_FUNCTION_ARGS);
 extern Datum pg_check_storage_transaction(PG_FUNCTION_ARGS);
+extern Datum pg_gtm_latency_statistics(PG_FUNCTION_ARGS);
 extern void  CheckGTMConnection(void);
 extern int32 RenameDBSequenceGTM(const char *seqname, const char *newseqname);
 #endif
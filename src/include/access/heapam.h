@@ -131,7 +131,21 @@ extern Size heap_parallelscan_estimate(Snapshot snapshot);
 extern void heap_parallelscan_initialize(ParallelHeapScanDesc target,
 							 Relation relation, Snapshot snapshot);
 extern void heap_parallelscan_reinitialize(ParallelHeapScanDesc parallel_scan);
+#ifdef _SHARDING_
+extern Size heap_parallelscan_estimate_extents(Snapshot snapshot, int nextents);
+extern void heap_parallelscan_initialize_extents(ParallelHeapScanDesc target,
+							 Relation relation, Snapshot snapshot,
+							 ExtentID *extents, int nextents);
+#endif
 extern HeapScanDesc heap_beginscan_parallel(Relation, ParallelHeapScanDesc);
+#ifdef _SHARDING_
+struct ExtentZoneFilter;
+extern bool heap_setscanextent(HeapScanDesc scan, ExtentID eid);
+extern void heap_setzonefilter(HeapScanDesc scan, struct ExtentZoneFilter *filter);
+extern bool heap_snapshot_filters_shards(Relation relation, Snapshot snapshot);
+extern bool heap_extent_shard_hidden(Relation relation, Snapshot snapshot,
+                         ExtentID eid, bool *known);
+#endif
 
 extern bool heap_fetch(Relation relation, Snapshot snapshot,
 		   HeapTuple tuple, Buffer *userbuf, bool keep_buf,
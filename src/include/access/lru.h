@@ -74,6 +74,7 @@
 #define LRU_H
 
 #include "access/xlogdefs.h"
+#include "port/atomics.h"
 #include "storage/lwlock.h"
 
 
@@ -153,6 +154,14 @@ typedef struct LruSharedData
     int           *page_lru_count;
     int            latest_page_number;
 
+    /*
+     * Per-slot change counters for the optimistic read path.  The counter of
+     * a slot is odd while its identity or contents are being changed; see
+     * LruReadPageOptimistic.  Only changed with the partition lock held in
+     * exclusive mode.
+     */
+    pg_atomic_uint32 *page_seq;
+
     /*
      * Optional array of WAL flush LSNs associated with entries in the SLRU
      * pages.  If not zero/NULL, we must flush WAL before writing pages (true
@@ -217,6 +226,16 @@ typedef LruCtlData *LruCtl;
 
 #define PARTITION_LOCK_IDX(shared) ((shared)->num_slots)
 
+/*
+ * Bracket any change of a slot's page number, status or buffer contents that
+ * a concurrent LruReadPageOptimistic must not observe half done.  The atomic
+ * add is a full barrier, so the stores in between are ordered against both.
+ */
+#define LruBeginSlotChange(shared, slotno) \
+    ((void) pg_atomic_fetch_add_u32(&(shared)->page_seq[slotno], 1))
+#define LruEndSlotChange(shared, slotno) \
+    ((void) pg_atomic_fetch_add_u32(&(shared)->page_seq[slotno], 1))
+
 extern Size LruShmemSize(int nslots, int nlsns);
 extern Size
 LruBufTableShmemSize(int size);
@@ -227,6 +246,8 @@ extern int LruReadPage(LruCtl ctl, int partitionno, int pageno, bool write_ok,
                   TransactionId xid);
 extern int LruReadPage_ReadOnly(LruCtl ctl, int partitionno, int pageno,
                            TransactionId xid);
+extern bool LruReadPageOptimistic(LruCtl ctl, int partitionno, int pageno,
+                      int offset, int len, char *dest);
 extern int PagenoMappingPartitionno(LruCtl ctl, int pageno);
 extern LWLock * GetPartitionLock(LruCtl ctl, int partitionno);
 extern void LruWritePage(LruCtl ctl, int partitionno, int slotno);
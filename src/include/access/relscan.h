@@ -101,6 +101,12 @@ typedef struct ParallelHeapScanDescData
     BlockNumber phs_startblock; /* starting block number */
 	pg_atomic_uint64 phs_nallocated;	/* number of blocks allocated to
 										 * workers so far. */
+#ifdef _SHARDING_
+    bool        phs_extentscan;  /* hand out extents instead of blocks,
+                                  * phs_nallocated counts extents then */
+    int32       phs_nextents;    /* number of extents to scan */
+    Size        phs_extents_off; /* offset of the ExtentID array */
+#endif
     char        phs_snapshot_data[FLEXIBLE_ARRAY_MEMBER];
 }            ParallelHeapScanDescData;
 
@@ -125,6 +131,10 @@ typedef struct HeapScanDescData
     /* rs_numblocks is usually InvalidBlockNumber, meaning "scan whole rel" */
     BufferAccessStrategy rs_strategy;    /* access strategy for reads */
     bool        rs_syncscan;    /* report location to syncscan logic? */
+#ifdef __TBASE__
+    BlockNumber rs_prefetch_next;    /* next block to read ahead */
+    Buffer        rs_vmbuffer;    /* visibility map page pinned across pages */
+#endif
 
     /* scan current state */
     bool        rs_inited;        /* false = scan not init'd yet */
@@ -134,6 +144,15 @@ typedef struct HeapScanDescData
     Buffer        rs_cbuf;        /* current buffer in scan, if any */
     /* NB: if rs_cbuf is not InvalidBuffer, we hold a pin on that buffer */
     ParallelHeapScanDesc rs_parallel;    /* parallel scan information */
+#ifdef _SHARDING_
+    /* range of the extent taken from rs_parallel in extent mode */
+    BlockNumber rs_extent_next;    /* next block to scan in the extent */
+    BlockNumber rs_extent_end;    /* first block after the extent */
+    /* extents the zone filter or shard visibility rule out are stepped over */
+    struct ExtentZoneFilter *rs_zonefilter;
+    ExtentID    rs_zone_eid;    /* extent rs_zone_skip was decided for */
+    bool        rs_zone_skip;
+#endif
 
 #ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
     /* statistic account */
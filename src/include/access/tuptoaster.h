@@ -211,6 +211,22 @@ extern HeapTuple toast_build_flattened_tuple(TupleDesc tupleDesc,
  * ----------
  */
 extern Datum toast_compress_datum(Datum value);
+extern Datum toast_compress_datum_method(Datum value, int cmethod);
+
+/*
+ * Compression methods of toasted values, see VARCOMPMETHOD_4B_C. Columns
+ * pick one with the "compression" attribute option, the others use
+ * default_toast_compression.
+ */
+#define TOAST_PGLZ_COMPRESSION_ID    0
+#define TOAST_LZ4_COMPRESSION_ID    1
+#define TOAST_ZSTD_COMPRESSION_ID    2
+
+extern int    default_toast_compression;
+
+extern int    toast_compression_method(const char *name);
+extern void validate_toast_compression(char *value);
+extern int    toast_get_compression_method(struct varlena *attr);
 
 /* ----------
  * toast_raw_datum_size -
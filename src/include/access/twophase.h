@@ -92,6 +92,9 @@ extern int    max_prepared_xacts;
 
 extern int  transaction_threshold;
 
+extern bool enable_async_commit_prepared;
+extern void AtIdle_AsyncCommitRecords(void);
+
 extern Size TwoPhaseShmemSize(void);
 extern void TwoPhaseShmemInit(void);
 
@@ -57,6 +57,9 @@ extern bool XactReadOnly;
 
 #ifdef __TBASE__
 extern bool GTM_ReadOnly;
+
+/* time the last commit spent committing on remote nodes, in microseconds */
+extern int64 XactRemoteCommitTime;
 #endif
 
 /*
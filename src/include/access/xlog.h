@@ -110,7 +110,7 @@ extern char *XLogArchiveCommand;
 extern bool EnableHotStandby;
 extern bool fullPageWrites;
 extern bool wal_log_hints;
-extern bool wal_compression;
+extern int    wal_compression;
 extern bool *wal_consistency_checking;
 extern char *wal_consistency_checking_string;
 extern bool log_checkpoints;
@@ -118,6 +118,7 @@ extern bool log_checkpoints;
 extern int    CheckPointSegments;
 #ifdef __TBASE__
 extern int    wal_gts_track_entries;
+extern int    wal_insert_locks;
 
 extern bool i_am_standby;
 
@@ -132,6 +133,15 @@ typedef enum ArchiveMode
 } ArchiveMode;
 extern int    XLogArchiveMode;
 
+/* Compression methods for full-page images, see wal_compression */
+typedef enum WalCompression
+{
+    WAL_COMPRESSION_NONE = 0,
+    WAL_COMPRESSION_PGLZ,
+    WAL_COMPRESSION_LZ4,
+    WAL_COMPRESSION_ZSTD
+} WalCompression;
+
 /* WAL levels */
 typedef enum WalLevel
 {
@@ -286,6 +296,11 @@ extern XLogRecPtr GetRedoRecPtr(void);
 extern XLogRecPtr GetInsertRecPtr(void);
 extern XLogRecPtr GetFlushRecPtr(void);
 extern XLogRecPtr GetLastImportantRecPtr(void);
+#ifdef __TBASE__
+extern void GetXLogFlushStats(uint64 *insert_lock_waits, uint64 *flush_requests,
+                  uint64 *flush_grouped, uint64 *flush_wait_time,
+                  uint64 *syncs, uint64 *sync_time);
+#endif
 extern void GetNextXidAndEpoch(TransactionId *xid, uint32 *epoch);
 extern void RemovePromoteSignalFiles(void);
 
@@ -0,0 +1,26 @@
+/*-------------------------------------------------------------------------
+ *
+ * xlogprefetch.h
+ *        Prefetching of data blocks referenced by WAL ahead of redo.
+ *
+ * Portions Copyright (c) 2020-Present, TBase Development Team, Tencent
+ *
+ * src/include/access/xlogprefetch.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef XLOGPREFETCH_H
+#define XLOGPREFETCH_H
+
+#include "access/xlogdefs.h"
+
+extern int recovery_prefetch_distance;
+
+typedef struct XLogPrefetcher XLogPrefetcher;
+
+extern XLogPrefetcher *XLogPrefetcherAllocate(void);
+extern void XLogPrefetcherFree(XLogPrefetcher *prefetcher);
+extern void XLogPrefetcherReadAhead(XLogPrefetcher *prefetcher,
+                        XLogRecPtr replayPtr, TimeLineID tli);
+
+#endif                            /* XLOGPREFETCH_H */
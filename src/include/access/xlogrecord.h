@@ -203,7 +203,7 @@ typedef struct XLogRecordBlockImageHeader
     uint8        bimg_info;        /* flag bits, see below */
 
     /*
-     * If BKPIMAGE_HAS_HOLE and BKPIMAGE_IS_COMPRESSED, an
+     * If BKPIMAGE_HAS_HOLE and BKPIMAGE_COMPRESSED(), an
      * XLogRecordBlockCompressHeader struct follows.
      */
 } XLogRecordBlockImageHeader;
@@ -213,9 +213,23 @@ typedef struct XLogRecordBlockImageHeader
 
 /* Information stored in bimg_info */
 #define BKPIMAGE_HAS_HOLE        0x01    /* page image has "hole" */
-#define BKPIMAGE_IS_COMPRESSED        0x02    /* page image is compressed */
+#define BKPIMAGE_IS_COMPRESSED        0x02    /* page image is compressed
+                                             * with pglz */
 #define BKPIMAGE_APPLY        0x04    /* page image should be restored during
                                      * replay */
+#ifdef __TBASE__
+#define BKPIMAGE_COMPRESS_LZ4        0x08    /* page image is compressed
+                                             * with lz4 */
+#define BKPIMAGE_COMPRESS_ZSTD        0x10    /* page image is compressed
+                                             * with zstd */
+
+#define BKPIMAGE_COMPRESSED(info) \
+    (((info) & (BKPIMAGE_IS_COMPRESSED | BKPIMAGE_COMPRESS_LZ4 | \
+                BKPIMAGE_COMPRESS_ZSTD)) != 0)
+#else
+#define BKPIMAGE_COMPRESSED(info) \
+    (((info) & BKPIMAGE_IS_COMPRESSED) != 0)
+#endif
 
 /*
  * Extra header information used when page image has "hole" and
@@ -53,6 +53,6 @@
  */
 
 /*                            yyyymmddN */
-#define CATALOG_VERSION_NO    201707211
+#define CATALOG_VERSION_NO    202610152
 
 #endif
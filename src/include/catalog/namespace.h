@@ -193,6 +193,9 @@ extern void GetTempNamespaceState(Oid *tempNamespaceId,
                       Oid *tempToastNamespaceId);
 extern void SetTempNamespaceState(Oid tempNamespaceId,
                       Oid tempToastNamespaceId);
+#ifdef __TBASE__
+extern bool TempNamespaceHasObjects(void);
+#endif
 extern void ResetTempTableNamespace(void);
 #ifdef XCP
 extern void ForgetTempTableNamespace(void);
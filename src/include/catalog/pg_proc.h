@@ -5441,7 +5441,7 @@ DATA(insert OID = 3779 (  pg_create_physical_replication_slot PGNSP PGUID 12 1 0
 DESCR("create a physical replication slot");
 DATA(insert OID = 3780 (  pg_drop_replication_slot PGNSP PGUID 12 1 0 0 0 f f f f t f v u 1 0 2278 "19" _null_ _null_ _null_ _null_ _null_ pg_drop_replication_slot _null_ _null_ _null_ ));
 DESCR("drop a replication slot");
-DATA(insert OID = 3781 (  pg_get_replication_slots    PGNSP PGUID 12 1 10 0 0 f f f f f t s s 0 0 2249 "" "{19,19,25,26,16,16,23,28,28,3220,3220}" "{o,o,o,o,o,o,o,o,o,o,o}" "{slot_name,plugin,slot_type,datoid,temporary,active,active_pid,xmin,catalog_xmin,restart_lsn,confirmed_flush_lsn}" _null_ _null_ pg_get_replication_slots _null_ _null_ _null_ ));
+DATA(insert OID = 3781 (  pg_get_replication_slots    PGNSP PGUID 12 1 10 0 0 f f f f f t s s 0 0 2249 "" "{19,19,25,26,16,16,23,28,28,3220,3220,20}" "{o,o,o,o,o,o,o,o,o,o,o,o}" "{slot_name,plugin,slot_type,datoid,temporary,active,active_pid,xmin,catalog_xmin,restart_lsn,confirmed_flush_lsn,shard_skipped}" _null_ _null_ pg_get_replication_slots _null_ _null_ _null_ ));
 DESCR("information about replication slots currently in use");
 DATA(insert OID = 3786 (  pg_create_logical_replication_slot PGNSP PGUID 12 1 0 0 0 f f f f t f v u 3 0 2249 "19 19 16" "{19,19,16,25,3220}" "{i,i,i,o,o}" "{slot_name,plugin,temporary,slot_name,lsn}" _null_ _null_ pg_create_logical_replication_slot _null_ _null_ _null_ ));
 DESCR("set up a logical replication slot");
@@ -5527,6 +5527,8 @@ DATA(insert OID = 7007 ( pgxc_pool_check    PGNSP PGUID 12 1 0 0 0 f f f f t f v
 DESCR("check connection information consistency in pooler");
 DATA(insert OID = 7008 ( pgxc_pool_reload    PGNSP PGUID 12 1 0 0 0 f f f f t f v u 0 0 16 "" _null_ _null_ _null_ _null_ _null_ pgxc_pool_reload _null_ _null_ _null_ ));
 DESCR("reload connection information in pooler and reload server sessions");
+DATA(insert OID = 5038 ( pgxc_pool_refresh    PGNSP PGUID 12 1 0 0 0 f f f f t f v u 0 0 16 "" _null_ _null_ _null_ _null_ _null_ pgxc_pool_refresh _null_ _null_ _null_ ));
+DESCR("redirect pooler connections of altered nodes without reloading server sessions");
 DATA(insert OID = 7009 ( pgxc_node_str        PGNSP PGUID 12 1 0 0 0 f f f f t f s u 0 0 19 "" _null_ _null_ _null_ _null_ _null_ pgxc_node_str _null_ _null_ _null_ ));
 DESCR("get the name of the node");
 DATA(insert OID = 7010 (  pgxc_is_committed    PGNSP PGUID 12 1 1 0 0 f f f f t t s u 1 0 16 "28" _null_ _null_ _null_ _null_ _null_ pgxc_is_committed _null_ _null_ _null_ ));
@@ -6675,6 +6677,14 @@ DESCR("gtm store: check gtm stored sequence status");
 DATA(insert OID = 5011 (  pg_check_storage_transaction        PGNSP PGUID 12 1 0 0 0 f f f f f f s r 1 0 2249 "16" "{16,25,25,23,23,1184,23,23,23,23}" "{i,o,o,o,o,o,o,o,o,o}" "{need_fix, gti_gid,node_list,gti_state,gti_store_handle,last_update_time,gs_next,gs_crc,error_msg,check_status}" _null_ _null_ pg_check_storage_transaction _null_ _null_ _null_ ));
 DESCR("gtm store: list gtm stored sequence info");
 
+DATA(insert OID = 5032 (  pg_gtm_latency_statistics        PGNSP PGUID 12 1 100 0 0 f f f f t t v r 1 0 2249 "16" "{16,23,23,23,25,20,20}" "{i,o,o,o,o,o,o}" "{clear,thread_id,last_ready,max_ready,command,latency_below_us,requests}" _null_ _null_ pg_gtm_latency_statistics _null_ _null_ _null_ ));
+DESCR("gtm statistics: latency histograms of gtm worker threads");
+
+DATA(insert OID = 5033 (  pg_stat_get_squeues        PGNSP PGUID 12 1 100 0 0 f f f f f t v r 0 0 2249 "" "{25,23,23,23,23,23,25,23,20,20,20,20,20,20,20,20,20,20}" "{o,o,o,o,o,o,o,o,o,o,o,o,o,o,o,o,o,o}" "{squeue,producer_pid,producer_node,consumer_index,consumer_node,consumer_pid,status,queued_rows,rows,bytes,full_count,full_wait_us,read_wait_us,spill_rows,spill_bytes,send_bytes,send_blocked,send_errors}" _null_ _null_ pg_stat_get_squeues _null_ _null_ _null_ ));
+DESCR("statistics: throughput counters of active shared queue consumers");
+DATA(insert OID = 5034 (  pg_stat_get_squeue_nodes        PGNSP PGUID 12 1 100 0 0 f f f f f t v r 0 0 2249 "" "{23,20,20,20,20,20,20,20,20,20,20}" "{o,o,o,o,o,o,o,o,o,o,o}" "{consumer_node,rows,bytes,full_count,full_wait_us,read_wait_us,spill_rows,spill_bytes,send_bytes,send_blocked,send_errors}" _null_ _null_ pg_stat_get_squeue_nodes _null_ _null_ _null_ ));
+DESCR("statistics: shared queue throughput counters summed up per consumer node");
+
 DATA(insert OID = 8001 (  show_node_lock PGNSP PGUID 12 1 1000 0 0 f f f f t t v s 0 0 2249 "" "{25,25,25,25,25,25}" "{o,o,o,o,o,o}" "{HeavyLock,LightLock,Schema,Table,Shard,EventLock}" _null_ _null_ show_node_lock _null_ _null_ _null_ ));
 DESCR("show information about node lock");
 DATA(insert OID = 8002 (  pg_node_lock PGNSP PGUID 12 1 0 0 0 f f f f t f v s 6 0 16 "25 18 25 25 23 25" _null_ _null_ _null_ _null_  _null_ pg_node_lock _null_ _null_ _null_ ));
@@ -6699,6 +6709,9 @@ DESCR("stat dual write info");
 
 DATA(insert OID = 8009 (  pg_stat_node_access PGNSP PGUID 12 1 1000 0 0 f f f f t t v s 0 0 2249 "" "{25}" "{o}" "{access}" _null_ _null_ pg_stat_node_access _null_ _null_ _null_ ));
 DESCR("stat data node access mode");
+
+DATA(insert OID = 8010 (  pg_get_cold_partitions PGNSP PGUID 12 1 1000 0 0 f f f f t t v s 1 0 2249 "2205" "{2205,2205,23}" "{i,o,o}" "{relation, partition, partition_index}" _null_ _null_ pg_get_cold_partitions _null_ _null_ _null_ ));
+DESCR("list interval partitions older than the hot data boundary");
 #endif
 #ifdef _MLS_
 DATA(insert OID = 4593 (  clsitemin    PGNSP PGUID 12 1 0 0 0 f f f f t f s s 1 0 4591 "2275" _null_ _null_ _null_ _null_ _null_ clsitemin    _null_ _null_ _null_ ));
@@ -6769,6 +6782,30 @@ DATA(insert OID = 4619 (  vacuum_hidden_shards    PGNSP PGUID 12 1 0 0 0 f f f f
 DESCR("vacuum hidden shards");
 DATA(insert OID = 4620 (  tbase_shard_statistic PGNSP PGUID 12 1 0 0 0 f f f f t t v r 0 0 2249 "" "{25,25,23,20,20,20,20,20,20}" "{o,o,o,o,o,o,o,o,o}" "{group_name,node_name,shard_id,ntups_select,ntups_insert,ntups_update,ntups_delete,size,ntups}" _null_ _null_ tbase_shard_statistic _null_ _null_ _null_ ));
 DESCR("show statistic data of all shards");
+DATA(insert OID = 5035 (  tbase_shard_io_statistic PGNSP PGUID 12 1 100 0 0 f f f f t t v r 0 0 2249 "" "{25,23,20,20,20}" "{o,o,o,o,o}" "{node_name,shard_id,blks_read,blks_hit,blks_written}" _null_ _null_ tbase_shard_io_statistic _null_ _null_ _null_ ));
+DESCR("statistics: buffer reads, hits and writes per shard");
+DATA(insert OID = 5040 (  tbase_shard_rebalance_plan PGNSP PGUID 12 1 100 0 0 f f f f t t s r 1 0 2249 "25" "{25,23,25,25}" "{i,o,o,o}" "{group_name,shardgroupid,from_node,to_node}" _null_ _null_ tbase_shard_rebalance_plan _null_ _null_ _null_ ));
+DESCR("shard group moves that balance a node group over its datanodes");
+DATA(insert OID = 5041 (  tbase_shard_rebalance_plan PGNSP PGUID 12 1 100 0 0 f f f f f t s r 3 0 2249 "25 1007 1022" "{25,1007,1022,23,25,25}" "{i,i,i,o,o,o}" "{group_name,shardgroupids,loads,shardgroupid,from_node,to_node}" _null_ _null_ tbase_shard_rebalance_plan _null_ _null_ _null_ ));
+DESCR("shard group moves that balance the given shard group loads over a node group");
+DATA(insert OID = 5042 (  pg_lock_wait_graph PGNSP PGUID 12 1 100 0 0 f f f f t t v r 0 0 2249 "" "{25,23,25,23}" "{o,o,o,o}" "{waiter_gxid,waiter_pid,holder_gxid,holder_pid}" _null_ _null_ pg_lock_wait_graph _null_ _null_ _null_ ));
+DESCR("wait-for edges between distributed transactions on this node");
+DATA(insert OID = 5043 (  pg_cancel_global_xid PGNSP PGUID 12 1 0 0 0 f f f f t f v u 1 0 23 "25" _null_ _null_ _null_ _null_ _null_ pg_cancel_global_xid _null_ _null_ _null_ ));
+DESCR("cancel the lock waits of a distributed transaction as deadlock victim");
+DATA(insert OID = 5044 (  pg_detect_global_deadlock PGNSP PGUID 12 1 0 0 0 f f f f t f v u 0 0 23 "" _null_ _null_ _null_ _null_ _null_ pg_detect_global_deadlock _null_ _null_ _null_ ));
+DESCR("detect and break deadlocks spanning several datanodes");
+DATA(insert OID = 5045 (  pg_column_compression PGNSP PGUID 12 1 0 0 0 f f f f t f s s 1 0 25 "2276" _null_ _null_ _null_ _null_ _null_ pg_column_compression _null_ _null_ _null_ ));
+DESCR("compression method of a toasted value");
+DATA(insert OID = 5046 (  cluster_unique_id PGNSP PGUID 12 1 0 0 0 f f f f t f v u 0 0 20 "" _null_ _null_ _null_ _null_ _null_ cluster_unique_id _null_ _null_ _null_ ));
+DESCR("cluster-unique 64-bit id made of time and node, without GTM");
+DATA(insert OID = 5047 (  pg_stat_get_fqs_cache PGNSP PGUID 12 1 0 0 0 f f f f f f v r 0 0 2249 "" "{20,20,20}" "{o,o,o}" "{hits,misses,entries}" _null_ _null_ pg_stat_get_fqs_cache _null_ _null_ _null_ ));
+DESCR("statistics: FQS decision cache of this backend");
+DATA(insert OID = 5036 (  pg_stat_get_wal_flush PGNSP PGUID 12 1 0 0 0 f f f f f f v r 0 0 2249 "" "{20,20,20,701,20,701}" "{o,o,o,o,o,o}" "{insert_lock_waits,flush_requests,flush_grouped,flush_wait_time,syncs,sync_time}" _null_ _null_ pg_stat_get_wal_flush _null_ _null_ _null_ ));
+DESCR("statistics: WAL insertion lock waits and group flush");
+DATA(insert OID = 5037 (  pg_export_global_timestamp PGNSP PGUID 12 1 0 0 0 f f f f t f v u 0 0 20 "" _null_ _null_ _null_ _null_ _null_ pg_export_global_timestamp _null_ _null_ _null_ ));
+DESCR("export the global timestamp of the transaction snapshot");
+DATA(insert OID = 5039 (  pg_last_replay_global_timestamp PGNSP PGUID 12 1 0 0 0 f f f f t f v s 0 0 20 "" _null_ _null_ _null_ _null_ _null_ pg_last_replay_global_timestamp _null_ _null_ _null_ ));
+DESCR("global timestamp of last replayed commit");
 
 DATA(insert OID = 4628 (  tbase_set_need_mvcc PGNSP PGUID 12 1 0 0 0 f f f f t f v r 1 0 16 "23" _null_ _null_ _null_ _null_ _null_ tbase_set_need_mvcc _null_ _null_ _null_ ));
 DESCR("set need_mvcc flag");
@@ -102,4 +102,6 @@ extern char *BuildRelationCheckoverlapsStr(DistributeBy *distributeby, PGXCSubCl
 
 extern Oid GetKeyValuesGroup(Oid db, Oid rel, char *value, Oid *coldgroup);
 
-extern bool IsKeyValues(Oid db, Oid rel, char *value);
\ No newline at end of file
+extern bool IsKeyValues(Oid db, Oid rel, char *value);
+
+extern Oid GetKeyValuesGroupByDatum(Oid rel, Oid type, Datum value, Oid *coldgroup);
\ No newline at end of file
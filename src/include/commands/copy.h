@@ -41,4 +41,8 @@ extern uint64 CopyFrom(CopyState cstate);
 
 extern DestReceiver *CreateCopyDestReceiver(void);
 
+#ifdef _SHARDING_
+extern int shard_copy_rate_limit;
+#endif
+
 #endif                            /* COPY_H */
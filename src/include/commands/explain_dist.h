@@ -30,6 +30,7 @@ typedef struct RemoteInstr
 	
 	int nodeTag;            /* type of current plan node */
 	Instrumentation instr;  /* instrument of current plan node */
+	Size memory;            /* workspace memory of current plan node */
 	
 	/* for Gather and Sort */
 	int nworkers_launched;  /* worker num of gather or sort */
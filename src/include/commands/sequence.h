@@ -153,6 +153,15 @@ extern bool IsTempSequence(Oid relid);
 extern char *GetGlobalSeqName(Relation rel, const char *new_seqname, const char *new_schemaname);
 #ifdef __TBASE__
 extern void RenameDatabaseSequence(const char* oldname, const char* newname);
+
+extern int shared_sequence_cache_size;
+
+extern Size SharedSeqCacheShmemSize(void);
+extern void SharedSeqCacheShmemInit(void);
+extern void SharedSeqCacheInvalidate(Oid dbid, Oid relid);
+
+extern Size UniqueIdShmemSize(void);
+extern void UniqueIdShmemInit(void);
 #endif
 #endif
 
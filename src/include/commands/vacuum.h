@@ -220,6 +220,7 @@ extern int	vacuum_multixact_freeze_table_age;
 
 #ifdef __TBASE__
 extern bool	enable_sampling_analyze;
+extern bool	interval_incremental_analyze;
 extern bool distributed_query_analyze;
 extern bool explain_query_analyze;
 
@@ -65,6 +65,16 @@ typedef struct PGLZ_Strategy
 } PGLZ_Strategy;
 
 
+/* ----------
+ * PGLZ_Workspace -
+ *
+ *        Opaque work area for pglz_compress_workspace, allocate it with
+ *        pglz_workspace_size() bytes.
+ * ----------
+ */
+typedef struct PGLZ_Workspace PGLZ_Workspace;
+
+
 /* ----------
  * The standard strategies
  *
@@ -85,6 +95,10 @@ extern const PGLZ_Strategy *const PGLZ_strategy_always;
  */
 extern int32 pglz_compress(const char *source, int32 slen, char *dest,
               const PGLZ_Strategy *strategy);
+extern size_t pglz_workspace_size(void);
+extern int32 pglz_compress_workspace(const char *source, int32 slen,
+                        char *dest, const PGLZ_Strategy *strategy,
+                        PGLZ_Workspace *ws);
 extern int32 pglz_decompress(const char *source, int32 slen, char *dest,
                 int32 rawsize);
 
@@ -486,6 +486,10 @@ extern void end_tup_output(TupOutputState *tstate);
  */
 extern EState *CreateExecutorState(void);
 extern void FreeExecutorState(EState *estate);
+#ifdef __TBASE__
+extern void ExecAssignWorkMem(EState *estate, PlannedStmt *plannedstmt);
+extern int  ExecWorkMem(EState *estate);
+#endif
 extern ExprContext *CreateExprContext(EState *estate);
 extern ExprContext *CreateStandaloneExprContext(void);
 extern void FreeExprContext(ExprContext *econtext, bool isCommit);
@@ -74,6 +74,7 @@ typedef struct RemoteInstrumentation
 {
 	int              nodeid;    /* which datanode the instrument comes from */
 	Instrumentation  instr;     /* the instrumentation */
+	Size             memory;    /* workspace memory of the node, in bytes */
 } RemoteInstrumentation;
 
 typedef struct DatanodeInstrumentation
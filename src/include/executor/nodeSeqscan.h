@@ -17,6 +17,10 @@
 #include "access/parallel.h"
 #include "nodes/execnodes.h"
 
+#ifdef _SHARDING_
+extern bool enable_parallel_shard_scan;
+#endif
+
 extern SeqScanState *ExecInitSeqScan(SeqScan *node, EState *estate, int eflags);
 extern void ExecEndSeqScan(SeqScanState *node);
 extern void ExecReScanSeqScan(SeqScanState *node);
@@ -37,5 +37,6 @@ extern bool ProducerReceiverPushBuffers(DestReceiver *self);
 
 #ifdef __TBASE__
 extern void SetProducerNodeMap(DestReceiver *self, int16 *nodemap);
+extern void SetProducerSelfFilter(DestReceiver *self, SQueueFilterCache *filter);
 #endif
 #endif   /* PRODUCER_RECEIVER_H */
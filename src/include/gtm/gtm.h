@@ -102,6 +102,7 @@ typedef struct GTM_ThreadInfo
 #endif
     GTM_WorkerStatistics  *stat_handle;     /* statistics hanndle */
     DataPumpBuf           *datapump_buff;   /* log collection buff */
+    DataPumpBuf           *txnlog_buff;     /* transaction trace buff, if enable_gtm_debug */
 } GTM_ThreadInfo;
 
 typedef struct GTM_Threads
@@ -150,6 +151,7 @@ extern void
 GTM_RemoveConnection(GTM_ConnectionInfo *conn);
 #ifdef __TBASE__
 extern   bool    enable_gtm_sequence_debug;
+extern   int     gtm_sequence_reserve_count;
 extern     bool     enable_gtm_debug;
 extern   bool   enable_sync_commit;
 extern   int    warnning_time_cost;
@@ -334,6 +334,35 @@ typedef struct GTM_TransactionDebugInfo
     
 } GTM_TransactionDebugInfo;
 
+/*
+ * Transaction and scan trace record.  Service threads queue these into their
+ * own datapump buffer, and the log collector thread drains them in batches.
+ * The gid, node string and relation name follow, each NUL terminated.
+ */
+typedef struct GTM_TxnLogRecord
+{
+    int32                        entryType;        /* GTMTypeTransaction or GTMTypeScan */
+    GlobalTransactionId            gxid;
+    int32                        node_count;
+    int32                        isGlobal;
+    int32                        isCommit;
+    int32                        scan_type;
+    GTM_Timestamp               prepare_timestamp;
+    GTM_Timestamp               commit_timestamp;
+    GTM_Timestamp               start_timestamp;
+    GTM_Timestamp               local_start_timestamp;
+    GTM_Timestamp               local_complete_timestamp;
+    int64                        scan_number;
+    uint32                        gid_len;
+    uint32                        nodestring_len;
+    uint32                        rel_name_len;
+} GTM_TxnLogRecord;
+
+#define GTM_TXN_LOG_MAX_RELNAME_LEN    256
+#define GTM_TXN_LOG_MAX_RECORD_LEN \
+    (sizeof(GTM_TxnLogRecord) + GTM_MAX_SESSION_ID_LEN + \
+     NODE_STRING_MAX_LENGTH + GTM_TXN_LOG_MAX_RELNAME_LEN)
+
 
 
 typedef struct GTM_StoredHashTable
@@ -393,6 +422,7 @@ typedef enum
 #define GTM_SYNC_CYCLE                     (5   * GTM_GTS_ONE_SECOND)
 #define GTM_SYNC_TIME_LIMIT              (60  * GTM_GTS_ONE_SECOND)
 #define GTM_LOG_COLLECT_CYCLE		     (5   * GTM_GTS_ONE_SECOND)
+#define GTM_TXN_LOG_COLLECT_CYCLE        (100 * 1000L)
 
 #pragma pack()
 
@@ -248,6 +248,12 @@ typedef struct GTM_Result
         char* errlog;
     } grd_errlog;
 
+    struct
+    {
+        int32                  count;
+        GTM_ThreadLatencyItem *threads;
+    } grd_latency;
+
 #endif
     /*
      * We keep these two items outside the union to avoid repeated malloc/free
@@ -297,6 +303,8 @@ int bkup_begin_transaction(GTM_Conn *conn, GTM_IsolationLevel isolevel,
                            uint32 client_id, GTM_Timestamp timestamp);
 #ifdef __TBASE__
 Get_GTS_Result get_global_timestamp(GTM_Conn *conn);
+int get_global_timestamp_send(GTM_Conn *conn);
+Get_GTS_Result get_global_timestamp_receive(GTM_Conn *conn);
 #ifdef __XLOG__
 int check_gtm_status(GTM_Conn *conn, int *status, GTM_Timestamp *master,XLogRecPtr *master_ptr,
                      int *standby_count,int **slave_is_sync, GTM_Timestamp **standby ,
@@ -307,6 +315,7 @@ int check_gtm_status(GTM_Conn *conn, int *status, GTM_Timestamp *master, GTM_Tim
 int bkup_global_timestamp(GTM_Conn *conn, GlobalTimestamp timestamp);
 int get_gtm_statistics(GTM_Conn *conn, int clear_flag, int timeout_seconds, GTM_StatisticsResult** result);
 int get_gtm_errlog(GTM_Conn *conn, int timeout_seconds, char** errlog, int* len);
+int get_gtm_latency_statistics(GTM_Conn *conn, int clear_flag, int timeout_seconds, GTM_ThreadLatencyItem** threads);
 
 #endif
 
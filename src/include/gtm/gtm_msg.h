@@ -123,6 +123,7 @@ typedef enum GTM_MessageType
 #endif
     MSG_GET_STATISTICS,
     MSG_GET_ERRORLOG,
+    MSG_GET_LATENCY_STATISTICS,
 
     /*
      * Must be at the end
@@ -208,6 +209,7 @@ typedef enum GTM_ResultType
 
     MSG_GET_GTM_STATISTICS_RESULT,
     MSG_GET_GTM_ERRORLOG_RESULT,
+    MSG_GET_GTM_LATENCY_STATISTICS_RESULT,
 
 	RESULT_TYPE_COUNT
 } GTM_ResultType;
@@ -42,11 +42,43 @@ typedef struct
     pg_atomic_uint32 min_costtime;
 } CACHE_LINE_ALIGN GTM_StatisticsInfo;
 
+/* Command groups with a latency histogram */
+typedef enum GTM_Latency_Cmd
+{
+    LATENCY_TXN_BEGIN,
+    LATENCY_GETGTS,
+    LATENCY_SNAPSHOT,
+    LATENCY_TXN_COMMIT,
+    LATENCY_SEQUENCE,
+    LATENCY_OTHER,
+    LATENCY_CMD_COUNT
+} GTM_LatencyCmd;
+
+/*
+ * Latency histogram buckets in microseconds, bucket 0 counts commands
+ * under 1us, bucket i those in [2^(i-1), 2^i) and the last one all slower.
+ */
+#define GTM_LATENCY_BUCKETS        24
+
 typedef struct
 {
     GTM_StatisticsInfo cmd_statistics[CMD_STATISTICS_TYPE_COUNT];
+
+    /* only written by the owning thread */
+    uint32     latency[LATENCY_CMD_COUNT][GTM_LATENCY_BUCKETS];
+    uint32     last_ready;         /* connections ready at last epoll wakeup */
+    uint32     max_ready;          /* most connections ready at one wakeup */
 } GTM_WorkerStatistics;
 
+/* Latency statistics of one worker thread, sent as is to the client */
+typedef struct
+{
+    uint32     thread_id;          /* index in GTMThreads */
+    uint32     last_ready;
+    uint32     max_ready;
+    uint32     latency[LATENCY_CMD_COUNT][GTM_LATENCY_BUCKETS];
+} GTM_ThreadLatencyItem;
+
 typedef struct
 {
     uint32     total_request_times;
@@ -59,6 +91,18 @@ typedef struct
     uint32     min_costtime;
 } GTM_StatisticsItem;
 
+/* Standbys reported in one statistics result, further ones are skipped */
+#define GTM_STAT_MAX_STANDBYS      16
+#define GTM_STAT_NAME_LEN          64
+
+typedef struct
+{
+    char       application_name[GTM_STAT_NAME_LEN];
+    uint64     write_ptr;                  /* xlog received by the standby */
+    uint64     flush_ptr;                  /* xlog flushed by the standby */
+    uint64     replay_ptr;                 /* xlog replayed by the standby */
+} GTM_StandbyStatItem;
+
 typedef struct
 {
     pg_time_t          start_time;                            /* statistics info start time */
@@ -66,6 +110,20 @@ typedef struct
     int32              sequences_remained;                    /* sequence remained num */
     int32              txn_remained;                          /* txn remained num */
     GTM_StatisticsItem stat_info[CMD_STATISTICS_TYPE_COUNT];  /* specific cmd statistics info */
+
+    /*
+     * Replication progress, absent (has_xlog_stat false) when talking to an
+     * older GTM. On a standby the local positions are what it received,
+     * flushed and replayed; on the master all three are its flush position
+     * and standbys lists what each connected standby reported.
+     */
+    bool               has_xlog_stat;
+    bool               is_standby;
+    uint64             write_ptr;
+    uint64             flush_ptr;
+    uint64             apply_ptr;
+    int32              standby_count;
+    GTM_StandbyStatItem standbys[GTM_STAT_MAX_STANDBYS];
 } GTM_StatisticsResult;
 
 typedef struct
@@ -82,5 +140,11 @@ void GTM_InitStatisticsHandle(void);
 
 void GTM_UpdateStatistics(GTM_WorkerStatistics* stat_handle, GTM_MessageType mtype, uint32 costtime);
 
+void GTM_UpdateLatency(GTM_WorkerStatistics* stat_handle, GTM_MessageType mtype, uint64 costtime_us);
+
+void GTM_UpdateReadyCount(GTM_WorkerStatistics* stat_handle, int nready);
+
 void ProcessGetStatisticsCommand(Port *myport, StringInfo message);
+
+void ProcessGetLatencyStatisticsCommand(Port *myport, StringInfo message);
 #endif
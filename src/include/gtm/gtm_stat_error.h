@@ -23,6 +23,7 @@
 #define GTM_BLOOM_FILTER_SIZE (1 * 1024 * 1024)
 #define GTM_GLOBAL_ERRLOG_DATAPUMP_SIZE (10 * 1024) /* k */
 #define GTM_THREAD_ERRLOG_DATAPUMP_SIZE (16) /* k */
+#define GTM_THREAD_TXNLOG_DATAPUMP_SIZE (1024) /* k */
 
 typedef int64 pg_time_t;
 
@@ -149,6 +149,7 @@ extern int32 GTM_StoreLogScan(GlobalTransactionId gxid,
                                 int scan_type,
                                  const char *rel_name,
                                  int64 scan_number);
+extern void GTM_StoreProcessTxnLog(void);
 extern GTMStorageHandle GTM_StoreGetPreparedTxnInfo(char *gid, GlobalTransactionId *gxid, char **nodestring);
 extern int32 GTM_StoreCommitTxn(char *gid);
 extern int32 GTM_StoreAbortTxn(char *gid);
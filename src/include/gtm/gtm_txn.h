@@ -165,6 +165,8 @@ typedef struct GTM_Transactions
     GTM_RWLock            gt_TransArrayLock;
     pg_atomic_uint32    gt_global_xid;
 
+    /* odd while gt_last_cycle/gt_global_timestamp are being changed */
+    pg_atomic_uint32    gt_timestamp_seq;
     GlobalTimestamp        gt_last_cycle;
     GlobalTimestamp     gt_global_timestamp;
     /* For debug purpose */
@@ -134,6 +134,7 @@ typedef struct XLogCtlData
     pg_time_t        segment_max_timestamp;
 
     GTM_MutexLock  walwrite_lck;
+    GTM_MutexLock  commit_delay_lck;  /* held by the flush gathering a group */
     uint64         last_write_idx;
     
     s_lock_t       walwirte_info_lck;
@@ -148,6 +149,8 @@ typedef struct XLogCtlData
     GTM_RWLock     standby_info_lck;
     XLogRecPtr     write_buff_pos;   /* how far we write xlog in buff */
     XLogRecPtr     apply;            /* how far we redo xlog */
+    GTM_MutexLock  redo_wait_lck;
+    GTM_CV         redo_wait_cv;     /* redoer waits here for more xlog */
     
 } XLogCtlData;
 
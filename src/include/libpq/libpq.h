@@ -70,6 +70,9 @@ extern int    pq_getmessage(StringInfo s, int maxlen);
 extern int    pq_getbyte(void);
 extern int    pq_peekbyte(void);
 extern int    pq_getbyte_if_available(unsigned char *c);
+#ifdef __TBASE__
+extern int    pq_peekbyte_if_available(unsigned char *c);
+#endif
 extern int    pq_putbytes(const char *s, size_t len);
 
 /*
@@ -331,6 +331,9 @@ extern bool enableFsync;
 extern bool allowSystemTableMods;
 extern PGDLLIMPORT int work_mem;
 extern PGDLLIMPORT int maintenance_work_mem;
+#ifdef __TBASE__
+extern PGDLLIMPORT int query_work_mem;
+#endif
 extern PGDLLIMPORT int replacement_sort_tuples;
 
 extern int    VacuumCostPageHit;
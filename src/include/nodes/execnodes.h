@@ -543,6 +543,9 @@ typedef struct EState
 #ifdef __AUDIT__
     int32        es_remote_subplan_num;    /* number of RemoteSubplan in es_plannedstmt */
 #endif
+#ifdef __TBASE__
+    int            es_work_mem;    /* share of query_work_mem per workspace, in KB, or 0 */
+#endif
 } EState;
 
 
@@ -1185,11 +1188,15 @@ typedef struct datamask_att_scan {
 	char     *defaultval;    /* keep default val */
 	int64    datamask;
 	FmgrInfo flinfo;
+	bool     constvalid;    /* masked value does not depend on the input */
+	Datum    constval;      /* precomputed masked value when constvalid */
 } DataMaskAttScan;
 
 typedef struct datamask_state
 {
 	DataMaskAttScan *maskinfo;
+	int              nmasked;       /* number of columns really masked for current user */
+	int             *masked_attnos; /* their zero based attribute numbers */
 } DataMaskState ;
 
 /* ----------------------------------------------------------------
@@ -1218,6 +1225,11 @@ typedef struct ScanState
     HeapScanDesc ss_currentScanDesc;
     TupleTableSlot *ss_ScanTupleSlot;
     DataMaskState   *ss_currentMaskDesc;
+#ifdef _MLS_
+    bool        ss_crypt_attrs_ready;  /* ss_crypt_attrs has been computed */
+    bool        ss_crypt_attrs_all;    /* all columns may be referenced */
+    Bitmapset  *ss_crypt_attrs;        /* columns referenced by the scan, attnum - 1 */
+#endif
 #ifdef __COLD_HOT__
     bool        inited;
 #endif
@@ -1231,6 +1243,13 @@ typedef struct SeqScanState
 {
     ScanState    ss;                /* its first field is NodeTag */
     Size        pscan_len;        /* size of parallel heap scan descriptor */
+#ifdef _SHARDING_
+    ExtentID   *pscan_extents;    /* extents of the shards the quals select,
+                                   * NULL to scan the whole relation */
+    int         pscan_nextents;    /* number of pscan_extents */
+    struct ExtentZoneFilter *zonefilter;    /* column ranges the quals
+                                             * select, NULL if none */
+#endif
 } SeqScanState;
 
 /* ----------------
@@ -1343,6 +1362,8 @@ typedef struct IndexScanState
  *        VMBuffer           buffer in use for visibility map testing, if any
  *        HeapFetches           number of tuples we were forced to fetch from heap
  *        ioss_PscanLen       Size of parallel index-only scan descriptor
+ *        FilterShards       whether the snapshot may hide shards of the heap
+ *        ShardEid           extent ShardHidden and ShardKnown were found for
  * ----------------
  */
 typedef struct IndexOnlyScanState
@@ -1362,6 +1383,12 @@ typedef struct IndexOnlyScanState
     Buffer        ioss_VMBuffer;
     long        ioss_HeapFetches;
     Size        ioss_PscanLen;
+#ifdef _SHARDING_
+    bool        ioss_FilterShards;
+    ExtentID    ioss_ShardEid;
+    bool        ioss_ShardHidden;
+    bool        ioss_ShardKnown;
+#endif
 } IndexOnlyScanState;
 
 /* ----------------
@@ -1884,6 +1911,8 @@ typedef struct HashJoinState
     size_t      matched_tuples;
     Size                  hj_parallelStateLen;
     ParallelHashJoinState *hj_parallelState;
+    int         hj_FilterNKeys;     /* outer keys of runtime join filter, */
+    AttrNumber  hj_FilterKeys[SQUEUE_FILTER_MAX_KEYS]; /* 0 if none */
 #endif
 } HashJoinState;
 
@@ -2262,6 +2291,9 @@ typedef struct HashState
 
 	SharedHashInfo *shared_info;	/* one entry per worker */
 	HashInstrumentation *hinstrument;	/* this worker's entry */
+#ifdef __TBASE__
+    SQueueFilter *filter;       /* runtime join filter being built, or NULL */
+#endif
 } HashState;
 
 /* ----------------
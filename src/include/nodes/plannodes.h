@@ -298,6 +298,9 @@ typedef struct Append
     List       *appendplans;
 #ifdef __TBASE__
     bool       interval;
+    Oid        interval_parent;      /* interval partitioned table scanned */
+    List       *interval_prune_quals; /* quals on it waiting for external params,
+                                       * used to skip children at executor start */
 #endif
 } Append;
 
@@ -402,6 +405,14 @@ typedef struct SampleScan
     Scan        scan;
     /* use struct pointer to avoid including parsenodes.h here */
     struct TableSampleClause *tablesample;
+#ifdef __TBASE__
+    /*
+     * reltuples of the whole table when the scan runs on several datanodes,
+     * so that a method sampling a fixed number of rows takes its share only;
+     * 0 otherwise
+     */
+    double        cluster_tuples;
+#endif
 } SampleScan;
 
 /* ----------------
@@ -404,6 +404,10 @@ typedef struct PlannerInfo
     /* These fields are used only when hasRecursion is true: */
     int            wt_param_id;    /* PARAM_EXEC ID for the work table */
     struct Path *non_recursive_path;    /* a path for non-recursive term */
+#ifdef __TBASE__
+    Distribution *wt_distribution;    /* work table distribution, if the
+                                     * recursion runs on the datanodes */
+#endif
 
     /* These fields are workspace for createplan.c */
     Relids        curOuterRels;    /* outer rels above current node */
@@ -423,6 +427,8 @@ typedef struct PlannerInfo
     Distribution *distribution; /* Query result distribution */
     bool        recursiveOk;
 #ifdef __TBASE__
+    bool        recursiveDistributed;    /* recursive union runs on the
+                                         * datanodes of distributed tables */
     bool        haspart_tobe_modify;
     Index        partrelindex;
     Bitmapset    *partpruning;
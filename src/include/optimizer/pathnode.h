@@ -353,6 +353,9 @@ extern ParamPathInfo *get_appendrel_parampathinfo(RelOptInfo *appendrel,
 #ifdef __TBASE__
 extern Path *create_redistribute_grouping_path(PlannerInfo *root, 
                                                 Query *parse, Path *path);
+extern Path *create_redistribute_window_path(PlannerInfo *root,
+                                                Query *parse, Path *path,
+                                                WindowClause *wc);
 extern void contains_remotesubplan(Path *path, int *number, bool *redistribute);
 
 extern int replication_level;
@@ -38,5 +38,8 @@ extern bool pgxc_is_trigger_shippable(Trigger *trigger);
 extern Node *get_var_from_arg(Node *arg);
 
 extern bool is_var_distribute_column(Var *var, List *rtable);
+
+extern int fqs_cache_size;
+extern char *shard_local_relation;
 #endif
 #endif
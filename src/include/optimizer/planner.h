@@ -127,6 +127,7 @@ extern void preprocess_rowmarks(PlannerInfo *root);
 
 #ifdef __TBASE__
 extern bool olap_optimizer;
+extern bool enable_distinct_agg_dedup;
 extern Size estimate_hashagg_entrysize(Path *path, const AggClauseCosts *agg_costs,
 						   						double dNumGroups);
 #endif
@@ -30,6 +30,10 @@
 #define PGSTAT_STAT_PERMANENT_DIRECTORY		"pg_stat"
 #define PGSTAT_STAT_PERMANENT_FILENAME		"pg_stat/global.stat"
 #define PGSTAT_STAT_PERMANENT_TMPFILE		"pg_stat/global.tmp"
+#ifdef __TBASE__
+#define PGSTAT_SHARED_TABSTAT_FILENAME		"pg_stat/shared_tabstat.stat"
+#define PGSTAT_SHARED_TABSTAT_TMPFILE		"pg_stat/shared_tabstat.tmp"
+#endif
 
 /* Default directory to store temporary statistics data in */
 #define PG_STAT_TMP_DIR		"pg_stat_tmp"
@@ -267,9 +271,15 @@ typedef struct PgStat_TableEntry
  *								and buffer access statistics.
  * ----------
  */
+#ifdef __TBASE__
+#define PGSTAT_NUM_TABENTRIES  \
+	((PGSTAT_MSG_PAYLOAD - sizeof(Oid) - 3 * sizeof(int) - 2 * sizeof(PgStat_Counter)	\
+	  - sizeof(PgStat_TableCounts)) / sizeof(PgStat_TableEntry))
+#else
 #define PGSTAT_NUM_TABENTRIES  \
 	((PGSTAT_MSG_PAYLOAD - sizeof(Oid) - 3 * sizeof(int) - 2 * sizeof(PgStat_Counter))	\
 	 / sizeof(PgStat_TableEntry))
+#endif
 
 typedef struct PgStat_MsgTabstat
 {
@@ -280,6 +290,10 @@ typedef struct PgStat_MsgTabstat
 	int			m_xact_rollback;
 	PgStat_Counter m_block_read_time;	/* times in microseconds */
 	PgStat_Counter m_block_write_time;
+#ifdef __TBASE__
+	/* sum of the table counts already applied to shared memory */
+	PgStat_TableCounts m_shared_counts;
+#endif
 	PgStat_TableEntry m_entry[PGSTAT_NUM_TABENTRIES];
 } PgStat_MsgTabstat;
 
@@ -768,6 +782,8 @@ typedef enum
 	WAIT_EVENT_BGWRITER_HIBERNATE,
 	WAIT_EVENT_BGWRITER_MAIN,
 	WAIT_EVENT_CHECKPOINTER_MAIN,
+	WAIT_EVENT_CHECKPOINT_WRITER_MAIN,
+	WAIT_EVENT_GLOBAL_DEADLOCK_DETECTOR_MAIN,
 	WAIT_EVENT_LOGICAL_LAUNCHER_MAIN,
 	WAIT_EVENT_LOGICAL_APPLY_MAIN,
 	WAIT_EVENT_PGSTAT_MAIN,
@@ -818,6 +834,7 @@ typedef enum
 	WAIT_EVENT_BGWORKER_SHUTDOWN = PG_WAIT_IPC,
 	WAIT_EVENT_BGWORKER_STARTUP,
 	WAIT_EVENT_BTREE_PAGE,
+	WAIT_EVENT_CHECKPOINT_WRITERS,
 	WAIT_EVENT_EXECUTE_GATHER,
 	WAIT_EVENT_LOGICAL_SYNC_DATA,
 	WAIT_EVENT_LOGICAL_SYNC_STATE_CHANGE,
@@ -944,7 +961,8 @@ typedef enum
 typedef enum ProgressCommandType
 {
 	PROGRESS_COMMAND_INVALID,
-	PROGRESS_COMMAND_VACUUM
+	PROGRESS_COMMAND_VACUUM,
+	PROGRESS_COMMAND_CREATE_INDEX
 } ProgressCommandType;
 
 #define PGSTAT_NUM_PROGRESS_PARAM	10
@@ -1166,6 +1184,19 @@ extern void CreateSharedBackendStatus(void);
 extern void pgstat_init(void);
 extern int	pgstat_start(void);
 extern void pgstat_reset_all(void);
+
+#ifdef __TBASE__
+/*
+ * Cumulative per-table statistics kept in shared memory instead of the
+ * collector, for up to shared_table_stats_size tables.
+ */
+extern int	shared_table_stats_size;
+
+extern Size SharedTabStatShmemSize(void);
+extern void SharedTabStatShmemInit(void);
+extern void pgstat_save_shared_tabstats(void);
+extern void pgstat_restore_shared_tabstats(void);
+#endif
 extern void allow_immediate_pgstat_restart(void);
 
 #ifdef EXEC_BACKEND
@@ -1218,6 +1249,7 @@ extern void pgstat_progress_update_param(int index, int64 val);
 extern void pgstat_progress_update_multi_param(int nparam, const int *index,
 								   const int64 *val);
 extern void pgstat_progress_end_command(void);
+extern ProgressCommandType pgstat_progress_command(void);
 
 extern PgStat_TableStatus *find_tabstat_entry(Oid rel_id);
 extern PgStat_BackendFunctionEntry *find_funcstat_entry(Oid func_id);
@@ -1357,6 +1389,9 @@ extern void pgstat_send_bgwriter(void);
  */
 extern PgStat_StatDBEntry *pgstat_fetch_stat_dbentry(Oid dbid);
 extern PgStat_StatTabEntry *pgstat_fetch_stat_tabentry(Oid relid);
+#ifdef __TBASE__
+extern PgStat_StatTabEntry *pgstat_fetch_shared_tabentry(Oid dbid, Oid relid);
+#endif
 extern PgBackendStatus *pgstat_fetch_stat_beentry(int beid);
 extern LocalPgBackendStatus *pgstat_fetch_stat_local_beentry(int beid);
 extern PgStat_StatFuncEntry *pgstat_fetch_stat_funcentry(Oid funcid);
@@ -35,6 +35,7 @@
 #include "access/parallel.h"
 #endif
 #include "access/xact.h"
+#include "lib/ilist.h"
 
 /* Outputs of handle_response() */
 #define RESPONSE_EOF EOF
@@ -62,6 +63,7 @@
 #define BIT_SET(data, bit)   ((1 << (bit)) & (data)) 
 
 extern int DataRowBufferSize;
+extern int CopySendBufferSize;
 
 extern bool need_global_snapshot;
 extern List *executed_node_list;
@@ -133,6 +135,8 @@ typedef struct ResponseCombiner
     char       *errorHint;                /* error hint to send back to client */
     Oid            returning_node;            /* returning replicated node */
     RemoteDataRow currentRow;            /* next data ro to be wrapped into a tuple */
+    struct RemoteRowArena *rowArena;    /* bump allocator for received data rows */
+    RemoteDataRow slotRow;                /* arena data row held by the result slot */
     /* TODO use a tuplestore as a rowbuffer */
     List        *rowBuffer;                /* buffer where rows are stored when connection
                                          * should be cleaned for reuse by other RemoteQuery */
@@ -162,6 +166,7 @@ typedef struct ResponseCombiner
     char*            errorNode;            /* node Oid, who raise an error, set when handle_response */
     int              backend_pid;        /* backend_pid, who raise an error, set when handle_response */
     bool             is_abort;
+    bool             discard_rows;       /* draining connections, data rows are dropped */
 #endif
     bool        merge_sort;             /* perform mergesort of node tuples */
     bool        extended_query;         /* running extended query protocol */
@@ -263,6 +268,17 @@ typedef struct RemoteSubplanState
     bool        finish_init;
     int32       eflags;                       /* estate flag. */
     ParallelWorkerStatus *parallel_status; /* Shared storage for parallel worker. */
+    SQueueFilter *filter;                  /* runtime join filter to send once bound */
+    /* rows of earlier scans, replayed by rescans with the same parameters */
+    bool        rescan_cacheable;          /* results depend on parameters only */
+    struct HTAB *rescan_cache;             /* RemoteRescanEntry by parameter hash */
+    dlist_head  rescan_lru;                /* entries, most recently used first */
+    MemoryContext rescan_cxt;              /* holds the entries and their rows */
+    Size        rescan_bytes;              /* memory used by the entries */
+    struct RemoteRescanEntry *rescan_fill;   /* entry the current scan adds to */
+    struct RemoteRescanEntry *rescan_replay; /* entry the current scan reads */
+    int         rescan_pos;                /* next row of rescan_replay */
+    int64       scan_rows;                 /* rows returned by the current scan */
 #endif
 } RemoteSubplanState;
 
@@ -336,6 +352,12 @@ typedef enum
 
 
 extern int PGXLRemoteFetchSize;
+#ifdef __TBASE__
+extern bool enable_remote_rescan_cache;
+extern int remote_rescan_cache_entries;
+extern double log_remote_misestimate_ratio;
+extern bool async_distributed_commit;
+#endif
 
 
 #if __TBASE__
@@ -373,6 +395,9 @@ extern void ExecFinishInitRemoteSubplan(RemoteSubplanState *node);
 extern TupleTableSlot* ExecRemoteSubplan(PlanState *pstate);
 extern void ExecEndRemoteSubplan(RemoteSubplanState *node);
 extern void ExecReScanRemoteSubplan(RemoteSubplanState *node);
+#ifdef __TBASE__
+extern void ExecRemoteSubplanSetFilter(RemoteSubplanState *node, SQueueFilter *filter);
+#endif
 extern void ExecRemoteUtility(RemoteQuery *node);
 
 extern bool    is_data_node_ready(PGXCNodeHandle * conn);
@@ -409,6 +434,7 @@ extern bool    PreAbort_Remote(TranscationType txn_type, bool need_release_handl
 #ifdef __TBASE__
 extern void SubTranscation_PreCommit_Remote(void);
 extern void SubTranscation_PreAbort_Remote(void);
+extern void FinishAsyncCommit_Remote(void);
 #endif
 extern void AtEOXact_Remote(void);
 extern bool IsTwoPhaseCommitRequired(bool localWrite);
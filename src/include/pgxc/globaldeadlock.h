@@ -0,0 +1,28 @@
+/*-------------------------------------------------------------------------
+ *
+ * globaldeadlock.h
+ *
+ *      Definitions for the global deadlock detector
+ *
+ * IDENTIFICATION
+ *      $$
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef GLOBALDEADLOCK_H
+#define GLOBALDEADLOCK_H
+
+#include "fmgr.h"
+
+/* GUC options */
+extern int global_deadlock_detector_interval;
+
+extern void GlobalDeadlockDetectorRegister(void);
+extern void GlobalDeadlockDetectorMain(Datum main_arg) pg_attribute_noreturn();
+
+extern Datum pg_lock_wait_graph(PG_FUNCTION_ARGS);
+extern Datum pg_cancel_global_xid(PG_FUNCTION_ARGS);
+extern Datum pg_detect_global_deadlock(PG_FUNCTION_ARGS);
+
+#endif   /* GLOBALDEADLOCK_H */
@@ -106,6 +106,8 @@ typedef struct
 	Expr		*sec_en_expr;	/* Sec Expression to evaluate at execution time
 								 * if planner can not determine execution
 								 * nodes */
+	int			cold_pruned;	/* cold group nodes skipped by cold/hot
+								 * routing, only reported by EXPLAIN */
 #endif
 	Oid			en_relid;			/* Relation to determine execution nodes */
 	RelationAccessType accesstype;	/* Access type to determine execution nodes */
@@ -186,6 +188,10 @@ extern int GET_NODES(Locator *self, Datum value, bool isnull,
 					       Datum secValue, bool secIsNull,
 #endif
 	                       bool *hasprimary);
+#ifdef __TBASE__
+extern bool GET_NODES_BATCH(Locator *self, Datum *values, bool *nulls,
+                           int nvalues, int *nodes);
+#endif
 extern void *getLocatorResults(Locator *self);
 extern void *getLocatorNodeMap(Locator *self);
 extern int getLocatorNodeCount(Locator *self);
@@ -48,6 +48,9 @@ extern Size NodeHashTableShmemSize(void);
 extern Size NodeTablesShmemSize(void);
 
 extern void PgxcNodeListAndCountWrapTransaction(void);
+#ifdef __TBASE__
+extern uint32 PgxcNodeTableVersion(void);
+#endif
 extern void
 PgxcNodeGetOidsExtend(Oid **coOids, Oid **dnOids, Oid **sdnOids,
                 int *num_coords, int *num_dns, int *num_sdns, bool update_preferred);
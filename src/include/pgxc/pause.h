@@ -19,6 +19,7 @@
 typedef struct {
     int        cl_holder_pid; /* pid of the process issuing CLUSTER PAUSE */
     int        cl_process_count; /* Number of processes undergoing txns */
+    int        cl_waiter_pid; /* pid of a CLUSTER PAUSE waiting for txns to drain */
 
     slock_t    cl_mutex; /* locks shared variables mentioned above */
 } ClusterLockInfo;
@@ -27,6 +28,7 @@ extern ClusterLockInfo *ClustLinfo;
 
 extern bool cluster_lock_held;
 extern bool cluster_ex_lock_held;
+extern int  cluster_pause_drain_timeout;
 
 extern void ClusterLockShmemInit(void);
 extern Size ClusterLockShmemSize(void);
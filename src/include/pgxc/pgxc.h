@@ -107,6 +107,8 @@ extern char *PGXCMainClusterName;
 extern char *PGXCDefaultClusterName;
 #ifdef __TBASE__
 extern char PGXCSessionId[NAMEDATALEN];
+/* global query id, set by a plugin on the coordinator and sent to all nodes */
+extern uint32 PGXCQueryId;
 #endif
 
 
@@ -132,6 +134,13 @@ extern Datum xc_lockForBackupKey2;
 #define IsConnFromGtm() (remoteConnType == REMOTE_CONN_GTM)
 #define IsConnFromGtmProxy() (remoteConnType == REMOTE_CONN_GTM_PROXY)
 
+/*
+ * Extra byte of ReadyForQuery sent to coordinators: whether the node has
+ * written (assigned a transaction id) in the current transaction.
+ */
+#define PGXC_READY_WRITTEN      'W'
+#define PGXC_READY_READ_ONLY    'R'
+
 /* key pair to be used as object id while using advisory lock for backup */
 #define XC_LOCK_FOR_BACKUP_KEY_1      0xFFFF
 #define XC_LOCK_FOR_BACKUP_KEY_2      0xFFFF
@@ -129,6 +129,14 @@ struct pgxc_node_handle
 	long        recv_datarows;
 	bool 		plpgsql_need_begin_sub_txn;
 	bool 		plpgsql_need_begin_txn;
+	size_t		copy_data_off;	/* start of the last CopyData message we buffered */
+	size_t		copy_data_end;	/* outEnd right after we buffered it */
+	int			session_pid;	/* remote backend the init string was sent to */
+	uint32		session_version;	/* version of the init string sent there */
+	bool		session_global_reset;	/* global_session was reset since */
+	int			fetch_size;		/* rows asked by the last Execute of a portal */
+	int64		fetch_rows;		/* data rows received since the portal was bound */
+	int64		fetch_bytes;	/* and their size */
 #endif
 };
 typedef struct pgxc_node_handle PGXCNodeHandle;
@@ -143,6 +151,18 @@ typedef struct
 	PGXCNodeHandle	  **coord_handles;	/* an array of Coordinator handles */
 } PGXCNodeAllHandles;
 
+#ifdef __TBASE__
+/* resets the session state of a remote connection to its defaults */
+#define PGXC_SESSION_RESET_CMD	"RESET ALL;" \
+								"RESET SESSION AUTHORIZATION;" \
+								"RESET transaction_isolation;" \
+								"RESET global_session;"
+
+#define PGXC_GLOBAL_SESSION_RESET_CMD	"RESET global_session;"
+
+extern bool enable_session_params_reuse;
+#endif
+
 extern void InitMultinodeExecutor(bool is_force);
 extern Oid get_nodeoid_from_nodeid(int nodeid, char node_type);
 
@@ -208,7 +228,10 @@ extern int	pgxc_node_send_sync(PGXCNodeHandle * handle);
 extern int pgxc_node_send_apply(PGXCNodeHandle * handle, char * buf, int len, bool ignore_pk_conflict);
 #endif
 #ifdef __TBASE__
+struct SQueueFilter;
 extern int pgxc_node_send_disconnect(PGXCNodeHandle * handle, char *cursor, int cons);
+extern int pgxc_node_send_runtime_filter(PGXCNodeHandle * handle, const char *cursor,
+                              struct SQueueFilter *filter);
 #endif
 extern int	pgxc_node_send_bind(PGXCNodeHandle * handle, const char *portal,
 								const char *statement, int paramlen, const char *params,
@@ -113,8 +113,25 @@ typedef struct
     int32  lineno;       /* lineno where destroy the slot */
     char   *node_name; /* connection node name , pointer to datanode_pool node_name, no memory allocated*/
     int32  backend_pid;/* backend pid of remote connection */
+    int32  last_holder;/* agent pid that held the slot last, 0 if reset */
+    bool   breused;    /* handed back to the agent that held it last */
 } PGXCNodePoolSlot;
 
+/* number of past windows whose peak demand the pool is kept ready for */
+#define POOL_DEMAND_WINDOWS 64
+
+/* log2 buckets of the latency histograms, in microseconds, last one open */
+#define POOL_LATENCY_BUCKETS 40
+
+typedef enum
+{
+    POOL_LATENCY_ACQUIRE,   /* session waiting for a connection */
+    POOL_LATENCY_SET,       /* replaying session params on an acquired connection */
+    POOL_LATENCY_BUILD,     /* async build request until it lands in the pool */
+    POOL_LATENCY_LIFETIME,  /* connection created until it was closed */
+    POOL_LATENCY_COUNT
+} PoolLatencyType;
+
 /* Pool of connections to specified pgxc node */
 typedef struct
 {
@@ -130,6 +147,14 @@ typedef struct
     char        node_name[NAMEDATALEN]; /* name of the node.*/
 	time_t		m_version;	/* version of node pool */
     PGXCNodePoolSlot **slot;
+
+    /* peak number of connections in use, per window of pool_demand_window */
+    int32       demand_cur;     /* peak of the current window */
+    int32       demand_idx;     /* last window saved in demand_hist */
+    time_t      demand_start;   /* start of the current window */
+    int32       demand_hist[POOL_DEMAND_WINDOWS];
+
+    uint32      latency[POOL_LATENCY_COUNT][POOL_LATENCY_BUCKETS];
 } PGXCNodePool;
 
 /* All pools for specified database */
@@ -239,7 +264,7 @@ typedef struct PoolerCmdStatistics
 } PoolerCmdStatistics;
 
 
-#define POOLER_CMD_COUNT (18)
+#define POOLER_CMD_COUNT (19)
 
 
 
@@ -260,6 +285,7 @@ extern char *g_unpooled_database;
 extern char *g_unpooled_user;
 
 extern int    PoolSizeCheckGap; 
+extern int    PoolDemandWindow;
 extern int    PoolConnMaxLifetime; 
 extern int    PoolMaxMemoryLimit;
 extern int    PoolConnectTimeOut;
@@ -373,5 +399,6 @@ extern int PoolManagerClosePooledConnections(const char *dbname, const char *use
 extern int PoolManagerGetCmdStatistics(char *s, int size);
 extern void PoolManagerResetCmdStatistics(void);
 extern int PoolManagerGetConnStatistics(StringInfo s);
+extern int PoolManagerGetLatencyStatistics(StringInfo s);
 
 #endif
@@ -103,6 +103,9 @@
 #define STRINGLENGTH 1024   /* string buffer length */
 
 extern int32       GetNodeIndexByHashValue(Oid group, long shardIdx);
+extern void        GetNodeIndexesByHashValues(Oid group, long *hashvalues, int nvalues,
+                                int32 *nodeindexes);
+extern int32       GetNodeIndexByShardId(Oid group, int32 shardid);
 extern Bitmapset  *g_DatanodeShardgroupBitmap;
 extern List       *g_TempKeyValueList;
 extern bool         g_IsExtension;
@@ -166,7 +169,11 @@ extern Bitmapset* CopyShardGroups_DN(Bitmapset * dest);
 extern int32 EvaluateShardId(Oid type, bool isNull, Datum dvalue, 
                            Oid secType, bool isSecNull, Datum secValue, Oid relid);
 
+/* shards barriered together by one TruncateShards() step */
+#define TRUNCATE_SHARD_BATCH 64
+
 extern int TruncateShard(Oid reloid, ShardID sid, int pausetime);
+extern int TruncateShards(Oid reloid, ShardID *sids, int nsids, int pausetime);
 
 /* shard barrier */
 extern void ShardBarrierShmemInit(void);
@@ -194,12 +201,26 @@ extern Datum pg_clear_node_cold_access(PG_FUNCTION_ARGS);
 
 extern Datum pg_stat_node_access(PG_FUNCTION_ARGS);
 
+extern Datum pg_get_cold_partitions(PG_FUNCTION_ARGS);
+
 extern Size ShardStatisticShmemSize(void);
 
 extern void ShardStatisticShmemInit(void);
 
 extern void UpdateShardStatistic(CmdType cmd, ShardID sid, int64 new_size, int64 old_size);
 
+extern void FlushPendingShardStatistic(void);
+
+/* kinds of buffer access counted per shard */
+typedef enum
+{
+    SHARD_BUFFER_HIT,
+    SHARD_BUFFER_READ,
+    SHARD_BUFFER_WRITE
+} ShardBufferAccess;
+
+extern void CountShardBufferAccess(ShardID sid, ShardBufferAccess access);
+
 extern void FlushShardStatistic(void);
 
 extern void RecoverShardStatistic(void);
@@ -208,6 +229,10 @@ extern void ResetShardStatistic(void);
 
 extern Datum tbase_shard_statistic(PG_FUNCTION_ARGS);
 
+extern Datum tbase_shard_io_statistic(PG_FUNCTION_ARGS);
+
+extern Datum tbase_shard_rebalance_plan(PG_FUNCTION_ARGS);
+
 #ifdef __COLD_HOT__
 extern Size DualWriteTableSize(void);
 extern void DualWriteCtlInit(void);
@@ -18,11 +18,13 @@
 
 #include "postgres.h"
 #include "executor/tuptable.h"
+#include "fmgr.h"
 #include "nodes/pg_list.h"
 #include "utils/tuplestore.h"
 #ifdef __TBASE__
 #include "tcop/dest.h"
 #include "storage/dsm_impl.h"
+#include "lib/stringinfo.h"
 #endif
 
 #ifdef __TBASE__
@@ -32,9 +34,12 @@
 #endif
 extern PGDLLIMPORT int NSQueues;
 extern PGDLLIMPORT int SQueueSize;
+extern PGDLLIMPORT int SQueueMemory;
 
-/* Fixed size of shared queue, maybe need to be GUC configurable */
-#define SQUEUE_SIZE ((long) SQueueSize * TBASE_MAX_DATANODE_NUMBER * 1024L)
+/* Size of the ring of one consumer, shrunk when the ring pool runs short */
+#define SQUEUE_RING_SIZE ((Size) SQueueSize * 1024L)
+/* Memory shared by the rings of all queues */
+#define SQUEUE_POOL_SIZE ((Size) SQueueMemory * 1024L)
 /* Number of shared queues, maybe need to be GUC configurable */
 #ifndef __TBASE__
 #define NUM_SQUEUES Max((long) NSQueues, MaxConnections / 4)
@@ -121,6 +126,7 @@ typedef enum
 	ConvertRecvNodeindexError,
 	ConvertRecvSockfdError,
 	ConvertSetSockfdError,
+	ConvertRecvSqnameError,
 	ConvertExit
 }ConvertStatus;
 
@@ -148,6 +154,9 @@ extern bool  g_DataPumpDebug;
 extern int32 g_SndThreadNum;
 extern int32 g_SndThreadBufferSize;
 extern int32 g_SndBatchSize;
+extern bool  g_SQueueBatchRead;
+extern bool  g_DataPumpZeroCopy;
+extern bool  g_DataPumpCompress;
 extern int   consumer_connect_timeout;
 extern int   g_DisConsumer_timeout;
 
@@ -193,6 +202,47 @@ extern bool IsConsumerDisConnect(char *sqname, int nodeid);
 extern void RemoveDisConsumerHash(char *sqname);
 
 extern void RemoteSubplanSigusr2Handler(SIGNAL_ARGS);
+
+/*
+ * Runtime join filter. A hash join whose outer side is a RemoteSubplan builds
+ * a bloom filter over the hash values of its inner keys and ships it to the
+ * producers; they drop tuples for that consumer which can not find a join
+ * partner before putting them into the queue.
+ */
+#define SQUEUE_FILTER_MAX_KEYS     4
+#define SQUEUE_FILTER_MIN_BITS     8192
+#define SQUEUE_FILTER_MAX_BITS     (1 << 23)
+
+typedef struct SQueueFilter
+{
+    char        sq_key[SQUEUE_KEYSIZE];    /* queue the filter is installed for */
+    int32       consumerIdx;               /* consumer the filter belongs to */
+    int32       nkeys;                     /* number of join keys */
+    int32       nbits;                     /* bitmap size, a power of 2 */
+    AttrNumber  keys[SQUEUE_FILTER_MAX_KEYS];      /* key columns in produced tuples */
+    Oid         hashfuncs[SQUEUE_FILTER_MAX_KEYS]; /* hash functions of the keys */
+    uint64      bitmap[FLEXIBLE_ARRAY_MEMBER];
+} SQueueFilter;
+
+#define SQUEUE_FILTER_SIZE(nbits) \
+    (offsetof(SQueueFilter, bitmap) + (nbits) / BITS_IN_BYTE)
+
+/* producer side state of a filter, private to squeue.c */
+typedef struct SQueueFilterCache SQueueFilterCache;
+
+extern bool enable_runtime_join_filter;
+
+extern SQueueFilter *SQueueFilterCreate(double ntuples);
+extern void SQueueFilterAdd(SQueueFilter *filter, uint32 hashvalue);
+extern SQueueFilterCache *SQueueFilterCacheCreate(SQueueFilter *filter);
+extern bool SQueueFilterMatch(SQueueFilterCache *cache, TupleTableSlot *slot);
+extern bool SharedQueueFilterTuple(SharedQueue squeue, int consumerIdx,
+                       TupleTableSlot *slot, SQueueFilterCache **caches);
+extern void SharedQueueRecvFilter(StringInfo msg);
+
+/* throughput counters of the shared queues and DataPump senders */
+extern Datum pg_stat_get_squeues(PG_FUNCTION_ARGS);
+extern Datum pg_stat_get_squeue_nodes(PG_FUNCTION_ARGS);
 #ifdef __TBASE__
 enum MT_thr_detach 
 { 
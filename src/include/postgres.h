@@ -169,11 +169,20 @@ typedef union
     struct                        /* Compressed-in-line format */
     {
         uint32        va_header;
-        uint32        va_rawsize; /* Original data size (excludes header) */
+        uint32        va_rawsize; /* Original data size (excludes header)
+                                 * and compression method */
         char        va_data[FLEXIBLE_ARRAY_MEMBER]; /* Compressed data */
     }            va_compressed;
 } varattrib_4b;
 
+/*
+ * A varlena is less than 1GB, so the top two bits of va_rawsize of a
+ * compressed datum are free to tell which method compressed it. Zero is
+ * pglz, so data compressed before there was a choice stays readable.
+ */
+#define VARLENA_RAWSIZE_BITS    30
+#define VARLENA_RAWSIZE_MASK    ((1U << VARLENA_RAWSIZE_BITS) - 1)
+
 typedef struct
 {
     uint8        va_header;
@@ -305,7 +314,9 @@ typedef struct
 #define VARDATA_1B_E(PTR)    (((varattrib_1b_e *) (PTR))->va_data)
 
 #define VARRAWSIZE_4B_C(PTR) \
-    (((varattrib_4b *) (PTR))->va_compressed.va_rawsize)
+    (((varattrib_4b *) (PTR))->va_compressed.va_rawsize & VARLENA_RAWSIZE_MASK)
+#define VARCOMPMETHOD_4B_C(PTR) \
+    (((varattrib_4b *) (PTR))->va_compressed.va_rawsize >> VARLENA_RAWSIZE_BITS)
 
 /* Externally visible macros */
 
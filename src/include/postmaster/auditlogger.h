@@ -96,6 +96,15 @@ extern int					Maintain_trace_log_cache_size_kb;
 extern bool                 am_auditlogger;
 extern bool                 enable_auditlogger_warning;
 
+/* what a backend does when its audit log queue is full */
+typedef enum
+{
+	ALOG_QUEUE_FULL_WAIT,		/* wait for the audit logger to make room */
+	ALOG_QUEUE_FULL_DROP		/* drop the record and count it */
+} AlogQueueFullAction;
+
+extern int					AuditLog_queue_full_action;
+
 extern int                    AuditLogger_Start(void);
 
 #ifdef EXEC_BACKEND
@@ -23,7 +23,8 @@
  */
 typedef enum
 {
-    AVW_BRINSummarizeRange
+    AVW_BRINSummarizeRange,
+    AVW_GINCleanPendingList
 } AutoVacuumWorkItemType;
 
 
@@ -77,7 +78,7 @@ extern void AutovacuumWorkerIAm(void);
 extern void AutovacuumLauncherIAm(void);
 #endif
 
-extern void AutoVacuumRequestWork(AutoVacuumWorkItemType type,
+extern bool AutoVacuumRequestWork(AutoVacuumWorkItemType type,
                       Oid relationId, BlockNumber blkno);
 
 /* shared memory stuff */
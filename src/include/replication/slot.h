@@ -156,8 +156,11 @@ typedef struct ReplicationSlot
     bool        *alltables;
     List        **tables;
     Bitmapset   **pubshards;
+    Bitmapset   *pubshards_union;   /* shards of all publications, NULL if
+                                     * any of them takes all the shards */
 
     /* statistic data */
+    uint64     nshard_skipped;      /* heap changes skipped by shard id */
     uint64     ntups_insert;
     uint64     ntups_delete;
     uint64     checksum_insert;
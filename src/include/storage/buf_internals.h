@@ -395,6 +395,9 @@ extern Size BufTableShmemSize(int size);
 extern void InitBufTable(int size);
 extern uint32 BufTableHashCode(BufferTag *tagPtr);
 extern int    BufTableLookup(BufferTag *tagPtr, uint32 hashcode);
+#ifdef __TBASE__
+extern int    BufTableLookupHint(uint32 hashcode);
+#endif
 extern int    BufTableInsert(BufferTag *tagPtr, uint32 hashcode, int buf_id);
 extern void BufTableDelete(BufferTag *tagPtr, uint32 hashcode);
 
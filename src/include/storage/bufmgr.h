@@ -175,6 +175,10 @@ extern PGDLLIMPORT int32 *LocalRefCount;
 extern bool ComputeIoConcurrency(int io_concurrency, double *target);
 extern void PrefetchBuffer(Relation reln, ForkNumber forkNum,
                BlockNumber blockNum);
+#ifdef __TBASE__
+extern bool PrefetchRedoBuffer(RelFileNode rnode, ForkNumber forkNum,
+               BlockNumber blockNum);
+#endif
 extern Buffer ReadBuffer(Relation reln, BlockNumber blockNum);
 extern Buffer ReadBufferExtended(Relation reln, ForkNumber forkNum,
                    BlockNumber blockNum, ReadBufferMode mode,
@@ -240,6 +244,9 @@ extern void AbortBufferIO(void);
 
 extern void BufmgrCommit(void);
 extern bool BgBufferSync(struct WritebackContext *wb_context);
+#ifdef __TBASE__
+extern int    BufferSyncRange(int from, int to, struct WritebackContext *wb_context);
+#endif
 
 extern void AtProcExit_LocalBuffers(void);
 
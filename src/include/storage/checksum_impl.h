@@ -131,11 +131,19 @@ do { \
     (checksum) = __tmp * FNV_PRIME ^ (__tmp >> 17); \
 } while (0)
 
+/*
+ * Includers may define PG_CHECKSUM_BLOCK_ATTRIBUTES to compile the block
+ * checksum for more than one instruction set, see checksum.c.
+ */
+#ifndef PG_CHECKSUM_BLOCK_ATTRIBUTES
+#define PG_CHECKSUM_BLOCK_ATTRIBUTES
+#endif
+
 /*
  * Block checksum algorithm.  The data argument must be aligned on a 4-byte
  * boundary.
  */
-static uint32
+static PG_CHECKSUM_BLOCK_ATTRIBUTES uint32
 pg_checksum_block(char *data, uint32 size)
 {
     uint32        sums[N_SUMS];
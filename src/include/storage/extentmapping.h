@@ -471,6 +471,7 @@ extern void     ema_get_eme_extract(Relation rel,
                                             ShardID     *sid, 
                                             int *hwm, 
                                             uint8 *freespace);
+extern bool     ema_get_extent_shard(Relation rel, ExtentID eid, ShardID *sid);
 extern void     ema_set_eme_hwm(Relation rel, ExtentID eid, int16 hwm);
 extern void     ema_set_eme_link(Relation rel, 
                                         ExtentID eid, 
@@ -549,6 +550,8 @@ extern void        FreeExtent(Relation rel, ExtentID eid);
 extern void     MarkExtentFull(Relation rel, ExtentID eid);
 extern void     MarkExtentAvailable(Relation rel, ExtentID eid);
 extern ExtentID    GetShardScanHead(Relation re, ShardID sid);
+extern int      GetShardScanExtents(Relation rel, ShardID sid, ExtentID *extents, int maxextents);
+extern ExtentID *GetShardsScanExtents(Relation rel, Bitmapset *shards, int *nextents);
 extern ExtentID RelOidGetShardScanHead(Oid reloid, ShardID sid);
 extern void     TruncateExtentMap(Relation rel, BlockNumber nblocks);
 extern void       RebuildExtentMap(Relation rel);
@@ -76,6 +76,7 @@ extern off_t FileSeek(File file, off_t offset, int whence);
 extern int    FileTruncate(File file, off_t offset, uint32 wait_event_info);
 #ifdef _SHARDING_
 extern int    FileDealloc(File file, off_t offset, uint32 len,  uint32 wait_event_info);
+extern int    FileAllocate(File file, off_t offset, off_t len, uint32 wait_event_info);
 #endif
 extern void FileWriteback(File file, off_t offset, off_t nbytes, uint32 wait_event_info);
 extern char *FilePathName(File file);
@@ -272,6 +272,7 @@ typedef enum BuiltinTrancheIds
     LWTRANCHE_BUFFER_IO_IN_PROGRESS,
 #ifdef _MLS_
     LWTRANCHE_REL_CRYPT_LOCK,
+    LWTRANCHE_DECRYPT_CACHE,
 #endif
     LWTRANCHE_REPLICATION_ORIGIN,
     LWTRANCHE_REPLICATION_SLOT_IO_IN_PROGRESS,
@@ -286,6 +287,7 @@ typedef enum BuiltinTrancheIds
     LWTRANCHE_PARALLEL_QUERY_DSA,
 #ifdef __TBASE__
     LWTRANCHE_PARALLEL_WORKER_DSA,
+    LWTRANCHE_SHARED_TABSTAT,
 #endif
     LWTRANCHE_TBM,
     LWTRANCHE_FIRST_USER_DEFINED
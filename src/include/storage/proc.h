@@ -126,12 +126,26 @@ struct XidCache
     (PROC_IN_VACUUM | PROC_IN_ANALYZE | PROC_VACUUM_FOR_WRAPAROUND)
 
 /*
- * We allow a small number of "weak" relation locks (AccesShareLock,
- * RowShareLock, RowExclusiveLock) to be recorded in the PGPROC structure
- * rather than the main lock table.  This eases contention on the lock
- * manager LWLocks.  See storage/lmgr/README for additional details.
+ * We allow a limited number of "weak" relation locks (AccesShareLock,
+ * RowShareLock, RowExclusiveLock) to be recorded in per-backend arrays
+ * referenced from the PGPROC structure rather than the main lock table.
+ * This eases contention on the lock manager LWLocks.  See storage/lmgr/README
+ * for additional details.
+ *
+ * The slots come in groups of FP_LOCK_SLOTS_PER_GROUP sharing one uint64 of
+ * lock bits, and a relation can only use the slots of the group its OID
+ * hashes to.  The number of groups follows max_locks_per_transaction, so
+ * that queries over many partitions can still take their locks here.
  */
-#define        FP_LOCK_SLOTS_PER_BACKEND 16
+extern PGDLLIMPORT int FastPathLockGroupsPerBackend;
+
+#define        FP_LOCK_GROUPS_PER_BACKEND_MAX    1024
+#define        FP_LOCK_SLOTS_PER_GROUP        16    /* don't change */
+#define        FastPathLockSlotsPerBackend() \
+    (FP_LOCK_SLOTS_PER_GROUP * FastPathLockGroupsPerBackend)
+#define        FastPathLockShmemSize() \
+    (MAXALIGN(FastPathLockGroupsPerBackend * sizeof(uint64)) + \
+     MAXALIGN(FastPathLockSlotsPerBackend() * sizeof(Oid)))
 
 /*
  * An invalid pgprocno.  Must be larger than the maximum number of PGPROC
@@ -261,8 +275,9 @@ struct PGPROC
     LWLock        backendLock;
 
     /* Lock manager data, recording fast-path locks taken by this backend. */
-    uint64        fpLockBits;        /* lock modes held for each fast-path slot */
-    Oid            fpRelId[FP_LOCK_SLOTS_PER_BACKEND]; /* slots for rel oids */
+    uint64       *fpLockBits;        /* lock modes held for each fast-path slot,
+                                 * one word per group */
+    Oid           *fpRelId;        /* slots for rel oids */
     bool        fpVXIDLock;        /* are we holding a fast-path VXID lock? */
     LocalTransactionId fpLocalTransactionId;    /* lxid for fast-path VXID
                                                  * lock */
@@ -84,6 +84,11 @@ typedef enum
 } SnapshotSource;
 
 extern void SetGlobalTimestamp(GlobalTimestamp gts, SnapshotSource source);
+#ifdef __TBASE__
+extern char *snapshot_global_timestamp_string;
+extern GlobalTimestamp ImportedGlobalTimestamp;
+extern int standby_read_wait_timeout;
+#endif
 #if 0
 extern void SetGlobalSnapshotData(TransactionId xmin, TransactionId xmax, int xcnt,
         TransactionId *xip,
@@ -121,9 +126,12 @@ extern RunningTransactions GetRunningTransactionData(void);
 extern bool TransactionIdIsInProgress(TransactionId xid);
 #ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
 extern bool TransactionIdIsPrepared(TransactionId xid, Snapshot snapshot, GlobalTimestamp *prepare_ts);
+extern void ProcArrayAdvanceGeneration(void);
 #endif
 #ifdef __TBASE__
 extern TransactionId GetLocalTransactionId(const char *globalXid);
+extern bool GetGlobalXidOfPid(int pid, char *globalXid);
+extern int    SignalGlobalXidBackends(const char *globalXid, ProcSignalReason reason);
 #endif
 extern char *GetGlobalTransactionId(const TransactionId pid);
 extern bool TransactionIdIsActive(TransactionId xid);
@@ -108,6 +108,7 @@ typedef enum
     PROCSIG_PARALLEL_MESSAGE,    /* message from cooperating parallel backend */
 #ifdef __TBASE__
     PROCSIG_PARALLEL_EXIT,        /* message from exited parallel backend */
+    PROCSIG_GLOBAL_DEADLOCK,    /* chosen as victim of a global deadlock */
 #endif
     PROCSIG_WALSND_INIT_STOPPING,    /* ask walsenders to prepare for shutdown  */
 
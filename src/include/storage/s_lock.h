@@ -336,6 +336,30 @@ tas(volatile slock_t *lock)
 
 #define S_UNLOCK(lock) __sync_lock_release(lock)
 
+#if defined(__aarch64__) || defined(__aarch64)
+
+/*
+ * On many-core ARM64 servers a failed TAS still takes the cache line
+ * exclusive, so waiters spinning on it keep stealing the line from the
+ * holder.  Spin on a plain load until the lock looks free instead, as on
+ * x86.
+ */
+#define TAS_SPIN(lock)    (*(lock) ? 1 : TAS(lock))
+
+/*
+ * ISB makes the core wait for the pipeline to drain, which takes about as
+ * long as x86's PAUSE; YIELD is a no-op on most implementations.
+ */
+#define SPIN_DELAY() spin_delay()
+
+static __inline__ void
+spin_delay(void)
+{
+    __asm__ __volatile__(
+        " isb;                \n");
+}
+
+#endif     /* __aarch64__ || __aarch64 */
 #endif     /* HAVE_GCC__SYNC_INT32_TAS */
 #endif     /* __arm__ || __arm || __aarch64__ || __aarch64 */
 
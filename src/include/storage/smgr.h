@@ -33,6 +33,9 @@ typedef struct ShardTargBlock
             (tb)->shardid = InvalidShardID; \
             (tb)->hits = 0; \
             (tb)->targblk = InvalidBlockNumber;
+
+/* number of remembered extents with free space, indexed by shardid */
+#define SMGR_FREEEXT_HINTS 64
 #endif
 
 /*
@@ -76,6 +79,9 @@ typedef struct SMgrRelationData
     BlockNumber smgr_shard_targblocks[SMGR_TARGBLOCK_MAX_SHARDS];    
     BlockNumber smgr_ema_nblocks;
     bool        smgr_hasextent;
+    /* extent of the shard which had free space the last time we looked */
+    ShardID        smgr_freeext_sid[SMGR_FREEEXT_HINTS];
+    ExtentID    smgr_freeext_eid[SMGR_FREEEXT_HINTS];
 #endif
     BlockNumber smgr_vm_nblocks;    /* last known size of vm fork */
 
@@ -143,6 +149,11 @@ extern void smgrrealloc(SMgrRelation reln, ForkNumber forknum, BlockNumber from_
 extern void AtEOXact_SMgr(void);
 extern BlockNumber smgr_get_target_block(SMgrRelation rel, ShardID shardid);
 extern void smgr_set_target_block(SMgrRelation rel, ShardID shardid, BlockNumber blkno);
+#ifdef _SHARDING_
+extern void smgr_reset_freeext_hints(SMgrRelation rel);
+extern ExtentID smgr_get_freeext_hint(SMgrRelation rel, ShardID shardid);
+extern void smgr_set_freeext_hint(SMgrRelation rel, ShardID shardid, ExtentID eid);
+#endif
 
 /* internals: move me elsewhere -- ay 7/94 */
 
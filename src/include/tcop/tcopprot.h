@@ -138,6 +138,10 @@ extern void StatementCancelHandler(SIGNAL_ARGS);
 extern void FloatExceptionHandler(SIGNAL_ARGS) pg_attribute_noreturn();
 extern void RecoveryConflictInterrupt(ProcSignalReason reason); /* called from SIGUSR1
                                                                  * handler */
+#ifdef __TBASE__
+extern void HandleGlobalDeadlockInterrupt(void);    /* called from SIGUSR1
+                                                     * handler */
+#endif
 extern void ProcessClientReadInterrupt(bool blocked);
 extern void ProcessClientWriteInterrupt(bool blocked);
 
@@ -147,6 +147,9 @@ extern MemoryContext MemoryContextGetParent(MemoryContext context);
 extern bool MemoryContextIsEmpty(MemoryContext context);
 extern void MemoryContextStats(MemoryContext context);
 extern void MemoryContextStatsDetail(MemoryContext context, int max_children);
+#ifdef __TBASE__
+extern Size MemoryContextTotalSpace(MemoryContext context);
+#endif
 extern void MemoryContextAllowInCriticalSection(MemoryContext context,
                                     bool allow);
 
@@ -259,5 +259,8 @@ extern void ReleaseCachedPlan(CachedPlan *plan, bool useResOwner);
 extern void SetRemoteSubplan(CachedPlanSource *plansource,
                  const char *plan_string);
 #endif
+#ifdef __TBASE__
+extern int    remote_subplan_cache_size;
+#endif
 
 #endif                            /* PLANCACHE_H */
@@ -165,6 +165,9 @@ typedef struct SnapshotData
 
     TransactionId prepare_xmin;
 
+    uint64        generation;        /* proc array generation the xid arrays
+                                     * were built at, 0 if not reusable */
+
     int64        number_visible_tuples;
     int64        scanned_tuples_before_prepare;
     int64        scanned_tuples_after_prepare;
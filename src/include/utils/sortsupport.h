@@ -268,6 +268,14 @@ ApplySortAbbrevFullComparator(Datum datum1, bool isNull1,
     return compare;
 }
 
+#ifdef __TBASE__
+/* Integer comparators recognized by tuplesort, in utils/sort/tuplesort.c */
+extern int    ssup_datum_int32_cmp(Datum x, Datum y, SortSupport ssup);
+#ifdef USE_FLOAT8_BYVAL
+extern int    ssup_datum_signed_cmp(Datum x, Datum y, SortSupport ssup);
+#endif
+#endif
+
 /* Other functions in utils/sort/sortsupport.c */
 extern void PrepareSortSupportComparisonShim(Oid cmpFunc, SortSupport ssup);
 extern void PrepareSortSupportFromOrderingOp(Oid orderingOp, SortSupport ssup);
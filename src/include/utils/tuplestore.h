@@ -130,6 +130,9 @@ extern void tuplestore_copy_read_pointer(Tuplestorestate *state,
 extern void tuplestore_trim(Tuplestorestate *state);
 
 extern bool tuplestore_in_memory(Tuplestorestate *state);
+#ifdef __TBASE__
+extern int64 tuplestore_space_peak(Tuplestorestate *state);
+#endif
 
 extern bool tuplestore_gettupleslot(Tuplestorestate *state, bool forward,
                         bool copy, TupleTableSlot *slot);
@@ -150,6 +153,8 @@ extern void tuplestore_clear(Tuplestorestate *state);
 extern void tuplestore_end(Tuplestorestate *state);
 
 #ifdef XCP
+extern bool datarow_spill_compress;
+
 extern Tuplestorestate *tuplestore_begin_datarow(bool interXact, int maxKBytes,
                          MemoryContext tmpcxt);
 extern Tuplestorestate *tuplestore_begin_message(bool interXact, int maxKBytes);
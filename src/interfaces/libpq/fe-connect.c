@@ -3667,6 +3667,8 @@ closePGconn(PGconn *conn)
     pqDropConnection(conn, true);
     conn->status = CONNECTION_BAD;    /* Well, not really _bad_ - just absent */
     conn->asyncStatus = PGASYNC_IDLE;
+    conn->pipelineStatus = PQ_PIPELINE_OFF;
+    pqFreeCmdQueue(conn);        /* discard pipelined commands */
     pqClearAsyncResult(conn);    /* deallocate result */
     resetPQExpBuffer(&conn->errorMessage);
     release_all_addrinfo(conn);
@@ -39,7 +39,9 @@ char       *const pgresStatus[] = {
     "PGRES_NONFATAL_ERROR",
     "PGRES_FATAL_ERROR",
     "PGRES_COPY_BOTH",
-    "PGRES_SINGLE_TUPLE"
+    "PGRES_SINGLE_TUPLE",
+    "PGRES_PIPELINE_SYNC",
+    "PGRES_PIPELINE_ABORTED"
 };
 
 /*
@@ -64,6 +66,15 @@ static int PQsendQueryGuts(PGconn *conn,
                 int resultFormat);
 static void parseInput(PGconn *conn);
 static PGresult *getCopyResult(PGconn *conn, ExecStatusType copytype);
+static PGresult *getReadyResult(PGconn *conn);
+static PGcmdQueueEntry *pqAllocCmdQueueEntry(PGconn *conn);
+static void pqAppendCmdQueueEntry(PGconn *conn, PGcmdQueueEntry *entry);
+static void pqFreeCmdQueueEntry(PGcmdQueueEntry *entry);
+static void pqRecordCommand(PGconn *conn, PGcmdQueueEntry *entry,
+                PGQueryClass queryclass, const char *query);
+static void pqCommandQueueAdvance(PGconn *conn, bool gotSync);
+static void pqPipelineProcessQueue(PGconn *conn);
+static int    pqPipelineFlush(PGconn *conn);
 static bool PQexecStart(PGconn *conn);
 static PGresult *PQexecFinish(PGconn *conn);
 static int PQsendDescribe(PGconn *conn, char desc_type,
@@ -1136,6 +1147,15 @@ PQsendQuery(PGconn *conn, const char *query)
     if (!PQsendQueryStart(conn))
         return 0;
 
+    /* the simple protocol sends its own Sync, it can't be pipelined */
+    if (conn->pipelineStatus != PQ_PIPELINE_OFF)
+    {
+        printfPQExpBuffer(&conn->errorMessage,
+                          libpq_gettext("%s not allowed in pipeline mode\n"),
+                          "PQsendQuery");
+        return 0;
+    }
+
     /* check the argument */
     if (!query)
     {
@@ -1231,6 +1251,8 @@ PQsendPrepare(PGconn *conn,
               const char *stmtName, const char *query,
               int nParams, const Oid *paramTypes)
 {// #lizard forgives
+    PGcmdQueueEntry *entry = NULL;
+
     if (!PQsendQueryStart(conn))
         return 0;
 
@@ -1262,6 +1284,13 @@ PQsendPrepare(PGconn *conn,
         return 0;
     }
 
+    if (conn->pipelineStatus != PQ_PIPELINE_OFF)
+    {
+        entry = pqAllocCmdQueueEntry(conn);
+        if (entry == NULL)
+            return 0;
+    }
+
     /* construct the Parse message */
     if (pqPutMsgStart('P', false, conn) < 0 ||
         pqPuts(stmtName, conn) < 0 ||
@@ -1288,32 +1317,31 @@ PQsendPrepare(PGconn *conn,
     if (pqPutMsgEnd(conn) < 0)
         goto sendFailed;
 
-    /* construct the Sync message */
-    if (pqPutMsgStart('S', false, conn) < 0 ||
-        pqPutMsgEnd(conn) < 0)
+    /* construct the Sync message, unless the pipeline sends it */
+    if (entry == NULL &&
+        (pqPutMsgStart('S', false, conn) < 0 ||
+         pqPutMsgEnd(conn) < 0))
         goto sendFailed;
 
-    /* remember we are doing just a Parse */
-    conn->queryclass = PGQUERY_PREPARE;
-
-    /* and remember the query text too, if possible */
-    /* if insufficient memory, last_query just winds up NULL */
-    if (conn->last_query)
-        free(conn->last_query);
-    conn->last_query = strdup(query);
+    /* remember we are doing just a Parse, and the query text too */
+    pqRecordCommand(conn, entry, PGQUERY_PREPARE, query);
 
     /*
      * Give the data a push.  In nonblock mode, don't complain if we're unable
      * to send it all; PQgetResult() will do any additional flushing needed.
      */
-    if (pqFlush(conn) < 0)
+    if (pqPipelineFlush(conn) < 0)
         goto sendFailed;
 
     /* OK, it's launched! */
-    conn->asyncStatus = PGASYNC_BUSY;
+    if (entry)
+        pqAppendCmdQueueEntry(conn, entry);
+    else
+        conn->asyncStatus = PGASYNC_BUSY;
     return 1;
 
 sendFailed:
+    pqFreeCmdQueueEntry(entry);
     pqHandleSendFailure(conn);
     return 0;
 }
@@ -1379,6 +1407,24 @@ PQsendQueryStart(PGconn *conn)
                           libpq_gettext("no connection to the server\n"));
         return false;
     }
+
+    /*
+     * In pipeline mode the command is queued behind the ones in progress,
+     * whose results are left alone.  Only COPY can't have anything queued.
+     */
+    if (conn->pipelineStatus != PQ_PIPELINE_OFF)
+    {
+        if (conn->asyncStatus == PGASYNC_COPY_IN ||
+            conn->asyncStatus == PGASYNC_COPY_OUT ||
+            conn->asyncStatus == PGASYNC_COPY_BOTH)
+        {
+            printfPQExpBuffer(&conn->errorMessage,
+                              libpq_gettext("cannot queue commands during COPY\n"));
+            return false;
+        }
+        return true;
+    }
+
     /* Can't send while already busy, either. */
     if (conn->asyncStatus != PGASYNC_IDLE)
     {
@@ -1416,6 +1462,7 @@ PQsendQueryGuts(PGconn *conn,
                 int resultFormat)
 {// #lizard forgives
     int            i;
+    PGcmdQueueEntry *entry = NULL;
 
     /* This isn't gonna work on a 2.0 server */
     if (PG_PROTOCOL_MAJOR(conn->pversion) < 3)
@@ -1425,9 +1472,17 @@ PQsendQueryGuts(PGconn *conn,
         return 0;
     }
 
+    if (conn->pipelineStatus != PQ_PIPELINE_OFF)
+    {
+        entry = pqAllocCmdQueueEntry(conn);
+        if (entry == NULL)
+            return 0;
+    }
+
     /*
      * We will send Parse (if needed), Bind, Describe Portal, Execute, Sync,
-     * using specified statement name and the unnamed portal.
+     * using specified statement name and the unnamed portal.  In pipeline
+     * mode the Sync is left to PQpipelineSync.
      */
 
     if (command)
@@ -1537,35 +1592,31 @@ PQsendQueryGuts(PGconn *conn,
         pqPutMsgEnd(conn) < 0)
         goto sendFailed;
 
-    /* construct the Sync message */
-    if (pqPutMsgStart('S', false, conn) < 0 ||
-        pqPutMsgEnd(conn) < 0)
+    /* construct the Sync message, unless the pipeline sends it */
+    if (entry == NULL &&
+        (pqPutMsgStart('S', false, conn) < 0 ||
+         pqPutMsgEnd(conn) < 0))
         goto sendFailed;
 
-    /* remember we are using extended query protocol */
-    conn->queryclass = PGQUERY_EXTENDED;
-
-    /* and remember the query text too, if possible */
-    /* if insufficient memory, last_query just winds up NULL */
-    if (conn->last_query)
-        free(conn->last_query);
-    if (command)
-        conn->last_query = strdup(command);
-    else
-        conn->last_query = NULL;
+    /* remember we are using extended query protocol, and the query text */
+    pqRecordCommand(conn, entry, PGQUERY_EXTENDED, command);
 
     /*
      * Give the data a push.  In nonblock mode, don't complain if we're unable
      * to send it all; PQgetResult() will do any additional flushing needed.
      */
-    if (pqFlush(conn) < 0)
+    if (pqPipelineFlush(conn) < 0)
         goto sendFailed;
 
     /* OK, it's launched! */
-    conn->asyncStatus = PGASYNC_BUSY;
+    if (entry)
+        pqAppendCmdQueueEntry(conn, entry);
+    else
+        conn->asyncStatus = PGASYNC_BUSY;
     return 1;
 
 sendFailed:
+    pqFreeCmdQueueEntry(entry);
     pqHandleSendFailure(conn);
     return 0;
 }
@@ -1754,9 +1805,12 @@ PQgetResult(PGconn *conn)
             res = NULL;            /* query is complete */
             break;
         case PGASYNC_READY:
-            res = pqPrepareAsyncResult(conn);
-            /* Set the state back to BUSY, allowing parsing to proceed. */
-            conn->asyncStatus = PGASYNC_BUSY;
+            res = getReadyResult(conn);
+            break;
+        case PGASYNC_PIPELINE_IDLE:
+            /* the current command is done, move on to the next one */
+            pqPipelineProcessQueue(conn);
+            res = NULL;
             break;
         case PGASYNC_COPY_IN:
             res = getCopyResult(conn, PGRES_COPY_IN);
@@ -1832,6 +1886,36 @@ getCopyResult(PGconn *conn, ExecStatusType copytype)
     return PQmakeEmptyPGresult(conn, copytype);
 }
 
+/*
+ * getReadyResult
+ *      Helper for PQgetResult: return the result that is ready
+ *
+ * Out of pipeline mode parsing simply proceeds.  In pipeline mode a result
+ * other than a single row completes the current command; the caller gets a
+ * NULL next, unless this was a sync point, which has no terminating NULL.
+ */
+static PGresult *
+getReadyResult(PGconn *conn)
+{
+    PGresult   *res = pqPrepareAsyncResult(conn);
+
+    if (conn->pipelineStatus == PQ_PIPELINE_OFF ||
+        (res && res->resultStatus == PGRES_SINGLE_TUPLE))
+    {
+        /* Set the state back to BUSY, allowing parsing to proceed. */
+        conn->asyncStatus = PGASYNC_BUSY;
+        return res;
+    }
+
+    pqCommandQueueAdvance(conn,
+                          res && res->resultStatus == PGRES_PIPELINE_SYNC);
+    conn->asyncStatus = PGASYNC_PIPELINE_IDLE;
+    if (res && res->resultStatus == PGRES_PIPELINE_SYNC)
+        pqPipelineProcessQueue(conn);
+
+    return res;
+}
+
 
 /*
  * PQexec
@@ -1934,6 +2018,13 @@ PQexecStart(PGconn *conn)
     if (!conn)
         return false;
 
+    if (conn->pipelineStatus != PQ_PIPELINE_OFF)
+    {
+        printfPQExpBuffer(&conn->errorMessage,
+                          libpq_gettext("synchronous command execution functions are not allowed in pipeline mode\n"));
+        return false;
+    }
+
     /*
      * Silently discard any prior query result that application didn't eat.
      * This is probably poor design, but it's here for backward compatibility.
@@ -2128,6 +2219,8 @@ PQsendDescribePortal(PGconn *conn, const char *portal)
 static int
 PQsendDescribe(PGconn *conn, char desc_type, const char *desc_target)
 {// #lizard forgives
+    PGcmdQueueEntry *entry = NULL;
+
     /* Treat null desc_target as empty string */
     if (!desc_target)
         desc_target = "";
@@ -2143,6 +2236,13 @@ PQsendDescribe(PGconn *conn, char desc_type, const char *desc_target)
         return 0;
     }
 
+    if (conn->pipelineStatus != PQ_PIPELINE_OFF)
+    {
+        entry = pqAllocCmdQueueEntry(conn);
+        if (entry == NULL)
+            return 0;
+    }
+
     /* construct the Describe message */
     if (pqPutMsgStart('D', false, conn) < 0 ||
         pqPutc(desc_type, conn) < 0 ||
@@ -2150,21 +2250,191 @@ PQsendDescribe(PGconn *conn, char desc_type, const char *desc_target)
         pqPutMsgEnd(conn) < 0)
         goto sendFailed;
 
-    /* construct the Sync message */
-    if (pqPutMsgStart('S', false, conn) < 0 ||
-        pqPutMsgEnd(conn) < 0)
+    /* construct the Sync message, unless the pipeline sends it */
+    if (entry == NULL &&
+        (pqPutMsgStart('S', false, conn) < 0 ||
+         pqPutMsgEnd(conn) < 0))
         goto sendFailed;
 
-    /* remember we are doing a Describe */
-    conn->queryclass = PGQUERY_DESCRIBE;
+    /* remember we are doing a Describe; the query text is not relevant now */
+    pqRecordCommand(conn, entry, PGQUERY_DESCRIBE, NULL);
 
-    /* reset last-query string (not relevant now) */
-    if (conn->last_query)
+    /*
+     * Give the data a push.  In nonblock mode, don't complain if we're unable
+     * to send it all; PQgetResult() will do any additional flushing needed.
+     */
+    if (pqPipelineFlush(conn) < 0)
+        goto sendFailed;
+
+    /* OK, it's launched! */
+    if (entry)
+        pqAppendCmdQueueEntry(conn, entry);
+    else
+        conn->asyncStatus = PGASYNC_BUSY;
+    return 1;
+
+sendFailed:
+    pqFreeCmdQueueEntry(entry);
+    pqHandleSendFailure(conn);
+    return 0;
+}
+
+/* ====== pipeline mode ======== */
+
+/*
+ * In pipeline mode commands are sent without waiting for the results of
+ * the previous ones, and without a Sync each.  Every command sent is put
+ * in conn's command queue; the head of the queue is the command whose
+ * results PQgetResult returns, its class and text being in queryclass and
+ * last_query just like for a command sent outside a pipeline.  After an
+ * error the server skips everything up to the next Sync, so the commands
+ * queued before it are answered locally with PGRES_PIPELINE_ABORTED.
+ */
+
+/*
+ * PQpipelineStatus
+ *     Return the pipeline mode status of the connection
+ */
+PGpipelineStatus
+PQpipelineStatus(const PGconn *conn)
+{
+    if (!conn)
+        return PQ_PIPELINE_OFF;
+
+    return conn->pipelineStatus;
+}
+
+/*
+ * PQenterPipelineMode
+ *     Put an idle connection in pipeline mode
+ *
+ * Returns 1 on success (or if already in pipeline mode), 0 on failure.
+ */
+int
+PQenterPipelineMode(PGconn *conn)
+{
+    if (!conn)
+        return 0;
+
+    /* succeed with no action if already in pipeline mode */
+    if (conn->pipelineStatus != PQ_PIPELINE_OFF)
+        return 1;
+
+    if (conn->asyncStatus != PGASYNC_IDLE)
     {
-        free(conn->last_query);
-        conn->last_query = NULL;
+        printfPQExpBuffer(&conn->errorMessage,
+                          libpq_gettext("cannot enter pipeline mode, connection not idle\n"));
+        return 0;
+    }
+
+    /* This isn't gonna work on a 2.0 server */
+    if (PG_PROTOCOL_MAJOR(conn->pversion) < 3)
+    {
+        printfPQExpBuffer(&conn->errorMessage,
+                          libpq_gettext("function requires at least protocol version 3.0\n"));
+        return 0;
+    }
+
+    conn->pipelineStatus = PQ_PIPELINE_ON;
+    return 1;
+}
+
+/*
+ * PQexitPipelineMode
+ *     Take the connection out of pipeline mode
+ *
+ * All results of the commands sent must have been collected.  Returns 1 on
+ * success (or if not in pipeline mode), 0 on failure.
+ */
+int
+PQexitPipelineMode(PGconn *conn)
+{
+    if (!conn)
+        return 0;
+
+    if (conn->pipelineStatus == PQ_PIPELINE_OFF)
+        return 1;
+
+    switch (conn->asyncStatus)
+    {
+        case PGASYNC_READY:
+            printfPQExpBuffer(&conn->errorMessage,
+                              libpq_gettext("cannot exit pipeline mode with uncollected results\n"));
+            return 0;
+        case PGASYNC_BUSY:
+            printfPQExpBuffer(&conn->errorMessage,
+                              libpq_gettext("cannot exit pipeline mode while busy\n"));
+            return 0;
+        case PGASYNC_COPY_IN:
+        case PGASYNC_COPY_OUT:
+        case PGASYNC_COPY_BOTH:
+            printfPQExpBuffer(&conn->errorMessage,
+                              libpq_gettext("cannot exit pipeline mode while in COPY\n"));
+            return 0;
+        default:
+            break;
+    }
+
+    /* still work to process */
+    if (conn->cmd_queue_head != NULL)
+    {
+        printfPQExpBuffer(&conn->errorMessage,
+                          libpq_gettext("cannot exit pipeline mode with uncollected results\n"));
+        return 0;
+    }
+
+    conn->pipelineStatus = PQ_PIPELINE_OFF;
+    conn->asyncStatus = PGASYNC_IDLE;
+
+    /* Flush any pending data in out buffer */
+    if (pqFlush(conn) < 0)
+        return 0;
+    return 1;
+}
+
+/*
+ * PQpipelineSync
+ *     Send a Sync, marking the end of a batch of pipelined commands
+ *
+ * The server answers it with ReadyForQuery, reported as a result of status
+ * PGRES_PIPELINE_SYNC.  The output buffer is flushed.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+int
+PQpipelineSync(PGconn *conn)
+{
+    PGcmdQueueEntry *entry;
+
+    if (!conn)
+        return 0;
+
+    if (conn->pipelineStatus == PQ_PIPELINE_OFF)
+    {
+        printfPQExpBuffer(&conn->errorMessage,
+                          libpq_gettext("cannot send pipeline when not in pipeline mode\n"));
+        return 0;
+    }
+
+    if (conn->asyncStatus == PGASYNC_COPY_IN ||
+        conn->asyncStatus == PGASYNC_COPY_OUT ||
+        conn->asyncStatus == PGASYNC_COPY_BOTH)
+    {
+        printfPQExpBuffer(&conn->errorMessage,
+                          libpq_gettext("cannot send pipeline while in COPY\n"));
+        return 0;
     }
 
+    entry = pqAllocCmdQueueEntry(conn);
+    if (entry == NULL)
+        return 0;
+    entry->queryclass = PGQUERY_SYNC;
+
+    /* construct the Sync message */
+    if (pqPutMsgStart('S', false, conn) < 0 ||
+        pqPutMsgEnd(conn) < 0)
+        goto sendFailed;
+
     /*
      * Give the data a push.  In nonblock mode, don't complain if we're unable
      * to send it all; PQgetResult() will do any additional flushing needed.
@@ -2173,14 +2443,238 @@ PQsendDescribe(PGconn *conn, char desc_type, const char *desc_target)
         goto sendFailed;
 
     /* OK, it's launched! */
-    conn->asyncStatus = PGASYNC_BUSY;
+    pqAppendCmdQueueEntry(conn, entry);
     return 1;
 
 sendFailed:
+    pqFreeCmdQueueEntry(entry);
     pqHandleSendFailure(conn);
     return 0;
 }
 
+/*
+ * PQsendFlushRequest
+ *     Ask the server to send the results produced so far, without a Sync
+ *
+ * The request is only buffered; it goes out with the next flush.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+int
+PQsendFlushRequest(PGconn *conn)
+{
+    if (!conn)
+        return 0;
+
+    /* Don't try to send if we know there's no live connection. */
+    if (conn->status != CONNECTION_OK)
+    {
+        printfPQExpBuffer(&conn->errorMessage,
+                          libpq_gettext("no connection to the server\n"));
+        return 0;
+    }
+
+    /* Can't send while already busy, either, unless enqueuing for later */
+    if (conn->asyncStatus != PGASYNC_IDLE &&
+        conn->pipelineStatus == PQ_PIPELINE_OFF)
+    {
+        printfPQExpBuffer(&conn->errorMessage,
+                          libpq_gettext("another command is already in progress\n"));
+        return 0;
+    }
+
+    if (pqPutMsgStart('H', false, conn) < 0 ||
+        pqPutMsgEnd(conn) < 0)
+        return 0;
+
+    return 1;
+}
+
+/*
+ * pqAllocCmdQueueEntry
+ *     Allocate a command queue entry, before building the messages so that
+ *     running out of memory can't leave a half-sent command behind
+ */
+static PGcmdQueueEntry *
+pqAllocCmdQueueEntry(PGconn *conn)
+{
+    PGcmdQueueEntry *entry;
+
+    entry = (PGcmdQueueEntry *) malloc(sizeof(PGcmdQueueEntry));
+    if (entry == NULL)
+    {
+        printfPQExpBuffer(&conn->errorMessage,
+                          libpq_gettext("out of memory\n"));
+        return NULL;
+    }
+    entry->queryclass = PGQUERY_SIMPLE;
+    entry->query = NULL;
+    entry->next = NULL;
+    return entry;
+}
+
+static void
+pqFreeCmdQueueEntry(PGcmdQueueEntry *entry)
+{
+    if (entry == NULL)
+        return;
+    if (entry->query)
+        free(entry->query);
+    free(entry);
+}
+
+/*
+ * pqFreeCmdQueue
+ *     Discard the command queue, when the connection is closed
+ */
+void
+pqFreeCmdQueue(PGconn *conn)
+{
+    while (conn->cmd_queue_head != NULL)
+    {
+        PGcmdQueueEntry *entry = conn->cmd_queue_head;
+
+        conn->cmd_queue_head = entry->next;
+        pqFreeCmdQueueEntry(entry);
+    }
+    conn->cmd_queue_tail = NULL;
+}
+
+/*
+ * pqRecordCommand
+ *     Remember the class and text of a command just built, in its queue
+ *     entry if pipelining, else as the current command of the connection
+ *
+ * If insufficient memory, the query text just winds up NULL.
+ */
+static void
+pqRecordCommand(PGconn *conn, PGcmdQueueEntry *entry,
+                PGQueryClass queryclass, const char *query)
+{
+    if (entry)
+    {
+        entry->queryclass = queryclass;
+        entry->query = query ? strdup(query) : NULL;
+        return;
+    }
+
+    conn->queryclass = queryclass;
+    if (conn->last_query)
+        free(conn->last_query);
+    conn->last_query = query ? strdup(query) : NULL;
+}
+
+/*
+ * pqAppendCmdQueueEntry
+ *     Queue a command that has been sent in pipeline mode
+ */
+static void
+pqAppendCmdQueueEntry(PGconn *conn, PGcmdQueueEntry *entry)
+{
+    if (conn->cmd_queue_tail != NULL)
+        conn->cmd_queue_tail->next = entry;
+    else
+        conn->cmd_queue_head = entry;
+    conn->cmd_queue_tail = entry;
+
+    /* if nothing was in progress, this becomes the current command */
+    if (conn->asyncStatus == PGASYNC_IDLE ||
+        conn->asyncStatus == PGASYNC_PIPELINE_IDLE)
+        pqPipelineProcessQueue(conn);
+}
+
+/*
+ * pqCommandQueueAdvance
+ *     Remove the current command from the queue once its results are done
+ *
+ * A Sync stays until its ReadyForQuery arrives, even if an error (say, from
+ * committing an implicit transaction) was reported before.
+ */
+static void
+pqCommandQueueAdvance(PGconn *conn, bool gotSync)
+{
+    PGcmdQueueEntry *entry = conn->cmd_queue_head;
+
+    if (entry == NULL)
+        return;
+    if (entry->queryclass == PGQUERY_SYNC && !gotSync)
+        return;
+
+    conn->cmd_queue_head = entry->next;
+    if (conn->cmd_queue_head == NULL)
+        conn->cmd_queue_tail = NULL;
+    pqFreeCmdQueueEntry(entry);
+}
+
+/*
+ * pqPipelineProcessQueue
+ *     Make the head of the command queue the current command
+ */
+static void
+pqPipelineProcessQueue(PGconn *conn)
+{
+    PGcmdQueueEntry *entry = conn->cmd_queue_head;
+
+    /* the current command, if any, isn't done yet */
+    if (conn->asyncStatus != PGASYNC_IDLE &&
+        conn->asyncStatus != PGASYNC_PIPELINE_IDLE)
+        return;
+
+    /* nothing more to process, get us in "real idle" mode */
+    if (entry == NULL)
+    {
+        conn->asyncStatus = PGASYNC_IDLE;
+        return;
+    }
+
+    /* initialize async result-accumulation state for the new command */
+    pqClearAsyncResult(conn);
+    conn->singleRowMode = false;
+
+    conn->queryclass = entry->queryclass;
+    if (conn->last_query)
+        free(conn->last_query);
+    conn->last_query = entry->query;
+    entry->query = NULL;
+
+    if (conn->pipelineStatus == PQ_PIPELINE_ABORTED &&
+        entry->queryclass != PGQUERY_SYNC)
+    {
+        /*
+         * The server discards everything up to the next Sync, so the command
+         * gets no answer; tell the client it was aborted.
+         */
+        conn->result = PQmakeEmptyPGresult(conn, PGRES_PIPELINE_ABORTED);
+        if (!conn->result)
+        {
+            printfPQExpBuffer(&conn->errorMessage,
+                              libpq_gettext("out of memory\n"));
+            pqSaveErrorResult(conn);
+        }
+        conn->asyncStatus = PGASYNC_READY;
+        return;
+    }
+
+    /* allow parsing to continue */
+    conn->asyncStatus = PGASYNC_BUSY;
+}
+
+/*
+ * pqPipelineFlush
+ *     Flush the output buffer after queueing a command
+ *
+ * In pipeline mode the data is only pushed once enough has accumulated;
+ * PQpipelineSync and PQgetResult flush the rest.
+ */
+static int
+pqPipelineFlush(PGconn *conn)
+{
+    if (conn->pipelineStatus != PQ_PIPELINE_ON ||
+        conn->outCount >= PQ_PIPELINE_FLUSH_THRESHOLD)
+        return pqFlush(conn);
+    return 0;
+}
+
 /*
  * PQnotifies
  *      returns a PGnotify* structure of the latest async notification
@@ -2571,6 +3065,14 @@ PQfn(PGconn *conn,
     /* clear the error string */
     resetPQExpBuffer(&conn->errorMessage);
 
+    if (conn->pipelineStatus != PQ_PIPELINE_OFF)
+    {
+        printfPQExpBuffer(&conn->errorMessage,
+                          libpq_gettext("%s not allowed in pipeline mode\n"),
+                          "PQfn");
+        return NULL;
+    }
+
     if (conn->sock == PGINVALID_SOCKET || conn->asyncStatus != PGASYNC_IDLE ||
         conn->result != NULL)
     {
@@ -3826,9 +4328,12 @@ PQgetResultTimed(PGconn *conn, time_t finish_time)
             res = NULL;            /* query is complete */
             break;
         case PGASYNC_READY:
-            res = pqPrepareAsyncResult(conn);
-            /* Set the state back to BUSY, allowing parsing to proceed. */
-            conn->asyncStatus = PGASYNC_BUSY;
+            res = getReadyResult(conn);
+            break;
+        case PGASYNC_PIPELINE_IDLE:
+            /* the current command is done, move on to the next one */
+            pqPipelineProcessQueue(conn);
+            res = NULL;
             break;
         case PGASYNC_COPY_IN:
             if (conn->result && conn->result->resultStatus == PGRES_COPY_IN)
@@ -278,12 +278,30 @@ pqParseInput3(PGconn *conn)
                 case 'E':        /* error return */
                     if (pqGetErrorNotice3(conn, true))
                         return;
+                    /* the server skips the rest of the pipeline until Sync */
+                    if (conn->pipelineStatus != PQ_PIPELINE_OFF)
+                        conn->pipelineStatus = PQ_PIPELINE_ABORTED;
                     conn->asyncStatus = PGASYNC_READY;
                     break;
                 case 'Z':        /* backend is ready for new query */
                     if (getReadyForQuery(conn))
                         return;
-                    conn->asyncStatus = PGASYNC_IDLE;
+                    if (conn->pipelineStatus != PQ_PIPELINE_OFF)
+                    {
+                        /* answer to PQpipelineSync, report it as a result */
+                        conn->result = PQmakeEmptyPGresult(conn,
+                                                           PGRES_PIPELINE_SYNC);
+                        if (!conn->result)
+                        {
+                            printfPQExpBuffer(&conn->errorMessage,
+                                              libpq_gettext("out of memory"));
+                            pqSaveErrorResult(conn);
+                        }
+                        conn->pipelineStatus = PQ_PIPELINE_ON;
+                        conn->asyncStatus = PGASYNC_READY;
+                    }
+                    else
+                        conn->asyncStatus = PGASYNC_IDLE;
                     break;
                 case 'I':        /* empty query */
                     if (conn->result == NULL)
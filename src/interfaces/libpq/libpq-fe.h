@@ -155,7 +155,10 @@ typedef enum
     PGRES_NONFATAL_ERROR,        /* notice or warning message */
     PGRES_FATAL_ERROR,            /* query failed */
     PGRES_COPY_BOTH,            /* Copy In/Out data transfer in progress */
-    PGRES_SINGLE_TUPLE            /* single tuple from larger resultset */
+    PGRES_SINGLE_TUPLE,            /* single tuple from larger resultset */
+    PGRES_PIPELINE_SYNC,        /* pipeline synchronization point */
+    PGRES_PIPELINE_ABORTED        /* command didn't run because of an abort
+                                 * earlier in a pipeline */
 } ExecStatusType;
 
 typedef enum
@@ -167,6 +170,14 @@ typedef enum
     PQTRANS_UNKNOWN                /* cannot determine status */
 } PGTransactionStatusType;
 
+typedef enum
+{
+    PQ_PIPELINE_OFF,            /* not in pipeline mode */
+    PQ_PIPELINE_ON,                /* in pipeline mode */
+    PQ_PIPELINE_ABORTED            /* pipeline mode, commands are skipped
+                                 * until the next synchronization point */
+} PGpipelineStatus;
+
 typedef enum
 {
     PQERRORS_TERSE,                /* single-line error messages */
@@ -489,6 +500,13 @@ extern PGresult *PQgetResult(PGconn *conn);
 extern int    PQisBusy(PGconn *conn);
 extern int    PQconsumeInput(PGconn *conn);
 
+/* Routines for pipeline mode management */
+extern PGpipelineStatus PQpipelineStatus(const PGconn *conn);
+extern int    PQenterPipelineMode(PGconn *conn);
+extern int    PQexitPipelineMode(PGconn *conn);
+extern int    PQpipelineSync(PGconn *conn);
+extern int    PQsendFlushRequest(PGconn *conn);
+
 /* LISTEN/NOTIFY support */
 extern PGnotify *PQnotifies(PGconn *conn);
 
@@ -282,7 +282,8 @@ typedef enum
     PGASYNC_READY,                /* result ready for PQgetResult */
     PGASYNC_COPY_IN,            /* Copy In data transfer in progress */
     PGASYNC_COPY_OUT,            /* Copy Out data transfer in progress */
-    PGASYNC_COPY_BOTH            /* Copy In/Out data transfer in progress */
+    PGASYNC_COPY_BOTH,            /* Copy In/Out data transfer in progress */
+    PGASYNC_PIPELINE_IDLE        /* "Idle" between commands in pipeline mode */
 } PGAsyncStatusType;
 
 /* PGQueryClass tracks which query protocol we are now executing */
@@ -291,9 +292,25 @@ typedef enum
     PGQUERY_SIMPLE,                /* simple Query protocol (PQexec) */
     PGQUERY_EXTENDED,            /* full Extended protocol (PQexecParams) */
     PGQUERY_PREPARE,            /* Parse only (PQprepare) */
-    PGQUERY_DESCRIBE            /* Describe Statement or Portal */
+    PGQUERY_DESCRIBE,            /* Describe Statement or Portal */
+    PGQUERY_SYNC                /* Sync at the end of a pipeline */
 } PGQueryClass;
 
+/*
+ * An entry in the pending command queue of a connection in pipeline mode.
+ * The head of the queue is the command whose results are being returned,
+ * its class and text are also kept in queryclass and last_query.
+ */
+typedef struct PGcmdQueueEntry
+{
+    PGQueryClass queryclass;    /* query type */
+    char       *query;            /* SQL command, or NULL if none/unknown */
+    struct PGcmdQueueEntry *next;
+} PGcmdQueueEntry;
+
+/* pipelined commands are flushed once this much output has accumulated */
+#define PQ_PIPELINE_FLUSH_THRESHOLD    65536
+
 /* PGSetenvStatusType defines the state of the PQSetenv state machine */
 /* (this is used only for 2.0-protocol connections) */
 typedef enum
@@ -445,6 +462,9 @@ struct pg_conn
     PGTransactionStatusType xactStatus; /* never changes to ACTIVE */
     PGQueryClass queryclass;
     char       *last_query;        /* last SQL command, or NULL if unknown */
+    PGpipelineStatus pipelineStatus;    /* status of pipeline mode */
+    PGcmdQueueEntry *cmd_queue_head;    /* commands sent in pipeline mode */
+    PGcmdQueueEntry *cmd_queue_tail;    /* whose results are not consumed */
     char        last_sqlstate[6];    /* last reported SQLSTATE */
     bool        options_valid;    /* true if OK to attempt connection */
     bool        nonblocking;    /* whether this connection is using nonblock
@@ -650,6 +670,7 @@ extern void pqSaveParameterStatus(PGconn *conn, const char *name,
                       const char *value);
 extern int    pqRowProcessor(PGconn *conn, const char **errmsgp);
 extern void pqHandleSendFailure(PGconn *conn);
+extern void pqFreeCmdQueue(PGconn *conn);
 #ifdef __TBASE__
 /* Timed get result. */
 extern PGresult *PQgetResultTimed(PGconn *conn, time_t finish_time);
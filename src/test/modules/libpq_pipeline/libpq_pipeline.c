@@ -0,0 +1,349 @@
+/*-------------------------------------------------------------------------
+ *
+ * libpq_pipeline.c
+ *		Verify libpq pipeline mode against a running server
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *		src/test/modules/libpq_pipeline/libpq_pipeline.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres_fe.h"
+
+#include "libpq-fe.h"
+
+
+static const char *progname;
+
+static void exit_nicely(PGconn *conn) pg_attribute_noreturn();
+static void pg_fatal(PGconn *conn, const char *fmt,...)
+			pg_attribute_printf(2, 3) pg_attribute_noreturn();
+static void expect_result(PGconn *conn, ExecStatusType status,
+			  const char *what);
+static void expect_null(PGconn *conn, const char *what);
+static void expect_value(PGconn *conn, const char *value, const char *what);
+static void send_query(PGconn *conn, const char *query, const char *param);
+
+static void test_disallowed(PGconn *conn);
+static void test_simple_pipeline(PGconn *conn);
+static void test_multi_pipelines(PGconn *conn);
+static void test_pipeline_abort(PGconn *conn);
+static void test_exit_pipeline(PGconn *conn);
+
+/* last result fetched by expect_result */
+static PGresult *last_result = NULL;
+
+static void
+exit_nicely(PGconn *conn)
+{
+	PQfinish(conn);
+	exit(1);
+}
+
+static void
+pg_fatal(PGconn *conn, const char *fmt,...)
+{
+	va_list		args;
+
+	fflush(stdout);
+	fprintf(stderr, "%s: ", progname);
+	va_start(args, fmt);
+	vfprintf(stderr, fmt, args);
+	va_end(args);
+	fprintf(stderr, "\n");
+	if (conn && PQerrorMessage(conn)[0] != '\0')
+		fprintf(stderr, "%s: connection says: %s", progname,
+				PQerrorMessage(conn));
+	exit_nicely(conn);
+}
+
+/*
+ * Fetch the next result and check its status.  It is kept for
+ * expect_value until the next one is fetched.
+ */
+static void
+expect_result(PGconn *conn, ExecStatusType status, const char *what)
+{
+	PGresult   *res;
+
+	if (last_result)
+	{
+		PQclear(last_result);
+		last_result = NULL;
+	}
+
+	res = PQgetResult(conn);
+	if (res == NULL)
+		pg_fatal(conn, "%s: expected %s, got no result",
+				 what, PQresStatus(status));
+	if (PQresultStatus(res) != status)
+		pg_fatal(conn, "%s: expected %s, got %s: %s",
+				 what, PQresStatus(status),
+				 PQresStatus(PQresultStatus(res)),
+				 PQresultErrorMessage(res));
+	last_result = res;
+}
+
+/* The results of a command end with a NULL, except at a sync point */
+static void
+expect_null(PGconn *conn, const char *what)
+{
+	PGresult   *res = PQgetResult(conn);
+
+	if (res != NULL)
+		pg_fatal(conn, "%s: expected end of results, got %s",
+				 what, PQresStatus(PQresultStatus(res)));
+}
+
+static void
+expect_value(PGconn *conn, const char *value, const char *what)
+{
+	if (last_result == NULL || PQntuples(last_result) != 1 ||
+		strcmp(PQgetvalue(last_result, 0, 0), value) != 0)
+		pg_fatal(conn, "%s: expected value \"%s\", got \"%s\"", what, value,
+				 last_result && PQntuples(last_result) > 0 ?
+				 PQgetvalue(last_result, 0, 0) : "");
+}
+
+static void
+send_query(PGconn *conn, const char *query, const char *param)
+{
+	const char *values[1];
+
+	values[0] = param;
+	if (!PQsendQueryParams(conn, query, param ? 1 : 0, NULL,
+						   param ? values : NULL, NULL, NULL, 0))
+		pg_fatal(conn, "failed to send \"%s\"", query);
+}
+
+/*
+ * Synchronous functions and the simple query protocol can't be used in
+ * pipeline mode, and pipeline functions need pipeline mode.
+ */
+static void
+test_disallowed(PGconn *conn)
+{
+	PGresult   *res;
+
+	if (PQpipelineSync(conn))
+		pg_fatal(conn, "PQpipelineSync succeeded outside pipeline mode");
+	if (!PQenterPipelineMode(conn))
+		pg_fatal(conn, "failed to enter pipeline mode");
+
+	res = PQexec(conn, "SELECT 1");
+	if (res != NULL)
+		pg_fatal(conn, "PQexec succeeded in pipeline mode");
+	if (PQsendQuery(conn, "SELECT 1"))
+		pg_fatal(conn, "PQsendQuery succeeded in pipeline mode");
+
+	if (!PQexitPipelineMode(conn))
+		pg_fatal(conn, "failed to exit pipeline mode");
+
+	res = PQexec(conn, "SELECT 1");
+	if (PQresultStatus(res) != PGRES_TUPLES_OK)
+		pg_fatal(conn, "PQexec failed after leaving pipeline mode");
+	PQclear(res);
+}
+
+/*
+ * One command and a sync.  A flush request makes the server send the
+ * command's result before the sync has been sent.
+ */
+static void
+test_simple_pipeline(PGconn *conn)
+{
+	if (!PQenterPipelineMode(conn))
+		pg_fatal(conn, "failed to enter pipeline mode");
+	if (PQpipelineStatus(conn) != PQ_PIPELINE_ON)
+		pg_fatal(conn, "pipeline status is not on");
+
+	send_query(conn, "SELECT $1::int + 1", "41");
+	if (!PQsendFlushRequest(conn) || PQflush(conn) != 0)
+		pg_fatal(conn, "failed to send flush request");
+
+	expect_result(conn, PGRES_TUPLES_OK, "first command");
+	expect_value(conn, "42", "first command");
+	expect_null(conn, "first command");
+
+	if (!PQpipelineSync(conn))
+		pg_fatal(conn, "pipeline sync failed");
+	expect_result(conn, PGRES_PIPELINE_SYNC, "sync");
+	expect_null(conn, "after sync");
+
+	if (!PQexitPipelineMode(conn))
+		pg_fatal(conn, "failed to exit pipeline mode");
+	if (PQpipelineStatus(conn) != PQ_PIPELINE_OFF)
+		pg_fatal(conn, "pipeline status is not off");
+}
+
+/* Several syncs are sent before any result is read */
+static void
+test_multi_pipelines(PGconn *conn)
+{
+	if (!PQenterPipelineMode(conn))
+		pg_fatal(conn, "failed to enter pipeline mode");
+
+	send_query(conn, "SELECT $1", "1");
+	send_query(conn, "SELECT $1", "2");
+	if (!PQpipelineSync(conn))
+		pg_fatal(conn, "first pipeline sync failed");
+	send_query(conn, "SELECT $1", "3");
+	if (!PQpipelineSync(conn))
+		pg_fatal(conn, "second pipeline sync failed");
+
+	expect_result(conn, PGRES_TUPLES_OK, "first command");
+	expect_value(conn, "1", "first command");
+	expect_null(conn, "first command");
+	expect_result(conn, PGRES_TUPLES_OK, "second command");
+	expect_value(conn, "2", "second command");
+	expect_null(conn, "second command");
+	expect_result(conn, PGRES_PIPELINE_SYNC, "first sync");
+
+	expect_result(conn, PGRES_TUPLES_OK, "third command");
+	expect_value(conn, "3", "third command");
+	expect_null(conn, "third command");
+	expect_result(conn, PGRES_PIPELINE_SYNC, "second sync");
+	expect_null(conn, "after second sync");
+
+	if (!PQexitPipelineMode(conn))
+		pg_fatal(conn, "failed to exit pipeline mode");
+}
+
+/*
+ * An error mid-pipeline aborts the commands after it up to the next sync,
+ * after which the pipeline works again.
+ */
+static void
+test_pipeline_abort(PGconn *conn)
+{
+	if (!PQenterPipelineMode(conn))
+		pg_fatal(conn, "failed to enter pipeline mode");
+
+	send_query(conn, "SELECT $1", "1");
+	send_query(conn, "SELECT 1 / $1::int", "0");
+	send_query(conn, "SELECT $1", "2");
+	if (!PQpipelineSync(conn))
+		pg_fatal(conn, "first pipeline sync failed");
+	send_query(conn, "SELECT $1", "3");
+	if (!PQpipelineSync(conn))
+		pg_fatal(conn, "second pipeline sync failed");
+
+	expect_result(conn, PGRES_TUPLES_OK, "command before the error");
+	expect_value(conn, "1", "command before the error");
+	expect_null(conn, "command before the error");
+
+	expect_result(conn, PGRES_FATAL_ERROR, "failing command");
+	expect_null(conn, "failing command");
+	if (PQpipelineStatus(conn) != PQ_PIPELINE_ABORTED)
+		pg_fatal(conn, "pipeline status is not aborted after an error");
+
+	expect_result(conn, PGRES_PIPELINE_ABORTED, "command after the error");
+	expect_null(conn, "command after the error");
+
+	expect_result(conn, PGRES_PIPELINE_SYNC, "first sync");
+	if (PQpipelineStatus(conn) != PQ_PIPELINE_ON)
+		pg_fatal(conn, "pipeline status is not on after sync");
+
+	expect_result(conn, PGRES_TUPLES_OK, "command after the sync");
+	expect_value(conn, "3", "command after the sync");
+	expect_null(conn, "command after the sync");
+	expect_result(conn, PGRES_PIPELINE_SYNC, "second sync");
+	expect_null(conn, "after second sync");
+
+	if (!PQexitPipelineMode(conn))
+		pg_fatal(conn, "failed to exit pipeline mode");
+}
+
+/* Pipeline mode can only be left once all results have been read */
+static void
+test_exit_pipeline(PGconn *conn)
+{
+	if (!PQenterPipelineMode(conn))
+		pg_fatal(conn, "failed to enter pipeline mode");
+
+	send_query(conn, "SELECT $1", "1");
+	if (!PQpipelineSync(conn))
+		pg_fatal(conn, "pipeline sync failed");
+
+	if (PQexitPipelineMode(conn))
+		pg_fatal(conn, "exited pipeline mode with a command in progress");
+	if (PQpipelineStatus(conn) != PQ_PIPELINE_ON)
+		pg_fatal(conn, "pipeline status is not on after failed exit");
+
+	expect_result(conn, PGRES_TUPLES_OK, "command");
+	expect_null(conn, "command");
+
+	if (PQexitPipelineMode(conn))
+		pg_fatal(conn, "exited pipeline mode before the sync was read");
+
+	expect_result(conn, PGRES_PIPELINE_SYNC, "sync");
+	expect_null(conn, "after sync");
+
+	if (!PQexitPipelineMode(conn))
+		pg_fatal(conn, "failed to exit pipeline mode");
+	if (!PQexitPipelineMode(conn))
+		pg_fatal(conn, "exiting pipeline mode twice failed");
+}
+
+static void
+usage(void)
+{
+	fprintf(stderr, "usage: %s TESTNAME [CONNINFO]\n", progname);
+	fprintf(stderr, "Tests:\n");
+	fprintf(stderr, "  disallowed_in_pipeline\n");
+	fprintf(stderr, "  simple_pipeline\n");
+	fprintf(stderr, "  multi_pipelines\n");
+	fprintf(stderr, "  pipeline_abort\n");
+	fprintf(stderr, "  exit_pipeline\n");
+}
+
+int
+main(int argc, char **argv)
+{
+	const char *conninfo = "";
+	const char *testname;
+	PGconn	   *conn;
+
+	progname = argv[0];
+
+	if (argc < 2 || argc > 3)
+	{
+		usage();
+		exit(1);
+	}
+	testname = argv[1];
+	if (argc > 2)
+		conninfo = argv[2];
+
+	conn = PQconnectdb(conninfo);
+	if (PQstatus(conn) != CONNECTION_OK)
+		pg_fatal(conn, "connection to database failed");
+
+	if (strcmp(testname, "disallowed_in_pipeline") == 0)
+		test_disallowed(conn);
+	else if (strcmp(testname, "simple_pipeline") == 0)
+		test_simple_pipeline(conn);
+	else if (strcmp(testname, "multi_pipelines") == 0)
+		test_multi_pipelines(conn);
+	else if (strcmp(testname, "pipeline_abort") == 0)
+		test_pipeline_abort(conn);
+	else if (strcmp(testname, "exit_pipeline") == 0)
+		test_exit_pipeline(conn);
+	else
+	{
+		fprintf(stderr, "%s: \"%s\" is not a recognized test name\n",
+				progname, testname);
+		usage();
+		exit_nicely(conn);
+	}
+
+	if (last_result)
+		PQclear(last_result);
+	PQfinish(conn);
+	printf("ok\n");
+	return 0;
+}
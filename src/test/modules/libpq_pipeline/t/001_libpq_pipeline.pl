@@ -0,0 +1,25 @@
+# Run the libpq pipeline mode tests of libpq_pipeline against one node
+
+use strict;
+use warnings;
+
+use TestLib;
+use Test::More tests => 15;
+use PostgresNode;
+
+my $node = get_new_node('main');
+$node->init;
+$node->start;
+
+my $prog = "$ENV{TESTDIR}/libpq_pipeline";
+
+foreach my $testname (
+	'disallowed_in_pipeline', 'simple_pipeline',
+	'multi_pipelines',        'pipeline_abort',
+	'exit_pipeline')
+{
+	$node->command_like([ $prog, $testname, $node->connstr('postgres') ],
+		qr/^ok$/m, $testname);
+}
+
+$node->stop('fast');
@@ -877,6 +877,9 @@ set_node_config_file(PGXCNodeTypeNum node)
     fputs("max_parallel_workers  = 256\n", pg_conf);
     fputs("enable_statistic = on\n", pg_conf);
 
+    /* Keep extent zone maps so that scans of shard tables can skip extents */
+    fputs("extent_zonemap_entries = 16384\n", pg_conf);
+
     /* Set pooler port for Coordinators */    
     snprintf(buf, sizeof(buf), "pooler_port = %d\n", get_pooler_port(node));
     fputs(buf, pg_conf);
@@ -0,0 +1,19 @@
+--
+-- cluster_unique_id
+--
+-- milliseconds since 2020-01-01, node type, node id and counter
+SELECT abs((cluster_unique_id() >> 22) -
+           (extract(epoch FROM clock_timestamp()) * 1000 - 1577836800000)::int8) < 60000 AS now_ok;
+SELECT (cluster_unique_id() >> 21) & 1 AS datanode, ((cluster_unique_id() >> 12) & 511) > 0 AS node_ok;
+EXECUTE DIRECT ON (datanode_1) 'SELECT (cluster_unique_id() >> 21) & 1 AS datanode';
+
+-- more ids than the counter holds per millisecond, all distinct and growing
+SELECT count(DISTINCT id), count(*), bool_and(id > prev) AS growing
+  FROM (SELECT id, lag(id) OVER (ORDER BY n) AS prev
+          FROM (SELECT n, cluster_unique_id() AS id FROM generate_series(1, 10000) n) s) t;
+
+CREATE TABLE uid_t (id int8 DEFAULT cluster_unique_id(), v int) DISTRIBUTE BY HASH (v);
+INSERT INTO uid_t (v) SELECT generate_series(1, 1000);
+INSERT INTO uid_t (v) VALUES (1001);
+SELECT count(DISTINCT id), count(*), min(id) > 0 AS positive FROM uid_t;
+DROP TABLE uid_t;
@@ -0,0 +1,14 @@
+--
+-- pg_get_cold_partitions
+--
+CREATE TABLE cold_plain (a int) DISTRIBUTE BY REPLICATION;
+SELECT * FROM pg_get_cold_partitions('cold_plain');
+
+-- routed by f1 only, so no partition is ever left to a cold group
+CREATE TABLE cold_t (f1 int not null, f2 timestamp not null) partition by range (f2) begin (timestamp without time zone '2019-01-01 0:0:0') step (interval '1 month') partitions (2) distribute by shard(f1) to group default_group;
+INSERT INTO cold_t VALUES (1, timestamp without time zone '2019-01-15 0:0:0');
+INSERT INTO cold_t VALUES (2, timestamp without time zone '2019-02-15 0:0:0');
+SELECT * FROM pg_get_cold_partitions('cold_t');
+
+DROP TABLE cold_plain;
+DROP TABLE cold_t;
@@ -0,0 +1,39 @@
+--
+-- Extent zone maps of shard tables
+--
+-- pg_regress keeps the summaries on; 0 would disable them
+SHOW extent_zonemap_entries;
+
+CREATE TABLE zm_t (a int, b bigint, d date, s text) DISTRIBUTE BY SHARD (a);
+INSERT INTO zm_t SELECT i, i * 10, date '2020-01-01' + i / 100, 'v' || i
+  FROM generate_series(1, 20000) i;
+
+-- quals the summaries can be checked against
+SELECT count(*) FROM zm_t WHERE a < 100;
+SELECT count(*) FROM zm_t WHERE 100 > a;
+SELECT a, b, s FROM zm_t WHERE a = 15000;
+SELECT count(*) FROM zm_t WHERE a >= 19990;
+SELECT count(*) FROM zm_t WHERE a > 20000;
+SELECT a FROM zm_t WHERE a = ANY ('{1, 5000, 20000, 30000}') ORDER BY a;
+SELECT count(*) FROM zm_t WHERE b BETWEEN 1000 AND 1990;
+SELECT count(*) FROM zm_t WHERE b < 100::int2;
+SELECT count(*) FROM zm_t WHERE d = date '2020-02-01';
+SELECT count(*) FROM zm_t WHERE d < date '2020-01-02' AND a > 50;
+-- not usable for skipping, still right
+SELECT count(*) FROM zm_t WHERE a <> 1;
+SELECT count(*) FROM zm_t WHERE a < 100 OR a > 19900;
+
+-- new tuple versions and new rows widen the summaries
+UPDATE zm_t SET b = -1 WHERE a % 1000 = 0;
+SELECT count(*) FROM zm_t WHERE b < 0;
+INSERT INTO zm_t VALUES (50000, 500000, date '2030-01-01', 'late');
+INSERT INTO zm_t VALUES (50001, NULL, NULL, 'nulls');
+SELECT a, s FROM zm_t WHERE a = 50000;
+SELECT a, s FROM zm_t WHERE d > date '2029-01-01';
+SELECT count(*) FROM zm_t WHERE b > 199990;
+SELECT a, s FROM zm_t WHERE b IS NULL;
+DELETE FROM zm_t WHERE a <= 10000;
+SELECT count(*) FROM zm_t WHERE a < 100;
+SELECT count(*) FROM zm_t WHERE a > 10000;
+
+DROP TABLE zm_t;
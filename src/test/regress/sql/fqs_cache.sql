@@ -0,0 +1,43 @@
+--
+-- FQS decision cache
+--
+CREATE TABLE fqs_cache_t1 (a int, b int) WITH (autovacuum_enabled = off)
+	DISTRIBUTE BY REPLICATION;
+CREATE TABLE fqs_cache_t2 (a int, b int) WITH (autovacuum_enabled = off)
+	DISTRIBUTE BY HASH (a);
+INSERT INTO fqs_cache_t1 VALUES (1, 10), (2, 20), (3, 30);
+INSERT INTO fqs_cache_t2 VALUES (1, 10), (2, 20), (3, 30);
+-- nothing looked up yet
+SELECT hits, misses, entries FROM pg_stat_get_fqs_cache();
+
+-- the first query of a shape misses, the next ones hit whatever the constants
+SELECT b FROM fqs_cache_t1 WHERE a = 1;
+SELECT b FROM fqs_cache_t1 WHERE a = 2;
+SELECT b FROM fqs_cache_t2 WHERE a = 1;
+SELECT b FROM fqs_cache_t2 WHERE a = 3;
+SELECT hits, misses, entries FROM pg_stat_get_fqs_cache();
+
+-- ALTER TABLE drops the decisions of that table only
+ALTER TABLE fqs_cache_t1 ADD COLUMN c int;
+SELECT b FROM fqs_cache_t1 WHERE a = 3;
+SELECT b FROM fqs_cache_t2 WHERE a = 2;
+SELECT hits, misses, entries FROM pg_stat_get_fqs_cache();
+
+-- fqs_cache_size = 0 switches the cache off
+SET fqs_cache_size = 0;
+SELECT b FROM fqs_cache_t2 WHERE a = 1;
+SELECT hits, misses, entries FROM pg_stat_get_fqs_cache();
+RESET fqs_cache_size;
+
+-- a replicated table can ship a sorted scan to one node
+EXPLAIN (verbose on, nodes off, costs off) SELECT a, b FROM fqs_cache_t1 ORDER BY a;
+SELECT a, b FROM fqs_cache_t1 ORDER BY a;
+SELECT hits, misses, entries FROM pg_stat_get_fqs_cache();
+
+-- once distributed it can't, the cached decision must not be reused
+ALTER TABLE fqs_cache_t1 DISTRIBUTE BY HASH (a);
+EXPLAIN (verbose on, nodes off, costs off) SELECT a, b FROM fqs_cache_t1 ORDER BY a;
+SELECT a, b FROM fqs_cache_t1 ORDER BY a;
+
+DROP TABLE fqs_cache_t1;
+DROP TABLE fqs_cache_t2;
@@ -0,0 +1,26 @@
+--
+-- Global deadlock detection
+--
+
+-- the detector worker is off by default
+SHOW global_deadlock_detector_interval;
+
+-- nobody waits for a lock, so there are no wait-for edges
+SELECT count(*) FROM pg_lock_wait_graph();
+EXECUTE DIRECT ON (datanode_1) 'SELECT count(*) FROM pg_lock_wait_graph()';
+EXECUTE DIRECT ON (datanode_2) 'SELECT count(*) FROM pg_lock_wait_graph()';
+
+-- and nothing to cancel
+SELECT pg_detect_global_deadlock();
+SELECT pg_cancel_global_xid('no such transaction');
+
+-- the detector only runs on coordinators
+EXECUTE DIRECT ON (datanode_1) 'SELECT pg_detect_global_deadlock()';
+
+-- only superusers may cancel transactions
+CREATE ROLE regress_gdd_user;
+SET SESSION AUTHORIZATION regress_gdd_user;
+SELECT pg_detect_global_deadlock();
+SELECT pg_cancel_global_xid('no such transaction');
+RESET SESSION AUTHORIZATION;
+DROP ROLE regress_gdd_user;
@@ -0,0 +1,41 @@
+--
+-- Decrypted page cache against shard truncation
+--
+-- Like mls_check, this needs the mls_admin user, and the datanodes have to
+-- run with decrypt_page_cache_size set and shared_buffers small enough for
+-- the churn below to push the pages of dc_tbl out into the cache.
+--
+\set dc_user :USER
+CREATE USER dc_super SUPERUSER;
+\c regression dc_super
+CREATE EXTENSION IF NOT EXISTS tbase_mls;
+CREATE TABLE dc_tbl (k int, v text) DISTRIBUTE BY SHARD (k);
+CREATE TABLE dc_churn (k int, v text) DISTRIBUTE BY SHARD (k);
+
+\c regression mls_admin
+SELECT MLS_TRANSPARENT_CRYPT_CREATE_ALGORITHM('AES128', '2468') AS dc_algo \gset
+SELECT MLS_TRANSPARENT_CRYPT_ALGORITHM_BIND_TABLE('public', 'dc_tbl', :dc_algo);
+
+\c regression dc_super
+-- all rows in one shard, written out clean, then evicted
+INSERT INTO dc_tbl SELECT 1, 'deleted ' || repeat('x', 500) FROM generate_series(1, 200);
+CHECKPOINT;
+INSERT INTO dc_churn SELECT g, repeat('y', 1000) FROM generate_series(1, 20000) g;
+UPDATE dc_churn SET v = repeat('z', 1000);
+
+-- truncate the shard on its datanode
+SELECT DISTINCT format('EXECUTE DIRECT ON (%s) ''VACUUM dc_tbl SHARDING (%s)''',
+                       n.node_name, t.shardid)
+FROM dc_tbl t JOIN pgxc_node n ON n.node_id = t.xc_node_id \gexec
+SELECT count(*) FROM dc_tbl;
+
+-- the freed extent is reused; none of the deleted rows may come back
+INSERT INTO dc_tbl SELECT 1, 'kept' FROM generate_series(1, 10);
+SELECT v, count(*) FROM dc_tbl GROUP BY v;
+
+DROP TABLE dc_tbl;
+DROP TABLE dc_churn;
+\c regression mls_admin
+SELECT MLS_TRANSPARENT_CRYPT_DROP_ALGORITHM(:dc_algo);
+\c regression :dc_user
+DROP USER dc_super;
@@ -0,0 +1,31 @@
+--
+-- numeric sum() and avg(), which add values fitting in 128 bits directly
+-- and fall back to the digit accumulator otherwise
+--
+CREATE TABLE num_sum (id int, g int, v numeric) DISTRIBUTE BY HASH (g);
+-- mixed scales
+INSERT INTO num_sum VALUES (1, 1, 1.5), (2, 1, 2.25), (3, 1, -3.125), (4, 1, 10), (5, 1, 0.0001);
+-- cancelling out keeps the scale
+INSERT INTO num_sum VALUES (6, 2, 1.50), (7, 2, -1.50);
+-- the running sum overflows 128 bits
+INSERT INTO num_sum SELECT 100 + i, 3, 12345678901234567890.123456789012345678
+  FROM generate_series(1, 20) i;
+-- a value that does not fit at all
+INSERT INTO num_sum VALUES (8, 4, 1e40), (9, 4, 1), (10, 4, 0.5);
+INSERT INTO num_sum VALUES (11, 5, 1), (12, 5, 2), (13, 5, 3), (14, 5, 4);
+INSERT INTO num_sum VALUES (15, 6, 1), (16, 6, 'NaN');
+-- rescaling the running sum overflows 128 bits
+INSERT INTO num_sum VALUES (17, 7, 99999999999999999999), (18, 7, 0.000000000000000000000000000001);
+
+SELECT g, sum(v), avg(v) = sum(v) / count(v) AS avg_ok FROM num_sum GROUP BY g ORDER BY g;
+-- partial sums of the datanodes are combined
+SELECT sum(v) FROM num_sum WHERE g <> 6;
+SELECT avg(v) FROM num_sum WHERE g = 5;
+SELECT sum(v), avg(v) FROM num_sum WHERE g = 100;
+-- the moving sum removes values again
+SELECT id, sum(v) OVER (ORDER BY id ROWS BETWEEN 1 PRECEDING AND CURRENT ROW)
+  FROM num_sum WHERE g = 1 ORDER BY id;
+-- variance always uses the digit accumulator
+SELECT var_samp(v), sum(v) FROM num_sum WHERE g = 5;
+
+DROP TABLE num_sum;
@@ -0,0 +1,37 @@
+--
+-- Runtime join filters shipped from hash joins to remote subplan producers
+--
+-- off by default
+SHOW enable_runtime_join_filter;
+
+CREATE TABLE rjf_t1 (a int, b int) DISTRIBUTE BY HASH (a);
+CREATE TABLE rjf_t2 (a int, b int) DISTRIBUTE BY HASH (a);
+INSERT INTO rjf_t1 SELECT i, i % 100 FROM generate_series(1, 1000) i;
+INSERT INTO rjf_t2 SELECT i, i * 3 FROM generate_series(1, 20) i;
+INSERT INTO rjf_t2 VALUES (21, 200);
+ANALYZE rjf_t1;
+ANALYZE rjf_t2;
+
+-- joins on b redistribute both sides; keep them hash joins
+SET enable_mergejoin TO off;
+SET enable_nestloop TO off;
+
+SELECT count(*), sum(t1.a) FROM rjf_t1 t1 JOIN rjf_t2 t2 ON t1.b = t2.b;
+SELECT count(*) FROM rjf_t1 t1 WHERE EXISTS (SELECT 1 FROM rjf_t2 t2 WHERE t2.b = t1.b);
+SELECT count(*), count(t1.a) FROM rjf_t1 t1 RIGHT JOIN rjf_t2 t2 ON t1.b = t2.b;
+SELECT count(*) FROM rjf_t1 t1 JOIN rjf_t2 t2 ON t1.b = t2.b WHERE t2.a > 20;
+
+-- with the filter, the results must not change
+SET enable_runtime_join_filter TO on;
+SELECT count(*), sum(t1.a) FROM rjf_t1 t1 JOIN rjf_t2 t2 ON t1.b = t2.b;
+SELECT count(*) FROM rjf_t1 t1 WHERE EXISTS (SELECT 1 FROM rjf_t2 t2 WHERE t2.b = t1.b);
+SELECT count(*), count(t1.a) FROM rjf_t1 t1 RIGHT JOIN rjf_t2 t2 ON t1.b = t2.b;
+SELECT count(*) FROM rjf_t1 t1 JOIN rjf_t2 t2 ON t1.b = t2.b WHERE t2.a > 20;
+-- a left join keeps unmatched outer rows, so it is not filtered
+SELECT count(*), count(t2.a) FROM rjf_t1 t1 LEFT JOIN rjf_t2 t2 ON t1.b = t2.b;
+
+RESET enable_runtime_join_filter;
+RESET enable_mergejoin;
+RESET enable_nestloop;
+DROP TABLE rjf_t1;
+DROP TABLE rjf_t2;
@@ -0,0 +1,20 @@
+--
+-- tbase_shard_rebalance_plan
+--
+-- the shard groups of default_group are spread evenly already
+SELECT count(*) FROM tbase_shard_rebalance_plan('default_group');
+SELECT * FROM tbase_shard_rebalance_plan('nosuch');
+
+-- shard groups 0, 2 and 4 live on the same datanode
+SELECT shardgroupid, from_node <> to_node AS moved
+  FROM tbase_shard_rebalance_plan('default_group', ARRAY[0, 2, 4], ARRAY[100, 250, 50]::float8[]);
+-- equal loads on both datanodes need no moves
+SELECT count(*) FROM tbase_shard_rebalance_plan('default_group', ARRAY[0, 1], ARRAY[100, 100]::float8[]);
+-- unknown shard groups and null entries are ignored
+SELECT count(*) FROM tbase_shard_rebalance_plan('default_group', ARRAY[99999, NULL], ARRAY[1000, 1000]::float8[]);
+-- moving the only loaded shard group would not narrow the gap
+SELECT count(*) FROM tbase_shard_rebalance_plan('default_group', ARRAY[0, 2], ARRAY[NULL, 1000]::float8[]);
+
+SELECT * FROM tbase_shard_rebalance_plan('default_group', ARRAY[0, 2], ARRAY[1]::float8[]);
+SELECT * FROM tbase_shard_rebalance_plan('default_group', ARRAY[0], ARRAY[-1]::float8[]);
+SELECT * FROM tbase_shard_rebalance_plan('default_group', NULL, ARRAY[1]::float8[]);
@@ -0,0 +1,30 @@
+--
+-- Per-column TOAST compression
+--
+SHOW default_toast_compression;
+
+CREATE TABLE cmp_t (id int, v text, w text) DISTRIBUTE BY REPLICATION;
+ALTER TABLE cmp_t ALTER COLUMN v SET (compression = foo);
+ALTER TABLE cmp_t ALTER COLUMN v SET (compression = pglz);
+SELECT attname, attoptions FROM pg_attribute
+  WHERE attrelid = 'cmp_t'::regclass AND attnum > 0 ORDER BY attnum;
+-- values of w are never compressed
+ALTER TABLE cmp_t ALTER COLUMN w SET STORAGE EXTERNAL;
+
+INSERT INTO cmp_t VALUES (1, 'short', 'short');
+INSERT INTO cmp_t VALUES (2, repeat('x', 10000), repeat('x', 10000));
+EXECUTE DIRECT ON (datanode_1) 'SELECT id, pg_column_compression(v) AS v, pg_column_compression(w) AS w FROM cmp_t ORDER BY id';
+SELECT id, length(v), length(w), v = w AS same FROM cmp_t ORDER BY id;
+
+-- the default method applies once the column option is gone
+ALTER TABLE cmp_t ALTER COLUMN v RESET (compression);
+SET default_toast_compression = pglz;
+INSERT INTO cmp_t VALUES (3, repeat('y', 10000), NULL);
+RESET default_toast_compression;
+EXECUTE DIRECT ON (datanode_1) 'SELECT id, pg_column_compression(v) AS v FROM cmp_t WHERE id = 3';
+SELECT length(v) FROM cmp_t WHERE id = 3;
+
+-- not a varlena
+SELECT pg_column_compression(1);
+
+DROP TABLE cmp_t;